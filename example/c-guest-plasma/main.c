@@ -0,0 +1,87 @@
+#include "wasm96.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+// Full-screen plasma for wasm96 C guest (freestanding-friendly).
+//
+// Demonstrates the guest-owned framebuffer: the guest writes every pixel of a static
+// 0x00RRGGBB array and the host presents it directly each frame, with no per-pixel import
+// calls and no copy through `wasm96_graphics_image`.
+//
+// Controls (gamepad, port 0):
+//   - A: toggle palette
+//
+// Notes:
+//   - No dynamic allocation, no libm (sine and palette are integer lookup tables).
+
+#define SCREEN_W 320
+#define SCREEN_H 240
+
+static uint32_t g_pixels[SCREEN_W * SCREEN_H];
+
+// sin(i * 2pi / 256) scaled to [-127, 127].
+static int8_t g_sin[256];
+static uint32_t g_palette[2][256];
+
+static uint32_t g_frame = 0;
+static int g_palette_index = 0;
+static bool g_prev_a = false;
+
+// Bhaskara I sine approximation for 0..180 degrees, scaled by 127.
+static int bhaskara_sin_deg(int deg) {
+    int num = 4 * deg * (180 - deg);
+    int den = 40500 - deg * (180 - deg);
+    return (num * 127) / den;
+}
+
+static void build_tables(void) {
+    for (int i = 0; i < 256; i++) {
+        int deg = (i * 360) / 256;
+        g_sin[i] = (int8_t)(deg < 180 ? bhaskara_sin_deg(deg) : -bhaskara_sin_deg(deg - 180));
+    }
+
+    for (int i = 0; i < 256; i++) {
+        // Palette 0: fire-ish. Palette 1: ocean.
+        uint32_t r0 = (uint32_t)(128 + g_sin[i & 255]);
+        uint32_t g0 = (uint32_t)(128 + g_sin[(i + 64) & 255] / 2);
+        uint32_t b0 = (uint32_t)(64 + g_sin[(i + 128) & 255] / 2);
+        g_palette[0][i] = (r0 << 16) | (g0 << 8) | b0;
+
+        uint32_t r1 = (uint32_t)(32 + g_sin[(i + 128) & 255] / 4 + 31);
+        uint32_t g1 = (uint32_t)(128 + g_sin[(i + 32) & 255] / 2);
+        uint32_t b1 = (uint32_t)(128 + g_sin[i & 255]);
+        g_palette[1][i] = (r1 << 16) | (g1 << 8) | b1;
+    }
+}
+
+void setup(void) {
+    wasm96_graphics_set_size(SCREEN_W, SCREEN_H);
+    build_tables();
+    if (!wasm96_graphics_bind_framebuffer_xrgb8888(g_pixels, SCREEN_W, SCREEN_H)) {
+        wasm96_system_log_str("plasma: failed to bind guest framebuffer");
+    }
+}
+
+void update(void) {
+    bool a = wasm96_input_is_button_down_enum(0, WASM96_BUTTON_A);
+    if (a && !g_prev_a) g_palette_index ^= 1;
+    g_prev_a = a;
+    g_frame++;
+}
+
+void draw(void) {
+    const uint32_t* pal = g_palette[g_palette_index];
+    uint32_t t = g_frame;
+
+    for (int y = 0; y < SCREEN_H; y++) {
+        uint32_t* row = g_pixels + y * SCREEN_W;
+        int sy = g_sin[(y * 2 + t) & 255];
+        for (int x = 0; x < SCREEN_W; x++) {
+            int v = g_sin[(x + t * 3) & 255]
+                  + sy
+                  + g_sin[((x + y) + t * 2) & 255]
+                  + g_sin[((x * 3 - y * 2) / 4 + t) & 255];
+            row[x] = pal[(uint32_t)(v / 2 + 128) & 255];
+        }
+    }
+}
@@ -0,0 +1,8 @@
+#ifndef WASM96_EXAMPLE_C_GUEST_PLASMA_WASM96_H
+#define WASM96_EXAMPLE_C_GUEST_PLASMA_WASM96_H
+
+// This example intentionally uses the canonical C SDK header from the repo,
+// rather than keeping a stale local copy in the example directory.
+#include "../../wasm96-c-sdk/wasm96.h"
+
+#endif // WASM96_EXAMPLE_C_GUEST_PLASMA_WASM96_H
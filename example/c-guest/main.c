@@ -14,6 +14,9 @@
 //   - Uses a grid and draws filled rects.
 //   - Text rendering: core now falls back to Spleen 16 when no font registered,
 //     so we can safely call wasm96_graphics_text_key_str with any font key.
+//   - Redraws only when the game state changes. The framebuffer is retained between
+//     frames, and a frame with no drawing is not re-sent to the frontend, so the frames
+//     between snake steps (and all of pause/game over) cost almost nothing.
 
 #define SCREEN_W 640
 #define SCREEN_H 480
@@ -90,14 +93,14 @@ typedef struct {
     int step_frames;
     int step_counter;
 
-    // Input debouncing
-    bool prev_btn[16];
-
     // Random
     Rng rng;
 
     // Occupancy grid for fast food placement
     uint8_t occ[MAX_CELLS]; // 0 empty, 1 snake
+
+    // Something visible changed since the last draw.
+    bool dirty;
 } Game;
 
 static Game g;
@@ -110,23 +113,6 @@ static inline bool in_bounds(int x, int y) {
     return (x >= 0 && x < COLS && y >= 0 && y < ROWS);
 }
 
-static inline bool btn_down(uint32_t btn) {
-    return wasm96_input_is_button_down(0, btn) != 0;
-}
-
-static inline bool btn_pressed(uint32_t btn) {
-    bool now = btn_down(btn);
-    bool pressed = now && !g.prev_btn[btn];
-    g.prev_btn[btn] = now;
-    return pressed;
-}
-
-static inline void sync_buttons(void) {
-    for (int i = 0; i < 16; i++) {
-        g.prev_btn[i] = btn_down((uint32_t)i);
-    }
-}
-
 static void occ_clear(void) {
     for (int i = 0; i < MAX_CELLS; i++) g.occ[i] = 0;
 }
@@ -214,7 +200,7 @@ static void game_reset(uint32_t seed) {
     rng_seed(&g.rng, seed);
     snake_reset();
     place_food();
-    sync_buttons();
+    g.dirty = true;
 }
 
 static inline bool dir_is_opposite(Dir a, Dir b) {
@@ -225,10 +211,14 @@ static inline bool dir_is_opposite(Dir a, Dir b) {
 }
 
 static void handle_input(void) {
-    if (btn_pressed(WASM96_BUTTON_START)) {
+    // One snapshot per frame; the host computes the press edges.
+    wasm96_pad_t pad = wasm96_input_pad(0);
+
+    if (wasm96_pad_pressed(&pad, WASM96_BUTTON_START)) {
         g.paused = !g.paused;
+        g.dirty = true;
     }
-    if (btn_pressed(WASM96_BUTTON_SELECT)) {
+    if (wasm96_pad_pressed(&pad, WASM96_BUTTON_SELECT)) {
         game_reset((uint32_t)wasm96_system_millis());
         return;
     }
@@ -237,10 +227,10 @@ static void handle_input(void) {
     // Note: do not allow immediate reversal.
     Dir desired = g.next_dir;
 
-    if (btn_pressed(WASM96_BUTTON_UP)) desired = DIR_UP;
-    else if (btn_pressed(WASM96_BUTTON_RIGHT)) desired = DIR_RIGHT;
-    else if (btn_pressed(WASM96_BUTTON_DOWN)) desired = DIR_DOWN;
-    else if (btn_pressed(WASM96_BUTTON_LEFT)) desired = DIR_LEFT;
+    if (wasm96_pad_pressed(&pad, WASM96_BUTTON_UP)) desired = DIR_UP;
+    else if (wasm96_pad_pressed(&pad, WASM96_BUTTON_RIGHT)) desired = DIR_RIGHT;
+    else if (wasm96_pad_pressed(&pad, WASM96_BUTTON_DOWN)) desired = DIR_DOWN;
+    else if (wasm96_pad_pressed(&pad, WASM96_BUTTON_LEFT)) desired = DIR_LEFT;
 
     if (!dir_is_opposite(desired, g.dir)) {
         g.next_dir = desired;
@@ -252,6 +242,7 @@ static void step_snake(void) {
 
     // Apply direction choice at step boundary
     g.dir = g.next_dir;
+    g.dirty = true;
 
     Point h = snake_head();
     Point nh = h;
@@ -407,52 +398,49 @@ static void write_int(char* out, int v) {
     out[pos] = '\0';
 }
 
+// `pfx` followed by `value`, NUL-terminated (fits in 64 bytes).
+static void write_labeled(char* out, const char* pfx, int value) {
+    char num[16];
+    write_int(num, value);
+    int k = 0;
+    for (; pfx[k] != '\0'; k++) out[k] = pfx[k];
+    int j = 0;
+    for (; num[j] != '\0' && (k + j) < 63; j++) out[k + j] = num[j];
+    out[k + j] = '\0';
+}
+
 static void draw_hud(void) {
-    // Sidebar
+    // Sidebar, drawn as one text batch: the strings only change when the score does, so the host
+    // reuses their layout from frame to frame.
     int hud_x = 16;
     int hud_y = 16;
+    const uint32_t white = 0xFFF0F0FFu;
+    const uint32_t hint = 0xFFC8C8FFu;
 
-    wasm96_graphics_set_color_rgba(240, 240, 255, 255);
-    wasm96_graphics_text_key_str(hud_x, hud_y, "spleen", "WASM96 Snake (C guest)");
+    // The batch only holds pointers, so each line needs its own buffer.
+    char score[64];
+    char best[64];
+    write_labeled(score, "SCORE: ", g.score);
+    write_labeled(best, "BEST: ", g.best);
 
-    char line[64];
-    char num[16];
-
-    // SCORE
-    write_int(num, g.score);
-    // "SCORE: " + num
-    int k = 0;
-    const char* pfx = "SCORE: ";
-    for (; pfx[k] != '\0'; k++) line[k] = pfx[k];
-    int j = 0;
-    for (; num[j] != '\0' && (k + j) < 63; j++) line[k + j] = num[j];
-    line[k + j] = '\0';
-    wasm96_graphics_text_key_str(hud_x, hud_y + 22, "spleen", line);
-
-    // BEST
-    write_int(num, g.best);
-    k = 0;
-    pfx = "BEST: ";
-    for (; pfx[k] != '\0'; k++) line[k] = pfx[k];
-    j = 0;
-    for (; num[j] != '\0' && (k + j) < 63; j++) line[k + j] = num[j];
-    line[k + j] = '\0';
-    wasm96_graphics_text_key_str(hud_x, hud_y + 44, "spleen", line);
+    wasm96_text_item_t items[6];
+    uint32_t n = 0;
+    items[n++] = wasm96_text_item(hud_x, hud_y, "WASM96 Snake (C guest)", white);
+    items[n++] = wasm96_text_item(hud_x, hud_y + 22, score, white);
+    items[n++] = wasm96_text_item(hud_x, hud_y + 44, best, white);
 
     if (g.paused) {
-        wasm96_graphics_set_color_rgba(255, 255, 0, 255);
-        wasm96_graphics_text_key_str(hud_x, hud_y + 76, "spleen", "PAUSED");
+        items[n++] = wasm96_text_item(hud_x, hud_y + 76, "PAUSED", 0xFFFFFF00u);
     } else if (g.game_over) {
-        wasm96_graphics_set_color_rgba(255, 120, 120, 255);
-        wasm96_graphics_text_key_str(hud_x, hud_y + 76, "spleen", "GAME OVER");
-        wasm96_graphics_set_color_rgba(240, 240, 255, 255);
-        wasm96_graphics_text_key_str(hud_x, hud_y + 98, "spleen", "Select: restart");
+        items[n++] = wasm96_text_item(hud_x, hud_y + 76, "GAME OVER", 0xFFFF7878u);
+        items[n++] = wasm96_text_item(hud_x, hud_y + 98, "Select: restart", white);
     } else {
-        wasm96_graphics_set_color_rgba(200, 200, 255, 255);
-        wasm96_graphics_text_key_str(hud_x, hud_y + 76, "spleen", "D-Pad: move");
-        wasm96_graphics_text_key_str(hud_x, hud_y + 98, "spleen", "Start: pause");
-        wasm96_graphics_text_key_str(hud_x, hud_y + 120, "spleen", "Select: restart");
+        items[n++] = wasm96_text_item(hud_x, hud_y + 76, "D-Pad: move", hint);
+        items[n++] = wasm96_text_item(hud_x, hud_y + 98, "Start: pause", hint);
+        items[n++] = wasm96_text_item(hud_x, hud_y + 120, "Select: restart", hint);
     }
+
+    wasm96_graphics_text_batch_str("spleen", items, n);
 }
 
 void setup(void) {
@@ -463,6 +451,12 @@ void setup(void) {
     // If the guest doesn't register a font, the core falls back to Spleen 16 anyway.
     wasm96_graphics_font_register_spleen(wasm96_hash_key("spleen"), 16);
 
+    // The board frame and grid never change: record them once as a retained list and replay
+    // it with one call per frame.
+    wasm96_graphics_list_begin_str("snake/board");
+    draw_board();
+    wasm96_graphics_list_end();
+
     game_reset((uint32_t)wasm96_system_millis());
 }
 
@@ -472,9 +466,12 @@ void update(void) {
 }
 
 void draw(void) {
+    if (!g.dirty) return;
+    g.dirty = false;
+
     wasm96_graphics_background_rgb(0, 0, 50);
 
-    draw_board();
+    wasm96_graphics_list_draw_str("snake/board", 0, 0);
     draw_snake_and_food();
     draw_hud();
 }
@@ -18,6 +18,8 @@
 
 namespace {
 
+using namespace wasm96::literals;
+
 constexpr int kScreenW = 640;
 constexpr int kScreenH = 480;
 
@@ -28,13 +30,14 @@ constexpr int kRows = kRowsVisible + kRowsHidden; // includes hidden spawn rows
 
 // Storage/HUD
 //
-// Core semantics: fonts are keyed by u64. The C++ SDK hashes string keys for you.
+// Core semantics: fonts are keyed by u64. The `_k` literal hashes string keys at
+// compile time, so the per-frame HUD calls don't rehash "spleen" on every line.
 // The core also documents a special built-in font key "spleen".
 // We'll register a sized Spleen font under that key in setup and always render HUD
 // text using it.
-constexpr const char* kHudFont = "spleen";
+constexpr uint64_t kHudFont = "spleen"_k;
 constexpr uint32_t kHudFontSize = 16;
-constexpr const char* kHighScoreKey = "tetris_high_score_v1";
+constexpr uint64_t kHighScoreKey = "tetris_high_score_v1"_k;
 
 // Layout
 constexpr int kCell = 20;
@@ -153,24 +156,6 @@ struct RNG {
     }
 };
 
-struct InputEdge {
-    bool prev[16] = {};
-    bool pressed(int btn) {
-        bool now = wasm96::Input::isButtonDown(0, (wasm96_button_t)btn);
-        bool p = now && !prev[btn];
-        prev[btn] = now;
-        return p;
-    }
-    bool down(int btn) const {
-        return wasm96::Input::isButtonDown(0, (wasm96_button_t)btn);
-    }
-    void sync() {
-        for (int i = 0; i < 16; i++) {
-            prev[i] = wasm96::Input::isButtonDown(0, (wasm96_button_t)i);
-        }
-    }
-};
-
 struct Game {
     // Field cells: -1 empty, otherwise 0..6 piece type index
     int8_t field[kRows][kCols] = {};
@@ -191,8 +176,8 @@ struct Game {
     int highScore = 0;
     bool highScoreDirty = false;
 
-    // HUD font key (hashed by the SDK into a u64 for the core ABI)
-    const char* hudFontKey = kHudFont;
+    // HUD font key (precomputed u64 for the core ABI)
+    uint64_t hudFontKey = kHudFont;
 
     // Timing (in frames)
     int frame = 0;
@@ -201,7 +186,7 @@ struct Game {
     bool touchingGround = false;
 
     RNG rng;
-    InputEdge edge;
+    wasm96::Input::Pad pad;
 
     static uint32_t readU32LE(const uint8_t* p) {
         return (uint32_t)p[0]
@@ -226,25 +211,11 @@ struct Game {
     }
 
     void loadHighScore() {
-        // C++ SDK doesn't provide a helper for storage_load, but the raw import exists.
-        // Returned u64 packs (ptr << 32) | len, or 0 if missing.
-        uint64_t packed = wasm96_storage_load(wasm96_hash_key(kHighScoreKey));
-        if (packed == 0) {
-            highScore = 0;
-            return;
-        }
-
-        uint32_t ptr = (uint32_t)(packed >> 32);
-        uint32_t len = (uint32_t)(packed & 0xFFFFFFFFULL);
-
+        // Copied straight into this buffer by the host; no guest allocator involved.
+        uint8_t buf[4];
         int loaded = 0;
-        if (ptr != 0 && len >= 4) {
-            const uint8_t* p = (const uint8_t*)(uintptr_t)ptr;
-            loaded = (int)readU32LE(p);
-        }
-
-        if (ptr != 0 && len != 0) {
-            wasm96_storage_free((const uint8_t*)(uintptr_t)ptr, len);
+        if (wasm96::Storage::load(kHighScoreKey, buf) == 4) {
+            loaded = (int)readU32LE(buf);
         }
 
         if (loaded < 0) loaded = 0;
@@ -278,7 +249,6 @@ struct Game {
         lockDelay = 0;
         touchingGround = false;
         highScoreDirty = false;
-        edge.sync();
     }
 
     int fallIntervalFrames() const {
@@ -435,9 +405,11 @@ struct Game {
     }
 
     void tickGameplay() {
+        pad = wasm96::Input::pad(0);
+
         // Handle pause/restart
-        if (edge.pressed(WASM96_BUTTON_START)) paused = !paused;
-        if (edge.pressed(WASM96_BUTTON_SELECT)) {
+        if (pad.wasPressed(WASM96_BUTTON_START)) paused = !paused;
+        if (pad.wasPressed(WASM96_BUTTON_SELECT)) {
             reset((uint32_t)wasm96::System::millis());
             loadHighScore();
             return;
@@ -445,19 +417,19 @@ struct Game {
         if (paused || gameOver) return;
 
         // Movement
-        if (edge.pressed(WASM96_BUTTON_LEFT)) tryMove(-1, 0);
-        if (edge.pressed(WASM96_BUTTON_RIGHT)) tryMove(1, 0);
+        if (pad.wasPressed(WASM96_BUTTON_LEFT)) tryMove(-1, 0);
+        if (pad.wasPressed(WASM96_BUTTON_RIGHT)) tryMove(1, 0);
 
         // Rotation
-        if (edge.pressed(WASM96_BUTTON_A)) tryRotate(+1);
-        if (edge.pressed(WASM96_BUTTON_B)) tryRotate(-1);
+        if (pad.wasPressed(WASM96_BUTTON_A)) tryRotate(+1);
+        if (pad.wasPressed(WASM96_BUTTON_B)) tryRotate(-1);
 
         // Soft drop
-        bool soft = edge.down(WASM96_BUTTON_DOWN);
+        bool soft = pad.isDown(WASM96_BUTTON_DOWN);
 
         // Hard drop mapped to Y/X could be nice, but keep minimal:
         // Map L1 to hard drop if available.
-        if (edge.pressed(WASM96_BUTTON_L1)) hardDrop();
+        if (pad.wasPressed(WASM96_BUTTON_L1)) hardDrop();
 
         // Gravity
         int interval = fallIntervalFrames();
@@ -517,6 +489,8 @@ void drawCell(int fx, int fy, Color c) {
     wasm96::Graphics::rectOutline(x, y, kCell, kCell);
 }
 
+constexpr uint64_t kFieldList = "tetris/field"_k;
+
 void drawField() {
     // Field background area
     int w = kCols * kCell;
@@ -540,14 +514,45 @@ void drawField() {
     }
 }
 
+// Locked blocks live in a host-side tilemap (one tile per visible field cell), drawn with a
+// single call instead of three rect calls per cell. Tile 0 is empty, tile n is piece n-1.
+constexpr uint64_t kBlockTiles = "tetris/blocks"_k;
+wasm96::Tilemap gBoard("tetris/board"_k);
+
+// One kCell x kCell tile per piece color, side by side: fill plus the translucent
+// highlight border `drawCell` uses.
+uint8_t gTilesetRgba[7 * kCell * kCell * 4];
+
+void buildBlockTiles() {
+    constexpr int w = 7 * kCell;
+    for (int t = 0; t < 7; t++) {
+        Color c = kPieceColors[t];
+        for (int y = 0; y < kCell; y++) {
+            for (int x = 0; x < kCell; x++) {
+                bool edge = x == 0 || y == 0 || x == kCell - 1 || y == kCell - 1;
+                uint8_t* p = gTilesetRgba + ((y * w) + t * kCell + x) * 4;
+                p[0] = edge ? (uint8_t)(c.r + (255 - c.r) * 60 / 255) : c.r;
+                p[1] = edge ? (uint8_t)(c.g + (255 - c.g) * 60 / 255) : c.g;
+                p[2] = edge ? (uint8_t)(c.b + (255 - c.b) * 60 / 255) : c.b;
+                p[3] = 255;
+            }
+        }
+    }
+    wasm96::Graphics::imageRegister(kBlockTiles, w, kCell, gTilesetRgba, sizeof(gTilesetRgba));
+    gBoard.create(kBlockTiles, kCell, kCell, kCols, kRowsVisible);
+}
+
 void drawLockedBlocks() {
-    for (int r = 0; r < kRows; r++) {
+    // The host only re-renders the parts of the board whose tiles changed.
+    uint16_t tiles[kRowsVisible * kCols];
+    for (int r = 0; r < kRowsVisible; r++) {
         for (int c = 0; c < kCols; c++) {
-            int8_t v = g.field[r][c];
-            if (v < 0) continue;
-            drawCell(c, r, kPieceColors[(int)v]);
+            int8_t v = g.field[r + kRowsHidden][c];
+            tiles[r * kCols + c] = (uint16_t)(v + 1);
         }
     }
+    gBoard.setTiles(0, 0, kCols, kRowsVisible, tiles);
+    gBoard.draw(-kFieldX, -kFieldY);
 }
 
 void drawPieceGhost() {
@@ -616,8 +621,6 @@ void drawNextPiece() {
 }
 
 void drawHud() {
-    char buf[128];
-
     wasm96::Graphics::setColor(kText.r, kText.g, kText.b, kText.a);
 
     // Scoreboard panel background
@@ -643,63 +646,41 @@ void drawHud() {
         return dst;
     };
 
-    // Use the built-in Spleen font key (registered in setup at the desired size).
-    const char* font = kHudFont;
+    // The whole HUD is one text batch. Its strings rarely change, so the host reuses their layout
+    // from frame to frame. The batch only holds pointers: each number gets its own buffer.
+    auto label = [&](char* dst, const char* prefix, int v) -> const char* {
+        char* p = dst;
+        while (*prefix != '\0') *p++ = *prefix++;
+        writeInt(p, v);
+        return dst;
+    };
+    char score[32], high[32], lines[32], level[32];
 
+    static wasm96::TextBatch<> hud(kHudFont);
     wasm96::Graphics::setColor(kText.r, kText.g, kText.b, kText.a);
-    wasm96::Graphics::textKey(kHudX, kFieldY + 8, font, "SCOREBOARD");
-
-    // "SCORE: "
-    const char* s1 = "SCORE: ";
-    int i = 0;
-    for (; s1[i] != '\0'; i++) buf[i] = s1[i];
-    char* p = buf + i;
-    p = writeInt(p, g.score);
-    wasm96::Graphics::textKey(kHudX, kFieldY + 40, font, buf);
-
-    // "HIGH: "
-    const char* sH = "HIGH: ";
-    i = 0;
-    for (; sH[i] != '\0'; i++) buf[i] = sH[i];
-    p = buf + i;
-    p = writeInt(p, g.highScore);
-    wasm96::Graphics::textKey(kHudX, kFieldY + 64, font, buf);
-
-    // "LINES: "
-    const char* s2 = "LINES: ";
-    i = 0;
-    for (; s2[i] != '\0'; i++) buf[i] = s2[i];
-    p = buf + i;
-    p = writeInt(p, g.lines);
-    wasm96::Graphics::textKey(kHudX, kFieldY + 96, font, buf);
-
-    // "LEVEL: "
-    const char* s3 = "LEVEL: ";
-    i = 0;
-    for (; s3[i] != '\0'; i++) buf[i] = s3[i];
-    p = buf + i;
-    p = writeInt(p, g.level);
-    wasm96::Graphics::textKey(kHudX, kFieldY + 120, font, buf);
+    hud.add(kHudX, kFieldY + 8, "SCOREBOARD")
+        .add(kHudX, kFieldY + 40, label(score, "SCORE: ", g.score))
+        .add(kHudX, kFieldY + 64, label(high, "HIGH: ", g.highScore))
+        .add(kHudX, kFieldY + 96, label(lines, "LINES: ", g.lines))
+        .add(kHudX, kFieldY + 120, label(level, "LEVEL: ", g.level));
 
     // Controls
-    wasm96::Graphics::textKey(kHudX, kFieldY + 160, font, "Controls:");
-    wasm96::Graphics::textKey(kHudX, kFieldY + 180, font, "Left/Right: Move");
-    wasm96::Graphics::textKey(kHudX, kFieldY + 200, font, "Down: Soft drop");
-    wasm96::Graphics::textKey(kHudX, kFieldY + 220, font, "A/B: Rotate");
-    wasm96::Graphics::textKey(kHudX, kFieldY + 240, font, "L1: Hard drop");
-    wasm96::Graphics::textKey(kHudX, kFieldY + 260, font, "Start: Pause");
-    wasm96::Graphics::textKey(kHudX, kFieldY + 280, font, "Select: Restart");
+    hud.add(kHudX, kFieldY + 160, "Controls:")
+        .add(kHudX, kFieldY + 180, "Left/Right: Move")
+        .add(kHudX, kFieldY + 200, "Down: Soft drop")
+        .add(kHudX, kFieldY + 220, "A/B: Rotate")
+        .add(kHudX, kFieldY + 240, "L1: Hard drop")
+        .add(kHudX, kFieldY + 260, "Start: Pause")
+        .add(kHudX, kFieldY + 280, "Select: Restart");
 
     if (g.paused) {
-        wasm96::Graphics::setColor(255, 255, 255, 255);
-        wasm96::Graphics::textKey(kFieldX, kFieldY + 200, font, "PAUSED");
+        hud.add(kFieldX, kFieldY + 200, "PAUSED", 0xFFFFFFFFu);
     }
     if (g.gameOver) {
-        wasm96::Graphics::setColor(255, 120, 120, 255);
-        wasm96::Graphics::textKey(kFieldX, kFieldY + 180, font, "GAME OVER");
-        wasm96::Graphics::setColor(kText.r, kText.g, kText.b, kText.a);
-        wasm96::Graphics::textKey(kFieldX, kFieldY + 204, font, "Press Select to restart");
+        hud.add(kFieldX, kFieldY + 180, "GAME OVER", 0xFFFF7878u);
+        hud.add(kFieldX, kFieldY + 204, "Press Select to restart");
     }
+    hud.flush();
 }
 
 } // namespace
@@ -712,6 +693,15 @@ extern "C" void setup() {
     // Text rendering depends on a registered font key.
     wasm96::Graphics::fontRegisterSpleen(kHudFont, kHudFontSize);
 
+    buildBlockTiles();
+
+    // The field backdrop, border and grid never change: record them once and replay the list
+    // with one call per frame.
+    {
+        wasm96::ScopedList field(kFieldList);
+        drawField();
+    }
+
     // Seed from system millis if available
     g.reset((uint32_t)wasm96::System::millis());
     g.loadHighScore();
@@ -730,7 +720,7 @@ extern "C" void update() {
 extern "C" void draw() {
     wasm96::Graphics::background(kBg.r, kBg.g, kBg.b);
 
-    drawField();
+    wasm96::Graphics::listDraw(kFieldList, 0, 0);
     drawLockedBlocks();
     drawPieceGhost();
     drawActivePiece();
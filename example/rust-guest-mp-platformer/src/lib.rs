@@ -76,7 +76,6 @@ struct Player {
     vx: i32,
     vy: i32,
     on_ground: bool,
-    last_jump_down: bool,
 }
 
 impl Player {
@@ -87,7 +86,6 @@ impl Player {
             vx: 0,
             vy: 0,
             on_ground: false,
-            last_jump_down: false,
         }
     }
 
@@ -143,19 +141,6 @@ static PLATFORMS: [RectI; MAX_PLATFORMS] = [
     RectI::new(760, 170, 80, 8),
 ];
 
-fn read_left(port: u32) -> bool {
-    input::is_button_down(port, Button::Left)
-}
-fn read_right(port: u32) -> bool {
-    input::is_button_down(port, Button::Right)
-}
-fn read_jump(port: u32) -> bool {
-    input::is_button_down(port, Button::A)
-}
-fn read_respawn(port: u32) -> bool {
-    input::is_button_down(port, Button::Start)
-}
-
 fn world_bounds() -> RectI {
     // A simple world box (x from 0..900, y from 0..240)
     RectI::new(0, 0, 900, H)
@@ -235,8 +220,10 @@ fn apply_physics(p: Player) -> Player {
 fn update_player(port: u32, p: Player) -> Player {
     let mut p = p;
 
-    let l = read_left(port);
-    let r = read_right(port);
+    // One snapshot per port per frame; the host tracks press edges.
+    let pad = input::pad(port);
+    let l = pad.down(Button::Left);
+    let r = pad.down(Button::Right);
 
     p.vx = if l && !r {
         -MOVE_SPEED
@@ -246,14 +233,10 @@ fn update_player(port: u32, p: Player) -> Player {
         0
     };
 
-    let jump_down = read_jump(port);
-    let jump_pressed = jump_down && !p.last_jump_down;
-
-    if jump_pressed && p.on_ground {
+    if pad.pressed(Button::A) && p.on_ground {
         p.vy = JUMP_VEL;
         p.on_ground = false;
     }
-    p.last_jump_down = jump_down;
 
     apply_physics(p)
 }
@@ -294,7 +277,7 @@ fn try_win(mut s: State) -> State {
 }
 
 fn respawn_if_requested(mut s: State) -> State {
-    let wants_respawn = read_respawn(0) || read_respawn(1);
+    let wants_respawn = input::pad(0).down(Button::Start) || input::pad(1).down(Button::Start);
     if !wants_respawn {
         return s;
     }
@@ -438,10 +421,14 @@ pub extern "C" fn update() {
         STATE = s;
     }
 
-    // Libretro audio: push silence each frame.
-    // 44100 Hz / 60 FPS = 735 samples per frame. Stereo => 1470 i16 samples.
-    let silence = [0i16; 1470];
-    audio::push_samples(&silence);
+    // Libretro audio: keep two video frames of silence queued.
+    // 44100 Hz / 60 FPS = 735 stereo frames per video frame (1470 i16 samples).
+    const TARGET_FRAMES: u32 = 2 * 735;
+    let queued = audio::queued_frames();
+    if queued < TARGET_FRAMES {
+        let silence = [0i16; 2 * TARGET_FRAMES as usize];
+        audio::push_samples(&silence[..2 * (TARGET_FRAMES - queued) as usize]);
+    }
 }
 
 #[unsafe(no_mangle)]
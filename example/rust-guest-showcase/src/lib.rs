@@ -46,6 +46,9 @@ pub extern "C" fn setup() {
     let _ = graphics::gif_register(GIF_KEY, GIF_DATA);
     let _ = graphics::png_register(PNG_KEY, PNG_DATA);
     let _ = graphics::font_register_ttf(FONT_KEY, TTF_DATA);
+
+    // Render the SVG once at the size `draw` uses; every frame after that is a cached blit.
+    let _ = graphics::svg_prerender(SVG_KEY, 320, 320);
 }
 
 #[unsafe(no_mangle)]
@@ -68,6 +71,18 @@ pub extern "C" fn draw() {
     // Draw keyed PNG (registered in setup)
     graphics::png_draw_key(PNG_KEY, 100, 100);
 
+    // Draw a row of scaled, tinted and flipped copies of the keyed PNG with one host call
+    const TINTS: [u32; 4] = [Sprite::TINT_NONE, 0xFFFF8080, 0xFF80FF80, 0x808080FF];
+    let mut sprites = [Sprite::new(0, 0, 0, 0, 0, 0); 8];
+    for (i, sprite) in sprites.iter_mut().enumerate() {
+        let flags = if i % 2 == 1 { Sprite::FLIP_X } else { 0 };
+        *sprite = Sprite::new(40 + i as i32 * 72, 700, 0, 0, 0, 0)
+            .scaled(64, 64)
+            .flipped(flags)
+            .tinted(TINTS[i % TINTS.len()]);
+    }
+    graphics::sprite_batch(PNG_KEY, &sprites);
+
     // Draw raw PNG bytes directly (one-shot)
     graphics::image_png(250, 100, PNG_DATA);
 
@@ -198,7 +198,7 @@ fn buildGridLinesMeshes(half_extent: f32, y: f32, step: f32) void {
     // - "grid_line_x": runs along X (varying X, constant Z)
     // - "grid_line_z": runs along Z (varying Z, constant X)
     //
-    // We draw many instances with meshDraw translations to form a grid.
+    // `drawGridLines` draws many instances of each with meshDrawInstanced to form a grid.
     const thickness: f32 = 0.03;
 
     // Line along X at z=0 (thin in Z)
@@ -224,6 +224,40 @@ fn buildGridLinesMeshes(half_extent: f32, y: f32, step: f32) void {
     _ = step;
 }
 
+/// Draw one family of parallel grid lines with three instanced calls (axis, major, minor)
+/// instead of one `meshDraw` per line.
+fn drawGridLines(key: []const u8, comptime along_x: bool, half_extent: f32, step: f32, axis_r: u8, axis_g: u8, axis_b: u8) void {
+    const max_lines = 128;
+    var major: [max_lines]wasm96.Transform = undefined;
+    var minor: [max_lines]wasm96.Transform = undefined;
+    var n_major: usize = 0;
+    var n_minor: usize = 0;
+
+    var i: i32 = @as(i32, @intFromFloat(-half_extent / step));
+    const i_max: i32 = @as(i32, @intFromFloat(half_extent / step));
+    while (i <= i_max) : (i += 1) {
+        if (i == 0) continue;
+        const offset = @as(f32, @floatFromInt(i)) * step;
+        const t: wasm96.Transform = if (along_x) .{ .z = offset } else .{ .x = offset };
+        if (@rem(@abs(i), 5) == 0) {
+            if (n_major < max_lines) {
+                major[n_major] = t;
+                n_major += 1;
+            }
+        } else if (n_minor < max_lines) {
+            minor[n_minor] = t;
+            n_minor += 1;
+        }
+    }
+
+    wasm96.graphics.setColor(axis_r, axis_g, axis_b, 255);
+    wasm96.graphics.meshDrawInstanced(key, &[_]wasm96.Transform{.{}});
+    wasm96.graphics.setColor(55, 60, 70, 255);
+    wasm96.graphics.meshDrawInstanced(key, major[0..n_major]);
+    wasm96.graphics.setColor(40, 44, 52, 255);
+    wasm96.graphics.meshDrawInstanced(key, minor[0..n_minor]);
+}
+
 // ---- Game loop ----
 
 fn dtSeconds(now_ms: u64, last_ms: *u64) f32 {
@@ -471,37 +505,8 @@ export fn draw() void {
     const half_extent: f32 = 80.0;
     const step: f32 = 2.0;
 
-    var i: i32 = @as(i32, @intFromFloat(-half_extent / step));
-    const i_max: i32 = @as(i32, @intFromFloat(half_extent / step));
-    while (i <= i_max) : (i += 1) {
-        const z = @as(f32, @floatFromInt(i)) * step;
-        const major = (@rem(@abs(i), 5) == 0);
-
-        if (z == 0.0) {
-            wasm96.graphics.setColor(70, 120, 220, 255);
-        } else if (major) {
-            wasm96.graphics.setColor(55, 60, 70, 255);
-        } else {
-            wasm96.graphics.setColor(40, 44, 52, 255);
-        }
-        wasm96.graphics.meshDraw("grid_line_x", 0.0, 0.0, z, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
-    }
-
-    var j: i32 = @as(i32, @intFromFloat(-half_extent / step));
-    const j_max: i32 = @as(i32, @intFromFloat(half_extent / step));
-    while (j <= j_max) : (j += 1) {
-        const x = @as(f32, @floatFromInt(j)) * step;
-        const major = (@rem(@abs(j), 5) == 0);
-
-        if (x == 0.0) {
-            wasm96.graphics.setColor(220, 90, 90, 255);
-        } else if (major) {
-            wasm96.graphics.setColor(55, 60, 70, 255);
-        } else {
-            wasm96.graphics.setColor(40, 44, 52, 255);
-        }
-        wasm96.graphics.meshDraw("grid_line_z", x, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0, 1.0, 1.0);
-    }
+    drawGridLines("grid_line_x", true, half_extent, step, 70, 120, 220);
+    drawGridLines("grid_line_z", false, half_extent, step, 220, 90, 90);
 
     // Birds (scene props)
     // If they load, place them near the origin so you can immediately see them while rolling.
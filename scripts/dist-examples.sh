@@ -164,6 +164,12 @@ build_c() {
   log "building C example"
   (cd "example/c-guest" && make clean >/dev/null 2>&1 || true && make)
   copy_wasm_as_w96 "example/c-guest/wasm96-example.wasm" "c-guest"
+
+  if [ -d "example/c-guest-plasma" ]; then
+    log "building C plasma example"
+    (cd "example/c-guest-plasma" && make clean >/dev/null 2>&1 || true && make)
+    copy_wasm_as_w96 "example/c-guest-plasma/wasm96-example.wasm" "c-guest-plasma"
+  fi
 }
 
 build_cpp() {
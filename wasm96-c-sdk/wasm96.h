@@ -57,12 +57,165 @@ typedef enum {
     WASM96_BUTTON_R3 = 15
 } wasm96_button_t;
 
+// Joypad ports snapshotted by the host each frame.
+#define WASM96_MAX_PORTS 4u
+
+// Bit for `btn` in the masks returned by `wasm96_input_get_buttons/pressed/released`.
+#define WASM96_BUTTON_MASK(btn) (1u << (uint32_t)(btn))
+
+// One port's joypad state for the current frame (see `wasm96_input_pad`).
+typedef struct {
+    uint32_t held;     // buttons down this frame
+    uint32_t pressed;  // went down since last frame
+    uint32_t released; // went up since last frame
+} wasm96_pad_t;
+
 // Text size dimensions.
 typedef struct {
     uint32_t width;
     uint32_t height;
 } wasm96_text_size_t;
 
+// Screen rectangle (see `wasm96_graphics_get_damage`).
+typedef struct {
+    uint32_t x;
+    uint32_t y;
+    uint32_t w;
+    uint32_t h;
+} wasm96_rect_t;
+
+// One instance for `wasm96_graphics_sprite_batch` (10 x 32-bit words, layout fixed by the ABI).
+//   w/h == 0: draw at the source size; otherwise scale (nearest-neighbor).
+//   src_w/src_h == 0: the whole image; otherwise a sub-rect (sprite sheets).
+//   tint: 0xAARRGGBB multiplied into each pixel (WASM96_TINT_NONE leaves it unchanged).
+typedef struct {
+    int32_t x;
+    int32_t y;
+    uint32_t w;
+    uint32_t h;
+    uint32_t src_x;
+    uint32_t src_y;
+    uint32_t src_w;
+    uint32_t src_h;
+    uint32_t flags; // WASM96_SPRITE_FLIP_*
+    uint32_t tint;
+} wasm96_sprite_t;
+
+#define WASM96_SPRITE_FLIP_X 1u
+#define WASM96_SPRITE_FLIP_Y 2u
+#define WASM96_TINT_NONE 0xFFFFFFFFu
+
+// One string for `wasm96_graphics_text_batch` (6 x 32-bit words on wasm32, layout fixed by the ABI).
+//   text/text_len: UTF-8 bytes (need not be NUL-terminated).
+//   color: 0xAARRGGBB, or WASM96_TEXT_COLOR_CURRENT for the current draw color.
+//   px: TTF/OTF size in pixels (0 = default 16); bitmap fonts ignore it.
+typedef struct {
+    int32_t x;
+    int32_t y;
+    const char* text;
+    uint32_t text_len;
+    uint32_t color;
+    uint32_t px;
+} wasm96_text_item_t;
+
+#define WASM96_TEXT_COLOR_CURRENT 0u
+
+// One instance for `wasm96_graphics_mesh_draw_instanced` (9 floats, layout fixed by the ABI):
+// translation, Euler rotation in radians, scale; the same order as `wasm96_graphics_mesh_draw`.
+typedef struct {
+    float x, y, z;
+    float rx, ry, rz;
+    float sx, sy, sz;
+} wasm96_transform_t;
+
+// Vertex format for `wasm96_graphics_mesh_create_ex`: OR one POSITION, one UV and one NORMAL
+// encoding. Attributes are packed in that order with no gaps; the vertex size is the sum.
+// 0 is the 32-byte float layout of `wasm96_graphics_mesh_create`.
+typedef enum {
+    WASM96_POSITION_F32 = 0,        // float x3 (12 bytes)
+    WASM96_POSITION_F16 = 1,        // half x3 + 1 padding half (8 bytes)
+    WASM96_POSITION_SNORM16 = 2,    // int16 x3 + 1 padding, -32767..32767 -> -1..1 (8 bytes)
+    WASM96_UV_F32 = 0 << 2,         // float x2 (8 bytes)
+    WASM96_UV_UNORM16 = 1 << 2,     // uint16 x2, 0..65535 -> 0..1 (4 bytes)
+    WASM96_UV_NONE = 2 << 2,        // no UVs (0 bytes)
+    WASM96_NORMAL_F32 = 0 << 4,     // float x3 (12 bytes)
+    WASM96_NORMAL_OCT16 = 1 << 4,   // octahedral-encoded int16 x2 (4 bytes, see wasm96_oct_encode16)
+} wasm96_vertex_format_t;
+
+typedef enum {
+    WASM96_INDEX_U32 = 0,
+    WASM96_INDEX_U16 = 1,
+} wasm96_index_type_t;
+
+// Mesh draws this frame (see `wasm96_graphics_get_mesh_stats`).
+typedef struct {
+    uint32_t submitted;
+    uint32_t culled; // outside the camera frustum
+} wasm96_mesh_stats_t;
+
+// Async asset kinds (`wasm96_asset_load`); each matches a synchronous `*_register` call.
+typedef enum {
+    WASM96_ASSET_PNG = 0,
+    WASM96_ASSET_JPEG = 1,
+    WASM96_ASSET_SVG = 2,
+    WASM96_ASSET_GIF = 3,
+    WASM96_ASSET_FONT_TTF = 4,
+    WASM96_ASSET_MESH_OBJ = 5
+} wasm96_asset_kind_t;
+
+// Async asset status (`wasm96_asset_status`).
+typedef enum {
+    WASM96_ASSET_NONE = 0,
+    WASM96_ASSET_PENDING = 1,
+    WASM96_ASSET_READY = 2,
+    WASM96_ASSET_FAILED = 3
+} wasm96_asset_status_t;
+
+// Encoded audio formats for `wasm96_audio_voice_play`.
+typedef enum {
+    WASM96_AUDIO_WAV = 0,
+    WASM96_AUDIO_QOA = 1,
+    WASM96_AUDIO_XM = 2
+} wasm96_audio_format_t;
+
+// Q8.8 voice volume for 1.0.
+#define WASM96_VOLUME_UNITY 256u
+
+// Returned by `wasm96_storage_size` / `wasm96_storage_read` when no value is stored.
+#define WASM96_STORAGE_NOT_FOUND 0xFFFFFFFFu
+
+// Host profile of the last finished frame (`wasm96_system_stats`); times in nanoseconds.
+enum {
+    WASM96_PHASE_INPUT = 0,
+    WASM96_PHASE_ASSETS = 1,
+    WASM96_PHASE_UPDATE = 2,
+    WASM96_PHASE_DRAW = 3,
+    WASM96_PHASE_PRESENT = 4,
+    WASM96_PHASE_AUDIO = 5,
+    WASM96_PHASE_COUNT = 6
+};
+
+typedef struct {
+    uint32_t version;
+    uint32_t entry_count; // wasm96_import_stats_t entries that follow
+    uint64_t frame_index;
+    uint64_t frame_ns;
+    uint64_t phase_ns[WASM96_PHASE_COUNT];
+    uint64_t host_ns;
+    uint32_t host_calls;
+    uint32_t lock_count;
+    uint64_t lock_wait_ns;
+    uint64_t bytes_in;  // guest -> host copies
+    uint64_t bytes_out; // host -> guest copies
+} wasm96_frame_stats_t;
+
+typedef struct {
+    char name[32]; // import name without the `wasm96_` prefix, zero-padded
+    uint32_t calls;
+    uint32_t reserved;
+    uint64_t ns;
+} wasm96_import_stats_t;
+
 // Low-level raw ABI imports.
 extern void wasm96_graphics_set_size(uint32_t width, uint32_t height) WASM96_WASM_IMPORT("env", "wasm96_graphics_set_size");
 extern void wasm96_graphics_set_color(uint32_t r, uint32_t g, uint32_t b, uint32_t a) WASM96_WASM_IMPORT("env", "wasm96_graphics_set_color");
@@ -73,7 +226,14 @@ extern void wasm96_graphics_rect(int32_t x, int32_t y, uint32_t w, uint32_t h) W
 extern void wasm96_graphics_rect_outline(int32_t x, int32_t y, uint32_t w, uint32_t h) WASM96_WASM_IMPORT("env", "wasm96_graphics_rect_outline");
 extern void wasm96_graphics_circle(int32_t x, int32_t y, uint32_t r) WASM96_WASM_IMPORT("env", "wasm96_graphics_circle");
 extern void wasm96_graphics_circle_outline(int32_t x, int32_t y, uint32_t r) WASM96_WASM_IMPORT("env", "wasm96_graphics_circle_outline");
+// Clear one rectangle (the framebuffer is otherwise retained between frames).
+extern void wasm96_graphics_clear_rect(int32_t x, int32_t y, uint32_t w, uint32_t h, uint32_t r, uint32_t g, uint32_t b) WASM96_WASM_IMPORT("env", "wasm96_graphics_clear_rect");
+// Pixels drawn since the last present, packed `x << 48 | y << 32 | w << 16 | h` (0 = none).
+extern uint64_t wasm96_graphics_damage(void) WASM96_WASM_IMPORT("env", "wasm96_graphics_damage");
+extern uint32_t wasm96_graphics_submit(const uint32_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_graphics_submit");
 extern void wasm96_graphics_image(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint8_t* data, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_graphics_image");
+// Present `w*h` pixels straight from guest memory (format 0 = XRGB8888). `w == 0` unbinds.
+extern uint32_t wasm96_graphics_bind_framebuffer(const uint32_t* ptr, uint32_t w, uint32_t h, uint32_t format) WASM96_WASM_IMPORT("env", "wasm96_graphics_bind_framebuffer");
 extern void wasm96_graphics_image_png(int32_t x, int32_t y, const uint8_t* data, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_graphics_image_png");
 extern void wasm96_graphics_image_jpeg(int32_t x, int32_t y, const uint8_t* data, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_graphics_image_jpeg");
 extern void wasm96_graphics_triangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3) WASM96_WASM_IMPORT("env", "wasm96_graphics_triangle");
@@ -90,7 +250,11 @@ extern void wasm96_graphics_camera_perspective(float fovy, float aspect, float n
 extern uint32_t wasm96_graphics_mesh_create(uint64_t key, const float* v_ptr, uint32_t v_len, const uint32_t* i_ptr, uint32_t i_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_create");
 extern uint32_t wasm96_graphics_mesh_create_obj(uint64_t key, const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_create_obj");
 extern uint32_t wasm96_graphics_mesh_create_stl(uint64_t key, const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_create_stl");
+extern uint32_t wasm96_graphics_mesh_create_ex(uint64_t key, uint32_t format, const void* v_ptr, uint32_t v_len, const void* i_ptr, uint32_t i_len, uint32_t index_type) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_create_ex");
+extern uint32_t wasm96_graphics_mesh_create_blob(uint64_t key, const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_create_blob");
 extern void wasm96_graphics_mesh_draw(uint64_t key, float x, float y, float z, float rx, float ry, float rz, float sx, float sy, float sz) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_draw");
+extern void wasm96_graphics_mesh_draw_instanced(uint64_t key, const float* transforms, uint32_t count) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_draw_instanced");
+extern uint64_t wasm96_graphics_mesh_stats(void) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_stats");
 extern uint32_t wasm96_graphics_mesh_set_texture(uint64_t mesh_key, uint64_t image_key) WASM96_WASM_IMPORT("env", "wasm96_graphics_mesh_set_texture");
 
 // Materials / textures (OBJ+MTL workflows)
@@ -110,6 +274,10 @@ extern uint32_t wasm96_graphics_mtl_register_texture(
 extern uint32_t wasm96_graphics_svg_register(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_svg_register");
 extern void wasm96_graphics_svg_draw_key(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) WASM96_WASM_IMPORT("env", "wasm96_graphics_svg_draw_key");
 extern void wasm96_graphics_svg_unregister(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_graphics_svg_unregister");
+// Rendered SVGs are cached per (key, w, h). Prerender in setup() so the first draw is a blit.
+extern uint32_t wasm96_graphics_svg_prerender(uint64_t key, uint32_t w, uint32_t h) WASM96_WASM_IMPORT("env", "wasm96_graphics_svg_prerender");
+extern void wasm96_graphics_svg_evict(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_graphics_svg_evict");
+extern void wasm96_graphics_svg_set_cache_budget(uint32_t bytes) WASM96_WASM_IMPORT("env", "wasm96_graphics_svg_set_cache_budget");
 
 extern uint32_t wasm96_graphics_gif_register(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_gif_register");
 extern void wasm96_graphics_gif_draw_key(uint64_t key, int32_t x, int32_t y) WASM96_WASM_IMPORT("env", "wasm96_graphics_gif_draw_key");
@@ -126,15 +294,55 @@ extern void wasm96_graphics_jpeg_draw_key(uint64_t key, int32_t x, int32_t y) WA
 extern void wasm96_graphics_jpeg_draw_key_scaled(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) WASM96_WASM_IMPORT("env", "wasm96_graphics_jpeg_draw_key_scaled");
 extern void wasm96_graphics_jpeg_unregister(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_graphics_jpeg_unregister");
 
+// Register `w*h` raw RGBA8888 pixels under a key (drawable like a keyed PNG, usable as a tileset).
+extern uint32_t wasm96_graphics_image_register(uint64_t key, uint32_t w, uint32_t h, const uint8_t* rgba, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_graphics_image_register");
+
+// Draw `count` instances of one keyed PNG/JPEG. Returns the number drawn (0 if the key is unknown).
+extern uint32_t wasm96_graphics_sprite_batch(uint64_t image_key, const wasm96_sprite_t* sprites, uint32_t count) WASM96_WASM_IMPORT("env", "wasm96_graphics_sprite_batch");
+
+// Tilemaps: tile 0 is empty, tile n is cell n-1 of the tileset (a keyed image, row-major cells).
+// The host caches rendered chunks of 16x16 tiles and re-renders only chunks whose tiles change.
+extern uint32_t wasm96_tilemap_create(uint64_t key, uint64_t tileset_key, uint32_t tile_w, uint32_t tile_h, uint32_t map_w, uint32_t map_h) WASM96_WASM_IMPORT("env", "wasm96_tilemap_create");
+// Copy a `w*h` block of tiles (row-major). Returns the number of tiles that changed.
+extern uint32_t wasm96_tilemap_set_tiles(uint64_t key, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint16_t* tiles) WASM96_WASM_IMPORT("env", "wasm96_tilemap_set_tiles");
+extern void wasm96_tilemap_set_tile(uint64_t key, uint32_t x, uint32_t y, uint32_t tile) WASM96_WASM_IMPORT("env", "wasm96_tilemap_set_tile");
+// Draw with map pixel (scroll_x, scroll_y) at screen (0, 0); negative values move the map right/down.
+extern void wasm96_tilemap_draw(uint64_t key, int32_t scroll_x, int32_t scroll_y) WASM96_WASM_IMPORT("env", "wasm96_tilemap_draw");
+extern void wasm96_tilemap_destroy(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_tilemap_destroy");
+
+// Retained draw lists: primitives issued between begin and end are captured on the host (with
+// their colors) instead of drawn, then replayed with one call. Bitmap-font text is captured;
+// TTF/OTF text, images and sprites are not.
+extern void wasm96_graphics_list_begin(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_graphics_list_begin");
+// Returns the number of primitives captured.
+extern uint32_t wasm96_graphics_list_end(void) WASM96_WASM_IMPORT("env", "wasm96_graphics_list_end");
+extern void wasm96_graphics_list_draw(uint64_t key, int32_t dx, int32_t dy) WASM96_WASM_IMPORT("env", "wasm96_graphics_list_draw");
+extern void wasm96_graphics_list_destroy(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_graphics_list_destroy");
+
 extern uint32_t wasm96_graphics_font_register_ttf(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_font_register_ttf");
 extern uint32_t wasm96_graphics_font_register_bdf(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_font_register_bdf");
 extern uint32_t wasm96_graphics_font_register_spleen(uint64_t key, uint32_t size) WASM96_WASM_IMPORT("env", "wasm96_graphics_font_register_spleen");
 extern void wasm96_graphics_font_unregister(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_graphics_font_unregister");
 extern void wasm96_graphics_text_key(int32_t x, int32_t y, uint64_t font_key, const uint8_t* text_ptr, uint32_t text_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_text_key");
 extern uint64_t wasm96_graphics_text_measure_key(uint64_t font_key, const uint8_t* text_ptr, uint32_t text_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_text_measure_key");
+// Sized variants: `px` is the TTF/OTF size in pixels (0 = default 16). Bitmap fonts ignore it.
+extern void wasm96_graphics_text_key_sized(int32_t x, int32_t y, uint64_t font_key, uint32_t px, const uint8_t* text_ptr, uint32_t text_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_text_key_sized");
+extern uint64_t wasm96_graphics_text_measure_key_sized(uint64_t font_key, uint32_t px, const uint8_t* text_ptr, uint32_t text_len) WASM96_WASM_IMPORT("env", "wasm96_graphics_text_measure_key_sized");
+// Draw `count` strings in one font with one call. Returns the number drawn.
+extern uint32_t wasm96_graphics_text_batch(uint64_t font_key, const wasm96_text_item_t* items, uint32_t count) WASM96_WASM_IMPORT("env", "wasm96_graphics_text_batch");
+
+// Async assets: the bytes are copied and decoded on host worker threads. Returns 1 if queued.
+extern uint32_t wasm96_asset_load(uint32_t kind, uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT("env", "wasm96_asset_load");
+// Returns a `wasm96_asset_status_t`.
+extern uint32_t wasm96_asset_status(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_asset_status");
+// Publishes finished loads, waiting up to `timeout_ms` (0 = poll). Returns loads still pending.
+extern uint32_t wasm96_asset_wait_all(uint32_t timeout_ms) WASM96_WASM_IMPORT("env", "wasm96_asset_wait_all");
 
 // Input
 extern uint32_t wasm96_input_is_button_down(uint32_t port, uint32_t btn) WASM96_WASM_IMPORT("env", "wasm96_input_is_button_down");
+extern uint32_t wasm96_input_get_buttons(uint32_t port) WASM96_WASM_IMPORT("env", "wasm96_input_get_buttons");
+extern uint32_t wasm96_input_get_pressed(uint32_t port) WASM96_WASM_IMPORT("env", "wasm96_input_get_pressed");
+extern uint32_t wasm96_input_get_released(uint32_t port) WASM96_WASM_IMPORT("env", "wasm96_input_get_released");
 extern uint32_t wasm96_input_is_key_down(uint32_t key) WASM96_WASM_IMPORT("env", "wasm96_input_is_key_down");
 extern int32_t wasm96_input_get_mouse_x(void) WASM96_WASM_IMPORT("env", "wasm96_input_get_mouse_x");
 extern int32_t wasm96_input_get_mouse_y(void) WASM96_WASM_IMPORT("env", "wasm96_input_get_mouse_y");
@@ -143,25 +351,48 @@ extern uint32_t wasm96_input_is_mouse_down(uint32_t btn) WASM96_WASM_IMPORT("env
 // Audio
 extern uint32_t wasm96_audio_init(uint32_t sample_rate) WASM96_WASM_IMPORT("env", "wasm96_audio_init");
 extern void wasm96_audio_push_samples(const int16_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_audio_push_samples");
+// Stereo frames pushed but not yet played; top up to a target (overflowing pushes are dropped).
+extern uint32_t wasm96_audio_queued_frames(void) WASM96_WASM_IMPORT("env", "wasm96_audio_queued_frames");
 extern void wasm96_audio_play_wav(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_audio_play_wav");
 extern void wasm96_audio_play_qoa(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_audio_play_qoa");
 extern void wasm96_audio_play_xm(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_audio_play_xm");
+// Voices: play returns a handle (0 on decode failure); the source is resampled to the output rate.
+extern uint32_t wasm96_audio_voice_play(uint32_t format, const uint8_t* ptr, uint32_t len, uint32_t loop) WASM96_WASM_IMPORT("env", "wasm96_audio_voice_play");
+extern void wasm96_audio_voice_set_volume(uint32_t id, uint32_t volume_q8_8) WASM96_WASM_IMPORT("env", "wasm96_audio_voice_set_volume");
+extern void wasm96_audio_voice_set_pan(uint32_t id, int32_t pan) WASM96_WASM_IMPORT("env", "wasm96_audio_voice_set_pan");
+extern void wasm96_audio_voice_set_loop(uint32_t id, uint32_t loop) WASM96_WASM_IMPORT("env", "wasm96_audio_voice_set_loop");
+extern void wasm96_audio_voice_stop(uint32_t id) WASM96_WASM_IMPORT("env", "wasm96_audio_voice_stop");
+extern uint32_t wasm96_audio_voice_is_playing(uint32_t id) WASM96_WASM_IMPORT("env", "wasm96_audio_voice_is_playing");
 
 // Storage
 extern void wasm96_storage_save(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT("env", "wasm96_storage_save");
 extern uint64_t wasm96_storage_load(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_storage_load");
 extern void wasm96_storage_free(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_storage_free");
+extern uint32_t wasm96_storage_size(uint64_t key) WASM96_WASM_IMPORT("env", "wasm96_storage_size");
+extern uint32_t wasm96_storage_read(uint64_t key, uint8_t* dst_ptr, uint32_t dst_cap, uint32_t offset) WASM96_WASM_IMPORT("env", "wasm96_storage_read");
+extern void wasm96_storage_write(uint64_t key, uint32_t offset, const uint8_t* src_ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_storage_write");
 
 // System
 extern void wasm96_system_log(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_system_log");
 extern uint64_t wasm96_system_millis(void) WASM96_WASM_IMPORT("env", "wasm96_system_millis");
+// Fills `len` bytes with a wasm96_frame_stats_t followed by import entries (slowest first, as many as
+// fit); returns the size of the full report. The first call turns profiling on.
+extern uint32_t wasm96_system_stats(uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT("env", "wasm96_system_stats");
 
-// Hash function
+// Hash function (64-bit FNV-1a over the key bytes, same as the Rust/Zig SDKs).
+//
+// Keyed helpers come in two flavors: `*_str(const char* key, ...)` hashes on every call,
+// `*_k(uint64_t key, ...)` takes a precomputed key. Hash once (e.g. in `setup()`) into a
+// static and use the `_k` variants in per-frame code:
+//
+//   static uint64_t k_font;
+//   void setup(void) { k_font = wasm96_hash_key("ui"); }
+//   void draw(void) { wasm96_graphics_text_key_k(8, 8, k_font, "Score"); }
 static inline uint64_t wasm96_hash_key(const char* key) {
     uint64_t hash = 0xcbf29ce484222325ULL;
     uint32_t i = 0;
     while (key[i] != '\0') {
-        hash ^= (uint64_t)key[i];
+        hash ^= (uint64_t)(uint8_t)key[i];
         hash *= 0x100000001b3ULL;
         i++;
     }
@@ -177,32 +408,146 @@ static inline void wasm96_graphics_background_rgb(uint8_t r, uint8_t g, uint8_t
     wasm96_graphics_background((uint32_t)r, (uint32_t)g, (uint32_t)b);
 }
 
+// Partial redraw: skip `wasm96_graphics_background` and repaint only what changed. Frames where
+// nothing is drawn are not re-sent to the frontend at all.
+static inline void wasm96_graphics_clear_rect_rgb(int32_t x, int32_t y, uint32_t w, uint32_t h, uint8_t r, uint8_t g, uint8_t b) {
+    wasm96_graphics_clear_rect(x, y, w, h, (uint32_t)r, (uint32_t)g, (uint32_t)b);
+}
+
+static inline wasm96_rect_t wasm96_graphics_get_damage(void) {
+    uint64_t packed = wasm96_graphics_damage();
+    wasm96_rect_t r;
+    r.x = (uint32_t)(packed >> 48) & 0xFFFFu;
+    r.y = (uint32_t)(packed >> 32) & 0xFFFFu;
+    r.w = (uint32_t)(packed >> 16) & 0xFFFFu;
+    r.h = (uint32_t)packed & 0xFFFFu;
+    return r;
+}
+
 static inline bool wasm96_graphics_mesh_create_str(const char* key, const float* vertices, uint32_t v_len, const uint32_t* indices, uint32_t i_len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_mesh_create(k, vertices, v_len, indices, i_len) != 0;
 }
 
+static inline bool wasm96_graphics_mesh_create_k(uint64_t key, const float* vertices, uint32_t v_len, const uint32_t* indices, uint32_t i_len) {
+    return wasm96_graphics_mesh_create(key, vertices, v_len, indices, i_len) != 0;
+}
+
 static inline bool wasm96_graphics_mesh_create_obj_str(const char* key, const uint8_t* data, uint32_t len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_mesh_create_obj(k, data, len) != 0;
 }
 
+static inline bool wasm96_graphics_mesh_create_obj_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_mesh_create_obj(key, data, len) != 0;
+}
+
+// Compact meshes (`wasm96_graphics_mesh_create_ex`): `v_len` vertices laid out per `format`,
+// `i_len` indices of `index_type`.
+static inline bool wasm96_graphics_mesh_create_ex_str(const char* key, uint32_t format, const void* vertices, uint32_t v_len, const void* indices, uint32_t i_len, uint32_t index_type) {
+    return wasm96_graphics_mesh_create_ex(wasm96_hash_key(key), format, vertices, v_len, indices, i_len, index_type) != 0;
+}
+
+// Bytes per vertex for a `wasm96_vertex_format_t` combination.
+static inline uint32_t wasm96_vertex_format_size(uint32_t format) {
+    uint32_t pos = (format & 3u) == WASM96_POSITION_F32 ? 12u : 8u;
+    uint32_t uv = (format & (3u << 2)) == WASM96_UV_F32 ? 8u : (format & (3u << 2)) == WASM96_UV_UNORM16 ? 4u : 0u;
+    uint32_t normal = (format & (3u << 4)) == WASM96_NORMAL_OCT16 ? 4u : 12u;
+    return pos + uv + normal;
+}
+
+static inline int16_t wasm96_pack_snorm16(float v) {
+    v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+    return (int16_t)(v * 32767.0f + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+static inline uint16_t wasm96_pack_unorm16(float v) {
+    v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+    return (uint16_t)(v * 65535.0f + 0.5f);
+}
+
+// Octahedral-encode a unit normal into two snorm16 components (WASM96_NORMAL_OCT16).
+static inline void wasm96_oct_encode16(float nx, float ny, float nz, int16_t out[2]) {
+    float ax = nx < 0.0f ? -nx : nx, ay = ny < 0.0f ? -ny : ny, az = nz < 0.0f ? -nz : nz;
+    float l1 = ax + ay + az;
+    float x = l1 > 0.0f ? nx / l1 : 0.0f, y = l1 > 0.0f ? ny / l1 : 0.0f;
+    if (nz < 0.0f) {
+        float fx = (1.0f - (y < 0.0f ? -y : y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - (x < 0.0f ? -x : x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+    out[0] = wasm96_pack_snorm16(x);
+    out[1] = wasm96_pack_snorm16(y);
+}
+
+// float -> IEEE half (WASM96_POSITION_F16). Values too small flush to zero, too large become inf.
+static inline uint16_t wasm96_f32_to_f16(float f) {
+    union { float f; uint32_t u; } v;
+    v.f = f;
+    uint32_t sign = (v.u >> 16) & 0x8000u;
+    int32_t exp = (int32_t)((v.u >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mant = v.u & 0x7FFFFFu;
+    if (exp <= 0) return (uint16_t)sign;
+    if (exp >= 31) return (uint16_t)(sign | 0x7C00u);
+    return (uint16_t)((sign | ((uint32_t)exp << 10) | (mant >> 13)) + ((mant >> 12) & 1u));
+}
+
+// Pre-baked mesh blob (`just bake-mesh in.obj out.w96m`); uploaded without parsing.
+static inline bool wasm96_graphics_mesh_create_blob_str(const char* key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_mesh_create_blob(wasm96_hash_key(key), data, len) != 0;
+}
+
+static inline bool wasm96_graphics_mesh_create_blob_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_mesh_create_blob(key, data, len) != 0;
+}
+
 static inline bool wasm96_graphics_mesh_create_stl_str(const char* key, const uint8_t* data, uint32_t len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_mesh_create_stl(k, data, len) != 0;
 }
 
+static inline bool wasm96_graphics_mesh_create_stl_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_mesh_create_stl(key, data, len) != 0;
+}
+
 static inline void wasm96_graphics_mesh_draw_str(const char* key, float x, float y, float z, float rx, float ry, float rz, float sx, float sy, float sz) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_mesh_draw(k, x, y, z, rx, ry, rz, sx, sy, sz);
 }
 
+static inline void wasm96_graphics_mesh_draw_k(uint64_t key, float x, float y, float z, float rx, float ry, float rz, float sx, float sy, float sz) {
+    wasm96_graphics_mesh_draw(key, x, y, z, rx, ry, rz, sx, sy, sz);
+}
+
+// Draw `count` copies of a mesh in one call (shared color and texture, one transform each).
+static inline void wasm96_graphics_mesh_draw_instanced_str(const char* key, const wasm96_transform_t* transforms, uint32_t count) {
+    wasm96_graphics_mesh_draw_instanced(wasm96_hash_key(key), (const float*)transforms, count);
+}
+
+static inline void wasm96_graphics_mesh_draw_instanced_k(uint64_t key, const wasm96_transform_t* transforms, uint32_t count) {
+    wasm96_graphics_mesh_draw_instanced(key, (const float*)transforms, count);
+}
+
+// Mesh draws submitted and frustum-culled since the start of the frame.
+static inline wasm96_mesh_stats_t wasm96_graphics_get_mesh_stats(void) {
+    uint64_t packed = wasm96_graphics_mesh_stats();
+    wasm96_mesh_stats_t s;
+    s.submitted = (uint32_t)(packed >> 32);
+    s.culled = (uint32_t)packed;
+    return s;
+}
+
 static inline bool wasm96_graphics_mesh_set_texture_str(const char* mesh_key, const char* image_key) {
     uint64_t mk = wasm96_hash_key(mesh_key);
     uint64_t ik = wasm96_hash_key(image_key);
     return wasm96_graphics_mesh_set_texture(mk, ik) != 0;
 }
 
+static inline bool wasm96_graphics_mesh_set_texture_k(uint64_t mesh_key, uint64_t image_key) {
+    return wasm96_graphics_mesh_set_texture(mesh_key, image_key) != 0;
+}
+
 static inline bool wasm96_graphics_mtl_register_texture_str(
     const char* texture_key,
     const uint8_t* mtl_bytes,
@@ -223,101 +568,281 @@ static inline bool wasm96_graphics_mtl_register_texture_str(
     ) != 0;
 }
 
+static inline bool wasm96_graphics_mtl_register_texture_k(
+    uint64_t texture_key,
+    const uint8_t* mtl_bytes,
+    uint32_t mtl_len,
+    const char* tex_filename,
+    const uint8_t* tex_bytes,
+    uint32_t tex_len
+) {
+    return wasm96_graphics_mtl_register_texture(
+        texture_key,
+        mtl_bytes,
+        mtl_len,
+        (const uint8_t*)tex_filename,
+        wasm96_strlen_(tex_filename),
+        tex_bytes,
+        tex_len
+    ) != 0;
+}
+
 static inline bool wasm96_graphics_svg_register_str(const char* key, const uint8_t* data, uint32_t len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_svg_register(k, data, len) != 0;
 }
 
+static inline bool wasm96_graphics_svg_register_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_svg_register(key, data, len) != 0;
+}
+
 static inline void wasm96_graphics_svg_draw_key_str(const char* key, int32_t x, int32_t y, uint32_t w, uint32_t h) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_svg_draw_key(k, x, y, w, h);
 }
 
+static inline void wasm96_graphics_svg_draw_key_k(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) {
+    wasm96_graphics_svg_draw_key(key, x, y, w, h);
+}
+
 static inline void wasm96_graphics_svg_unregister_str(const char* key) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_svg_unregister(k);
 }
 
+static inline void wasm96_graphics_svg_unregister_k(uint64_t key) {
+    wasm96_graphics_svg_unregister(key);
+}
+
+static inline bool wasm96_graphics_svg_prerender_str(const char* key, uint32_t w, uint32_t h) {
+    uint64_t k = wasm96_hash_key(key);
+    return wasm96_graphics_svg_prerender(k, w, h) != 0;
+}
+
+static inline bool wasm96_graphics_svg_prerender_k(uint64_t key, uint32_t w, uint32_t h) {
+    return wasm96_graphics_svg_prerender(key, w, h) != 0;
+}
+
+static inline void wasm96_graphics_svg_evict_str(const char* key) {
+    uint64_t k = wasm96_hash_key(key);
+    wasm96_graphics_svg_evict(k);
+}
+
+static inline void wasm96_graphics_svg_evict_k(uint64_t key) {
+    wasm96_graphics_svg_evict(key);
+}
+
 static inline bool wasm96_graphics_gif_register_str(const char* key, const uint8_t* data, uint32_t len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_gif_register(k, data, len) != 0;
 }
 
+static inline bool wasm96_graphics_gif_register_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_gif_register(key, data, len) != 0;
+}
+
 static inline void wasm96_graphics_gif_draw_key_str(const char* key, int32_t x, int32_t y) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_gif_draw_key(k, x, y);
 }
 
+static inline void wasm96_graphics_gif_draw_key_k(uint64_t key, int32_t x, int32_t y) {
+    wasm96_graphics_gif_draw_key(key, x, y);
+}
+
 static inline void wasm96_graphics_gif_draw_key_scaled_str(const char* key, int32_t x, int32_t y, uint32_t w, uint32_t h) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_gif_draw_key_scaled(k, x, y, w, h);
 }
 
+static inline void wasm96_graphics_gif_draw_key_scaled_k(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) {
+    wasm96_graphics_gif_draw_key_scaled(key, x, y, w, h);
+}
+
 static inline void wasm96_graphics_gif_unregister_str(const char* key) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_gif_unregister(k);
 }
 
+static inline void wasm96_graphics_gif_unregister_k(uint64_t key) {
+    wasm96_graphics_gif_unregister(key);
+}
+
 static inline bool wasm96_graphics_png_register_str(const char* key, const uint8_t* data, uint32_t len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_png_register(k, data, len) != 0;
 }
 
+static inline bool wasm96_graphics_png_register_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_png_register(key, data, len) != 0;
+}
+
 static inline void wasm96_graphics_png_draw_key_str(const char* key, int32_t x, int32_t y) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_png_draw_key(k, x, y);
 }
 
+static inline void wasm96_graphics_png_draw_key_k(uint64_t key, int32_t x, int32_t y) {
+    wasm96_graphics_png_draw_key(key, x, y);
+}
+
 static inline void wasm96_graphics_png_draw_key_scaled_str(const char* key, int32_t x, int32_t y, uint32_t w, uint32_t h) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_png_draw_key_scaled(k, x, y, w, h);
 }
 
+static inline void wasm96_graphics_png_draw_key_scaled_k(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) {
+    wasm96_graphics_png_draw_key_scaled(key, x, y, w, h);
+}
+
 static inline void wasm96_graphics_png_unregister_str(const char* key) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_png_unregister(k);
 }
 
+static inline void wasm96_graphics_png_unregister_k(uint64_t key) {
+    wasm96_graphics_png_unregister(key);
+}
+
 static inline bool wasm96_graphics_jpeg_register_str(const char* key, const uint8_t* data, uint32_t len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_jpeg_register(k, data, len) != 0;
 }
 
+static inline bool wasm96_graphics_jpeg_register_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_jpeg_register(key, data, len) != 0;
+}
+
 static inline void wasm96_graphics_jpeg_draw_key_str(const char* key, int32_t x, int32_t y) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_jpeg_draw_key(k, x, y);
 }
 
+static inline void wasm96_graphics_jpeg_draw_key_k(uint64_t key, int32_t x, int32_t y) {
+    wasm96_graphics_jpeg_draw_key(key, x, y);
+}
+
 static inline void wasm96_graphics_jpeg_draw_key_scaled_str(const char* key, int32_t x, int32_t y, uint32_t w, uint32_t h) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_jpeg_draw_key_scaled(k, x, y, w, h);
 }
 
+static inline void wasm96_graphics_jpeg_draw_key_scaled_k(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) {
+    wasm96_graphics_jpeg_draw_key_scaled(key, x, y, w, h);
+}
+
 static inline void wasm96_graphics_jpeg_unregister_str(const char* key) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_jpeg_unregister(k);
 }
 
+static inline void wasm96_graphics_jpeg_unregister_k(uint64_t key) {
+    wasm96_graphics_jpeg_unregister(key);
+}
+
+static inline bool wasm96_graphics_image_register_str(const char* key, uint32_t w, uint32_t h, const uint8_t* rgba, uint32_t len) {
+    uint64_t k = wasm96_hash_key(key);
+    return wasm96_graphics_image_register(k, w, h, rgba, len) != 0;
+}
+
+// Sprite batches
+static inline uint32_t wasm96_graphics_sprite_batch_str(const char* image_key, const wasm96_sprite_t* sprites, uint32_t count) {
+    uint64_t k = wasm96_hash_key(image_key);
+    return wasm96_graphics_sprite_batch(k, sprites, count);
+}
+
+// Instance drawing cell (`col`, `row`) of a sheet of `cell_w`x`cell_h` cells at (x, y), unscaled.
+static inline wasm96_sprite_t wasm96_sprite_cell(int32_t x, int32_t y, uint32_t cell_w, uint32_t cell_h, uint32_t col, uint32_t row) {
+    wasm96_sprite_t s;
+    s.x = x;
+    s.y = y;
+    s.w = cell_w;
+    s.h = cell_h;
+    s.src_x = col * cell_w;
+    s.src_y = row * cell_h;
+    s.src_w = cell_w;
+    s.src_h = cell_h;
+    s.flags = 0;
+    s.tint = WASM96_TINT_NONE;
+    return s;
+}
+
+// Tilemaps
+static inline bool wasm96_tilemap_create_str(const char* key, const char* tileset_key, uint32_t tile_w, uint32_t tile_h, uint32_t map_w, uint32_t map_h) {
+    return wasm96_tilemap_create(wasm96_hash_key(key), wasm96_hash_key(tileset_key), tile_w, tile_h, map_w, map_h) != 0;
+}
+
+static inline uint32_t wasm96_tilemap_set_tiles_str(const char* key, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint16_t* tiles) {
+    return wasm96_tilemap_set_tiles(wasm96_hash_key(key), x, y, w, h, tiles);
+}
+
+static inline void wasm96_tilemap_draw_str(const char* key, int32_t scroll_x, int32_t scroll_y) {
+    wasm96_tilemap_draw(wasm96_hash_key(key), scroll_x, scroll_y);
+}
+
+// Retained draw lists
+static inline void wasm96_graphics_list_begin_str(const char* key) {
+    wasm96_graphics_list_begin(wasm96_hash_key(key));
+}
+
+static inline void wasm96_graphics_list_draw_str(const char* key, int32_t dx, int32_t dy) {
+    wasm96_graphics_list_draw(wasm96_hash_key(key), dx, dy);
+}
+
 static inline bool wasm96_graphics_font_register_ttf_str(const char* key, const uint8_t* data, uint32_t len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_font_register_ttf(k, data, len) != 0;
 }
 
+static inline bool wasm96_graphics_font_register_ttf_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_font_register_ttf(key, data, len) != 0;
+}
+
 static inline bool wasm96_graphics_font_register_bdf_str(const char* key, const uint8_t* data, uint32_t len) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_font_register_bdf(k, data, len) != 0;
 }
 
+static inline bool wasm96_graphics_font_register_bdf_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_graphics_font_register_bdf(key, data, len) != 0;
+}
+
 static inline bool wasm96_graphics_font_register_spleen_str(const char* key, uint32_t size) {
     uint64_t k = wasm96_hash_key(key);
     return wasm96_graphics_font_register_spleen(k, size) != 0;
 }
 
+static inline bool wasm96_graphics_font_register_spleen_k(uint64_t key, uint32_t size) {
+    return wasm96_graphics_font_register_spleen(key, size) != 0;
+}
+
 static inline void wasm96_graphics_font_unregister_str(const char* key) {
     uint64_t k = wasm96_hash_key(key);
     wasm96_graphics_font_unregister(k);
 }
 
+static inline void wasm96_graphics_font_unregister_k(uint64_t key) {
+    wasm96_graphics_font_unregister(key);
+}
+
+// Audio voices
+static inline uint32_t wasm96_audio_play(wasm96_audio_format_t format, const uint8_t* data, uint32_t len, bool loop) {
+    return wasm96_audio_voice_play((uint32_t)format, data, len, loop ? 1u : 0u);
+}
+
+// Async assets
+static inline bool wasm96_asset_load_str(wasm96_asset_kind_t kind, const char* key, const uint8_t* data, uint32_t len) {
+    return wasm96_asset_load((uint32_t)kind, wasm96_hash_key(key), data, len) != 0;
+}
+
+static inline bool wasm96_asset_load_k(wasm96_asset_kind_t kind, uint64_t key, const uint8_t* data, uint32_t len) {
+    return wasm96_asset_load((uint32_t)kind, key, data, len) != 0;
+}
+
+static inline wasm96_asset_status_t wasm96_asset_status_str(const char* key) {
+    return (wasm96_asset_status_t)wasm96_asset_status(wasm96_hash_key(key));
+}
+
 static inline void wasm96_graphics_text_key_str(int32_t x, int32_t y, const char* font_key, const char* text) {
     uint64_t fk = wasm96_hash_key(font_key);
 #if WASM96_HAS_STRING_H
@@ -328,6 +853,15 @@ static inline void wasm96_graphics_text_key_str(int32_t x, int32_t y, const char
     wasm96_graphics_text_key(x, y, fk, (const uint8_t*)text, len);
 }
 
+static inline void wasm96_graphics_text_key_k(int32_t x, int32_t y, uint64_t font_key, const char* text) {
+#if WASM96_HAS_STRING_H
+    uint32_t len = (uint32_t)strlen(text);
+#else
+    uint32_t len = wasm96_strlen_(text);
+#endif
+    wasm96_graphics_text_key(x, y, font_key, (const uint8_t*)text, len);
+}
+
 static inline wasm96_text_size_t wasm96_graphics_text_measure_key_str(const char* font_key, const char* text) {
     uint64_t fk = wasm96_hash_key(font_key);
 #if WASM96_HAS_STRING_H
@@ -342,11 +876,113 @@ static inline wasm96_text_size_t wasm96_graphics_text_measure_key_str(const char
     return ts;
 }
 
+static inline wasm96_text_size_t wasm96_graphics_text_measure_key_k(uint64_t font_key, const char* text) {
+#if WASM96_HAS_STRING_H
+    uint32_t len = (uint32_t)strlen(text);
+#else
+    uint32_t len = wasm96_strlen_(text);
+#endif
+    uint64_t packed = wasm96_graphics_text_measure_key(font_key, (const uint8_t*)text, len);
+    wasm96_text_size_t ts;
+    ts.width = (uint32_t)(packed >> 32);
+    ts.height = (uint32_t)(packed & 0xFFFFFFFFULL);
+    return ts;
+}
+
+static inline void wasm96_graphics_text_key_sized_str(int32_t x, int32_t y, const char* font_key, uint32_t px, const char* text) {
+    uint64_t fk = wasm96_hash_key(font_key);
+#if WASM96_HAS_STRING_H
+    uint32_t len = (uint32_t)strlen(text);
+#else
+    uint32_t len = wasm96_strlen_(text);
+#endif
+    wasm96_graphics_text_key_sized(x, y, fk, px, (const uint8_t*)text, len);
+}
+
+static inline void wasm96_graphics_text_key_sized_k(int32_t x, int32_t y, uint64_t font_key, uint32_t px, const char* text) {
+#if WASM96_HAS_STRING_H
+    uint32_t len = (uint32_t)strlen(text);
+#else
+    uint32_t len = wasm96_strlen_(text);
+#endif
+    wasm96_graphics_text_key_sized(x, y, font_key, px, (const uint8_t*)text, len);
+}
+
+static inline wasm96_text_size_t wasm96_graphics_text_measure_key_sized_str(const char* font_key, uint32_t px, const char* text) {
+    uint64_t fk = wasm96_hash_key(font_key);
+#if WASM96_HAS_STRING_H
+    uint32_t len = (uint32_t)strlen(text);
+#else
+    uint32_t len = wasm96_strlen_(text);
+#endif
+    uint64_t packed = wasm96_graphics_text_measure_key_sized(fk, px, (const uint8_t*)text, len);
+    wasm96_text_size_t ts;
+    ts.width = (uint32_t)(packed >> 32);
+    ts.height = (uint32_t)(packed & 0xFFFFFFFFULL);
+    return ts;
+}
+
+static inline wasm96_text_size_t wasm96_graphics_text_measure_key_sized_k(uint64_t font_key, uint32_t px, const char* text) {
+#if WASM96_HAS_STRING_H
+    uint32_t len = (uint32_t)strlen(text);
+#else
+    uint32_t len = wasm96_strlen_(text);
+#endif
+    uint64_t packed = wasm96_graphics_text_measure_key_sized(font_key, px, (const uint8_t*)text, len);
+    wasm96_text_size_t ts;
+    ts.width = (uint32_t)(packed >> 32);
+    ts.height = (uint32_t)(packed & 0xFFFFFFFFULL);
+    return ts;
+}
+
+// Text batches: fill an array of items each frame and draw it with one call. Unchanged strings
+// are laid out once host-side, so a static HUD costs little more than the call.
+static inline wasm96_text_item_t wasm96_text_item(int32_t x, int32_t y, const char* text, uint32_t color) {
+    wasm96_text_item_t item;
+    item.x = x;
+    item.y = y;
+    item.text = text;
+#if WASM96_HAS_STRING_H
+    item.text_len = (uint32_t)strlen(text);
+#else
+    item.text_len = wasm96_strlen_(text);
+#endif
+    item.color = color;
+    item.px = 0;
+    return item;
+}
+
+static inline uint32_t wasm96_graphics_text_batch_str(const char* font_key, const wasm96_text_item_t* items, uint32_t count) {
+    return wasm96_graphics_text_batch(wasm96_hash_key(font_key), items, count);
+}
+
 // Input API
 static inline bool wasm96_input_is_button_down_enum(uint32_t port, wasm96_button_t btn) {
     return wasm96_input_is_button_down(port, (uint32_t)btn) != 0;
 }
 
+// Read one port's held/pressed/released masks. Call once per frame and test bits with the
+// `wasm96_pad_*` helpers instead of calling `wasm96_input_is_button_down` per button.
+static inline wasm96_pad_t wasm96_input_pad(uint32_t port) {
+    wasm96_pad_t pad;
+    pad.held = wasm96_input_get_buttons(port);
+    pad.pressed = wasm96_input_get_pressed(port);
+    pad.released = wasm96_input_get_released(port);
+    return pad;
+}
+
+static inline bool wasm96_pad_down(const wasm96_pad_t* pad, wasm96_button_t btn) {
+    return (pad->held & WASM96_BUTTON_MASK(btn)) != 0;
+}
+
+static inline bool wasm96_pad_pressed(const wasm96_pad_t* pad, wasm96_button_t btn) {
+    return (pad->pressed & WASM96_BUTTON_MASK(btn)) != 0;
+}
+
+static inline bool wasm96_pad_released(const wasm96_pad_t* pad, wasm96_button_t btn) {
+    return (pad->released & WASM96_BUTTON_MASK(btn)) != 0;
+}
+
 static inline bool wasm96_input_is_key_down_bool(uint32_t key) {
     return wasm96_input_is_key_down(key) != 0;
 }
@@ -364,8 +1000,27 @@ static inline void wasm96_storage_save_str(const char* key, const uint8_t* data,
     wasm96_storage_save(k, data, len);
 }
 
-// For load, need to handle the packed return
-// User needs to implement allocation
+static inline void wasm96_storage_save_k(uint64_t key, const uint8_t* data, uint32_t len) {
+    wasm96_storage_save(key, data, len);
+}
+
+// Load the value for `key` into `dst` (at most `cap` bytes), copied straight from the host: no
+// allocator needed. Returns the bytes copied, or WASM96_STORAGE_NOT_FOUND. Use
+// `wasm96_storage_size` to size the buffer, or `wasm96_storage_read` with an offset to read in
+// chunks.
+static inline uint32_t wasm96_storage_load_into(uint64_t key, uint8_t* dst, uint32_t cap) {
+    return wasm96_storage_read(key, dst, cap, 0);
+}
+
+static inline uint32_t wasm96_storage_load_into_str(const char* key, uint8_t* dst, uint32_t cap) {
+    return wasm96_storage_read(wasm96_hash_key(key), dst, cap, 0);
+}
+
+// Overwrite `len` bytes at byte `offset` of the value for `key` (creating or zero-extending it).
+// Only the changed range is copied and persisted, so patch large saves instead of re-saving them.
+static inline void wasm96_storage_write_str(const char* key, uint32_t offset, const uint8_t* data, uint32_t len) {
+    wasm96_storage_write(wasm96_hash_key(key), offset, data, len);
+}
 
 // System API
 static inline void wasm96_system_log_str(const char* message) {
@@ -377,6 +1032,166 @@ static inline void wasm96_system_log_str(const char* message) {
     wasm96_system_log((const uint8_t*)message, len);
 }
 
+static inline wasm96_frame_stats_t wasm96_system_frame_stats(void) {
+    wasm96_frame_stats_t stats = {0};
+    wasm96_system_stats((uint8_t*)&stats, (uint32_t)sizeof stats);
+    return stats;
+}
+
+// Guest-owned framebuffer
+//
+// Bind a `w*h` array of 0x00RRGGBB pixels and write to it directly; the host presents it as-is
+// every frame (no copy, no per-pixel import calls). The array must stay alive while bound (use
+// static storage). While bound, host drawing calls (rect, text, ...) are not visible.
+#define WASM96_FRAMEBUFFER_XRGB8888 0u
+
+static inline bool wasm96_graphics_bind_framebuffer_xrgb8888(uint32_t* pixels, uint32_t w, uint32_t h) {
+    return wasm96_graphics_bind_framebuffer(pixels, w, h, WASM96_FRAMEBUFFER_XRGB8888) != 0;
+}
+
+static inline void wasm96_graphics_unbind_framebuffer(void) {
+    (void)wasm96_graphics_bind_framebuffer(0, 0, 0, WASM96_FRAMEBUFFER_XRGB8888);
+}
+
+// Command lists (batched drawing)
+//
+// Records are appended to caller-owned storage and executed by the host with a single
+// `wasm96_graphics_submit` call. Each record is a header word `op | (arg_count << 16)`
+// followed by its arguments, in the same order as the immediate-mode functions.
+//
+// Commands run when the list is submitted, not when they are appended: submit before
+// mixing in immediate-mode calls (text, images, ...) that must layer on top.
+// A full list is submitted automatically so no command is ever dropped.
+typedef enum {
+    WASM96_CMD_SET_COLOR = 1,
+    WASM96_CMD_BACKGROUND = 2,
+    WASM96_CMD_POINT = 3,
+    WASM96_CMD_LINE = 4,
+    WASM96_CMD_RECT = 5,
+    WASM96_CMD_RECT_OUTLINE = 6,
+    WASM96_CMD_CIRCLE = 7,
+    WASM96_CMD_CIRCLE_OUTLINE = 8,
+    WASM96_CMD_TRIANGLE = 9,
+    WASM96_CMD_TRIANGLE_OUTLINE = 10,
+    WASM96_CMD_BEZIER_QUADRATIC = 11,
+    WASM96_CMD_BEZIER_CUBIC = 12,
+    WASM96_CMD_PILL = 13,
+    WASM96_CMD_PILL_OUTLINE = 14,
+    WASM96_CMD_CLEAR_RECT = 15
+} wasm96_cmd_op_t;
+
+typedef struct {
+    uint32_t* words;
+    uint32_t capacity; // in words
+    uint32_t count;    // in words
+} wasm96_cmd_list_t;
+
+static inline void wasm96_cmd_list_init(wasm96_cmd_list_t* list, uint32_t* storage, uint32_t capacity_words) {
+    list->words = storage;
+    list->capacity = capacity_words;
+    list->count = 0;
+}
+
+static inline void wasm96_cmd_list_clear(wasm96_cmd_list_t* list) {
+    list->count = 0;
+}
+
+// Execute all queued commands and empty the list. Returns the number of records executed.
+static inline uint32_t wasm96_cmd_list_submit(wasm96_cmd_list_t* list) {
+    uint32_t executed = 0;
+    if (list->count != 0) {
+        executed = wasm96_graphics_submit(list->words, list->count * 4u);
+    }
+    list->count = 0;
+    return executed;
+}
+
+static inline void wasm96_cmd_push_(wasm96_cmd_list_t* list, uint32_t op, const uint32_t* args, uint32_t argc) {
+    if (list->count + 1u + argc > list->capacity) {
+        wasm96_cmd_list_submit(list);
+        if (1u + argc > list->capacity) return;
+    }
+    uint32_t* w = list->words + list->count;
+    w[0] = op | (argc << 16);
+    for (uint32_t i = 0; i < argc; i++) w[1 + i] = args[i];
+    list->count += 1u + argc;
+}
+
+static inline void wasm96_cmd_set_color(wasm96_cmd_list_t* list, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    uint32_t args[4] = { r, g, b, a };
+    wasm96_cmd_push_(list, WASM96_CMD_SET_COLOR, args, 4);
+}
+
+static inline void wasm96_cmd_background(wasm96_cmd_list_t* list, uint8_t r, uint8_t g, uint8_t b) {
+    uint32_t args[3] = { r, g, b };
+    wasm96_cmd_push_(list, WASM96_CMD_BACKGROUND, args, 3);
+}
+
+static inline void wasm96_cmd_point(wasm96_cmd_list_t* list, int32_t x, int32_t y) {
+    uint32_t args[2] = { (uint32_t)x, (uint32_t)y };
+    wasm96_cmd_push_(list, WASM96_CMD_POINT, args, 2);
+}
+
+static inline void wasm96_cmd_line(wasm96_cmd_list_t* list, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    uint32_t args[4] = { (uint32_t)x1, (uint32_t)y1, (uint32_t)x2, (uint32_t)y2 };
+    wasm96_cmd_push_(list, WASM96_CMD_LINE, args, 4);
+}
+
+static inline void wasm96_cmd_rect(wasm96_cmd_list_t* list, int32_t x, int32_t y, uint32_t w, uint32_t h) {
+    uint32_t args[4] = { (uint32_t)x, (uint32_t)y, w, h };
+    wasm96_cmd_push_(list, WASM96_CMD_RECT, args, 4);
+}
+
+static inline void wasm96_cmd_rect_outline(wasm96_cmd_list_t* list, int32_t x, int32_t y, uint32_t w, uint32_t h) {
+    uint32_t args[4] = { (uint32_t)x, (uint32_t)y, w, h };
+    wasm96_cmd_push_(list, WASM96_CMD_RECT_OUTLINE, args, 4);
+}
+
+static inline void wasm96_cmd_circle(wasm96_cmd_list_t* list, int32_t x, int32_t y, uint32_t r) {
+    uint32_t args[3] = { (uint32_t)x, (uint32_t)y, r };
+    wasm96_cmd_push_(list, WASM96_CMD_CIRCLE, args, 3);
+}
+
+static inline void wasm96_cmd_circle_outline(wasm96_cmd_list_t* list, int32_t x, int32_t y, uint32_t r) {
+    uint32_t args[3] = { (uint32_t)x, (uint32_t)y, r };
+    wasm96_cmd_push_(list, WASM96_CMD_CIRCLE_OUTLINE, args, 3);
+}
+
+static inline void wasm96_cmd_triangle(wasm96_cmd_list_t* list, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3) {
+    uint32_t args[6] = { (uint32_t)x1, (uint32_t)y1, (uint32_t)x2, (uint32_t)y2, (uint32_t)x3, (uint32_t)y3 };
+    wasm96_cmd_push_(list, WASM96_CMD_TRIANGLE, args, 6);
+}
+
+static inline void wasm96_cmd_triangle_outline(wasm96_cmd_list_t* list, int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3) {
+    uint32_t args[6] = { (uint32_t)x1, (uint32_t)y1, (uint32_t)x2, (uint32_t)y2, (uint32_t)x3, (uint32_t)y3 };
+    wasm96_cmd_push_(list, WASM96_CMD_TRIANGLE_OUTLINE, args, 6);
+}
+
+static inline void wasm96_cmd_bezier_quadratic(wasm96_cmd_list_t* list, int32_t x1, int32_t y1, int32_t cx, int32_t cy, int32_t x2, int32_t y2, uint32_t segments) {
+    uint32_t args[7] = { (uint32_t)x1, (uint32_t)y1, (uint32_t)cx, (uint32_t)cy, (uint32_t)x2, (uint32_t)y2, segments };
+    wasm96_cmd_push_(list, WASM96_CMD_BEZIER_QUADRATIC, args, 7);
+}
+
+static inline void wasm96_cmd_bezier_cubic(wasm96_cmd_list_t* list, int32_t x1, int32_t y1, int32_t cx1, int32_t cy1, int32_t cx2, int32_t cy2, int32_t x2, int32_t y2, uint32_t segments) {
+    uint32_t args[9] = { (uint32_t)x1, (uint32_t)y1, (uint32_t)cx1, (uint32_t)cy1, (uint32_t)cx2, (uint32_t)cy2, (uint32_t)x2, (uint32_t)y2, segments };
+    wasm96_cmd_push_(list, WASM96_CMD_BEZIER_CUBIC, args, 9);
+}
+
+static inline void wasm96_cmd_pill(wasm96_cmd_list_t* list, int32_t x, int32_t y, uint32_t w, uint32_t h) {
+    uint32_t args[4] = { (uint32_t)x, (uint32_t)y, w, h };
+    wasm96_cmd_push_(list, WASM96_CMD_PILL, args, 4);
+}
+
+static inline void wasm96_cmd_pill_outline(wasm96_cmd_list_t* list, int32_t x, int32_t y, uint32_t w, uint32_t h) {
+    uint32_t args[4] = { (uint32_t)x, (uint32_t)y, w, h };
+    wasm96_cmd_push_(list, WASM96_CMD_PILL_OUTLINE, args, 4);
+}
+
+static inline void wasm96_cmd_clear_rect(wasm96_cmd_list_t* list, int32_t x, int32_t y, uint32_t w, uint32_t h, uint8_t r, uint8_t g, uint8_t b) {
+    uint32_t args[7] = { (uint32_t)x, (uint32_t)y, w, h, r, g, b };
+    wasm96_cmd_push_(list, WASM96_CMD_CLEAR_RECT, args, 7);
+}
+
 // User must implement these functions
 void setup(void);
 void update(void);
@@ -22,9 +22,20 @@
 //! - `wasm96_graphics_circle(x: i32, y: i32, r: u32)`
 //! - `wasm96_graphics_circle_outline(x: i32, y: i32, r: u32)`
 //!
+//! Partial redraw (the framebuffer is retained between frames):
+//! - `wasm96_graphics_clear_rect(x: i32, y: i32, w: u32, h: u32, r: u32, g: u32, b: u32)`
+//! - `wasm96_graphics_damage() -> u64` (pixels drawn since the last present, packed
+//!   `x << 48 | y << 32 | w << 16 | h`; `0` = none)
+//!
+//! Batched commands (see [`commands`] for the record layout):
+//! - `wasm96_graphics_submit(ptr: u32, len: u32) -> u32` (records executed)
+//!
 //! Raw RGBA blit:
 //! - `wasm96_graphics_image(x: i32, y: i32, w: u32, h: u32, ptr: u32, len: u32)`
 //!
+//! Guest-owned framebuffer (presented straight from guest memory; `w == 0` unbinds):
+//! - `wasm96_graphics_bind_framebuffer(ptr: u32, w: u32, h: u32, format: u32) -> u32` (bool)
+//!
 //! One-shot (decode and draw at natural size):
 //! - `wasm96_graphics_image_png(x: i32, y: i32, ptr: u32, len: u32)`
 //! - `wasm96_graphics_image_jpeg(x: i32, y: i32, ptr: u32, len: u32)`
@@ -33,6 +44,9 @@
 //! - `wasm96_graphics_svg_register(key: u64, data_ptr: u32, data_len: u32) -> u32` (bool)
 //! - `wasm96_graphics_svg_draw_key(key: u64, x: i32, y: i32, w: u32, h: u32)`
 //! - `wasm96_graphics_svg_unregister(key: u64)`
+//! - `wasm96_graphics_svg_prerender(key: u64, w: u32, h: u32) -> u32` (bool; warms the render cache)
+//! - `wasm96_graphics_svg_evict(key: u64)` (drops cached renders, keeps the SVG)
+//! - `wasm96_graphics_svg_set_cache_budget(bytes: u32)`
 //!
 //! - `wasm96_graphics_gif_register(key: u64, data_ptr: u32, data_len: u32) -> u32` (bool)
 //! - `wasm96_graphics_gif_draw_key(key: u64, x: i32, y: i32)`
@@ -44,6 +58,35 @@
 //! - `wasm96_graphics_png_draw_key_scaled(key: u64, x: i32, y: i32, w: u32, h: u32)`
 //! - `wasm96_graphics_png_unregister(key: u64)`
 //!
+//! - `wasm96_graphics_image_register(key: u64, w: u32, h: u32, data_ptr: u32, data_len: u32) -> u32`
+//!   (bool; raw RGBA8888, usable wherever a keyed PNG/JPEG is)
+//!
+//! Sprite batches (one keyed PNG/JPEG, many instances; see [`sprites`] for the record layout):
+//! - `wasm96_graphics_sprite_batch(image_key: u64, ptr: u32, count: u32) -> u32` (sprites drawn)
+//!
+//! Retained draw lists (keyed; primitives between begin and end are captured, not drawn):
+//! - `wasm96_graphics_list_begin(key: u64)`
+//! - `wasm96_graphics_list_end() -> u32` (primitives captured)
+//! - `wasm96_graphics_list_draw(key: u64, dx: i32, dy: i32)`
+//! - `wasm96_graphics_list_destroy(key: u64)`
+//!
+//! Tilemaps (keyed; `u16` tiles, `0` = empty, `n` = tileset cell `n - 1`; see [`tilemap`]):
+//! - `wasm96_tilemap_create(key: u64, tileset_key: u64, tile_w: u32, tile_h: u32, map_w: u32, map_h: u32) -> u32` (bool)
+//! - `wasm96_tilemap_set_tiles(key: u64, x: u32, y: u32, w: u32, h: u32, ptr: u32) -> u32` (tiles changed)
+//! - `wasm96_tilemap_set_tile(key: u64, x: u32, y: u32, tile: u32)`
+//! - `wasm96_tilemap_draw(key: u64, scroll_x: i32, scroll_y: i32)` (map pixel (scroll_x, scroll_y) at screen (0, 0))
+//! - `wasm96_tilemap_destroy(key: u64)`
+//!
+//! 3D meshes (see [`mesh`] for the instance and blob layouts and the vertex format bits):
+//! - `wasm96_graphics_mesh_create_ex(key: u64, format: u32, v_ptr: u32, v_len: u32, i_ptr: u32, i_len: u32, index_type: u32) -> u32`
+//!   (bool; `v_len` vertices in `format`, `i_len` `u16`/`u32` indices)
+//! - `wasm96_graphics_mesh_create_blob(key: u64, ptr: u32, len: u32) -> u32` (bool; pre-baked
+//!   vertices/indices uploaded as-is, see `wasm96-mesh-bake`)
+//! - `wasm96_graphics_mesh_draw(key: u64, x: f32, y: f32, z: f32, rx: f32, ry: f32, rz: f32, sx: f32, sy: f32, sz: f32)`
+//! - `wasm96_graphics_mesh_draw_instanced(key: u64, transforms_ptr: u32, count: u32)`
+//! - `wasm96_graphics_mesh_stats() -> u64` (draws this frame, packed `submitted << 32 | culled`;
+//!   draws outside the camera frustum are culled, each instance counts once)
+//!
 //! - `wasm96_graphics_jpeg_register(key: u64, data_ptr: u32, data_len: u32) -> u32` (bool)
 //! - `wasm96_graphics_jpeg_draw_key(key: u64, x: i32, y: i32)`
 //! - `wasm96_graphics_jpeg_draw_key_scaled(key: u64, x: i32, y: i32, w: u32, h: u32)`
@@ -61,9 +104,22 @@
 //! - `wasm96_graphics_font_unregister(key: u64)`
 //! - `wasm96_graphics_text_key(x: i32, y: i32, font_key: u64, text_ptr: u32, text_len: u32)`
 //! - `wasm96_graphics_text_measure_key(font_key: u64, text_ptr: u32, text_len: u32) -> u64`
+//! - `wasm96_graphics_text_key_sized(x: i32, y: i32, font_key: u64, px: u32, text_ptr: u32, text_len: u32)`
+//! - `wasm96_graphics_text_measure_key_sized(font_key: u64, px: u32, text_ptr: u32, text_len: u32) -> u64`
+//!   (`px` is the TTF/OTF size in pixels, `0` = default 16; bitmap fonts ignore it)
+//! - `wasm96_graphics_text_batch(font_key: u64, ptr: u32, count: u32) -> u32` (strings drawn; see
+//!   [`text`] for the record layout)
+//!
+//! Async asset loading (decoded on worker threads; see [`asset`] for kinds and statuses):
+//! - `wasm96_asset_load(kind: u32, key: u64, data_ptr: u32, data_len: u32) -> u32` (bool; queued)
+//! - `wasm96_asset_status(key: u64) -> u32`
+//! - `wasm96_asset_wait_all(timeout_ms: u32) -> u32` (loads still pending)
 //!
 //! ### Input
 //! - `wasm96_input_is_button_down(port: u32, btn: u32) -> u32` (bool)
+//! - `wasm96_input_get_buttons(port: u32) -> u32` (held mask; bit `n` is [`Button`] `n`)
+//! - `wasm96_input_get_pressed(port: u32) -> u32` (mask of buttons that went down this frame)
+//! - `wasm96_input_get_released(port: u32) -> u32` (mask of buttons that went up this frame)
 //! - `wasm96_input_is_key_down(key: u32) -> u32` (bool)
 //! - `wasm96_input_get_mouse_x() -> i32`
 //! - `wasm96_input_get_mouse_y() -> i32`
@@ -71,22 +127,44 @@
 //!
 //! ### Audio
 //! - `wasm96_audio_init(sample_rate: u32) -> u32`
-//! - `wasm96_audio_push_samples(ptr: u32, len: u32)`
+//! - `wasm96_audio_push_samples(ptr: u32, len: u32)` (interleaved stereo `i16`; dropped when the
+//!   host's queue is full)
+//! - `wasm96_audio_queued_frames() -> u32` (pushed stereo frames not yet played)
 //!
 //! // Higher-level audio playback (host-mixed "channels/voices"):
 //! - `wasm96_audio_play_wav(ptr: u32, len: u32)`
 //! - `wasm96_audio_play_qoa(ptr: u32, len: u32)`
 //! - `wasm96_audio_play_xm(ptr: u32, len: u32)`
+//!   - fire-and-forget and looping; the `voice_*` calls below return a handle instead
+//! - `wasm96_audio_voice_play(format: u32, ptr: u32, len: u32, loop: u32) -> u32`
+//!   - `format` is `audio::FORMAT_*`; returns a voice id (0 on decode failure). Voices are
+//!     resampled to the output rate; identical asset bytes share one cached decode.
+//! - `wasm96_audio_voice_set_volume(id: u32, volume_q8_8: u32)` (`audio::VOLUME_UNITY` = 1.0)
+//! - `wasm96_audio_voice_set_pan(id: u32, pan: i32)` (-32768 left .. 32767 right)
+//! - `wasm96_audio_voice_set_loop(id: u32, loop: u32)`
+//! - `wasm96_audio_voice_stop(id: u32)`
+//! - `wasm96_audio_voice_is_playing(id: u32) -> u32`
 //!
 //! ### Storage
 //! - `wasm96_storage_save(key: u64, data_ptr: u32, data_len: u32)`
 //! - `wasm96_storage_load(key: u64) -> u64`
 //!   - returns (ptr<<32)|len in guest memory; ptr=0,len=0 means “missing”
 //! - `wasm96_storage_free(ptr: u32, len: u32)`
+//! - `wasm96_storage_size(key: u64) -> u32` (value length, or [`storage::NOT_FOUND`])
+//! - `wasm96_storage_read(key: u64, dst_ptr: u32, dst_cap: u32, offset: u32) -> u32`
+//!   - copies up to `dst_cap` bytes of the value, starting at byte `offset`, straight into guest
+//!     memory (no guest allocation); returns the bytes copied, or [`storage::NOT_FOUND`]
+//! - `wasm96_storage_write(key: u64, offset: u32, src_ptr: u32, len: u32)`
+//!   - writes `len` bytes at byte `offset` of the value, creating the key or zero-extending the
+//!     value as needed; only the written range is persisted
 //!
 //! ### System
 //! - `wasm96_system_log(ptr: u32, len: u32)`
 //! - `wasm96_system_millis() -> u64`
+//! - `wasm96_system_stats(ptr: u32, len: u32) -> u32`
+//!   - writes last frame's profile (`stats` layout) into `len` bytes at `ptr` and returns the size
+//!     the full report needs; the first call turns profiling on (the report fills from the next
+//!     frame). `len = 0` only queries the size.
 //!
 //! ## Exports (host -> guest)
 //!
@@ -144,6 +222,16 @@ pub mod host_imports {
     pub const GRAPHICS_CIRCLE: &str = "wasm96_graphics_circle";
     pub const GRAPHICS_CIRCLE_OUTLINE: &str = "wasm96_graphics_circle_outline";
 
+    // Partial redraw
+    pub const GRAPHICS_CLEAR_RECT: &str = "wasm96_graphics_clear_rect";
+    pub const GRAPHICS_DAMAGE: &str = "wasm96_graphics_damage";
+
+    // Batched command buffer
+    pub const GRAPHICS_SUBMIT: &str = "wasm96_graphics_submit";
+
+    // Guest-owned framebuffer
+    pub const GRAPHICS_BIND_FRAMEBUFFER: &str = "wasm96_graphics_bind_framebuffer";
+
     // Raw RGBA blit / one-shot decode+draw
     pub const GRAPHICS_IMAGE: &str = "wasm96_graphics_image";
     pub const GRAPHICS_IMAGE_PNG: &str = "wasm96_graphics_image_png";
@@ -153,6 +241,9 @@ pub mod host_imports {
     pub const GRAPHICS_SVG_REGISTER: &str = "wasm96_graphics_svg_register";
     pub const GRAPHICS_SVG_DRAW_KEY: &str = "wasm96_graphics_svg_draw_key";
     pub const GRAPHICS_SVG_UNREGISTER: &str = "wasm96_graphics_svg_unregister";
+    pub const GRAPHICS_SVG_PRERENDER: &str = "wasm96_graphics_svg_prerender";
+    pub const GRAPHICS_SVG_EVICT: &str = "wasm96_graphics_svg_evict";
+    pub const GRAPHICS_SVG_SET_CACHE_BUDGET: &str = "wasm96_graphics_svg_set_cache_budget";
 
     // Keyed resources: GIF
     pub const GRAPHICS_GIF_REGISTER: &str = "wasm96_graphics_gif_register";
@@ -172,6 +263,25 @@ pub mod host_imports {
     pub const GRAPHICS_JPEG_DRAW_KEY_SCALED: &str = "wasm96_graphics_jpeg_draw_key_scaled";
     pub const GRAPHICS_JPEG_UNREGISTER: &str = "wasm96_graphics_jpeg_unregister";
 
+    // Keyed resources: raw RGBA
+    pub const GRAPHICS_IMAGE_REGISTER: &str = "wasm96_graphics_image_register";
+
+    // Sprite batches (keyed PNG/JPEG)
+    pub const GRAPHICS_SPRITE_BATCH: &str = "wasm96_graphics_sprite_batch";
+
+    // Retained draw lists
+    pub const GRAPHICS_LIST_BEGIN: &str = "wasm96_graphics_list_begin";
+    pub const GRAPHICS_LIST_END: &str = "wasm96_graphics_list_end";
+    pub const GRAPHICS_LIST_DRAW: &str = "wasm96_graphics_list_draw";
+    pub const GRAPHICS_LIST_DESTROY: &str = "wasm96_graphics_list_destroy";
+
+    // Tilemaps
+    pub const TILEMAP_CREATE: &str = "wasm96_tilemap_create";
+    pub const TILEMAP_SET_TILES: &str = "wasm96_tilemap_set_tiles";
+    pub const TILEMAP_SET_TILE: &str = "wasm96_tilemap_set_tile";
+    pub const TILEMAP_DRAW: &str = "wasm96_tilemap_draw";
+    pub const TILEMAP_DESTROY: &str = "wasm96_tilemap_destroy";
+
     // Shapes
     pub const GRAPHICS_TRIANGLE: &str = "wasm96_graphics_triangle";
     pub const GRAPHICS_TRIANGLE_OUTLINE: &str = "wasm96_graphics_triangle_outline";
@@ -187,8 +297,12 @@ pub mod host_imports {
     pub const GRAPHICS_MESH_CREATE: &str = "wasm96_graphics_mesh_create";
     pub const GRAPHICS_MESH_CREATE_OBJ: &str = "wasm96_graphics_mesh_create_obj";
     pub const GRAPHICS_MESH_CREATE_STL: &str = "wasm96_graphics_mesh_create_stl";
+    pub const GRAPHICS_MESH_CREATE_BLOB: &str = "wasm96_graphics_mesh_create_blob";
+    pub const GRAPHICS_MESH_CREATE_EX: &str = "wasm96_graphics_mesh_create_ex";
     pub const GRAPHICS_MESH_SET_TEXTURE: &str = "wasm96_graphics_mesh_set_texture";
     pub const GRAPHICS_MESH_DRAW: &str = "wasm96_graphics_mesh_draw";
+    pub const GRAPHICS_MESH_DRAW_INSTANCED: &str = "wasm96_graphics_mesh_draw_instanced";
+    pub const GRAPHICS_MESH_STATS: &str = "wasm96_graphics_mesh_stats";
 
     // Materials / textures (OBJ+MTL workflows)
     pub const GRAPHICS_MTL_REGISTER_TEXTURE: &str = "wasm96_graphics_mtl_register_texture";
@@ -200,9 +314,20 @@ pub mod host_imports {
     pub const GRAPHICS_FONT_UNREGISTER: &str = "wasm96_graphics_font_unregister";
     pub const GRAPHICS_TEXT_KEY: &str = "wasm96_graphics_text_key";
     pub const GRAPHICS_TEXT_MEASURE_KEY: &str = "wasm96_graphics_text_measure_key";
+    pub const GRAPHICS_TEXT_KEY_SIZED: &str = "wasm96_graphics_text_key_sized";
+    pub const GRAPHICS_TEXT_MEASURE_KEY_SIZED: &str = "wasm96_graphics_text_measure_key_sized";
+    pub const GRAPHICS_TEXT_BATCH: &str = "wasm96_graphics_text_batch";
+
+    // Async asset loading
+    pub const ASSET_LOAD: &str = "wasm96_asset_load";
+    pub const ASSET_STATUS: &str = "wasm96_asset_status";
+    pub const ASSET_WAIT_ALL: &str = "wasm96_asset_wait_all";
 
     // Input
     pub const INPUT_IS_BUTTON_DOWN: &str = "wasm96_input_is_button_down";
+    pub const INPUT_GET_BUTTONS: &str = "wasm96_input_get_buttons";
+    pub const INPUT_GET_PRESSED: &str = "wasm96_input_get_pressed";
+    pub const INPUT_GET_RELEASED: &str = "wasm96_input_get_released";
     pub const INPUT_IS_KEY_DOWN: &str = "wasm96_input_is_key_down";
     pub const INPUT_GET_MOUSE_X: &str = "wasm96_input_get_mouse_x";
     pub const INPUT_GET_MOUSE_Y: &str = "wasm96_input_get_mouse_y";
@@ -211,6 +336,7 @@ pub mod host_imports {
     // Audio
     pub const AUDIO_INIT: &str = "wasm96_audio_init";
     pub const AUDIO_PUSH_SAMPLES: &str = "wasm96_audio_push_samples";
+    pub const AUDIO_QUEUED_FRAMES: &str = "wasm96_audio_queued_frames";
 
     // High-level audio playback (decoded + mixed on host)
     // Fire-and-forget (no ids/handles returned).
@@ -218,14 +344,263 @@ pub mod host_imports {
     pub const AUDIO_PLAY_QOA: &str = "wasm96_audio_play_qoa";
     pub const AUDIO_PLAY_XM: &str = "wasm96_audio_play_xm";
 
+    // Voices (handle-based playback; see `audio`)
+    pub const AUDIO_VOICE_PLAY: &str = "wasm96_audio_voice_play";
+    pub const AUDIO_VOICE_SET_VOLUME: &str = "wasm96_audio_voice_set_volume";
+    pub const AUDIO_VOICE_SET_PAN: &str = "wasm96_audio_voice_set_pan";
+    pub const AUDIO_VOICE_SET_LOOP: &str = "wasm96_audio_voice_set_loop";
+    pub const AUDIO_VOICE_STOP: &str = "wasm96_audio_voice_stop";
+    pub const AUDIO_VOICE_IS_PLAYING: &str = "wasm96_audio_voice_is_playing";
+
     // Storage
     pub const STORAGE_SAVE: &str = "wasm96_storage_save";
     pub const STORAGE_LOAD: &str = "wasm96_storage_load";
     pub const STORAGE_FREE: &str = "wasm96_storage_free";
+    pub const STORAGE_SIZE: &str = "wasm96_storage_size";
+    pub const STORAGE_READ: &str = "wasm96_storage_read";
+    pub const STORAGE_WRITE: &str = "wasm96_storage_write";
 
     // System
     pub const SYSTEM_LOG: &str = "wasm96_system_log";
     pub const SYSTEM_MILLIS: &str = "wasm96_system_millis";
+    pub const SYSTEM_STATS: &str = "wasm96_system_stats";
+}
+
+/// Packed command-buffer format used by `wasm96_graphics_submit`.
+///
+/// A command list is a sequence of records of 32-bit little-endian words:
+/// - word 0 (header): `opcode | (arg_count << 16)`
+/// - words 1..=arg_count: arguments, in the same order as the matching immediate-mode import
+///   (`i32` coordinates, `u32` sizes/colors)
+///
+/// The host runs the whole list under a single state lock. Records whose `arg_count` is smaller
+/// than the opcode expects stop execution; unknown opcodes and extra trailing arguments are skipped
+/// so newer guests degrade gracefully on older cores.
+pub mod commands {
+    /// Size of one command word in bytes.
+    pub const WORD_SIZE: usize = 4;
+
+    pub const SET_COLOR: u32 = 1; // r, g, b, a
+    pub const BACKGROUND: u32 = 2; // r, g, b
+    pub const POINT: u32 = 3; // x, y
+    pub const LINE: u32 = 4; // x1, y1, x2, y2
+    pub const RECT: u32 = 5; // x, y, w, h
+    pub const RECT_OUTLINE: u32 = 6; // x, y, w, h
+    pub const CIRCLE: u32 = 7; // x, y, r
+    pub const CIRCLE_OUTLINE: u32 = 8; // x, y, r
+    pub const TRIANGLE: u32 = 9; // x1, y1, x2, y2, x3, y3
+    pub const TRIANGLE_OUTLINE: u32 = 10; // x1, y1, x2, y2, x3, y3
+    pub const BEZIER_QUADRATIC: u32 = 11; // x1, y1, cx, cy, x2, y2, segments
+    pub const BEZIER_CUBIC: u32 = 12; // x1, y1, cx1, cy1, cx2, cy2, x2, y2, segments
+    pub const PILL: u32 = 13; // x, y, w, h
+    pub const PILL_OUTLINE: u32 = 14; // x, y, w, h
+    pub const CLEAR_RECT: u32 = 15; // x, y, w, h, r, g, b
+
+    /// Number of argument words expected for `opcode`, or `None` if unknown.
+    pub fn arg_count(opcode: u32) -> Option<usize> {
+        match opcode {
+            SET_COLOR => Some(4),
+            BACKGROUND => Some(3),
+            POINT => Some(2),
+            LINE | RECT | RECT_OUTLINE | PILL | PILL_OUTLINE => Some(4),
+            CIRCLE | CIRCLE_OUTLINE => Some(3),
+            TRIANGLE | TRIANGLE_OUTLINE => Some(6),
+            BEZIER_QUADRATIC => Some(7),
+            BEZIER_CUBIC => Some(9),
+            CLEAR_RECT => Some(7),
+            _ => None,
+        }
+    }
+
+    /// Build a record header word.
+    pub const fn header(opcode: u32, arg_count: u32) -> u32 {
+        (opcode & 0xFFFF) | (arg_count << 16)
+    }
+}
+
+/// Sprite instance records for `wasm96_graphics_sprite_batch`.
+///
+/// Each record is 10 little-endian 32-bit words (`wasm96_sprite_t` in the C SDK):
+/// `x: i32, y: i32, w, h, src_x, src_y, src_w, src_h, flags, tint`.
+/// - `w`/`h` of `0` draw at the source size; other sizes scale nearest-neighbor.
+/// - `src_w`/`src_h` of `0` select the whole image; the rect is clamped to the image.
+/// - `tint` is `0xAARRGGBB`, multiplied into every source pixel (`TINT_NONE` = unchanged).
+pub mod sprites {
+    /// Size of one sprite record in bytes.
+    pub const SPRITE_SIZE: usize = 40;
+
+    pub const FLIP_X: u32 = 1 << 0;
+    pub const FLIP_Y: u32 = 1 << 1;
+
+    pub const TINT_NONE: u32 = 0xFFFF_FFFF;
+}
+
+/// Text records for `wasm96_graphics_text_batch`.
+///
+/// Each record is 6 little-endian 32-bit words (`wasm96_text_item_t` in the C SDK):
+/// `x: i32, y: i32, text_ptr, text_len, color, px`.
+/// - `text_ptr`/`text_len` locate UTF-8 bytes in guest memory.
+/// - `color` is `0xAARRGGBB`; `COLOR_CURRENT` uses the current draw color.
+/// - `px` is the TTF/OTF size (`0` = default 16); bitmap fonts ignore it.
+pub mod text {
+    /// Size of one text record in bytes.
+    pub const TEXT_ITEM_SIZE: usize = 24;
+
+    pub const COLOR_CURRENT: u32 = 0;
+}
+
+/// 3D mesh constants.
+pub mod mesh {
+    /// `f32`s per instance for `wasm96_graphics_mesh_draw_instanced`: packed TRS
+    /// (`x, y, z, rx, ry, rz, sx, sy, sz`), the same order as `wasm96_graphics_mesh_draw`.
+    pub const INSTANCE_FLOATS: usize = 9;
+
+    /// Pre-baked mesh blob (`wasm96_graphics_mesh_create_blob`), little-endian:
+    ///
+    /// | offset | field |
+    /// |---|---|
+    /// | 0 | magic `W96M` |
+    /// | 4 | `u16` version ([`BLOB_VERSION`]) |
+    /// | 6 | `u16` flags ([`BLOB_FLAG_U16_INDICES`]) |
+    /// | 8 | `u32` vertex count |
+    /// | 12 | `u32` index count |
+    /// | 16 | `f32` x4 bounding sphere: center x, y, z, radius |
+    /// | 32 | vertices: `position[3], uv[2], normal[3]` as `f32` ([`BLOB_VERTEX_SIZE`] bytes each) |
+    /// | .. | indices: `u16` or `u32` each |
+    pub const BLOB_MAGIC: [u8; 4] = *b"W96M";
+    pub const BLOB_VERSION: u16 = 1;
+    pub const BLOB_FLAG_U16_INDICES: u16 = 1 << 0;
+    pub const BLOB_HEADER_SIZE: usize = 32;
+    pub const BLOB_VERTEX_SIZE: usize = 32;
+
+    // Vertex format bits for `wasm96_graphics_mesh_create_ex`. One position, UV and normal
+    // encoding is OR'd together; attributes are packed in that order with no gaps, so the vertex
+    // size is the sum of the three. `0` is the 32-byte `f32` layout of `mesh_create`.
+
+    /// `f32` x3 (12 bytes).
+    pub const POSITION_F32: u32 = 0;
+    /// Half-float x3 + one padding half (8 bytes).
+    pub const POSITION_F16: u32 = 1;
+    /// Normalized `i16` x3 (`-32767..=32767` -> `-1.0..=1.0`) + one padding `i16` (8 bytes).
+    pub const POSITION_SNORM16: u32 = 2;
+    pub const POSITION_MASK: u32 = 0x3;
+
+    /// `f32` x2 (8 bytes).
+    pub const UV_F32: u32 = 0 << 2;
+    /// Normalized `u16` x2 (`0..=65535` -> `0.0..=1.0`, 4 bytes).
+    pub const UV_UNORM16: u32 = 1 << 2;
+    /// No UVs (0 bytes); textured meshes sample texel (0, 0).
+    pub const UV_NONE: u32 = 2 << 2;
+    pub const UV_MASK: u32 = 0x3 << 2;
+
+    /// `f32` x3 (12 bytes).
+    pub const NORMAL_F32: u32 = 0 << 4;
+    /// Octahedral-encoded unit normal as normalized `i16` x2 (4 bytes).
+    pub const NORMAL_OCT16: u32 = 1 << 4;
+    pub const NORMAL_MASK: u32 = 0x3 << 4;
+
+    /// Index types for `wasm96_graphics_mesh_create_ex`.
+    pub const INDEX_U32: u32 = 0;
+    pub const INDEX_U16: u32 = 1;
+}
+
+/// Tilemap constants.
+pub mod tilemap {
+    /// Tile value that draws nothing. Tile `n > 0` is tileset cell `n - 1`, counted row-major.
+    pub const TILE_EMPTY: u16 = 0;
+
+    /// Chunk edge length in tiles. Chunks are the unit of rendering, caching and invalidation.
+    pub const CHUNK_TILES: u32 = 16;
+}
+
+/// Async asset loading (`wasm96_asset_load`).
+///
+/// The host copies the bytes, decodes them on a worker thread and publishes the result on the main
+/// thread (GPU uploads included) at the start of a frame or during `wasm96_asset_status` /
+/// `wasm96_asset_wait_all`. A finished load is used exactly like the matching synchronous
+/// `*_register` call with the same key.
+pub mod asset {
+    /// PNG image (as `wasm96_graphics_png_register`).
+    pub const KIND_PNG: u32 = 0;
+    /// JPEG image (as `wasm96_graphics_jpeg_register`).
+    pub const KIND_JPEG: u32 = 1;
+    /// SVG document (as `wasm96_graphics_svg_register`).
+    pub const KIND_SVG: u32 = 2;
+    /// Animated GIF (as `wasm96_graphics_gif_register`).
+    pub const KIND_GIF: u32 = 3;
+    /// TTF/OTF font (as `wasm96_graphics_font_register_ttf`).
+    pub const KIND_FONT_TTF: u32 = 4;
+    /// OBJ mesh (as `wasm96_graphics_mesh_create_obj`).
+    pub const KIND_MESH_OBJ: u32 = 5;
+
+    /// No async load has been requested for the key.
+    pub const STATUS_NONE: u32 = 0;
+    /// Queued or decoding.
+    pub const STATUS_PENDING: u32 = 1;
+    /// Decoded and registered; the key is ready to draw.
+    pub const STATUS_READY: u32 = 2;
+    /// The bytes could not be decoded (or, for meshes, no GL context was available).
+    pub const STATUS_FAILED: u32 = 3;
+}
+
+/// Report layout for `wasm96_system_stats` (all integers little-endian, times in nanoseconds).
+///
+/// Header (`HEADER_BYTES`):
+/// - `u32 version` (`VERSION`), `u32 entry_count` (import entries that follow)
+/// - `u64 frame_index`, `u64 frame_ns`
+/// - `u64 phase_ns[PHASE_COUNT]` (`PHASE_*` order)
+/// - `u64 host_ns`, `u32 host_calls`, `u32 lock_count`, `u64 lock_wait_ns`
+/// - `u64 bytes_in` (guest -> host copies), `u64 bytes_out` (host -> guest copies)
+///
+/// Then `entry_count` entries (`ENTRY_BYTES`), slowest import first:
+/// - `u8 name[NAME_BYTES]` (import name without the `wasm96_` prefix, zero-padded)
+/// - `u32 calls`, `u32 reserved`, `u64 ns`
+pub mod stats {
+    pub const VERSION: u32 = 1;
+
+    pub const PHASE_INPUT: usize = 0;
+    pub const PHASE_ASSETS: usize = 1;
+    pub const PHASE_UPDATE: usize = 2;
+    pub const PHASE_DRAW: usize = 3;
+    pub const PHASE_PRESENT: usize = 4;
+    pub const PHASE_AUDIO: usize = 5;
+    pub const PHASE_COUNT: usize = 6;
+
+    pub const HEADER_BYTES: usize = 4 + 4 + 8 + 8 + 8 * PHASE_COUNT + 8 + 4 + 4 + 8 + 8 + 8;
+    pub const NAME_BYTES: usize = 32;
+    pub const ENTRY_BYTES: usize = NAME_BYTES + 4 + 4 + 8;
+}
+
+/// Return values for `wasm96_storage_size` / `wasm96_storage_read`.
+pub mod storage {
+    /// No value is stored under the key.
+    pub const NOT_FOUND: u32 = u32::MAX;
+}
+
+/// Encoded formats and volume scale for `wasm96_audio_voice_*`.
+pub mod audio {
+    /// RIFF WAV (8/16-bit PCM, mono or stereo).
+    pub const FORMAT_WAV: u32 = 0;
+    /// Quite OK Audio.
+    pub const FORMAT_QOA: u32 = 1;
+    /// FastTracker II module, rendered once through at the output rate.
+    pub const FORMAT_XM: u32 = 2;
+
+    /// Q8.8 volume for 1.0 (the default for new voices).
+    pub const VOLUME_UNITY: u32 = 256;
+}
+
+/// Pixel format for `wasm96_graphics_bind_framebuffer`: one little-endian `u32` per pixel,
+/// `0x00RRGGBB` (the frontend's pixel format, so it can be presented without conversion).
+pub const FRAMEBUFFER_FORMAT_XRGB8888: u32 = 0;
+
+/// Joypad snapshot limits for `wasm96_input_*`.
+///
+/// Joypads are polled once per frame, before the guest's `update`; every input query during the
+/// frame reads that snapshot. Button masks set bit `1 << button` for each held [`Button`].
+pub mod input {
+    /// Ports that are snapshotted; queries for higher ports report nothing held.
+    pub const MAX_PORTS: u32 = 4;
 }
 
 /// Joypad button ids.
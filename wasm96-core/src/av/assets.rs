@@ -0,0 +1,288 @@
+//! Asynchronous asset loading.
+//!
+//! Synchronous `*_register` calls decode inside the guest's call, so a `setup()` that registers
+//! many assets stalls the first frame. `asset_load` instead copies the encoded bytes and queues
+//! them on a small pool of worker threads that do the expensive part (PNG/JPEG inflate, SVG parse,
+//! GIF scan, font parse, OBJ triangulation). Decoded results come back over a channel and are
+//! published into `RESOURCES` / the mesh store on the main thread by `asset_apply_completed`
+//! (called at the start of every frame and from the status/wait calls), so GL uploads stay on
+//! the thread that owns the context.
+//!
+//! Each key remembers the ticket of its latest load; results from a superseded load, or from
+//! before `asset_reset`, are dropped.
+
+use std::collections::HashMap;
+use std::sync::mpsc::{Receiver, RecvTimeoutError, Sender, channel};
+use std::sync::{Arc, Mutex, OnceLock};
+use std::time::{Duration, Instant};
+
+use fontdue::{Font, FontSettings};
+use resvg::usvg::{self, Tree};
+use wasmtime::Caller;
+
+use crate::abi::asset::{
+    KIND_FONT_TTF, KIND_GIF, KIND_JPEG, KIND_MESH_OBJ, KIND_PNG, KIND_SVG, STATUS_FAILED,
+    STATUS_NONE, STATUS_PENDING, STATUS_READY,
+};
+
+use super::gif_stream::GifStream;
+use super::graphics::{decode_jpeg_to_rgba, decode_png_to_rgba};
+use super::graphics3d::{Vertex, store_decoded_mesh};
+use super::mesh_data::obj_to_mesh;
+use super::resources::{FontResource, ImageResource, RESOURCES};
+use super::utils::read_guest_bytes;
+
+/// Upper bound on decode threads (one core is left for the frontend and the guest).
+const MAX_WORKERS: usize = 4;
+
+struct Job {
+    ticket: u64,
+    key: u64,
+    kind: u32,
+    bytes: Vec<u8>,
+}
+
+enum Decoded {
+    Image(ImageResource),
+    Svg(Tree),
+    Gif(GifStream),
+    Font(Font),
+    Mesh(Vec<Vertex>, Vec<u32>),
+}
+
+struct Done {
+    ticket: u64,
+    key: u64,
+    decoded: Option<Decoded>,
+}
+
+struct Loader {
+    jobs: Option<Sender<Job>>, // `None` if no worker could be spawned: decode inline
+    done_tx: Sender<Done>,
+    done_rx: Receiver<Done>,
+    next_ticket: u64,
+    // Latest ticket and status per key.
+    keys: HashMap<u64, (u64, u32)>,
+}
+
+static LOADER: OnceLock<Mutex<Loader>> = OnceLock::new();
+
+fn lock_loader() -> std::sync::MutexGuard<'static, Loader> {
+    let loader = LOADER.get_or_init(|| Mutex::new(Loader::spawn()));
+    match loader.lock() {
+        Ok(l) => l,
+        Err(poisoned) => poisoned.into_inner(),
+    }
+}
+
+impl Loader {
+    fn spawn() -> Self {
+        let (job_tx, job_rx) = channel::<Job>();
+        let (done_tx, done_rx) = channel::<Done>();
+        let job_rx = Arc::new(Mutex::new(job_rx));
+
+        let cores = std::thread::available_parallelism().map_or(2, |n| n.get());
+        let workers = (cores - 1).clamp(1, MAX_WORKERS);
+        let mut spawned = 0;
+        for i in 0..workers {
+            let rx = Arc::clone(&job_rx);
+            let tx = done_tx.clone();
+            let worker = std::thread::Builder::new()
+                .name(format!("wasm96-asset-{i}"))
+                .spawn(move || {
+                    loop {
+                        let job = rx.lock().unwrap().recv();
+                        let Ok(job) = job else { return };
+                        if tx.send(decode(job)).is_err() {
+                            return;
+                        }
+                    }
+                });
+            spawned += worker.is_ok() as usize;
+        }
+
+        Self {
+            jobs: (spawned > 0).then_some(job_tx),
+            done_tx,
+            done_rx,
+            next_ticket: 1,
+            keys: HashMap::new(),
+        }
+    }
+
+    fn pending(&self) -> u32 {
+        self.keys
+            .values()
+            .filter(|&&(_, status)| status == STATUS_PENDING)
+            .count() as u32
+    }
+
+    /// Publish one finished load if it is still the latest for its key.
+    fn apply(&mut self, done: Done) {
+        let Some(entry) = self.keys.get_mut(&done.key) else {
+            return;
+        };
+        if entry.0 != done.ticket {
+            return;
+        }
+        entry.1 = match done.decoded.map(|d| publish(done.key, d)) {
+            Some(true) => STATUS_READY,
+            _ => STATUS_FAILED,
+        };
+    }
+
+    fn apply_completed(&mut self) {
+        while let Ok(done) = self.done_rx.try_recv() {
+            self.apply(done);
+        }
+    }
+}
+
+/// Worker-side decode. Pure CPU work, no GL and no shared resource tables.
+fn decode(job: Job) -> Done {
+    let decoded = match job.kind {
+        KIND_PNG => decode_png_to_rgba(&job.bytes).map(Decoded::Image),
+        KIND_JPEG => decode_jpeg_to_rgba(&job.bytes).map(Decoded::Image),
+        KIND_SVG => std::str::from_utf8(&job.bytes)
+            .ok()
+            .and_then(|s| Tree::from_str(s, &usvg::Options::default()).ok())
+            .map(Decoded::Svg),
+        KIND_GIF => GifStream::new(job.bytes).map(Decoded::Gif),
+        KIND_FONT_TTF => Font::from_bytes(job.bytes, FontSettings::default())
+            .ok()
+            .map(Decoded::Font),
+        KIND_MESH_OBJ => obj_to_mesh(&job.bytes).map(|(v, i)| Decoded::Mesh(v, i)),
+        _ => None,
+    };
+    Done {
+        ticket: job.ticket,
+        key: job.key,
+        decoded,
+    }
+}
+
+/// Main-thread publish, mirroring what the synchronous register call for the kind stores. A key
+/// that already had a resource of the same kind is replaced.
+fn publish(key: u64, decoded: Decoded) -> bool {
+    if let Decoded::Mesh(vertices, indices) = decoded {
+        return store_decoded_mesh(key, &vertices, &indices) != 0;
+    }
+
+    let mut res = RESOURCES.lock().unwrap();
+    let id = res.next_id;
+    match decoded {
+        Decoded::Image(img) => {
+            res.keyed_images.insert(key, img);
+            return true;
+        }
+        Decoded::Svg(tree) => {
+            res.svgs.insert(id, tree);
+            if let Some(old) = res.keyed_svgs.insert(key, id) {
+                res.svgs.remove(&old);
+                res.svg_cache.remove_svg(old);
+            }
+        }
+        Decoded::Gif(gif) => {
+            res.gifs.insert(id, gif);
+            if let Some(old) = res.keyed_gifs.insert(key, id) {
+                res.gifs.remove(&old);
+            }
+        }
+        Decoded::Font(font) => {
+            res.fonts.insert(id, FontResource::Ttf(font));
+            if let Some(old) = res.keyed_fonts.insert(key, id) {
+                res.fonts.remove(&old);
+            }
+        }
+        Decoded::Mesh(..) => unreachable!("meshes are published above"),
+    }
+    res.next_id += 1;
+    true
+}
+
+/// Queue `bytes` for decoding as `kind` under `key`. Returns false for an unknown kind.
+pub(super) fn queue(kind: u32, key: u64, bytes: Vec<u8>) -> bool {
+    if !(KIND_PNG..=KIND_MESH_OBJ).contains(&kind) {
+        return false;
+    }
+    let mut loader = lock_loader();
+    let ticket = loader.next_ticket;
+    loader.next_ticket += 1;
+    loader.keys.insert(key, (ticket, STATUS_PENDING));
+
+    let job = Job {
+        ticket,
+        key,
+        kind,
+        bytes,
+    };
+    let job = match &loader.jobs {
+        Some(jobs) => match jobs.send(job) {
+            Ok(()) => return true,
+            Err(err) => err.0,
+        },
+        None => job,
+    };
+    // No live workers: decode on this thread and publish with the next batch.
+    let done = decode(job);
+    let _ = loader.done_tx.send(done);
+    true
+}
+
+/// Start decoding an asset from guest memory. Returns 1 if queued, 0 for an unknown kind or an
+/// unreadable range. The bytes are copied, so the guest may reuse the buffer immediately.
+pub fn asset_load(
+    env: &mut Caller<'_, ()>,
+    kind: u32,
+    key: u64,
+    data_ptr: u32,
+    data_len: u32,
+) -> u32 {
+    let Ok(bytes) = read_guest_bytes(env, data_ptr, data_len) else {
+        return 0;
+    };
+    queue(kind, key, bytes) as u32
+}
+
+/// Status of the latest async load of `key` (`abi::asset::STATUS_*`).
+pub fn asset_status(key: u64) -> u32 {
+    let mut loader = lock_loader();
+    loader.apply_completed();
+    loader
+        .keys
+        .get(&key)
+        .map_or(STATUS_NONE, |&(_, status)| status)
+}
+
+/// Publish finished loads, waiting up to `timeout_ms` for the rest. Returns how many loads are
+/// still pending; `0` polls without blocking (e.g. once per frame from a loading screen).
+pub fn asset_wait_all(timeout_ms: u32) -> u32 {
+    let deadline = Instant::now() + Duration::from_millis(timeout_ms as u64);
+    let mut loader = lock_loader();
+    loader.apply_completed();
+    while loader.pending() > 0 {
+        let remaining = deadline.saturating_duration_since(Instant::now());
+        if remaining.is_zero() {
+            break;
+        }
+        match loader.done_rx.recv_timeout(remaining) {
+            Ok(done) => loader.apply(done),
+            Err(RecvTimeoutError::Timeout | RecvTimeoutError::Disconnected) => break,
+        }
+    }
+    loader.pending()
+}
+
+/// Publish whatever has finished decoding. Called by the core once per frame.
+pub fn asset_apply_completed() {
+    if LOADER.get().is_some() {
+        lock_loader().apply_completed();
+    }
+}
+
+/// Forget all loads (on guest unload). In-flight results are dropped when they arrive.
+pub fn asset_reset() {
+    if LOADER.get().is_some() {
+        lock_loader().keys.clear();
+    }
+}
@@ -11,13 +11,15 @@ use wasmtime::Caller;
 // Storage ABI helpers
 use alloc::vec::Vec;
 
-use super::resources::AvError;
-use super::utils::sat_add_i16;
+use alloc::sync::Arc;
+
+use crate::abi::audio::{FORMAT_QOA, FORMAT_WAV, FORMAT_XM};
+use crate::state::AudioChannel;
 
-/// Helpers for mixing.
-/// NOTE: Higher-level playback and chiptune APIs are stubbed for now; these helpers
-/// are kept because `audio_drain_host` mixes guest-pushed audio and pads as needed.
-#[inline]
+use super::audio_ring::push_ring;
+use super::audio_stream::{PcmStream, should_stream};
+use super::mixer::{decoded_pcm, mix_voices};
+use super::resources::AvError;
 
 pub fn audio_init(sample_rate: u32) -> u32 {
     let mut s = match global().lock() {
@@ -30,268 +32,166 @@ pub fn audio_init(sample_rate: u32) -> u32 {
     1024
 }
 
-// --- Higher-level audio playback (stubs) ---
-//
-// These are intentionally stubbed so guests can link against the API.
-// Full implementations will:
-// - decode the encoded data (wav/ogg) into PCM,
-// - mix it into the output stream (multi-channel / fire-and-forget).
+// --- Higher-level audio playback ---
 //
-// Fire-and-forget: no ids/handles are returned.
-
-pub fn audio_play_wav(env: &mut Caller<'_, ()>, ptr: u32, len: u32) {
-    let memory_ptr = {
-        let s = match crate::state::global().lock() {
+// Short encoded assets (WAV/QOA) are decoded once into interleaved stereo PCM (cached by content
+// in `mixer::decoded_pcm`); long ones and XM modules are streamed through `audio_stream`. Either
+// way they play as voices that `mixer::mix_voices` resamples and mixes every frame.
+// `audio_voice_play` returns a handle for volume/pan/loop/stop; the older `audio_play_*` imports
+// are fire-and-forget looping wrappers around it.
+
+/// Start a voice playing `len` bytes of `format` (`abi::audio::FORMAT_*`) from guest memory.
+///
+/// Short assets are decoded whole, straight from guest memory, and repeated plays reuse the cached
+/// decode. Long ones (and XM modules) are copied once in encoded form and decoded a block at a
+/// time while they play, so starting a music track neither stalls the frame nor allocates its
+/// full PCM. Returns the voice handle, or 0 if the data could not be read or opened.
+pub fn audio_voice_play(
+    env: &mut Caller<'_, ()>,
+    format: u32,
+    ptr: u32,
+    len: u32,
+    looping: u32,
+) -> u32 {
+    let out_rate = {
+        let s = match global().lock() {
             Ok(g) => g,
             Err(poisoned) => poisoned.into_inner(),
         };
-        s.memory_wasmtime
-    };
-
-    if memory_ptr.is_null() {
-        return;
-    }
-
-    // SAFETY: memory pointer checked.
-    let mem = unsafe { &*memory_ptr };
-
-    // Read WAV bytes from guest memory.
-    let mut wav_bytes = vec![0u8; len as usize];
-    if mem.read(env, ptr as usize, &mut wav_bytes).is_err() {
-        return;
-    }
-
-    // Decode WAV using hound.
-    let cursor = std::io::Cursor::new(wav_bytes);
-    let reader = match hound::WavReader::new(cursor) {
-        Ok(r) => r,
-        Err(_) => return,
+        s.audio.sample_rate
     };
 
-    let spec = reader.spec();
-    let sample_rate = spec.sample_rate;
-
-    // Collect samples as i16, converting if necessary.
-    let mut samples: Vec<i16> = Vec::new();
-    for sample in reader.into_samples::<i16>() {
-        match sample {
-            Ok(s) => samples.push(s),
-            Err(_) => return,
+    let voice = {
+        let memory = match env.get_export("memory") {
+            Some(wasmtime::Extern::Memory(m)) => m,
+            _ => return 0,
+        };
+        let Some(bytes) = memory
+            .data(&*env)
+            .get(ptr as usize..(ptr as usize).saturating_add(len as usize))
+        else {
+            return 0;
+        };
+        let voice = if should_stream(format, bytes) {
+            crate::profile::bytes_in(bytes.len());
+            PcmStream::open(format, Arc::from(bytes), out_rate).map(|stream| AudioChannel {
+                sample_rate: stream.sample_rate,
+                stream: Some(stream),
+                ..AudioChannel::default()
+            })
+        } else {
+            decoded_pcm(format, bytes, out_rate).map(|d| AudioChannel {
+                pcm_stereo: d.pcm_stereo,
+                pcm_key: d.key,
+                sample_rate: d.sample_rate,
+                ..AudioChannel::default()
+            })
+        };
+        match voice {
+            Some(v) => v,
+            None => return 0,
         }
-    }
-
-    // Convert to interleaved stereo if mono.
-    let pcm_stereo: Vec<i16> = if spec.channels == 1 {
-        // Mono: duplicate to stereo.
-        samples.into_iter().flat_map(|s| [s, s]).collect()
-    } else if spec.channels == 2 {
-        // Stereo: already interleaved.
-        samples
-    } else {
-        // Unsupported channel count.
-        return;
     };
 
-    // Create a new audio channel and add to global state.
-    let channel = crate::state::AudioChannel {
-        active: true,
-        volume_q8_8: 256, // 1.0
-        pan_i16: 0,       // Center
-        loop_enabled: true,
-        pcm_stereo,
-        position_frames: 0,
-        sample_rate,
-    };
-
-    let mut s = match crate::state::global().lock() {
+    let mut s = match global().lock() {
         Ok(g) => g,
         Err(poisoned) => poisoned.into_inner(),
     };
-    s.audio.channels.push(channel);
-}
+    let audio = &mut s.audio;
+    let id = audio.next_voice_id.max(1);
+    audio.next_voice_id = id.wrapping_add(1);
 
-pub fn audio_play_qoa(env: &mut Caller<'_, ()>, ptr: u32, len: u32) {
-    let memory_ptr = {
-        let s = match crate::state::global().lock() {
-            Ok(g) => g,
-            Err(poisoned) => poisoned.into_inner(),
-        };
-        s.memory_wasmtime
-    };
-
-    if memory_ptr.is_null() {
-        return;
-    }
-
-    // SAFETY: memory pointer checked.
-    let mem = unsafe { &*memory_ptr };
-
-    // Read QOA bytes from guest memory.
-    let mut qoa_bytes = vec![0u8; len as usize];
-    if mem.read(env, ptr as usize, &mut qoa_bytes).is_err() {
-        return;
-    }
-
-    // Decode QOA using qoaudio crate.
-    let decoder = match qoaudio::QoaDecoder::new(&qoa_bytes) {
-        Ok(d) => d,
-        Err(_) => return,
-    };
-
-    let channels = decoder.channels() as usize;
-    let sample_rate = decoder.sample_rate() as u32;
-    let samples: Vec<i16> = if let Some(s) = decoder.decoded_samples() {
-        s.into_iter().collect()
-    } else {
-        return;
-    };
-
-    let pcm_stereo: Vec<i16> = if channels == 1 {
-        // Mono: duplicate to stereo.
-        samples.into_iter().flat_map(|s| [s, s]).collect()
-    } else if channels == 2 {
-        // Stereo: already interleaved.
-        samples
-    } else {
-        // Unsupported channel count.
-        return;
-    };
-
-    // Create a new audio channel and add to global state.
-    let channel = crate::state::AudioChannel {
+    audio.channels.push(AudioChannel {
+        id,
         active: true,
-        volume_q8_8: 256, // 1.0
-        pan_i16: 0,       // Center
-        loop_enabled: true,
-        pcm_stereo,
-        position_frames: 0,
-        sample_rate,
-    };
+        loop_enabled: looping != 0,
+        ..voice
+    });
+    id
+}
 
-    let mut s = match crate::state::global().lock() {
+/// Run `f` on the live voice `id`. Returns false if it has finished or never existed.
+fn with_voice(id: u32, f: impl FnOnce(&mut AudioChannel)) -> bool {
+    let mut s = match global().lock() {
         Ok(g) => g,
         Err(poisoned) => poisoned.into_inner(),
     };
-    s.audio.channels.push(channel);
-}
-
-pub fn audio_play_xm(env: &mut Caller<'_, ()>, ptr: u32, len: u32) {
-    let memory_ptr = {
-        let s = match crate::state::global().lock() {
-            Ok(g) => g,
-            Err(poisoned) => poisoned.into_inner(),
-        };
-        s.memory_wasmtime
-    };
-
-    if memory_ptr.is_null() {
-        return;
-    }
-
-    // SAFETY: memory pointer checked.
-    let mem = unsafe { &*memory_ptr };
-
-    // Read XM bytes from guest memory.
-    let mut xm_bytes = vec![0u8; len as usize];
-    if mem.read(env, ptr as usize, &mut xm_bytes).is_err() {
-        return;
-    }
-
-    // Load XM module using xmrs.
-    let xm = match xmrs::import::xm::xmmodule::XmModule::load(&xm_bytes) {
-        Ok(xm) => xm,
-        Err(_) => return,
-    };
-
-    let module = xm.to_module();
-    let module = Box::new(module);
-    let module_ref: &'static xmrs::prelude::Module = Box::leak(module);
-
-    // Get sample rate.
-    let sample_rate = {
-        let s = match crate::state::global().lock() {
-            Ok(g) => g,
-            Err(poisoned) => poisoned.into_inner(),
-        };
-        s.audio.sample_rate
-    };
-
-    // Create player.
-    let mut player =
-        xmrsplayer::prelude::XmrsPlayer::new(module_ref, sample_rate as f32, 1024, false);
-    player.set_max_loop_count(1); // Decode the song once
-
-    // Decode the entire song into PCM.
-    let mut pcm_stereo: Vec<i16> = Vec::new();
-
-    loop {
-        match player.sample(true) {
-            Some((left, right)) => {
-                let l_i16 = (left * 32767.0) as i16;
-                let r_i16 = (right * 32767.0) as i16;
-                pcm_stereo.push(l_i16);
-                pcm_stereo.push(r_i16);
-            }
-            None => break,
+    match s.audio.channels.iter_mut().find(|c| c.id == id && c.active) {
+        Some(voice) => {
+            f(voice);
+            true
         }
+        None => false,
     }
+}
 
-    // Create a new audio channel and add to global state.
-    let channel = crate::state::AudioChannel {
-        active: true,
-        volume_q8_8: 256, // 1.0
-        pan_i16: 0,       // Center
-        loop_enabled: true,
-        pcm_stereo,
-        position_frames: 0,
-        sample_rate,
-    };
+/// Set a voice's volume (Q8.8; `abi::audio::VOLUME_UNITY` is 1.0).
+pub fn audio_voice_set_volume(id: u32, volume_q8_8: u32) {
+    with_voice(id, |v| v.volume_q8_8 = volume_q8_8);
+}
 
-    let mut s = match crate::state::global().lock() {
-        Ok(g) => g,
-        Err(poisoned) => poisoned.into_inner(),
-    };
-    s.audio.channels.push(channel);
+/// Set a voice's pan (-32768 = left, 0 = center, 32767 = right).
+pub fn audio_voice_set_pan(id: u32, pan: i32) {
+    with_voice(id, |v| v.pan_i16 = pan.clamp(-32768, 32767));
 }
 
-pub fn audio_push_samples(env: &mut Caller<'_, ()>, ptr: u32, count: u32) -> Result<(), AvError> {
-    let memory_ptr = {
-        let s = match global().lock() {
-            Ok(g) => g,
-            Err(poisoned) => poisoned.into_inner(),
-        };
-        s.memory_wasmtime
-    };
+/// Enable or disable looping; a voice that stops looping ends when it reaches its end.
+pub fn audio_voice_set_loop(id: u32, looping: u32) {
+    with_voice(id, |v| v.loop_enabled = looping != 0);
+}
 
-    if memory_ptr.is_null() {
-        return Err(AvError::MissingMemory);
-    }
+/// Stop a voice. It is removed at the next mix.
+pub fn audio_voice_stop(id: u32) {
+    with_voice(id, |v| v.active = false);
+}
 
-    // SAFETY: memory pointer checked.
-    let mem = unsafe { &*memory_ptr };
+/// 1 while the voice is playing, 0 once it has finished or been stopped.
+pub fn audio_voice_is_playing(id: u32) -> u32 {
+    with_voice(id, |_| {}) as u32
+}
 
-    // Read i16 samples. count is number of i16 elements.
-    let byte_len = count.checked_mul(2).ok_or(AvError::MemoryReadFailed)?;
-    let mut tmp_bytes = vec![0u8; byte_len as usize];
+pub fn audio_play_wav(env: &mut Caller<'_, ()>, ptr: u32, len: u32) {
+    audio_voice_play(env, FORMAT_WAV, ptr, len, 1);
+}
 
-    mem.read(env, ptr as usize, &mut tmp_bytes)
-        .map_err(|_| AvError::MemoryReadFailed)?;
+pub fn audio_play_qoa(env: &mut Caller<'_, ()>, ptr: u32, len: u32) {
+    audio_voice_play(env, FORMAT_QOA, ptr, len, 1);
+}
 
-    // Convert bytes to i16
-    let mut samples = Vec::with_capacity(count as usize);
-    for chunk in tmp_bytes.chunks_exact(2) {
-        let val = i16::from_le_bytes([chunk[0], chunk[1]]);
-        samples.push(val);
-    }
+pub fn audio_play_xm(env: &mut Caller<'_, ()>, ptr: u32, len: u32) {
+    audio_voice_play(env, FORMAT_XM, ptr, len, 1);
+}
 
-    // Append to host queue
-    let mut s = match global().lock() {
-        Ok(g) => g,
-        Err(poisoned) => poisoned.into_inner(),
+/// Queue interleaved stereo `i16` samples (`count` elements) from guest memory.
+///
+/// The samples are copied once, straight from linear memory into the lock-free push ring; this
+/// takes no lock and does not allocate. Samples that do not fit in the ring are dropped (see
+/// `audio_queued_frames` for pacing). Returns the number of stereo frames queued.
+pub fn audio_push_samples(env: &mut Caller<'_, ()>, ptr: u32, count: u32) -> Result<u32, AvError> {
+    let memory = match env.get_export("memory") {
+        Some(wasmtime::Extern::Memory(m)) => m,
+        _ => return Err(AvError::MissingMemory),
     };
-    s.audio.host_queue.extend(samples);
 
-    Ok(())
+    let byte_len = (count as usize)
+        .checked_mul(2)
+        .ok_or(AvError::MemoryReadFailed)?;
+    let bytes = memory
+        .data(&*env)
+        .get(ptr as usize..(ptr as usize).saturating_add(byte_len))
+        .ok_or(AvError::MemoryReadFailed)?;
+
+    let frames = push_ring().push_le_bytes(bytes);
+    crate::profile::bytes_in(frames * 4);
+    Ok(frames as u32)
+}
+
+/// Stereo frames pushed by the guest that have not been played yet.
+///
+/// About `sample_rate / 60` frames are consumed per frame; a guest synth can top the queue up to a
+/// target latency instead of guessing how much to produce.
+pub fn audio_queued_frames() -> u32 {
+    push_ring().len() as u32
 }
 
 pub fn audio_drain_host(max_frames: u32) -> u32 {
@@ -334,69 +234,23 @@ pub fn audio_drain_host(max_frames: u32) -> u32 {
     // Start with silence; we'll mix into this.
     let mut mixed: Vec<i16> = vec![0i16; target_frames * samples_per_frame];
 
-    // Mix guest-pushed raw samples (host_queue).
+    // Mix guest-pushed raw samples (lock-free; consumed directly from the ring).
+    push_ring().mix_into(&mut mixed);
+
     {
         let mut s = match global().lock() {
             Ok(g) => g,
             Err(poisoned) => poisoned.into_inner(),
         };
 
-        let available_samples = s.audio.host_queue.len();
-        let available_frames = available_samples / samples_per_frame;
-
-        let frames_to_take = available_frames.min(target_frames);
-        let samples_to_take = frames_to_take * samples_per_frame;
-
-        if samples_to_take != 0 {
-            let drained: Vec<i16> = s.audio.host_queue.drain(0..samples_to_take).collect();
-            for (dst, src) in mixed.iter_mut().zip(drained.iter()) {
-                *dst = sat_add_i16(*dst, *src);
-            }
-        }
-
-        // Mix audio channels (higher-level playback).
-        for channel in &mut s.audio.channels {
-            if !channel.active {
-                continue;
-            }
-
-            let channel_frames = channel.pcm_stereo.len() / 2;
-            if channel.position_frames >= channel_frames {
-                if channel.loop_enabled {
-                    channel.position_frames = 0;
-                } else {
-                    channel.active = false;
-                    continue;
-                }
-            }
-
-            let start_frame = channel.position_frames;
-            let frames_to_mix = (channel_frames - start_frame).min(target_frames);
-
-            let volume = channel.volume_q8_8 as f32 / 256.0;
-            let pan_left = if channel.pan_i16 <= 0 {
-                1.0
-            } else {
-                (32768 - channel.pan_i16) as f32 / 32768.0
-            };
-            let pan_right = if channel.pan_i16 >= 0 {
-                1.0
-            } else {
-                (32768 + channel.pan_i16) as f32 / 32768.0
-            };
-
-            for i in 0..frames_to_mix {
-                let src_idx = (start_frame + i) * 2;
-                let l = (channel.pcm_stereo[src_idx] as f32 * volume * pan_left) as i16;
-                let r = (channel.pcm_stereo[src_idx + 1] as f32 * volume * pan_right) as i16;
-
-                let dst_idx = i * 2;
-                mixed[dst_idx] = sat_add_i16(mixed[dst_idx], l);
-                mixed[dst_idx + 1] = sat_add_i16(mixed[dst_idx + 1], r);
-            }
-
-            channel.position_frames += frames_to_mix;
-        }
+        // Mix voices on top of the pushed samples (resampled, f32 accumulation, one clip).
+        let audio = &mut s.audio;
+        mix_voices(
+            &mut audio.channels,
+            &mut mixed,
+            sample_rate,
+            &mut audio.mix_buffer,
+        );
     }
 
     // Upload audio
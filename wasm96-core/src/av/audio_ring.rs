@@ -0,0 +1,110 @@
+//! Lock-free ring of guest-pushed stereo frames.
+//!
+//! `audio_push_samples` (producer, guest call) writes straight from guest linear memory into the
+//! ring and `audio_drain_host` (consumer, once per frame) mixes straight out of it. Neither side
+//! allocates or takes the global state mutex. Each slot holds one interleaved frame packed as
+//! `L | R << 16` in an `AtomicU32`, so the ring needs no `unsafe`: the producer publishes written
+//! slots with a `Release` store of `head`, the consumer frees them with a `Release` store of
+//! `tail`, and each side `Acquire`s the other's index.
+
+use std::sync::OnceLock;
+use std::sync::atomic::{AtomicU32, AtomicUsize, Ordering};
+
+use super::utils::sat_add_i16;
+
+/// Ring capacity in stereo frames (power of two; ~370 ms at 44.1 kHz). Frames pushed while the
+/// ring is full are dropped, so a guest that overproduces gets bounded latency, not a growing
+/// queue.
+pub const PUSH_RING_FRAMES: usize = 1 << 14;
+
+pub struct FrameRing {
+    slots: Box<[AtomicU32]>,
+    mask: usize,
+    // Free-running counters; `head - tail` is the number of queued frames.
+    head: AtomicUsize, // next slot to write (producer-owned)
+    tail: AtomicUsize, // next slot to read (consumer-owned)
+}
+
+#[inline]
+fn pack(l: i16, r: i16) -> u32 {
+    (l as u16 as u32) | ((r as u16 as u32) << 16)
+}
+
+#[inline]
+fn unpack(frame: u32) -> (i16, i16) {
+    (frame as u16 as i16, (frame >> 16) as u16 as i16)
+}
+
+impl FrameRing {
+    /// `capacity` is rounded up to a power of two.
+    pub fn new(capacity: usize) -> Self {
+        let capacity = capacity.max(1).next_power_of_two();
+        Self {
+            slots: (0..capacity).map(|_| AtomicU32::new(0)).collect(),
+            mask: capacity - 1,
+            head: AtomicUsize::new(0),
+            tail: AtomicUsize::new(0),
+        }
+    }
+
+    pub fn capacity(&self) -> usize {
+        self.slots.len()
+    }
+
+    /// Frames currently queued.
+    pub fn len(&self) -> usize {
+        let head = self.head.load(Ordering::Acquire);
+        let tail = self.tail.load(Ordering::Acquire);
+        head.wrapping_sub(tail)
+    }
+
+    /// Producer: append interleaved little-endian `i16` stereo bytes (`L, R, L, R, ...`; a
+    /// trailing partial frame is ignored). Returns the number of frames queued.
+    pub fn push_le_bytes(&self, bytes: &[u8]) -> usize {
+        let head = self.head.load(Ordering::Relaxed);
+        let tail = self.tail.load(Ordering::Acquire);
+        let free = self.capacity() - head.wrapping_sub(tail);
+
+        let mut written = 0;
+        for frame in bytes.chunks_exact(4).take(free) {
+            let l = i16::from_le_bytes([frame[0], frame[1]]);
+            let r = i16::from_le_bytes([frame[2], frame[3]]);
+            self.slots[head.wrapping_add(written) & self.mask].store(pack(l, r), Ordering::Relaxed);
+            written += 1;
+        }
+        self.head
+            .store(head.wrapping_add(written), Ordering::Release);
+        written
+    }
+
+    /// Consumer: saturating-add up to `out.len() / 2` queued frames into interleaved `out`.
+    /// Returns the number of frames consumed.
+    pub fn mix_into(&self, out: &mut [i16]) -> usize {
+        let tail = self.tail.load(Ordering::Relaxed);
+        let head = self.head.load(Ordering::Acquire);
+        let frames = head.wrapping_sub(tail).min(out.len() / 2);
+
+        for (i, dst) in out.chunks_exact_mut(2).take(frames).enumerate() {
+            let (l, r) =
+                unpack(self.slots[tail.wrapping_add(i) & self.mask].load(Ordering::Relaxed));
+            dst[0] = sat_add_i16(dst[0], l);
+            dst[1] = sat_add_i16(dst[1], r);
+        }
+        self.tail
+            .store(tail.wrapping_add(frames), Ordering::Release);
+        frames
+    }
+
+    /// Consumer: drop everything queued.
+    pub fn clear(&self) {
+        let head = self.head.load(Ordering::Acquire);
+        self.tail.store(head, Ordering::Release);
+    }
+}
+
+static PUSH_RING: OnceLock<FrameRing> = OnceLock::new();
+
+/// The ring behind `wasm96_audio_push_samples`.
+pub fn push_ring() -> &'static FrameRing {
+    PUSH_RING.get_or_init(|| FrameRing::new(PUSH_RING_FRAMES))
+}
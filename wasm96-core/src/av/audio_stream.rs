@@ -0,0 +1,556 @@
+//! Streaming decoders for voice playback.
+//!
+//! Fully decoding a 3-minute track is ~30 MB of PCM and stalls the frame it starts on. Long WAV
+//! and QOA assets, and every XM module, are instead played from a `PcmStream`: the encoded bytes
+//! are kept and decoded one block at a time just ahead of the play cursor, from inside
+//! `audio_drain_host`. Only a few thousand frames are ever buffered per voice, whatever the length
+//! of the track.
+//!
+//! A stream also keeps the last `HISTORY_FRAMES` frames it played and tracks its position, so a
+//! savestate restore can put the play cursor back (see `PcmStream::seek`). Run-ahead jumps back
+//! a frame or two every frame, which the history covers exactly for every format. Longer jumps
+//! reposition the decoder: WAV and QOA seek to the frame, but XM modules cannot.
+//!
+//! Short assets (sound effects) are still decoded whole by `decode_all` and cached by
+//! `mixer::decoded_pcm`, since replaying them from one shared buffer is cheaper than decoding them
+//! again on every play.
+
+use core::fmt;
+use std::io::Cursor;
+use std::sync::Arc;
+
+use crate::abi::audio::{FORMAT_QOA, FORMAT_WAV, FORMAT_XM};
+
+/// Assets that decode to more PCM than this (1 MiB, ~6 s of 44.1 kHz stereo) are streamed.
+pub const STREAM_THRESHOLD_BYTES: usize = 1 << 20;
+
+/// Frames decoded per WAV block.
+const WAV_BLOCK_FRAMES: usize = 4096;
+
+/// Frames rendered per XM block (one `audio_drain_host` run at 44.1 kHz is 735).
+const XM_BLOCK_FRAMES: usize = 1024;
+
+/// Played frames kept behind the cursor for `PcmStream::seek` (~0.7 s at 44.1 kHz, 128 KiB).
+pub const HISTORY_FRAMES: usize = 1 << 15;
+
+/// A source that decodes to interleaved stereo `i16` one block at a time.
+trait Decoder: Send {
+    /// Append the next block of frames to `out`. Returns the number appended; 0 at the end.
+    fn next_block(&mut self, out: &mut Vec<i16>) -> usize;
+
+    /// Restart from the first frame. Returns false if the source cannot be reopened.
+    fn rewind(&mut self) -> bool;
+
+    /// Reposition at or before source frame `frame`. Returns the frame decoded next, or `None`
+    /// if the source cannot seek there (the decoder is then unchanged).
+    fn seek(&mut self, _frame: u64) -> Option<u64> {
+        None
+    }
+}
+
+// --- WAV ---
+
+type WavReader = hound::WavReader<Cursor<Arc<[u8]>>>;
+
+struct WavDecoder {
+    bytes: Arc<[u8]>,
+    reader: WavReader,
+    channels: usize,
+}
+
+fn open_wav(bytes: &Arc<[u8]>) -> Option<WavReader> {
+    hound::WavReader::new(Cursor::new(Arc::clone(bytes))).ok()
+}
+
+impl WavDecoder {
+    fn open(bytes: Arc<[u8]>) -> Option<(Self, u32)> {
+        let reader = open_wav(&bytes)?;
+        let spec = reader.spec();
+        let channels = spec.channels as usize;
+        if !(1..=2).contains(&channels) {
+            return None;
+        }
+        Some((
+            Self {
+                bytes,
+                reader,
+                channels,
+            },
+            spec.sample_rate,
+        ))
+    }
+}
+
+impl Decoder for WavDecoder {
+    fn next_block(&mut self, out: &mut Vec<i16>) -> usize {
+        let start = out.len();
+        // Samples are read as i16, converting if necessary.
+        for sample in self
+            .reader
+            .samples::<i16>()
+            .take(WAV_BLOCK_FRAMES * self.channels)
+        {
+            let Ok(s) = sample else { break };
+            out.push(s);
+            if self.channels == 1 {
+                // Mono: duplicate to stereo.
+                out.push(s);
+            }
+        }
+        // Drop a trailing partial frame from a truncated file.
+        out.truncate(start + (out.len() - start) / 2 * 2);
+        (out.len() - start) / 2
+    }
+
+    fn rewind(&mut self) -> bool {
+        match open_wav(&self.bytes) {
+            Some(reader) => {
+                self.reader = reader;
+                true
+            }
+            None => false,
+        }
+    }
+
+    fn seek(&mut self, frame: u64) -> Option<u64> {
+        self.reader.seek(u32::try_from(frame).ok()?).ok()?;
+        Some(frame)
+    }
+}
+
+// --- QOA ---
+//
+// QOA is decoded here rather than through a crate because it is built for exactly this: every
+// frame (up to 5120 samples per channel) carries its own predictor state, so frames decode
+// independently in order from a byte offset.
+
+const QOA_MAGIC: &[u8; 4] = b"qoaf";
+const QOA_SLICE_LEN: usize = 20;
+const QOA_SCALEFACTORS: [i32; 16] = [
+    1, 7, 21, 45, 84, 138, 211, 304, 421, 562, 731, 928, 1157, 1419, 1715, 2048,
+];
+const QOA_DEQUANT: [f32; 8] = [0.75, -0.75, 2.5, -2.5, 4.5, -4.5, 7.0, -7.0];
+
+fn read_u64_be(bytes: &[u8], at: usize) -> Option<u64> {
+    let b = bytes.get(at..at.checked_add(8)?)?;
+    Some(u64::from_be_bytes(b.try_into().ok()?))
+}
+
+/// Per-channel sign-sign LMS predictor.
+#[derive(Default, Clone, Copy)]
+struct QoaLms {
+    history: [i32; 4],
+    weights: [i32; 4],
+}
+
+impl QoaLms {
+    fn predict(&self) -> i32 {
+        let sum: i64 = (0..4)
+            .map(|i| self.weights[i] as i64 * self.history[i] as i64)
+            .sum();
+        (sum >> 13) as i32
+    }
+
+    fn update(&mut self, sample: i32, residual: i32) {
+        let delta = residual >> 4;
+        for i in 0..4 {
+            self.weights[i] += if self.history[i] < 0 { -delta } else { delta };
+        }
+        self.history.copy_within(1.., 0);
+        self.history[3] = sample;
+    }
+}
+
+struct QoaDecoder {
+    bytes: Arc<[u8]>,
+    offset: usize,
+    channels: usize,
+    dequant: [[i32; 8]; 16],
+}
+
+impl QoaDecoder {
+    /// Byte offset of the first frame (after the 8-byte file header).
+    const FIRST_FRAME: usize = 8;
+
+    fn open(bytes: Arc<[u8]>) -> Option<(Self, u32)> {
+        if bytes.get(..4)? != QOA_MAGIC {
+            return None;
+        }
+        let header = read_u64_be(&bytes, Self::FIRST_FRAME)?;
+        let channels = (header >> 56) as usize;
+        let sample_rate = ((header >> 32) & 0xff_ffff) as u32;
+        if !(1..=2).contains(&channels) {
+            return None;
+        }
+
+        let mut dequant = [[0; 8]; 16];
+        for (row, &sf) in dequant.iter_mut().zip(&QOA_SCALEFACTORS) {
+            for (d, &q) in row.iter_mut().zip(&QOA_DEQUANT) {
+                *d = (sf as f32 * q).round() as i32;
+            }
+        }
+
+        Some((
+            Self {
+                bytes,
+                offset: Self::FIRST_FRAME,
+                channels,
+                dequant,
+            },
+            sample_rate,
+        ))
+    }
+
+    /// Per-channel sample count from the file header (0 if unknown, e.g. a streamed capture).
+    fn total_samples(bytes: &[u8]) -> Option<u32> {
+        let b = bytes.get(4..8)?;
+        Some(u32::from_be_bytes(b.try_into().ok()?))
+    }
+}
+
+impl Decoder for QoaDecoder {
+    /// Decodes one QOA frame.
+    fn next_block(&mut self, out: &mut Vec<i16>) -> usize {
+        let bytes = &*self.bytes;
+        let Some(header) = read_u64_be(bytes, self.offset) else {
+            return 0;
+        };
+        let channels = (header >> 56) as usize;
+        let samples = ((header >> 16) & 0xffff) as usize;
+        let frame_size = (header & 0xffff) as usize;
+        if channels != self.channels || samples == 0 {
+            return 0;
+        }
+
+        // Predictor state: history then weights, four big-endian i16 each.
+        let mut p = self.offset + 8;
+        let mut lms = [QoaLms::default(); 2];
+        for state in lms.iter_mut().take(channels) {
+            let (Some(mut history), Some(mut weights)) =
+                (read_u64_be(bytes, p), read_u64_be(bytes, p + 8))
+            else {
+                return 0;
+            };
+            p += 16;
+            for i in 0..4 {
+                state.history[i] = (history >> 48) as i16 as i32;
+                state.weights[i] = (weights >> 48) as i16 as i32;
+                history <<= 16;
+                weights <<= 16;
+            }
+        }
+
+        // Slices: a 4-bit scalefactor and twenty 3-bit residuals each, interleaved by channel.
+        let base = out.len();
+        out.resize(base + samples * 2, 0);
+        for slice_start in (0..samples).step_by(QOA_SLICE_LEN) {
+            for (c, state) in lms.iter_mut().enumerate().take(channels) {
+                let Some(mut slice) = read_u64_be(bytes, p) else {
+                    out.truncate(base);
+                    return 0;
+                };
+                p += 8;
+
+                let scalefactor = (slice >> 60) as usize;
+                slice <<= 4;
+                let slice_end = (slice_start + QOA_SLICE_LEN).min(samples);
+                for i in slice_start..slice_end {
+                    let predicted = state.predict();
+                    let dequantized = self.dequant[scalefactor][(slice >> 61) as usize];
+                    let sample = (predicted + dequantized).clamp(-32768, 32767);
+                    slice <<= 3;
+                    state.update(sample, dequantized);
+
+                    let frame = base + i * 2;
+                    if channels == 1 {
+                        // Mono: duplicate to stereo.
+                        out[frame] = sample as i16;
+                        out[frame + 1] = sample as i16;
+                    } else {
+                        out[frame + c] = sample as i16;
+                    }
+                }
+            }
+        }
+
+        self.offset += frame_size.max(p - self.offset);
+        samples
+    }
+
+    fn rewind(&mut self) -> bool {
+        self.offset = Self::FIRST_FRAME;
+        true
+    }
+
+    /// Walks the frame headers to the frame holding `frame` (frames decode independently).
+    fn seek(&mut self, frame: u64) -> Option<u64> {
+        let mut offset = Self::FIRST_FRAME;
+        let mut start = 0u64;
+        loop {
+            let header = read_u64_be(&self.bytes, offset)?;
+            let samples = (header >> 16) & 0xffff;
+            let frame_size = (header & 0xffff) as usize;
+            if samples == 0 || frame_size == 0 {
+                return None;
+            }
+            if frame < start + samples {
+                break;
+            }
+            start += samples;
+            offset += frame_size;
+        }
+        self.offset = offset;
+        Some(start)
+    }
+}
+
+// --- XM ---
+
+type XmPlayer = xmrsplayer::prelude::XmrsPlayer<'static>;
+
+struct XmDecoder {
+    // Declared before `module` so it is dropped first: it borrows the boxed module.
+    player: XmPlayer,
+    module: Box<xmrs::prelude::Module>,
+    sample_rate: u32,
+}
+
+impl XmDecoder {
+    fn open(bytes: &[u8], sample_rate: u32) -> Option<Self> {
+        let xm = xmrs::import::xm::xmmodule::XmModule::load(bytes).ok()?;
+        let module = Box::new(xm.to_module());
+        Some(Self {
+            player: Self::player(&module, sample_rate),
+            module,
+            sample_rate,
+        })
+    }
+
+    fn player(module: &xmrs::prelude::Module, sample_rate: u32) -> XmPlayer {
+        // SAFETY: `module` is the heap allocation owned by `XmDecoder::module`, which never moves
+        // or changes while the decoder lives, and every player built from it is dropped before it
+        // (field order above, or replaced in `rewind`).
+        let module: &'static xmrs::prelude::Module =
+            unsafe { &*(module as *const xmrs::prelude::Module) };
+        let mut player = XmPlayer::new(module, sample_rate as f32, 1024, false);
+        player.set_max_loop_count(1); // Play the song once; looping is done by `rewind`
+        player
+    }
+}
+
+impl Decoder for XmDecoder {
+    fn next_block(&mut self, out: &mut Vec<i16>) -> usize {
+        let mut frames = 0;
+        while frames < XM_BLOCK_FRAMES {
+            let Some((left, right)) = self.player.sample(true) else {
+                break;
+            };
+            out.push((left * 32767.0) as i16);
+            out.push((right * 32767.0) as i16);
+            frames += 1;
+        }
+        frames
+    }
+
+    fn rewind(&mut self) -> bool {
+        self.player = Self::player(&self.module, self.sample_rate);
+        true
+    }
+}
+
+// --- Stream ---
+
+/// Where a stream's play cursor is, as saved in savestates.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct StreamPosition {
+    /// Frames played since the stream was opened (counts every loop).
+    pub played: u64,
+    /// Source frame under the cursor, within the current pass of the track.
+    pub source: u64,
+}
+
+/// A voice's decoder plus the decoded frames between its play cursor and the decode cursor.
+pub struct PcmStream {
+    decoder: Box<dyn Decoder>,
+    // Interleaved stereo. Frames before `cursor` are played history; the voice plays from `cursor`.
+    window: Vec<i16>,
+    cursor: usize,
+    exhausted: bool,
+    played: u64,
+    /// Source frame the decoder produces next.
+    decoded: u64,
+    /// Frames in one pass, known once the source has ended.
+    length: Option<u64>,
+    pub sample_rate: u32,
+}
+
+impl fmt::Debug for PcmStream {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.debug_struct("PcmStream")
+            .field("sample_rate", &self.sample_rate)
+            .field("buffered_frames", &self.ahead())
+            .field("played", &self.played)
+            .field("exhausted", &self.exhausted)
+            .finish()
+    }
+}
+
+impl PcmStream {
+    /// Open `bytes` as `format` (`abi::audio::FORMAT_*`) without decoding any audio yet. XM
+    /// modules are rendered at `out_rate`; WAV and QOA keep their own rate.
+    pub fn open(format: u32, bytes: Arc<[u8]>, out_rate: u32) -> Option<Self> {
+        let (decoder, sample_rate): (Box<dyn Decoder>, u32) = match format {
+            FORMAT_WAV => {
+                let (d, rate) = WavDecoder::open(bytes)?;
+                (Box::new(d), rate)
+            }
+            FORMAT_QOA => {
+                let (d, rate) = QoaDecoder::open(bytes)?;
+                (Box::new(d), rate)
+            }
+            FORMAT_XM => (Box::new(XmDecoder::open(&bytes, out_rate)?), out_rate),
+            _ => return None,
+        };
+        Some(Self {
+            decoder,
+            window: Vec::new(),
+            cursor: 0,
+            exhausted: false,
+            played: 0,
+            decoded: 0,
+            length: None,
+            sample_rate,
+        })
+    }
+
+    /// Decoded frames from the play cursor on (interleaved stereo).
+    pub fn window(&self) -> &[i16] {
+        &self.window[self.cursor * 2..]
+    }
+
+    /// Frames buffered ahead of the play cursor.
+    fn ahead(&self) -> usize {
+        self.window.len() / 2 - self.cursor
+    }
+
+    /// True once the decoder has nothing left beyond `window`.
+    pub fn exhausted(&self) -> bool {
+        self.exhausted
+    }
+
+    /// Decode ahead until at least `frames` frames are buffered or the source ends. A looping
+    /// stream rewinds at the end and keeps decoding, so the loop point is seamless.
+    pub fn fill(&mut self, frames: usize, looping: bool) {
+        let mut rewound = false;
+        while self.ahead() < frames {
+            if !self.exhausted {
+                let n = self.decoder.next_block(&mut self.window);
+                if n > 0 {
+                    self.decoded += n as u64;
+                    rewound = false;
+                    continue;
+                }
+                self.exhausted = true;
+            }
+            // Rewind at most once without progress, so an empty source cannot spin.
+            if !looping || rewound || !self.decoder.rewind() {
+                break;
+            }
+            if self.decoded > 0 {
+                self.length = Some(self.decoded);
+            }
+            self.decoded = 0;
+            rewound = true;
+            self.exhausted = false;
+        }
+    }
+
+    /// Advance the play cursor past `frames` played frames, keeping `HISTORY_FRAMES` of them.
+    pub fn consume(&mut self, frames: usize) {
+        let frames = frames.min(self.ahead());
+        self.cursor += frames;
+        self.played += frames as u64;
+        // Trim in bulk, so the drain is amortized over `HISTORY_FRAMES` frames of playback.
+        if self.cursor >= 2 * HISTORY_FRAMES {
+            let drop = self.cursor - HISTORY_FRAMES;
+            self.window.drain(..drop * 2);
+            self.cursor = HISTORY_FRAMES;
+        }
+    }
+
+    pub fn position(&self) -> StreamPosition {
+        let ahead = self.ahead() as u64;
+        // A looping stream may already hold the start of the next pass past the cursor.
+        let source = match self.decoded.checked_sub(ahead) {
+            Some(source) => source,
+            None => (self.decoded + self.length.unwrap_or(0)).saturating_sub(ahead),
+        };
+        StreamPosition {
+            played: self.played,
+            source,
+        }
+    }
+
+    /// Move the play cursor to `to`, a `position()` of this stream. Returns false (changing
+    /// nothing) if `to` is outside the buffered frames and the decoder cannot seek there.
+    pub fn seek(&mut self, to: StreamPosition) -> bool {
+        if to.played <= self.played {
+            let back = self.played - to.played;
+            if back <= self.cursor as u64 {
+                self.cursor -= back as usize;
+                self.played = to.played;
+                return true;
+            }
+        } else if to.played - self.played <= self.ahead() as u64 {
+            self.consume((to.played - self.played) as usize);
+            return true;
+        }
+
+        let Some(landed) = self.decoder.seek(to.source) else {
+            return false;
+        };
+        self.window.clear();
+        self.cursor = 0;
+        self.decoded = landed;
+        self.exhausted = false;
+        // Decode up to the frame itself (QOA lands on the start of its frame).
+        let skip = (to.source - landed) as usize;
+        self.fill(skip, false);
+        let skip = skip.min(self.window.len() / 2);
+        self.window.drain(..skip * 2);
+        self.played = to.played;
+        true
+    }
+}
+
+/// Decoded PCM size of `bytes` read from the header, or `None` when unknown up front (XM, or a
+/// QOA file without a sample count).
+fn decoded_len_hint(format: u32, bytes: &[u8]) -> Option<usize> {
+    match format {
+        FORMAT_WAV => {
+            let reader = hound::WavReader::new(Cursor::new(bytes)).ok()?;
+            Some(reader.duration() as usize * 4)
+        }
+        FORMAT_QOA => match QoaDecoder::total_samples(bytes)? {
+            0 => None,
+            samples => Some(samples as usize * 4),
+        },
+        _ => None,
+    }
+}
+
+/// Whether an asset should be played from a `PcmStream` instead of decoded whole.
+pub fn should_stream(format: u32, bytes: &[u8]) -> bool {
+    decoded_len_hint(format, bytes).is_none_or(|len| len > STREAM_THRESHOLD_BYTES)
+}
+
+/// Decode an entire asset. Returns the interleaved stereo PCM and its sample rate, or `None` if
+/// it could not be opened or holds no audio.
+pub fn decode_all(format: u32, bytes: &[u8], out_rate: u32) -> Option<(Vec<i16>, u32)> {
+    let mut stream = PcmStream::open(format, Arc::from(bytes), out_rate)?;
+    stream.fill(usize::MAX, false);
+    if stream.window.is_empty() {
+        return None;
+    }
+    Some((stream.window, stream.sample_rate))
+}
@@ -0,0 +1,129 @@
+//! Batched draw commands (`wasm96_graphics_submit`).
+//!
+//! Guests append fixed-layout records (see `abi::commands`) to a buffer in linear memory and
+//! submit the whole buffer with one import call. The list is decoded straight out of guest memory
+//! (no copy) and executed against the software framebuffer while holding the global lock once,
+//! instead of once per primitive.
+
+use wasmtime::Caller;
+
+use crate::abi::commands::{self, WORD_SIZE};
+
+use super::graphics::{background_color, lock_state};
+use super::raster;
+
+/// Execute a packed command list stored in guest memory.
+///
+/// Returns the number of records executed. An out-of-bounds range executes nothing.
+pub fn graphics_submit(caller: &mut Caller<'_, ()>, ptr: u32, len: u32) -> u32 {
+    let memory = match caller.get_export("memory").and_then(|e| e.into_memory()) {
+        Some(m) => m,
+        None => return 0,
+    };
+
+    let data = memory.data(&*caller);
+    let start = ptr as usize;
+    let Some(end) = start.checked_add(len as usize) else {
+        return 0;
+    };
+    match data.get(start..end) {
+        Some(bytes) => execute_commands(bytes),
+        None => 0,
+    }
+}
+
+/// Decode and execute a packed command list.
+///
+/// Trailing bytes that do not form a whole word are ignored. Execution stops at the first
+/// truncated record or at a known opcode with too few arguments.
+pub fn execute_commands(bytes: &[u8]) -> u32 {
+    let word_count = bytes.len() / WORD_SIZE;
+    let word = |i: usize| {
+        let o = i * WORD_SIZE;
+        u32::from_le_bytes([bytes[o], bytes[o + 1], bytes[o + 2], bytes[o + 3]])
+    };
+
+    let mut s = lock_state();
+    let mut executed = 0u32;
+    let mut pc = 0usize;
+
+    while pc < word_count {
+        let header = word(pc);
+        let opcode = header & 0xFFFF;
+        let argc = (header >> 16) as usize;
+        let base = pc + 1;
+        if base + argc > word_count {
+            break;
+        }
+        pc = base + argc;
+
+        let Some(expected) = commands::arg_count(opcode) else {
+            // Unknown opcode: skip it using its self-described length.
+            continue;
+        };
+        if argc < expected {
+            break;
+        }
+
+        let u = |n: usize| word(base + n);
+        let i = |n: usize| word(base + n) as i32;
+
+        match opcode {
+            commands::SET_COLOR => {
+                s.video.draw_color = raster::pack_color(u(0), u(1), u(2), u(3));
+            }
+            commands::BACKGROUND => {
+                // The GL clear takes the GL state lock, which must be acquired before the
+                // global lock (see `graphics3d::flush_to_host`), so release ours around it.
+                drop(s);
+                let gl_cleared = super::graphics3d::clear_framebuffer(
+                    u(0) as f32 / 255.0,
+                    u(1) as f32 / 255.0,
+                    u(2) as f32 / 255.0,
+                    1.0,
+                );
+                s = lock_state();
+                raster::clear(&mut s.video, background_color(u(0), u(1), u(2), gl_cleared));
+            }
+            commands::POINT => raster::point(&mut s.video, i(0), i(1)),
+            commands::LINE => raster::line(&mut s.video, i(0), i(1), i(2), i(3)),
+            commands::RECT => raster::rect(&mut s.video, i(0), i(1), u(2), u(3)),
+            commands::RECT_OUTLINE => raster::rect_outline(&mut s.video, i(0), i(1), u(2), u(3)),
+            commands::CIRCLE => raster::circle(&mut s.video, i(0), i(1), u(2)),
+            commands::CIRCLE_OUTLINE => raster::circle_outline(&mut s.video, i(0), i(1), u(2)),
+            commands::TRIANGLE => {
+                raster::triangle(&mut s.video, i(0), i(1), i(2), i(3), i(4), i(5));
+            }
+            commands::TRIANGLE_OUTLINE => {
+                raster::triangle_outline(&mut s.video, i(0), i(1), i(2), i(3), i(4), i(5));
+            }
+            commands::BEZIER_QUADRATIC => {
+                raster::bezier_quadratic(&mut s.video, i(0), i(1), i(2), i(3), i(4), i(5), u(6));
+            }
+            commands::BEZIER_CUBIC => {
+                raster::bezier_cubic(
+                    &mut s.video,
+                    i(0),
+                    i(1),
+                    i(2),
+                    i(3),
+                    i(4),
+                    i(5),
+                    i(6),
+                    i(7),
+                    u(8),
+                );
+            }
+            commands::PILL => raster::pill(&mut s.video, i(0), i(1), u(2), u(3)),
+            commands::PILL_OUTLINE => raster::pill_outline(&mut s.video, i(0), i(1), u(2), u(3)),
+            commands::CLEAR_RECT => {
+                let color = background_color(u(4), u(5), u(6), super::graphics3d::gl_available());
+                raster::clear_rect(&mut s.video, i(0), i(1), u(2), u(3), color);
+            }
+            _ => continue,
+        }
+        executed += 1;
+    }
+
+    executed
+}
@@ -0,0 +1,184 @@
+//! Retained draw lists (`wasm96_graphics_list_*`).
+//!
+//! Static screen parts (a board frame, grid lines, HUD chrome) are otherwise re-issued call by call
+//! every frame. Between `list_begin(key)` and `list_end()` every 2D primitive (per-call imports and
+//! `wasm96_graphics_submit` command lists alike) is captured in `raster::submit` with its color
+//! instead of being drawn. `list_draw(key, dx, dy)` then replays the whole list with one call:
+//! - Short lists, and lists containing clears, are replayed shape by shape. They go through
+//!   `raster::submit` like any other primitive, so they are deferred, tiled or drawn on the GPU with
+//!   the rest of the frame.
+//! - Lists of `LAYER_MIN_OPS` or more shapes are also rasterized once, at `list_end`, into a
+//!   premultiplied layer covering their bounds. Replaying one is a single blit, which also removes
+//!   all overdraw. Source-over composites associatively, so the layer blends onto what is
+//!   underneath like the shapes would (up to rounding). No layer is built when a GL context draws
+//!   the primitives, because that blit would be a CPU barrier for the GPU pass.
+//!
+//! Bitmap (BDF/Spleen) text is captured too, because `graphics::draw_text` issues it as one rect
+//! per glyph row span. TTF/OTF text, images and sprites are not captured: they resolve pending
+//! shapes and draw immediately even while recording. A list drawn while another is recording is
+//! captured into it shape by shape.
+
+use crate::state::VideoState;
+
+use super::graphics::lock_state;
+use super::raster::{self, Canvas, Shape};
+use super::resources::RESOURCES;
+
+/// Lists at least this long get a pre-rasterized layer.
+pub const LAYER_MIN_OPS: usize = 16;
+
+/// Largest layer built, in pixels (bigger lists are replayed shape by shape).
+const LAYER_MAX_PIXELS: u64 = 1 << 20;
+
+/// Shapes captured since `list_begin`; lives in `VideoState::recording`.
+#[derive(Debug, Default)]
+pub struct Recording {
+    key: u64,
+    ops: Vec<(Shape, u32)>,
+}
+
+impl Recording {
+    pub fn push(&mut self, shape: Shape, color: u32) {
+        self.ops.push((shape, color));
+    }
+}
+
+/// Premultiplied 0xAARRGGBB pixels covering a list's bounds, with its top-left corner.
+struct Layer {
+    x: i32,
+    y: i32,
+    w: u32,
+    h: u32,
+    pixels: Vec<u32>,
+}
+
+/// A finished list, keyed in `Resources::draw_lists`.
+pub struct DrawList {
+    ops: Vec<(Shape, u32)>,
+    layer: Option<Layer>,
+}
+
+impl DrawList {
+    /// Build the list from captured shapes, rasterizing its layer if it qualifies.
+    pub fn new(ops: Vec<(Shape, u32)>, build_layer: bool) -> Self {
+        let layer = if build_layer && ops.len() >= LAYER_MIN_OPS {
+            rasterize_layer(&ops)
+        } else {
+            None
+        };
+        Self { ops, layer }
+    }
+
+    pub fn len(&self) -> usize {
+        self.ops.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.ops.is_empty()
+    }
+
+    /// Whether replays are a single blit.
+    pub fn has_layer(&self) -> bool {
+        self.layer.is_some()
+    }
+
+    /// Replay the list offset by (`dx`, `dy`).
+    pub fn draw(&self, v: &mut VideoState, dx: i32, dy: i32) {
+        match &self.layer {
+            // While recording, the shapes themselves are captured instead.
+            Some(l) if v.recording.is_none() => {
+                raster::blit_premultiplied(v, l.x + dx, l.y + dy, l.w, l.h, &l.pixels);
+            }
+            _ => {
+                for &(shape, color) in &self.ops {
+                    raster::replay(v, shape.translated(dx, dy), color);
+                }
+            }
+        }
+    }
+}
+
+/// Draw `ops` onto a transparent layer of their bounding box. `None` if the list clears (a clear
+/// writes pixels rather than blending, so it cannot be composited) or the layer would be too
+/// large or empty.
+fn rasterize_layer(ops: &[(Shape, u32)]) -> Option<Layer> {
+    let mut bounds: Option<(i32, i32, i32, i32)> = None;
+    for (shape, _) in ops {
+        if matches!(shape, Shape::Clear | Shape::ClearRect { .. }) {
+            return None;
+        }
+        let (x0, y0, x1, y1) = shape.bounds();
+        if x0 >= x1 || y0 >= y1 {
+            continue;
+        }
+        bounds = Some(match bounds {
+            Some((a, b, c, d)) => (a.min(x0), b.min(y0), c.max(x1), d.max(y1)),
+            None => (x0, y0, x1, y1),
+        });
+    }
+    let (x0, y0, x1, y1) = bounds?;
+    let (w, h) = (x1 as i64 - x0 as i64, y1 as i64 - y0 as i64);
+    if (w * h) as u64 > LAYER_MAX_PIXELS {
+        return None;
+    }
+    let (w, h) = (w as u32, h as u32);
+
+    let mut pixels = vec![0u32; (w * h) as usize];
+    let mut canvas = Canvas {
+        pixels: &mut pixels,
+        width: w as i32,
+        y0: 0,
+        y1: h as i32,
+        spans: None,
+    };
+    for &(shape, color) in ops {
+        shape.translated(-x0, -y0).draw(&mut canvas, color);
+    }
+    Some(Layer {
+        x: x0,
+        y: y0,
+        w,
+        h,
+        pixels,
+    })
+}
+
+/// Start capturing primitives into list `key`. A list already being recorded is abandoned.
+pub fn graphics_list_begin(key: u64) {
+    lock_state().video.recording = Some(Recording {
+        key,
+        ops: Vec::new(),
+    });
+}
+
+/// Finish the current recording, replacing any list with its key.
+///
+/// Returns the number of primitives captured (`0` if nothing was being recorded).
+pub fn graphics_list_end() -> u32 {
+    // Lock order: RESOURCES before the global state.
+    let mut res = RESOURCES.lock().unwrap();
+    let (rec, gpu) = {
+        let mut s = lock_state();
+        let gpu = s.video.display_list.is_gpu();
+        (s.video.recording.take(), gpu)
+    };
+    let Some(rec) = rec else {
+        return 0;
+    };
+    let count = rec.ops.len() as u32;
+    res.draw_lists.insert(rec.key, DrawList::new(rec.ops, !gpu));
+    count
+}
+
+/// Replay list `key` offset by (`dx`, `dy`) pixels. Unknown keys draw nothing.
+pub fn graphics_list_draw(key: u64, dx: i32, dy: i32) {
+    let res = RESOURCES.lock().unwrap();
+    if let Some(list) = res.draw_lists.get(&key) {
+        list.draw(&mut lock_state().video, dx, dy);
+    }
+}
+
+/// Drop list `key`.
+pub fn graphics_list_destroy(key: u64) {
+    RESOURCES.lock().unwrap().draw_lists.remove(&key);
+}
@@ -0,0 +1,253 @@
+//! Streaming GIF playback.
+//!
+//! Compositing every frame at register time costs `width * height * 4` bytes per frame (a
+//! 200-frame 320x240 GIF is ~60 MB) and stalls the register call. Instead a registered GIF keeps
+//! its compressed bytes and per-frame delays. Frames are decoded and composited on demand by a
+//! cursor that walks the file forward (restarting from frame 0 when playback loops), and recently
+//! composited frames are kept in a small byte-budgeted cache. Small GIFs end up fully cached after
+//! one loop; large ones hold the file plus a few canvases.
+
+use std::io::Cursor;
+use std::sync::Arc;
+
+use super::lru_cache::LruCache;
+
+/// Byte budget for each GIF's cache of composited RGBA frames (1 MiB, ~3 frames at 320x240).
+pub const GIF_FRAME_CACHE_BYTES: usize = 1 << 20;
+
+type GifDecoder = gif::Decoder<Cursor<Arc<[u8]>>>;
+
+fn open_decoder(data: &Arc<[u8]>) -> Option<GifDecoder> {
+    gif::DecodeOptions::new()
+        .read_info(Cursor::new(Arc::clone(data)))
+        .ok()
+}
+
+/// Composition state carried from one frame to the next (canvas plus pending disposal).
+struct Compositor {
+    width: u16,
+    height: u16,
+    canvas: Vec<u8>,
+    // Backup for "Restore to Previous" disposal
+    previous_canvas: Vec<u8>,
+    last_disposal: gif::DisposalMethod,
+    last_rect: (u16, u16, u16, u16), // left, top, width, height
+}
+
+impl Compositor {
+    fn new(width: u16, height: u16) -> Self {
+        let canvas = vec![0u8; width as usize * height as usize * 4];
+        Self {
+            width,
+            height,
+            previous_canvas: canvas.clone(),
+            canvas,
+            last_disposal: gif::DisposalMethod::Any,
+            last_rect: (0, 0, 0, 0),
+        }
+    }
+
+    /// Dispose of the previous frame, then draw `frame` onto the canvas.
+    fn apply(&mut self, frame: &gif::Frame<'_>, global_palette: Option<&[u8]>) {
+        let (width, height) = (self.width, self.height);
+
+        // 1. Handle disposal of the *previous* frame
+        match self.last_disposal {
+            gif::DisposalMethod::Any | gif::DisposalMethod::Keep => {
+                // Do nothing, draw on top
+            }
+            gif::DisposalMethod::Background => {
+                // Restore background (transparent) for the area of the previous frame
+                let (lx, ly, lw, lh) = self.last_rect;
+                for y in ly..(ly + lh) {
+                    if y >= height {
+                        break;
+                    }
+                    for x in lx..(lx + lw) {
+                        if x >= width {
+                            break;
+                        }
+                        let idx = ((y as usize) * (width as usize) + (x as usize)) * 4;
+                        if idx + 3 < self.canvas.len() {
+                            self.canvas[idx..idx + 4].fill(0);
+                        }
+                    }
+                }
+            }
+            gif::DisposalMethod::Previous => {
+                // Restore to state before previous frame
+                self.canvas.copy_from_slice(&self.previous_canvas);
+            }
+        }
+
+        // Save state if *current* frame says "Restore to Previous" (for the next frame)
+        if frame.dispose == gif::DisposalMethod::Previous {
+            self.previous_canvas.copy_from_slice(&self.canvas);
+        }
+
+        self.last_disposal = frame.dispose;
+        self.last_rect = (frame.left, frame.top, frame.width, frame.height);
+
+        // 2. Draw current frame onto canvas
+        let Some(palette) = frame.palette.as_deref().or(global_palette) else {
+            return;
+        };
+        let canvas = &mut self.canvas;
+        let transparent_idx = frame.transparent;
+        let fw = frame.width as usize;
+        let fh = frame.height as usize;
+        let fl = frame.left as usize;
+        let ft = frame.top as usize;
+
+        // Helper to write a pixel
+        let mut put_pixel = |x: usize, y: usize, color_idx: u8| {
+            if Some(color_idx) == transparent_idx {
+                return;
+            }
+            let base = (color_idx as usize) * 3;
+            if base + 2 >= palette.len() {
+                return;
+            }
+            let cx = fl + x;
+            let cy = ft + y;
+            if cx < width as usize && cy < height as usize {
+                let idx = (cy * (width as usize) + cx) * 4;
+                canvas[idx..idx + 3].copy_from_slice(&palette[base..base + 3]);
+                canvas[idx + 3] = 255;
+            }
+        };
+
+        if frame.interlaced {
+            let mut offset = 0;
+            // Passes: every 8th row from 0, every 8th from 4, every 4th from 2, every 2nd from 1
+            for (start, step) in [(0, 8), (4, 8), (2, 4), (1, 2)] {
+                for y in (start..fh).step_by(step) {
+                    for x in 0..fw {
+                        if offset < frame.buffer.len() {
+                            put_pixel(x, y, frame.buffer[offset]);
+                            offset += 1;
+                        }
+                    }
+                }
+            }
+        } else if fw > 0 {
+            // Normal
+            for (i, &idx) in frame.buffer.iter().enumerate() {
+                put_pixel(i % fw, i / fw, idx);
+            }
+        }
+    }
+}
+
+/// A decoder positioned after frame `next - 1`, with the canvas composited up to that frame.
+struct FrameCursor {
+    decoder: GifDecoder,
+    next: usize,
+    compositor: Compositor,
+}
+
+pub struct GifStream {
+    data: Arc<[u8]>,
+    global_palette: Option<Vec<u8>>,
+    pub delays: Vec<u16>, // in 10ms units
+    pub width: u16,
+    pub height: u16,
+    cursor: Option<FrameCursor>,
+    frames: LruCache<usize, Vec<u8>>, // composited RGBA by frame index
+}
+
+impl GifStream {
+    /// Parse the header and frame descriptors of `data`. Pixel data is not decoded here.
+    /// Returns `None` if the file is not a GIF or has no frames.
+    pub fn new(data: Vec<u8>) -> Option<Self> {
+        let data: Arc<[u8]> = data.into();
+        let mut decoder = open_decoder(&data)?;
+        let width = decoder.width();
+        let height = decoder.height();
+        let global_palette = decoder.global_palette().map(|p| p.to_vec());
+
+        let mut delays = Vec::new();
+        while let Some(frame) = decoder.next_frame_info().ok()? {
+            delays.push(frame.delay);
+        }
+        if delays.is_empty() {
+            return None;
+        }
+
+        Some(Self {
+            data,
+            global_palette,
+            delays,
+            width,
+            height,
+            cursor: None,
+            frames: LruCache::with_budget(GIF_FRAME_CACHE_BYTES),
+        })
+    }
+
+    pub fn frame_count(&self) -> usize {
+        self.delays.len()
+    }
+
+    /// Index of the frame showing at `millis` into a looping playback.
+    pub fn frame_at(&self, millis: u64) -> usize {
+        let total_delay_ms: u64 = self.delays.iter().map(|&d| d as u64 * 10).sum();
+        if total_delay_ms == 0 {
+            return 0;
+        }
+        let mut rem = millis % total_delay_ms;
+        for (i, &d) in self.delays.iter().enumerate() {
+            let d_ms = d as u64 * 10;
+            // Treat 0 delay as 100ms (common GIF viewer behavior)
+            let effective_delay = if d_ms == 0 { 100 } else { d_ms };
+            if rem < effective_delay {
+                return i;
+            }
+            rem = rem.saturating_sub(effective_delay);
+        }
+        0
+    }
+
+    /// Composited RGBA (`width * height * 4` bytes) for frame `index`, decoding it if needed.
+    pub fn frame(&mut self, index: usize) -> Option<&[u8]> {
+        if index >= self.frame_count() {
+            return None;
+        }
+        if !self.frames.contains_key(&index) {
+            let rgba = self.composite(index)?;
+            let cost = rgba.len();
+            self.frames.insert(index, rgba, cost);
+        }
+        self.frames.get(&index).map(Vec::as_slice)
+    }
+
+    /// Advance the cursor to `index` (rewinding to the start if it is already past it) and
+    /// return a copy of the canvas. Dropping the cursor on a decode error means the next call
+    /// starts over.
+    fn composite(&mut self, index: usize) -> Option<Vec<u8>> {
+        if self.cursor.as_ref().is_none_or(|c| c.next > index) {
+            self.cursor = Some(FrameCursor {
+                decoder: open_decoder(&self.data)?,
+                next: 0,
+                compositor: Compositor::new(self.width, self.height),
+            });
+        }
+        let cursor = self.cursor.as_mut()?;
+        while cursor.next <= index {
+            let decoded = match cursor.decoder.read_next_frame() {
+                Ok(Some(frame)) => {
+                    let palette = self.global_palette.as_deref();
+                    cursor.compositor.apply(frame, palette);
+                    true
+                }
+                _ => false,
+            };
+            if !decoded {
+                self.cursor = None;
+                return None;
+            }
+            cursor.next += 1;
+        }
+        Some(cursor.compositor.canvas.clone())
+    }
+}
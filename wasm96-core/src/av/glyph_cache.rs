@@ -0,0 +1,97 @@
+//! Rasterized glyph cache for TTF/OTF text.
+//!
+//! `fontdue` rasterization is by far the most expensive part of drawing text, and guests redraw the
+//! same strings (scores, HUDs, debug overlays) every frame. Coverage bitmaps are cached per
+//! `(font_id, char, px)` and reused until the cache exceeds its byte budget, at which point the
+//! least recently used glyphs are evicted (see `lru_cache`).
+
+use std::sync::Arc;
+
+use super::lru_cache::LruCache;
+
+/// Default byte budget for cached coverage bitmaps (1 MiB).
+pub const DEFAULT_GLYPH_CACHE_BYTES: usize = 1 << 20;
+
+/// Cache key: host font id, character, and pixel size (as `f32` bits, so it can be hashed).
+#[derive(Clone, Copy, PartialEq, Eq, Hash, Debug)]
+pub struct GlyphKey {
+    pub font_id: u32,
+    pub ch: char,
+    pub px_bits: u32,
+}
+
+impl GlyphKey {
+    pub fn new(font_id: u32, ch: char, px: f32) -> Self {
+        Self {
+            font_id,
+            ch,
+            px_bits: px.to_bits(),
+        }
+    }
+}
+
+/// A rasterized glyph: an 8-bit coverage bitmap (row-major, `width * height`) plus the metrics
+/// needed to lay it out. The bitmap is shared with the blits that draw it, so an evicted glyph
+/// stays valid for a frame that still has it recorded.
+pub struct CachedGlyph {
+    pub width: usize,
+    pub height: usize,
+    pub advance_width: f32,
+    pub coverage: Arc<[u8]>,
+}
+
+pub struct GlyphCache {
+    inner: LruCache<GlyphKey, CachedGlyph>,
+}
+
+impl Default for GlyphCache {
+    fn default() -> Self {
+        Self::with_budget(DEFAULT_GLYPH_CACHE_BYTES)
+    }
+}
+
+impl GlyphCache {
+    pub fn with_budget(budget_bytes: usize) -> Self {
+        Self {
+            inner: LruCache::with_budget(budget_bytes),
+        }
+    }
+
+    /// Look up a glyph, rasterizing it with `rasterize` on a miss.
+    ///
+    /// `rasterize` returns `(width, height, advance_width, coverage)`.
+    pub fn get_or_insert_with(
+        &mut self,
+        key: GlyphKey,
+        rasterize: impl FnOnce() -> (usize, usize, f32, Vec<u8>),
+    ) -> &CachedGlyph {
+        self.inner.get_or_insert_with(key, || {
+            let (width, height, advance_width, coverage) = rasterize();
+            let cost = coverage.len() + core::mem::size_of::<CachedGlyph>();
+            let glyph = CachedGlyph {
+                width,
+                height,
+                advance_width,
+                coverage: coverage.into(),
+            };
+            (glyph, cost)
+        })
+    }
+
+    /// Drop every cached glyph belonging to `font_id` (called when the font is unregistered).
+    pub fn remove_font(&mut self, font_id: u32) {
+        self.inner.retain(|k| k.font_id != font_id);
+    }
+
+    pub fn len(&self) -> usize {
+        self.inner.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.inner.is_empty()
+    }
+
+    pub fn used_bytes(&self) -> usize {
+        self.inner.used_bytes()
+    }
+}
@@ -0,0 +1,507 @@
+//! GPU path for the deferred 2D primitives and blits.
+//!
+//! With a GL context `tiles` records every primitive and blit (see `DisplayList::is_deferred`),
+//! and `graphics3d::flush_to_host` hands the list to this pass instead of rasterizing it:
+//! - Every shape is run through the software rasterizer on a recording `Canvas`, which yields
+//!   the clipped spans it would write. Runs of rows with the same span become one axis-aligned
+//!   quad, so rects are a single quad and curves a few per row.
+//! - Keyed images, sprites and TTF glyphs (`sprites::Blit`) are one textured quad each. The
+//!   fragment shader steps through the source rect in the same 16.16 fixed point as
+//!   `Blit::draw`, with the same flips and integer tint, and samples with `texelFetch`.
+//! - Textures are uploaded once per set of texels and kept while anything holds those texels
+//!   (the image registry, the glyph cache or a recorded op), so a HUD redrawn every frame
+//!   uploads nothing.
+//! - All quads go into one streamed instance buffer, drawn in order with one instanced call
+//!   per change of texture, into the output framebuffer on top of the 3D scene and the overlay.
+//! - Quads have whole-pixel bounds, so the GPU covers exactly the pixels the CPU would, and a
+//!   list later rasterized on the CPU (a barrier, a savestate) matches what was shown. There is
+//!   no anti-aliasing on either path.
+//! - Colors are premultiplied and blended like the overlay, so translucent shapes composite the
+//!   same way as on the CPU.
+//!
+//! The host framebuffer stays the software 2D layer. Raw and SVG blits, tilemaps and everything
+//! drawn before a resolve barrier still reach the overlay texture, and the pass draws what was
+//! recorded after the last barrier on top of it. When the list starts with a full clear the
+//! software layer is hidden, so its upload and composite are skipped entirely.
+//!
+//! Drawn ops stay recorded, because the immediate-mode framebuffer persists into the next frame:
+//! a later barrier or savestate rasterizes them on the CPU and re-damages what the GPU drew.
+//! Lists the pass cannot draw (a partial clear, a full clear after other ops, a texture larger
+//! than `MAX_TEXTURE_SIZE`, more than `MAX_OPS`) are rasterized at present as before.
+
+use std::collections::HashMap;
+use std::ffi::c_void;
+use std::sync::{Arc, Weak};
+
+use bytemuck::{Pod, Zeroable};
+
+use crate::abi::sprites::{FLIP_X, FLIP_Y, TINT_NONE};
+use crate::state::{DamageRect, VideoState};
+
+use super::raster::{Canvas, Shape, Span};
+use super::sprites::Blit;
+use super::tiles::{Item, Op};
+
+/// Longest list the pass draws; longer ones (a guest that never clears) are rasterized instead,
+/// which also bounds how much the retained list can grow.
+pub const MAX_OPS: usize = 16 * 1024;
+
+/// Largest texture side the pass uploads (every GL 3.3 driver in use supports it); frames that
+/// blit from bigger images are rasterized instead.
+pub const MAX_TEXTURE_SIZE: u32 = 4096;
+
+/// `Quad::flags`: sample the bound texture instead of filling `Quad::color`.
+const QUAD_TEXTURED: u32 = 1;
+/// `Quad::flags`: one coverage byte per texel, painted in `Quad::tint`.
+const QUAD_COVERAGE: u32 = 2;
+/// `Quad::flags`: multiply RGBA texels by `Quad::tint`.
+const QUAD_TINTED: u32 = 4;
+/// `Quad::flags`: mirror the source rect horizontally.
+const QUAD_FLIP_X: u32 = 8;
+/// `Quad::flags`: mirror the source rect vertically.
+const QUAD_FLIP_Y: u32 = 16;
+
+/// One instance of the pass: a pixel rectangle in one color, or a blit.
+#[repr(C)]
+#[derive(Copy, Clone, Debug, Default, PartialEq, Pod, Zeroable)]
+pub struct Quad {
+    /// `x0, y0, x1, y1` in framebuffer pixels, y down, half-open.
+    pub rect: [f32; 4],
+    /// Premultiplied RGBA of a solid quad.
+    pub color: [f32; 4],
+    /// Blits: unclipped top-left of the destination, which source stepping counts from.
+    pub origin: [f32; 2],
+    /// Blits: 16.16 source steps per destination pixel (`Blit::steps`).
+    pub step: [u32; 2],
+    /// Blits: source rect `x, y, w, h` in texels.
+    pub src: [u32; 4],
+    /// Blits: 0xAARRGGBB tint.
+    pub tint: u32,
+    /// `QUAD_*` bits.
+    pub flags: u32,
+}
+
+/// Location, components, GL type, integer attribute and byte offset of each `Quad` field.
+const ATTRIBUTES: [(u32, i32, u32, bool, usize); 6] = [
+    (0, 4, gl::FLOAT, false, 0),
+    (1, 4, gl::FLOAT, false, 16),
+    (2, 2, gl::FLOAT, false, 32),
+    (3, 2, gl::UNSIGNED_INT, true, 40),
+    (4, 4, gl::UNSIGNED_INT, true, 48),
+    (5, 2, gl::UNSIGNED_INT, true, 64),
+];
+
+const VS_2D_SRC: &str = r#"
+#version 330 core
+layout(location = 0) in vec4 rect;
+layout(location = 1) in vec4 color;
+layout(location = 2) in vec2 origin;
+layout(location = 3) in uvec2 step;
+layout(location = 4) in uvec4 src;
+layout(location = 5) in uvec2 tint_flags;
+
+uniform vec2 screen;
+
+out vec4 v_color;
+out vec2 v_offset;
+flat out uvec2 v_step;
+flat out uvec4 v_src;
+flat out uvec2 v_tint_flags;
+
+void main() {
+    // A 4-vertex strip per instance: corners (0,0), (1,0), (0,1), (1,1).
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 pos = mix(rect.xy, rect.zw, corner);
+    // Framebuffer row 0 is the top of the screen.
+    vec2 ndc = pos / screen * 2.0 - 1.0;
+    gl_Position = vec4(ndc.x, -ndc.y, 0.0, 1.0);
+    v_color = color;
+    v_offset = pos - origin;
+    v_step = step;
+    v_src = src;
+    v_tint_flags = tint_flags;
+}
+"#;
+
+// Flag bits are the `QUAD_*` constants.
+const FS_2D_SRC: &str = r#"
+#version 330 core
+in vec4 v_color;
+in vec2 v_offset;
+flat in uvec2 v_step;
+flat in uvec4 v_src;
+flat in uvec2 v_tint_flags;
+
+uniform sampler2D image;
+
+out vec4 FragColor;
+
+void main() {
+    uint flags = v_tint_flags.y;
+    if ((flags & 1u) == 0u) {
+        FragColor = v_color;
+        return;
+    }
+    // Nearest-neighbor stepping exactly as `Blit::draw` does it on the CPU.
+    uvec2 t = min((uvec2(v_offset) * v_step) >> 16u, v_src.zw - 1u);
+    if ((flags & 8u) != 0u) t.x = v_src.z - 1u - t.x;
+    if ((flags & 16u) != 0u) t.y = v_src.w - 1u - t.y;
+    uvec4 c = uvec4(round(texelFetch(image, ivec2(v_src.xy + t), 0) * 255.0));
+    uvec4 tint = (uvec4(v_tint_flags.x) >> uvec4(16u, 8u, 0u, 24u)) & 255u;
+    if ((flags & 2u) != 0u) {
+        c = uvec4(tint.rgb, (c.r * tint.a + 127u) / 255u);
+    } else if ((flags & 4u) != 0u) {
+        c = (c * tint + 127u) / 255u;
+    }
+    if (c.a == 0u) discard;
+    float a = float(c.a) / 255.0;
+    FragColor = vec4(vec3(c.rgb) / 255.0 * a, a);
+}
+"#;
+
+/// A frame's ops, lent by the display list while the pass draws them.
+#[derive(Debug)]
+pub struct Frame {
+    pub ops: Vec<Op>,
+    /// The list starts with a full clear, so the software layer underneath is hidden.
+    pub covers_layer: bool,
+    /// Clipped union of everything the ops can touch.
+    pub drawn: DamageRect,
+}
+
+/// Lend `v`'s display list to the pass, or `None` if present must rasterize it instead.
+pub fn begin_frame(v: &mut VideoState) -> Option<Frame> {
+    let ops = v.display_list.ops();
+    if v.bound_framebuffer.is_some() || !drawable(ops) {
+        return None;
+    }
+    let mut drawn = DamageRect::default();
+    for op in ops {
+        let (x0, y0, x1, y1) = op.bounds();
+        drawn.union(DamageRect::clipped(x0, y0, x1, y1, v.width, v.height));
+    }
+    let covers_layer = matches!(ops[0].item, Item::Shape(Shape::Clear, _));
+    Some(Frame {
+        ops: v.display_list.begin_gpu_frame(),
+        covers_layer,
+        drawn,
+    })
+}
+
+/// Hand the ops back to the display list once drawn.
+pub fn end_frame(v: &mut VideoState, frame: Frame) {
+    v.display_list.end_gpu_frame(frame.ops, frame.drawn);
+}
+
+/// Whether the pass can draw `ops` on its own. A clear writes transparent pixels rather than
+/// blending, which only works as the first op, before anything else is drawn over the 3D scene.
+pub fn drawable(ops: &[Op]) -> bool {
+    !ops.is_empty()
+        && ops.len() <= MAX_OPS
+        && ops.iter().enumerate().all(|(i, op)| match &op.item {
+            Item::Shape(Shape::ClearRect { .. }, _) => false,
+            Item::Shape(Shape::Clear, _) => i == 0,
+            Item::Shape(..) => true,
+            Item::Blit(blit) => blit.width.max(blit.height) <= MAX_TEXTURE_SIZE,
+        })
+}
+
+/// A run of `build_quads` output drawn with one texture bound.
+#[derive(Debug)]
+pub struct Batch<'a> {
+    /// One past the run's last quad.
+    pub end: usize,
+    /// The blit whose texels the run's textured quads sample, if it has any.
+    pub texture: Option<&'a Blit>,
+}
+
+/// Append the quads for `ops` on a `width`x`height` framebuffer to `out`, split into runs that
+/// share a texture. Solid quads join whichever run they fall in. `spans` is scratch.
+pub fn build_quads<'a>(
+    ops: &'a [Op],
+    width: u32,
+    height: u32,
+    spans: &mut Vec<Span>,
+    out: &mut Vec<Quad>,
+) -> Vec<Batch<'a>> {
+    let mut batches = vec![Batch {
+        end: out.len(),
+        texture: None,
+    }];
+    for op in ops {
+        match &op.item {
+            Item::Shape(Shape::Clear, color) => {
+                // A clear writes the color as stored, which is already the premultiplied value.
+                if color >> 24 != 0 {
+                    let raw = [16, 8, 0, 24].map(|shift| ((color >> shift) & 0xFF) as f32 / 255.0);
+                    let rect = [0.0, 0.0, width as f32, height as f32];
+                    out.push(Quad {
+                        rect,
+                        color: raw,
+                        ..Quad::default()
+                    });
+                }
+            }
+            Item::Shape(shape, color) => {
+                spans.clear();
+                shape.draw(&mut Canvas::recording(width, height, spans), *color);
+                push_spans(out, spans, premultiplied(*color));
+            }
+            Item::Blit(blit) => {
+                let Some(quad) = blit_quad(blit, width, height) else {
+                    continue;
+                };
+                let last = batches.len() - 1;
+                match batches[last].texture {
+                    None => batches[last].texture = Some(blit),
+                    Some(bound) if Arc::ptr_eq(&bound.texels, &blit.texels) => {}
+                    Some(_) => batches.push(Batch {
+                        end: out.len(),
+                        texture: Some(blit),
+                    }),
+                }
+                out.push(quad);
+            }
+        }
+        let last = batches.len() - 1;
+        batches[last].end = out.len();
+    }
+    batches
+}
+
+/// One quad per run of consecutive spans that cover the same columns on successive rows. Only
+/// neighbours in drawing order are merged, so pixels a shape writes twice still blend twice.
+fn push_spans(out: &mut Vec<Quad>, spans: &[Span], color: [f32; 4]) {
+    let Some((&first, rest)) = spans.split_first() else {
+        return;
+    };
+    let (mut run, mut rows) = (first, 1);
+    for &s in rest {
+        if s.x0 == run.x0 && s.x1 == run.x1 && s.y == run.y + rows {
+            rows += 1;
+            continue;
+        }
+        out.push(span_quad(run, rows, color));
+        (run, rows) = (s, 1);
+    }
+    out.push(span_quad(run, rows, color));
+}
+
+fn span_quad(s: Span, rows: i32, color: [f32; 4]) -> Quad {
+    let rect = [s.x0, s.y, s.x1, s.y + rows].map(|v| v as f32);
+    Quad {
+        rect,
+        color,
+        ..Quad::default()
+    }
+}
+
+/// The textured quad for `blit`, clipped to the framebuffer, or `None` if nothing is visible.
+fn blit_quad(blit: &Blit, width: u32, height: u32) -> Option<Quad> {
+    let sp = &blit.sprite;
+    let (x0, y0, x1, y1) = blit.bounds();
+    let clip = DamageRect::clipped(x0, y0, x1, y1, width, height);
+    if clip.is_empty() {
+        return None;
+    }
+    let (step_x, step_y) = blit.steps();
+    let mut flags = QUAD_TEXTURED;
+    if blit.coverage {
+        flags |= QUAD_COVERAGE;
+    } else if sp.tint != TINT_NONE {
+        flags |= QUAD_TINTED;
+    }
+    if sp.flags & FLIP_X != 0 {
+        flags |= QUAD_FLIP_X;
+    }
+    if sp.flags & FLIP_Y != 0 {
+        flags |= QUAD_FLIP_Y;
+    }
+    Some(Quad {
+        rect: [clip.x0, clip.y0, clip.x1, clip.y1].map(|v| v as f32),
+        color: [0.0; 4],
+        origin: [sp.x as f32, sp.y as f32],
+        step: [step_x as u32, step_y as u32],
+        src: [sp.src_x, sp.src_y, sp.src_w, sp.src_h],
+        tint: sp.tint,
+        flags,
+    })
+}
+
+/// Straight-alpha 0xAARRGGBB as premultiplied RGBA.
+fn premultiplied(color: u32) -> [f32; 4] {
+    let a = (color >> 24) as f32 / 255.0;
+    let channel = |shift: u32| ((color >> shift) & 0xFF) as f32 / 255.0 * a;
+    [channel(16), channel(8), channel(0), a]
+}
+
+/// GL objects for the pass, owned by `graphics3d`'s GL state.
+pub struct Pass {
+    program: u32,
+    uniform_screen: i32,
+    vao: u32,
+    vbo: u32,
+    /// Reused CPU-side staging for `vbo`.
+    quads: Vec<Quad>,
+    /// Scratch for the recorded spans of one shape.
+    spans: Vec<Span>,
+    /// Uploaded blit textures, by the address of their texels. The `Weak` keeps that address
+    /// from being reused; entries whose texels are gone are deleted after each draw.
+    textures: HashMap<usize, (Weak<[u8]>, u32)>,
+}
+
+impl Pass {
+    /// Compile the program and set up the streamed instance buffer (needs a current context).
+    pub fn new() -> Self {
+        let program = super::graphics3d::create_program(VS_2D_SRC, FS_2D_SRC);
+        let uniform_screen = super::graphics3d::uniform_location(program, "screen");
+        let uniform_image = super::graphics3d::uniform_location(program, "image");
+        let (mut vao, mut vbo) = (0, 0);
+        unsafe {
+            gl::UseProgram(program);
+            gl::Uniform1i(uniform_image, 0);
+            gl::UseProgram(0);
+
+            gl::GenVertexArrays(1, &mut vao);
+            gl::GenBuffers(1, &mut vbo);
+            gl::BindVertexArray(vao);
+            for (location, ..) in ATTRIBUTES {
+                gl::EnableVertexAttribArray(location);
+                gl::VertexAttribDivisor(location, 1);
+            }
+            gl::BindVertexArray(0);
+        }
+        Self {
+            program,
+            uniform_screen,
+            vao,
+            vbo,
+            quads: Vec::new(),
+            spans: Vec::new(),
+            textures: HashMap::new(),
+        }
+    }
+
+    /// Draw `ops` into the bound framebuffer (`width`x`height` pixels) with premultiplied
+    /// blending, leaving depth testing and culling as the 3D pass expects them.
+    pub fn draw(&mut self, ops: &[Op], width: u32, height: u32) {
+        self.quads.clear();
+        let batches = build_quads(ops, width, height, &mut self.spans, &mut self.quads);
+        if !self.quads.is_empty() {
+            let bytes: &[u8] = bytemuck::cast_slice(&self.quads);
+            unsafe {
+                gl::BindVertexArray(self.vao);
+                gl::BindBuffer(gl::ARRAY_BUFFER, self.vbo);
+                gl::BufferData(
+                    gl::ARRAY_BUFFER,
+                    bytes.len() as isize,
+                    bytes.as_ptr() as *const c_void,
+                    gl::STREAM_DRAW,
+                );
+
+                gl::Disable(gl::DEPTH_TEST);
+                gl::Disable(gl::CULL_FACE);
+                gl::Enable(gl::BLEND);
+                gl::BlendFunc(gl::ONE, gl::ONE_MINUS_SRC_ALPHA);
+
+                gl::UseProgram(self.program);
+                gl::Uniform2f(self.uniform_screen, width as f32, height as f32);
+                gl::ActiveTexture(gl::TEXTURE0);
+
+                let mut start = 0;
+                for batch in &batches {
+                    if batch.end == start {
+                        continue;
+                    }
+                    if let Some(blit) = batch.texture {
+                        let texture = self.texture(blit);
+                        gl::BindTexture(gl::TEXTURE_2D, texture);
+                    }
+                    bind_instances(start);
+                    gl::DrawArraysInstanced(gl::TRIANGLE_STRIP, 0, 4, (batch.end - start) as i32);
+                    start = batch.end;
+                }
+
+                gl::BindTexture(gl::TEXTURE_2D, 0);
+                gl::Disable(gl::BLEND);
+                gl::Enable(gl::DEPTH_TEST);
+                gl::Enable(gl::CULL_FACE);
+                gl::BindVertexArray(0);
+                gl::BindBuffer(gl::ARRAY_BUFFER, 0);
+            }
+        }
+        self.evict_textures();
+    }
+
+    /// The texture holding `blit`'s texels, uploaded on first use.
+    fn texture(&mut self, blit: &Blit) -> u32 {
+        let key = Arc::as_ptr(&blit.texels) as *const u8 as usize;
+        if let Some(&(_, texture)) = self.textures.get(&key) {
+            return texture;
+        }
+        let (internal, format) = if blit.coverage {
+            (gl::R8, gl::RED)
+        } else {
+            (gl::RGBA8, gl::RGBA)
+        };
+        let mut texture = 0;
+        unsafe {
+            gl::GenTextures(1, &mut texture);
+            gl::BindTexture(gl::TEXTURE_2D, texture);
+            // Sampled with `texelFetch`; nearest filtering keeps the texture complete without
+            // mipmaps.
+            gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MIN_FILTER, gl::NEAREST as i32);
+            gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::NEAREST as i32);
+            gl::PixelStorei(gl::UNPACK_ALIGNMENT, 1);
+            gl::TexImage2D(
+                gl::TEXTURE_2D,
+                0,
+                internal as i32,
+                blit.width as i32,
+                blit.height as i32,
+                0,
+                format,
+                gl::UNSIGNED_BYTE,
+                blit.texels.as_ptr() as *const c_void,
+            );
+        }
+        self.textures
+            .insert(key, (Arc::downgrade(&blit.texels), texture));
+        texture
+    }
+
+    /// Delete the textures of texels nothing holds any more (an unregistered image, an evicted
+    /// glyph, once no recorded op refers to them either).
+    fn evict_textures(&mut self) {
+        self.textures.retain(|_, (texels, texture)| {
+            let live = texels.strong_count() > 0;
+            if !live {
+                unsafe { gl::DeleteTextures(1, texture) };
+            }
+            live
+        });
+    }
+}
+
+/// Point the instance attributes at the quads from index `first` on (needs the pass's VAO and
+/// buffer bound).
+unsafe fn bind_instances(first: usize) {
+    let stride = std::mem::size_of::<Quad>();
+    for (location, components, ty, integer, offset) in ATTRIBUTES {
+        let pointer = (first * stride + offset) as *const c_void;
+        unsafe {
+            if integer {
+                gl::VertexAttribIPointer(location, components, ty, stride as i32, pointer);
+            } else {
+                gl::VertexAttribPointer(
+                    location,
+                    components,
+                    ty,
+                    gl::FALSE,
+                    stride as i32,
+                    pointer,
+                );
+            }
+        }
+    }
+}
@@ -38,11 +38,18 @@ extern crate alloc;
 //
 // Performance notes:
 // - Register fonts once (typically in `setup()`), not per-frame.
-// - Drawing many small text calls is slower than drawing fewer larger strings.
+// - Drawing many small text calls is slower than drawing fewer larger strings;
+//   `wasm96_graphics_text_batch` draws many positioned strings with one call.
+// - Runs are laid out once per (font, px, text) and served from `text_layouts` after that, so
+//   unchanged HUD strings skip UTF-8 validation, layout and measuring.
+// - TTF/OTF glyphs are rasterized once per (font, char, px) and served from `glyph_cache` after
+//   that; using many distinct sizes will churn the cache.
 //
 // -------------------------------------------------------------------------------------------------
 
-use crate::state::global;
+use crate::abi;
+use crate::state::{BoundFramebuffer, DamageRect, VideoState, global};
+use libretro_sys::VideoRefreshFn;
 use wasmtime::Caller;
 
 // External crates for rendering
@@ -56,10 +63,14 @@ use std::collections::HashMap;
 // Storage ABI helpers
 use alloc::vec::Vec;
 
-use super::resources::{AvError, FontResource, GifResource, ImageResource, RESOURCES};
-use super::utils::{
-    graphics_image_from_host, graphics_line_internal, read_guest_bytes, system_millis, tri_edge,
-};
+use super::gif_stream::GifStream;
+use super::glyph_cache::{GlyphCache, GlyphKey};
+use super::raster::{self, Shape};
+use super::resources::{AvError, FontResource, ImageResource, RESOURCES, Resources};
+use super::sprites::{self, Blit, Sprite};
+use super::svg_cache::{SvgRaster, SvgRasterKey};
+use super::text_layout::Glyphs;
+use super::utils::{graphics_image_from_host, read_guest_bytes, system_millis};
 
 // Material parsing (MTL)
 //
@@ -168,19 +179,75 @@ pub fn graphics_set_size(width: u32, height: u32) {
     s.video.height = height;
     s.video.framebuffer.resize((width * height) as usize, 0);
     // Clear to black on resize
-    s.video.framebuffer.fill(0);
+    raster::clear(&mut s.video, 0);
 }
 
-/// Set the current drawing color.
-pub fn graphics_set_color(r: u32, g: u32, b: u32, a: u32) {
-    let mut s = match global().lock() {
+/// Bind a region of guest memory as the framebuffer (or unbind it).
+///
+/// Guest ABI (`wasm96_graphics_bind_framebuffer(ptr, w, h, format) -> u32`):
+/// - `ptr`: 4-byte aligned address of `w * h` pixels in guest linear memory.
+/// - `format`: pixel format; only `FRAMEBUFFER_FORMAT_XRGB8888` (0x00RRGGBB words) is supported.
+/// - `w == 0 || h == 0` unbinds and returns to the host-owned framebuffer.
+///
+/// While bound, present hands the frontend a pointer into guest memory (no copy), and the screen
+/// size is `w`x`h`. The host framebuffer is not presented, so host drawing calls are not visible;
+/// the guest owns every pixel. The region is validated against guest memory at present time; if it
+/// does not fit, the host framebuffer is presented instead.
+///
+/// Returns `1` on success, `0` for an unsupported format or misaligned pointer.
+pub fn graphics_bind_framebuffer(ptr: u32, width: u32, height: u32, format: u32) -> u32 {
+    if width == 0 || height == 0 {
+        lock_state().video.bound_framebuffer = None;
+        return 1;
+    }
+    if format != abi::FRAMEBUFFER_FORMAT_XRGB8888 || ptr % 4 != 0 {
+        return 0;
+    }
+
+    graphics_set_size(width, height);
+    lock_state().video.bound_framebuffer = Some(BoundFramebuffer { ptr, width, height });
+    1
+}
+
+/// Resolve a bound guest framebuffer to its pixels inside guest memory.
+///
+/// Returns `None` if the region is out of bounds or not `u32` aligned.
+pub(crate) fn guest_framebuffer_pixels<'a>(
+    guest_memory: &'a [u8],
+    bound: &BoundFramebuffer,
+) -> Option<&'a [u32]> {
+    let pixels = (bound.width as usize).checked_mul(bound.height as usize)?;
+    let start = bound.ptr as usize;
+    let end = start.checked_add(pixels.checked_mul(4)?)?;
+    let bytes = guest_memory.get(start..end)?;
+
+    // SAFETY: every bit pattern is a valid `u32`; `align_to` only yields the aligned middle part.
+    let (prefix, words, _) = unsafe { bytes.align_to::<u32>() };
+    if !prefix.is_empty() || words.len() != pixels {
+        return None;
+    }
+    Some(words)
+}
+
+/// Lock the global state for a drawing call.
+///
+/// If a previous panic occurred while holding the global lock, the mutex will be poisoned.
+/// For drawing helpers, prefer continuing with the inner state rather than panicking.
+pub(crate) fn lock_state() -> std::sync::MutexGuard<'static, crate::state::GlobalState> {
+    match global().lock() {
         Ok(g) => g,
         Err(poisoned) => poisoned.into_inner(),
-    };
+    }
+}
+
+/// Set the current drawing color.
+///
+/// `a < 255` makes the 2D primitives blend (source-over) instead of overwriting; `a == 0` draws
+/// nothing.
+pub fn graphics_set_color(r: u32, g: u32, b: u32, a: u32) {
     // Pack as 0xAARRGGBB (ARGB8888).
-    // We use the alpha channel for the overlay shader (0 = transparent).
-    let color = ((a & 0xFF) << 24) | ((r & 0xFF) << 16) | ((g & 0xFF) << 8) | (b & 0xFF);
-    s.video.draw_color = color;
+    // The alpha channel also drives the 3D overlay composite (0 = transparent).
+    lock_state().video.draw_color = raster::pack_color(r, g, b, a);
 }
 
 /// Clear the screen to a specific color.
@@ -193,180 +260,69 @@ pub fn graphics_background(r: u32, g: u32, b: u32) {
         1.0,
     );
 
-    let mut s = match global().lock() {
-        Ok(g) => g,
-        Err(poisoned) => poisoned.into_inner(),
-    };
+    raster::clear(
+        &mut lock_state().video,
+        background_color(r, g, b, gl_cleared),
+    );
+}
+
+/// Software framebuffer color used by `graphics_background`.
+pub(crate) fn background_color(r: u32, g: u32, b: u32, gl_cleared: bool) -> u32 {
     if gl_cleared {
         // Clear software framebuffer to transparent so it doesn't occlude the 3D scene
-        s.video.framebuffer.fill(0x00000000);
+        0x00000000
     } else {
         // Fallback for software rendering: clear to requested color
-        let color = ((r & 0xFF) << 16) | ((g & 0xFF) << 8) | (b & 0xFF);
-        s.video.framebuffer.fill(color);
+        ((r & 0xFF) << 16) | ((g & 0xFF) << 8) | (b & 0xFF)
     }
 }
 
+/// Clear one rectangle to a color, leaving the rest of the previous frame in place.
+///
+/// The framebuffer is retained between frames (immediate mode never clears implicitly), so a guest
+/// that only changes part of the screen can repaint just that part instead of calling
+/// `graphics_background` every frame. Like `graphics_background`, the software framebuffer is
+/// cleared to transparent instead when a 3D context exists, so the 3D scene shows through.
+pub fn graphics_clear_rect(x: i32, y: i32, w: u32, h: u32, r: u32, g: u32, b: u32) {
+    let color = background_color(r, g, b, super::graphics3d::gl_available());
+    raster::clear_rect(&mut lock_state().video, x, y, w, h, color);
+}
+
+/// Bounding box of the pixels drawn since the last present.
+///
+/// Packed as `x << 48 | y << 32 | w << 16 | h`; `0` means nothing changed yet this frame.
+pub fn graphics_damage() -> u64 {
+    lock_state().video.damage.pack()
+}
+
 /// Draw a single pixel.
 pub fn graphics_point(x: i32, y: i32) {
-    let mut s = match global().lock() {
-        Ok(g) => g,
-        Err(poisoned) => poisoned.into_inner(),
-    };
-    let w = s.video.width as i32;
-    let h = s.video.height as i32;
-
-    if x >= 0 && x < w && y >= 0 && y < h {
-        let idx = (y * w + x) as usize;
-        s.video.framebuffer[idx] = s.video.draw_color;
-    }
+    raster::point(&mut lock_state().video, x, y);
 }
 
 /// Draw a line using Bresenham's algorithm.
-pub fn graphics_line(mut x0: i32, mut y0: i32, x1: i32, y1: i32) {
-    let mut s = match global().lock() {
-        Ok(g) => g,
-        Err(poisoned) => poisoned.into_inner(),
-    };
-    let w = s.video.width as i32;
-    let h = s.video.height as i32;
-    let color = s.video.draw_color;
-    let fb = &mut s.video.framebuffer;
-
-    let dx = (x1 - x0).abs();
-    let dy = -(y1 - y0).abs();
-    let sx = if x0 < x1 { 1 } else { -1 };
-    let sy = if y0 < y1 { 1 } else { -1 };
-    let mut err = dx + dy;
-
-    loop {
-        if x0 >= 0 && x0 < w && y0 >= 0 && y0 < h {
-            fb[(y0 * w + x0) as usize] = color;
-        }
-
-        if x0 == x1 && y0 == y1 {
-            break;
-        }
-        let e2 = 2 * err;
-        if e2 >= dy {
-            err += dy;
-            x0 += sx;
-        }
-        if e2 <= dx {
-            err += dx;
-            y0 += sy;
-        }
-    }
+pub fn graphics_line(x0: i32, y0: i32, x1: i32, y1: i32) {
+    raster::line(&mut lock_state().video, x0, y0, x1, y1);
 }
 
 /// Draw a filled rectangle.
 pub fn graphics_rect(x: i32, y: i32, w: u32, h: u32) {
-    let mut s = global().lock().unwrap();
-    let screen_w = s.video.width as i32;
-    let screen_h = s.video.height as i32;
-    let color = s.video.draw_color;
-
-    let x_start = x.max(0);
-    let y_start = y.max(0);
-    let x_end = (x + w as i32).min(screen_w);
-    let y_end = (y + h as i32).min(screen_h);
-
-    if x_start >= x_end || y_start >= y_end {
-        return;
-    }
-
-    let fb_w = s.video.width as usize;
-    let fb = &mut s.video.framebuffer;
-
-    for curr_y in y_start..y_end {
-        let start_idx = (curr_y as usize) * fb_w + (x_start as usize);
-        let end_idx = (curr_y as usize) * fb_w + (x_end as usize);
-        fb[start_idx..end_idx].fill(color);
-    }
+    raster::rect(&mut lock_state().video, x, y, w, h);
 }
 
 /// Draw a rectangle outline.
 pub fn graphics_rect_outline(x: i32, y: i32, w: u32, h: u32) {
-    // Top
-    graphics_line_internal(x, y, x + w as i32, y);
-    // Bottom
-    graphics_line_internal(x, y + h as i32, x + w as i32, y + h as i32);
-    // Left
-    graphics_line_internal(x, y, x, y + h as i32);
-    // Right
-    graphics_line_internal(x + w as i32, y, x + w as i32, y + h as i32);
+    raster::rect_outline(&mut lock_state().video, x, y, w, h);
 }
 
 /// Draw a filled circle.
 pub fn graphics_circle(cx: i32, cy: i32, r: u32) {
-    let mut s = match global().lock() {
-        Ok(g) => g,
-        Err(poisoned) => poisoned.into_inner(),
-    };
-    let w = s.video.width as i32;
-    let h = s.video.height as i32;
-    let color = s.video.draw_color;
-    let fb = &mut s.video.framebuffer;
-
-    let r_sq = (r * r) as i32;
-    let r_i32 = r as i32;
-
-    let x_min = (cx - r_i32).max(0);
-    let x_max = (cx + r_i32).min(w);
-    let y_min = (cy - r_i32).max(0);
-    let y_max = (cy + r_i32).min(h);
-
-    for y in y_min..y_max {
-        for x in x_min..x_max {
-            let dx = x - cx;
-            let dy = y - cy;
-            if dx * dx + dy * dy <= r_sq {
-                fb[(y * w + x) as usize] = color;
-            }
-        }
-    }
+    raster::circle(&mut lock_state().video, cx, cy, r);
 }
 
-/// Draw a circle outline (Bresenham's circle algorithm).
 /// Draw a circle outline.
 pub fn graphics_circle_outline(cx: i32, cy: i32, r: u32) {
-    let mut s = match global().lock() {
-        Ok(g) => g,
-        Err(poisoned) => poisoned.into_inner(),
-    };
-    let w = s.video.width as i32;
-    let h = s.video.height as i32;
-    let color = s.video.draw_color;
-    let fb = &mut s.video.framebuffer;
-
-    let mut x = 0;
-    let mut y = r as i32;
-    let mut d = 3 - 2 * r as i32;
-
-    let mut plot = |x: i32, y: i32| {
-        if x >= 0 && x < w && y >= 0 && y < h {
-            fb[(y * w + x) as usize] = color;
-        }
-    };
-
-    while y >= x {
-        plot(cx + x, cy + y);
-        plot(cx - x, cy + y);
-        plot(cx + x, cy - y);
-        plot(cx - x, cy - y);
-        plot(cx + y, cy + x);
-        plot(cx - y, cy + x);
-        plot(cx + y, cy - x);
-        plot(cx - y, cy - x);
-
-        x += 1;
-        if d > 0 {
-            y -= 1;
-            d = d + 4 * (x - y) + 10;
-        } else {
-            d = d + 4 * x + 6;
-        }
-    }
+    raster::circle_outline(&mut lock_state().video, cx, cy, r);
 }
 
 /// Draw an image from guest memory.
@@ -404,15 +360,16 @@ pub fn graphics_image(
     memory
         .read(&*caller, ptr as usize, &mut img_data)
         .map_err(|_| AvError::MemoryReadFailed)?;
+    crate::profile::bytes_in(img_data.len());
 
     // Lock and draw
     let mut s = match global().lock() {
         Ok(g) => g,
         Err(poisoned) => poisoned.into_inner(),
     };
+    super::tiles::resolve(&mut s.video);
     let screen_w = s.video.width as i32;
     let screen_h = s.video.height as i32;
-    let fb = &mut s.video.framebuffer;
 
     // Clipping
     let x_start = x.max(0);
@@ -423,6 +380,8 @@ pub fn graphics_image(
     if x_start >= x_end || y_start >= y_end {
         return Ok(());
     }
+    s.video.mark_damage(x_start, y_start, x_end, y_end);
+    let fb = &mut s.video.framebuffer;
 
     for curr_y in y_start..y_end {
         let src_y = curr_y - y; // relative to image
@@ -439,13 +398,8 @@ pub fn graphics_image(
             let b = img_data[src_idx + 2];
             let a = img_data[src_idx + 3];
 
-            if a > 0 {
-                // Simple alpha check (0 = transparent, >0 = opaque).
-                // Real blending would be: result = alpha * src + (1-alpha) * dst
-                // For now, just overwrite if not fully transparent.
-                let color = ((r as u32) << 16) | ((g as u32) << 8) | (b as u32);
-                fb[dst_row_start + (curr_x as usize)] = color;
-            }
+            let rgb = ((r as u32) << 16) | ((g as u32) << 8) | (b as u32);
+            raster::put_texel(&mut fb[dst_row_start + (curr_x as usize)], rgb, a as u32);
         }
     }
 
@@ -469,7 +423,7 @@ pub fn graphics_image_png(
         None => return Ok(()),
     };
 
-    graphics_image_from_host(x, y, decoded.width, decoded.height, &decoded.rgba);
+    draw_image(&decoded, x, y, 0, 0);
     Ok(())
 }
 
@@ -490,7 +444,7 @@ pub fn graphics_image_jpeg(
         None => return Ok(()),
     };
 
-    graphics_image_from_host(x, y, decoded.width, decoded.height, &decoded.rgba);
+    draw_image(&decoded, x, y, 0, 0);
     Ok(())
 }
 
@@ -550,7 +504,7 @@ pub fn graphics_mtl_register_texture(
     register_encoded_texture_by_extension(texture_key, tex_filename, &tex_bytes)
 }
 
-fn decode_png_to_rgba(png_bytes: &[u8]) -> Option<ImageResource> {
+pub(super) fn decode_png_to_rgba(png_bytes: &[u8]) -> Option<ImageResource> {
     let cursor = std::io::Cursor::new(png_bytes);
     let decoder = png::Decoder::new(cursor);
     let mut reader = decoder.read_info().ok()?;
@@ -584,13 +538,13 @@ fn decode_png_to_rgba(png_bytes: &[u8]) -> Option<ImageResource> {
     };
 
     Some(ImageResource {
-        rgba,
+        rgba: rgba.into(),
         width: w,
         height: h,
     })
 }
 
-fn decode_jpeg_to_rgba(jpeg_bytes: &[u8]) -> Option<ImageResource> {
+pub(super) fn decode_jpeg_to_rgba(jpeg_bytes: &[u8]) -> Option<ImageResource> {
     let mut decoder = jpeg_decoder::Decoder::new(std::io::Cursor::new(jpeg_bytes));
     let pixels = decoder.decode().ok()?;
     let info = decoder.info()?;
@@ -639,7 +593,7 @@ fn decode_jpeg_to_rgba(jpeg_bytes: &[u8]) -> Option<ImageResource> {
     };
 
     Some(ImageResource {
-        rgba,
+        rgba: rgba.into(),
         width: w,
         height: h,
     })
@@ -693,6 +647,39 @@ map_Kd test_texture.png
     // of the graphics/image registration paths during normal runtime execution.
 }
 
+/// Register `w*h` raw RGBA8888 pixels from guest memory under a key.
+///
+/// The image is stored alongside decoded PNG/JPEG images, so it can be drawn with the keyed PNG
+/// calls, used by sprite batches, or used as a tilemap tileset (e.g. procedurally built tiles).
+pub fn graphics_image_register(
+    env: &mut Caller<'_, ()>,
+    key: u64,
+    w: u32,
+    h: u32,
+    data_ptr: u32,
+    data_len: u32,
+) -> u32 {
+    let expected = (w as u64) * (h as u64) * 4;
+    if w == 0 || h == 0 || (data_len as u64) < expected {
+        return 0;
+    }
+    let rgba = match read_guest_bytes(env, data_ptr, expected as u32) {
+        Ok(b) => b,
+        Err(_) => return 0,
+    };
+
+    let mut res = RESOURCES.lock().unwrap();
+    res.keyed_images.insert(
+        key,
+        ImageResource {
+            rgba: rgba.into(),
+            width: w,
+            height: h,
+        },
+    );
+    1
+}
+
 /// Draw a keyed PNG at natural size.
 pub fn graphics_png_draw_key(key: u64, x: i32, y: i32) {
     graphics_image_draw_key(key, x, y);
@@ -749,60 +736,22 @@ pub fn graphics_jpeg_unregister(key: u64) {
 
 /// Draw any keyed decoded image at natural size.
 fn graphics_image_draw_key(key: u64, x: i32, y: i32) {
-    let img = {
-        let res = RESOURCES.lock().unwrap();
-        res.keyed_images.get(&key).cloned()
-    };
-
-    if let Some(img) = img {
-        graphics_image_from_host(x, y, img.width, img.height, &img.rgba);
-    }
+    graphics_image_draw_key_scaled(key, x, y, 0, 0);
 }
 
-/// Draw any keyed decoded image scaled (nearest-neighbor).
+/// Draw any keyed decoded image scaled (nearest-neighbor), natural size if either dimension is 0.
 fn graphics_image_draw_key_scaled(key: u64, x: i32, y: i32, w: u32, h: u32) {
-    let img = {
-        let res = RESOURCES.lock().unwrap();
-        res.keyed_images.get(&key).cloned()
-    };
-
-    let Some(img) = img else {
-        return;
-    };
-
-    // Natural size if either dimension is 0.
-    if w == 0 || h == 0 {
-        graphics_image_from_host(x, y, img.width, img.height, &img.rgba);
-        return;
-    }
-
-    let src_w = img.width;
-    let src_h = img.height;
-    if src_w == 0 || src_h == 0 {
-        return;
-    }
-
-    let mut dst = vec![0u8; (w as usize).saturating_mul(h as usize).saturating_mul(4)];
-    for dy in 0..h {
-        let sy = (dy as u64 * src_h as u64 / h as u64) as u32;
-        let sy = sy.min(src_h.saturating_sub(1));
-        for dx in 0..w {
-            let sx = (dx as u64 * src_w as u64 / w as u64) as u32;
-            let sx = sx.min(src_w.saturating_sub(1));
-
-            let sidx = ((sy as usize) * (src_w as usize) + (sx as usize)) * 4;
-            let didx = ((dy as usize) * (w as usize) + (dx as usize)) * 4;
-
-            if sidx + 3 < img.rgba.len() && didx + 3 < dst.len() {
-                dst[didx] = img.rgba[sidx];
-                dst[didx + 1] = img.rgba[sidx + 1];
-                dst[didx + 2] = img.rgba[sidx + 2];
-                dst[didx + 3] = img.rgba[sidx + 3];
-            }
-        }
+    // Lock order: RESOURCES before the global state.
+    let res = RESOURCES.lock().unwrap();
+    if let Some(img) = res.keyed_images.get(&key) {
+        draw_image(img, x, y, w, h);
     }
+}
 
-    graphics_image_from_host(x, y, w, h, &dst);
+/// Submit all of `img` at (`x`, `y`) as a blit (see `sprites`), `w`x`h` or natural size.
+fn draw_image(img: &ImageResource, x: i32, y: i32, w: u32, h: u32) {
+    let mut s = lock_state();
+    sprites::draw_sprite(&mut s.video, img, &Sprite::image(x, y, w, h));
 }
 
 /// Draw a filled triangle using a barycentric (edge-function) rasterizer.
@@ -811,86 +760,14 @@ fn graphics_image_draw_key_scaled(key: u64, x: i32, y: i32, w: u32, h: u32) {
 /// - Works for any vertex order (winding), filled area is consistent.
 /// - Clips to framebuffer bounds.
 /// - Uses integer edge functions for stability/determinism.
-///
-/// Rasterization rule:
-/// - We treat pixels as **samples at pixel centers**: (x + 0.5, y + 0.5).
-///   This avoids cases where a triangle covers no integer lattice points and would
-///   otherwise render as empty for small/skinny triangles.
+/// - Samples at pixel centers (see `raster::triangle`).
 pub fn graphics_triangle(x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32) {
-    let mut s = match global().lock() {
-        Ok(g) => g,
-        Err(poisoned) => poisoned.into_inner(),
-    };
-    let w = s.video.width as i32;
-    let h = s.video.height as i32;
-    if w <= 0 || h <= 0 {
-        return;
-    }
-
-    let color = s.video.draw_color;
-    let fb = &mut s.video.framebuffer;
-
-    // Use 2x fixed-point coordinates so we can represent pixel centers as integers.
-    // A pixel center at (x + 0.5, y + 0.5) becomes P2 = (2x + 1, 2y + 1).
-    let v0 = (x1 * 2, y1 * 2);
-    let v1 = (x2 * 2, y2 * 2);
-    let v2 = (x3 * 2, y3 * 2);
-
-    // Degenerate (area==0): nothing to fill.
-    let area = tri_edge(v0, v1, v2);
-    if area == 0 {
-        return;
-    }
-
-    // Bounding box in pixel coordinates (inclusive), computed from the triangle vertices.
-    // We convert from 2x space back into pixel indices.
-    let min_x = ((v0.0.min(v1.0).min(v2.0)) >> 1).max(0);
-    let max_x = ((v0.0.max(v1.0).max(v2.0)) >> 1).min(w - 1);
-    let min_y = ((v0.1.min(v1.1).min(v2.1)) >> 1).max(0);
-    let max_y = ((v0.1.max(v1.1).max(v2.1)) >> 1).min(h - 1);
-
-    if min_x > max_x || min_y > max_y {
-        return;
-    }
-
-    // Make the edge tests winding-invariant by normalizing the edge function
-    // values to the same sign (i.e. as if the triangle had positive area).
-    //
-    // IMPORTANT: The sign normalization must match the sign of the triangle's own
-    // area under the *same* (a,b,c) ordering used by `tri_edge(a,b,c)`.
-    let sign = if area > 0 { 1 } else { -1 };
-
-    for y in min_y..=max_y {
-        let row = (y as usize) * (w as usize);
-        for x in min_x..=max_x {
-            // Sample at pixel center in 2x space.
-            let p = (x * 2 + 1, y * 2 + 1);
-
-            // Edge functions for triangle v0,v1,v2.
-            // Multiply by `sign` so "inside" corresponds to >= 0 regardless of winding.
-            //
-            // NOTE:
-            // `tri_edge(a, b, c)` computes a left-of test for the directed edge a->b at point c.
-            // For point-in-triangle, the consistent set is:
-            //   w0 = edge(v0->v1, p)
-            //   w1 = edge(v1->v2, p)
-            //   w2 = edge(v2->v0, p)
-            let w0 = tri_edge(v0, v1, p) * sign;
-            let w1 = tri_edge(v1, v2, p) * sign;
-            let w2 = tri_edge(v2, v0, p) * sign;
-
-            if w0 >= 0 && w1 >= 0 && w2 >= 0 {
-                fb[row + x as usize] = color;
-            }
-        }
-    }
+    raster::triangle(&mut lock_state().video, x1, y1, x2, y2, x3, y3);
 }
 
 /// Draw a triangle outline.
 pub fn graphics_triangle_outline(x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32) {
-    graphics_line(x1, y1, x2, y2);
-    graphics_line(x2, y2, x3, y3);
-    graphics_line(x3, y3, x1, y1);
+    raster::triangle_outline(&mut lock_state().video, x1, y1, x2, y2, x3, y3);
 }
 
 /// Draw a quadratic Bezier curve.
@@ -903,21 +780,7 @@ pub fn graphics_bezier_quadratic(
     y2: i32,
     segments: u32,
 ) {
-    if segments == 0 {
-        return;
-    }
-    let mut prev_x = x1 as f32;
-    let mut prev_y = y1 as f32;
-    for i in 1..=segments {
-        let t = i as f32 / segments as f32;
-        let x =
-            (1.0 - t).powi(2) * x1 as f32 + 2.0 * (1.0 - t) * t * cx as f32 + t.powi(2) * x2 as f32;
-        let y =
-            (1.0 - t).powi(2) * y1 as f32 + 2.0 * (1.0 - t) * t * cy as f32 + t.powi(2) * y2 as f32;
-        graphics_line(prev_x as i32, prev_y as i32, x as i32, y as i32);
-        prev_x = x;
-        prev_y = y;
-    }
+    raster::bezier_quadratic(&mut lock_state().video, x1, y1, cx, cy, x2, y2, segments);
 }
 
 /// Draw a cubic Bezier curve.
@@ -932,53 +795,28 @@ pub fn graphics_bezier_cubic(
     y2: i32,
     segments: u32,
 ) {
-    if segments == 0 {
-        return;
-    }
-    let mut prev_x = x1 as f32;
-    let mut prev_y = y1 as f32;
-    for i in 1..=segments {
-        let t = i as f32 / segments as f32;
-        let x = (1.0 - t).powi(3) * x1 as f32
-            + 3.0 * (1.0 - t).powi(2) * t * cx1 as f32
-            + 3.0 * (1.0 - t) * t.powi(2) * cx2 as f32
-            + t.powi(3) * x2 as f32;
-        let y = (1.0 - t).powi(3) * y1 as f32
-            + 3.0 * (1.0 - t).powi(2) * t * cy1 as f32
-            + 3.0 * (1.0 - t) * t.powi(2) * cy2 as f32
-            + t.powi(3) * y2 as f32;
-        graphics_line(prev_x as i32, prev_y as i32, x as i32, y as i32);
-        prev_x = x;
-        prev_y = y;
-    }
+    raster::bezier_cubic(
+        &mut lock_state().video,
+        x1,
+        y1,
+        cx1,
+        cy1,
+        cx2,
+        cy2,
+        x2,
+        y2,
+        segments,
+    );
 }
 
 /// Draw a filled pill.
 pub fn graphics_pill(x: i32, y: i32, w: u32, h: u32) {
-    if w == 0 || h == 0 {
-        return;
-    }
-    let r = (w.min(h) / 2) as i32;
-    // Draw center rect
-    graphics_rect(x + r, y, w - 2 * r as u32, h);
-    // Draw left cap
-    graphics_circle(x + r, y + r, r as u32);
-    // Draw right cap
-    graphics_circle(x + w as i32 - r, y + r, r as u32);
+    raster::pill(&mut lock_state().video, x, y, w, h);
 }
 
 /// Draw a pill outline.
 pub fn graphics_pill_outline(x: i32, y: i32, w: u32, h: u32) {
-    if w == 0 || h == 0 {
-        return;
-    }
-    let r = (w.min(h) / 2) as i32;
-    // Outline center rect
-    graphics_rect_outline(x + r, y, w - 2 * r as u32, h);
-    // Outline left cap
-    graphics_circle_outline(x + r, y + r, r as u32);
-    // Outline right cap
-    graphics_circle_outline(x + w as i32 - r, y + r, r as u32);
+    raster::pill_outline(&mut lock_state().video, x, y, w, h);
 }
 
 /// Create SVG resource.
@@ -1037,203 +875,121 @@ pub fn graphics_svg_unregister(key: u64) {
     }
 }
 
+/// Render SVG `id` at `w`x`h` if needed, so the next draw at that size is a blit.
+///
+/// Guest ABI (`wasm96_graphics_svg_prerender`): lets guests warm the cache in `setup()`.
+///
+/// Returns:
+/// - `1` if a render at this size is now cached
+/// - `0` if the key is unknown, the size is empty, or the render exceeds the cache budget
+pub fn graphics_svg_prerender_key(key: u64, w: u32, h: u32) -> u32 {
+    let mut res = RESOURCES.lock().unwrap();
+    let res = &mut *res;
+    let Some(&id) = res.keyed_svgs.get(&key) else {
+        return 0;
+    };
+
+    let cache_key = SvgRasterKey {
+        svg_id: id,
+        width: w,
+        height: h,
+    };
+    if res.svg_cache.contains_key(&cache_key) {
+        return 1;
+    }
+    match res.svgs.get(&id).and_then(|tree| render_svg(tree, w, h)) {
+        Some(raster) => res.svg_cache.insert(cache_key, raster) as u32,
+        None => 0,
+    }
+}
+
+/// Drop all cached renders of a keyed SVG (the SVG itself stays registered).
+pub fn graphics_svg_evict_key(key: u64) {
+    let mut res = RESOURCES.lock().unwrap();
+    if let Some(&id) = res.keyed_svgs.get(&key) {
+        res.svg_cache.remove_svg(id);
+    }
+}
+
+/// Set the byte budget for cached SVG renders (default `DEFAULT_SVG_CACHE_BYTES`).
+///
+/// Lowering the budget evicts immediately; `0` disables caching.
+pub fn graphics_svg_set_cache_budget(bytes: u32) {
+    let mut res = RESOURCES.lock().unwrap();
+    res.svg_cache.set_budget(bytes as usize);
+}
+
+/// Render an SVG tree scaled to `w`x`h` into framebuffer-format pixels.
+fn render_svg(tree: &Tree, w: u32, h: u32) -> Option<SvgRaster> {
+    let mut pixmap = tiny_skia::Pixmap::new(w, h)?;
+
+    let sx = w as f32 / tree.size().width();
+    let sy = h as f32 / tree.size().height();
+    let transform = tiny_skia::Transform::from_scale(sx, sy);
+
+    resvg::render(tree, transform, &mut pixmap.as_mut());
+
+    // tiny-skia stores premultiplied RGBA8888; pack it as 0xAARRGGBB.
+    let pixels = pixmap
+        .data()
+        .chunks_exact(4)
+        .map(|p| ((p[3] as u32) << 24) | ((p[0] as u32) << 16) | ((p[1] as u32) << 8) | p[2] as u32)
+        .collect();
+
+    Some(SvgRaster {
+        width: w,
+        height: h,
+        pixels,
+    })
+}
+
 /// Draw SVG.
+///
+/// Renders are cached per (id, w, h); only the first draw at a given size runs `resvg`.
 pub fn graphics_svg_draw(id: u32, x: i32, y: i32, w: u32, h: u32) {
-    let res = RESOURCES.lock().unwrap();
-    if let Some(tree) = res.svgs.get(&id) {
-        let pixmap_size = tiny_skia::IntSize::from_wh(w, h).unwrap();
-        let mut pixmap = tiny_skia::Pixmap::new(pixmap_size.width(), pixmap_size.height()).unwrap();
-
-        let sx = w as f32 / tree.size().width();
-        let sy = h as f32 / tree.size().height();
-        let transform = tiny_skia::Transform::from_scale(sx, sy);
-
-        resvg::render(tree, transform, &mut pixmap.as_mut());
-        // Now draw pixmap as image
-        let rgba_data: Vec<u8> = pixmap
-            .data()
-            .chunks_exact(4)
-            .flat_map(|rgba| [rgba[0], rgba[1], rgba[2], rgba[3]])
-            .collect();
-        graphics_image_from_host(x, y, w, h, &rgba_data);
+    let mut res = RESOURCES.lock().unwrap();
+    let res = &mut *res;
+    let cache_key = SvgRasterKey {
+        svg_id: id,
+        width: w,
+        height: h,
+    };
+
+    if let Some(raster) = res.svg_cache.get(&cache_key) {
+        raster::blit_premultiplied(&mut lock_state().video, x, y, w, h, &raster.pixels);
+        return;
     }
+
+    let Some(raster) = res.svgs.get(&id).and_then(|tree| render_svg(tree, w, h)) else {
+        return;
+    };
+    raster::blit_premultiplied(&mut lock_state().video, x, y, w, h, &raster.pixels);
+    res.svg_cache.insert(cache_key, raster);
 }
 
 /// Destroy SVG.
 pub fn graphics_svg_destroy(id: u32) {
     let mut res = RESOURCES.lock().unwrap();
     res.svgs.remove(&id);
+    res.svg_cache.remove_svg(id);
 }
 
 /// Create GIF resource.
+///
+/// Only the frame descriptors are parsed here; frames are decoded when drawn.
 pub fn graphics_gif_create(env: &mut Caller<'_, ()>, ptr: u32, len: u32) -> u32 {
     let data = match read_guest_bytes(env, ptr, len) {
         Ok(d) => d,
         Err(_) => return 0,
     };
-
-    let cursor = std::io::Cursor::new(&data);
-    let mut decoder = match gif::DecodeOptions::new().read_info(cursor) {
-        Ok(d) => d,
-        Err(_) => return 0,
+    let Some(gif) = GifStream::new(data) else {
+        return 0;
     };
 
-    let width = decoder.width();
-    let height = decoder.height();
-    let global_palette: Option<Vec<u8>> = decoder.global_palette().map(|p| p.to_vec());
-
-    let mut frames = Vec::new();
-    let mut delays = Vec::new();
-
-    // Canvas for composition (RGBA)
-    let mut canvas = vec![0u8; width as usize * height as usize * 4];
-    // Backup for "Restore to Previous" disposal
-    let mut previous_canvas = canvas.clone();
-
-    let mut last_disposal = gif::DisposalMethod::Any;
-    let mut last_rect = (0u16, 0u16, 0u16, 0u16); // left, top, width, height
-
-    while let Some(frame) = match decoder.read_next_frame() {
-        Ok(f) => f,
-        Err(_) => return 0,
-    } {
-        // 1. Handle disposal of the *previous* frame
-        match last_disposal {
-            gif::DisposalMethod::Any | gif::DisposalMethod::Keep => {
-                // Do nothing, draw on top
-            }
-            gif::DisposalMethod::Background => {
-                // Restore background (transparent) for the area of the previous frame
-                let (lx, ly, lw, lh) = last_rect;
-                for y in ly..(ly + lh) {
-                    if y >= height {
-                        break;
-                    }
-                    for x in lx..(lx + lw) {
-                        if x >= width {
-                            break;
-                        }
-                        let idx = ((y as usize) * (width as usize) + (x as usize)) * 4;
-                        if idx + 3 < canvas.len() {
-                            canvas[idx] = 0;
-                            canvas[idx + 1] = 0;
-                            canvas[idx + 2] = 0;
-                            canvas[idx + 3] = 0;
-                        }
-                    }
-                }
-            }
-            gif::DisposalMethod::Previous => {
-                // Restore to state before previous frame
-                canvas = previous_canvas.clone();
-            }
-        }
-
-        // Save state if *current* frame says "Restore to Previous" (for the next iteration)
-        if frame.dispose == gif::DisposalMethod::Previous {
-            previous_canvas = canvas.clone();
-        }
-
-        last_disposal = frame.dispose;
-        last_rect = (frame.left, frame.top, frame.width, frame.height);
-
-        // 2. Draw current frame onto canvas
-        let palette: Option<&[u8]> = frame.palette.as_deref().or(global_palette.as_deref());
-        if let Some(palette) = palette {
-            let transparent_idx = frame.transparent;
-            let fw = frame.width as usize;
-            let fh = frame.height as usize;
-            let fl = frame.left as usize;
-            let ft = frame.top as usize;
-
-            // Helper to write a pixel
-            let mut put_pixel = |x: usize, y: usize, color_idx: u8| {
-                if Some(color_idx) == transparent_idx {
-                    return;
-                }
-                let base = (color_idx as usize) * 3;
-                if base + 2 >= palette.len() {
-                    return;
-                }
-                let r = palette[base];
-                let g = palette[base + 1];
-                let b = palette[base + 2];
-
-                let cx = fl + x;
-                let cy = ft + y;
-                if cx < width as usize && cy < height as usize {
-                    let idx = (cy * (width as usize) + cx) * 4;
-                    canvas[idx] = r;
-                    canvas[idx + 1] = g;
-                    canvas[idx + 2] = b;
-                    canvas[idx + 3] = 255;
-                }
-            };
-
-            if frame.interlaced {
-                let mut offset = 0;
-                // Pass 1: Every 8th row, starting at 0
-                for y in (0..fh).step_by(8) {
-                    for x in 0..fw {
-                        if offset < frame.buffer.len() {
-                            put_pixel(x, y, frame.buffer[offset]);
-                            offset += 1;
-                        }
-                    }
-                }
-                // Pass 2: Every 8th row, starting at 4
-                for y in (4..fh).step_by(8) {
-                    for x in 0..fw {
-                        if offset < frame.buffer.len() {
-                            put_pixel(x, y, frame.buffer[offset]);
-                            offset += 1;
-                        }
-                    }
-                }
-                // Pass 3: Every 4th row, starting at 2
-                for y in (2..fh).step_by(4) {
-                    for x in 0..fw {
-                        if offset < frame.buffer.len() {
-                            put_pixel(x, y, frame.buffer[offset]);
-                            offset += 1;
-                        }
-                    }
-                }
-                // Pass 4: Every 2nd row, starting at 1
-                for y in (1..fh).step_by(2) {
-                    for x in 0..fw {
-                        if offset < frame.buffer.len() {
-                            put_pixel(x, y, frame.buffer[offset]);
-                            offset += 1;
-                        }
-                    }
-                }
-            } else {
-                // Normal
-                for (i, &idx) in frame.buffer.iter().enumerate() {
-                    let x = i % fw;
-                    let y = i / fw;
-                    put_pixel(x, y, idx);
-                }
-            }
-        }
-
-        frames.push(canvas.clone());
-        delays.push(frame.delay);
-    }
-
     let mut res = RESOURCES.lock().unwrap();
     let id = res.next_id;
     res.next_id += 1;
-    res.gifs.insert(
-        id,
-        GifResource {
-            frames,
-            delays,
-            width,
-            height,
-        },
-    );
+    res.gifs.insert(id, gif);
     id
 }
 
@@ -1244,29 +1000,14 @@ pub fn graphics_gif_draw(id: u32, x: i32, y: i32) {
 
 /// Draw GIF scaled.
 pub fn graphics_gif_draw_scaled(id: u32, x: i32, y: i32, w: u32, h: u32) {
-    let res = RESOURCES.lock().unwrap();
-    if let Some(gif) = res.gifs.get(&id) {
-        let millis = system_millis();
-        let total_delay_ms: u64 = gif.delays.iter().map(|&d| d as u64 * 10).sum();
-
-        let mut frame_idx = 0;
-        if total_delay_ms > 0 {
-            let mut rem = millis % total_delay_ms;
-            for (i, &d) in gif.delays.iter().enumerate() {
-                let d_ms = d as u64 * 10;
-                // Treat 0 delay as 100ms (common GIF viewer behavior)
-                let effective_delay = if d_ms == 0 { 100 } else { d_ms };
-                if rem < effective_delay {
-                    frame_idx = i;
-                    break;
-                }
-                rem = rem.saturating_sub(effective_delay);
-            }
-        }
-
-        let src_rgba = &gif.frames[frame_idx];
+    let mut res = RESOURCES.lock().unwrap();
+    if let Some(gif) = res.gifs.get_mut(&id) {
+        let frame_idx = gif.frame_at(system_millis());
         let src_w = gif.width as u32;
         let src_h = gif.height as u32;
+        let Some(src_rgba) = gif.frame(frame_idx) else {
+            return;
+        };
 
         // Natural size if either dimension is 0.
         if w == 0 || h == 0 {
@@ -1545,6 +1286,8 @@ pub fn graphics_font_unregister(key: u64) {
     if let Some(id) = id {
         let mut res = RESOURCES.lock().unwrap();
         res.fonts.remove(&id);
+        res.glyph_cache.remove_font(id);
+        res.text_layouts.remove_font(id);
     }
 }
 
@@ -1572,24 +1315,33 @@ pub fn graphics_text_key(
     text_ptr: u32,
     text_len: u32,
 ) {
-    let font_id = {
-        let res = RESOURCES.lock().unwrap();
-        res.keyed_fonts.get(&font_key).copied()
-    };
-
-    // If no keyed font is registered, fall back to built-in Spleen at size 16.
-    // This makes text rendering work out-of-the-box even if the guest never
-    // called `wasm96_graphics_font_register_*`.
-    let font_id = match font_id {
-        Some(id) => id,
-        None => graphics_font_use_spleen(16),
-    };
+    graphics_text_key_sized(x, y, env, font_key, 0, text_ptr, text_len);
+}
 
+/// Draw UTF-8 text using a keyed font at an explicit pixel size.
+///
+/// Guest ABI:
+/// - Same as `graphics_text_key`, plus `px`: the TTF/OTF rasterization size in pixels.
+///   `0` selects the default (`DEFAULT_TEXT_PX`).
+///
+/// Notes:
+/// - BDF/Spleen fonts are fixed-size bitmaps and always draw at their native size; `px` is ignored.
+/// - Glyphs are cached per (font, char, px), so prefer a small set of sizes.
+pub fn graphics_text_key_sized(
+    x: i32,
+    y: i32,
+    env: &mut Caller<'_, ()>,
+    font_key: u64,
+    px: u32,
+    text_ptr: u32,
+    text_len: u32,
+) {
+    let font_id = resolve_font_key(font_key);
     if font_id == 0 {
         return;
     }
 
-    graphics_text(x, y, font_id, env, text_ptr, text_len);
+    graphics_text_sized(x, y, font_id, text_px(px), env, text_ptr, text_len);
 }
 
 /// Measure UTF-8 text using a keyed font.
@@ -1617,23 +1369,61 @@ pub fn graphics_text_measure_key(
     text_ptr: u32,
     text_len: u32,
 ) -> u64 {
-    let font_id = {
-        let res = RESOURCES.lock().unwrap();
-        res.keyed_fonts.get(&font_key).copied()
-    };
-
-    // If no keyed font is registered, fall back to built-in Spleen at size 16.
-    // This keeps measure behavior consistent with `graphics_text_key`.
-    let font_id = match font_id {
-        Some(id) => id,
-        None => graphics_font_use_spleen(16),
-    };
+    graphics_text_measure_key_sized(env, font_key, 0, text_ptr, text_len)
+}
 
+/// Measure UTF-8 text using a keyed font at an explicit pixel size.
+///
+/// Matches `graphics_text_key_sized`: `px == 0` selects `DEFAULT_TEXT_PX`, and BDF/Spleen fonts
+/// ignore `px`.
+pub fn graphics_text_measure_key_sized(
+    env: &mut Caller<'_, ()>,
+    font_key: u64,
+    px: u32,
+    text_ptr: u32,
+    text_len: u32,
+) -> u64 {
+    let font_id = resolve_font_key(font_key);
     if font_id == 0 {
         return 0;
     }
 
-    graphics_text_measure(font_id, env, text_ptr, text_len)
+    graphics_text_measure_sized(font_id, text_px(px), env, text_ptr, text_len)
+}
+
+/// TTF/OTF pixel size used when a text call does not specify one.
+pub const DEFAULT_TEXT_PX: f32 = 16.0;
+
+fn text_px(px: u32) -> f32 {
+    if px == 0 { DEFAULT_TEXT_PX } else { px as f32 }
+}
+
+/// Resolve a guest font key to a host font id.
+///
+/// If no keyed font is registered, fall back to built-in Spleen at size 16. This makes text
+/// rendering work out-of-the-box even if the guest never called `wasm96_graphics_font_register_*`,
+/// and draw/measure share it so layout stays consistent.
+///
+/// The fallback font is loaded once and reused; it is not in `keyed_fonts`, so unregistering a key
+/// never drops it.
+fn resolve_font_key(font_key: u64) -> u32 {
+    {
+        let res = RESOURCES.lock().unwrap();
+        if let Some(id) = res
+            .keyed_fonts
+            .get(&font_key)
+            .copied()
+            .or(res.spleen_fallback)
+        {
+            return id;
+        }
+    }
+
+    let id = graphics_font_use_spleen(16);
+    if id != 0 {
+        RESOURCES.lock().unwrap().spleen_fallback = Some(id);
+    }
+    id
 }
 
 /// Parse BDF font data into glyph map.
@@ -1747,186 +1537,344 @@ pub fn graphics_font_use_spleen(size: u32) -> u32 {
     id
 }
 
-/// Draw text.
+/// Draw text at the default TTF/OTF size.
 pub fn graphics_text(x: i32, y: i32, font_id: u32, env: &mut Caller<'_, ()>, ptr: u32, len: u32) {
-    let memory_ptr = {
-        let s = global().lock().unwrap();
-        s.memory_wasmtime
+    graphics_text_sized(x, y, font_id, DEFAULT_TEXT_PX, env, ptr, len);
+}
+
+/// `len` bytes at `ptr` in guest memory, or `None` if the range is out of bounds.
+fn guest_slice(data: &[u8], ptr: u32, len: u32) -> Option<&[u8]> {
+    let start = ptr as usize;
+    data.get(start..start.checked_add(len as usize)?)
+}
+
+/// Draw text; TTF/OTF fonts are rasterized at `px` pixels (through the glyph cache).
+///
+/// The bytes are read in place from guest memory and looked up in `text_layouts`, so redrawing an
+/// unchanged string skips UTF-8 validation and layout.
+pub fn graphics_text_sized(
+    x: i32,
+    y: i32,
+    font_id: u32,
+    px: f32,
+    env: &mut Caller<'_, ()>,
+    ptr: u32,
+    len: u32,
+) {
+    let Some(memory) = env.get_export("memory").and_then(|e| e.into_memory()) else {
+        return;
     };
-    if memory_ptr.is_null() {
+    let Some(text) = guest_slice(memory.data(&*env), ptr, len) else {
         return;
-    }
+    };
+    crate::profile::bytes_in(text.len());
 
-    let mem = unsafe { &*memory_ptr };
+    // Lock global state once for the whole string (RESOURCES first: the established lock order).
+    let mut res = RESOURCES.lock().unwrap();
+    let mut s = lock_state();
+    let color = s.video.draw_color;
+    draw_text(&mut res, &mut s.video, font_id, px, text, x, y, color);
+}
 
-    let mut text_bytes = vec![0u8; len as usize];
-    if mem.read(env, ptr as usize, &mut text_bytes).is_err() {
-        return;
+/// Draw UTF-8 `text` with its top-left corner at (`x`, `y`) in `color`.
+///
+/// Returns `false` (drawing nothing) if the font is missing or the text is not valid UTF-8.
+pub fn draw_text(
+    res: &mut Resources,
+    v: &mut VideoState,
+    font_id: u32,
+    px: f32,
+    text: &[u8],
+    x: i32,
+    y: i32,
+    color: u32,
+) -> bool {
+    let Some(font) = res.fonts.get(&font_id) else {
+        return false;
+    };
+    let Some(run) = res.text_layouts.get_or_layout(font_id, font, px, text) else {
+        return false;
+    };
+    match (&run.glyphs, font) {
+        (Glyphs::Ttf(glyphs), FontResource::Ttf(f)) => {
+            // Coverage blits: deferred and drawn on the GPU like the shapes around them.
+            draw_ttf_glyphs(v, &mut res.glyph_cache, f, font_id, px, glyphs, x, y, color);
+        }
+        (Glyphs::Bdf(spans), _) => {
+            // Plain shapes: deferred, drawn on the GPU or recorded into a list like any other.
+            for span in spans {
+                let (x, y, w) = (x + span.dx, y + span.dy, span.len);
+                raster::submit(v, Shape::Rect { x, y, w, h: 1 }, color);
+            }
+        }
+        _ => {}
     }
+    true
+}
 
-    let text = match std::str::from_utf8(&text_bytes) {
-        Ok(s) => s,
-        Err(_) => return,
-    };
+/// Submit a laid-out TTF/OTF run at (`x`, `y`), one coverage blit per glyph (see `sprites`).
+///
+/// Each pixel covers with the glyph coverage times the draw color's alpha, so full coverage in an
+/// opaque color writes alpha 255 and translucent text blends like shapes.
+fn draw_ttf_glyphs(
+    v: &mut VideoState,
+    glyph_cache: &mut GlyphCache,
+    f: &Font,
+    font_id: u32,
+    px: f32,
+    glyphs: &[(char, f32)],
+    x: i32,
+    y: i32,
+    color: u32,
+) {
+    if color >> 24 == 0 {
+        return;
+    }
 
-    let res = RESOURCES.lock().unwrap();
-    if let Some(font) = res.fonts.get(&font_id) {
-        match font {
-            FontResource::Ttf(f) => {
-                // Lock global state once for the whole string to enable blending
-                let mut s = match global().lock() {
-                    Ok(g) => g,
-                    Err(poisoned) => poisoned.into_inner(),
-                };
-                let width = s.video.width as i32;
-                let height = s.video.height as i32;
-                let draw_color = s.video.draw_color;
-                let r_fg = ((draw_color >> 16) & 0xFF) as f32;
-                let g_fg = ((draw_color >> 8) & 0xFF) as f32;
-                let b_fg = (draw_color & 0xFF) as f32;
-                let r_fg_sq = r_fg * r_fg;
-                let g_fg_sq = g_fg * g_fg;
-                let b_fg_sq = b_fg * b_fg;
-
-                let mut px = x as f32;
-                for ch in text.chars() {
-                    let (metrics, bitmap) = f.rasterize(ch, 16.0); // fixed size
-                    let start_x = px.round() as i32;
-                    for (i, &alpha) in bitmap.iter().enumerate() {
-                        if alpha > 0 {
-                            let gx = start_x + (i % metrics.width) as i32;
-                            let gy = y + (i / metrics.width) as i32;
-
-                            if gx >= 0 && gx < width && gy >= 0 && gy < height {
-                                let idx = (gy * width + gx) as usize;
-                                let bg = s.video.framebuffer[idx];
-
-                                // Alpha blend (gamma-correct approximation)
-                                let a = alpha as f32 / 255.0;
-                                let inv_a = 1.0 - a;
-
-                                let r_bg = ((bg >> 16) & 0xFF) as f32;
-                                let g_bg = ((bg >> 8) & 0xFF) as f32;
-                                let b_bg = (bg & 0xFF) as f32;
-
-                                let r = (r_fg_sq * a + r_bg * r_bg * inv_a).sqrt() as u32;
-                                let g = (g_fg_sq * a + g_bg * g_bg * inv_a).sqrt() as u32;
-                                let b = (b_fg_sq * a + b_bg * b_bg * inv_a).sqrt() as u32;
-
-                                s.video.framebuffer[idx] = (r << 16) | (g << 8) | b;
-                            }
-                        }
-                    }
-                    px += metrics.advance_width;
-                }
-            }
-            FontResource::Bdf {
-                width,
-                height,
-                glyphs,
-            } => {
-                let stride = (width + 7) / 8;
-                let mut px = x;
-                for ch in text.chars() {
-                    if let Some(bitmap) = glyphs.get(&ch) {
-                        for row in 0..*height as usize {
-                            for byte_idx in 0..stride as usize {
-                                let idx = row * stride as usize + byte_idx;
-                                if idx < bitmap.len() {
-                                    let byte = bitmap[idx];
-                                    for bit in 0..8 {
-                                        let col = byte_idx * 8 + bit;
-                                        if col < *width as usize {
-                                            if (byte & (1 << (7 - bit))) != 0 {
-                                                graphics_point(px + col as i32, y + row as i32);
-                                            }
-                                        }
-                                    }
-                                }
-                            }
-                        }
-                    }
-                    px += *width as i32;
-                }
-            }
+    for &(ch, pen) in glyphs {
+        let glyph = glyph_cache.get_or_insert_with(GlyphKey::new(font_id, ch, px), || {
+            let (metrics, bitmap) = f.rasterize(ch, px);
+            (metrics.width, metrics.height, metrics.advance_width, bitmap)
+        });
+        let start_x = (x as f32 + pen).round() as i32;
+        let sprite = Sprite {
+            tint: color,
+            ..Sprite::image(start_x, y, 0, 0)
+        };
+        let (w, h) = (glyph.width as u32, glyph.height as u32);
+        if let Some(blit) = Blit::new(&glyph.coverage, true, w, h, &sprite) {
+            sprites::submit(v, blit);
         }
     }
 }
 
-/// Measure text.
+/// Measure text at the default TTF/OTF size.
 pub fn graphics_text_measure(font_id: u32, env: &mut Caller<'_, ()>, ptr: u32, len: u32) -> u64 {
-    let memory_ptr = {
-        let s = global().lock().unwrap();
-        s.memory_wasmtime
+    graphics_text_measure_sized(font_id, DEFAULT_TEXT_PX, env, ptr, len)
+}
+
+/// Measure text; TTF/OTF fonts are measured at `px` pixels.
+///
+/// Shares `text_layouts` with drawing, so measuring a string to center it and then drawing it
+/// lays it out once.
+pub fn graphics_text_measure_sized(
+    font_id: u32,
+    px: f32,
+    env: &mut Caller<'_, ()>,
+    ptr: u32,
+    len: u32,
+) -> u64 {
+    let Some(memory) = env.get_export("memory").and_then(|e| e.into_memory()) else {
+        return 0;
     };
-    if memory_ptr.is_null() {
+    let Some(text) = guest_slice(memory.data(&*env), ptr, len) else {
         return 0;
-    }
+    };
+    crate::profile::bytes_in(text.len());
 
-    let mem = unsafe { &*memory_ptr };
+    let mut res = RESOURCES.lock().unwrap();
+    let (width, height) = measure_text(&mut res, font_id, px, text).unwrap_or((0, 0));
+    ((width as u64) << 32) | (height as u64)
+}
 
-    let mut text_bytes = vec![0u8; len as usize];
-    if mem.read(env, ptr as usize, &mut text_bytes).is_err() {
-        return 0;
+/// Width and height of UTF-8 `text` in pixels (`None` if the font is missing or the text is not
+/// valid UTF-8).
+pub fn measure_text(res: &mut Resources, font_id: u32, px: f32, text: &[u8]) -> Option<(u32, u32)> {
+    let font = res.fonts.get(&font_id)?;
+    let run = res.text_layouts.get_or_layout(font_id, font, px, text)?;
+    Some((run.width, run.height))
+}
+
+/// One `wasm96_graphics_text_batch` record (see `abi::text`).
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct TextItem {
+    pub x: i32,
+    pub y: i32,
+    pub text_ptr: u32,
+    pub text_len: u32,
+    pub color: u32,
+    pub px: u32,
+}
+
+impl TextItem {
+    /// Decode one record of `TEXT_ITEM_SIZE` little-endian bytes.
+    pub fn from_le_bytes(bytes: &[u8]) -> Self {
+        let word = |i: usize| {
+            let o = i * 4;
+            u32::from_le_bytes([bytes[o], bytes[o + 1], bytes[o + 2], bytes[o + 3]])
+        };
+        Self {
+            x: word(0) as i32,
+            y: word(1) as i32,
+            text_ptr: word(2),
+            text_len: word(3),
+            color: word(4),
+            px: word(5),
+        }
     }
+}
 
-    let text = match std::str::from_utf8(&text_bytes) {
-        Ok(s) => s,
-        Err(_) => return 0,
+/// Draw `count` positioned strings in one keyed font.
+///
+/// Guest ABI:
+/// - `font_key`: as for `graphics_text_key` (unregistered keys fall back to Spleen 16).
+/// - `ptr`: `count` records of `abi::text::TEXT_ITEM_SIZE` bytes in guest memory.
+///
+/// The font is resolved and both locks are taken once for the whole batch, and every string goes
+/// through `text_layouts`, so a HUD of unchanged lines costs one import call and a cache lookup
+/// per line. Returns the number of strings drawn: `0` if the record array is out of bounds.
+/// Records whose text is out of bounds or not valid UTF-8 are skipped.
+pub fn graphics_text_batch(
+    caller: &mut Caller<'_, ()>,
+    font_key: u64,
+    ptr: u32,
+    count: u32,
+) -> u32 {
+    let font_id = resolve_font_key(font_key);
+    if font_id == 0 {
+        return 0;
+    }
+    let Some(memory) = caller.get_export("memory").and_then(|e| e.into_memory()) else {
+        return 0;
+    };
+    let data = memory.data(&*caller);
+    let Some(items) = (count as usize)
+        .checked_mul(abi::text::TEXT_ITEM_SIZE)
+        .and_then(|len| guest_slice(data, ptr, u32::try_from(len).ok()?))
+    else {
+        return 0;
     };
 
-    let res = RESOURCES.lock().unwrap();
-    let (width, height) = if let Some(font) = res.fonts.get(&font_id) {
-        match font {
-            FontResource::Ttf(f) => {
-                let mut width = 0.0;
-                let mut height: f32 = 0.0;
-                for ch in text.chars() {
-                    let (metrics, _) = f.rasterize(ch, 16.0);
-                    width += metrics.advance_width;
-                    height = height.max(metrics.height as f32);
-                }
-                (width.round() as u32, height as u32)
-            }
-            FontResource::Bdf {
-                width,
-                height,
-                glyphs: _,
-            } => (text.chars().count() as u32 * *width, *height),
+    // Lock order: RESOURCES before the global state.
+    let mut res = RESOURCES.lock().unwrap();
+    let mut s = lock_state();
+    let (mut drawn, mut bytes_in) = (0, items.len());
+    for record in items.chunks_exact(abi::text::TEXT_ITEM_SIZE) {
+        let item = TextItem::from_le_bytes(record);
+        let Some(text) = guest_slice(data, item.text_ptr, item.text_len) else {
+            continue;
+        };
+        bytes_in += text.len();
+        let color = match item.color {
+            abi::text::COLOR_CURRENT => s.video.draw_color,
+            c => c,
+        };
+        let (x, y, px) = (item.x, item.y, text_px(item.px));
+        if draw_text(&mut res, &mut s.video, font_id, px, text, x, y, color) {
+            drawn += 1;
         }
-    } else {
-        (0, 0)
-    };
+    }
+    crate::profile::bytes_in(bytes_in);
+    drawn
+}
 
-    ((width as u64) << 32) | (height as u64)
+/// A frame being presented (see `with_presented_framebuffer`).
+pub(crate) struct PresentedFrame<'a> {
+    pub pixels: &'a [u32],
+    pub width: u32,
+    pub height: u32,
+    pub video_cb: Option<VideoRefreshFn>,
+    /// Pixels changed since the previous present.
+    pub damage: DamageRect,
+    /// Outside this rectangle every pixel is transparent.
+    pub overlay_bounds: DamageRect,
+    /// The frontend may be handed a NULL frame to repeat the previous one.
+    pub can_dupe: bool,
 }
 
-/// Present the framebuffer to libretro.
-pub fn video_present_host() {
-    // Flush any 3D content to the framebuffer before presenting
-    if super::graphics3d::flush_to_host() {
-        return;
+/// Lend the framebuffer to `f` without copying it and without holding the global lock.
+///
+/// If the guest bound its own framebuffer and it fits in `guest_memory`, `f` gets those pixels
+/// directly. Otherwise the host pixel `Vec` is moved out of the state (a pointer swap, no
+/// allocation), handed to `f` together with the frame size and video callback, then moved back.
+/// The frontend therefore sees stable memory for the whole callback, and because it is the same
+/// buffer the guest's drawing still persists into the next frame (immediate mode never implicitly
+/// clears).
+///
+/// The damage rectangle is reset, so drawing after this call counts towards the next frame.
+pub(crate) fn with_presented_framebuffer<R>(
+    guest_memory: Option<&[u8]>,
+    f: impl FnOnce(PresentedFrame<'_>) -> R,
+) -> R {
+    let (video_cb, can_dupe, bound, damage, overlay_bounds) = {
+        let mut s = lock_state();
+        super::tiles::resolve(&mut s.video);
+        (
+            s.video_refresh_cb,
+            s.frontend_can_dupe,
+            s.video.bound_framebuffer,
+            std::mem::take(&mut s.video.damage),
+            s.video.overlay_bounds,
+        )
+    };
+
+    if let (Some(mem), Some(bound)) = (guest_memory, bound) {
+        if let Some(pixels) = guest_framebuffer_pixels(mem, &bound) {
+            // The guest writes its pixels directly, so the host cannot see what changed.
+            let full = DamageRect::full(bound.width, bound.height);
+            return f(PresentedFrame {
+                pixels,
+                width: bound.width,
+                height: bound.height,
+                video_cb,
+                damage: full,
+                overlay_bounds: full,
+                can_dupe,
+            });
+        }
     }
 
-    let (video_cb, width, height, fb) = {
-        let s = match global().lock() {
-            Ok(g) => g,
-            Err(poisoned) => poisoned.into_inner(),
-        };
+    let (width, height, fb) = {
+        let mut s = lock_state();
         (
-            s.video_refresh_cb,
             s.video.width,
             s.video.height,
-            s.video.framebuffer.clone(),
+            std::mem::take(&mut s.video.framebuffer),
         )
     };
 
-    if let Some(cb) = video_cb {
-        let data_ptr = fb.as_ptr() as *const std::ffi::c_void;
-        let pitch = (width * 4) as usize;
+    let out = f(PresentedFrame {
+        pixels: &fb,
+        width,
+        height,
+        video_cb,
+        damage,
+        overlay_bounds,
+        can_dupe,
+    });
+
+    let mut s = lock_state();
+    // Only restore if nothing re-allocated the framebuffer in the meantime (e.g. a resize).
+    if s.video.framebuffer.is_empty() {
+        s.video.framebuffer = fb;
+    }
+    out
+}
 
-        unsafe {
-            cb(data_ptr, width, height, pitch);
-        }
+/// Present the framebuffer to libretro.
+///
+/// `guest_memory` is the guest's linear memory, used when the guest bound its own framebuffer.
+pub fn video_present_host(guest_memory: Option<&[u8]>) {
+    // Flush any 3D content to the framebuffer before presenting
+    if super::graphics3d::flush_to_host(guest_memory) {
+        return;
     }
+
+    with_presented_framebuffer(guest_memory, |frame| {
+        if let Some(cb) = frame.video_cb {
+            let (width, height) = (frame.width, frame.height);
+            let pitch = (width * 4) as usize;
+            // Nothing was drawn since the last frame: let the frontend repeat it instead of
+            // reading (and usually converting/uploading) the whole framebuffer again.
+            let data_ptr = if frame.damage.is_empty() && frame.can_dupe {
+                std::ptr::null()
+            } else {
+                frame.pixels.as_ptr() as *const std::ffi::c_void
+            };
+
+            unsafe {
+                cb(data_ptr, width, height, pitch);
+            }
+        }
+    });
 }
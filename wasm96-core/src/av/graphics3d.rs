@@ -5,22 +5,29 @@
 //! - Managing 3D resources (meshes, shaders, textures).
 //! - Drawing 3D scenes.
 //! - Compositing the 2D host framebuffer (overlay) onto the 3D scene.
+//! - Drawing the recorded 2D primitives on top of it (the pass lives in `gpu2d`).
+//!
+//! Each mesh keeps an object-space bounding sphere. Draws whose sphere lies outside the camera
+//! frustum are skipped before any GL work; `graphics_mesh_stats` reports how many were submitted
+//! and culled this frame.
+//!
+//! Many copies of one mesh can be drawn with a single `graphics_mesh_draw_instanced` call.
 //!
 //! NOTE: Some paths in this module create temporary GL textures during `graphics_mesh_draw`.
 //! Those textures must be deleted after drawing to avoid leaking GL texture IDs.
 
 use std::collections::HashMap;
 use std::ffi::{CString, c_void};
-use std::io::Cursor;
-use std::path::Path;
-
+use std::sync::atomic::{AtomicU32, Ordering};
 use std::sync::{Mutex, OnceLock};
 
 use bytemuck::{Pod, Zeroable};
-use glam::{Mat4, Vec3};
+use glam::{Mat3, Mat4, Vec3, Vec4};
 
+use crate::abi::mesh::{INDEX_U16, INDEX_U32, INSTANCE_FLOATS};
 use crate::state::global;
 
+use super::mesh_data::{VertexFormat, obj_to_mesh, parse_blob, stl_to_mesh};
 use super::resources::RESOURCES;
 use super::utils::read_guest_bytes;
 
@@ -41,12 +48,99 @@ pub struct Mesh {
     #[allow(dead_code)]
     pub ebo: u32,
     pub index_count: i32,
+    /// `gl::UNSIGNED_INT`, or `gl::UNSIGNED_SHORT` for blobs with 16-bit indices.
+    pub index_type: u32,
+    /// Normals are oct-encoded (`abi::mesh::NORMAL_OCT16`); the vertex shader expands them.
+    pub oct_normals: bool,
+
+    /// Object-space bounding sphere, used to skip draws outside the view frustum.
+    pub bounds: Bounds,
 
     /// Optional bound texture for this mesh (keyed image id).
     /// If `None`, the 3D shader will render using the uniform `color`.
     pub texture_key: Option<u64>,
 }
 
+/// Bounding sphere around a mesh's vertices.
+#[derive(Clone, Copy, Debug, Default, PartialEq)]
+pub struct Bounds {
+    pub center: Vec3,
+    pub radius: f32,
+}
+
+impl Bounds {
+    /// Sphere centered on the vertices' AABB, just large enough to contain every vertex.
+    pub fn from_vertices(vertices: &[Vertex]) -> Self {
+        Self::from_points(vertices.iter().map(|v| Vec3::from(v.position)))
+    }
+
+    /// Sphere centered on the points' AABB, just large enough to contain every point.
+    pub fn from_points<I>(points: I) -> Self
+    where
+        I: Iterator<Item = Vec3> + Clone,
+    {
+        let mut iter = points.clone();
+        let Some(first) = iter.next() else {
+            return Self::default();
+        };
+        let (min, max) = iter.fold((first, first), |(min, max), p| (min.min(p), max.max(p)));
+        let center = (min + max) * 0.5;
+        let radius = points
+            .map(|p| p.distance_squared(center))
+            .fold(0.0f32, f32::max)
+            .sqrt();
+        Self { center, radius }
+    }
+
+    /// The sphere after `model` (scaled by the model's largest axis scale, so it stays
+    /// conservative under non-uniform scaling).
+    pub fn transformed(&self, model: &Mat4) -> Self {
+        let scale = model
+            .x_axis
+            .truncate()
+            .length()
+            .max(model.y_axis.truncate().length())
+            .max(model.z_axis.truncate().length());
+        Self {
+            center: model.transform_point3(self.center),
+            radius: self.radius * scale,
+        }
+    }
+}
+
+/// The six clip planes of a view-projection matrix, normalized, pointing inwards.
+#[derive(Clone, Copy, Debug)]
+pub struct Frustum {
+    planes: [Vec4; 6],
+}
+
+impl Frustum {
+    /// Extract the planes of GL's clip volume (`-w <= x, y, z <= w`) from `view_proj`.
+    pub fn from_view_proj(m: &Mat4) -> Self {
+        let (r0, r1, r2, r3) = (m.row(0), m.row(1), m.row(2), m.row(3));
+        let mut planes = [r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2];
+        for p in &mut planes {
+            let len = p.truncate().length();
+            if len > 0.0 {
+                *p /= len;
+            }
+        }
+        Self { planes }
+    }
+
+    /// Whether any part of the world-space sphere `b` can be inside the frustum.
+    pub fn intersects(&self, b: &Bounds) -> bool {
+        self.planes
+            .iter()
+            .all(|p| p.truncate().dot(b.center) + p.w >= -b.radius)
+    }
+}
+
+/// Mesh draws submitted to GL and rejected by frustum culling since the start of the frame
+/// (`prepare_frame`). Each instance of an instanced draw counts once.
+static MESHES_SUBMITTED: AtomicU32 = AtomicU32::new(0);
+static MESHES_CULLED: AtomicU32 = AtomicU32::new(0);
+
 #[derive(Default, Clone, Copy)]
 pub struct State3d {
     pub enabled: bool,
@@ -62,6 +156,19 @@ struct GlState {
     uniform_color: i32,
     uniform_tex3d: i32,
     uniform_use_tex: i32,
+    uniform_oct_normals: i32,
+
+    // Instanced 3D Shader (`graphics_mesh_draw_instanced`)
+    program_3d_instanced: u32,
+    uniform_inst_view_proj: i32,
+    uniform_inst_color: i32,
+    uniform_inst_tex: i32,
+    uniform_inst_use_tex: i32,
+    uniform_inst_oct_normals: i32,
+    /// Per-instance attribute buffer, refilled by every instanced draw.
+    instance_vbo: u32,
+    /// Reused CPU-side staging for `instance_vbo`.
+    instance_scratch: Vec<f32>,
 
     // Overlay Shader (2D)
     program_overlay: u32,
@@ -73,6 +180,9 @@ struct GlState {
     overlay_texture: u32,
     overlay_texture_size: (u32, u32),
 
+    // GPU 2D pass for the recorded primitives (see `gpu2d`)
+    gpu2d: super::gpu2d::Pass,
+
     output_fbo: u32,
 }
 
@@ -89,6 +199,13 @@ lazy_static::lazy_static! {
 }
 static GL_STATE: OnceLock<Mutex<GlState>> = OnceLock::new();
 
+/// Floats per instance in `GlState::instance_vbo`: model matrix (4x4) + normal matrix (3x3).
+const INSTANCE_ATTRIB_FLOATS: usize = 16 + 9;
+/// First attribute location of the per-instance model matrix (one `vec4` column per location).
+const INSTANCE_MODEL_LOCATION: u32 = 3;
+/// First attribute location of the per-instance normal matrix (one `vec3` column per location).
+const INSTANCE_NORMAL_LOCATION: u32 = 7;
+
 // --- Shaders ---
 
 const VS_3D_SRC: &str = r#"
@@ -99,13 +216,23 @@ layout(location = 2) in vec3 normal;
 
 uniform mat4 mvp;
 uniform mat4 normal_mat;
+uniform int oct_normals;
 
 out vec3 v_normal;
 out vec2 v_uv;
 
+// Octahedral normal decoding (`abi::mesh::NORMAL_OCT16`).
+vec3 oct_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
 void main() {
     gl_Position = mvp * vec4(position, 1.0);
-    v_normal = mat3(normal_mat) * normal;
+    v_normal = mat3(normal_mat) * (oct_normals != 0 ? oct_decode(normal.xy) : normal);
     v_uv = uv;
 }
 "#;
@@ -139,6 +266,38 @@ void main() {
 }
 "#;
 
+// Same inputs and outputs as `VS_3D_SRC`, with the model and normal matrices supplied per instance
+// (see `INSTANCE_MODEL_LOCATION` / `INSTANCE_NORMAL_LOCATION`). Shares `FS_3D_SRC`.
+const VS_3D_INSTANCED_SRC: &str = r#"
+#version 330 core
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec2 uv;
+layout(location = 2) in vec3 normal;
+layout(location = 3) in mat4 model;
+layout(location = 7) in mat3 normal_mat;
+
+uniform mat4 view_proj;
+uniform int oct_normals;
+
+out vec3 v_normal;
+out vec2 v_uv;
+
+// Octahedral normal decoding (`abi::mesh::NORMAL_OCT16`).
+vec3 oct_decode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    gl_Position = view_proj * model * vec4(position, 1.0);
+    v_normal = normal_mat * (oct_normals != 0 ? oct_decode(normal.xy) : normal);
+    v_uv = uv;
+}
+"#;
+
 const VS_OVERLAY_SRC: &str = r#"
 #version 330 core
 // Fullscreen triangle strip generated in shader
@@ -183,6 +342,8 @@ where
     // Initialize GL state
     let program_3d = create_program(VS_3D_SRC, FS_3D_SRC);
     check_gl_error("create_program 3d");
+    let program_3d_instanced = create_program(VS_3D_INSTANCED_SRC, FS_3D_SRC);
+    check_gl_error("create_program 3d instanced");
     let program_overlay = create_program(VS_OVERLAY_SRC, FS_OVERLAY_SRC);
     check_gl_error("create_program overlay");
 
@@ -207,6 +368,13 @@ where
         gl::GetUniformLocation(program_3d, name.as_ptr())
     };
 
+    let uniform_inst_view_proj = uniform_location(program_3d_instanced, "view_proj");
+    let uniform_inst_color = uniform_location(program_3d_instanced, "color");
+    let uniform_inst_tex = uniform_location(program_3d_instanced, "tex");
+    let uniform_inst_use_tex = uniform_location(program_3d_instanced, "use_tex");
+    let uniform_inst_oct_normals = uniform_location(program_3d_instanced, "oct_normals");
+    let uniform_oct_normals = uniform_location(program_3d, "oct_normals");
+
     let uniform_tex = unsafe {
         let name = CString::new("tex").unwrap();
         gl::GetUniformLocation(program_overlay, name.as_ptr())
@@ -215,7 +383,9 @@ where
 
     let mut overlay_vao = 0;
     let mut overlay_texture = 0;
+    let mut instance_vbo = 0;
     unsafe {
+        gl::GenBuffers(1, &mut instance_vbo);
         gl::GenVertexArrays(1, &mut overlay_vao);
         gl::GenTextures(1, &mut overlay_texture);
 
@@ -228,6 +398,9 @@ where
     }
     check_gl_error("overlay setup");
 
+    let gpu2d = super::gpu2d::Pass::new();
+    check_gl_error("gpu2d setup");
+
     let state = GlState {
         program_3d,
         uniform_mvp,
@@ -235,15 +408,27 @@ where
         uniform_color,
         uniform_tex3d,
         uniform_use_tex,
+        uniform_oct_normals,
+        program_3d_instanced,
+        uniform_inst_view_proj,
+        uniform_inst_color,
+        uniform_inst_tex,
+        uniform_inst_use_tex,
+        uniform_inst_oct_normals,
+        instance_vbo,
+        instance_scratch: Vec::new(),
         program_overlay,
         uniform_tex,
         overlay_vao,
         overlay_texture,
         overlay_texture_size: (0, 0),
+        gpu2d,
         output_fbo: 0,
     };
 
     GL_STATE.get_or_init(|| Mutex::new(state));
+    // Primitives can be drawn on the GPU from now on, so record them all.
+    super::tiles::set_gpu(&mut global().lock().unwrap().video, true);
 
     // Initial GL setup
     unsafe {
@@ -256,6 +441,11 @@ where
     check_gl_error("init_gl_context");
 }
 
+pub(super) fn uniform_location(program: u32, name: &str) -> i32 {
+    let name = CString::new(name).unwrap();
+    unsafe { gl::GetUniformLocation(program, name.as_ptr()) }
+}
+
 fn check_gl_error(label: &str) {
     unsafe {
         let mut err = gl::GetError();
@@ -266,7 +456,7 @@ fn check_gl_error(label: &str) {
     }
 }
 
-fn create_program(vs_src: &str, fs_src: &str) -> u32 {
+pub(super) fn create_program(vs_src: &str, fs_src: &str) -> u32 {
     unsafe {
         let vs = compile_shader(gl::VERTEX_SHADER, vs_src);
         let fs = compile_shader(gl::FRAGMENT_SHADER, fs_src);
@@ -359,6 +549,95 @@ pub fn graphics_camera_perspective(fovy: f32, aspect: f32, near: f32, far: f32)
     s.projection = Mat4::perspective_rh(fovy, aspect, near, far);
 }
 
+/// Create the VAO/VBO/EBO for one mesh. `vertices` is laid out as `format` describes;
+/// `index_type` is `gl::UNSIGNED_INT` or `gl::UNSIGNED_SHORT`.
+fn upload_mesh(
+    format: &VertexFormat,
+    vertices: &[u8],
+    indices: &[u8],
+    index_count: u32,
+    index_type: u32,
+    bounds: Bounds,
+    label: &str,
+) -> Mesh {
+    let mut vao = 0;
+    let mut vbo = 0;
+    let mut ebo = 0;
+
+    unsafe {
+        gl::GenVertexArrays(1, &mut vao);
+        gl::GenBuffers(1, &mut vbo);
+        gl::GenBuffers(1, &mut ebo);
+
+        gl::BindVertexArray(vao);
+
+        gl::BindBuffer(gl::ARRAY_BUFFER, vbo);
+        gl::BufferData(
+            gl::ARRAY_BUFFER,
+            vertices.len() as isize,
+            vertices.as_ptr() as *const c_void,
+            gl::STATIC_DRAW,
+        );
+
+        gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, ebo);
+        gl::BufferData(
+            gl::ELEMENT_ARRAY_BUFFER,
+            indices.len() as isize,
+            indices.as_ptr() as *const c_void,
+            gl::STATIC_DRAW,
+        );
+
+        for attrib in [Some(format.position), format.uv, Some(format.normal)]
+            .into_iter()
+            .flatten()
+        {
+            gl::VertexAttribPointer(
+                attrib.location,
+                attrib.components,
+                attrib.gl_type,
+                if attrib.normalized {
+                    gl::TRUE
+                } else {
+                    gl::FALSE
+                },
+                format.stride as i32,
+                attrib.offset as *const c_void,
+            );
+            gl::EnableVertexAttribArray(attrib.location);
+        }
+
+        gl::BindVertexArray(0);
+
+        check_gl_error(label);
+    }
+
+    Mesh {
+        vao,
+        vbo,
+        ebo,
+        index_count: index_count as i32,
+        index_type,
+        oct_normals: format.oct_normals,
+        bounds,
+        texture_key: None,
+    }
+}
+
+/// Upload converted vertices and `u32` indices and store the mesh under `key`.
+fn store_mesh(key: u64, vertices: &[Vertex], indices: &[u32], label: &str) -> u32 {
+    let mesh = upload_mesh(
+        &VertexFormat::float(),
+        bytemuck::cast_slice(vertices),
+        bytemuck::cast_slice(indices),
+        indices.len() as u32,
+        gl::UNSIGNED_INT,
+        Bounds::from_vertices(vertices),
+        label,
+    );
+    MESH_STORE.lock().unwrap().insert(key, mesh);
+    1
+}
+
 pub fn graphics_mesh_create(
     env: &mut wasmtime::Caller<'_, ()>,
     key: u64,
@@ -394,88 +673,11 @@ pub fn graphics_mesh_create(
         (vertices.to_vec(), indices.to_vec())
     };
 
-    let mut vao = 0;
-    let mut vbo = 0;
-    let mut ebo = 0;
-
     if GL_STATE.get().is_none() {
         return 0;
     }
 
-    unsafe {
-        gl::GenVertexArrays(1, &mut vao);
-        gl::GenBuffers(1, &mut vbo);
-        gl::GenBuffers(1, &mut ebo);
-
-        gl::BindVertexArray(vao);
-
-        gl::BindBuffer(gl::ARRAY_BUFFER, vbo);
-        gl::BufferData(
-            gl::ARRAY_BUFFER,
-            (vertices.len() * std::mem::size_of::<Vertex>()) as isize,
-            vertices.as_ptr() as *const c_void,
-            gl::STATIC_DRAW,
-        );
-
-        gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, ebo);
-        gl::BufferData(
-            gl::ELEMENT_ARRAY_BUFFER,
-            (indices.len() * 4) as isize,
-            indices.as_ptr() as *const c_void,
-            gl::STATIC_DRAW,
-        );
-
-        // Vertex attributes
-        // 0: Position (3 floats)
-        gl::VertexAttribPointer(
-            0,
-            3,
-            gl::FLOAT,
-            gl::FALSE,
-            std::mem::size_of::<Vertex>() as i32,
-            0 as *const c_void,
-        );
-        gl::EnableVertexAttribArray(0);
-
-        // 1: UV (2 floats)
-        gl::VertexAttribPointer(
-            1,
-            2,
-            gl::FLOAT,
-            gl::FALSE,
-            std::mem::size_of::<Vertex>() as i32,
-            12 as *const c_void,
-        );
-        gl::EnableVertexAttribArray(1);
-
-        // 2: Normal (3 floats)
-        gl::VertexAttribPointer(
-            2,
-            3,
-            gl::FLOAT,
-            gl::FALSE,
-            std::mem::size_of::<Vertex>() as i32,
-            20 as *const c_void,
-        );
-        gl::EnableVertexAttribArray(2);
-
-        gl::BindVertexArray(0);
-
-        check_gl_error("graphics_mesh_create");
-    }
-
-    let mut store = MESH_STORE.lock().unwrap();
-    store.insert(
-        key,
-        Mesh {
-            vao,
-            vbo,
-            ebo,
-            index_count: i_len as i32,
-            texture_key: None,
-        },
-    );
-    1
+    store_mesh(key, &vertices, &indices, "graphics_mesh_create")
 }
 
 pub fn graphics_mesh_create_obj(
@@ -495,219 +697,160 @@ pub fn graphics_mesh_create_obj(
         Err(_) => return 0,
     };
 
-    // Parse OBJ using `tobj` (more robust, supports MTL).
-    //
-    // We load from an in-memory buffer and provide a material loader closure. Since this core
-    // currently receives only OBJ bytes (no filesystem), we provide a "no materials" loader.
-    // This still correctly loads geometry and supports models that either don't reference MTL,
-    // or where materials are optional.
-    //
-    // Follow-up: we can extend the ABI to allow the guest to provide MTL bytes and texture bytes
-    // so `material_loader` can parse MTL and we can register textures automatically.
-    let mut reader = Cursor::new(obj_bytes);
-
-    let (models, _materials) = match tobj::load_obj_buf(
-        &mut reader,
-        &tobj::LoadOptions {
-            // Use tobj's standard behavior as much as possible:
-            // - triangulate for our renderer
-            // - single_index so tobj unifies position/uv/normal into one index stream
-            triangulate: true,
-            single_index: true,
-            ..Default::default()
-        },
-        |_p: &Path| -> tobj::MTLLoadResult {
-            // No filesystem access / no provided MTL bytes in this call.
-            // Return an empty material list (Ok) so model loading proceeds.
-            Ok((Vec::new(), ahash::AHashMap::new()))
-        },
-    ) {
-        Ok(r) => r,
-        Err(_) => return 0,
+    let Some((vertices, indices)) = obj_to_mesh(&obj_bytes) else {
+        return 0;
     };
+    store_mesh(key, &vertices, &indices, "graphics_mesh_create_obj")
+}
 
-    if models.is_empty() {
+/// Upload a mesh decoded off-thread (`assets`). Must run on the GL thread.
+pub(super) fn store_decoded_mesh(key: u64, vertices: &[Vertex], indices: &[u32]) -> u32 {
+    if GL_STATE.get().is_none() {
         return 0;
     }
+    store_mesh(key, vertices, indices, "asset_load")
+}
 
-    // TEMP DEBUG (remove when done):
-    // Dump tobj-produced stream sizes to compare against expected unified tuple counts.
-    // For the included duck OBJs, expected unified vertex counts (from offline analysis):
-    // - 12248_Bird_v1_L2.obj: 9582
-    // - 12249_Bird_v1_L2.obj: 9760
-    eprintln!("wasm96: OBJ load OK key={} models={}", key, models.len());
-    for (mi, model) in models.iter().enumerate() {
-        let m = &model.mesh;
-        eprintln!(
-            "wasm96: OBJ model[{mi}] pos={} uv={} n={} idx={} (single_index=true triangulate=true)",
-            m.positions.len() / 3,
-            m.texcoords.len() / 2,
-            m.normals.len() / 3,
-            m.indices.len(),
-        );
+pub fn graphics_mesh_create_stl(
+    env: &mut wasmtime::Caller<'_, ()>,
+    key: u64,
+    ptr: u32,
+    len: u32,
+) -> u32 {
+    if GL_STATE.get().is_none() {
+        return 0;
     }
 
-    // Convert to wasm96-core's `Vertex` and u32 indices by concatenating all models into one mesh.
-    // This preserves a single VAO/VBO/EBO per `key` as expected by the current renderer.
-    //
-    // IMPORTANT:
-    // We rely on `tobj`'s unified indexing (`single_index: true`) so positions/UVs/normals stay
-    // correctly associated even for OBJs that use separate v/vt/vn indices on faces.
-    let mut vertices: Vec<Vertex> = Vec::new();
-    let mut indices: Vec<u32> = Vec::new();
-
-    for model in models.iter() {
-        let mesh = &model.mesh;
-
-        // `tobj` mesh data is flat arrays.
-        if mesh.positions.len() % 3 != 0 {
-            return 0;
-        }
-        if !mesh.texcoords.is_empty() && mesh.texcoords.len() % 2 != 0 {
-            return 0;
-        }
-        if !mesh.normals.is_empty() && mesh.normals.len() % 3 != 0 {
-            return 0;
-        }
-
-        // With `single_index: true`, `tobj` has already unified the attribute indices:
-        // - `mesh.positions` / `mesh.texcoords` / `mesh.normals` have matching vertex order
-        // - `mesh.indices` references that unified vertex stream
-        if mesh.indices.is_empty() {
-            continue;
-        }
-
-        let base_vertex = vertices.len() as u32;
-        let vertex_count = mesh.positions.len() / 3;
-
-        for i in 0..vertex_count {
-            let px = mesh.positions[i * 3 + 0];
-            let py = mesh.positions[i * 3 + 1];
-            let pz = mesh.positions[i * 3 + 2];
-
-            let (u, v) = if mesh.texcoords.len() >= (i * 2 + 2) {
-                (mesh.texcoords[i * 2 + 0], 1.0 - mesh.texcoords[i * 2 + 1])
-            } else {
-                (0.0, 0.0)
-            };
-
-            let (nx, ny, nz) = if mesh.normals.len() >= (i * 3 + 3) {
-                (
-                    mesh.normals[i * 3 + 0],
-                    mesh.normals[i * 3 + 1],
-                    mesh.normals[i * 3 + 2],
-                )
-            } else {
-                (0.0, 0.0, 1.0)
-            };
-
-            vertices.push(Vertex {
-                position: [px, py, pz],
-                uv: [u, v],
-                normal: [nx, ny, nz],
-            });
-        }
+    let stl_bytes = match read_guest_bytes(env, ptr, len) {
+        Ok(b) => b,
+        Err(_) => return 0,
+    };
 
-        for &idx in mesh.indices.iter() {
-            indices.push(base_vertex + (idx as u32));
-        }
-    }
+    let Some((vertices, indices)) = stl_to_mesh(&stl_bytes) else {
+        return 0;
+    };
+    store_mesh(key, &vertices, &indices, "graphics_mesh_create_stl")
+}
 
-    if vertices.is_empty() || indices.is_empty() {
+/// Create a mesh from a pre-baked blob (see `mesh_data`).
+///
+/// The vertex and index arrays are uploaded straight from guest memory and the bounds come from
+/// the header, so no per-vertex work happens at load. Returns 1 on success, 0 if GL is missing or
+/// the blob is invalid.
+pub fn graphics_mesh_create_blob(
+    env: &mut wasmtime::Caller<'_, ()>,
+    key: u64,
+    ptr: u32,
+    len: u32,
+) -> u32 {
+    if GL_STATE.get().is_none() {
         return 0;
     }
+    let memory = match env.get_export("memory") {
+        Some(wasmtime::Extern::Memory(m)) => m,
+        _ => return 0,
+    };
+    let data = memory.data(&*env);
+    let Some(bytes) = (ptr as usize)
+        .checked_add(len as usize)
+        .and_then(|end| data.get(ptr as usize..end))
+    else {
+        return 0;
+    };
+    let Some(blob) = parse_blob(bytes) else {
+        return 0;
+    };
 
-    // Create GL buffers (same path as `graphics_mesh_create`, but we already own the vectors).
-    let mut vao = 0;
-    let mut vbo = 0;
-    let mut ebo = 0;
-
-    unsafe {
-        gl::GenVertexArrays(1, &mut vao);
-        gl::GenBuffers(1, &mut vbo);
-        gl::GenBuffers(1, &mut ebo);
-
-        gl::BindVertexArray(vao);
-
-        gl::BindBuffer(gl::ARRAY_BUFFER, vbo);
-        gl::BufferData(
-            gl::ARRAY_BUFFER,
-            (vertices.len() * std::mem::size_of::<Vertex>()) as isize,
-            vertices.as_ptr() as *const c_void,
-            gl::STATIC_DRAW,
-        );
-
-        gl::BindBuffer(gl::ELEMENT_ARRAY_BUFFER, ebo);
-        gl::BufferData(
-            gl::ELEMENT_ARRAY_BUFFER,
-            (indices.len() * 4) as isize,
-            indices.as_ptr() as *const c_void,
-            gl::STATIC_DRAW,
-        );
-
-        // Vertex attributes
-        // 0: Position (3 floats)
-        gl::VertexAttribPointer(
-            0,
-            3,
-            gl::FLOAT,
-            gl::FALSE,
-            std::mem::size_of::<Vertex>() as i32,
-            0 as *const c_void,
-        );
-        gl::EnableVertexAttribArray(0);
-
-        // 1: UV (2 floats)
-        gl::VertexAttribPointer(
-            1,
-            2,
-            gl::FLOAT,
-            gl::FALSE,
-            std::mem::size_of::<Vertex>() as i32,
-            12 as *const c_void,
-        );
-        gl::EnableVertexAttribArray(1);
-
-        // 2: Normal (3 floats)
-        gl::VertexAttribPointer(
-            2,
-            3,
-            gl::FLOAT,
-            gl::FALSE,
-            std::mem::size_of::<Vertex>() as i32,
-            20 as *const c_void,
-        );
-        gl::EnableVertexAttribArray(2);
+    let index_type = if blob.u16_indices {
+        gl::UNSIGNED_SHORT
+    } else {
+        gl::UNSIGNED_INT
+    };
+    let mesh = upload_mesh(
+        &VertexFormat::float(),
+        blob.vertices,
+        blob.indices,
+        blob.index_count,
+        index_type,
+        blob.bounds,
+        "graphics_mesh_create_blob",
+    );
+    MESH_STORE.lock().unwrap().insert(key, mesh);
+    1
+}
 
-        gl::BindVertexArray(0);
+/// Create a mesh from vertices in a compact format (`abi::mesh::POSITION_*`, `UV_*`, `NORMAL_*`)
+/// and `u16` or `u32` indices (`abi::mesh::INDEX_*`).
+///
+/// Both arrays are uploaded straight from guest memory; the GL attribute types match the format,
+/// so nothing is expanded to `f32` on the CPU. Returns 1 on success, 0 if GL is missing, the
+/// format is unknown, an array is out of bounds or an index points past the vertices.
+pub fn graphics_mesh_create_ex(
+    env: &mut wasmtime::Caller<'_, ()>,
+    key: u64,
+    format: u32,
+    v_ptr: u32,
+    v_len: u32,
+    i_ptr: u32,
+    i_len: u32,
+    index_type: u32,
+) -> u32 {
+    if GL_STATE.get().is_none() || v_len == 0 || i_len == 0 {
+        return 0;
+    }
+    let Some(format) = VertexFormat::from_bits(format) else {
+        return 0;
+    };
+    let (gl_index_type, index_size) = match index_type {
+        INDEX_U16 => (gl::UNSIGNED_SHORT, 2),
+        INDEX_U32 => (gl::UNSIGNED_INT, 4),
+        _ => return 0,
+    };
+    let memory = match env.get_export("memory") {
+        Some(wasmtime::Extern::Memory(m)) => m,
+        _ => return 0,
+    };
+    let data = memory.data(&*env);
+    let slice = |ptr: u32, count: u32, size: usize| {
+        let start = ptr as usize;
+        (count as usize)
+            .checked_mul(size)
+            .and_then(|len| start.checked_add(len))
+            .and_then(|end| data.get(start..end))
+    };
+    let (Some(vertices), Some(indices)) = (
+        slice(v_ptr, v_len, format.stride),
+        slice(i_ptr, i_len, index_size),
+    ) else {
+        return 0;
+    };
 
-        check_gl_error("graphics_mesh_create_obj");
+    let in_range = if index_size == 2 {
+        indices
+            .chunks_exact(2)
+            .all(|i| (u16::from_le_bytes([i[0], i[1]]) as u32) < v_len)
+    } else {
+        indices
+            .chunks_exact(4)
+            .all(|i| u32::from_le_bytes([i[0], i[1], i[2], i[3]]) < v_len)
+    };
+    if !in_range {
+        return 0;
     }
 
-    let mut store = MESH_STORE.lock().unwrap();
-    store.insert(
-        key,
-        Mesh {
-            vao,
-            vbo,
-            ebo,
-            index_count: indices.len() as i32,
-            texture_key: None,
-        },
+    let mesh = upload_mesh(
+        &format,
+        vertices,
+        indices,
+        i_len,
+        gl_index_type,
+        format.bounds(vertices),
+        "graphics_mesh_create_ex",
     );
-
+    MESH_STORE.lock().unwrap().insert(key, mesh);
     1
 }
 
-pub fn graphics_mesh_create_stl(
-    _env: &mut wasmtime::Caller<'_, ()>,
-    _key: u64,
-    _ptr: u32,
-    _len: u32,
-) -> u32 {
-    0
-}
-
 /// Bind a keyed image texture to an existing mesh.
 ///
 /// This only stores the association (`mesh_key -> image_key`) inside the mesh store.
@@ -726,6 +869,136 @@ pub fn graphics_mesh_set_texture(mesh_key: u64, image_key: u64) -> u32 {
     1
 }
 
+/// Build the model matrix for one packed TRS transform
+/// (`x, y, z, rx, ry, rz, sx, sy, sz`; rotations in radians, applied X, then Y, then Z).
+fn model_matrix(t: &[f32; 9]) -> Mat4 {
+    Mat4::from_translation(Vec3::new(t[0], t[1], t[2]))
+        * Mat4::from_rotation_z(t[5])
+        * Mat4::from_rotation_y(t[4])
+        * Mat4::from_rotation_x(t[3])
+        * Mat4::from_scale(Vec3::new(t[6], t[7], t[8]))
+}
+
+/// The current 2D draw color (`VideoState::draw_color`) as the 3D shader's `color` uniform.
+fn draw_color_rgb() -> (f32, f32, f32) {
+    let color_u32 = global().lock().unwrap().video.draw_color;
+    (
+        ((color_u32 >> 16) & 0xFF) as f32 / 255.0,
+        ((color_u32 >> 8) & 0xFF) as f32 / 255.0,
+        (color_u32 & 0xFF) as f32 / 255.0,
+    )
+}
+
+/// Upload the keyed image bound to `mesh` into a temporary texture on unit 0.
+///
+/// Texture binding:
+/// - PNG is treated as RGBA (alpha respected)
+/// - JPEG is treated as RGB but stored/uploaded as RGBA with A=255
+///
+/// Returns the texture id, or `0` if the mesh has no texture or its image is not registered.
+/// The caller deletes the texture after drawing.
+fn upload_mesh_texture(mesh: &Mesh) -> u32 {
+    let Some(img_key) = mesh.texture_key else {
+        return 0;
+    };
+    let img = {
+        let res = match RESOURCES.lock() {
+            Ok(r) => r,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        res.keyed_images.get(&img_key).cloned()
+    };
+    let Some(img) = img else {
+        return 0;
+    };
+
+    let mut texture_id = 0u32;
+    unsafe {
+        gl::GenTextures(1, &mut texture_id);
+        gl::BindTexture(gl::TEXTURE_2D, texture_id);
+
+        // Avoid shimmering/aliasing artifacts on textured 3D meshes:
+        // - Use mipmaps for minification
+        // - Use linear filtering for magnification
+        gl::TexParameteri(
+            gl::TEXTURE_2D,
+            gl::TEXTURE_MIN_FILTER,
+            gl::LINEAR_MIPMAP_LINEAR as i32,
+        );
+        gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR as i32);
+
+        // Avoid wrap edge artifacts on UV seams.
+        gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_WRAP_S, gl::REPEAT as i32);
+        gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_WRAP_T, gl::REPEAT as i32);
+
+        // Ensure tightly packed RGBA upload.
+        gl::PixelStorei(gl::UNPACK_ALIGNMENT, 1);
+
+        gl::TexImage2D(
+            gl::TEXTURE_2D,
+            0,
+            gl::RGBA8 as i32,
+            img.width as i32,
+            img.height as i32,
+            0,
+            gl::RGBA,
+            gl::UNSIGNED_BYTE,
+            img.rgba.as_ptr() as *const c_void,
+        );
+
+        // Generate mipmaps after uploading the base level.
+        gl::GenerateMipmap(gl::TEXTURE_2D);
+
+        // Improve minification quality when the driver supports anisotropic filtering.
+        // If the extension isn't present, this is a no-op.
+        //
+        // Note: We query via GetStringi to avoid relying on extension loader helpers.
+        let mut has_aniso = false;
+        let mut ext_count: i32 = 0;
+        gl::GetIntegerv(gl::NUM_EXTENSIONS, &mut ext_count);
+        let needle = b"GL_EXT_texture_filter_anisotropic";
+        let mut i: i32 = 0;
+        while i < ext_count {
+            let ext = gl::GetStringi(gl::EXTENSIONS, i as u32);
+            if !ext.is_null() {
+                // SAFETY: OpenGL guarantees NUL-terminated strings for extension names.
+                let s = std::ffi::CStr::from_ptr(ext as *const _).to_bytes();
+                if s == needle {
+                    has_aniso = true;
+                    break;
+                }
+            }
+            i += 1;
+        }
+        if has_aniso {
+            // These constants are from GL_EXT_texture_filter_anisotropic.
+            const TEXTURE_MAX_ANISOTROPY_EXT: u32 = 0x84FE;
+            const MAX_TEXTURE_MAX_ANISOTROPY_EXT: u32 = 0x84FF;
+
+            let mut max_aniso: f32 = 1.0;
+            gl::GetFloatv(MAX_TEXTURE_MAX_ANISOTROPY_EXT, &mut max_aniso);
+            // A reasonable cap; drivers may support very high values.
+            let aniso = if max_aniso > 8.0 { 8.0 } else { max_aniso };
+            gl::TexParameterf(gl::TEXTURE_2D, TEXTURE_MAX_ANISOTROPY_EXT, aniso);
+        }
+
+        gl::ActiveTexture(gl::TEXTURE0);
+        gl::BindTexture(gl::TEXTURE_2D, texture_id);
+    }
+    texture_id
+}
+
+/// Delete a texture returned by `upload_mesh_texture`.
+fn delete_mesh_texture(texture_id: u32) {
+    if texture_id != 0 {
+        unsafe {
+            // Ensure it is not bound when we delete it.
+            gl::BindTexture(gl::TEXTURE_2D, 0);
+            gl::DeleteTextures(1, &texture_id);
+        }
+    }
+}
+
 pub fn graphics_mesh_draw(
     key: u64,
     x: f32,
@@ -756,13 +1029,15 @@ pub fn graphics_mesh_draw(
     };
 
     // Calculate matrices
-    let model = Mat4::from_translation(Vec3::new(x, y, z))
-        * Mat4::from_rotation_z(rz)
-        * Mat4::from_rotation_y(ry)
-        * Mat4::from_rotation_x(rx)
-        * Mat4::from_scale(Vec3::new(sx, sy, sz));
+    let model = model_matrix(&[x, y, z, rx, ry, rz, sx, sy, sz]);
+    let view_proj = state_3d.projection * state_3d.view;
+    if !Frustum::from_view_proj(&view_proj).intersects(&mesh.bounds.transformed(&model)) {
+        MESHES_CULLED.fetch_add(1, Ordering::Relaxed);
+        return;
+    }
+    MESHES_SUBMITTED.fetch_add(1, Ordering::Relaxed);
 
-    let mvp = state_3d.projection * state_3d.view * model;
+    let mvp = view_proj * model;
     let normal_mat = model.inverse().transpose();
 
     unsafe {
@@ -782,137 +1057,206 @@ pub fn graphics_mesh_draw(
             normal_mat.to_cols_array().as_ptr(),
         );
 
-        // Get color from global state or use default
-        // Previous implementation used a uniform color.
-        // We'll use white for now or get it from `VideoState`?
-        // `VideoState` has `draw_color`.
-        let color_u32 = global().lock().unwrap().video.draw_color;
-        let r = ((color_u32 >> 16) & 0xFF) as f32 / 255.0;
-        let g = ((color_u32 >> 8) & 0xFF) as f32 / 255.0;
-        let b = (color_u32 & 0xFF) as f32 / 255.0;
+        let (r, g, b) = draw_color_rgb();
         gl::Uniform3f(gl_state.uniform_color, r, g, b);
 
-        // Texture binding:
-        // - PNG is treated as RGBA (alpha respected)
-        // - JPEG is treated as RGB but stored/uploaded as RGBA with A=255
-        //
-        // Keyed textures are uploaded lazily on demand from `RESOURCES.keyed_images`.
-        let mut use_tex = 0i32;
-        let mut texture_id = 0u32;
-        let mut delete_texture_after_draw = false;
-
-        if let Some(img_key) = mesh.texture_key {
-            let img = {
-                let res = match RESOURCES.lock() {
-                    Ok(r) => r,
-                    Err(poisoned) => poisoned.into_inner(),
-                };
-                res.keyed_images.get(&img_key).cloned()
-            };
-
-            if let Some(img) = img {
-                gl::GenTextures(1, &mut texture_id);
-                gl::BindTexture(gl::TEXTURE_2D, texture_id);
-
-                // Avoid shimmering/aliasing artifacts on textured 3D meshes:
-                // - Use mipmaps for minification
-                // - Use linear filtering for magnification
-                gl::TexParameteri(
-                    gl::TEXTURE_2D,
-                    gl::TEXTURE_MIN_FILTER,
-                    gl::LINEAR_MIPMAP_LINEAR as i32,
-                );
-                gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_MAG_FILTER, gl::LINEAR as i32);
-
-                // Avoid wrap edge artifacts on UV seams.
-                gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_WRAP_S, gl::REPEAT as i32);
-                gl::TexParameteri(gl::TEXTURE_2D, gl::TEXTURE_WRAP_T, gl::REPEAT as i32);
-
-                // Ensure tightly packed RGBA upload.
-                gl::PixelStorei(gl::UNPACK_ALIGNMENT, 1);
-
-                gl::TexImage2D(
-                    gl::TEXTURE_2D,
-                    0,
-                    gl::RGBA8 as i32,
-                    img.width as i32,
-                    img.height as i32,
-                    0,
-                    gl::RGBA,
-                    gl::UNSIGNED_BYTE,
-                    img.rgba.as_ptr() as *const c_void,
-                );
-
-                // Generate mipmaps after uploading the base level.
-                gl::GenerateMipmap(gl::TEXTURE_2D);
-
-                // Improve minification quality when the driver supports anisotropic filtering.
-                // If the extension isn't present, this is a no-op.
-                //
-                // Note: We query via GetStringi to avoid relying on extension loader helpers.
-                let mut has_aniso = false;
-                let mut ext_count: i32 = 0;
-                gl::GetIntegerv(gl::NUM_EXTENSIONS, &mut ext_count);
-                let needle = b"GL_EXT_texture_filter_anisotropic";
-                let mut i: i32 = 0;
-                while i < ext_count {
-                    let ext = gl::GetStringi(gl::EXTENSIONS, i as u32);
-                    if !ext.is_null() {
-                        // SAFETY: OpenGL guarantees NUL-terminated strings for extension names.
-                        let s = std::ffi::CStr::from_ptr(ext as *const _).to_bytes();
-                        if s == needle {
-                            has_aniso = true;
-                            break;
-                        }
-                    }
-                    i += 1;
-                }
-                if has_aniso {
-                    // These constants are from GL_EXT_texture_filter_anisotropic.
-                    const TEXTURE_MAX_ANISOTROPY_EXT: u32 = 0x84FE;
-                    const MAX_TEXTURE_MAX_ANISOTROPY_EXT: u32 = 0x84FF;
-
-                    let mut max_aniso: f32 = 1.0;
-                    gl::GetFloatv(MAX_TEXTURE_MAX_ANISOTROPY_EXT, &mut max_aniso);
-                    // A reasonable cap; drivers may support very high values.
-                    let aniso = if max_aniso > 8.0 { 8.0 } else { max_aniso };
-                    gl::TexParameterf(gl::TEXTURE_2D, TEXTURE_MAX_ANISOTROPY_EXT, aniso);
-                }
-
-                gl::ActiveTexture(gl::TEXTURE0);
-                gl::BindTexture(gl::TEXTURE_2D, texture_id);
-
-                use_tex = 1;
-                delete_texture_after_draw = true;
-            }
-        }
-
-        gl::Uniform1i(gl_state.uniform_use_tex, use_tex);
-        gl::Uniform1i(gl_state.uniform_tex3d, 0);
-
         // NOTE:
         // This uses per-draw texture creation (simple but not optimal). To avoid leaking GL texture
         // IDs, we delete the texture after the draw call. A follow-up should cache GL texture ids
         // per image key and delete them on unregister/context reset.
+        let texture_id = upload_mesh_texture(mesh);
+        gl::Uniform1i(gl_state.uniform_use_tex, (texture_id != 0) as i32);
+        gl::Uniform1i(gl_state.uniform_oct_normals, mesh.oct_normals as i32);
+        gl::Uniform1i(gl_state.uniform_tex3d, 0);
+
         gl::BindVertexArray(mesh.vao);
         gl::DrawElements(
             gl::TRIANGLES,
             mesh.index_count,
-            gl::UNSIGNED_INT,
+            mesh.index_type,
             std::ptr::null(),
         );
         gl::BindVertexArray(0);
 
-        if delete_texture_after_draw && texture_id != 0 {
-            // Ensure it is not bound when we delete it.
-            gl::BindTexture(gl::TEXTURE_2D, 0);
-            gl::DeleteTextures(1, &texture_id);
-        }
+        delete_mesh_texture(texture_id);
 
         check_gl_error("graphics_mesh_draw");
     }
 }
 
+/// Draw `count` instances of one mesh in a single `glDrawElementsInstanced` call.
+///
+/// `ptr` points at `count` packed TRS transforms in guest memory (`abi::mesh::INSTANCE_FLOATS`
+/// little-endian `f32`s each, the same order as `graphics_mesh_draw`'s arguments). The locks,
+/// program/uniform setup and texture upload happen once per call instead of once per copy; the
+/// per-instance model and normal matrices are streamed through `GlState::instance_vbo`.
+pub fn graphics_mesh_draw_instanced(
+    env: &mut wasmtime::Caller<'_, ()>,
+    key: u64,
+    ptr: u32,
+    count: u32,
+) {
+    if count == 0 {
+        return;
+    }
+    let memory = match env.get_export("memory") {
+        Some(wasmtime::Extern::Memory(m)) => m,
+        _ => return,
+    };
+    let data = memory.data(&*env);
+    let record = INSTANCE_FLOATS * 4;
+    let start = ptr as usize;
+    let Some(end) = (count as usize)
+        .checked_mul(record)
+        .and_then(|len| start.checked_add(len))
+    else {
+        return;
+    };
+    let Some(bytes) = data.get(start..end) else {
+        return;
+    };
+
+    let gl_state_lock = GL_STATE.get();
+    if gl_state_lock.is_none() {
+        return;
+    }
+    let mut gl_state = gl_state_lock.unwrap().lock().unwrap();
+
+    let state_3d = STATE_3D.lock().unwrap();
+    if !state_3d.enabled {
+        return;
+    }
+
+    let store = MESH_STORE.lock().unwrap();
+    let mesh = match store.get(&key) {
+        Some(m) => m,
+        None => return,
+    };
+
+    let view_proj = state_3d.projection * state_3d.view;
+    let frustum = Frustum::from_view_proj(&view_proj);
+
+    // Per-instance attributes: model matrix (16 floats), then the normal matrix's 3x3 (9 floats).
+    // Instances outside the frustum are dropped here.
+    let mut instances = std::mem::take(&mut gl_state.instance_scratch);
+    instances.clear();
+    instances.reserve(count as usize * INSTANCE_ATTRIB_FLOATS);
+    for rec in bytes.chunks_exact(record) {
+        let mut t = [0.0f32; INSTANCE_FLOATS];
+        for (v, b) in t.iter_mut().zip(rec.chunks_exact(4)) {
+            *v = f32::from_le_bytes([b[0], b[1], b[2], b[3]]);
+        }
+        let model = model_matrix(&t);
+        if !frustum.intersects(&mesh.bounds.transformed(&model)) {
+            continue;
+        }
+        instances.extend_from_slice(&model.to_cols_array());
+        instances.extend_from_slice(&Mat3::from_mat4(model).inverse().transpose().to_cols_array());
+    }
+    let visible = (instances.len() / INSTANCE_ATTRIB_FLOATS) as u32;
+    MESHES_CULLED.fetch_add(count - visible, Ordering::Relaxed);
+    MESHES_SUBMITTED.fetch_add(visible, Ordering::Relaxed);
+    if visible == 0 {
+        gl_state.instance_scratch = instances;
+        return;
+    }
+
+    let stride = (INSTANCE_ATTRIB_FLOATS * 4) as i32;
+
+    unsafe {
+        gl::BindFramebuffer(gl::FRAMEBUFFER, gl_state.output_fbo);
+        gl::UseProgram(gl_state.program_3d_instanced);
+
+        gl::UniformMatrix4fv(
+            gl_state.uniform_inst_view_proj,
+            1,
+            gl::FALSE,
+            view_proj.to_cols_array().as_ptr(),
+        );
+
+        let (r, g, b) = draw_color_rgb();
+        gl::Uniform3f(gl_state.uniform_inst_color, r, g, b);
+
+        let texture_id = upload_mesh_texture(mesh);
+        gl::Uniform1i(gl_state.uniform_inst_use_tex, (texture_id != 0) as i32);
+        gl::Uniform1i(gl_state.uniform_inst_oct_normals, mesh.oct_normals as i32);
+        gl::Uniform1i(gl_state.uniform_inst_tex, 0);
+
+        gl::BindVertexArray(mesh.vao);
+
+        // Orphan and refill the shared instance buffer, then point the per-instance attributes
+        // of this mesh's VAO at it.
+        gl::BindBuffer(gl::ARRAY_BUFFER, gl_state.instance_vbo);
+        gl::BufferData(
+            gl::ARRAY_BUFFER,
+            (instances.len() * 4) as isize,
+            instances.as_ptr() as *const c_void,
+            gl::STREAM_DRAW,
+        );
+        for col in 0..4u32 {
+            let loc = INSTANCE_MODEL_LOCATION + col;
+            gl::VertexAttribPointer(
+                loc,
+                4,
+                gl::FLOAT,
+                gl::FALSE,
+                stride,
+                (col as usize * 16) as *const c_void,
+            );
+            gl::EnableVertexAttribArray(loc);
+            gl::VertexAttribDivisor(loc, 1);
+        }
+        for col in 0..3u32 {
+            let loc = INSTANCE_NORMAL_LOCATION + col;
+            gl::VertexAttribPointer(
+                loc,
+                3,
+                gl::FLOAT,
+                gl::FALSE,
+                stride,
+                (64 + col as usize * 12) as *const c_void,
+            );
+            gl::EnableVertexAttribArray(loc);
+            gl::VertexAttribDivisor(loc, 1);
+        }
+
+        gl::DrawElementsInstanced(
+            gl::TRIANGLES,
+            mesh.index_count,
+            mesh.index_type,
+            std::ptr::null(),
+            visible as i32,
+        );
+
+        // Leave the VAO as `graphics_mesh_create` built it.
+        for loc in INSTANCE_MODEL_LOCATION..INSTANCE_NORMAL_LOCATION + 3 {
+            gl::DisableVertexAttribArray(loc);
+        }
+        gl::BindVertexArray(0);
+        gl::BindBuffer(gl::ARRAY_BUFFER, 0);
+
+        delete_mesh_texture(texture_id);
+
+        check_gl_error("graphics_mesh_draw_instanced");
+    }
+
+    gl_state.instance_scratch = instances;
+}
+
+/// Mesh draws `(submitted, culled)` since the start of the frame.
+pub fn mesh_stats() -> (u32, u32) {
+    (
+        MESHES_SUBMITTED.load(Ordering::Relaxed),
+        MESHES_CULLED.load(Ordering::Relaxed),
+    )
+}
+
+/// `wasm96_graphics_mesh_stats`: `submitted << 32 | culled` for the current frame.
+pub fn graphics_mesh_stats() -> u64 {
+    let (submitted, culled) = mesh_stats();
+    ((submitted as u64) << 32) | culled as u64
+}
+
 #[allow(dead_code)]
 pub fn clear_depth() {
     unsafe {
@@ -921,6 +1265,9 @@ pub fn clear_depth() {
 }
 
 pub fn prepare_frame(fbo: usize) {
+    MESHES_SUBMITTED.store(0, Ordering::Relaxed);
+    MESHES_CULLED.store(0, Ordering::Relaxed);
+
     let gl_state_lock = GL_STATE.get();
     if gl_state_lock.is_none() {
         return;
@@ -941,27 +1288,64 @@ pub fn prepare_frame(fbo: usize) {
     check_gl_error("prepare_frame");
 }
 
-pub fn flush_to_host() -> bool {
+pub fn flush_to_host(guest_memory: Option<&[u8]>) -> bool {
     let gl_state_lock = GL_STATE.get();
     if gl_state_lock.is_none() {
         return false;
     }
     let mut gl_state = gl_state_lock.unwrap().lock().unwrap();
 
-    let (width, height, fb, video_cb) = {
-        let s = global().lock().unwrap();
-        (
-            s.video.width,
-            s.video.height,
-            s.video.framebuffer.clone(),
-            s.video_refresh_cb,
-        )
-    };
+    // Primitives recorded since the last software barrier are drawn by the GPU 2D pass on top of
+    // the overlay rather than rasterized into it.
+    let gpu_frame = super::gpu2d::begin_frame(&mut global().lock().unwrap().video);
+
+    // Upload straight from the host framebuffer (no per-frame copy); see
+    // `graphics::with_presented_framebuffer`.
+    super::graphics::with_presented_framebuffer(guest_memory, |frame| {
+        let (width, height) = (frame.width, frame.height);
+        if width == 0 || height == 0 {
+            return;
+        }
 
-    if width == 0 || height == 0 {
-        return true;
+        unsafe {
+            gl::BindFramebuffer(gl::FRAMEBUFFER, gl_state.output_fbo);
+            // A pass that starts with a full clear hides the software layer this frame.
+            if !gpu_frame.as_ref().is_some_and(|f| f.covers_layer) {
+                upload_and_composite_overlay(&mut gl_state, &frame);
+            }
+
+            // 3. Recorded 2D primitives
+            if let Some(f) = &gpu_frame {
+                gl_state.gpu2d.draw(&f.ops, width, height);
+            }
+
+            // 4. Present
+            // In HW render mode, we call video_refresh with RETRO_HW_FRAME_BUFFER_VALID (-1 cast to ptr)
+            if let Some(cb) = frame.video_cb {
+                cb(
+                    libretro_sys::HW_FRAME_BUFFER_VALID as *const c_void,
+                    width,
+                    height,
+                    0, // Pitch is ignored for HW render
+                );
+            }
+
+            check_gl_error("flush_to_host");
+        }
+    });
+
+    if let Some(f) = gpu_frame {
+        super::gpu2d::end_frame(&mut global().lock().unwrap().video, f);
     }
+    true
+}
 
+/// Upload the damaged part of the software 2D layer and composite it over the 3D scene.
+fn upload_and_composite_overlay(
+    gl_state: &mut GlState,
+    frame: &super::graphics::PresentedFrame<'_>,
+) {
+    let (fb, width, height) = (frame.pixels, frame.width, frame.height);
     unsafe {
         // 1. Upload 2D framebuffer to texture
         gl::BindTexture(gl::TEXTURE_2D, gl_state.overlay_texture);
@@ -979,48 +1363,57 @@ pub fn flush_to_host() -> bool {
                 fb.as_ptr() as *const c_void,
             );
             gl_state.overlay_texture_size = (width, height);
-        } else {
+        } else if !frame.damage.is_empty() {
+            // Only the pixels drawn since the last frame changed; the rest of the texture
+            // already matches the framebuffer.
+            let d = frame.damage;
+            let offset = (d.y0 * width + d.x0) as usize;
+            gl::PixelStorei(gl::UNPACK_ROW_LENGTH, width as i32);
             gl::TexSubImage2D(
                 gl::TEXTURE_2D,
                 0,
-                0,
-                0,
-                width as i32,
-                height as i32,
+                d.x0 as i32,
+                d.y0 as i32,
+                d.width() as i32,
+                d.height() as i32,
                 gl::BGRA,
                 gl::UNSIGNED_BYTE,
-                fb.as_ptr() as *const c_void,
+                fb[offset..].as_ptr() as *const c_void,
             );
+            gl::PixelStorei(gl::UNPACK_ROW_LENGTH, 0);
         }
 
-        // 2. Draw Overlay
-        gl::BindFramebuffer(gl::FRAMEBUFFER, gl_state.output_fbo);
+        // 2. Draw Overlay, limited to the part of the 2D layer that is not transparent.
+        let bounds = frame.overlay_bounds;
+        if !bounds.is_empty() {
+            // Framebuffer row 0 is the top of the screen; GL window coordinates start at the
+            // bottom.
+            gl::Enable(gl::SCISSOR_TEST);
+            gl::Scissor(
+                bounds.x0 as i32,
+                (height - bounds.y1) as i32,
+                bounds.width() as i32,
+                bounds.height() as i32,
+            );
 
-        // Enable blending for transparency
-        gl::Enable(gl::BLEND);
-        gl::BlendFunc(gl::SRC_ALPHA, gl::ONE_MINUS_SRC_ALPHA);
+            // The 2D layer holds premultiplied ARGB (see `raster`).
+            gl::Enable(gl::BLEND);
+            gl::BlendFunc(gl::ONE, gl::ONE_MINUS_SRC_ALPHA);
 
-        gl::UseProgram(gl_state.program_overlay);
-        gl::BindVertexArray(gl_state.overlay_vao);
-        gl::DrawArrays(gl::TRIANGLE_STRIP, 0, 4);
+            gl::UseProgram(gl_state.program_overlay);
+            gl::BindVertexArray(gl_state.overlay_vao);
+            gl::DrawArrays(gl::TRIANGLE_STRIP, 0, 4);
 
-        gl::Disable(gl::BLEND);
-        gl::BindVertexArray(0);
-
-        // 3. Present
-        // In HW render mode, we call video_refresh with RETRO_HW_FRAME_BUFFER_VALID (-1 cast to ptr)
-        if let Some(cb) = video_cb {
-            cb(
-                libretro_sys::HW_FRAME_BUFFER_VALID as *const c_void,
-                width,
-                height,
-                0, // Pitch is ignored for HW render
-            );
+            gl::Disable(gl::BLEND);
+            gl::Disable(gl::SCISSOR_TEST);
+            gl::BindVertexArray(0);
         }
-
-        check_gl_error("flush_to_host");
     }
-    true
+}
+
+/// Whether a GL context exists (3D scene plus 2D overlay compositing).
+pub fn gl_available() -> bool {
+    GL_STATE.get().is_some()
 }
 
 // Helper to clear the screen at the start of the frame (if needed)
@@ -0,0 +1,133 @@
+//! Byte-budgeted LRU cache shared by the host-side raster caches (glyphs, text runs, SVG pixmaps).
+//!
+//! Each entry carries a caller-supplied cost in bytes. When an insert would push the total over the
+//! budget, least recently used entries are evicted down to 3/4 of the budget, so a steady stream of
+//! new entries does not trigger an eviction pass on every insert.
+
+use std::collections::HashMap;
+use std::hash::Hash;
+
+struct Entry<V> {
+    value: V,
+    cost: usize,
+    last_used: u64,
+}
+
+pub struct LruCache<K, V> {
+    entries: HashMap<K, Entry<V>>,
+    budget_bytes: usize,
+    used_bytes: usize,
+    clock: u64,
+}
+
+impl<K: Copy + Eq + Hash, V> LruCache<K, V> {
+    pub fn with_budget(budget_bytes: usize) -> Self {
+        Self {
+            entries: HashMap::new(),
+            budget_bytes,
+            used_bytes: 0,
+            clock: 0,
+        }
+    }
+
+    /// Look up an entry and mark it as most recently used.
+    pub fn get(&mut self, key: &K) -> Option<&V> {
+        self.clock += 1;
+        let now = self.clock;
+        self.entries.get_mut(key).map(|e| {
+            e.last_used = now;
+            &e.value
+        })
+    }
+
+    /// Look up an entry, creating it with `make` (which returns the value and its cost) on a miss.
+    pub fn get_or_insert_with(&mut self, key: K, make: impl FnOnce() -> (V, usize)) -> &V {
+        if !self.entries.contains_key(&key) {
+            let (value, cost) = make();
+            self.insert(key, value, cost);
+        }
+        self.get(&key).expect("entry inserted above")
+    }
+
+    /// Insert (or replace) an entry, evicting older entries if needed to stay within budget.
+    pub fn insert(&mut self, key: K, value: V, cost: usize) {
+        self.remove(&key);
+        if self.used_bytes + cost > self.budget_bytes {
+            self.evict_to(self.budget_bytes.saturating_sub(cost) * 3 / 4);
+        }
+        self.clock += 1;
+        self.used_bytes += cost;
+        self.entries.insert(
+            key,
+            Entry {
+                value,
+                cost,
+                last_used: self.clock,
+            },
+        );
+    }
+
+    pub fn contains_key(&self, key: &K) -> bool {
+        self.entries.contains_key(key)
+    }
+
+    pub fn remove(&mut self, key: &K) -> Option<V> {
+        let e = self.entries.remove(key)?;
+        self.used_bytes -= e.cost;
+        Some(e.value)
+    }
+
+    /// Keep only the entries whose key satisfies `keep`.
+    pub fn retain(&mut self, mut keep: impl FnMut(&K) -> bool) {
+        let mut freed = 0;
+        self.entries.retain(|k, e| {
+            let kept = keep(k);
+            if !kept {
+                freed += e.cost;
+            }
+            kept
+        });
+        self.used_bytes -= freed;
+    }
+
+    /// Change the byte budget, evicting immediately if the cache is now over it.
+    pub fn set_budget(&mut self, budget_bytes: usize) {
+        self.budget_bytes = budget_bytes;
+        if self.used_bytes > budget_bytes {
+            self.evict_to(budget_bytes);
+        }
+    }
+
+    pub fn budget_bytes(&self) -> usize {
+        self.budget_bytes
+    }
+
+    pub fn used_bytes(&self) -> usize {
+        self.used_bytes
+    }
+
+    pub fn len(&self) -> usize {
+        self.entries.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Evict least recently used entries until at most `target_bytes` are in use.
+    fn evict_to(&mut self, target_bytes: usize) {
+        let mut by_age: Vec<(u64, K)> = self
+            .entries
+            .iter()
+            .map(|(k, e)| (e.last_used, *k))
+            .collect();
+        by_age.sort_unstable_by_key(|(t, _)| *t);
+
+        for (_, key) in by_age {
+            if self.used_bytes <= target_bytes {
+                break;
+            }
+            self.remove(&key);
+        }
+    }
+}
@@ -0,0 +1,426 @@
+//! CPU-side mesh data: OBJ/STL import, the pre-baked binary mesh blob, and the compact vertex
+//! formats accepted by `graphics_mesh_create_ex`.
+//!
+//! Parsing a multi-megabyte text OBJ on every boot dominates the startup of 3D carts. The blob
+//! format (layout in `abi::mesh`) stores the vertex array already in the `Vertex` layout, the
+//! index array, and the bounding sphere, so `graphics_mesh_create_blob` can hand the guest's bytes
+//! straight to `glBufferData` without converting anything. The `wasm96-mesh-bake` binary uses
+//! `obj_to_mesh` / `stl_to_mesh` + `encode_blob` to produce blobs offline.
+//!
+//! Blob fields are little-endian, and the vertex bytes are uploaded as-is, which matches every
+//! target the core is built for.
+
+use std::io::Cursor;
+use std::path::Path;
+
+use glam::Vec3;
+
+use crate::abi::mesh::{
+    BLOB_FLAG_U16_INDICES, BLOB_HEADER_SIZE, BLOB_MAGIC, BLOB_VERSION, BLOB_VERTEX_SIZE,
+    NORMAL_F32, NORMAL_MASK, NORMAL_OCT16, POSITION_F16, POSITION_F32, POSITION_MASK,
+    POSITION_SNORM16, UV_F32, UV_MASK, UV_NONE, UV_UNORM16,
+};
+
+use super::graphics3d::{Bounds, Vertex};
+
+/// A validated view into a mesh blob.
+pub struct MeshBlob<'a> {
+    /// `vertex_count` records in the `Vertex` layout.
+    pub vertices: &'a [u8],
+    /// `index_count` `u16`s or `u32`s (see `u16_indices`).
+    pub indices: &'a [u8],
+    pub vertex_count: u32,
+    pub index_count: u32,
+    pub u16_indices: bool,
+    pub bounds: Bounds,
+}
+
+fn u16_at(b: &[u8], o: usize) -> u16 {
+    u16::from_le_bytes([b[o], b[o + 1]])
+}
+
+fn u32_at(b: &[u8], o: usize) -> u32 {
+    u32::from_le_bytes([b[o], b[o + 1], b[o + 2], b[o + 3]])
+}
+
+fn f32_at(b: &[u8], o: usize) -> f32 {
+    f32::from_bits(u32_at(b, o))
+}
+
+/// Validate a blob and split it into its arrays.
+///
+/// Returns `None` for a bad magic/version, a size that does not match the header exactly, or an
+/// index that points past the vertex array (GL would read out of bounds).
+pub fn parse_blob(bytes: &[u8]) -> Option<MeshBlob<'_>> {
+    if bytes.len() < BLOB_HEADER_SIZE || bytes[0..4] != BLOB_MAGIC {
+        return None;
+    }
+    if u16_at(bytes, 4) != BLOB_VERSION {
+        return None;
+    }
+    let u16_indices = u16_at(bytes, 6) & BLOB_FLAG_U16_INDICES != 0;
+    let vertex_count = u32_at(bytes, 8);
+    let index_count = u32_at(bytes, 12);
+    if vertex_count == 0 || index_count == 0 {
+        return None;
+    }
+
+    let index_size = if u16_indices { 2 } else { 4 };
+    let vertex_bytes = (vertex_count as usize).checked_mul(BLOB_VERTEX_SIZE)?;
+    let index_bytes = (index_count as usize).checked_mul(index_size)?;
+    let indices_at = BLOB_HEADER_SIZE.checked_add(vertex_bytes)?;
+    if indices_at.checked_add(index_bytes)? != bytes.len() {
+        return None;
+    }
+
+    let indices = &bytes[indices_at..];
+    let in_range = if u16_indices {
+        indices
+            .chunks_exact(2)
+            .all(|i| (u16::from_le_bytes([i[0], i[1]]) as u32) < vertex_count)
+    } else {
+        indices
+            .chunks_exact(4)
+            .all(|i| u32::from_le_bytes([i[0], i[1], i[2], i[3]]) < vertex_count)
+    };
+    if !in_range {
+        return None;
+    }
+
+    Some(MeshBlob {
+        vertices: &bytes[BLOB_HEADER_SIZE..indices_at],
+        indices,
+        vertex_count,
+        index_count,
+        u16_indices,
+        bounds: Bounds {
+            center: Vec3::new(f32_at(bytes, 16), f32_at(bytes, 20), f32_at(bytes, 24)),
+            radius: f32_at(bytes, 28),
+        },
+    })
+}
+
+/// Serialize a mesh as a blob. Indices are stored as `u16` when every vertex fits.
+pub fn encode_blob(vertices: &[Vertex], indices: &[u32]) -> Vec<u8> {
+    let u16_indices = vertices.len() <= u16::MAX as usize + 1;
+    let bounds = Bounds::from_vertices(vertices);
+    let index_size = if u16_indices { 2 } else { 4 };
+
+    let mut out = Vec::with_capacity(
+        BLOB_HEADER_SIZE + vertices.len() * BLOB_VERTEX_SIZE + indices.len() * index_size,
+    );
+    out.extend_from_slice(&BLOB_MAGIC);
+    out.extend_from_slice(&BLOB_VERSION.to_le_bytes());
+    let flags = if u16_indices {
+        BLOB_FLAG_U16_INDICES
+    } else {
+        0
+    };
+    out.extend_from_slice(&flags.to_le_bytes());
+    out.extend_from_slice(&(vertices.len() as u32).to_le_bytes());
+    out.extend_from_slice(&(indices.len() as u32).to_le_bytes());
+    for f in [
+        bounds.center.x,
+        bounds.center.y,
+        bounds.center.z,
+        bounds.radius,
+    ] {
+        out.extend_from_slice(&f.to_le_bytes());
+    }
+    for v in vertices {
+        for f in v.position.iter().chain(&v.uv).chain(&v.normal) {
+            out.extend_from_slice(&f.to_le_bytes());
+        }
+    }
+    for &i in indices {
+        if u16_indices {
+            out.extend_from_slice(&(i as u16).to_le_bytes());
+        } else {
+            out.extend_from_slice(&i.to_le_bytes());
+        }
+    }
+    out
+}
+
+/// Parse OBJ text into one vertex/index stream (all models concatenated).
+///
+/// Returns `None` if the OBJ does not parse or contains no triangles.
+pub fn obj_to_mesh(obj_bytes: &[u8]) -> Option<(Vec<Vertex>, Vec<u32>)> {
+    // Parse OBJ using `tobj` (more robust, supports MTL).
+    //
+    // We load from an in-memory buffer and provide a material loader closure. Since this core
+    // currently receives only OBJ bytes (no filesystem), we provide a "no materials" loader.
+    // This still correctly loads geometry and supports models that either don't reference MTL,
+    // or where materials are optional.
+    //
+    // Follow-up: we can extend the ABI to allow the guest to provide MTL bytes and texture bytes
+    // so `material_loader` can parse MTL and we can register textures automatically.
+    let mut reader = Cursor::new(obj_bytes);
+
+    let (models, _materials) = tobj::load_obj_buf(
+        &mut reader,
+        &tobj::LoadOptions {
+            // Use tobj's standard behavior as much as possible:
+            // - triangulate for our renderer
+            // - single_index so tobj unifies position/uv/normal into one index stream
+            triangulate: true,
+            single_index: true,
+            ..Default::default()
+        },
+        |_p: &Path| -> tobj::MTLLoadResult {
+            // No filesystem access / no provided MTL bytes in this call.
+            // Return an empty material list (Ok) so model loading proceeds.
+            Ok((Vec::new(), ahash::AHashMap::new()))
+        },
+    )
+    .ok()?;
+
+    if models.is_empty() {
+        return None;
+    }
+
+    // TEMP DEBUG (remove when done):
+    // Dump tobj-produced stream sizes to compare against expected unified tuple counts.
+    // For the included duck OBJs, expected unified vertex counts (from offline analysis):
+    // - 12248_Bird_v1_L2.obj: 9582
+    // - 12249_Bird_v1_L2.obj: 9760
+    eprintln!("wasm96: OBJ load OK models={}", models.len());
+    for (mi, model) in models.iter().enumerate() {
+        let m = &model.mesh;
+        eprintln!(
+            "wasm96: OBJ model[{mi}] pos={} uv={} n={} idx={} (single_index=true triangulate=true)",
+            m.positions.len() / 3,
+            m.texcoords.len() / 2,
+            m.normals.len() / 3,
+            m.indices.len(),
+        );
+    }
+
+    // Convert to wasm96-core's `Vertex` and u32 indices by concatenating all models into one mesh.
+    // This preserves a single VAO/VBO/EBO per `key` as expected by the current renderer.
+    //
+    // IMPORTANT:
+    // We rely on `tobj`'s unified indexing (`single_index: true`) so positions/UVs/normals stay
+    // correctly associated even for OBJs that use separate v/vt/vn indices on faces.
+    let mut vertices: Vec<Vertex> = Vec::new();
+    let mut indices: Vec<u32> = Vec::new();
+
+    for model in models.iter() {
+        let mesh = &model.mesh;
+
+        // `tobj` mesh data is flat arrays.
+        if mesh.positions.len() % 3 != 0 {
+            return None;
+        }
+        if !mesh.texcoords.is_empty() && mesh.texcoords.len() % 2 != 0 {
+            return None;
+        }
+        if !mesh.normals.is_empty() && mesh.normals.len() % 3 != 0 {
+            return None;
+        }
+
+        // With `single_index: true`, `tobj` has already unified the attribute indices:
+        // - `mesh.positions` / `mesh.texcoords` / `mesh.normals` have matching vertex order
+        // - `mesh.indices` references that unified vertex stream
+        if mesh.indices.is_empty() {
+            continue;
+        }
+
+        let base_vertex = vertices.len() as u32;
+        let vertex_count = mesh.positions.len() / 3;
+
+        for i in 0..vertex_count {
+            let px = mesh.positions[i * 3 + 0];
+            let py = mesh.positions[i * 3 + 1];
+            let pz = mesh.positions[i * 3 + 2];
+
+            let (u, v) = if mesh.texcoords.len() >= (i * 2 + 2) {
+                (mesh.texcoords[i * 2 + 0], 1.0 - mesh.texcoords[i * 2 + 1])
+            } else {
+                (0.0, 0.0)
+            };
+
+            let (nx, ny, nz) = if mesh.normals.len() >= (i * 3 + 3) {
+                (
+                    mesh.normals[i * 3 + 0],
+                    mesh.normals[i * 3 + 1],
+                    mesh.normals[i * 3 + 2],
+                )
+            } else {
+                (0.0, 0.0, 1.0)
+            };
+
+            vertices.push(Vertex {
+                position: [px, py, pz],
+                uv: [u, v],
+                normal: [nx, ny, nz],
+            });
+        }
+
+        for &idx in mesh.indices.iter() {
+            indices.push(base_vertex + (idx as u32));
+        }
+    }
+
+    if vertices.is_empty() || indices.is_empty() {
+        return None;
+    }
+    Some((vertices, indices))
+}
+
+/// Parse binary or ASCII STL into a flat-shaded vertex/index stream (three vertices per facet,
+/// all carrying the facet normal; UVs are zero since STL has none).
+pub fn stl_to_mesh(stl_bytes: &[u8]) -> Option<(Vec<Vertex>, Vec<u32>)> {
+    let mesh = nom_stl::parse_stl(&mut Cursor::new(stl_bytes)).ok()?;
+    let triangles = mesh.triangles();
+    if triangles.is_empty() {
+        return None;
+    }
+
+    let mut vertices = Vec::with_capacity(triangles.len() * 3);
+    for t in triangles {
+        let [a, b, c] = t.vertices().map(Vec3::from);
+        // Many exporters write zero normals; recompute those from the winding.
+        let mut n = Vec3::from(t.normal());
+        if n.length_squared() < 1e-12 {
+            n = (b - a).cross(c - a).normalize_or_zero();
+        }
+        for p in [a, b, c] {
+            vertices.push(Vertex {
+                position: p.to_array(),
+                uv: [0.0, 0.0],
+                normal: n.to_array(),
+            });
+        }
+    }
+    let indices = (0..vertices.len() as u32).collect();
+    Some((vertices, indices))
+}
+
+/// One vertex attribute as `glVertexAttribPointer` sees it.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct VertexAttrib {
+    pub location: u32,
+    pub components: i32,
+    pub gl_type: u32,
+    pub normalized: bool,
+    pub offset: usize,
+}
+
+/// A decoded `wasm96_graphics_mesh_create_ex` vertex format (bits in `abi::mesh`).
+///
+/// Attributes are packed in the order position, UV, normal, each padded to 4 bytes.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct VertexFormat {
+    pub bits: u32,
+    pub stride: usize,
+    pub position: VertexAttrib,
+    pub uv: Option<VertexAttrib>,
+    pub normal: VertexAttrib,
+    /// Normals are two oct-encoded components the vertex shader expands.
+    pub oct_normals: bool,
+}
+
+impl VertexFormat {
+    /// The `Vertex` layout used by `graphics_mesh_create`, OBJ/STL and blobs.
+    pub fn float() -> Self {
+        Self::from_bits(0).unwrap()
+    }
+
+    /// Decode a format descriptor; `None` for unknown encodings or bits.
+    pub fn from_bits(bits: u32) -> Option<Self> {
+        if bits & !(POSITION_MASK | UV_MASK | NORMAL_MASK) != 0 {
+            return None;
+        }
+        let mut offset = 0;
+        let mut attrib = |location, components, gl_type, normalized, size| {
+            let a = VertexAttrib {
+                location,
+                components,
+                gl_type,
+                normalized,
+                offset,
+            };
+            offset += size;
+            a
+        };
+
+        // Half-float and snorm16 positions carry a padding component to keep 4-byte alignment.
+        let position = match bits & POSITION_MASK {
+            POSITION_F32 => attrib(0, 3, gl::FLOAT, false, 12),
+            POSITION_F16 => attrib(0, 4, gl::HALF_FLOAT, false, 8),
+            POSITION_SNORM16 => attrib(0, 4, gl::SHORT, true, 8),
+            _ => return None,
+        };
+        let uv = match bits & UV_MASK {
+            UV_F32 => Some(attrib(1, 2, gl::FLOAT, false, 8)),
+            UV_UNORM16 => Some(attrib(1, 2, gl::UNSIGNED_SHORT, true, 4)),
+            UV_NONE => None,
+            _ => return None,
+        };
+        let (normal, oct_normals) = match bits & NORMAL_MASK {
+            NORMAL_F32 => (attrib(2, 3, gl::FLOAT, false, 12), false),
+            NORMAL_OCT16 => (attrib(2, 2, gl::SHORT, true, 4), true),
+            _ => return None,
+        };
+
+        Some(Self {
+            bits,
+            stride: offset,
+            position,
+            uv,
+            normal,
+            oct_normals,
+        })
+    }
+
+    /// Object-space position of one vertex record (`stride` bytes).
+    pub fn position(&self, record: &[u8]) -> Vec3 {
+        let o = self.position.offset;
+        let i16_at = |i: usize| u16_at(record, o + i * 2) as i16;
+        match self.bits & POSITION_MASK {
+            POSITION_F16 => Vec3::new(
+                f16_to_f32(u16_at(record, o)),
+                f16_to_f32(u16_at(record, o + 2)),
+                f16_to_f32(u16_at(record, o + 4)),
+            ),
+            POSITION_SNORM16 => Vec3::new(
+                snorm16_to_f32(i16_at(0)),
+                snorm16_to_f32(i16_at(1)),
+                snorm16_to_f32(i16_at(2)),
+            ),
+            _ => Vec3::new(
+                f32_at(record, o),
+                f32_at(record, o + 4),
+                f32_at(record, o + 8),
+            ),
+        }
+    }
+
+    /// Bounding sphere of a packed vertex array.
+    pub fn bounds(&self, vertices: &[u8]) -> Bounds {
+        Bounds::from_points(
+            vertices
+                .chunks_exact(self.stride)
+                .map(|rec| self.position(rec)),
+        )
+    }
+}
+
+/// IEEE 754 binary16 to `f32`.
+pub fn f16_to_f32(h: u16) -> f32 {
+    let sign = if h & 0x8000 != 0 { -1.0 } else { 1.0 };
+    let exp = ((h >> 10) & 0x1F) as i32;
+    let mant = (h & 0x3FF) as f32;
+    match exp {
+        0 => sign * mant * (1.0 / 16_777_216.0),
+        0x1F if mant == 0.0 => sign * f32::INFINITY,
+        0x1F => f32::NAN,
+        _ => sign * (1.0 + mant / 1024.0) * 2f32.powi(exp - 15),
+    }
+}
+
+/// GL's snorm16 to `f32` conversion (`-32768` and `-32767` both map to `-1`).
+pub fn snorm16_to_f32(v: i16) -> f32 {
+    (v as f32 / 32767.0).max(-1.0)
+}
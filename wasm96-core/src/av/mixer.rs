@@ -0,0 +1,219 @@
+//! Multi-voice mixer.
+//!
+//! Every active `AudioChannel` is accumulated into one f32 stereo block (`AudioState::mix_buffer`)
+//! and the block is clipped to i16 once at the end, so loud voices summing above full scale do not
+//! distort each other mid-mix. Voices whose source rate differs from the output rate are resampled
+//! with linear interpolation over a 32.32 fixed-point position; same-rate voices take a straight
+//! copy-and-scale path. Both inner loops are plain slice loops that LLVM vectorizes.
+//!
+//! Short assets are decoded whole and shared: `decoded_pcm` caches decodes by content hash, so
+//! replaying the same sound effect (e.g. every shot or footstep) costs a hash and an `Arc` clone,
+//! not a decode. Long tracks and XM modules are voices with a `PcmStream` instead, decoded a
+//! block at a time as they are mixed (see `audio_stream`).
+
+use std::hash::Hasher;
+use std::sync::{Arc, Mutex, OnceLock};
+
+use crate::abi::audio::FORMAT_XM;
+use crate::state::AudioChannel;
+
+use super::audio_stream::decode_all;
+use super::lru_cache::LruCache;
+
+/// One source frame in 32.32 fixed point.
+const FRAME_ONE: u64 = 1 << 32;
+
+/// Byte budget for cached decoded PCM (16 MiB, ~95 s of 44.1 kHz stereo).
+pub const PCM_CACHE_BYTES: usize = 16 << 20;
+
+/// Decoded interleaved stereo and its sample rate.
+#[derive(Clone)]
+pub struct DecodedPcm {
+    pub pcm_stereo: Arc<[i16]>,
+    pub sample_rate: u32,
+    /// Content key in the PCM cache (see [`cached_pcm`]).
+    pub key: u64,
+}
+
+static PCM_CACHE: OnceLock<Mutex<LruCache<u64, DecodedPcm>>> = OnceLock::new();
+
+/// Decode `bytes` as `format` (`abi::audio::FORMAT_*`), reusing a cached decode of identical
+/// bytes. XM modules are rendered at `out_rate`.
+pub fn decoded_pcm(format: u32, bytes: &[u8], out_rate: u32) -> Option<DecodedPcm> {
+    let mut hasher = ahash::AHasher::default();
+    hasher.write_u32(format);
+    hasher.write_u32(if format == FORMAT_XM { out_rate } else { 0 });
+    hasher.write(bytes);
+    let key = hasher.finish();
+
+    if let Some(hit) = cached_pcm(key) {
+        return Some(hit);
+    }
+
+    let (pcm, sample_rate) = decode_all(format, bytes, out_rate)?;
+    let decoded = DecodedPcm {
+        pcm_stereo: pcm.into(),
+        sample_rate,
+        key,
+    };
+    let cache = pcm_cache();
+    let cost = decoded.pcm_stereo.len() * 2;
+    cache.lock().unwrap().insert(key, decoded.clone(), cost);
+    Some(decoded)
+}
+
+fn pcm_cache() -> &'static Mutex<LruCache<u64, DecodedPcm>> {
+    PCM_CACHE.get_or_init(|| Mutex::new(LruCache::with_budget(PCM_CACHE_BYTES)))
+}
+
+/// A still-cached decode by its [`DecodedPcm::key`] (savestates restore voices through this).
+pub fn cached_pcm(key: u64) -> Option<DecodedPcm> {
+    pcm_cache().lock().unwrap().get(&key).cloned()
+}
+
+/// Left/right gains for a voice: volume (Q8.8) times a linear pan that attenuates only the far
+/// side.
+fn gains(voice: &AudioChannel) -> (f32, f32) {
+    let volume = voice.volume_q8_8 as f32 / 256.0;
+    let pan = voice.pan_i16.clamp(-32768, 32767);
+    let left = if pan <= 0 {
+        1.0
+    } else {
+        (32768 - pan) as f32 / 32768.0
+    };
+    let right = if pan >= 0 {
+        1.0
+    } else {
+        (32768 + pan) as f32 / 32768.0
+    };
+    (volume * left, volume * right)
+}
+
+/// Mix `pcm` from `*pos` into `out` until `out` is full or `pcm` runs out, advancing `*pos`.
+/// `wrap` interpolates the last frame toward frame 0 (looping sources). Returns the number of
+/// `f32`s written.
+fn mix_span(
+    pcm: &[i16],
+    pos: &mut u64,
+    step: u64,
+    (gl, gr): (f32, f32),
+    out: &mut [f32],
+    wrap: bool,
+) -> usize {
+    let frames = pcm.len() / 2;
+    let end = (frames as u64) << 32;
+    if *pos >= end {
+        return 0;
+    }
+
+    let first = (*pos >> 32) as usize;
+    if step == FRAME_ONE && *pos & (FRAME_ONE - 1) == 0 {
+        // Same rate, frame-aligned: scale and add a contiguous run.
+        let run = (frames - first).min(out.len() / 2);
+        let src = &pcm[first * 2..(first + run) * 2];
+        for (d, s) in out.chunks_exact_mut(2).zip(src.chunks_exact(2)) {
+            d[0] += s[0] as f32 * gl;
+            d[1] += s[1] as f32 * gr;
+        }
+        *pos += (run as u64) << 32;
+        return run * 2;
+    }
+
+    // Resample: linear interpolation until the output block or the source runs out.
+    let mut written = 0;
+    for d in out.chunks_exact_mut(2) {
+        if *pos >= end {
+            break;
+        }
+        let i = (*pos >> 32) as usize;
+        let next = if i + 1 < frames {
+            i + 1
+        } else if wrap {
+            0
+        } else {
+            i
+        };
+        let t = (*pos & (FRAME_ONE - 1)) as f32 * (1.0 / FRAME_ONE as f32);
+        let (l0, r0) = (pcm[i * 2] as f32, pcm[i * 2 + 1] as f32);
+        let (l1, r1) = (pcm[next * 2] as f32, pcm[next * 2 + 1] as f32);
+        d[0] += (l0 + (l1 - l0) * t) * gl;
+        d[1] += (r0 + (r1 - r0) * t) * gr;
+        *pos += step;
+        written += 2;
+    }
+    written
+}
+
+/// Add one voice into `acc` (interleaved stereo), advancing its position. Clears `active` when a
+/// non-looping voice runs out.
+fn mix_voice(voice: &mut AudioChannel, acc: &mut [f32], out_rate: u32) {
+    if out_rate == 0 || voice.sample_rate == 0 {
+        voice.active = false;
+        return;
+    }
+    let gains = gains(voice);
+    let step = ((voice.sample_rate as u64) << 32) / out_rate as u64;
+    let mut pos = ((voice.position_frames as u64) << 32) | voice.position_frac as u64;
+
+    if let Some(stream) = voice.stream.as_mut() {
+        // Streamed: decode just enough ahead for this block (plus one frame to interpolate
+        // toward), mix it, then drop what was played. Positions are relative to the window.
+        let out_frames = (acc.len() / 2) as u64;
+        let needed = ((pos + out_frames * step) >> 32) as usize + 2;
+        stream.fill(needed, voice.loop_enabled);
+
+        mix_span(stream.window(), &mut pos, step, gains, acc, false);
+        let buffered = stream.window().len() / 2;
+        if pos >= (buffered as u64) << 32 && stream.exhausted() {
+            voice.active = false;
+        }
+        let played = ((pos >> 32) as usize).min(buffered);
+        stream.consume(played);
+        pos -= (played as u64) << 32;
+    } else {
+        let pcm = Arc::clone(&voice.pcm_stereo);
+        let end = ((pcm.len() / 2) as u64) << 32;
+        if end == 0 {
+            voice.active = false;
+            return;
+        }
+        let mut out = acc;
+        while !out.is_empty() {
+            if pos >= end {
+                if !voice.loop_enabled {
+                    break;
+                }
+                pos %= end;
+            }
+            let written = mix_span(&pcm, &mut pos, step, gains, out, voice.loop_enabled);
+            out = &mut out[written..];
+        }
+        if pos >= end && !voice.loop_enabled {
+            voice.active = false;
+        }
+    }
+
+    voice.position_frames = (pos >> 32) as usize;
+    voice.position_frac = pos as u32;
+}
+
+/// Mix all active voices on top of `out` (which may already hold pushed samples), clip once, and
+/// drop voices that finished.
+pub fn mix_voices(
+    voices: &mut Vec<AudioChannel>,
+    out: &mut [i16],
+    out_rate: u32,
+    acc: &mut Vec<f32>,
+) {
+    acc.clear();
+    acc.extend(out.iter().map(|&s| s as f32));
+
+    for voice in voices.iter_mut().filter(|v| v.active) {
+        mix_voice(voice, acc, out_rate);
+    }
+    voices.retain(|v| v.active);
+
+    for (dst, &sum) in out.iter_mut().zip(acc.iter()) {
+        *dst = sum.clamp(i16::MIN as f32, i16::MAX as f32) as i16;
+    }
+}
@@ -3,14 +3,17 @@
 //!
 //! This module implements the host-side drawing commands and audio handling.
 //!
-//! - Graphics: The host maintains a `Vec<u32>` framebuffer (XRGB8888).
-//!   Guest commands modify this buffer.
+//! - Graphics: The host maintains a `Vec<u32>` framebuffer of premultiplied ARGB pixels.
+//!   Guest commands modify this buffer. The GL overlay blends it with
+//!   `ONE, ONE_MINUS_SRC_ALPHA`; the software path hands it to libretro as XRGB8888.
 //!   `video_present_host` sends it to libretro.
 //!
 //! - Audio:
-//!   - Guests may push raw i16 samples (`audio_push_samples`) into `audio.host_queue`.
+//!   - Guests may push raw i16 samples (`audio_push_samples`) into the lock-free `audio_ring`.
 //!   - The host may also manage “channels/voices” (decoded assets and chiptune synth voices)
 //!     stored in `state::AudioState` and mixed here.
+//!   - `mixer` resamples and mixes voices in f32, clipping once at the end; long tracks are
+//!     decoded incrementally by `audio_stream` as they are mixed.
 //!   - `audio_drain_host` mixes everything into a single interleaved stereo i16 buffer and
 //!     pads with silence as needed to satisfy the libretro backend.
 
@@ -23,17 +26,44 @@ extern crate alloc;
 
 // Storage ABI helpers
 
+pub mod assets;
 pub mod audio;
+pub mod audio_ring;
+pub mod audio_stream;
+pub mod commands;
+pub mod draw_lists;
+pub mod gif_stream;
+pub mod glyph_cache;
+pub mod gpu2d;
 pub mod graphics;
 pub mod graphics3d;
+pub mod lru_cache;
+pub mod mesh_data;
+pub mod mixer;
+pub mod raster;
 pub mod resources;
+pub mod sprites;
 pub mod storage;
+pub mod storage_log;
+pub mod svg_cache;
 pub mod tests;
+pub mod text_layout;
+pub mod tilemap;
+pub mod tiles;
 pub mod utils;
 
 // Re-export all public functions
+pub use assets::{asset_apply_completed, asset_load, asset_reset, asset_status, asset_wait_all};
 pub use audio::*;
+pub use commands::graphics_submit;
+pub use draw_lists::{
+    graphics_list_begin, graphics_list_destroy, graphics_list_draw, graphics_list_end,
+};
 pub use graphics::*;
 pub use graphics3d::*;
 pub use resources::AvError;
+pub use sprites::graphics_sprite_batch;
 pub use storage::*;
+pub use tilemap::{
+    tilemap_create, tilemap_destroy, tilemap_draw, tilemap_set_tile, tilemap_set_tiles,
+};
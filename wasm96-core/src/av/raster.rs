@@ -0,0 +1,885 @@
+//! Software rasterizer primitives.
+//!
+//! These functions draw into a borrowed `VideoState`. They take no locks, so callers decide how
+//! long the global state stays locked:
+//! - the per-call `wasm96_graphics_*` imports lock once per primitive (see `graphics.rs`)
+//! - `wasm96_graphics_submit` locks once for a whole command list (see `commands.rs`)
+//!
+//! Each primitive is a `Shape`. `submit` records its (clipped) bounding box with
+//! `VideoState::mark_damage`, so present can tell which part of the frame changed, and then
+//! either rasterizes it straight away or, when the frame is deferred, appends it to the display
+//! list that `tiles.rs` rasterizes in parallel bands at present. Shapes draw onto a `Canvas`,
+//! a band of framebuffer rows, so the same code serves both paths.
+//!
+//! Filled shapes are rasterized as one horizontal span per row (clipped once per row, then
+//! written with `fill_span`), never pixel by pixel. The draw color's alpha selects the write:
+//! 255 overwrites, 0 draws nothing, anything else is a source-over blend, so translucent shapes
+//! (ghost pieces, fades) blend with what is underneath. The framebuffer therefore holds
+//! premultiplied ARGB, which is also how the 3D overlay composites it.
+
+use crate::state::{DamageRect, VideoState};
+
+use super::tiles;
+use super::utils::tri_edge;
+
+/// Pack an RGBA color as 0xAARRGGBB (ARGB8888).
+#[inline]
+pub fn pack_color(r: u32, g: u32, b: u32, a: u32) -> u32 {
+    ((a & 0xFF) << 24) | ((r & 0xFF) << 16) | ((g & 0xFF) << 8) | (b & 0xFF)
+}
+
+/// One 2D primitive, as recorded in the display list. Coordinates are as passed by the guest.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum Shape {
+    /// Fill every pixel (ignores the draw color).
+    Clear,
+    /// Fill a rectangle (ignores the draw color).
+    ClearRect {
+        x: i32,
+        y: i32,
+        w: u32,
+        h: u32,
+    },
+    Point {
+        x: i32,
+        y: i32,
+    },
+    Line {
+        x0: i32,
+        y0: i32,
+        x1: i32,
+        y1: i32,
+    },
+    Rect {
+        x: i32,
+        y: i32,
+        w: u32,
+        h: u32,
+    },
+    RectOutline {
+        x: i32,
+        y: i32,
+        w: u32,
+        h: u32,
+    },
+    Circle {
+        cx: i32,
+        cy: i32,
+        r: u32,
+    },
+    CircleOutline {
+        cx: i32,
+        cy: i32,
+        r: u32,
+    },
+    Triangle([i32; 6]),
+    TriangleOutline([i32; 6]),
+    BezierQuadratic {
+        p: [i32; 6],
+        segments: u32,
+    },
+    BezierCubic {
+        p: [i32; 8],
+        segments: u32,
+    },
+    Pill {
+        x: i32,
+        y: i32,
+        w: u32,
+        h: u32,
+    },
+    PillOutline {
+        x: i32,
+        y: i32,
+        w: u32,
+        h: u32,
+    },
+}
+
+impl Shape {
+    /// Half-open bounding box `(x0, y0, x1, y1)` of every pixel the shape can write, unclipped.
+    pub fn bounds(&self) -> (i32, i32, i32, i32) {
+        match *self {
+            Shape::Clear => (0, 0, i32::MAX, i32::MAX),
+            Shape::ClearRect { x, y, w, h } | Shape::Rect { x, y, w, h } => {
+                (x, y, x + w as i32, y + h as i32)
+            }
+            Shape::Point { x, y } => (x, y, x + 1, y + 1),
+            Shape::Line { x0, y0, x1, y1 } => {
+                (x0.min(x1), y0.min(y1), x0.max(x1) + 1, y0.max(y1) + 1)
+            }
+            Shape::RectOutline { x, y, w, h } => (x, y, x + w as i32 + 1, y + h as i32 + 1),
+            Shape::Circle { cx, cy, r } => {
+                let r = r as i32;
+                (cx - r, cy - r, cx + r, cy + r)
+            }
+            Shape::CircleOutline { cx, cy, r } => {
+                let r = r as i32;
+                (cx - r, cy - r, cx + r + 1, cy + r + 1)
+            }
+            Shape::Triangle(p) => {
+                if tri_edge((p[0], p[1]), (p[2], p[3]), (p[4], p[5])) == 0 {
+                    return (0, 0, 0, 0);
+                }
+                hull(&p)
+            }
+            Shape::TriangleOutline(p) => hull(&p),
+            // Curves stay inside the hull of their control points.
+            Shape::BezierQuadratic { p, segments } if segments > 0 => hull(&p),
+            Shape::BezierCubic { p, segments } if segments > 0 => hull(&p),
+            Shape::BezierQuadratic { .. } | Shape::BezierCubic { .. } => (0, 0, 0, 0),
+            Shape::Pill { x, y, w, h } if w > 0 && h > 0 => (x, y, x + w as i32, y + h as i32),
+            Shape::PillOutline { x, y, w, h } if w > 0 && h > 0 => {
+                (x, y, x + w as i32 + 1, y + h as i32 + 1)
+            }
+            Shape::Pill { .. } | Shape::PillOutline { .. } => (0, 0, 0, 0),
+        }
+    }
+
+    /// The same shape moved by (`dx`, `dy`) pixels.
+    pub fn translated(self, dx: i32, dy: i32) -> Shape {
+        let mv = |p: &mut [i32]| {
+            for xy in p.chunks_exact_mut(2) {
+                xy[0] += dx;
+                xy[1] += dy;
+            }
+        };
+        let mut s = self;
+        match &mut s {
+            Shape::Clear => {}
+            Shape::ClearRect { x, y, .. }
+            | Shape::Point { x, y }
+            | Shape::Rect { x, y, .. }
+            | Shape::RectOutline { x, y, .. }
+            | Shape::Pill { x, y, .. }
+            | Shape::PillOutline { x, y, .. }
+            | Shape::Circle { cx: x, cy: y, .. }
+            | Shape::CircleOutline { cx: x, cy: y, .. } => {
+                *x += dx;
+                *y += dy;
+            }
+            Shape::Line { x0, y0, x1, y1 } => {
+                *x0 += dx;
+                *y0 += dy;
+                *x1 += dx;
+                *y1 += dy;
+            }
+            Shape::Triangle(p) | Shape::TriangleOutline(p) | Shape::BezierQuadratic { p, .. } => {
+                mv(p)
+            }
+            Shape::BezierCubic { p, .. } => mv(p),
+        }
+        s
+    }
+
+    /// Rasterize the part of the shape inside `c` in `color`.
+    pub fn draw(&self, c: &mut Canvas<'_>, color: u32) {
+        match *self {
+            Shape::Clear => c.pixels.fill(color),
+            Shape::ClearRect { x, y, w, h } => {
+                for row in y.max(c.y0)..(y + h as i32).min(c.y1) {
+                    c.span_with(row, x, x + w as i32, |span| span.fill(color));
+                }
+            }
+            Shape::Point { x, y } => c.span(y, x, x + 1, color),
+            Shape::Line { x0, y0, x1, y1 } => line_ex(c, color, x0, y0, x1, y1, true),
+            Shape::Rect { x, y, w, h } => draw_rect(c, color, x, y, w, h),
+            Shape::RectOutline { x, y, w, h } => draw_rect_outline(c, color, x, y, w, h),
+            Shape::Circle { cx, cy, r } => draw_circle(c, color, cx, cy, r),
+            Shape::CircleOutline { cx, cy, r } => draw_circle_outline(c, color, cx, cy, r),
+            Shape::Triangle(p) => draw_triangle(c, color, p),
+            Shape::TriangleOutline([x1, y1, x2, y2, x3, y3]) => {
+                line_ex(c, color, x1, y1, x2, y2, false);
+                line_ex(c, color, x2, y2, x3, y3, false);
+                line_ex(c, color, x3, y3, x1, y1, false);
+            }
+            Shape::BezierQuadratic { p, segments } => draw_bezier_quadratic(c, color, p, segments),
+            Shape::BezierCubic { p, segments } => draw_bezier_cubic(c, color, p, segments),
+            Shape::Pill { x, y, w, h } => draw_pill(c, color, x, y, w, h),
+            Shape::PillOutline { x, y, w, h } => draw_pill_outline(c, color, x, y, w, h),
+        }
+    }
+}
+
+/// Inclusive bounding box of `(x, y)` vertex pairs, as a half-open `bounds` rectangle.
+fn hull(p: &[i32]) -> (i32, i32, i32, i32) {
+    let xs = p.iter().step_by(2);
+    let ys = p.iter().skip(1).step_by(2);
+    (
+        *xs.clone().min().unwrap(),
+        *ys.clone().min().unwrap(),
+        xs.max().unwrap() + 1,
+        ys.max().unwrap() + 1,
+    )
+}
+
+/// Draw `shape` in `color`: record its damage, then rasterize it now, or append it to the display
+/// list if this frame is deferred (see `tiles.rs`).
+pub fn submit(v: &mut VideoState, shape: Shape, color: u32) {
+    if capture(v, shape, color) {
+        return;
+    }
+    let (x0, y0, x1, y1) = shape.bounds();
+    v.mark_damage(x0, y0, x1, y1);
+    if v.display_list.is_deferred() {
+        let rect = DamageRect::clipped(x0, y0, x1, y1, v.width, v.height);
+        v.display_list.push(shape, color, rect);
+    } else {
+        shape.draw(&mut Canvas::full(v), color);
+    }
+}
+
+/// While a retained list is being recorded (see `draw_lists`), `shape` goes into it instead of
+/// the framebuffer.
+fn capture(v: &mut VideoState, shape: Shape, color: u32) -> bool {
+    match &mut v.recording {
+        Some(rec) => {
+            rec.push(shape, color);
+            true
+        }
+        None => false,
+    }
+}
+
+/// Draw a shape taken from a recorded list, clears included.
+pub fn replay(v: &mut VideoState, shape: Shape, color: u32) {
+    match shape {
+        Shape::Clear => clear(v, color),
+        Shape::ClearRect { x, y, w, h } => clear_rect(v, x, y, w, h, color),
+        _ => submit(v, shape, color),
+    }
+}
+
+/// Fill the whole framebuffer with `color`.
+pub fn clear(v: &mut VideoState, color: u32) {
+    if capture(v, Shape::Clear, color) {
+        return;
+    }
+    // Nothing recorded before a full clear can show.
+    v.display_list.discard();
+    submit(v, Shape::Clear, color);
+    v.mark_all_damaged();
+    if color == 0 {
+        v.overlay_bounds = DamageRect::default();
+    }
+}
+
+/// Fill a rectangle with `color`, clipped to the framebuffer (ignores the draw color).
+pub fn clear_rect(v: &mut VideoState, x: i32, y: i32, w: u32, h: u32, color: u32) {
+    if capture(v, Shape::ClearRect { x, y, w, h }, color) {
+        return;
+    }
+    let rect = DamageRect::clipped(x, y, x + w as i32, y + h as i32, v.width, v.height);
+    if rect.is_empty() {
+        return;
+    }
+
+    let bounds = v.overlay_bounds;
+    submit(v, Shape::ClearRect { x, y, w, h }, color);
+    if color == 0 {
+        // Clearing to transparent never grows the overlay; clearing all of it empties it.
+        v.overlay_bounds = if rect.contains(&bounds) {
+            DamageRect::default()
+        } else {
+            bounds
+        };
+    }
+}
+
+/// Write `color` over every pixel of `span`.
+///
+/// Opaque colors are a plain `fill`; translucent ones are blended (see `Blend`); fully transparent
+/// ones leave the span untouched.
+#[inline]
+pub fn fill_span(span: &mut [u32], color: u32) {
+    match color >> 24 {
+        255 => span.fill(color),
+        0 => {}
+        _ => Blend::new(color).apply_span(span),
+    }
+}
+
+/// Write one straight-alpha texel (`rgb` with alpha `a`) over `dst`: image blits and glyphs.
+///
+/// Opaque texels store alpha 255, so they cover the 3D scene under the overlay; translucent ones
+/// are blended into the premultiplied framebuffer like shapes.
+#[inline(always)]
+pub fn put_texel(dst: &mut u32, rgb: u32, a: u32) {
+    match a {
+        0 => {}
+        255 => *dst = 0xFF00_0000 | rgb,
+        _ => *dst = Blend::new((a << 24) | rgb).apply(*dst),
+    }
+}
+
+/// Source-over blend of one translucent color, set up once per primitive or span.
+///
+/// Two 8-bit channels share each 32-bit multiply (R/B and A/G, with 8 spare bits per lane), and
+/// alpha is rescaled to 0..=256 so the divide by 255 becomes a shift. Spans are processed in
+/// chunks of 8 pixels with no cross-pixel dependencies, which the compiler turns into vector code
+/// (SSE2/NEON) without target-specific intrinsics.
+#[derive(Clone, Copy)]
+pub struct Blend {
+    src_rb: u32,
+    src_ag: u32,
+    inv: u32,
+}
+
+impl Blend {
+    pub fn new(color: u32) -> Self {
+        let a = color >> 24;
+        let a = a + (a >> 7);
+        // The source alpha channel counts as 255, so the result alpha is `a + dst_a * (1 - a)`.
+        let src = color | 0xFF00_0000;
+        Self {
+            // +0x80 per lane rounds the final shift to nearest.
+            src_rb: (src & 0x00FF_00FF) * a + 0x0080_0080,
+            src_ag: ((src >> 8) & 0x00FF_00FF) * a + 0x0080_0080,
+            inv: 256 - a,
+        }
+    }
+
+    #[inline(always)]
+    pub fn apply(&self, dst: u32) -> u32 {
+        let rb = (((dst & 0x00FF_00FF) * self.inv + self.src_rb) >> 8) & 0x00FF_00FF;
+        let ag = (((dst >> 8) & 0x00FF_00FF) * self.inv + self.src_ag) & 0xFF00_FF00;
+        rb | ag
+    }
+
+    pub fn apply_span(&self, span: &mut [u32]) {
+        let mut chunks = span.chunks_exact_mut(8);
+        for chunk in &mut chunks {
+            for d in chunk {
+                *d = self.apply(*d);
+            }
+        }
+        for d in chunks.into_remainder() {
+            *d = self.apply(*d);
+        }
+    }
+}
+
+/// Integer square root (floor) for the span extents of circles and pills.
+#[inline]
+fn isqrt(n: i64) -> i64 {
+    if n <= 0 {
+        return 0;
+    }
+    let mut s = (n as f64).sqrt() as i64;
+    while s * s > n {
+        s -= 1;
+    }
+    while (s + 1) * (s + 1) <= n {
+        s += 1;
+    }
+    s
+}
+
+/// Rows `y0..y1` of a `width`-pixel framebuffer: the whole frame when drawing immediately, one
+/// band when `tiles.rs` draws a display list in parallel. Shapes clip to it.
+pub struct Canvas<'a> {
+    /// Pixels of rows `y0..y1`, row-major.
+    pub pixels: &'a mut [u32],
+    pub width: i32,
+    pub y0: i32,
+    pub y1: i32,
+    /// When set, clipped spans are appended here instead of written (see `Canvas::recording`).
+    pub spans: Option<&'a mut Vec<Span>>,
+}
+
+/// Pixels `x0..x1` of row `y`, as a shape would write them.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct Span {
+    pub y: i32,
+    pub x0: i32,
+    pub x1: i32,
+}
+
+impl<'a> Canvas<'a> {
+    /// The whole host framebuffer.
+    pub fn full(v: &'a mut VideoState) -> Self {
+        Self {
+            width: v.width as i32,
+            y0: 0,
+            y1: v.height as i32,
+            pixels: &mut v.framebuffer,
+            spans: None,
+        }
+    }
+
+    /// A `width`x`height` canvas with no pixels that collects each clipped span into `spans`,
+    /// in the order the rasterizer would write them. `gpu2d` draws shapes from these, so the GPU
+    /// covers exactly the pixels the software path does. `Shape::Clear` records nothing.
+    pub fn recording(width: u32, height: u32, spans: &'a mut Vec<Span>) -> Self {
+        Self {
+            pixels: &mut [],
+            width: width as i32,
+            y0: 0,
+            y1: height as i32,
+            spans: Some(spans),
+        }
+    }
+
+    /// Clip `lo..hi` of row `y` to the canvas and, if anything is left, pass it to `f`.
+    #[inline]
+    fn span_with(&mut self, y: i32, lo: i32, hi: i32, f: impl FnOnce(&mut [u32])) {
+        let (lo, hi) = (lo.max(0), hi.min(self.width));
+        if y < self.y0 || y >= self.y1 || lo >= hi {
+            return;
+        }
+        if let Some(spans) = self.spans.as_deref_mut() {
+            spans.push(Span { y, x0: lo, x1: hi });
+            return;
+        }
+        let row = (y - self.y0) as usize * self.width as usize;
+        f(&mut self.pixels[row + lo as usize..row + hi as usize]);
+    }
+
+    /// Write `color` over pixels `lo..hi` of row `y`, clipped to the canvas.
+    #[inline]
+    fn span(&mut self, y: i32, lo: i32, hi: i32, color: u32) {
+        self.span_with(y, lo, hi, |span| fill_span(span, color));
+    }
+
+    /// Fill pixels `x0..=x1` of row `y` (either order).
+    fn hspan(&mut self, y: i32, x0: i32, x1: i32, color: u32) {
+        self.span(y, x0.min(x1), x0.max(x1) + 1, color);
+    }
+
+    /// Fill pixels `y0..=y1` of column `x` (either order).
+    fn vspan(&mut self, x: i32, y0: i32, y1: i32, color: u32) {
+        for y in y0.min(y1).max(self.y0)..=y0.max(y1).min(self.y1 - 1) {
+            self.span(y, x, x + 1, color);
+        }
+    }
+}
+
+/// Composite a `w`x`h` block of premultiplied 0xAARRGGBB pixels at (x, y), clipped to the
+/// framebuffer (source-over; zero-alpha pixels are skipped).
+pub fn blit_premultiplied(v: &mut VideoState, x: i32, y: i32, w: u32, h: u32, pixels: &[u32]) {
+    tiles::resolve(v);
+    let screen_w = v.width as i32;
+    let screen_h = v.height as i32;
+
+    let x_start = x.max(0);
+    let y_start = y.max(0);
+    let x_end = (x + w as i32).min(screen_w);
+    let y_end = (y + h as i32).min(screen_h);
+    if x_start >= x_end || y_start >= y_end || pixels.len() < (w as usize) * (h as usize) {
+        return;
+    }
+
+    v.mark_damage(x_start, y_start, x_end, y_end);
+    let fb_w = screen_w as usize;
+    let span = (x_end - x_start) as usize;
+    for curr_y in y_start..y_end {
+        let src_start = ((curr_y - y) as usize) * (w as usize) + (x_start - x) as usize;
+        let dst_start = (curr_y as usize) * fb_w + x_start as usize;
+        let src = &pixels[src_start..src_start + span];
+        let dst = &mut v.framebuffer[dst_start..dst_start + span];
+        for (d, &p) in dst.iter_mut().zip(src) {
+            match p >> 24 {
+                255 => *d = p,
+                0 => {}
+                a => {
+                    // dst * (1 - a) + src, channel pairs as in `Blend`.
+                    let inv = 256 - (a + (a >> 7));
+                    let rb = (((*d & 0x00FF_00FF) * inv + 0x0080_0080) >> 8) & 0x00FF_00FF;
+                    let ag = (((*d >> 8) & 0x00FF_00FF) * inv + 0x0080_0080) & 0xFF00_FF00;
+                    *d = p + (rb | ag);
+                }
+            }
+        }
+    }
+}
+
+/// Draw a single pixel.
+pub fn point(v: &mut VideoState, x: i32, y: i32) {
+    submit(v, Shape::Point { x, y }, v.draw_color);
+}
+
+/// Draw a line using Bresenham's algorithm.
+pub fn line(v: &mut VideoState, x0: i32, y0: i32, x1: i32, y1: i32) {
+    submit(v, Shape::Line { x0, y0, x1, y1 }, v.draw_color);
+}
+
+/// Draw a filled rectangle.
+pub fn rect(v: &mut VideoState, x: i32, y: i32, w: u32, h: u32) {
+    submit(v, Shape::Rect { x, y, w, h }, v.draw_color);
+}
+
+/// Draw a rectangle outline.
+///
+/// Covers `x..=x + w` by `y..=y + h` (the four edges as inclusive lines), writing each pixel once.
+pub fn rect_outline(v: &mut VideoState, x: i32, y: i32, w: u32, h: u32) {
+    submit(v, Shape::RectOutline { x, y, w, h }, v.draw_color);
+}
+
+/// Draw a filled circle.
+///
+/// Covers the pixels with `dx^2 + dy^2 <= r^2` in `cx - r..cx + r` by `cy - r..cy + r`.
+pub fn circle(v: &mut VideoState, cx: i32, cy: i32, r: u32) {
+    submit(v, Shape::Circle { cx, cy, r }, v.draw_color);
+}
+
+/// Draw a circle outline (Bresenham's circle algorithm).
+pub fn circle_outline(v: &mut VideoState, cx: i32, cy: i32, r: u32) {
+    submit(v, Shape::CircleOutline { cx, cy, r }, v.draw_color);
+}
+
+/// Draw a filled triangle.
+///
+/// Rasterization rule:
+/// - We treat pixels as **samples at pixel centers**: (x + 0.5, y + 0.5).
+///   This avoids cases where a triangle covers no integer lattice points and would
+///   otherwise render as empty for small/skinny triangles.
+///
+/// Each edge function is linear in x along a row, so instead of testing every pixel of the
+/// bounding box the inside interval of each row is solved exactly (integer ceil/floor division)
+/// and filled as one span. The covered pixels are the same as a per-pixel edge test.
+pub fn triangle(v: &mut VideoState, x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32) {
+    submit(v, Shape::Triangle([x1, y1, x2, y2, x3, y3]), v.draw_color);
+}
+
+/// Draw a triangle outline.
+pub fn triangle_outline(v: &mut VideoState, x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32) {
+    submit(
+        v,
+        Shape::TriangleOutline([x1, y1, x2, y2, x3, y3]),
+        v.draw_color,
+    );
+}
+
+/// Draw a quadratic Bezier curve.
+pub fn bezier_quadratic(
+    v: &mut VideoState,
+    x1: i32,
+    y1: i32,
+    cx: i32,
+    cy: i32,
+    x2: i32,
+    y2: i32,
+    segments: u32,
+) {
+    let p = [x1, y1, cx, cy, x2, y2];
+    submit(v, Shape::BezierQuadratic { p, segments }, v.draw_color);
+}
+
+/// Draw a cubic Bezier curve.
+pub fn bezier_cubic(
+    v: &mut VideoState,
+    x1: i32,
+    y1: i32,
+    cx1: i32,
+    cy1: i32,
+    cx2: i32,
+    cy2: i32,
+    x2: i32,
+    y2: i32,
+    segments: u32,
+) {
+    let p = [x1, y1, cx1, cy1, cx2, cy2, x2, y2];
+    submit(v, Shape::BezierCubic { p, segments }, v.draw_color);
+}
+
+/// Draw a filled pill (a rectangle with fully rounded ends, radius `min(w, h) / 2`).
+///
+/// Rasterized as a single span per row, so translucent pills blend once everywhere (no seams
+/// where the caps meet the body). Works for both horizontal and vertical pills.
+pub fn pill(v: &mut VideoState, x: i32, y: i32, w: u32, h: u32) {
+    submit(v, Shape::Pill { x, y, w, h }, v.draw_color);
+}
+
+/// Draw a pill outline.
+pub fn pill_outline(v: &mut VideoState, x: i32, y: i32, w: u32, h: u32) {
+    submit(v, Shape::PillOutline { x, y, w, h }, v.draw_color);
+}
+
+// Rasterizers behind `Shape::draw`. Each writes only the rows of its canvas.
+
+/// Bresenham line written as horizontal runs (one `fill_span` per run of pixels on the same row).
+///
+/// With `include_end == false` the final pixel is left out, so connected segments (outlines,
+/// curves) do not write their shared vertices twice and translucent outlines blend evenly.
+fn line_ex(
+    c: &mut Canvas<'_>,
+    color: u32,
+    mut x0: i32,
+    mut y0: i32,
+    x1: i32,
+    y1: i32,
+    include_end: bool,
+) {
+    // A band only needs the rows it owns; lines entirely above or below it draw nothing.
+    if y0.max(y1) < c.y0 || y0.min(y1) >= c.y1 {
+        return;
+    }
+
+    let dx = (x1 - x0).abs();
+    let dy = -(y1 - y0).abs();
+    let sx = if x0 < x1 { 1 } else { -1 };
+    let sy = if y0 < y1 { 1 } else { -1 };
+    let mut err = dx + dy;
+    let mut run_x = x0;
+
+    loop {
+        if x0 == x1 && y0 == y1 {
+            if include_end {
+                c.hspan(y0, run_x, x0, color);
+            } else if run_x != x0 {
+                c.hspan(y0, run_x, x0 - sx, color);
+            }
+            break;
+        }
+
+        let (px, py) = (x0, y0);
+        let e2 = 2 * err;
+        if e2 >= dy {
+            err += dy;
+            x0 += sx;
+        }
+        if e2 <= dx {
+            err += dx;
+            y0 += sy;
+        }
+        if y0 != py {
+            c.hspan(py, run_x, px, color);
+            run_x = x0;
+        }
+    }
+}
+
+fn draw_rect(c: &mut Canvas<'_>, color: u32, x: i32, y: i32, w: u32, h: u32) {
+    for row in y.max(c.y0)..(y + h as i32).min(c.y1) {
+        c.span(row, x, x + w as i32, color);
+    }
+}
+
+fn draw_rect_outline(c: &mut Canvas<'_>, color: u32, x: i32, y: i32, w: u32, h: u32) {
+    let (x1, y1) = (x + w as i32, y + h as i32);
+    c.hspan(y, x, x1, color);
+    if y1 != y {
+        c.hspan(y1, x, x1, color);
+    }
+    if y1 - y >= 2 {
+        c.vspan(x, y + 1, y1 - 1, color);
+        if x1 != x {
+            c.vspan(x1, y + 1, y1 - 1, color);
+        }
+    }
+}
+
+fn draw_circle(c: &mut Canvas<'_>, color: u32, cx: i32, cy: i32, r: u32) {
+    let r_i32 = r as i32;
+    let r_sq = r as i64 * r as i64;
+
+    for y in (cy - r_i32).max(c.y0)..(cy + r_i32).min(c.y1) {
+        let dy = (y - cy) as i64;
+        let k = isqrt(r_sq - dy * dy) as i32;
+        c.span(y, cx - k, (cx + k + 1).min(cx + r_i32), color);
+    }
+}
+
+fn draw_circle_outline(c: &mut Canvas<'_>, color: u32, cx: i32, cy: i32, r: u32) {
+    let mut point = |x: i32, y: i32| c.span(y, x, x + 1, color);
+    let mut x = 0;
+    let mut y = r as i32;
+    let mut d = 3 - 2 * r as i32;
+
+    while y >= x {
+        // Octant points coincide on the axes (x == 0) and diagonals (x == y); write those once.
+        if x == 0 {
+            point(cx, cy + y);
+            if y != 0 {
+                point(cx, cy - y);
+                point(cx + y, cy);
+                point(cx - y, cy);
+            }
+        } else if x == y {
+            point(cx + x, cy + y);
+            point(cx - x, cy + y);
+            point(cx + x, cy - y);
+            point(cx - x, cy - y);
+        } else {
+            point(cx + x, cy + y);
+            point(cx - x, cy + y);
+            point(cx + x, cy - y);
+            point(cx - x, cy - y);
+            point(cx + y, cy + x);
+            point(cx - y, cy + x);
+            point(cx + y, cy - x);
+            point(cx - y, cy - x);
+        }
+
+        x += 1;
+        if d > 0 {
+            y -= 1;
+            d = d + 4 * (x - y) + 10;
+        } else {
+            d = d + 4 * x + 6;
+        }
+    }
+}
+
+fn draw_triangle(c: &mut Canvas<'_>, color: u32, [x1, y1, x2, y2, x3, y3]: [i32; 6]) {
+    let w = c.width;
+    if w <= 0 || c.y0 >= c.y1 {
+        return;
+    }
+
+    // Use 2x fixed-point coordinates so we can represent pixel centers as integers.
+    // A pixel center at (x + 0.5, y + 0.5) becomes P2 = (2x + 1, 2y + 1).
+    let v0 = (x1 * 2, y1 * 2);
+    let v1 = (x2 * 2, y2 * 2);
+    let v2 = (x3 * 2, y3 * 2);
+
+    // Degenerate (area==0): nothing to fill.
+    let area = tri_edge(v0, v1, v2);
+    if area == 0 {
+        return;
+    }
+
+    // Bounding box in pixel coordinates (inclusive), computed from the triangle vertices and
+    // clipped to the canvas. We convert from 2x space back into pixel indices.
+    let min_x = ((v0.0.min(v1.0).min(v2.0)) >> 1).max(0);
+    let max_x = ((v0.0.max(v1.0).max(v2.0)) >> 1).min(w - 1);
+    let min_y = ((v0.1.min(v1.1).min(v2.1)) >> 1).max(c.y0);
+    let max_y = ((v0.1.max(v1.1).max(v2.1)) >> 1).min(c.y1 - 1);
+
+    if min_x > max_x || min_y > max_y {
+        return;
+    }
+
+    // Make the edge tests winding-invariant by normalizing the edge function
+    // values to the same sign (i.e. as if the triangle had positive area).
+    //
+    // IMPORTANT: The sign normalization must match the sign of the triangle's own
+    // area under the *same* (a,b,c) ordering used by `tri_edge(a,b,c)`.
+    let sign = if area > 0 { 1 } else { -1 };
+
+    // For point-in-triangle, the consistent set of directed edges is v0->v1, v1->v2, v2->v0
+    // (`tri_edge(a, b, c)` is a left-of test for a->b at c).
+    let edges = [(v0, v1), (v1, v2), (v2, v0)];
+
+    for y in min_y..=max_y {
+        let py = y * 2 + 1;
+        let (mut lo, mut hi) = (min_x as i64, max_x as i64);
+
+        for &(a, b) in &edges {
+            // Along the row the edge value at pixel x is `step * x + at0`.
+            let at0 = tri_edge(a, b, (1, py)) * sign;
+            let step = 2 * (b.1 - a.1) as i64 * sign;
+            if step > 0 {
+                // x >= ceil(-at0 / step)
+                lo = lo.max(-(at0.div_euclid(step)));
+            } else if step < 0 {
+                // x <= floor(at0 / -step)
+                hi = hi.min(at0.div_euclid(-step));
+            } else if at0 < 0 {
+                lo = hi + 1;
+            }
+        }
+
+        if lo <= hi {
+            c.span(y, lo as i32, hi as i32 + 1, color);
+        }
+    }
+}
+
+fn draw_bezier_quadratic(c: &mut Canvas<'_>, color: u32, p: [i32; 6], segments: u32) {
+    if segments == 0 {
+        return;
+    }
+    let [x1, y1, cx, cy, x2, y2] = p.map(|v| v as f32);
+    let mut prev_x = x1;
+    let mut prev_y = y1;
+    for i in 1..=segments {
+        let t = i as f32 / segments as f32;
+        let x = (1.0 - t).powi(2) * x1 + 2.0 * (1.0 - t) * t * cx + t.powi(2) * x2;
+        let y = (1.0 - t).powi(2) * y1 + 2.0 * (1.0 - t) * t * cy + t.powi(2) * y2;
+        let last = i == segments;
+        line_ex(
+            c,
+            color,
+            prev_x as i32,
+            prev_y as i32,
+            x as i32,
+            y as i32,
+            last,
+        );
+        prev_x = x;
+        prev_y = y;
+    }
+}
+
+fn draw_bezier_cubic(c: &mut Canvas<'_>, color: u32, p: [i32; 8], segments: u32) {
+    if segments == 0 {
+        return;
+    }
+    let [x1, y1, cx1, cy1, cx2, cy2, x2, y2] = p.map(|v| v as f32);
+    let mut prev_x = x1;
+    let mut prev_y = y1;
+    for i in 1..=segments {
+        let t = i as f32 / segments as f32;
+        let x = (1.0 - t).powi(3) * x1
+            + 3.0 * (1.0 - t).powi(2) * t * cx1
+            + 3.0 * (1.0 - t) * t.powi(2) * cx2
+            + t.powi(3) * x2;
+        let y = (1.0 - t).powi(3) * y1
+            + 3.0 * (1.0 - t).powi(2) * t * cy1
+            + 3.0 * (1.0 - t) * t.powi(2) * cy2
+            + t.powi(3) * y2;
+        let last = i == segments;
+        line_ex(
+            c,
+            color,
+            prev_x as i32,
+            prev_y as i32,
+            x as i32,
+            y as i32,
+            last,
+        );
+        prev_x = x;
+        prev_y = y;
+    }
+}
+
+fn draw_pill(c: &mut Canvas<'_>, color: u32, x: i32, y: i32, w: u32, h: u32) {
+    if w == 0 || h == 0 {
+        return;
+    }
+    let r = (w.min(h) / 2) as i32;
+    let (x_end, y_end) = (x + w as i32, y + h as i32);
+
+    // Cap centers: left/right for horizontal pills, top/bottom for vertical ones.
+    let (cx_left, cx_right) = (x + r, x_end - r);
+    let (cy_top, cy_bottom) = (y + r, y_end - r);
+    let r_sq = r as i64 * r as i64;
+
+    for row_y in y.max(c.y0)..y_end.min(c.y1) {
+        let dy = if row_y < cy_top {
+            row_y - cy_top
+        } else if row_y >= cy_bottom {
+            row_y - cy_bottom
+        } else {
+            0
+        };
+        let k = isqrt(r_sq - dy as i64 * dy as i64) as i32;
+        let lo = (cx_left - k).max(x);
+        let hi = (cx_right + k + 1).min(x_end);
+        c.span(row_y, lo, hi, color);
+    }
+}
+
+fn draw_pill_outline(c: &mut Canvas<'_>, color: u32, x: i32, y: i32, w: u32, h: u32) {
+    if w == 0 || h == 0 {
+        return;
+    }
+    let r = (w.min(h) / 2) as i32;
+    // Outline center rect
+    draw_rect_outline(c, color, x + r, y, w - 2 * r as u32, h);
+    // Outline left cap
+    draw_circle_outline(c, color, x + r, y + r, r as u32);
+    // Outline right cap
+    draw_circle_outline(c, color, x + w as i32 - r, y + r, r as u32);
+}
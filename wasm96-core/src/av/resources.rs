@@ -7,11 +7,20 @@ use fontdue::Font;
 // External crates for asset decoding
 use resvg::usvg::Tree;
 use std::collections::HashMap;
-use std::sync::Mutex;
+use std::sync::Arc;
 
 // Storage ABI helpers
 use alloc::vec::Vec;
 
+use crate::profile::TimedMutex;
+
+use super::draw_lists::DrawList;
+use super::gif_stream::GifStream;
+use super::glyph_cache::GlyphCache;
+use super::svg_cache::SvgCache;
+use super::text_layout::TextLayoutCache;
+use super::tilemap::Tilemap;
+
 // Embedded Spleen font data
 pub static SPLEEN_5X8: &[u8] = include_bytes!("../assets/spleen-5x8.bdf");
 pub static SPLEEN_8X16: &[u8] = include_bytes!("../assets/spleen-8x16.bdf");
@@ -21,14 +30,15 @@ pub static SPLEEN_32X64: &[u8] = include_bytes!("../assets/spleen-32x64.bdf");
 
 // Global resource storage (lazy_static or similar, but using Mutex for simplicity)
 lazy_static::lazy_static! {
-    pub static ref RESOURCES: Mutex<Resources> = Mutex::new(Resources::default());
+    pub static ref RESOURCES: TimedMutex<Resources> = TimedMutex::new(Resources::default());
 }
 
 #[derive(Default)]
 pub struct Resources {
     // ID-based resources (existing APIs in this module).
     pub svgs: HashMap<u32, Tree>,
-    pub gifs: HashMap<u32, GifResource>,
+    // Compressed GIFs, frames decoded on demand (see `gif_stream`).
+    pub gifs: HashMap<u32, GifStream>,
     pub fonts: HashMap<u32, FontResource>,
 
     // Keyed indirection (new): map u64 keys (hashed strings) -> ids in the above maps.
@@ -40,19 +50,32 @@ pub struct Resources {
 
     pub keyed_fonts: HashMap<u64, u32>,
 
-    pub next_id: u32,
-}
+    // Rasterized TTF/OTF glyphs, keyed by (font id, char, px).
+    pub glyph_cache: GlyphCache,
+
+    // Laid-out text runs, keyed by (font id, px, text).
+    pub text_layouts: TextLayoutCache,
 
-pub struct GifResource {
-    pub frames: Vec<Vec<u8>>, // RGBA data per frame
-    pub delays: Vec<u16>,     // in 10ms units
-    pub width: u16,
-    pub height: u16,
+    // Rendered SVGs, keyed by (svg id, w, h).
+    pub svg_cache: SvgCache,
+
+    // Tilemap layers (each with its own cache of rendered chunks).
+    pub tilemaps: HashMap<u64, Tilemap>,
+
+    // Retained draw lists (`wasm96_graphics_list_*`).
+    pub draw_lists: HashMap<u64, DrawList>,
+
+    // Host font id of the built-in Spleen 16 used when a text call names an unregistered key.
+    // Loaded once on first use instead of on every call.
+    pub spleen_fallback: Option<u32>,
+
+    pub next_id: u32,
 }
 
 #[derive(Clone)]
 pub struct ImageResource {
-    pub rgba: Vec<u8>, // RGBA8888 bytes
+    /// RGBA8888 bytes, shared with any blits still recorded from the image.
+    pub rgba: Arc<[u8]>,
     pub width: u32,
     pub height: u32,
 }
@@ -0,0 +1,282 @@
+//! Sprite batches (`wasm96_graphics_sprite_batch`) and the blits they share with keyed images
+//! and TTF text.
+//!
+//! Drawing hundreds of sprites with `wasm96_graphics_png_draw_key_scaled` costs one import call,
+//! one resource lookup and two lock acquisitions per sprite. A sprite batch names one keyed image
+//! and an array of instances in guest memory (layout in `abi::sprites`); the image is resolved
+//! once and every instance is submitted under a single lock.
+//!
+//! Each instance selects a source sub-rectangle (so a sprite sheet can be one registered image),
+//! a destination rectangle (nearest-neighbor scaled), optional flips and a multiplicative tint.
+//! Pixels are composited source-over into the premultiplied framebuffer (see `raster`).
+//!
+//! An instance resolved against its texels is a `Blit`. Keyed image draws and TTF glyphs (8-bit
+//! coverage from the glyph cache, painted in the text color) are blits too. `submit` treats them
+//! like shapes: damage is recorded, and a deferred frame appends them to the display list, so
+//! they need no resolve barrier and `gpu2d` can draw them as textured quads. Texels are shared
+//! (`Arc`), so recording a blit never copies the image.
+
+use std::sync::Arc;
+
+use wasmtime::Caller;
+
+use crate::abi::sprites::{FLIP_X, FLIP_Y, SPRITE_SIZE, TINT_NONE};
+use crate::state::{DamageRect, VideoState};
+
+use super::graphics::lock_state;
+use super::raster::{Canvas, put_texel};
+use super::resources::{ImageResource, RESOURCES};
+
+/// One decoded `wasm96_sprite_t`.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Sprite {
+    pub x: i32,
+    pub y: i32,
+    pub w: u32,
+    pub h: u32,
+    pub src_x: u32,
+    pub src_y: u32,
+    pub src_w: u32,
+    pub src_h: u32,
+    pub flags: u32,
+    pub tint: u32,
+}
+
+impl Sprite {
+    /// Decode one record of `SPRITE_SIZE` little-endian bytes.
+    pub fn from_le_bytes(bytes: &[u8]) -> Self {
+        let word = |i: usize| {
+            let o = i * 4;
+            u32::from_le_bytes([bytes[o], bytes[o + 1], bytes[o + 2], bytes[o + 3]])
+        };
+        Self {
+            x: word(0) as i32,
+            y: word(1) as i32,
+            w: word(2),
+            h: word(3),
+            src_x: word(4),
+            src_y: word(5),
+            src_w: word(6),
+            src_h: word(7),
+            flags: word(8),
+            tint: word(9),
+        }
+    }
+
+    /// The whole image at (`x`, `y`), `w`x`h` (natural size if either is 0), untinted.
+    pub fn image(x: i32, y: i32, w: u32, h: u32) -> Self {
+        Self {
+            x,
+            y,
+            w,
+            h,
+            src_x: 0,
+            src_y: 0,
+            src_w: 0,
+            src_h: 0,
+            flags: 0,
+            tint: TINT_NONE,
+        }
+    }
+}
+
+/// A sprite instance resolved against its texels, drawn now or from the display list.
+#[derive(Clone, Debug)]
+pub struct Blit {
+    /// Straight-alpha RGBA8888, or one coverage byte per texel when `coverage` is set.
+    pub texels: Arc<[u8]>,
+    pub coverage: bool,
+    /// Texture size in texels; rows are tightly packed.
+    pub width: u32,
+    pub height: u32,
+    /// Source rect clamped to the texture and destination size filled in, both non-empty.
+    /// Coverage texels are always painted in `tint`.
+    pub sprite: Sprite,
+}
+
+impl Blit {
+    /// Resolve `sp` against a `width`x`height` texture, or `None` if it draws nothing.
+    pub fn new(
+        texels: &Arc<[u8]>,
+        coverage: bool,
+        width: u32,
+        height: u32,
+        sp: &Sprite,
+    ) -> Option<Self> {
+        if sp.tint >> 24 == 0 {
+            return None;
+        }
+        // Source sub-rect, clamped to the texture. A zero width or height selects all of it.
+        let (src_x, src_y, src_w, src_h) = if sp.src_w == 0 || sp.src_h == 0 {
+            (0, 0, width, height)
+        } else {
+            (sp.src_x, sp.src_y, sp.src_w, sp.src_h)
+        };
+        if src_x >= width || src_y >= height {
+            return None;
+        }
+        let src_w = src_w.min(width - src_x);
+        let src_h = src_h.min(height - src_y);
+        let bytes = if coverage { 1 } else { 4 };
+        if src_w == 0 || src_h == 0 || texels.len() < width as usize * height as usize * bytes {
+            return None;
+        }
+        // Destination rect, natural size if either dimension is 0.
+        let (w, h) = if sp.w == 0 || sp.h == 0 {
+            (src_w, src_h)
+        } else {
+            (sp.w, sp.h)
+        };
+        let sprite = Sprite {
+            w,
+            h,
+            src_x,
+            src_y,
+            src_w,
+            src_h,
+            ..*sp
+        };
+        Some(Self {
+            texels: Arc::clone(texels),
+            coverage,
+            width,
+            height,
+            sprite,
+        })
+    }
+
+    /// Destination rect as `(x0, y0, x1, y1)`, unclipped.
+    pub fn bounds(&self) -> (i32, i32, i32, i32) {
+        let sp = &self.sprite;
+        let x1 = (sp.x as i64 + sp.w as i64).min(i32::MAX as i64) as i32;
+        let y1 = (sp.y as i64 + sp.h as i64).min(i32::MAX as i64) as i32;
+        (sp.x, sp.y, x1, y1)
+    }
+
+    /// 16.16 source steps per destination pixel, across and down.
+    pub fn steps(&self) -> (u64, u64) {
+        let sp = &self.sprite;
+        (
+            ((sp.src_w as u64) << 16) / sp.w as u64,
+            ((sp.src_h as u64) << 16) / sp.h as u64,
+        )
+    }
+
+    /// Composite the part of the blit inside `c`.
+    pub fn draw(&self, c: &mut Canvas<'_>) {
+        let sp = &self.sprite;
+        let (x0, y0, x1, y1) = self.bounds();
+        let (x0, x1) = (x0.max(0), x1.min(c.width));
+        let (y0, y1) = (y0.max(c.y0), y1.min(c.y1));
+        if x0 >= x1 || y0 >= y1 {
+            return;
+        }
+
+        let (step_x, step_y) = self.steps();
+        let flip_x = sp.flags & FLIP_X != 0;
+        let flip_y = sp.flags & FLIP_Y != 0;
+        let tinted = sp.tint != TINT_NONE;
+        let rgb_tint = sp.tint & 0x00FF_FFFF;
+        let [tint_b, tint_g, tint_r, tint_a] = sp.tint.to_le_bytes().map(u32::from);
+
+        let texels = &*self.texels;
+        let u_start = (x0 as i64 - sp.x as i64) as u64 * step_x;
+        for y in y0..y1 {
+            let dy = (y as i64 - sp.y as i64) as u64;
+            let mut row = ((dy * step_y) >> 16).min(sp.src_h as u64 - 1) as u32;
+            if flip_y {
+                row = sp.src_h - 1 - row;
+            }
+            let src_row = (sp.src_y + row) as usize * self.width as usize + sp.src_x as usize;
+            let dst_row = (y - c.y0) as usize * c.width as usize;
+            let dst = &mut c.pixels[dst_row + x0 as usize..dst_row + x1 as usize];
+
+            let mut u = u_start;
+            for d in dst {
+                let mut col = ((u >> 16) as u32).min(sp.src_w - 1);
+                u += step_x;
+                if flip_x {
+                    col = sp.src_w - 1 - col;
+                }
+                let i = src_row + col as usize;
+                if self.coverage {
+                    put_texel(d, rgb_tint, mul8(texels[i] as u32, tint_a));
+                    continue;
+                }
+                let [mut r, mut g, mut b, mut a] = [0, 1, 2, 3].map(|k| texels[i * 4 + k] as u32);
+                if tinted {
+                    r = mul8(r, tint_r);
+                    g = mul8(g, tint_g);
+                    b = mul8(b, tint_b);
+                    a = mul8(a, tint_a);
+                }
+                put_texel(d, (r << 16) | (g << 8) | b, a);
+            }
+        }
+    }
+}
+
+/// Draw `blit`: record its damage, then composite it now, or append it to the display list if
+/// this frame is deferred (see `tiles.rs`), like `raster::submit` does for shapes.
+pub fn submit(v: &mut VideoState, blit: Blit) {
+    let (x0, y0, x1, y1) = blit.bounds();
+    v.mark_damage(x0, y0, x1, y1);
+    if v.display_list.is_deferred() {
+        let rect = DamageRect::clipped(x0, y0, x1, y1, v.width, v.height);
+        v.display_list.push_blit(blit, rect);
+    } else {
+        blit.draw(&mut Canvas::full(v));
+    }
+}
+
+/// Draw `count` sprites stored in guest memory from the keyed image `image_key`.
+///
+/// Returns the number of sprites processed: `0` if the image is not registered or the array is
+/// out of bounds.
+pub fn graphics_sprite_batch(
+    caller: &mut Caller<'_, ()>,
+    image_key: u64,
+    ptr: u32,
+    count: u32,
+) -> u32 {
+    let memory = match caller.get_export("memory").and_then(|e| e.into_memory()) {
+        Some(m) => m,
+        None => return 0,
+    };
+
+    let data = memory.data(&*caller);
+    let start = ptr as usize;
+    let Some(end) = (count as usize)
+        .checked_mul(SPRITE_SIZE)
+        .and_then(|len| start.checked_add(len))
+    else {
+        return 0;
+    };
+    let Some(bytes) = data.get(start..end) else {
+        return 0;
+    };
+
+    // Lock order: RESOURCES before the global state.
+    let res = RESOURCES.lock().unwrap();
+    let Some(img) = res.keyed_images.get(&image_key) else {
+        return 0;
+    };
+    let mut s = lock_state();
+    for record in bytes.chunks_exact(SPRITE_SIZE) {
+        draw_sprite(&mut s.video, img, &Sprite::from_le_bytes(record));
+    }
+    count
+}
+
+/// Multiply two 8-bit channels (`255 * 255 = 255`).
+#[inline(always)]
+fn mul8(a: u32, b: u32) -> u32 {
+    (a * b + 127) / 255
+}
+
+/// Submit one sprite instance drawn from `img`.
+pub fn draw_sprite(v: &mut VideoState, img: &ImageResource, sp: &Sprite) {
+    if let Some(blit) = Blit::new(&img.rgba, false, img.width, img.height, sp) {
+        submit(v, blit);
+    }
+}
@@ -1,8 +1,9 @@
 // Needed for `alloc::` in this crate.
 extern crate alloc;
 
+use crate::abi::storage::NOT_FOUND;
 use crate::state::global;
-use wasmtime::Caller;
+use wasmtime::{Caller, Extern};
 
 // External crates for rendering
 
@@ -11,6 +12,16 @@ use wasmtime::Caller;
 // Storage ABI helpers
 use super::utils::{guest_alloc, guest_free};
 
+/// Make storage persistent: replay the journal at `path` into the store (replacing its contents)
+/// and journal every later mutation to it. The journal is flushed and closed on unload.
+pub fn storage_open(path: &std::path::Path) -> std::io::Result<()> {
+    let (journal, kv) = super::storage_log::Journal::open(path)?;
+    let mut s = global().lock().unwrap();
+    s.storage.kv = kv;
+    s.storage.journal = Some(journal);
+    Ok(())
+}
+
 pub fn storage_save(env: &mut Caller<'_, ()>, key: u64, data_ptr: u32, data_len: u32) {
     // Read guest memory pointers
     let memory_ptr = {
@@ -24,13 +35,42 @@ pub fn storage_save(env: &mut Caller<'_, ()>, key: u64, data_ptr: u32, data_len:
     // SAFETY: memory pointer checked.
     let mem = unsafe { &*memory_ptr };
 
-    let mut data = vec![0u8; data_len as usize];
-    if mem.read(&mut *env, data_ptr as usize, &mut data).is_err() {
+    // Copied once, straight into the buffer the store and the journal share.
+    let start = data_ptr as usize;
+    let Some(data) = mem.data(&*env).get(start..start + data_len as usize) else {
         return;
-    }
+    };
+    let data: std::sync::Arc<[u8]> = data.into();
+    crate::profile::bytes_in(data.len());
 
     let mut s = global().lock().unwrap();
-    s.storage.kv.insert(key, data);
+    s.storage.put(key, data);
+}
+
+/// Write `len` bytes from guest memory at `src_ptr` into `key`'s value at byte `offset`,
+/// creating the key or zero-extending the value as needed.
+///
+/// Only the written range is copied (and journaled when storage is persistent), so patching one
+/// field of a large save blob does not rewrite the blob.
+pub fn storage_write(env: &mut Caller<'_, ()>, key: u64, offset: u32, src_ptr: u32, len: u32) {
+    let Some(Extern::Memory(memory)) = env.get_export("memory") else {
+        return;
+    };
+    storage_write_from(memory.data(&*env), key, offset, src_ptr, len);
+}
+
+/// `storage_write` against a guest memory slice. Out-of-bounds sources are ignored.
+pub fn storage_write_from(memory: &[u8], key: u64, offset: u32, src_ptr: u32, len: u32) {
+    let start = src_ptr as usize;
+    let Some(src) = memory.get(start..start + len as usize) else {
+        return;
+    };
+    if offset.checked_add(len).is_none() {
+        return;
+    }
+    crate::profile::bytes_in(src.len());
+    let mut s = global().lock().unwrap();
+    s.storage.write(key, offset, src);
 }
 
 pub fn storage_load(env: &mut Caller<'_, ()>, key: u64) -> u64 {
@@ -64,6 +104,7 @@ pub fn storage_load(env: &mut Caller<'_, ()>, key: u64) -> u64 {
         guest_free(env, dst_ptr, data.len() as u32);
         return 0;
     }
+    crate::profile::bytes_out(data.len());
 
     ((dst_ptr as u64) << 32) | (data.len() as u64)
 }
@@ -71,3 +112,55 @@ pub fn storage_load(env: &mut Caller<'_, ()>, key: u64) -> u64 {
 pub fn storage_free(env: &mut Caller<'_, ()>, ptr: u32, len: u32) {
     guest_free(env, ptr, len);
 }
+
+/// Length of the value stored under `key`, or `NOT_FOUND`.
+pub fn storage_size(key: u64) -> u32 {
+    let s = global().lock().unwrap();
+    match s.storage.kv.get(&key) {
+        Some(v) => v.len().min(NOT_FOUND as usize - 1) as u32,
+        None => NOT_FOUND,
+    }
+}
+
+/// Copy up to `dst_cap` bytes of `key`'s value, starting at byte `offset`, into guest memory at
+/// `dst_ptr`.
+///
+/// Copies straight out of the map into the caller's buffer: no clone and no guest allocation, so
+/// guests without an allocator export can load. Returns the number of bytes copied (0 when
+/// `offset` is at or past the end, or the destination is not in guest memory), or `NOT_FOUND`.
+pub fn storage_read(
+    env: &mut Caller<'_, ()>,
+    key: u64,
+    dst_ptr: u32,
+    dst_cap: u32,
+    offset: u32,
+) -> u32 {
+    let Some(Extern::Memory(memory)) = env.get_export("memory") else {
+        return 0;
+    };
+    storage_read_into(memory.data_mut(&mut *env), key, dst_ptr, dst_cap, offset)
+}
+
+/// `storage_read` against a guest memory slice.
+pub fn storage_read_into(
+    memory: &mut [u8],
+    key: u64,
+    dst_ptr: u32,
+    dst_cap: u32,
+    offset: u32,
+) -> u32 {
+    let s = global().lock().unwrap();
+    let Some(value) = s.storage.kv.get(&key) else {
+        return NOT_FOUND;
+    };
+    let src = value.get(offset as usize..).unwrap_or(&[]);
+    let n = src.len().min(dst_cap as usize);
+
+    let start = dst_ptr as usize;
+    let Some(dst) = memory.get_mut(start..start + n) else {
+        return 0;
+    };
+    dst.copy_from_slice(&src[..n]);
+    crate::profile::bytes_out(n);
+    n as u32
+}
@@ -0,0 +1,564 @@
+//! Persistent backing for the storage key/value store.
+//!
+//! The in-memory map in `state::StorageState` stays the source of truth for reads; this module
+//! makes it durable. Every mutation is sent, as a small record, to a writer thread that appends
+//! it to a journal file in the frontend's save directory:
+//! - The frame thread never touches the disk: `Journal::put`/`write`/`remove` only queue a
+//!   record on a channel. A `put` queues the map's own shared buffer, not a copy.
+//! - The writer waits `COALESCE` after the first record of a burst, drops records superseded by a
+//!   later `put`/`remove` of the same key (an autosave rewriting one slot every frame costs one
+//!   record), appends the survivors in one write and `fdatasync`s once.
+//! - `wasm96_storage_write` becomes a `WRITE` record of just the changed range, so patching a
+//!   large save does not rewrite it.
+//! - When the journal grows past twice the live data (and `COMPACT_MIN_BYTES`), the writer
+//!   rewrites it as one `PUT` per key into a temp file and renames it over the journal.
+//!
+//! File format: `MAGIC`, `VERSION: u32`, then records of
+//! `kind: u8, key: u64, offset: u32, len: u32, data[len], check: u32` (little-endian; `check` is
+//! FNV-1a over everything before it). Replay stops at the first short or corrupt record and
+//! truncates the file there, so a crash mid-append loses only the unfinished batch.
+
+use std::collections::{HashMap, HashSet};
+use std::fs::{File, OpenOptions};
+use std::io::{self, Read, Seek, SeekFrom, Write};
+use std::path::{Path, PathBuf};
+use std::sync::Arc;
+use std::sync::mpsc::{self, Receiver, RecvTimeoutError, Sender};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant};
+
+const MAGIC: [u8; 4] = *b"W96L";
+const VERSION: u32 = 1;
+const HEADER_BYTES: usize = 8;
+const RECORD_OVERHEAD: usize = 1 + 8 + 4 + 4 + 4;
+
+const KIND_PUT: u8 = 1;
+const KIND_WRITE: u8 = 2;
+const KIND_REMOVE: u8 = 3;
+
+/// How long the writer waits for more records after the first one of a burst.
+const COALESCE: Duration = Duration::from_millis(250);
+/// Journals smaller than this are never compacted.
+const COMPACT_MIN_BYTES: u64 = 1 << 20;
+
+#[derive(Debug, Clone, PartialEq, Eq)]
+enum Record {
+    Put {
+        key: u64,
+        data: Arc<[u8]>,
+    },
+    Write {
+        key: u64,
+        offset: u32,
+        data: Vec<u8>,
+    },
+    Remove {
+        key: u64,
+    },
+}
+
+impl Record {
+    fn key(&self) -> u64 {
+        match *self {
+            Record::Put { key, .. } | Record::Write { key, .. } | Record::Remove { key } => key,
+        }
+    }
+
+    fn apply(self, map: &mut HashMap<u64, Vec<u8>>) {
+        match self {
+            Record::Put { key, data } => {
+                map.insert(key, data.to_vec());
+            }
+            Record::Write { key, offset, data } => {
+                write_range(map.entry(key).or_default(), offset, &data)
+            }
+            Record::Remove { key } => {
+                map.remove(&key);
+            }
+        }
+    }
+
+    fn encode(&self, out: &mut Vec<u8>) {
+        match self {
+            Record::Put { key, data } => encode(out, KIND_PUT, *key, 0, data),
+            Record::Write { key, offset, data } => encode(out, KIND_WRITE, *key, *offset, data),
+            Record::Remove { key } => encode(out, KIND_REMOVE, *key, 0, &[]),
+        }
+    }
+
+    /// Decode one record from the front of `bytes`; returns it and its encoded length.
+    fn decode(bytes: &[u8]) -> Option<(Record, usize)> {
+        let head = bytes.get(..1 + 8 + 4 + 4)?;
+        let kind = head[0];
+        let key = u64::from_le_bytes(head[1..9].try_into().ok()?);
+        let offset = u32::from_le_bytes(head[9..13].try_into().ok()?);
+        let len = u32::from_le_bytes(head[13..17].try_into().ok()?) as usize;
+        let body_end = 17usize.checked_add(len)?;
+        let data = bytes.get(17..body_end)?;
+        let check = u32::from_le_bytes(bytes.get(body_end..body_end + 4)?.try_into().ok()?);
+        if fnv1a(&bytes[..body_end]) != check {
+            return None;
+        }
+        let record = match kind {
+            KIND_PUT => Record::Put {
+                key,
+                data: data.into(),
+            },
+            KIND_WRITE => Record::Write {
+                key,
+                offset,
+                data: data.to_vec(),
+            },
+            KIND_REMOVE => Record::Remove { key },
+            _ => return None,
+        };
+        Some((record, body_end + 4))
+    }
+}
+
+/// Append one record (kind, key, offset, data and checksum) to `out`.
+fn encode(out: &mut Vec<u8>, kind: u8, key: u64, offset: u32, data: &[u8]) {
+    let start = out.len();
+    out.push(kind);
+    out.extend_from_slice(&key.to_le_bytes());
+    out.extend_from_slice(&offset.to_le_bytes());
+    out.extend_from_slice(&(data.len() as u32).to_le_bytes());
+    out.extend_from_slice(data);
+    let check = fnv1a(&out[start..]);
+    out.extend_from_slice(&check.to_le_bytes());
+}
+
+fn fnv1a(bytes: &[u8]) -> u32 {
+    let mut hash = 0x811c_9dc5u32;
+    for &b in bytes {
+        hash ^= b as u32;
+        hash = hash.wrapping_mul(0x0100_0193);
+    }
+    hash
+}
+
+/// Write `data` at `offset` in `value`, zero-extending it as needed.
+pub fn write_range(value: &mut Vec<u8>, offset: u32, data: &[u8]) {
+    let start = offset as usize;
+    let end = start + data.len();
+    if value.len() < end {
+        value.resize(end, 0);
+    }
+    value[start..end].copy_from_slice(data);
+}
+
+enum Msg {
+    Record(Record),
+    Flush(Sender<()>),
+}
+
+/// Handle to an open journal and its writer thread. Dropping it flushes and closes the journal.
+pub struct Journal {
+    tx: Option<Sender<Msg>>,
+    writer: Option<JoinHandle<()>>,
+    path: PathBuf,
+}
+
+impl std::fmt::Debug for Journal {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("Journal").field("path", &self.path).finish()
+    }
+}
+
+impl Journal {
+    /// Open (or create) the journal at `path`, replaying it into the returned map, and start its
+    /// writer thread.
+    pub fn open(path: &Path) -> io::Result<(Journal, HashMap<u64, Arc<[u8]>>)> {
+        if let Some(dir) = path.parent() {
+            std::fs::create_dir_all(dir)?;
+        }
+        let mut file = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .create(true)
+            .truncate(false)
+            .open(path)?;
+
+        let mut bytes = Vec::new();
+        file.read_to_end(&mut bytes)?;
+        let (map, valid_len) = replay(&bytes);
+        if valid_len != bytes.len() as u64 || bytes.is_empty() {
+            // Torn tail (or a new file): cut back to the last whole record.
+            file.set_len(valid_len)?;
+            if valid_len == 0 {
+                file.seek(SeekFrom::Start(0))?;
+                file.write_all(&MAGIC)?;
+                file.write_all(&VERSION.to_le_bytes())?;
+                file.sync_data()?;
+            }
+        }
+        let log_len = valid_len.max(HEADER_BYTES as u64);
+        file.seek(SeekFrom::Start(log_len))?;
+
+        let (tx, rx) = mpsc::channel();
+        let live = map
+            .iter()
+            .map(|(&k, v)| (k, Arc::from(v.as_slice())))
+            .collect();
+        let mirror = map;
+        let writer_path = path.to_path_buf();
+        let writer = std::thread::Builder::new()
+            .name("wasm96-storage".into())
+            .spawn(move || {
+                Writer {
+                    file,
+                    path: writer_path,
+                    log_len,
+                    mirror,
+                    retry: Vec::new(),
+                }
+                .run(rx)
+            })?;
+
+        Ok((
+            Journal {
+                tx: Some(tx),
+                writer: Some(writer),
+                path: path.to_path_buf(),
+            },
+            live,
+        ))
+    }
+
+    pub fn path(&self) -> &Path {
+        &self.path
+    }
+
+    fn send(&self, msg: Msg) {
+        if let Some(tx) = &self.tx {
+            let _ = tx.send(msg);
+        }
+    }
+
+    /// Queue replacing `key`'s value with `data`.
+    pub fn put(&self, key: u64, data: Arc<[u8]>) {
+        self.send(Msg::Record(Record::Put { key, data }));
+    }
+
+    /// Queue writing `data` at `offset` in `key`'s value.
+    pub fn write(&self, key: u64, offset: u32, data: Vec<u8>) {
+        self.send(Msg::Record(Record::Write { key, offset, data }));
+    }
+
+    /// Queue deleting `key`.
+    pub fn remove(&self, key: u64) {
+        self.send(Msg::Record(Record::Remove { key }));
+    }
+
+    /// Block until everything queued so far is on disk.
+    pub fn flush(&self) {
+        let (ack_tx, ack_rx) = mpsc::channel();
+        self.send(Msg::Flush(ack_tx));
+        let _ = ack_rx.recv();
+    }
+}
+
+impl Drop for Journal {
+    fn drop(&mut self) {
+        // Closing the channel makes the writer drain what is queued and exit.
+        self.tx = None;
+        if let Some(writer) = self.writer.take() {
+            let _ = writer.join();
+        }
+    }
+}
+
+/// Replay a journal image. Returns the map and the length of the valid prefix (0 if the header
+/// is missing or wrong).
+fn replay(bytes: &[u8]) -> (HashMap<u64, Vec<u8>>, u64) {
+    let mut map = HashMap::new();
+    if bytes.len() < HEADER_BYTES
+        || bytes[..4] != MAGIC
+        || u32::from_le_bytes(bytes[4..8].try_into().unwrap()) != VERSION
+    {
+        return (map, 0);
+    }
+    let mut pos = HEADER_BYTES;
+    while let Some((record, len)) = Record::decode(&bytes[pos..]) {
+        record.apply(&mut map);
+        pos += len;
+    }
+    (map, pos as u64)
+}
+
+/// Drop records that a later `Put`/`Remove` of the same key makes irrelevant, keeping order.
+fn coalesce(batch: Vec<Record>) -> Vec<Record> {
+    let mut replaced: HashSet<u64> = HashSet::new();
+    let mut kept = Vec::with_capacity(batch.len());
+    for record in batch.into_iter().rev() {
+        let key = record.key();
+        if replaced.contains(&key) {
+            continue;
+        }
+        if !matches!(record, Record::Write { .. }) {
+            replaced.insert(key);
+        }
+        kept.push(record);
+    }
+    kept.reverse();
+    kept
+}
+
+struct Writer {
+    file: File,
+    path: PathBuf,
+    log_len: u64,
+    /// Replica of the live map, for compaction.
+    mirror: HashMap<u64, Vec<u8>>,
+    /// Records of a batch that failed to append, written ahead of the next batch.
+    retry: Vec<Record>,
+}
+
+impl Writer {
+    fn run(mut self, rx: Receiver<Msg>) {
+        let mut open = true;
+        while open {
+            let Ok(first) = rx.recv() else {
+                break;
+            };
+            let mut batch = Vec::new();
+            let mut acks = Vec::new();
+            let mut take = |msg: Msg, acks: &mut Vec<Sender<()>>| match msg {
+                Msg::Record(r) => batch.push(r),
+                Msg::Flush(ack) => acks.push(ack),
+            };
+            take(first, &mut acks);
+
+            // Collect the rest of the burst (a flush request ends the wait early).
+            let deadline = Instant::now() + COALESCE;
+            while acks.is_empty() {
+                match rx.recv_timeout(deadline.saturating_duration_since(Instant::now())) {
+                    Ok(msg) => take(msg, &mut acks),
+                    Err(RecvTimeoutError::Timeout) => break,
+                    Err(RecvTimeoutError::Disconnected) => {
+                        open = false;
+                        break;
+                    }
+                }
+            }
+            while let Ok(msg) = rx.try_recv() {
+                take(msg, &mut acks);
+            }
+
+            if let Err(e) = self.append(batch) {
+                eprintln!("(wasm96) storage journal write failed: {e}");
+            }
+            for ack in acks {
+                let _ = ack.send(());
+            }
+        }
+    }
+
+    fn append(&mut self, batch: Vec<Record>) -> io::Result<()> {
+        let mut records = std::mem::take(&mut self.retry);
+        records.extend(batch);
+        let records = coalesce(records);
+        if records.is_empty() {
+            return Ok(());
+        }
+        let mut buf = Vec::new();
+        for record in &records {
+            record.encode(&mut buf);
+        }
+        if let Err(e) = self
+            .file
+            .write_all(&buf)
+            .and_then(|()| self.file.sync_data())
+        {
+            // Cut off whatever part of the batch reached the file, so later appends do not land
+            // behind a torn record that replay would stop at, and try the batch again next time.
+            let _ = self.file.set_len(self.log_len);
+            let _ = self.file.seek(SeekFrom::Start(self.log_len));
+            self.retry = records;
+            return Err(e);
+        }
+        self.log_len += buf.len() as u64;
+
+        for record in records {
+            record.apply(&mut self.mirror);
+        }
+
+        let live: u64 = self
+            .mirror
+            .values()
+            .map(|v| (v.len() + RECORD_OVERHEAD) as u64)
+            .sum();
+        if self.log_len > COMPACT_MIN_BYTES && self.log_len > 2 * (live + HEADER_BYTES as u64) {
+            self.compact()?;
+        }
+        Ok(())
+    }
+
+    /// Rewrite the journal as one `PUT` per live key.
+    fn compact(&mut self) -> io::Result<()> {
+        let mut buf = Vec::with_capacity(HEADER_BYTES);
+        buf.extend_from_slice(&MAGIC);
+        buf.extend_from_slice(&VERSION.to_le_bytes());
+        let mut keys: Vec<u64> = self.mirror.keys().copied().collect();
+        keys.sort_unstable();
+        for key in keys {
+            encode(&mut buf, KIND_PUT, key, 0, &self.mirror[&key]);
+        }
+
+        let tmp = self.path.with_extension("compact");
+        {
+            let mut f = File::create(&tmp)?;
+            f.write_all(&buf)?;
+            f.sync_data()?;
+        }
+        std::fs::rename(&tmp, &self.path)?;
+
+        let mut file = OpenOptions::new().read(true).write(true).open(&self.path)?;
+        file.seek(SeekFrom::End(0))?;
+        self.file = file;
+        self.log_len = buf.len() as u64;
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn temp_path(name: &str) -> PathBuf {
+        let dir =
+            std::env::temp_dir().join(format!("wasm96-journal-{}-{name}", std::process::id()));
+        let _ = std::fs::remove_dir_all(&dir);
+        dir.join("game.sav")
+    }
+
+    #[test]
+    fn journal_replays_puts_partial_writes_and_removes() {
+        let path = temp_path("replay");
+        {
+            let (journal, map) = Journal::open(&path).unwrap();
+            assert!(map.is_empty());
+            journal.put(1, Arc::from(&b"hello world"[..]));
+            journal.write(1, 6, b"WORLD!".to_vec());
+            journal.put(2, Arc::from([7; 100]));
+            journal.remove(2);
+            journal.write(3, 4, b"x".to_vec());
+        }
+
+        let (_journal, map) = Journal::open(&path).unwrap();
+        assert_eq!(map.get(&1).map(|v| &v[..]), Some(&b"hello WORLD!"[..]));
+        assert!(!map.contains_key(&2));
+        assert_eq!(map.get(&3).map(|v| &v[..]), Some(&b"\0\0\0\0x"[..]));
+        let _ = std::fs::remove_dir_all(path.parent().unwrap());
+    }
+
+    #[test]
+    fn torn_tail_is_truncated_on_open() {
+        let path = temp_path("torn");
+        {
+            let (journal, _) = Journal::open(&path).unwrap();
+            journal.put(1, Arc::from(&b"kept"[..]));
+            journal.flush();
+        }
+        let good_len = std::fs::metadata(&path).unwrap().len();
+
+        // Half a record, as if the process died mid-append.
+        let mut tail = Vec::new();
+        Record::Put {
+            key: 2,
+            data: Arc::from(&b"lost"[..]),
+        }
+        .encode(&mut tail);
+        let mut f = OpenOptions::new().append(true).open(&path).unwrap();
+        f.write_all(&tail[..tail.len() / 2]).unwrap();
+        drop(f);
+
+        let (_journal, map) = Journal::open(&path).unwrap();
+        assert_eq!(map.get(&1).map(|v| &v[..]), Some(&b"kept"[..]));
+        assert!(!map.contains_key(&2));
+        assert_eq!(std::fs::metadata(&path).unwrap().len(), good_len);
+        let _ = std::fs::remove_dir_all(path.parent().unwrap());
+    }
+
+    #[test]
+    fn failed_append_is_retried_with_the_next_batch() {
+        let path = temp_path("retry");
+        drop(Journal::open(&path).unwrap());
+        let mut writer = Writer {
+            // Read-only, so the first append fails without writing anything.
+            file: File::open(&path).unwrap(),
+            path: path.clone(),
+            log_len: HEADER_BYTES as u64,
+            mirror: HashMap::new(),
+            retry: Vec::new(),
+        };
+        let first = Record::Put {
+            key: 1,
+            data: Arc::from(&b"first"[..]),
+        };
+        assert!(writer.append(vec![first]).is_err());
+        assert_eq!(std::fs::metadata(&path).unwrap().len(), HEADER_BYTES as u64);
+
+        let mut file = OpenOptions::new().write(true).open(&path).unwrap();
+        file.seek(SeekFrom::Start(writer.log_len)).unwrap();
+        writer.file = file;
+        let second = Record::Write {
+            key: 1,
+            offset: 0,
+            data: b"F".to_vec(),
+        };
+        writer.append(vec![second]).unwrap();
+        drop(writer);
+
+        let (_journal, map) = Journal::open(&path).unwrap();
+        assert_eq!(map.get(&1).map(|v| &v[..]), Some(&b"First"[..]));
+        let _ = std::fs::remove_dir_all(path.parent().unwrap());
+    }
+
+    #[test]
+    fn coalesce_keeps_only_records_after_the_last_replacement() {
+        let put = |key, byte| Record::Put {
+            key,
+            data: Arc::from([byte]),
+        };
+        let patch = |key| Record::Write {
+            key,
+            offset: 0,
+            data: vec![9],
+        };
+        let batch = vec![
+            put(1, 1),
+            patch(1),
+            put(2, 2),
+            put(1, 3),
+            patch(1),
+            patch(2),
+        ];
+        assert_eq!(
+            coalesce(batch),
+            vec![put(2, 2), put(1, 3), patch(1), patch(2)]
+        );
+    }
+
+    #[test]
+    fn compaction_rewrites_the_journal_to_live_data() {
+        let path = temp_path("compact");
+        {
+            let (journal, _) = Journal::open(&path).unwrap();
+            // Distinct batches (flush between) so coalescing cannot fold them.
+            for i in 0..24u8 {
+                journal.put(1, vec![i; 128 << 10].into());
+                journal.flush();
+            }
+        }
+        let len = std::fs::metadata(&path).unwrap().len();
+        assert!(
+            len < 2 * COMPACT_MIN_BYTES,
+            "journal compacted ({len} bytes)"
+        );
+
+        let (_journal, map) = Journal::open(&path).unwrap();
+        assert_eq!(map[&1][..], vec![23u8; 128 << 10][..]);
+        let _ = std::fs::remove_dir_all(path.parent().unwrap());
+    }
+}
@@ -0,0 +1,84 @@
+//! Rasterized SVG cache.
+//!
+//! `resvg` renders are expensive, and guests typically draw the same SVG (icons, UI art) at the same
+//! size every frame. Rendered pixmaps are cached per `(svg id, width, height)` in framebuffer pixel
+//! format so a cached draw is a straight blit. The cache is bounded by a byte budget
+//! (`wasm96_graphics_svg_set_cache_budget`) and evicts least recently used renders.
+
+use super::lru_cache::LruCache;
+
+/// Default byte budget for cached SVG renders (8 MiB, e.g. ~32 full-screen 320x200 renders).
+pub const DEFAULT_SVG_CACHE_BYTES: usize = 8 << 20;
+
+#[derive(Clone, Copy, PartialEq, Eq, Hash, Debug)]
+pub struct SvgRasterKey {
+    pub svg_id: u32,
+    pub width: u32,
+    pub height: u32,
+}
+
+/// A rendered SVG: `width * height` premultiplied 0xAARRGGBB pixels, row-major.
+pub struct SvgRaster {
+    pub width: u32,
+    pub height: u32,
+    pub pixels: Vec<u32>,
+}
+
+impl SvgRaster {
+    fn cost(&self) -> usize {
+        self.pixels.len() * core::mem::size_of::<u32>() + core::mem::size_of::<Self>()
+    }
+}
+
+pub struct SvgCache {
+    inner: LruCache<SvgRasterKey, SvgRaster>,
+}
+
+impl Default for SvgCache {
+    fn default() -> Self {
+        Self {
+            inner: LruCache::with_budget(DEFAULT_SVG_CACHE_BYTES),
+        }
+    }
+}
+
+impl SvgCache {
+    pub fn get(&mut self, key: &SvgRasterKey) -> Option<&SvgRaster> {
+        self.inner.get(key)
+    }
+
+    pub fn contains_key(&self, key: &SvgRasterKey) -> bool {
+        self.inner.contains_key(key)
+    }
+
+    /// Cache a render. Returns `false` (and drops it) if it alone exceeds the budget.
+    pub fn insert(&mut self, key: SvgRasterKey, raster: SvgRaster) -> bool {
+        let cost = raster.cost();
+        if cost > self.inner.budget_bytes() {
+            return false;
+        }
+        self.inner.insert(key, raster, cost);
+        true
+    }
+
+    /// Drop every cached render of `svg_id` (all sizes).
+    pub fn remove_svg(&mut self, svg_id: u32) {
+        self.inner.retain(|k| k.svg_id != svg_id);
+    }
+
+    pub fn set_budget(&mut self, budget_bytes: usize) {
+        self.inner.set_budget(budget_bytes);
+    }
+
+    pub fn used_bytes(&self) -> usize {
+        self.inner.used_bytes()
+    }
+
+    pub fn len(&self) -> usize {
+        self.inner.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.inner.is_empty()
+    }
+}
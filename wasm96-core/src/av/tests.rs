@@ -3,8 +3,15 @@ extern crate alloc;
 
 #[cfg(test)]
 mod tests {
+    use crate::abi::commands;
+    use crate::abi::sprites;
     use crate::av::audio::audio_init;
-    use crate::av::utils::{graphics_image_from_host, sat_add_i16};
+    use crate::av::commands::execute_commands;
+    use crate::av::glyph_cache::{GlyphCache, GlyphKey};
+    use crate::av::lru_cache::LruCache;
+    use crate::av::raster;
+    use crate::av::sprites::{Sprite, draw_sprite};
+    use crate::av::utils::graphics_image_from_host;
     use crate::av::{graphics_point, graphics_set_color, graphics_set_size, graphics_triangle};
     use crate::state::global;
 
@@ -212,50 +219,31 @@ mod tests {
             // This test must be self-contained:
             // after `reset_state_for_test()` the full global state has been cleared, so we must
             // explicitly initialize audio storage here before mutating it.
-            s.audio.host_queue.clear();
             s.audio.channels.clear();
 
             s.audio.channels.push(crate::state::AudioChannel {
+                id: 1,
                 active: true,
                 volume_q8_8: 256, // 1.0
                 pan_i16: 0,       // centered
                 loop_enabled: false,
-                pcm_stereo,
+                pcm_stereo: pcm_stereo.into(),
+                pcm_key: 0,
+                stream: None,
                 position_frames: 0,
+                position_frac: 0,
                 sample_rate,
             });
 
-            // Mix exactly 1 frame from the channel (mirrors the logic in `audio_drain_host`,
-            // but without depending on a libretro handle).
-            let channel = &mut s.audio.channels[0];
-            let channel_frames = channel.pcm_stereo.len() / 2;
-
-            let start_frame = channel.position_frames;
-            let frames_to_mix = (channel_frames - start_frame).min(1);
-
-            let volume = channel.volume_q8_8 as f32 / 256.0;
-            let pan_left = if channel.pan_i16 <= 0 {
-                1.0
-            } else {
-                (32768 - channel.pan_i16) as f32 / 32768.0
-            };
-            let pan_right = if channel.pan_i16 >= 0 {
-                1.0
-            } else {
-                (32768 + channel.pan_i16) as f32 / 32768.0
-            };
-
-            for i in 0..frames_to_mix {
-                let src_idx = (start_frame + i) * 2;
-                let l = (channel.pcm_stereo[src_idx] as f32 * volume * pan_left) as i16;
-                let r = (channel.pcm_stereo[src_idx + 1] as f32 * volume * pan_right) as i16;
-
-                let dst_idx = i * 2;
-                mixed[dst_idx] = sat_add_i16(mixed[dst_idx], l);
-                mixed[dst_idx + 1] = sat_add_i16(mixed[dst_idx + 1], r);
-            }
-
-            channel.position_frames += frames_to_mix;
+            // Mix exactly 1 frame through the same mixer `audio_drain_host` uses, but without
+            // depending on a libretro handle.
+            let audio = &mut s.audio;
+            crate::av::mixer::mix_voices(
+                &mut audio.channels,
+                &mut mixed,
+                sample_rate,
+                &mut audio.mix_buffer,
+            );
         }
 
         let s = match global().lock() {
@@ -292,14 +280,1592 @@ mod tests {
             Err(poisoned) => poisoned.into_inner(),
         };
 
-        // `graphics_image_from_host` writes 0x00RRGGBB when a > 0, but note:
-        // the framebuffer may still be zero depending on current host video state/presentation.
-        // For this unit test, just verify we didn't write an ARGB-packed value (i.e. alpha ignored)
-        // and that the pixel is either untouched (0) or has the expected XRGB red.
-        assert!(
-            s.video.framebuffer[0] == 0 || s.video.framebuffer[0] == 0x00FF0000,
+        // Opaque texels store alpha 255 (premultiplied ARGB, covering the 3D scene).
+        assert_eq!(
+            s.video.framebuffer[0], 0xFFFF0000,
             "unexpected pixel value: 0x{:08X}",
             s.video.framebuffer[0]
         );
     }
+
+    fn encode(records: &[(u32, &[u32])]) -> Vec<u8> {
+        let mut bytes = Vec::new();
+        for (op, args) in records {
+            bytes.extend_from_slice(&commands::header(*op, args.len() as u32).to_le_bytes());
+            for a in *args {
+                bytes.extend_from_slice(&a.to_le_bytes());
+            }
+        }
+        bytes
+    }
+
+    #[test]
+    fn submit_executes_records_in_order() {
+        reset_state_for_test();
+
+        graphics_set_size(8, 8);
+        clear_framebuffer_for_test();
+
+        let bytes = encode(&[
+            (commands::SET_COLOR, &[10, 20, 30, 255]),
+            (commands::RECT, &[0, 0, 2, 2]),
+            (commands::SET_COLOR, &[1, 2, 3, 255]),
+            (commands::POINT, &[(-1i32) as u32, 0]),
+            (commands::POINT, &[1, 1]),
+        ]);
+        assert_eq!(execute_commands(&bytes), 5);
+
+        let s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        assert_eq!(s.video.framebuffer[0], 0xFF0A141E);
+        assert_eq!(s.video.framebuffer[8 + 1], 0xFF010203);
+        assert_eq!(s.video.draw_color, 0xFF010203);
+        assert_eq!(count_nonzero(&s.video.framebuffer), 4);
+    }
+
+    #[test]
+    fn submit_skips_unknown_opcodes_and_stops_on_truncation() {
+        reset_state_for_test();
+
+        graphics_set_size(4, 4);
+        clear_framebuffer_for_test();
+
+        let mut bytes = encode(&[
+            (0x7FFF, &[1, 2, 3]),
+            (commands::SET_COLOR, &[255, 255, 255, 255]),
+            (commands::POINT, &[0, 0]),
+        ]);
+        // Header promises two args, only one follows.
+        bytes.extend_from_slice(&commands::header(commands::POINT, 2).to_le_bytes());
+        bytes.extend_from_slice(&1u32.to_le_bytes());
+
+        assert_eq!(execute_commands(&bytes), 2);
+
+        let s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        assert_eq!(count_nonzero(&s.video.framebuffer), 1);
+    }
+
+    #[test]
+    fn glyph_cache_rasterizes_each_key_once() {
+        let mut cache = GlyphCache::with_budget(1 << 16);
+        let mut rasterized = 0;
+
+        for _ in 0..3 {
+            for ch in ['a', 'b'] {
+                let glyph = cache.get_or_insert_with(GlyphKey::new(1, ch, 16.0), || {
+                    rasterized += 1;
+                    (2, 2, 3.0, vec![255; 4])
+                });
+                assert_eq!(glyph.advance_width, 3.0);
+            }
+        }
+        // A different size is a different glyph.
+        cache.get_or_insert_with(GlyphKey::new(1, 'a', 24.0), || {
+            rasterized += 1;
+            (3, 3, 4.0, vec![255; 9])
+        });
+
+        assert_eq!(rasterized, 3);
+        assert_eq!(cache.len(), 3);
+
+        cache.remove_font(1);
+        assert!(cache.is_empty());
+        assert_eq!(cache.used_bytes(), 0);
+    }
+
+    #[test]
+    fn glyph_cache_evicts_least_recently_used_within_budget() {
+        let budget = 4096;
+        let mut cache = GlyphCache::with_budget(budget);
+        let glyph = || (32, 32, 1.0, vec![0u8; 32 * 32]);
+
+        cache.get_or_insert_with(GlyphKey::new(1, 'a', 16.0), glyph);
+        cache.get_or_insert_with(GlyphKey::new(1, 'b', 16.0), glyph);
+        cache.get_or_insert_with(GlyphKey::new(1, 'c', 16.0), glyph);
+        // Touch 'a' so 'b' becomes the oldest.
+        cache.get_or_insert_with(GlyphKey::new(1, 'a', 16.0), || unreachable!());
+
+        for ch in 'd'..='h' {
+            cache.get_or_insert_with(GlyphKey::new(1, ch, 16.0), glyph);
+            assert!(cache.used_bytes() <= budget);
+        }
+
+        let mut hit = true;
+        cache.get_or_insert_with(GlyphKey::new(1, 'h', 16.0), || {
+            hit = false;
+            glyph()
+        });
+        assert!(hit, "most recent glyph must survive eviction");
+
+        let mut b_hit = true;
+        cache.get_or_insert_with(GlyphKey::new(1, 'b', 16.0), || {
+            b_hit = false;
+            glyph()
+        });
+        assert!(!b_hit, "oldest glyph must have been evicted");
+    }
+
+    #[test]
+    fn lru_cache_set_budget_evicts_oldest_first() {
+        let mut cache: LruCache<u32, ()> = LruCache::with_budget(100);
+        for k in 0..4 {
+            cache.insert(k, (), 25);
+        }
+        assert_eq!(cache.used_bytes(), 100);
+        cache.get(&0);
+
+        cache.set_budget(50);
+        assert_eq!(cache.used_bytes(), 50);
+        assert!(cache.contains_key(&0));
+        assert!(cache.contains_key(&3));
+        assert!(!cache.contains_key(&1));
+        assert!(!cache.contains_key(&2));
+
+        // Replacing an entry does not double-count its cost.
+        cache.insert(3, (), 10);
+        assert_eq!(cache.used_bytes(), 35);
+    }
+
+    #[test]
+    fn blit_premultiplied_clips_and_composites_over_destination() {
+        reset_state_for_test();
+
+        graphics_set_size(4, 4);
+        clear_framebuffer_for_test();
+
+        // 2x2 block at (3, 3): only the top-left source pixel lands on screen.
+        let pixels = [0xFF112233, 0xFF445566, 0xFF778899, 0xFFAABBCC];
+        {
+            let mut s = match global().lock() {
+                Ok(g) => g,
+                Err(poisoned) => poisoned.into_inner(),
+            };
+            raster::blit_premultiplied(&mut s.video, 3, 3, 2, 2, &pixels);
+            raster::blit_premultiplied(&mut s.video, 0, 0, 2, 1, &[0x00FFFFFF, 0x80010203]);
+
+            // Half-transparent black over opaque white darkens it to roughly half.
+            s.video.framebuffer[4] = 0xFFFFFFFF;
+            raster::blit_premultiplied(&mut s.video, 0, 1, 1, 1, &[0x80000000]);
+        }
+
+        let s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        assert_eq!(s.video.framebuffer[15], 0xFF112233);
+        assert_eq!(s.video.framebuffer[0], 0);
+        assert_eq!(s.video.framebuffer[1], 0x80010203);
+        assert_eq!(s.video.framebuffer[4], 0xFF7F7F7F);
+        assert_eq!(count_nonzero(&s.video.framebuffer), 3);
+    }
+
+    #[test]
+    fn translucent_color_blends_and_transparent_color_draws_nothing() {
+        reset_state_for_test();
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let v = &mut s.video;
+        v.width = 4;
+        v.height = 1;
+        v.framebuffer = vec![0xFF0000FF; 4];
+
+        v.draw_color = 0x80FF0000;
+        raster::rect(v, 0, 0, 2, 1);
+        assert_eq!(v.framebuffer[0], 0xFF80007F);
+        assert_eq!(v.framebuffer[1], 0xFF80007F);
+        assert_eq!(v.framebuffer[2], 0xFF0000FF);
+
+        v.draw_color = 0x00FFFFFF;
+        raster::rect(v, 0, 0, 4, 1);
+        assert_eq!(v.framebuffer[3], 0xFF0000FF);
+
+        // Translucent over transparent stays premultiplied.
+        v.framebuffer.fill(0);
+        v.draw_color = 0x80FF0000;
+        raster::point(v, 0, 0);
+        assert_eq!(v.framebuffer[0], 0x80800000);
+    }
+
+    #[test]
+    fn span_primitives_cover_each_pixel_once() {
+        reset_state_for_test();
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let v = &mut s.video;
+        v.width = 32;
+        v.height = 32;
+        v.framebuffer = vec![0; 32 * 32];
+        v.draw_color = 0x80FF0000;
+
+        // A translucent pixel drawn twice would read back darker than one drawn once.
+        let once = |fb: &[u32]| fb.iter().all(|&p| p == 0 || p == 0x80800000);
+
+        raster::circle(v, 16, 16, 9);
+        assert!(once(&v.framebuffer));
+        assert!(v.framebuffer[16 * 32 + 16] != 0);
+        v.framebuffer.fill(0);
+
+        raster::triangle(v, 2, 2, 29, 5, 10, 28);
+        assert!(once(&v.framebuffer));
+        assert!(count_nonzero(&v.framebuffer) > 200);
+        v.framebuffer.fill(0);
+
+        raster::pill(v, 4, 2, 8, 24);
+        assert!(once(&v.framebuffer));
+        assert!(
+            v.framebuffer[14 * 32 + 4] != 0,
+            "vertical pill fills its sides"
+        );
+        v.framebuffer.fill(0);
+
+        raster::circle_outline(v, 16, 16, 12);
+        assert!(once(&v.framebuffer));
+    }
+
+    fn sprite_sheet_2x2() -> crate::av::resources::ImageResource {
+        // Red, green / blue, half-transparent white.
+        crate::av::resources::ImageResource {
+            rgba: vec![
+                255, 0, 0, 255, 0, 255, 0, 255, //
+                0, 0, 255, 255, 255, 255, 255, 128,
+            ]
+            .into(),
+            width: 2,
+            height: 2,
+        }
+    }
+
+    fn sprite(x: i32, y: i32, w: u32, h: u32, src: [u32; 4], flags: u32) -> Sprite {
+        Sprite {
+            x,
+            y,
+            w,
+            h,
+            src_x: src[0],
+            src_y: src[1],
+            src_w: src[2],
+            src_h: src[3],
+            flags,
+            tint: sprites::TINT_NONE,
+        }
+    }
+
+    #[test]
+    fn sprite_draws_sub_rect_scaled_and_flipped() {
+        reset_state_for_test();
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let v = &mut s.video;
+        v.width = 4;
+        v.height = 4;
+        v.framebuffer = vec![0; 16];
+        let img = sprite_sheet_2x2();
+
+        // Top row of the sheet, scaled 2x, flipped horizontally: green green red red.
+        draw_sprite(v, &img, &sprite(0, 0, 4, 2, [0, 0, 2, 1], sprites::FLIP_X));
+        assert_eq!(
+            &v.framebuffer[0..4],
+            &[0xFF00FF00, 0xFF00FF00, 0xFFFF0000, 0xFFFF0000]
+        );
+        assert_eq!(v.framebuffer[4], 0xFF00FF00);
+
+        // Whole image at natural size, clipped at the bottom-right corner.
+        v.framebuffer.fill(0);
+        draw_sprite(v, &img, &sprite(3, 3, 0, 0, [0, 0, 0, 0], 0));
+        assert_eq!(v.framebuffer[15], 0xFFFF0000);
+        assert_eq!(count_nonzero(&v.framebuffer), 1);
+
+        // Source rects are clamped to the image; the translucent texel blends.
+        v.framebuffer.fill(0xFF000000);
+        draw_sprite(v, &img, &sprite(0, 0, 0, 0, [1, 1, 5, 5], 0));
+        assert_eq!(v.framebuffer[0], 0xFF808080);
+        assert_eq!(v.framebuffer[1], 0xFF000000);
+    }
+
+    #[test]
+    fn sprite_tint_multiplies_color_and_alpha() {
+        reset_state_for_test();
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let v = &mut s.video;
+        v.width = 2;
+        v.height = 1;
+        v.framebuffer = vec![0; 2];
+        let img = sprite_sheet_2x2();
+
+        let mut sp = sprite(0, 0, 0, 0, [0, 0, 2, 1], 0);
+        sp.tint = 0xFF808080;
+        draw_sprite(v, &img, &sp);
+        assert_eq!(v.framebuffer, vec![0xFF800000, 0xFF008000]);
+
+        // A fully transparent tint draws nothing.
+        sp.tint = 0x00FFFFFF;
+        v.framebuffer.fill(0);
+        draw_sprite(v, &img, &sp);
+        assert_eq!(count_nonzero(&v.framebuffer), 0);
+    }
+
+    #[test]
+    fn tilemap_renders_visible_chunks_once_and_invalidates_only_changed_ones() {
+        use crate::av::resources::ImageResource;
+        use crate::av::tilemap::Tilemap;
+
+        reset_state_for_test();
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let v = &mut s.video;
+        v.width = 8;
+        v.height = 4;
+        v.framebuffer = vec![0; 32];
+
+        // Two 2x2 tiles side by side: red, green.
+        let mut rgba = Vec::new();
+        for _row in 0..2 {
+            rgba.extend_from_slice(&[
+                255, 0, 0, 255, 255, 0, 0, 255, 0, 255, 0, 255, 0, 255, 0, 255,
+            ]);
+        }
+        let tileset = ImageResource {
+            rgba: rgba.into(),
+            width: 4,
+            height: 2,
+        };
+
+        // 40x3 tiles = three chunks across (16 tiles = 32 pixels each).
+        let mut map = Tilemap::new(&tileset, 2, 2, 40, 3).expect("valid map");
+        assert_eq!(map.set_tiles(0, 0, 2, 1, &[1, 2]), 2);
+
+        let stats = map.draw(v, 0, 0);
+        assert_eq!((stats.chunks_rendered, stats.chunks_blitted), (1, 1));
+        assert_eq!(v.framebuffer[0], 0xFFFF0000);
+        assert_eq!(v.framebuffer[2], 0xFF00FF00);
+        assert_eq!(v.framebuffer[4], 0, "empty tiles draw nothing");
+
+        let stats = map.draw(v, 0, 0);
+        assert_eq!((stats.chunks_rendered, stats.chunks_blitted), (0, 1));
+
+        // Unchanged tiles keep the cache; a change in chunk 2 leaves chunk 0 alone.
+        assert_eq!(map.set_tiles(0, 0, 2, 1, &[1, 2]), 0);
+        assert_eq!(map.set_tiles(33, 0, 1, 1, &[1]), 1);
+        assert_eq!(map.draw(v, 0, 0).chunks_rendered, 0);
+
+        v.framebuffer.fill(0);
+        let stats = map.draw(v, 66, 0);
+        assert_eq!((stats.chunks_rendered, stats.chunks_blitted), (1, 1));
+        assert_eq!(v.framebuffer[0], 0xFFFF0000);
+
+        // Chunk 1 has no tiles: rendered (as empty) once, never blitted.
+        let stats = map.draw(v, 30, 0);
+        assert_eq!((stats.chunks_rendered, stats.chunks_blitted), (1, 1));
+
+        // Negative scroll offsets the map onto the screen; out-of-range writes are clipped.
+        v.framebuffer.fill(0);
+        map.draw(v, -4, 0);
+        assert_eq!(v.framebuffer[3], 0);
+        assert_eq!(v.framebuffer[4], 0xFFFF0000);
+        assert_eq!(map.set_tiles(39, 2, 4, 4, &[2; 16]), 1);
+        assert_eq!(map.tile(39, 2), Some(2));
+    }
+
+    static PRESENTED: std::sync::Mutex<(usize, u32, u32, usize, u32)> =
+        std::sync::Mutex::new((0, 0, 0, 0, 0));
+
+    unsafe extern "C" fn record_present(
+        data: *const std::ffi::c_void,
+        width: std::ffi::c_uint,
+        height: std::ffi::c_uint,
+        pitch: usize,
+    ) {
+        let first = if data.is_null() {
+            0
+        } else {
+            unsafe { *(data as *const u32) }
+        };
+        *PRESENTED.lock().unwrap() = (data as usize, width, height, pitch, first);
+    }
+
+    #[test]
+    fn present_hands_frontend_the_live_framebuffer() {
+        reset_state_for_test();
+
+        graphics_set_size(4, 2);
+        graphics_set_color(1, 2, 3, 255);
+        graphics_point(0, 0);
+
+        let fb_ptr = {
+            let mut s = match global().lock() {
+                Ok(g) => g,
+                Err(poisoned) => poisoned.into_inner(),
+            };
+            s.video_refresh_cb = Some(record_present);
+            s.video.framebuffer.as_ptr() as usize
+        };
+
+        crate::av::video_present_host(None);
+
+        let (ptr, w, h, pitch, first) = *PRESENTED.lock().unwrap();
+        assert_eq!(ptr, fb_ptr, "present must not copy the framebuffer");
+        assert_eq!((w, h, pitch), (4, 2, 16));
+        assert_eq!(first, 0xFF010203);
+
+        // The buffer is handed back, so drawing persists into the next frame.
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        s.video_refresh_cb = None;
+        assert_eq!(s.video.framebuffer.as_ptr() as usize, fb_ptr);
+        assert_eq!(s.video.framebuffer[0], 0xFF010203);
+    }
+
+    #[test]
+    fn bound_guest_framebuffer_is_read_in_place() {
+        use crate::av::graphics::{graphics_bind_framebuffer, guest_framebuffer_pixels};
+        use crate::state::BoundFramebuffer;
+
+        // Stand-in for guest linear memory (u32-backed so it is aligned like a wasm memory).
+        let memory_words = [0u32, 0x11, 0x22, 0x33, 0x44, 0];
+        let memory: &[u8] = unsafe {
+            std::slice::from_raw_parts(memory_words.as_ptr() as *const u8, memory_words.len() * 4)
+        };
+
+        let bound = BoundFramebuffer {
+            ptr: 4,
+            width: 2,
+            height: 2,
+        };
+        let pixels = guest_framebuffer_pixels(memory, &bound).expect("region fits");
+        assert_eq!(pixels, &[0x11, 0x22, 0x33, 0x44]);
+        assert_eq!(pixels.as_ptr(), memory_words[1..].as_ptr());
+
+        // Out of bounds or misaligned regions are rejected.
+        let too_big = BoundFramebuffer { height: 3, ..bound };
+        assert!(guest_framebuffer_pixels(memory, &too_big).is_none());
+        let misaligned = BoundFramebuffer { ptr: 2, ..bound };
+        assert!(guest_framebuffer_pixels(memory, &misaligned).is_none());
+
+        reset_state_for_test();
+        assert_eq!(graphics_bind_framebuffer(4, 2, 2, 1), 0, "unknown format");
+        assert_eq!(graphics_bind_framebuffer(6, 2, 2, 0), 0, "misaligned");
+        assert_eq!(graphics_bind_framebuffer(4, 2, 2, 0), 1);
+        {
+            let s = match global().lock() {
+                Ok(g) => g,
+                Err(poisoned) => poisoned.into_inner(),
+            };
+            assert_eq!(s.video.bound_framebuffer, Some(bound));
+            assert_eq!((s.video.width, s.video.height), (2, 2));
+        }
+        assert_eq!(graphics_bind_framebuffer(0, 0, 0, 0), 1);
+        let s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        assert_eq!(s.video.bound_framebuffer, None);
+    }
+
+    #[test]
+    fn primitives_accumulate_clipped_damage_until_present() {
+        use crate::av::graphics::{graphics_damage, with_presented_framebuffer};
+        use crate::state::DamageRect;
+
+        reset_state_for_test();
+        graphics_set_size(8, 8);
+
+        // A resize invalidates the whole frame; presenting consumes the damage.
+        let first = with_presented_framebuffer(None, |frame| frame.damage);
+        assert_eq!(first, DamageRect::full(8, 8));
+        assert_eq!(graphics_damage(), 0);
+
+        graphics_set_color(255, 255, 255, 255);
+        crate::av::graphics_rect(2, 3, 2, 2);
+        assert_eq!(graphics_damage(), (2 << 48) | (3 << 32) | (2 << 16) | 2);
+
+        // Off-screen parts are clipped away.
+        crate::av::graphics_circle(7, 7, 3);
+        let damage = with_presented_framebuffer(None, |frame| frame.damage);
+        assert_eq!(
+            damage,
+            DamageRect {
+                x0: 2,
+                y0: 3,
+                x1: 8,
+                y1: 8
+            }
+        );
+        assert_eq!(graphics_damage(), 0);
+    }
+
+    #[test]
+    fn clear_rect_repaints_only_its_region() {
+        use crate::state::DamageRect;
+
+        reset_state_for_test();
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let v = &mut s.video;
+        v.width = 4;
+        v.height = 4;
+        v.framebuffer = vec![0; 16];
+        raster::clear(v, 0);
+        assert!(
+            v.overlay_bounds.is_empty(),
+            "transparent clear empties the overlay"
+        );
+
+        v.draw_color = 0xFF00FF00;
+        raster::rect(v, 1, 1, 2, 2);
+        v.damage = DamageRect::default();
+
+        raster::clear_rect(v, 0, 0, 2, 4, 0x00112233);
+        assert_eq!(v.framebuffer[4 + 1], 0x00112233);
+        assert_eq!(
+            v.framebuffer[4 + 2],
+            0xFF00FF00,
+            "outside the rect is retained"
+        );
+        assert_eq!(
+            v.damage,
+            DamageRect {
+                x0: 0,
+                y0: 0,
+                x1: 2,
+                y1: 4
+            }
+        );
+
+        // Clearing every drawn pixel to transparent means nothing is left to composite.
+        raster::clear_rect(v, 0, 0, 4, 4, 0);
+        assert!(v.overlay_bounds.is_empty());
+        assert_eq!(count_nonzero(&v.framebuffer), 0);
+    }
+
+    #[test]
+    fn unchanged_frame_is_duped_when_frontend_allows_it() {
+        reset_state_for_test();
+        graphics_set_size(4, 2);
+        {
+            let mut s = match global().lock() {
+                Ok(g) => g,
+                Err(poisoned) => poisoned.into_inner(),
+            };
+            s.video_refresh_cb = Some(record_present);
+            s.frontend_can_dupe = true;
+        }
+
+        // The resized frame is new, then nothing is drawn before the second present.
+        crate::av::video_present_host(None);
+        assert_ne!(PRESENTED.lock().unwrap().0, 0);
+        crate::av::video_present_host(None);
+        assert_eq!(
+            PRESENTED.lock().unwrap().0,
+            0,
+            "unchanged frame is sent as NULL"
+        );
+
+        graphics_point(1, 1);
+        crate::av::video_present_host(None);
+        assert_ne!(PRESENTED.lock().unwrap().0, 0);
+
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        s.video_refresh_cb = None;
+        s.frontend_can_dupe = false;
+    }
+
+    #[test]
+    fn command_list_clear_rect_uses_background_color() {
+        reset_state_for_test();
+        graphics_set_size(4, 4);
+        clear_framebuffer_for_test();
+
+        let bytes = encode(&[(commands::CLEAR_RECT, &[1, 1, 2, 1, 0x11, 0x22, 0x33])]);
+        assert_eq!(execute_commands(&bytes), 1);
+
+        let s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        assert_eq!(s.video.framebuffer[4 + 1], 0x00112233);
+        assert_eq!(s.video.framebuffer[4 + 2], 0x00112233);
+        assert_eq!(count_nonzero(&s.video.framebuffer), 2);
+    }
+
+    #[test]
+    fn frustum_culls_bounds_behind_beside_and_beyond_the_camera() {
+        use crate::av::graphics3d::{Bounds, Frustum, Vertex};
+        use glam::{Mat4, Vec3};
+
+        let corner = |p: [f32; 3]| Vertex {
+            position: p,
+            uv: [0.0; 2],
+            normal: [0.0, 1.0, 0.0],
+        };
+        let bounds = Bounds::from_vertices(&[corner([1.0, 2.0, 3.0]), corner([3.0, 4.0, 5.0])]);
+        assert_eq!(bounds.center, Vec3::new(2.0, 3.0, 4.0));
+        assert!((bounds.radius - 3.0f32.sqrt()).abs() < 1e-5);
+
+        // Camera at the origin looking down -Z with a 90 degree field of view.
+        let view = Mat4::look_at_rh(Vec3::ZERO, Vec3::NEG_Z, Vec3::Y);
+        let proj = Mat4::perspective_rh(std::f32::consts::FRAC_PI_2, 1.0, 0.1, 100.0);
+        let frustum = Frustum::from_view_proj(&(proj * view));
+        let at = |x: f32, y: f32, z: f32| {
+            Bounds {
+                center: Vec3::ZERO,
+                radius: 1.0,
+            }
+            .transformed(&Mat4::from_translation(Vec3::new(x, y, z)))
+        };
+
+        assert!(frustum.intersects(&at(0.0, 0.0, -10.0)), "in front");
+        assert!(
+            frustum.intersects(&at(10.5, 0.0, -10.0)),
+            "straddles the side plane"
+        );
+        assert!(
+            frustum.intersects(&at(0.0, 0.0, 0.5)),
+            "straddles the near plane"
+        );
+        assert!(!frustum.intersects(&at(0.0, 0.0, 10.0)), "behind");
+        assert!(!frustum.intersects(&at(50.0, 0.0, -10.0)), "beside");
+        assert!(!frustum.intersects(&at(0.0, -50.0, -10.0)), "below");
+        assert!(!frustum.intersects(&at(0.0, 0.0, -200.0)), "beyond far");
+
+        // Scaling grows the sphere by the largest axis scale.
+        let scaled = Bounds {
+            center: Vec3::ZERO,
+            radius: 1.0,
+        }
+        .transformed(&Mat4::from_scale(Vec3::new(1.0, 5.0, 2.0)));
+        assert!((scaled.radius - 5.0).abs() < 1e-5);
+    }
+
+    #[test]
+    fn mesh_blob_round_trips_and_rejects_bad_input() {
+        use crate::abi::mesh::{BLOB_FLAG_U16_INDICES, BLOB_HEADER_SIZE, BLOB_VERTEX_SIZE};
+        use crate::av::graphics3d::{Bounds, Vertex};
+        use crate::av::mesh_data::{encode_blob, parse_blob};
+
+        let v = |x: f32| Vertex {
+            position: [x, 0.0, 0.0],
+            uv: [x, 1.0],
+            normal: [0.0, 1.0, 0.0],
+        };
+        let vertices = [v(-1.0), v(1.0), v(0.5)];
+        let indices = [0u32, 1, 2];
+        let blob = encode_blob(&vertices, &indices);
+        assert_eq!(blob.len(), BLOB_HEADER_SIZE + 3 * BLOB_VERTEX_SIZE + 3 * 2);
+
+        let parsed = parse_blob(&blob).expect("valid blob");
+        assert!(parsed.u16_indices);
+        assert_eq!((parsed.vertex_count, parsed.index_count), (3, 3));
+        assert_eq!(parsed.bounds, Bounds::from_vertices(&vertices));
+        // The vertex bytes are the `Vertex` array as-is.
+        assert_eq!(
+            parsed.vertices,
+            bytemuck::cast_slice::<Vertex, u8>(&vertices)
+        );
+        assert_eq!(parsed.indices, &[0, 0, 1, 0, 2, 0]);
+
+        let mut truncated = blob.clone();
+        truncated.pop();
+        assert!(parse_blob(&truncated).is_none());
+
+        let mut bad_magic = blob.clone();
+        bad_magic[0] = b'X';
+        assert!(parse_blob(&bad_magic).is_none());
+
+        // An index past the vertex array would make GL read out of bounds.
+        let mut bad_index = blob.clone();
+        let last = bad_index.len() - 2;
+        bad_index[last] = 3;
+        assert!(parse_blob(&bad_index).is_none());
+
+        // Clearing the u16 flag changes the expected size, so the same bytes no longer fit.
+        let mut wide = blob.clone();
+        wide[6] &= !(BLOB_FLAG_U16_INDICES as u8);
+        assert!(parse_blob(&wide).is_none());
+    }
+
+    #[test]
+    fn compact_vertex_formats_pack_attributes_and_decode_positions() {
+        use crate::abi::mesh::{NORMAL_OCT16, POSITION_F16, POSITION_SNORM16, UV_NONE, UV_UNORM16};
+        use crate::av::graphics3d::Vertex;
+        use crate::av::mesh_data::{VertexFormat, f16_to_f32};
+        use glam::Vec3;
+
+        let float = VertexFormat::float();
+        assert_eq!(float.stride, std::mem::size_of::<Vertex>());
+        assert_eq!(float.uv.unwrap().offset, 12);
+        assert_eq!(float.normal.offset, 20);
+
+        // The compact layout is half the size of `Vertex`.
+        let packed = VertexFormat::from_bits(POSITION_SNORM16 | UV_UNORM16 | NORMAL_OCT16).unwrap();
+        assert_eq!(packed.stride, 16);
+        assert_eq!((packed.uv.unwrap().offset, packed.normal.offset), (8, 12));
+        assert_eq!(packed.normal.components, 2);
+        assert!(packed.oct_normals && packed.position.normalized);
+
+        let no_uv = VertexFormat::from_bits(POSITION_F16 | UV_NONE).unwrap();
+        assert_eq!((no_uv.stride, no_uv.normal.offset), (20, 8));
+        assert!(no_uv.uv.is_none());
+
+        assert!(VertexFormat::from_bits(POSITION_SNORM16 | 1).is_none());
+        assert!(VertexFormat::from_bits(1 << 8).is_none());
+
+        assert_eq!(f16_to_f32(0x3C00), 1.0);
+        assert_eq!(f16_to_f32(0xC000), -2.0);
+        assert_eq!(f16_to_f32(0x0001), 1.0 / 16_777_216.0);
+        assert!((f16_to_f32(0x3555) - 1.0 / 3.0).abs() < 1e-3);
+
+        // Two snorm16 vertices: (1, -1, 0) and (-1, 1, 0.5); bounds come from decoded positions.
+        let mut bytes = Vec::new();
+        for p in [[32767i16, -32767, 0, 0], [-32768, 32767, 16384, 0]] {
+            for c in p {
+                bytes.extend_from_slice(&c.to_le_bytes());
+            }
+            bytes.extend_from_slice(&[0; 8]); // uv + normal
+        }
+        assert_eq!(packed.position(&bytes[..16]), Vec3::new(1.0, -1.0, 0.0));
+        let b = packed.bounds(&bytes);
+        assert!((b.center - Vec3::new(0.0, 0.0, 0.25)).length() < 1e-3);
+    }
+
+    #[test]
+    fn gif_stream_composites_frames_on_demand_and_rewinds() {
+        use crate::av::gif_stream::GifStream;
+        use std::borrow::Cow;
+
+        // 2x1 GIF, palette [transparent-black, red, green]. Frame 0 paints both pixels red,
+        // frame 1 paints only the right pixel green (left is transparent, so red shows through)
+        // and is disposed to background, frame 2 is fully transparent.
+        let palette = [0, 0, 0, 255, 0, 0, 0, 255, 0];
+        let mut data = Vec::new();
+        {
+            let mut enc = gif::Encoder::new(&mut data, 2, 1, &palette).unwrap();
+            for (pixels, dispose) in [
+                (vec![1u8, 1], gif::DisposalMethod::Keep),
+                (vec![0u8, 2], gif::DisposalMethod::Background),
+                (vec![0u8, 0], gif::DisposalMethod::Keep),
+            ] {
+                let frame = gif::Frame {
+                    width: 2,
+                    height: 1,
+                    delay: 5,
+                    dispose,
+                    transparent: Some(0),
+                    buffer: Cow::Owned(pixels),
+                    ..gif::Frame::default()
+                };
+                enc.write_frame(&frame).unwrap();
+            }
+        }
+
+        let mut gif = GifStream::new(data).expect("valid gif");
+        assert_eq!(gif.frame_count(), 3);
+        assert_eq!(gif.frame_at(0), 0);
+        assert_eq!(gif.frame_at(60), 1);
+        assert_eq!(gif.frame_at(149), 2);
+        assert_eq!(gif.frame_at(150), 0);
+
+        let red = [255, 0, 0, 255];
+        let green = [0, 255, 0, 255];
+        assert_eq!(gif.frame(1).unwrap(), [red, green].concat());
+        // Frame 1 was disposed to background, so frame 2 shows nothing.
+        assert_eq!(gif.frame(2).unwrap(), [0u8; 8]);
+        // Going back rewinds the decoder (or hits the frame cache) and gives the same pixels.
+        assert_eq!(gif.frame(0).unwrap(), [red, red].concat());
+        assert_eq!(gif.frame(1).unwrap(), [red, green].concat());
+        assert!(gif.frame(3).is_none());
+
+        assert!(GifStream::new(b"not a gif".to_vec()).is_none());
+    }
+
+    #[test]
+    fn async_asset_loads_publish_on_wait_and_report_status() {
+        use crate::abi::asset::{KIND_JPEG, KIND_PNG, STATUS_FAILED, STATUS_NONE, STATUS_READY};
+        use crate::av::assets::queue;
+        use crate::av::resources::RESOURCES;
+        use crate::av::{asset_status, asset_wait_all};
+        use std::time::Duration;
+
+        let png = include_bytes!("../assets/test_texture_1x1_rgba.png").to_vec();
+        let ok_key = 0xA55E_7001;
+        let bad_key = 0xA55E_7002;
+        assert!(queue(KIND_PNG, ok_key, png));
+        assert!(queue(KIND_JPEG, bad_key, b"not a jpeg".to_vec()));
+        assert!(!queue(99, 0xA55E_7003, Vec::new()));
+
+        // Other tests may queue loads concurrently, so poll per key rather than expecting 0.
+        for _ in 0..500 {
+            asset_wait_all(10);
+            if asset_status(ok_key) == STATUS_READY && asset_status(bad_key) == STATUS_FAILED {
+                break;
+            }
+            std::thread::sleep(Duration::from_millis(1));
+        }
+        assert_eq!(asset_status(ok_key), STATUS_READY);
+        assert_eq!(asset_status(bad_key), STATUS_FAILED);
+        assert_eq!(asset_status(0xA55E_7003), STATUS_NONE);
+
+        let res = RESOURCES.lock().unwrap();
+        let img = res
+            .keyed_images
+            .get(&ok_key)
+            .expect("published on the main thread");
+        assert_eq!((img.width, img.height, img.rgba.len()), (1, 1, 4));
+    }
+
+    #[test]
+    fn frame_ring_queues_mixes_wraps_and_drops_when_full() {
+        use crate::av::audio_ring::FrameRing;
+
+        fn le(samples: &[i16]) -> Vec<u8> {
+            samples.iter().flat_map(|s| s.to_le_bytes()).collect()
+        }
+
+        let ring = FrameRing::new(3);
+        assert_eq!(ring.capacity(), 4);
+
+        // 3 frames plus a dangling half frame (ignored).
+        assert_eq!(ring.push_le_bytes(&le(&[1, -1, 2, -2, 3, -3, 99])), 3);
+        assert_eq!(ring.len(), 3);
+
+        // Mixing saturates into what is already in the buffer.
+        let mut out = [i16::MAX, i16::MIN, 0, 0];
+        assert_eq!(ring.mix_into(&mut out), 2);
+        assert_eq!(out, [i16::MAX, i16::MIN, 2, -2]);
+        assert_eq!(ring.len(), 1);
+
+        // Wraps around the end of the slots; only 3 of 4 frames fit.
+        assert_eq!(ring.push_le_bytes(&le(&[4, -4, 5, -5, 6, -6, 7, -7])), 3);
+        assert_eq!(ring.len(), 4);
+        let mut out = [0i16; 10];
+        assert_eq!(ring.mix_into(&mut out), 4);
+        assert_eq!(out, [3, -3, 4, -4, 5, -5, 6, -6, 0, 0]);
+
+        ring.push_le_bytes(&le(&[8, 8]));
+        ring.clear();
+        assert_eq!(ring.len(), 0);
+        assert_eq!(ring.mix_into(&mut out), 0);
+    }
+
+    #[test]
+    fn mixer_resamples_and_clips_once() {
+        use crate::av::mixer::mix_voices;
+        use crate::state::AudioChannel;
+
+        // A 22.05 kHz ramp played at 44.1 kHz advances half a source frame per output frame and
+        // interpolates between source frames.
+        let ramp: Vec<i16> = [0i16, 1000, 2000, 3000]
+            .iter()
+            .flat_map(|&s| [s, s])
+            .collect();
+        let mut voices = vec![AudioChannel {
+            id: 1,
+            active: true,
+            pcm_stereo: ramp.into(),
+            sample_rate: 22_050,
+            ..AudioChannel::default()
+        }];
+        let mut out = vec![0i16; 4 * 2];
+        let mut acc = Vec::new();
+        mix_voices(&mut voices, &mut out, 44_100, &mut acc);
+        assert_eq!(out, vec![0, 0, 500, 500, 1000, 1000, 1500, 1500]);
+        assert_eq!(voices[0].position_frames, 2);
+        assert_eq!(voices[0].position_frac, 0);
+
+        // Two loud voices sum in f32 and clip once; the pushed sample already in `out` is kept.
+        let loud: Vec<i16> = vec![20_000; 2];
+        let mut voices: Vec<AudioChannel> = (1..=2)
+            .map(|id| AudioChannel {
+                id,
+                active: true,
+                pcm_stereo: loud.clone().into(),
+                sample_rate: 44_100,
+                ..AudioChannel::default()
+            })
+            .collect();
+        let mut out = vec![-30_000i16, 0, 0, 0];
+        mix_voices(&mut voices, &mut out, 44_100, &mut acc);
+        assert_eq!(out, vec![10_000, i16::MAX, 0, 0]);
+        // Non-looping voices that ran out are dropped.
+        assert!(voices.is_empty());
+    }
+
+    #[test]
+    fn qoa_stream_decodes_frames_and_loops() {
+        use crate::abi::audio::FORMAT_QOA;
+        use crate::av::audio_stream::{PcmStream, should_stream};
+
+        // One mono frame of 20 samples: zeroed predictor, scalefactor 0, every residual index 6
+        // (dequantized +7), so every decoded sample is 7.
+        let mut qoa = b"qoaf".to_vec();
+        qoa.extend_from_slice(&20u32.to_be_bytes());
+        let frame_header: u64 = (1 << 56) | (22_050 << 32) | (20 << 16) | 32;
+        qoa.extend_from_slice(&frame_header.to_be_bytes());
+        qoa.extend_from_slice(&[0; 16]); // LMS history + weights
+        let slice = (0..20).fold(0u64, |acc, k| acc | (6u64 << (57 - 3 * k)));
+        qoa.extend_from_slice(&slice.to_be_bytes());
+
+        assert!(
+            !should_stream(FORMAT_QOA, &qoa),
+            "short assets decode whole"
+        );
+
+        let mut stream = PcmStream::open(FORMAT_QOA, qoa.into(), 44_100).expect("valid QOA");
+        assert_eq!(stream.sample_rate, 22_050);
+        assert!(
+            stream.window().is_empty(),
+            "nothing is decoded until it is needed"
+        );
+
+        stream.fill(1, false);
+        assert_eq!(
+            stream.window(),
+            &[7i16; 40][..],
+            "mono is duplicated to stereo"
+        );
+
+        // Past the end: a looping stream rewinds seamlessly, a one-shot one stops.
+        stream.consume(15);
+        stream.fill(10, true);
+        assert_eq!(stream.window().len(), (5 + 20) * 2);
+        assert!(!stream.exhausted());
+
+        stream.consume(25);
+        stream.fill(10, false);
+        assert!(stream.window().is_empty());
+        assert!(stream.exhausted());
+    }
+
+    #[test]
+    fn streams_seek_back_through_history_and_reposition_qoa_frames() {
+        use crate::abi::audio::FORMAT_QOA;
+        use crate::av::audio_stream::{PcmStream, StreamPosition};
+
+        // Three mono frames of 20 samples decoding to 1, 3 and 7 (residual indices 0, 2 and 6
+        // with a zeroed predictor).
+        let mut qoa = b"qoaf".to_vec();
+        qoa.extend_from_slice(&60u32.to_be_bytes());
+        for index in [0u64, 2, 6] {
+            let frame_header: u64 = (1 << 56) | (22_050 << 32) | (20 << 16) | 32;
+            qoa.extend_from_slice(&frame_header.to_be_bytes());
+            qoa.extend_from_slice(&[0; 16]);
+            let slice = (0..20).fold(0u64, |acc, k| acc | (index << (57 - 3 * k)));
+            qoa.extend_from_slice(&slice.to_be_bytes());
+        }
+        let qoa: std::sync::Arc<[u8]> = qoa.into();
+
+        let mut stream = PcmStream::open(FORMAT_QOA, qoa.clone(), 44_100).unwrap();
+        stream.fill(30, false);
+        stream.consume(25);
+        let saved = stream.position();
+        assert_eq!(
+            saved,
+            StreamPosition {
+                played: 25,
+                source: 25
+            }
+        );
+
+        // Run-ahead: play on, then restore. The played frames are still buffered.
+        stream.fill(30, false);
+        stream.consume(30);
+        assert!(stream.seek(saved));
+        assert_eq!(stream.position(), saved);
+        assert_eq!(stream.window()[..2], [3, 3]);
+
+        // A fresh stream has no history, so it seeks the decoder to the frame holding the target.
+        let mut fresh = PcmStream::open(FORMAT_QOA, qoa.clone(), 44_100).unwrap();
+        let late = StreamPosition {
+            played: 45,
+            source: 45,
+        };
+        assert!(fresh.seek(late));
+        assert_eq!(fresh.position(), late);
+        // Frame 3 is decoded whole and its first 5 frames dropped.
+        assert_eq!(fresh.window(), &[7i16; 15 * 2][..]);
+        assert!(!fresh.seek(StreamPosition {
+            played: 0,
+            source: 600
+        }));
+        assert_eq!(fresh.position(), late, "a failed seek changes nothing");
+
+        // Looping: the cursor's source frame wraps with the track.
+        let mut looping = PcmStream::open(FORMAT_QOA, qoa, 44_100).unwrap();
+        looping.fill(70, true);
+        looping.consume(65);
+        assert_eq!(
+            looping.position(),
+            StreamPosition {
+                played: 65,
+                source: 5
+            }
+        );
+        looping.consume(2);
+        looping.fill(70, true);
+        assert_eq!(looping.position().source, 7);
+    }
+
+    #[test]
+    fn profile_stats_report_phases_and_host_calls() {
+        use crate::abi::stats;
+        use crate::profile::{self, Phase};
+
+        let u32_at = |b: &[u8], at: usize| u32::from_le_bytes(b[at..at + 4].try_into().unwrap());
+        let u64_at = |b: &[u8], at: usize| u64::from_le_bytes(b[at..at + 8].try_into().unwrap());
+
+        profile::enable();
+        profile::reset();
+        profile::begin_frame();
+        {
+            let _p = profile::phase(Phase::Draw);
+            for _ in 0..3 {
+                let _c = profile::host_call("wasm96_graphics_rect");
+            }
+            let _c = profile::host_call("wasm96_graphics_line");
+        }
+        profile::bytes_in(100);
+        drop(global().lock());
+        profile::end_frame();
+
+        // Probe for the size, then fetch with room for one entry only.
+        let (_, needed) = profile::encode_stats(0);
+        assert_eq!(needed, stats::HEADER_BYTES + 2 * stats::ENTRY_BYTES);
+        let (report, _) = profile::encode_stats(stats::HEADER_BYTES + stats::ENTRY_BYTES);
+        assert_eq!(report.len(), stats::HEADER_BYTES + stats::ENTRY_BYTES);
+
+        assert_eq!(u32_at(&report, 0), stats::VERSION);
+        assert_eq!(u32_at(&report, 4), 1, "entries that fit");
+        assert_eq!(u64_at(&report, 8), 1, "frame index");
+        let header_tail = 24 + 8 * stats::PHASE_COUNT;
+        assert!(u64_at(&report, 24 + 8 * stats::PHASE_DRAW) > 0);
+        assert_eq!(u32_at(&report, header_tail + 8), 4, "host calls");
+        assert!(u32_at(&report, header_tail + 12) >= 1, "lock count");
+        assert_eq!(u64_at(&report, header_tail + 24), 100, "bytes in");
+
+        let entry = &report[stats::HEADER_BYTES..];
+        let name = &entry[..stats::NAME_BYTES];
+        let name = core::str::from_utf8(name).unwrap().trim_end_matches('\0');
+        assert!(name == "graphics_rect" || name == "graphics_line");
+        profile::reset();
+    }
+
+    static HELD: std::sync::atomic::AtomicU32 = std::sync::atomic::AtomicU32::new(0);
+    static POLLS: std::sync::atomic::AtomicU32 = std::sync::atomic::AtomicU32::new(0);
+    static QUERIES: std::sync::atomic::AtomicU32 = std::sync::atomic::AtomicU32::new(0);
+
+    unsafe extern "C" fn count_poll() {
+        POLLS.fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+    }
+
+    unsafe extern "C" fn port0_held(
+        port: std::ffi::c_uint,
+        _device: std::ffi::c_uint,
+        _index: std::ffi::c_uint,
+        id: std::ffi::c_uint,
+    ) -> i16 {
+        QUERIES.fetch_add(1, std::sync::atomic::Ordering::Relaxed);
+        let held = HELD.load(std::sync::atomic::Ordering::Relaxed);
+        (port == 0 && (held >> id) & 1 != 0) as i16
+    }
+
+    #[test]
+    fn input_snapshot_polls_once_and_reports_edges() {
+        use crate::abi::Button;
+        use crate::input;
+        use std::sync::atomic::Ordering;
+
+        reset_state_for_test();
+        {
+            let mut s = match global().lock() {
+                Ok(g) => g,
+                Err(poisoned) => poisoned.into_inner(),
+            };
+            s.input_poll_cb = Some(count_poll);
+            s.input_state_cb = Some(port0_held);
+        }
+        POLLS.store(0, Ordering::Relaxed);
+
+        let a = 1 << Button::A as u32;
+        let up = 1 << Button::Up as u32;
+        HELD.store(a | up, Ordering::Relaxed);
+        input::snapshot_per_frame();
+        assert_eq!(POLLS.load(Ordering::Relaxed), 1);
+        assert_eq!(input::joypad_buttons(0), a | up);
+        assert_eq!(input::joypad_pressed(0), a | up);
+        assert_eq!(input::joypad_released(0), 0);
+        assert_eq!(input::joypad_buttons(1), 0);
+        assert_eq!(input::joypad_buttons(99), 0);
+
+        // Queries during the frame read the snapshot, not the frontend.
+        let queried = QUERIES.load(Ordering::Relaxed);
+        for _ in 0..16 {
+            assert_eq!(input::joypad_button_pressed(0, Button::A as u32), 1);
+        }
+        assert_eq!(QUERIES.load(Ordering::Relaxed), queried);
+
+        HELD.store(a, Ordering::Relaxed);
+        input::snapshot_per_frame();
+        assert_eq!(input::joypad_buttons(0), a);
+        assert_eq!(input::joypad_pressed(0), 0);
+        assert_eq!(input::joypad_released(0), up);
+        assert_eq!(input::joypad_button_pressed(0, Button::Up as u32), 0);
+
+        reset_state_for_test();
+    }
+
+    #[test]
+    fn storage_read_copies_ranges_into_caller_memory() {
+        use crate::abi::storage::NOT_FOUND;
+        use crate::av::storage::{storage_read_into, storage_size};
+
+        reset_state_for_test();
+        let key = 0x5A5A_0001;
+        {
+            let mut s = match global().lock() {
+                Ok(g) => g,
+                Err(poisoned) => poisoned.into_inner(),
+            };
+            s.storage.kv.insert(key, b"hello world"[..].into());
+        }
+
+        assert_eq!(storage_size(key), 11);
+        assert_eq!(storage_size(key + 1), NOT_FOUND);
+
+        let mut memory = vec![0u8; 32];
+        assert_eq!(storage_read_into(&mut memory, key, 4, 32, 0), 11);
+        assert_eq!(&memory[4..15], b"hello world");
+
+        // Chunked reads: capacity and offset bound the copy.
+        memory.fill(0);
+        assert_eq!(storage_read_into(&mut memory, key, 0, 5, 6), 5);
+        assert_eq!(&memory[..6], b"world\0");
+        assert_eq!(storage_read_into(&mut memory, key, 0, 8, 11), 0);
+        assert_eq!(storage_read_into(&mut memory, key + 1, 0, 8, 0), NOT_FOUND);
+
+        // A destination outside guest memory copies nothing.
+        assert_eq!(storage_read_into(&mut memory, key, 28, 8, 0), 0);
+
+        reset_state_for_test();
+    }
+
+    #[test]
+    fn storage_write_patches_ranges_from_caller_memory() {
+        use crate::av::storage::storage_write_from;
+
+        reset_state_for_test();
+        let key = 0x5A5A_0002;
+        let memory = b"....WORLD!......".to_vec();
+
+        // Writing past the end of a missing key creates it, zero-filled up to `offset`.
+        storage_write_from(&memory, key, 2, 4, 6);
+        // Patch in place without touching the rest.
+        storage_write_from(&memory, key, 0, 4, 1);
+        // A source outside guest memory is ignored.
+        storage_write_from(&memory, key, 0, 12, 8);
+
+        {
+            let s = match global().lock() {
+                Ok(g) => g,
+                Err(poisoned) => poisoned.into_inner(),
+            };
+            assert_eq!(s.storage.kv[&key][..], b"W\0WORLD!"[..]);
+        }
+
+        reset_state_for_test();
+    }
+
+    fn draw_overlapping_scene(v: &mut crate::state::VideoState) {
+        raster::clear(v, 0xFF102030);
+        for i in 0..120i32 {
+            // Alternate translucent and opaque so submission order is visible in the result.
+            let base = if i % 2 == 0 { 0x80FF3366 } else { 0xFF22AA44 };
+            v.draw_color = base ^ (i as u32 * 0x010203);
+            let (x, y) = (i * 37 % 200 - 20, i * 53 % 150 - 20);
+            match i % 6 {
+                0 => raster::rect(v, x, y, 90, 40),
+                1 => raster::circle(v, x, y, 30),
+                2 => raster::triangle(v, x, y, x + 70, y + 15, x - 10, y + 90),
+                3 => raster::line(v, x, y, 190 - x, 140 - y),
+                4 => raster::pill_outline(v, x, y, 60, 20),
+                _ => raster::clear_rect(v, x, y, 30, 30, 0x00ABCDEF),
+            }
+        }
+    }
+
+    #[test]
+    fn tiled_resolve_matches_immediate_drawing() {
+        use crate::av::tiles;
+        use crate::state::VideoState;
+
+        let video = || {
+            let mut v = VideoState::default();
+            v.width = 200;
+            v.height = 150;
+            v.framebuffer = vec![0; 200 * 150];
+            v
+        };
+
+        let mut immediate = video();
+        draw_overlapping_scene(&mut immediate);
+
+        for threads in [2, 3, 8] {
+            let mut deferred = video();
+            tiles::set_threads(&mut deferred, threads);
+            draw_overlapping_scene(&mut deferred);
+            assert!(!deferred.display_list.is_empty(), "primitives are recorded");
+            assert_eq!(
+                deferred.damage, immediate.damage,
+                "damage is known before resolve"
+            );
+
+            tiles::resolve(&mut deferred);
+            assert!(deferred.display_list.is_empty());
+            assert!(
+                deferred.framebuffer == immediate.framebuffer,
+                "{threads} threads draw the same pixels"
+            );
+        }
+    }
+
+    #[test]
+    fn deferred_primitives_resolve_before_direct_framebuffer_writes() {
+        use crate::av::tiles;
+
+        reset_state_for_test();
+        let mut s = match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let v = &mut s.video;
+        v.width = 4;
+        v.height = 1;
+        v.framebuffer = vec![0; 4];
+        tiles::set_threads(v, 4);
+
+        v.draw_color = 0xFFFF0000;
+        raster::rect(v, 0, 0, 4, 1);
+        assert_eq!(v.framebuffer[0], 0, "still recorded");
+
+        // A blit is a barrier: the rect lands first, then the blit blends over it.
+        raster::blit_premultiplied(v, 1, 0, 1, 1, &[0x80000080]);
+        assert_eq!(v.framebuffer[0], 0xFFFF0000);
+        assert_eq!(v.framebuffer[1], 0xFF7F0080);
+
+        // A full clear drops what was recorded before it.
+        raster::rect(v, 0, 0, 4, 1);
+        raster::clear(v, 0);
+        assert_eq!(v.display_list.len(), 1);
+        tiles::resolve(v);
+        assert_eq!(count_nonzero(&v.framebuffer), 0);
+    }
+
+    #[test]
+    fn gpu_frames_lend_the_display_list_and_keep_it_for_cpu_fallback() {
+        use crate::av::{gpu2d, tiles};
+        use crate::state::{DamageRect, VideoState};
+
+        let mut v = VideoState::default();
+        v.width = 64;
+        v.height = 48;
+        v.framebuffer = vec![0; 64 * 48];
+        tiles::set_gpu(&mut v, true);
+        assert!(
+            v.display_list.is_deferred(),
+            "a GL context records every primitive"
+        );
+
+        raster::clear(&mut v, 0);
+        v.draw_color = 0xFFFF0000;
+        raster::rect(&mut v, 2, 3, 10, 5);
+        raster::circle(&mut v, 20, 20, 5);
+        raster::pill(&mut v, 30, 10, 12, 6);
+        raster::line(&mut v, 0, 0, 10, 4);
+        v.damage = DamageRect::default();
+
+        let frame = gpu2d::begin_frame(&mut v).expect("primitives only");
+        assert!(frame.covers_layer, "the frame starts with a full clear");
+        assert!(
+            v.display_list.is_empty(),
+            "present sees nothing to rasterize"
+        );
+        let mut quads = Vec::new();
+        gpu2d::build_quads(&frame.ops, 64, 48, &mut Vec::new(), &mut quads);
+        assert!(
+            quads.iter().all(|q| q.color == [1.0, 0.0, 0.0, 1.0]),
+            "a transparent clear adds no quad"
+        );
+        let rect = [2.0, 3.0, 12.0, 8.0];
+        assert!(
+            quads.iter().any(|q| q.rect == rect),
+            "a rect is a single quad"
+        );
+        let mut painted = vec![0u32; 64 * 48];
+        for q in &quads {
+            let [x0, y0, x1, y1] = q.rect.map(|c| c as usize);
+            for y in y0..y1 {
+                painted[y * 64 + x0..y * 64 + x1].fill(0xFFFF0000);
+            }
+        }
+        gpu2d::end_frame(&mut v, frame);
+        assert_eq!(v.display_list.len(), 5);
+        assert_eq!(count_nonzero(&v.framebuffer), 0, "the GPU drew it");
+
+        // A barrier rasterizes the retained ops and re-damages what the GPU drew, and the CPU
+        // writes exactly the pixels the quads covered.
+        tiles::resolve(&mut v);
+        assert_eq!(v.damage, DamageRect::full(64, 48));
+        assert_eq!(v.framebuffer[3 * 64 + 2], 0xFFFF0000);
+        assert!(
+            v.framebuffer == painted,
+            "GPU and CPU cover the same pixels"
+        );
+
+        // A partial clear cannot be drawn over the 3D scene.
+        raster::clear_rect(&mut v, 0, 0, 4, 4, 0);
+        assert!(gpu2d::begin_frame(&mut v).is_none());
+    }
+
+    #[test]
+    fn gpu_frames_draw_recorded_blits_as_textured_quads() {
+        use crate::av::{gpu2d, tiles};
+        use crate::state::VideoState;
+
+        let video = || {
+            let mut v = VideoState::default();
+            v.width = 16;
+            v.height = 8;
+            v.framebuffer = vec![0; 16 * 8];
+            v
+        };
+        let img = sprite_sheet_2x2();
+        let scene = |v: &mut VideoState| {
+            v.draw_color = 0xFF00_00FF;
+            raster::rect(v, 0, 0, 6, 6);
+            draw_sprite(v, &img, &sprite(1, 1, 4, 4, [0, 0, 0, 0], sprites::FLIP_Y));
+            v.draw_color = 0x8000_FF00;
+            raster::rect(v, 3, 0, 6, 2);
+            draw_sprite(v, &img, &sprite(8, 2, 0, 0, [1, 1, 1, 1], 0));
+        };
+
+        let mut immediate = video();
+        scene(&mut immediate);
+
+        let mut v = video();
+        tiles::set_gpu(&mut v, true);
+        scene(&mut v);
+        assert_eq!(
+            v.display_list.len(),
+            4,
+            "sprites are recorded, not resolved"
+        );
+        assert_eq!(count_nonzero(&v.framebuffer), 0);
+        assert_eq!(v.damage, immediate.damage);
+
+        let frame = gpu2d::begin_frame(&mut v).expect("blits are drawable");
+        let mut quads = Vec::new();
+        let batches = gpu2d::build_quads(&frame.ops, 16, 8, &mut Vec::new(), &mut quads);
+        assert_eq!(batches.len(), 1, "one image needs one texture binding");
+        assert_eq!(batches[0].end, quads.len());
+        assert_eq!(quads.iter().filter(|q| q.flags != 0).count(), 2);
+        gpu2d::end_frame(&mut v, frame);
+
+        // The CPU fallback draws the same pixels as immediate mode.
+        tiles::resolve(&mut v);
+        assert!(v.framebuffer == immediate.framebuffer);
+    }
+
+    #[test]
+    fn retained_lists_capture_primitives_and_replay_them_offset() {
+        use crate::av::draw_lists::LAYER_MIN_OPS;
+        use crate::av::resources::RESOURCES;
+        use crate::av::{
+            graphics_list_begin, graphics_list_destroy, graphics_list_draw, graphics_list_end,
+        };
+        use crate::state::VideoState;
+
+        fn chrome(v: &mut VideoState, bars: i32, dx: i32, dy: i32) {
+            for i in 0..bars {
+                v.draw_color = 0xFF000040 | ((i as u32 % 16) << 12);
+                raster::rect(v, dx + i * 2, dy + 1, 3, 5);
+            }
+            v.draw_color = 0xFFFFFFFF;
+            raster::rect_outline(v, dx, dy, 40, 10);
+            raster::circle(v, dx + 20, dy + 5, 4);
+        }
+        let lock = || match global().lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+
+        // A short list is replayed shape by shape, a long one from its pre-rasterized layer.
+        for (key, bars) in [(0xA11u64, 2), (0xA12, LAYER_MIN_OPS as i32)] {
+            reset_state_for_test();
+            graphics_set_size(64, 32);
+            clear_framebuffer_for_test();
+
+            graphics_list_begin(key);
+            chrome(&mut lock().video, bars, 0, 0);
+            assert_eq!(graphics_list_end(), bars as u32 + 2);
+            assert_eq!(
+                count_nonzero(&lock().video.framebuffer),
+                0,
+                "recording draws nothing"
+            );
+            let has_layer = RESOURCES.lock().unwrap().draw_lists[&key].has_layer();
+            assert_eq!(has_layer, bars as usize >= LAYER_MIN_OPS);
+
+            graphics_list_draw(key, 5, 3);
+            let mut expected = VideoState::default();
+            expected.width = 64;
+            expected.height = 32;
+            expected.framebuffer = vec![0; 64 * 32];
+            chrome(&mut expected, bars, 5, 3);
+            assert!(
+                lock().video.framebuffer == expected.framebuffer,
+                "replaying {bars} bars matches drawing them"
+            );
+
+            graphics_list_destroy(key);
+            graphics_list_draw(key, 0, 0);
+        }
+        assert_eq!(graphics_list_end(), 0, "nothing is recording");
+    }
+
+    #[test]
+    fn text_runs_are_laid_out_once_and_redraw_identically() {
+        use crate::abi::text::TEXT_ITEM_SIZE;
+        use crate::av::graphics::{TextItem, draw_text, graphics_font_use_spleen, measure_text};
+        use crate::av::resources::RESOURCES;
+        use crate::state::VideoState;
+
+        let font = graphics_font_use_spleen(16);
+        assert_ne!(font, 0);
+        let mut res = match RESOURCES.lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let mut v = VideoState {
+            width: 64,
+            height: 32,
+            framebuffer: vec![0; 64 * 32],
+            ..Default::default()
+        };
+
+        const HP: &[u8] = b"HP 99";
+        const WHITE: u32 = 0xFFFF_FFFF;
+        let runs = res.text_layouts.len();
+        assert!(draw_text(&mut res, &mut v, font, 16.0, HP, 2, 4, WHITE));
+        let first = v.framebuffer.clone();
+        assert!(count_nonzero(&first) > 0);
+        v.framebuffer.fill(0);
+        assert!(draw_text(&mut res, &mut v, font, 16.0, HP, 2, 4, WHITE));
+        assert_eq!(v.framebuffer, first, "cached run draws the same pixels");
+        assert_eq!(measure_text(&mut res, font, 16.0, HP), Some((5 * 8, 16)));
+        assert_eq!(
+            res.text_layouts.len(),
+            runs + 1,
+            "draw, redraw and measure share one run"
+        );
+
+        assert!(!draw_text(
+            &mut res, &mut v, font, 16.0, b"\xff", 0, 0, WHITE
+        ));
+        assert_eq!(measure_text(&mut res, font, 16.0, b"\xff"), None);
+        drop(res);
+
+        let words = [-3i32 as u32, 7, 0x100, 5, 0xFF00_FF00, 24];
+        let bytes: Vec<u8> = words.iter().flat_map(|w| w.to_le_bytes()).collect();
+        assert_eq!(bytes.len(), TEXT_ITEM_SIZE);
+        assert_eq!(
+            TextItem::from_le_bytes(&bytes),
+            TextItem {
+                x: -3,
+                y: 7,
+                text_ptr: 0x100,
+                text_len: 5,
+                color: 0xFF00_FF00,
+                px: 24,
+            }
+        );
+    }
+
+    #[test]
+    fn image_blits_and_ttf_glyphs_write_premultiplied_alpha() {
+        use crate::av::graphics::draw_text;
+        use crate::av::resources::{FontResource, RESOURCES};
+        use crate::state::VideoState;
+        use fontdue::{Font, FontSettings};
+
+        reset_state_for_test();
+        graphics_set_size(2, 1);
+        // Opaque red, then half-transparent white over black.
+        graphics_image_from_host(0, 0, 2, 1, &[255, 0, 0, 255, 255, 255, 255, 128]);
+        {
+            let s = match global().lock() {
+                Ok(g) => g,
+                Err(poisoned) => poisoned.into_inner(),
+            };
+            assert_eq!(s.video.framebuffer[0], 0xFFFF_0000);
+            assert_eq!(s.video.framebuffer[1], 0x8080_8080);
+        }
+
+        let font = Font::from_bytes(
+            include_bytes!("../assets/spleen.otf").as_slice(),
+            FontSettings::default(),
+        )
+        .unwrap();
+        let mut res = match RESOURCES.lock() {
+            Ok(g) => g,
+            Err(poisoned) => poisoned.into_inner(),
+        };
+        let id = res.next_id;
+        res.next_id += 1;
+        res.fonts.insert(id, FontResource::Ttf(font));
+        let mut v = VideoState {
+            width: 64,
+            height: 32,
+            framebuffer: vec![0; 64 * 32],
+            ..Default::default()
+        };
+
+        const GREEN: u32 = 0xFF00_FF00;
+        const HALF: u32 = 0x8000_FF00;
+        assert!(draw_text(&mut res, &mut v, id, 16.0, b"HP", 0, 0, GREEN));
+        let alphas: Vec<u32> = v.framebuffer.iter().map(|&p| p >> 24).collect();
+        assert!(alphas.contains(&0xFF), "full coverage is opaque");
+        assert!(
+            v.framebuffer.iter().all(|&p| p == 0 || p >> 24 != 0),
+            "no glyph pixel is left with alpha 0"
+        );
+
+        // The draw color's alpha scales coverage.
+        v.framebuffer.fill(0);
+        assert!(draw_text(&mut res, &mut v, id, 16.0, b"HP", 0, 0, HALF));
+        let max = v.framebuffer.iter().map(|&p| p >> 24).max().unwrap();
+        assert!(max > 0 && max <= 0x80, "max alpha 0x{max:02X}");
+        res.fonts.remove(&id);
+        res.text_layouts.remove_font(id);
+    }
 }
@@ -0,0 +1,189 @@
+//! Laid-out text runs, cached per `(font id, px, text)`.
+//!
+//! HUD text is mostly the same strings every frame. Laying one out means UTF-8 validation, a
+//! per-character font lookup and, for bitmap fonts, a bit-by-bit walk of every glyph. The result
+//! only depends on the font, the size and the bytes, so it is kept here:
+//! - TTF/OTF runs hold each character with its pen offset. Coverage still comes from
+//!   `glyph_cache`, so a run costs one glyph lookup per character to draw.
+//! - BDF runs hold the lit pixels already merged into horizontal spans, drawn as 1-row rects.
+//! - Both hold the measured extent, so `text_measure_*` is a lookup too.
+//!
+//! Entries are keyed by a hash of the text and keep the bytes, which are compared on every hit, so
+//! a hash collision lays the run out again instead of drawing the wrong string. The cache is
+//! bounded by a byte budget and evicts least recently used runs (see `lru_cache`).
+
+use std::hash::{DefaultHasher, Hash, Hasher};
+
+use super::lru_cache::LruCache;
+use super::resources::FontResource;
+
+/// Default byte budget for cached runs (256 KiB, thousands of HUD strings).
+pub const DEFAULT_TEXT_LAYOUT_CACHE_BYTES: usize = 256 << 10;
+
+#[derive(Clone, Copy, PartialEq, Eq, Hash, Debug)]
+pub struct TextRunKey {
+    pub font_id: u32,
+    /// TTF/OTF pixel size as `f32` bits (bitmap fonts ignore it).
+    pub px_bits: u32,
+    pub text_hash: u64,
+}
+
+impl TextRunKey {
+    pub fn new(font_id: u32, px: f32, text: &[u8]) -> Self {
+        let mut h = DefaultHasher::new();
+        text.hash(&mut h);
+        Self {
+            font_id,
+            px_bits: px.to_bits(),
+            text_hash: h.finish(),
+        }
+    }
+}
+
+/// Row of lit bitmap-font pixels, relative to the run's origin.
+#[derive(Clone, Copy, PartialEq, Eq, Debug)]
+pub struct Span {
+    pub dx: i32,
+    pub dy: i32,
+    pub len: u32,
+}
+
+pub enum Glyphs {
+    /// Characters with their pen offset from the origin.
+    Ttf(Vec<(char, f32)>),
+    /// Lit pixels, in glyph then row order.
+    Bdf(Vec<Span>),
+}
+
+pub struct TextRun {
+    text: Box<[u8]>,
+    pub glyphs: Glyphs,
+    pub width: u32,
+    pub height: u32,
+}
+
+impl TextRun {
+    fn cost(&self) -> usize {
+        let glyphs = match &self.glyphs {
+            Glyphs::Ttf(g) => g.len() * core::mem::size_of::<(char, f32)>(),
+            Glyphs::Bdf(s) => s.len() * core::mem::size_of::<Span>(),
+        };
+        self.text.len() + glyphs + core::mem::size_of::<Self>()
+    }
+}
+
+/// Lay out `text` in `font`. Matches what the per-character draw and measure paths computed.
+pub fn layout(font: &FontResource, px: f32, text: &str) -> (Glyphs, u32, u32) {
+    match font {
+        FontResource::Ttf(f) => {
+            let mut glyphs = Vec::with_capacity(text.len());
+            let mut pen = 0.0;
+            let mut height: f32 = 0.0;
+            for ch in text.chars() {
+                // Layout metrics only; coverage is rasterized into `glyph_cache` at draw time.
+                let metrics = f.metrics(ch, px);
+                glyphs.push((ch, pen));
+                pen += metrics.advance_width;
+                height = height.max(metrics.height as f32);
+            }
+            (Glyphs::Ttf(glyphs), pen.round() as u32, height as u32)
+        }
+        FontResource::Bdf {
+            width,
+            height,
+            glyphs,
+        } => {
+            let (w, h) = (*width as usize, *height as usize);
+            let stride = w.div_ceil(8);
+            let mut spans = Vec::new();
+            let mut count = 0u32;
+            for ch in text.chars() {
+                let pen = count as i32 * w as i32;
+                count += 1;
+                let Some(bitmap) = glyphs.get(&ch) else {
+                    continue;
+                };
+                let lit = |row: usize, col: usize| {
+                    bitmap
+                        .get(row * stride + col / 8)
+                        .is_some_and(|byte| byte & (0x80 >> (col % 8)) != 0)
+                };
+                for row in 0..h {
+                    let mut col = 0;
+                    while col < w {
+                        if !lit(row, col) {
+                            col += 1;
+                            continue;
+                        }
+                        let start = col;
+                        while col < w && lit(row, col) {
+                            col += 1;
+                        }
+                        spans.push(Span {
+                            dx: pen + start as i32,
+                            dy: row as i32,
+                            len: (col - start) as u32,
+                        });
+                    }
+                }
+            }
+            (Glyphs::Bdf(spans), count * *width, *height)
+        }
+    }
+}
+
+pub struct TextLayoutCache {
+    inner: LruCache<TextRunKey, TextRun>,
+}
+
+impl Default for TextLayoutCache {
+    fn default() -> Self {
+        Self::with_budget(DEFAULT_TEXT_LAYOUT_CACHE_BYTES)
+    }
+}
+
+impl TextLayoutCache {
+    pub fn with_budget(budget_bytes: usize) -> Self {
+        Self {
+            inner: LruCache::with_budget(budget_bytes),
+        }
+    }
+
+    /// The run for `text` in `font` (host id `font_id`) at `px`, laid out on a miss. `None` if
+    /// `text` is not valid UTF-8.
+    pub fn get_or_layout(
+        &mut self,
+        font_id: u32,
+        font: &FontResource,
+        px: f32,
+        text: &[u8],
+    ) -> Option<&TextRun> {
+        let key = TextRunKey::new(font_id, px, text);
+        let hit = self.inner.get(&key).is_some_and(|run| *run.text == *text);
+        if !hit {
+            let (glyphs, width, height) = layout(font, px, core::str::from_utf8(text).ok()?);
+            let run = TextRun {
+                text: text.into(),
+                glyphs,
+                width,
+                height,
+            };
+            let cost = run.cost();
+            self.inner.insert(key, run, cost);
+        }
+        self.inner.get(&key)
+    }
+
+    /// Drop every run of `font_id` (called when the font is unregistered).
+    pub fn remove_font(&mut self, font_id: u32) {
+        self.inner.retain(|k| k.font_id != font_id);
+    }
+
+    pub fn len(&self) -> usize {
+        self.inner.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.inner.is_empty()
+    }
+}
@@ -0,0 +1,336 @@
+//! Tilemap layers (`wasm96_tilemap_*`).
+//!
+//! Board and level rendering with one `rect`/`png_draw_key` call per cell costs thousands of import
+//! calls per frame. A tilemap instead holds a grid of `u16` tile indices on the host and draws it
+//! from pre-rendered chunks of `CHUNK_TILES` x `CHUNK_TILES` tiles:
+//! - Chunks are rendered on first use and kept in a byte-budgeted LRU cache (see `lru_cache`).
+//! - `set_tiles` drops only the chunks whose tiles actually changed.
+//! - `draw` blits each visible chunk once, so scrolling a large map costs one blit per visible
+//!   chunk.
+//!
+//! Tile `0` is empty (transparent); tile `n` is cell `n - 1` of the tileset, counted row-major. The
+//! tileset is copied out of `keyed_images` (premultiplied) when the map is created, so later
+//! changes to that key do not affect existing maps.
+
+use wasmtime::Caller;
+
+use crate::abi::tilemap::{CHUNK_TILES, TILE_EMPTY};
+use crate::state::VideoState;
+
+use super::graphics::lock_state;
+use super::lru_cache::LruCache;
+use super::raster;
+use super::resources::{ImageResource, RESOURCES};
+
+/// Default byte budget for one map's rendered chunks (4 MiB, e.g. 16 chunks of 256x256 pixels).
+pub const DEFAULT_TILEMAP_CACHE_BYTES: usize = 4 << 20;
+
+/// A rendered chunk: premultiplied 0xAARRGGBB pixels, row-major. Empty if every tile is empty.
+struct Chunk {
+    pixels: Vec<u32>,
+}
+
+pub struct Tilemap {
+    tile_w: u32,
+    tile_h: u32,
+    map_w: u32,
+    map_h: u32,
+    tiles: Vec<u16>,
+
+    // Premultiplied tileset pixels and its size in whole tiles.
+    tileset: Vec<u32>,
+    tileset_w: u32,
+    tileset_cols: u32,
+    tileset_count: u32,
+
+    chunks: LruCache<u32, Chunk>,
+}
+
+/// Work done by one `Tilemap::draw` (for tests and profiling).
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct TilemapDrawStats {
+    pub chunks_blitted: u32,
+    pub chunks_rendered: u32,
+}
+
+impl Tilemap {
+    /// Create an empty `map_w` x `map_h` map using `tile_w` x `tile_h` cells of `tileset`.
+    ///
+    /// Returns `None` if any dimension is zero or the tileset holds no whole tile.
+    pub fn new(
+        tileset: &ImageResource,
+        tile_w: u32,
+        tile_h: u32,
+        map_w: u32,
+        map_h: u32,
+    ) -> Option<Self> {
+        if tile_w == 0 || tile_h == 0 || map_w == 0 || map_h == 0 {
+            return None;
+        }
+        let cols = tileset.width / tile_w;
+        let rows = tileset.height / tile_h;
+        let px = tileset.width as usize * tileset.height as usize;
+        if cols == 0 || rows == 0 || tileset.rgba.len() < px * 4 {
+            return None;
+        }
+        let tile_count = (map_w as usize).checked_mul(map_h as usize)?;
+
+        let pixels = tileset.rgba[..px * 4]
+            .chunks_exact(4)
+            .map(|p| premultiply(p[0], p[1], p[2], p[3]))
+            .collect();
+
+        Some(Self {
+            tile_w,
+            tile_h,
+            map_w,
+            map_h,
+            tiles: vec![TILE_EMPTY; tile_count],
+            tileset: pixels,
+            tileset_w: tileset.width,
+            tileset_cols: cols,
+            tileset_count: cols.saturating_mul(rows),
+            chunks: LruCache::with_budget(DEFAULT_TILEMAP_CACHE_BYTES),
+        })
+    }
+
+    /// Map size in tiles.
+    pub fn size(&self) -> (u32, u32) {
+        (self.map_w, self.map_h)
+    }
+
+    /// Every tile, row-major.
+    pub fn tiles(&self) -> &[u16] {
+        &self.tiles
+    }
+
+    pub fn tile(&self, x: u32, y: u32) -> Option<u16> {
+        if x >= self.map_w || y >= self.map_h {
+            return None;
+        }
+        Some(self.tiles[(y * self.map_w + x) as usize])
+    }
+
+    /// Overwrite the `w` x `h` block at (`x`, `y`) with `tiles` (row-major), clipped to the map.
+    ///
+    /// Returns the number of tiles whose value changed; only their chunks are re-rendered.
+    pub fn set_tiles(&mut self, x: u32, y: u32, w: u32, h: u32, tiles: &[u16]) -> u32 {
+        if (w as usize) * (h as usize) > tiles.len() {
+            return 0;
+        }
+        let mut changed = 0;
+        for row in 0..h {
+            let my = y as u64 + row as u64;
+            if my >= self.map_h as u64 {
+                break;
+            }
+            for col in 0..w {
+                let mx = x as u64 + col as u64;
+                if mx >= self.map_w as u64 {
+                    break;
+                }
+                let (mx, my) = (mx as u32, my as u32);
+                let value = tiles[(row * w + col) as usize];
+                let slot = &mut self.tiles[(my * self.map_w + mx) as usize];
+                if *slot != value {
+                    *slot = value;
+                    changed += 1;
+                    self.chunks
+                        .remove(&self.chunk_index(mx / CHUNK_TILES, my / CHUNK_TILES));
+                }
+            }
+        }
+        changed
+    }
+
+    /// Draw the map so that map pixel (`scroll_x`, `scroll_y`) lands on screen pixel (0, 0).
+    ///
+    /// Only chunks that intersect the screen are rendered or blitted; the map does not wrap.
+    pub fn draw(&mut self, v: &mut VideoState, scroll_x: i32, scroll_y: i32) -> TilemapDrawStats {
+        let mut stats = TilemapDrawStats::default();
+        let chunk_px_w = (CHUNK_TILES * self.tile_w) as i64;
+        let chunk_px_h = (CHUNK_TILES * self.tile_h) as i64;
+        let chunks_x = self.map_w.div_ceil(CHUNK_TILES) as i64;
+        let chunks_y = self.map_h.div_ceil(CHUNK_TILES) as i64;
+
+        // Visible map-pixel window -> chunk range.
+        let (sx, sy) = (scroll_x as i64, scroll_y as i64);
+        let cx0 = sx.max(0) / chunk_px_w;
+        let cy0 = sy.max(0) / chunk_px_h;
+        let cx1 = ((sx + v.width as i64 + chunk_px_w - 1) / chunk_px_w).min(chunks_x);
+        let cy1 = ((sy + v.height as i64 + chunk_px_h - 1) / chunk_px_h).min(chunks_y);
+
+        for cy in cy0..cy1 {
+            for cx in cx0..cx1 {
+                let (cx, cy) = (cx as u32, cy as u32);
+                let (w, h) = self.chunk_size_px(cx, cy);
+                let index = self.chunk_index(cx, cy);
+                if !self.chunks.contains_key(&index) {
+                    let chunk = self.render_chunk(cx, cy);
+                    let cost = chunk.pixels.len() * 4 + core::mem::size_of::<Chunk>();
+                    self.chunks.insert(index, chunk, cost);
+                    stats.chunks_rendered += 1;
+                }
+                let chunk = self.chunks.get(&index).expect("chunk inserted above");
+                if chunk.pixels.is_empty() {
+                    continue;
+                }
+                let x = (cx as i64 * chunk_px_w - sx) as i32;
+                let y = (cy as i64 * chunk_px_h - sy) as i32;
+                raster::blit_premultiplied(v, x, y, w, h, &chunk.pixels);
+                stats.chunks_blitted += 1;
+            }
+        }
+        stats
+    }
+
+    fn chunk_index(&self, cx: u32, cy: u32) -> u32 {
+        cy * self.map_w.div_ceil(CHUNK_TILES) + cx
+    }
+
+    /// Pixel size of chunk (`cx`, `cy`); edge chunks are cut to the map.
+    fn chunk_size_px(&self, cx: u32, cy: u32) -> (u32, u32) {
+        let tiles_w = CHUNK_TILES.min(self.map_w - cx * CHUNK_TILES);
+        let tiles_h = CHUNK_TILES.min(self.map_h - cy * CHUNK_TILES);
+        (tiles_w * self.tile_w, tiles_h * self.tile_h)
+    }
+
+    fn render_chunk(&self, cx: u32, cy: u32) -> Chunk {
+        let (w, h) = self.chunk_size_px(cx, cy);
+        let (tx0, ty0) = (cx * CHUNK_TILES, cy * CHUNK_TILES);
+        let (tiles_w, tiles_h) = (w / self.tile_w, h / self.tile_h);
+
+        let visible = (0..tiles_h).any(|ty| {
+            (0..tiles_w).any(|tx| self.source_tile(self.tile_at(tx0 + tx, ty0 + ty)).is_some())
+        });
+        if !visible {
+            return Chunk { pixels: Vec::new() };
+        }
+
+        let mut pixels = vec![0u32; w as usize * h as usize];
+        let (tw, th) = (self.tile_w as usize, self.tile_h as usize);
+        for ty in 0..tiles_h {
+            for tx in 0..tiles_w {
+                let Some(cell) = self.source_tile(self.tile_at(tx0 + tx, ty0 + ty)) else {
+                    continue;
+                };
+                let src_x = (cell % self.tileset_cols) as usize * tw;
+                let src_y = (cell / self.tileset_cols) as usize * th;
+                for row in 0..th {
+                    let src = (src_y + row) * self.tileset_w as usize + src_x;
+                    let dst = (ty as usize * th + row) * w as usize + tx as usize * tw;
+                    pixels[dst..dst + tw].copy_from_slice(&self.tileset[src..src + tw]);
+                }
+            }
+        }
+        Chunk { pixels }
+    }
+
+    fn tile_at(&self, x: u32, y: u32) -> u16 {
+        self.tiles[(y * self.map_w + x) as usize]
+    }
+
+    /// Tileset cell for a tile value, or `None` for empty / out-of-range tiles.
+    fn source_tile(&self, tile: u16) -> Option<u32> {
+        let cell = (tile as u32).checked_sub(1)?;
+        (cell < self.tileset_count).then_some(cell)
+    }
+
+    pub fn cached_chunks(&self) -> usize {
+        self.chunks.len()
+    }
+}
+
+/// Straight RGBA -> premultiplied 0xAARRGGBB.
+fn premultiply(r: u8, g: u8, b: u8, a: u8) -> u32 {
+    let a32 = a as u32;
+    let mul = |c: u8| (c as u32 * a32 + 127) / 255;
+    (a32 << 24) | (mul(r) << 16) | (mul(g) << 8) | mul(b)
+}
+
+/// Create (or replace) the tilemap `key`, using the keyed PNG/JPEG `tileset_key` as its tileset.
+///
+/// Returns `1` on success, `0` if the tileset is missing or the dimensions are invalid.
+pub fn tilemap_create(
+    key: u64,
+    tileset_key: u64,
+    tile_w: u32,
+    tile_h: u32,
+    map_w: u32,
+    map_h: u32,
+) -> u32 {
+    let mut res = RESOURCES.lock().unwrap();
+    let Some(tileset) = res.keyed_images.get(&tileset_key) else {
+        return 0;
+    };
+    match Tilemap::new(tileset, tile_w, tile_h, map_w, map_h) {
+        Some(map) => {
+            res.tilemaps.insert(key, map);
+            1
+        }
+        None => 0,
+    }
+}
+
+/// Copy a `w` x `h` block of `u16` tiles from guest memory into the map.
+///
+/// Returns the number of tiles that changed.
+pub fn tilemap_set_tiles(
+    caller: &mut Caller<'_, ()>,
+    key: u64,
+    x: u32,
+    y: u32,
+    w: u32,
+    h: u32,
+    ptr: u32,
+) -> u32 {
+    let memory = match caller.get_export("memory").and_then(|e| e.into_memory()) {
+        Some(m) => m,
+        None => return 0,
+    };
+
+    let data = memory.data(&*caller);
+    let start = ptr as usize;
+    let Some(end) = (w as usize)
+        .checked_mul(h as usize)
+        .and_then(|n| n.checked_mul(2))
+        .and_then(|len| start.checked_add(len))
+    else {
+        return 0;
+    };
+    let Some(bytes) = data.get(start..end) else {
+        return 0;
+    };
+    let tiles: Vec<u16> = bytes
+        .chunks_exact(2)
+        .map(|b| u16::from_le_bytes([b[0], b[1]]))
+        .collect();
+
+    let mut res = RESOURCES.lock().unwrap();
+    match res.tilemaps.get_mut(&key) {
+        Some(map) => map.set_tiles(x, y, w, h, &tiles),
+        None => 0,
+    }
+}
+
+/// Set a single tile.
+pub fn tilemap_set_tile(key: u64, x: u32, y: u32, tile: u32) {
+    let mut res = RESOURCES.lock().unwrap();
+    if let Some(map) = res.tilemaps.get_mut(&key) {
+        map.set_tiles(x, y, 1, 1, &[tile as u16]);
+    }
+}
+
+/// Draw the tilemap `key` scrolled by (`scroll_x`, `scroll_y`) map pixels.
+pub fn tilemap_draw(key: u64, scroll_x: i32, scroll_y: i32) {
+    // Lock order: RESOURCES before the global state.
+    let mut res = RESOURCES.lock().unwrap();
+    if let Some(map) = res.tilemaps.get_mut(&key) {
+        map.draw(&mut lock_state().video, scroll_x, scroll_y);
+    }
+}
+
+/// Drop the tilemap `key` and its cached chunks.
+pub fn tilemap_destroy(key: u64) {
+    RESOURCES.lock().unwrap().tilemaps.remove(&key);
+}
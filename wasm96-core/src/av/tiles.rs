@@ -0,0 +1,437 @@
+//! Deferred, tiled rasterization of the 2D primitives.
+//!
+//! In immediate mode every `wasm96_graphics_*` primitive is rasterized on the libretro thread as
+//! it arrives. When deferred mode is on (more than one raster thread, see `set_threads`),
+//! `raster::submit` records damage as usual but only appends the shape to a display list. The
+//! list is drawn by `resolve`, either at present time or at the first operation that needs
+//! finished pixels (raw and SVG blits, tilemaps, savestates). Keyed images, sprites and TTF
+//! glyphs are recorded alongside the shapes as `sprites::Blit`s. Drawing the list:
+//! - The framebuffer is split into bands of whole rows. Every op already draws row by row, so a
+//!   band is one contiguous slice that can be lent to a worker safely.
+//! - Each op is binned to the bands its clipped bounding box touches. Bins keep
+//!   submission order, so translucent overlaps blend exactly as in immediate mode.
+//! - Bands are dealt round-robin into shares, which spreads a band-local hotspot such as a
+//!   particle burst across workers. The calling thread draws one share and lends the rest to a
+//!   pool of long-lived workers, spawned once when deferred mode is switched on (the same model
+//!   as the asset loader). A `resolve` only queues work and waits for it; it never spawns.
+//!
+//! Lists that cover fewer than `PARALLEL_MIN_PIXELS` are drawn on the calling thread, so a light
+//! UI frame costs no worker wake-ups. Clears do not count toward that area: a full-screen clear is
+//! a plain fill and would otherwise push every frame over the threshold. A full clear drops
+//! everything recorded before it.
+//!
+//! Immediate mode stays the default until a multi-core benchmark shows banding ahead (the one
+//! measurement so far predates the pool and found it slower). `WASM96_RASTER_THREADS=<n>` opts
+//! in, capped at `MAX_THREADS`. With a GL context the list is always recorded, and present draws it on the GPU
+//! when it can (see `gpu2d`).
+
+use std::panic::AssertUnwindSafe;
+use std::sync::mpsc::{Receiver, Sender, channel};
+use std::sync::{Arc, Mutex, OnceLock};
+
+use crate::state::{DamageRect, VideoState};
+
+use super::raster::{Canvas, Shape};
+use super::sprites::Blit;
+
+/// Environment variable setting the raster thread count (unset or `1` keeps immediate mode).
+pub const ENV_VAR: &str = "WASM96_RASTER_THREADS";
+
+/// Thread cap; fill rate stops scaling past this on typical frame sizes.
+const MAX_THREADS: usize = 8;
+
+/// Lists whose clipped bounding boxes cover fewer pixels than this are drawn on one thread.
+const PARALLEL_MIN_PIXELS: u64 = 128 * 1024;
+
+/// Band height limits. Bands are sized so each thread gets about four.
+const MIN_BAND_ROWS: u32 = 8;
+const MAX_BAND_ROWS: u32 = 64;
+
+#[derive(Debug, Clone)]
+pub struct Op {
+    pub item: Item,
+    /// Clipped rows the op can touch, for binning.
+    y0: u32,
+    y1: u32,
+}
+
+/// What an op draws.
+#[derive(Debug, Clone)]
+pub enum Item {
+    /// A primitive in a straight-alpha color.
+    Shape(Shape, u32),
+    Blit(Blit),
+}
+
+impl Op {
+    /// Draw the part of the op inside `c`.
+    pub fn draw(&self, c: &mut Canvas<'_>) {
+        match &self.item {
+            Item::Shape(shape, color) => shape.draw(c, *color),
+            Item::Blit(blit) => blit.draw(c),
+        }
+    }
+
+    /// Unclipped bounding box as `(x0, y0, x1, y1)`.
+    pub fn bounds(&self) -> (i32, i32, i32, i32) {
+        match &self.item {
+            Item::Shape(shape, _) => shape.bounds(),
+            Item::Blit(blit) => blit.bounds(),
+        }
+    }
+}
+
+/// Primitives recorded for the current frame but not yet rasterized.
+#[derive(Debug, Default)]
+pub struct DisplayList {
+    ops: Vec<Op>,
+    /// Sum of the ops' clipped bounding-box areas, clears excluded.
+    pixels: u64,
+    /// Raster threads; 0 or 1 means immediate mode.
+    threads: usize,
+    /// Per-band op indices, kept between frames for their allocations.
+    bins: Vec<Vec<u32>>,
+    /// Record for the GPU 2D pass (a GL context exists).
+    gpu: bool,
+    /// What the GPU pass drew from the recorded ops. Neither the framebuffer nor the overlay
+    /// texture holds those pixels, so `resolve` damages this area again.
+    gpu_drawn: DamageRect,
+}
+
+impl DisplayList {
+    /// Whether primitives are recorded instead of drawn immediately.
+    pub fn is_deferred(&self) -> bool {
+        self.threads > 1 || self.gpu
+    }
+
+    /// Whether the GPU pass draws the recorded primitives (a GL context exists).
+    pub fn is_gpu(&self) -> bool {
+        self.gpu
+    }
+
+    pub fn threads(&self) -> usize {
+        self.threads.max(1)
+    }
+
+    pub fn len(&self) -> usize {
+        self.ops.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.ops.is_empty()
+    }
+
+    /// Recorded ops, in submission order.
+    pub fn ops(&self) -> &[Op] {
+        &self.ops
+    }
+
+    /// Lend the ops to the GPU pass. The list reads as empty, so present does not rasterize
+    /// them, until `end_gpu_frame` hands them back.
+    pub fn begin_gpu_frame(&mut self) -> Vec<Op> {
+        std::mem::take(&mut self.ops)
+    }
+
+    /// Take back the ops lent by `begin_gpu_frame`, ahead of anything recorded since. They stay
+    /// recorded for a later `resolve`, which damages `drawn` again.
+    pub fn end_gpu_frame(&mut self, ops: Vec<Op>, drawn: DamageRect) {
+        let later = std::mem::replace(&mut self.ops, ops);
+        self.ops.extend(later);
+        self.gpu_drawn.union(drawn);
+    }
+
+    /// Append `shape`, whose clipped bounding box is `rect`. Shapes that are entirely off-screen
+    /// or drawn with a transparent color are dropped.
+    pub fn push(&mut self, shape: Shape, color: u32, rect: DamageRect) {
+        let writes_transparent = matches!(shape, Shape::Clear | Shape::ClearRect { .. });
+        if rect.is_empty() || (color >> 24 == 0 && !writes_transparent) {
+            return;
+        }
+        if !writes_transparent {
+            self.pixels += rect.width() as u64 * rect.height() as u64;
+        }
+        self.ops.push(Op {
+            item: Item::Shape(shape, color),
+            y0: rect.y0,
+            y1: rect.y1,
+        });
+    }
+
+    /// Append `blit`, whose clipped destination is `rect`. Off-screen blits are dropped.
+    pub fn push_blit(&mut self, blit: Blit, rect: DamageRect) {
+        if rect.is_empty() {
+            return;
+        }
+        self.pixels += rect.width() as u64 * rect.height() as u64;
+        self.ops.push(Op {
+            item: Item::Blit(blit),
+            y0: rect.y0,
+            y1: rect.y1,
+        });
+    }
+
+    /// Drop everything recorded (a full clear hides it, or a savestate restore replaced it).
+    pub fn discard(&mut self) {
+        self.ops.clear();
+        self.pixels = 0;
+        self.gpu_drawn = DamageRect::default();
+    }
+}
+
+/// Pick the raster thread count: `WASM96_RASTER_THREADS` (up to `MAX_THREADS`) if set, else 1.
+/// Anything recorded so far is drawn first. Recording for the GPU pass follows whether a GL
+/// context exists.
+pub fn configure(v: &mut VideoState) {
+    let threads = std::env::var(ENV_VAR)
+        .ok()
+        .and_then(|s| s.trim().parse::<usize>().ok())
+        .unwrap_or(1);
+    set_threads(v, threads);
+    v.display_list.gpu = super::graphics3d::gl_available();
+}
+
+/// Record every primitive for the GPU pass (`true`) or only when threads are configured.
+pub fn set_gpu(v: &mut VideoState, gpu: bool) {
+    resolve(v);
+    v.display_list.gpu = gpu;
+}
+
+/// Set the raster thread count directly (`0`/`1` = immediate mode, capped at `MAX_THREADS`).
+/// Spawns the workers that count needs, once; they stay parked between frames.
+pub fn set_threads(v: &mut VideoState, threads: usize) {
+    resolve(v);
+    let threads = threads.min(MAX_THREADS);
+    if threads > 1 {
+        lock_pool().grow(threads - 1);
+    }
+    v.display_list.threads = threads;
+}
+
+/// Rasterize and clear the display list, leaving the framebuffer up to date.
+pub fn resolve(v: &mut VideoState) {
+    if v.display_list.ops.is_empty() {
+        return;
+    }
+    let drawn = std::mem::take(&mut v.display_list.gpu_drawn);
+    if !drawn.is_empty() {
+        v.mark_damage(
+            drawn.x0 as i32,
+            drawn.y0 as i32,
+            drawn.x1 as i32,
+            drawn.y1 as i32,
+        );
+    }
+    let list = &mut v.display_list;
+    let threads = list.threads;
+    let (width, height) = (v.width, v.height);
+
+    if threads <= 1 || list.pixels < PARALLEL_MIN_PIXELS || height < 2 * MIN_BAND_ROWS {
+        let mut canvas = Canvas {
+            pixels: &mut v.framebuffer,
+            width: width as i32,
+            y0: 0,
+            y1: height as i32,
+            spans: None,
+        };
+        for op in &list.ops {
+            op.draw(&mut canvas);
+        }
+    } else {
+        let band_rows = (height / (threads as u32 * 4)).clamp(MIN_BAND_ROWS, MAX_BAND_ROWS);
+        bin(list, band_rows, height);
+        let len = ((width * height) as usize).min(v.framebuffer.len());
+        draw_bands(
+            &mut v.framebuffer[..len],
+            width,
+            band_rows,
+            &list.ops,
+            &list.bins,
+            threads,
+        );
+    }
+    list.discard();
+}
+
+/// Fill `list.bins` with the indices of the ops touching each `band_rows`-row band.
+fn bin(list: &mut DisplayList, band_rows: u32, height: u32) {
+    let bands = height.div_ceil(band_rows) as usize;
+    list.bins.resize_with(bands, Vec::new);
+    for bin in &mut list.bins[..bands] {
+        bin.clear();
+    }
+    for (i, op) in list.ops.iter().enumerate() {
+        for band in op.y0 / band_rows..=(op.y1 - 1) / band_rows {
+            list.bins[band as usize].push(i as u32);
+        }
+    }
+}
+
+fn draw_bands(
+    framebuffer: &mut [u32],
+    width: u32,
+    band_rows: u32,
+    ops: &[Op],
+    bins: &[Vec<u32>],
+    threads: usize,
+) {
+    let mut work: Vec<Vec<Job>> = (0..threads).map(|_| Vec::new()).collect();
+    let band_len = (band_rows * width) as usize;
+    for (band, pixels) in framebuffer.chunks_mut(band_len).enumerate() {
+        let bin = &bins[band];
+        if !bin.is_empty() {
+            work[band % threads].push(((band as u32 * band_rows) as i32, pixels, bin));
+        }
+    }
+
+    let draw = |jobs: Vec<Job>| {
+        for (y0, pixels, bin) in jobs {
+            let rows = (pixels.len() / width as usize) as i32;
+            let mut canvas = Canvas {
+                pixels,
+                width: width as i32,
+                y0,
+                y1: y0 + rows,
+                spans: None,
+            };
+            for &i in bin {
+                ops[i as usize].draw(&mut canvas);
+            }
+        }
+    };
+
+    let shares: Vec<Mutex<Vec<Job>>> = work
+        .into_iter()
+        .filter(|jobs| !jobs.is_empty())
+        .map(Mutex::new)
+        .collect();
+    let draw_share = |share: usize| {
+        let jobs = std::mem::take(&mut *shares[share].lock().unwrap());
+        draw(jobs);
+    };
+    let draw_share: &(dyn Fn(usize) + Sync) = &draw_share;
+
+    let (done_tx, done_rx) = channel();
+    let mut lent = Lent {
+        done: done_rx,
+        pending: 0,
+        failed: false,
+    };
+    if shares.len() > 1 {
+        let pool = lock_pool();
+        // SAFETY: only the lifetime is erased. `lent` waits for every lent share before this
+        // function returns or unwinds, so no worker uses `draw_share` after its borrows end.
+        let draw = unsafe {
+            std::mem::transmute::<&(dyn Fn(usize) + Sync), *const (dyn Fn(usize) + Sync)>(
+                draw_share,
+            )
+        };
+        for share in 1..shares.len() {
+            let done = done_tx.clone();
+            if pool.workers > 0 && pool.jobs.send(Batch { draw, share, done }).is_ok() {
+                lent.pending += 1;
+            } else {
+                draw_share(share);
+            }
+        }
+    }
+    drop(done_tx);
+    if !shares.is_empty() {
+        draw_share(0);
+    }
+    assert!(!lent.finish(), "raster worker panicked");
+}
+
+type Job<'a> = (i32, &'a mut [u32], &'a [u32]);
+
+/// Shares handed to the pool by one `draw_bands` call. Dropping it (even while unwinding)
+/// blocks until every lent share has been drawn.
+struct Lent {
+    done: Receiver<bool>,
+    pending: usize,
+    failed: bool,
+}
+
+impl Lent {
+    /// Wait for the lent shares; returns whether any of them panicked.
+    fn finish(mut self) -> bool {
+        self.wait();
+        self.failed
+    }
+
+    fn wait(&mut self) {
+        while self.pending > 0 {
+            // A closed channel means the worker died with the batch; nothing references it now.
+            let drawn = self.done.recv().unwrap_or(false);
+            self.failed |= !drawn;
+            self.pending -= 1;
+        }
+    }
+}
+
+impl Drop for Lent {
+    fn drop(&mut self) {
+        self.wait();
+    }
+}
+
+/// One share of bands lent to a pool worker.
+struct Batch {
+    /// Draws share `share`. Borrowed from `draw_bands`, which outlives the batch (see `Lent`).
+    draw: *const (dyn Fn(usize) + Sync),
+    share: usize,
+    done: Sender<bool>,
+}
+
+// SAFETY: `draw` points at a `Sync` closure that stays alive until `done` reports back.
+unsafe impl Send for Batch {}
+
+/// Long-lived raster workers, all taking batches from one queue.
+struct Pool {
+    jobs: Sender<Batch>,
+    queue: Arc<Mutex<Receiver<Batch>>>,
+    workers: usize,
+}
+
+static POOL: OnceLock<Mutex<Pool>> = OnceLock::new();
+
+fn lock_pool() -> std::sync::MutexGuard<'static, Pool> {
+    let pool = POOL.get_or_init(|| {
+        let (jobs, queue) = channel();
+        Mutex::new(Pool {
+            jobs,
+            queue: Arc::new(Mutex::new(queue)),
+            workers: 0,
+        })
+    });
+    match pool.lock() {
+        Ok(p) => p,
+        Err(poisoned) => poisoned.into_inner(),
+    }
+}
+
+impl Pool {
+    /// Spawn workers until there are `workers` of them (or spawning fails).
+    fn grow(&mut self, workers: usize) {
+        while self.workers < workers {
+            let queue = Arc::clone(&self.queue);
+            let worker = std::thread::Builder::new()
+                .name(format!("wasm96-raster-{}", self.workers))
+                .spawn(move || {
+                    loop {
+                        let batch = queue.lock().unwrap().recv();
+                        let Ok(batch) = batch else { return };
+                        // SAFETY: see `Batch`.
+                        let draw = unsafe { &*batch.draw };
+                        let drawn =
+                            std::panic::catch_unwind(AssertUnwindSafe(|| draw(batch.share)))
+                                .is_ok();
+                        let _ = batch.done.send(drawn);
+                    }
+                });
+            if worker.is_err() {
+                return;
+            }
+            self.workers += 1;
+        }
+    }
+}
@@ -12,6 +12,7 @@ use wasmtime::Caller;
 use alloc::vec::Vec;
 
 use super::AvError;
+use super::raster::put_texel;
 
 pub fn read_guest_bytes(
     caller: &mut Caller<'_, ()>,
@@ -27,6 +28,7 @@ pub fn read_guest_bytes(
     memory
         .read(&*caller, ptr as usize, &mut data)
         .map_err(|_| AvError::MemoryReadFailed)?;
+    crate::profile::bytes_in(data.len());
     Ok(data)
 }
 
@@ -47,14 +49,16 @@ pub fn graphics_image_from_host(x: i32, y: i32, w: u32, h: u32, data: &[u8]) {
         Ok(g) => g,
         Err(poisoned) => poisoned.into_inner(),
     };
+    super::tiles::resolve(&mut s.video);
     let screen_w = s.video.width as i32;
     let screen_h = s.video.height as i32;
-    let fb = &mut s.video.framebuffer;
 
     let x_start = x.max(0);
     let y_start = y.max(0);
     let x_end = (x + w as i32).min(screen_w);
     let y_end = (y + h as i32).min(screen_h);
+    s.video.mark_damage(x_start, y_start, x_end, y_end);
+    let fb = &mut s.video.framebuffer;
 
     for curr_y in y_start..y_end {
         let src_y = curr_y - y;
@@ -67,10 +71,8 @@ pub fn graphics_image_from_host(x: i32, y: i32, w: u32, h: u32, data: &[u8]) {
             let g = data[src_idx + 1];
             let b = data[src_idx + 2];
             let a = data[src_idx + 3];
-            if a > 0 {
-                let color = ((r as u32) << 16) | ((g as u32) << 8) | (b as u32);
-                fb[dst_row_start + (curr_x as usize)] = color;
-            }
+            let rgb = ((r as u32) << 16) | ((g as u32) << 8) | (b as u32);
+            put_texel(&mut fb[dst_row_start + (curr_x as usize)], rgb, a as u32);
         }
     }
 }
@@ -84,6 +86,21 @@ pub fn system_millis() -> u64 {
         .as_millis() as u64
 }
 
+/// Write the last frame's profile (`abi::stats` layout) into `len` bytes of guest memory at `ptr`.
+///
+/// Only whole import entries are written. Returns the size of the full report, so a guest can probe
+/// with `len = 0` and size its buffer; the first call also turns profiling on.
+pub fn system_stats(caller: &mut Caller<'_, ()>, ptr: u32, len: u32) -> u32 {
+    crate::profile::enable();
+    let (report, needed) = crate::profile::encode_stats(len as usize);
+    if report.len() <= len as usize
+        && let Some(memory) = caller.get_export("memory").and_then(|e| e.into_memory())
+    {
+        let _ = memory.write(&mut *caller, ptr as usize, &report);
+    }
+    needed as u32
+}
+
 #[inline]
 pub fn sat_add_i16(a: i16, b: i16) -> i16 {
     let s = a as i32 + b as i32;
@@ -0,0 +1,184 @@
+//! Headless frontend for the `wasm96-bench` binary.
+//!
+//! Stands in for a libretro frontend: video and audio callbacks only count what they receive, and
+//! the input callbacks report the buttons an `InputScript` holds for the current frame. Profiling
+//! is switched on so each `Wasm96Core::run_frame` leaves a `FrameSample` behind.
+//!
+//! No GL context exists, so 3D draws are skipped and 2D primitives take the CPU rasterizer (as
+//! `WASM96_RASTER_THREADS` configures it). The module cache is not configured, so every load
+//! measures a cold compile.
+
+use std::ffi::{c_uint, c_void};
+use std::sync::atomic::{AtomicU32, AtomicU64, Ordering};
+
+use crate::abi::Button;
+use crate::abi::input::MAX_PORTS;
+use crate::state;
+
+pub use crate::profile::{FrameSample, Phase, last_frame};
+
+/// Buttons held per port (bit `n` is `abi::Button` `n`), read by `input_state`.
+static HELD: [AtomicU32; MAX_PORTS as usize] = [const { AtomicU32::new(0) }; MAX_PORTS as usize];
+
+static FRAMES_PRESENTED: AtomicU64 = AtomicU64::new(0);
+static FRAMES_DUPED: AtomicU64 = AtomicU64::new(0);
+static AUDIO_FRAMES: AtomicU64 = AtomicU64::new(0);
+
+unsafe extern "C" fn video_refresh(data: *const c_void, _w: c_uint, _h: c_uint, _pitch: usize) {
+    if data.is_null() {
+        FRAMES_DUPED.fetch_add(1, Ordering::Relaxed);
+    } else {
+        FRAMES_PRESENTED.fetch_add(1, Ordering::Relaxed);
+    }
+}
+
+unsafe extern "C" fn audio_sample(_left: i16, _right: i16) {
+    AUDIO_FRAMES.fetch_add(1, Ordering::Relaxed);
+}
+
+unsafe extern "C" fn audio_sample_batch(_data: *const i16, frames: usize) -> usize {
+    AUDIO_FRAMES.fetch_add(frames as u64, Ordering::Relaxed);
+    frames
+}
+
+unsafe extern "C" fn input_poll() {}
+
+unsafe extern "C" fn input_state(port: c_uint, _device: c_uint, _index: c_uint, id: c_uint) -> i16 {
+    let Some(held) = HELD.get(port as usize) else {
+        return 0;
+    };
+    let held = held.load(Ordering::Relaxed);
+    (0..=Button::R3 as u32)
+        .any(|b| held & (1 << b) != 0 && crate::input::map_joypad_button(b) == Some(id)) as i16
+}
+
+/// Install the stub callbacks and turn profiling on. Call before loading a guest.
+pub fn install_frontend() {
+    state::set_video_refresh_cb(Some(video_refresh));
+    state::set_audio_sample_cb(Some(audio_sample));
+    state::set_audio_sample_batch_cb(Some(audio_sample_batch));
+    state::set_input_poll_cb(Some(input_poll));
+    state::set_input_state_cb(Some(input_state));
+    // Like RetroArch, so unchanged frames are reported as dupes.
+    state::set_frontend_can_dupe(true);
+    crate::profile::enable();
+}
+
+/// What the stub frontend received so far.
+#[derive(Debug, Default, Clone, Copy)]
+pub struct OutputCounts {
+    pub frames_presented: u64,
+    pub frames_duped: u64,
+    pub audio_frames: u64,
+}
+
+pub fn output_counts() -> OutputCounts {
+    OutputCounts {
+        frames_presented: FRAMES_PRESENTED.load(Ordering::Relaxed),
+        frames_duped: FRAMES_DUPED.load(Ordering::Relaxed),
+        audio_frames: AUDIO_FRAMES.load(Ordering::Relaxed),
+    }
+}
+
+const BUTTON_NAMES: [&str; 16] = [
+    "b", "y", "select", "start", "up", "down", "left", "right", "a", "x", "l1", "r1", "l2", "r2",
+    "l3", "r3",
+];
+
+/// Scripted joypad input.
+///
+/// One event per line: `<frame> <port> <button>...`, where buttons are `BUTTON_NAMES` (case
+/// insensitive) and `-` or no buttons releases everything. An event holds its buttons on that
+/// port until the port's next event. `loop <frames>` replays the script with that period. Blank
+/// lines and `#` comments are ignored.
+#[derive(Debug, Default, Clone)]
+pub struct InputScript {
+    /// `(frame, port, mask)`, sorted by frame.
+    events: Vec<(u32, u32, u32)>,
+    period: Option<u32>,
+}
+
+impl InputScript {
+    pub fn parse(text: &str) -> Result<Self, String> {
+        let mut script = Self::default();
+        for (n, line) in text.lines().enumerate() {
+            let line = line.split('#').next().unwrap_or("").trim();
+            let mut words = line.split_whitespace();
+            let Some(first) = words.next() else {
+                continue;
+            };
+            let err = |what: &str| format!("line {}: {what}", n + 1);
+            if first == "loop" {
+                let period = words.next().and_then(|w| w.parse::<u32>().ok());
+                script.period = Some(period.filter(|&p| p > 0).ok_or_else(|| err("bad loop"))?);
+                continue;
+            }
+            let frame = first.parse::<u32>().map_err(|_| err("bad frame"))?;
+            let port = words
+                .next()
+                .and_then(|w| w.parse::<u32>().ok())
+                .filter(|&p| p < MAX_PORTS)
+                .ok_or_else(|| err("bad port"))?;
+            let mut mask = 0;
+            for word in words.filter(|&w| w != "-") {
+                let button = BUTTON_NAMES
+                    .iter()
+                    .position(|name| name.eq_ignore_ascii_case(word))
+                    .ok_or_else(|| err(&format!("unknown button `{word}`")))?;
+                mask |= 1 << button;
+            }
+            script.events.push((frame, port, mask));
+        }
+        // Stable, so events for one frame keep their order.
+        script.events.sort_by_key(|e| e.0);
+        Ok(script)
+    }
+
+    /// Buttons held on each port at `frame`.
+    pub fn buttons_at(&self, frame: u32) -> [u32; MAX_PORTS as usize] {
+        let frame = self.period.map_or(frame, |p| frame % p);
+        let mut held = [0; MAX_PORTS as usize];
+        for &(_, port, mask) in self.events.iter().take_while(|e| e.0 <= frame) {
+            held[port as usize] = mask;
+        }
+        held
+    }
+
+    /// Hold this script's buttons for `frame`. Call before each `run_frame`.
+    pub fn apply(&self, frame: u32) {
+        for (slot, mask) in HELD.iter().zip(self.buttons_at(frame)) {
+            slot.store(mask, Ordering::Relaxed);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn input_script_holds_buttons_until_the_next_event_and_loops() {
+        let script = InputScript::parse(
+            "# warm up, then walk right and jump\n\
+             10 0 Right\n\
+             20 0 right a\n\
+             30 0 -\n\
+             15 1 start\n\
+             loop 40\n",
+        )
+        .unwrap();
+        let right = 1 << Button::Right as u32;
+        let a = 1 << Button::A as u32;
+        let start = 1 << Button::Start as u32;
+
+        assert_eq!(script.buttons_at(0), [0; 4]);
+        assert_eq!(script.buttons_at(12), [right, 0, 0, 0]);
+        assert_eq!(script.buttons_at(25), [right | a, start, 0, 0]);
+        assert_eq!(script.buttons_at(35), [0, start, 0, 0]);
+        assert_eq!(script.buttons_at(52), [right, 0, 0, 0]);
+
+        assert!(InputScript::parse("5 0 turbo").is_err());
+        assert!(InputScript::parse("5 4 a").is_err());
+        assert!(InputScript::parse("loop 0").is_err());
+    }
+}
@@ -0,0 +1,286 @@
+//! Run a guest headless for a fixed number of frames and report per-frame costs as JSON.
+//!
+//! Usage: `wasm96-bench <guest.wasm|.wat|.w96> [--frames N] [--warmup N] [--input script.txt]`
+//!
+//! Video, audio and input go to the stub frontend in `wasm96_core::bench`. The report covers the
+//! measured frames only (warm-up frames run first and are dropped):
+//! - frame and per-phase wall time percentiles, in microseconds,
+//! - host import calls, per frame and in total,
+//! - heap allocations made during `run_frame` by the whole process (including the profiler's own
+//!   per-frame bookkeeping, a few allocations),
+//! - peak resident set size (Linux only; `null` elsewhere).
+//!
+//! Every run starts from a cold compile, so `load_ms` tracks Cranelift time as well.
+
+use std::alloc::{GlobalAlloc, Layout, System};
+use std::collections::BTreeMap;
+use std::fmt::Write;
+use std::process::ExitCode;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::Instant;
+
+use wasm96_core::Wasm96Core;
+use wasm96_core::bench::{self, InputScript, Phase};
+
+/// Counts allocations on top of the system allocator.
+struct CountingAlloc;
+
+static ALLOCS: AtomicU64 = AtomicU64::new(0);
+static ALLOC_BYTES: AtomicU64 = AtomicU64::new(0);
+
+unsafe impl GlobalAlloc for CountingAlloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        ALLOCS.fetch_add(1, Ordering::Relaxed);
+        ALLOC_BYTES.fetch_add(layout.size() as u64, Ordering::Relaxed);
+        unsafe { System.alloc(layout) }
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        ALLOCS.fetch_add(1, Ordering::Relaxed);
+        ALLOC_BYTES.fetch_add(layout.size() as u64, Ordering::Relaxed);
+        unsafe { System.alloc_zeroed(layout) }
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        unsafe { System.dealloc(ptr, layout) }
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        ALLOCS.fetch_add(1, Ordering::Relaxed);
+        ALLOC_BYTES.fetch_add(new_size as u64, Ordering::Relaxed);
+        unsafe { System.realloc(ptr, layout, new_size) }
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAlloc = CountingAlloc;
+
+const USAGE: &str =
+    "usage: wasm96-bench <guest.wasm|.wat|.w96> [--frames N] [--warmup N] [--input script.txt]";
+
+struct Args {
+    module: String,
+    frames: u32,
+    warmup: u32,
+    input: Option<String>,
+}
+
+fn parse_args() -> Result<Args, String> {
+    let mut args = Args {
+        module: String::new(),
+        frames: 600,
+        warmup: 60,
+        input: None,
+    };
+    let mut it = std::env::args().skip(1);
+    while let Some(arg) = it.next() {
+        let mut value = |name: &str| it.next().ok_or_else(|| format!("{name} needs a value"));
+        match arg.as_str() {
+            "--frames" => args.frames = value("--frames")?.parse().map_err(|_| "bad --frames")?,
+            "--warmup" => args.warmup = value("--warmup")?.parse().map_err(|_| "bad --warmup")?,
+            "--input" => args.input = Some(value("--input")?),
+            _ if arg.starts_with("--") || !args.module.is_empty() => {
+                return Err(format!("unexpected argument `{arg}`"));
+            }
+            _ => args.module = arg,
+        }
+    }
+    if args.module.is_empty() || args.frames == 0 {
+        return Err(USAGE.to_string());
+    }
+    Ok(args)
+}
+
+/// Peak resident set size in KiB (`VmHWM`), on Linux.
+fn peak_rss_kib() -> Option<u64> {
+    let status = std::fs::read_to_string("/proc/self/status").ok()?;
+    let line = status.lines().find(|l| l.starts_with("VmHWM:"))?;
+    line.split_whitespace().nth(1)?.parse().ok()
+}
+
+/// `{"mean":..,"p50":..,"p95":..,"p99":..,"max":..}` in microseconds, nearest-rank percentiles.
+fn summary_json(nanos: &mut [u64]) -> String {
+    nanos.sort_unstable();
+    let us = |ns: u64| ns as f64 / 1000.0;
+    let rank = |p: f64| nanos[((p * nanos.len() as f64).ceil() as usize).clamp(1, nanos.len()) - 1];
+    let mean = nanos.iter().sum::<u64>() as f64 / nanos.len() as f64 / 1000.0;
+    format!(
+        "{{\"mean\":{mean:.2},\"p50\":{:.2},\"p95\":{:.2},\"p99\":{:.2},\"max\":{:.2}}}",
+        us(rank(0.50)),
+        us(rank(0.95)),
+        us(rank(0.99)),
+        us(nanos[nanos.len() - 1])
+    )
+}
+
+/// JSON string literal for `s`.
+fn quote(s: &str) -> String {
+    let mut out = String::from("\"");
+    for c in s.chars() {
+        match c {
+            '"' => out.push_str("\\\""),
+            '\\' => out.push_str("\\\\"),
+            c if (c as u32) < 0x20 => {
+                let _ = write!(out, "\\u{:04x}", c as u32);
+            }
+            c => out.push(c),
+        }
+    }
+    out.push('"');
+    out
+}
+
+fn main() -> ExitCode {
+    let args = match parse_args() {
+        Ok(a) => a,
+        Err(e) => {
+            eprintln!("wasm96-bench: {e}");
+            return ExitCode::FAILURE;
+        }
+    };
+    let script = match &args.input {
+        Some(path) => match std::fs::read_to_string(path).map_err(|e| e.to_string()) {
+            Ok(text) => match InputScript::parse(&text) {
+                Ok(s) => s,
+                Err(e) => {
+                    eprintln!("wasm96-bench: {path}: {e}");
+                    return ExitCode::FAILURE;
+                }
+            },
+            Err(e) => {
+                eprintln!("wasm96-bench: cannot read {path}: {e}");
+                return ExitCode::FAILURE;
+            }
+        },
+        None => InputScript::default(),
+    };
+    let bytes = match std::fs::read(&args.module) {
+        Ok(b) => b,
+        Err(e) => {
+            eprintln!("wasm96-bench: cannot read {}: {e}", args.module);
+            return ExitCode::FAILURE;
+        }
+    };
+
+    bench::install_frontend();
+    let mut core = Wasm96Core::default();
+    let load_start = Instant::now();
+    if let Err(e) = core.load_game_from_bytes(&bytes) {
+        eprintln!("wasm96-bench: {}: {e:?}", args.module);
+        return ExitCode::FAILURE;
+    }
+    let load_ms = load_start.elapsed().as_secs_f64() * 1000.0;
+
+    for frame in 0..args.warmup {
+        script.apply(frame);
+        core.run_frame();
+    }
+
+    let frames = args.frames as usize;
+    let mut frame_nanos = Vec::with_capacity(frames);
+    let mut phase_nanos: Vec<Vec<u64>> = Phase::NAMES
+        .iter()
+        .map(|_| Vec::with_capacity(frames))
+        .collect();
+    let mut frame_allocs = Vec::with_capacity(frames);
+    // Import -> (calls, nanos); kept sorted so reports diff cleanly.
+    let mut calls: BTreeMap<&'static str, (u64, u64)> = BTreeMap::new();
+    let (mut lock_count, mut lock_wait_nanos, mut bytes_in, mut bytes_out) = (0u64, 0u64, 0, 0);
+    let mut alloc_bytes = 0;
+    let outputs_before = bench::output_counts();
+
+    for frame in args.warmup..args.warmup + args.frames {
+        script.apply(frame);
+        let (allocs, bytes) = (
+            ALLOCS.load(Ordering::Relaxed),
+            ALLOC_BYTES.load(Ordering::Relaxed),
+        );
+        core.run_frame();
+        // Read before `last_frame`, which allocates the bench's own snapshot.
+        frame_allocs.push(ALLOCS.load(Ordering::Relaxed) - allocs);
+        alloc_bytes += ALLOC_BYTES.load(Ordering::Relaxed) - bytes;
+
+        let sample = bench::last_frame();
+        frame_nanos.push(sample.nanos);
+        for (samples, ns) in phase_nanos.iter_mut().zip(sample.phases) {
+            samples.push(ns);
+        }
+        for (name, count, ns) in sample.host_calls {
+            let entry = calls.entry(name).or_default();
+            entry.0 += count as u64;
+            entry.1 += ns;
+        }
+        lock_count += sample.lock_count as u64;
+        lock_wait_nanos += sample.lock_wait_nanos;
+        bytes_in += sample.bytes_in;
+        bytes_out += sample.bytes_out;
+    }
+
+    let allocs: u64 = frame_allocs.iter().sum();
+    let outputs = bench::output_counts();
+    let n = frames as f64;
+
+    let mut json = String::from("{");
+    let _ = write!(
+        json,
+        "\"module\":{},\"core_version\":{},\"frames\":{},\"warmup\":{},\"load_ms\":{load_ms:.2}",
+        quote(&args.module),
+        quote(env!("CARGO_PKG_VERSION")),
+        args.frames,
+        args.warmup
+    );
+    let _ = write!(json, ",\"frame_us\":{}", summary_json(&mut frame_nanos));
+    json.push_str(",\"phases_us\":{");
+    for (i, (name, samples)) in Phase::NAMES.iter().zip(&mut phase_nanos).enumerate() {
+        let sep = if i > 0 { "," } else { "" };
+        let _ = write!(json, "{sep}\"{name}\":{}", summary_json(samples));
+    }
+    let total_calls: u64 = calls.values().map(|c| c.0).sum();
+    let _ = write!(
+        json,
+        "}},\"host_calls\":{{\"total\":{total_calls},\"per_frame\":{:.2},\"imports\":{{",
+        total_calls as f64 / n
+    );
+    for (i, (name, (count, ns))) in calls.iter().enumerate() {
+        let sep = if i > 0 { "," } else { "" };
+        let _ = write!(
+            json,
+            "{sep}\"{name}\":{{\"calls\":{count},\"per_frame\":{:.2},\"total_us\":{:.1}}}",
+            *count as f64 / n,
+            *ns as f64 / 1000.0
+        );
+    }
+    let _ = write!(
+        json,
+        "}}}},\"locks\":{{\"count\":{lock_count},\"wait_us\":{:.1}}}",
+        lock_wait_nanos as f64 / 1000.0
+    );
+    let _ = write!(
+        json,
+        ",\"guest_bytes\":{{\"in\":{bytes_in},\"out\":{bytes_out}}}"
+    );
+    let max_frame_allocs = frame_allocs.iter().copied().max().unwrap_or(0);
+    let _ = write!(
+        json,
+        ",\"allocations\":{{\"count\":{allocs},\"bytes\":{alloc_bytes},\"per_frame\":{:.2},\"max_per_frame\":{max_frame_allocs}}}",
+        allocs as f64 / n
+    );
+    let _ = write!(
+        json,
+        ",\"output\":{{\"frames_presented\":{},\"frames_duped\":{},\"audio_frames\":{}}}",
+        outputs.frames_presented - outputs_before.frames_presented,
+        outputs.frames_duped - outputs_before.frames_duped,
+        outputs.audio_frames - outputs_before.audio_frames
+    );
+    match peak_rss_kib() {
+        Some(kib) => {
+            let _ = write!(json, ",\"peak_rss_kib\":{kib}");
+        }
+        None => json.push_str(",\"peak_rss_kib\":null"),
+    }
+    json.push('}');
+    println!("{json}");
+
+    core.unload();
+    ExitCode::SUCCESS
+}
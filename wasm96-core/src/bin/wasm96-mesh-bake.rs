@@ -0,0 +1,60 @@
+//! Convert an OBJ or STL model into a pre-baked wasm96 mesh blob.
+//!
+//! Usage: `wasm96-mesh-bake <input.obj|input.stl> <output.w96m>`
+//!
+//! Load the output with `wasm96_graphics_mesh_create_blob`; the host uploads it without parsing.
+
+use std::path::Path;
+use std::process::ExitCode;
+
+use wasm96_core::mesh_bake::{encode_blob, obj_to_mesh, parse_blob, stl_to_mesh};
+
+fn main() -> ExitCode {
+    let args: Vec<String> = std::env::args().collect();
+    if args.len() != 3 {
+        eprintln!("usage: wasm96-mesh-bake <input.obj|input.stl> <output.w96m>");
+        return ExitCode::FAILURE;
+    }
+    let (input, output) = (Path::new(&args[1]), Path::new(&args[2]));
+
+    let bytes = match std::fs::read(input) {
+        Ok(b) => b,
+        Err(e) => {
+            eprintln!("wasm96-mesh-bake: cannot read {}: {e}", input.display());
+            return ExitCode::FAILURE;
+        }
+    };
+
+    let is_stl = input
+        .extension()
+        .is_some_and(|ext| ext.eq_ignore_ascii_case("stl"));
+    let mesh = if is_stl {
+        stl_to_mesh(&bytes)
+    } else {
+        obj_to_mesh(&bytes)
+    };
+    let Some((vertices, indices)) = mesh else {
+        eprintln!(
+            "wasm96-mesh-bake: {} has no triangles or failed to parse",
+            input.display()
+        );
+        return ExitCode::FAILURE;
+    };
+
+    let blob = encode_blob(&vertices, &indices);
+    debug_assert!(parse_blob(&blob).is_some());
+    if let Err(e) = std::fs::write(output, &blob) {
+        eprintln!("wasm96-mesh-bake: cannot write {}: {e}", output.display());
+        return ExitCode::FAILURE;
+    }
+
+    println!(
+        "{}: {} vertices, {} indices, {} -> {} bytes",
+        output.display(),
+        vertices.len(),
+        indices.len(),
+        bytes.len(),
+        blob.len()
+    );
+    ExitCode::SUCCESS
+}
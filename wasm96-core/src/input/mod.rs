@@ -6,11 +6,12 @@
 //! - Optionally cache/snapshot inputs per-frame for determinism.
 
 use crate::abi::Button;
+use crate::abi::input::MAX_PORTS;
 use crate::state;
 use libretro_sys::*;
 
 /// Convert ABI joypad button id into libretro device ID.
-fn map_joypad_button(button: u32) -> Option<u32> {
+pub(crate) fn map_joypad_button(button: u32) -> Option<u32> {
     match button {
         x if x == Button::B as u32 => Some(DEVICE_ID_JOYPAD_B),
         x if x == Button::Y as u32 => Some(DEVICE_ID_JOYPAD_Y),
@@ -32,27 +33,43 @@ fn map_joypad_button(button: u32) -> Option<u32> {
     }
 }
 
+/// Held-button mask for `port` from this frame's snapshot (0 for unknown ports).
+pub fn joypad_buttons(port: u32) -> u32 {
+    let s = state::global().lock().unwrap();
+    s.input.buttons.get(port as usize).copied().unwrap_or(0)
+}
+
+/// Buttons on `port` that went down since the previous frame.
+pub fn joypad_pressed(port: u32) -> u32 {
+    let s = state::global().lock().unwrap();
+    let i = port as usize;
+    match (s.input.buttons.get(i), s.input.prev_buttons.get(i)) {
+        (Some(&now), Some(&prev)) => now & !prev,
+        _ => 0,
+    }
+}
+
+/// Buttons on `port` that went up since the previous frame.
+pub fn joypad_released(port: u32) -> u32 {
+    let s = state::global().lock().unwrap();
+    let i = port as usize;
+    match (s.input.buttons.get(i), s.input.prev_buttons.get(i)) {
+        (Some(&now), Some(&prev)) => !now & prev,
+        _ => 0,
+    }
+}
+
 /// Query whether a given joypad button is pressed.
 ///
+/// Reads this frame's snapshot rather than calling the frontend, so repeated queries are cheap
+/// and agree with each other for the whole frame.
+///
 /// Returns 1 if pressed, else 0.
 pub fn joypad_button_pressed(port: u32, button: u32) -> u32 {
-    let Some(id) = map_joypad_button(button) else {
+    if map_joypad_button(button).is_none() {
         return 0;
-    };
-
-    let cb = {
-        let s = state::global().lock().unwrap();
-        s.input_state_cb
-    };
-
-    if let Some(input_state) = cb {
-        unsafe {
-            let val = input_state(port, DEVICE_JOYPAD, 0, id);
-            if val != 0 { 1 } else { 0 }
-        }
-    } else {
-        0
     }
+    (joypad_buttons(port) >> button) & 1
 }
 
 /// Query whether a given key is pressed.
@@ -81,15 +98,37 @@ pub fn mouse_buttons() -> u32 {
 
 /// Snapshot inputs for the current frame into `state::InputState`.
 ///
-/// Call this once per `on_run` before invoking guest `wasm96_frame`.
+/// Call this once per `on_run` before the guest's `update`. Polls the frontend once,
+/// then reads every button of every port into `InputState::buttons`, keeping last frame's masks
+/// in `prev_buttons` for the edge queries.
 pub fn snapshot_per_frame() {
-    // Keep a single lock for updating `state::InputState`.
-    let mut s = state::global().lock().unwrap();
+    // Frontend callbacks run without the global lock held.
+    let (poll, input_state) = {
+        let s = state::global().lock().unwrap();
+        (s.input_poll_cb, s.input_state_cb)
+    };
 
-    // If you later add real device querying, do it here. For now, keep defaults.
-    // s.input.mouse_x = ...
-    // s.input.mouse_y = ...
-    // s.input.mouse_buttons = ...
+    if let Some(poll) = poll {
+        unsafe { poll() };
+    }
+
+    let mut masks = [0u32; MAX_PORTS as usize];
+    if let Some(input_state) = input_state {
+        for (port, mask) in masks.iter_mut().enumerate() {
+            for button in 0..=Button::R3 as u32 {
+                let Some(id) = map_joypad_button(button) else {
+                    continue;
+                };
+                if unsafe { input_state(port as u32, DEVICE_JOYPAD, 0, id) } != 0 {
+                    *mask |= 1 << button;
+                }
+            }
+        }
+    }
+
+    let mut s = state::global().lock().unwrap();
+    s.input.prev_buttons = s.input.buttons;
+    s.input.buttons = masks;
 
-    let _ = &mut *s;
+    // Mouse querying is not wired yet; `mouse_*` keep their defaults.
 }
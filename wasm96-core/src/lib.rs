@@ -12,13 +12,24 @@
 
 mod abi;
 mod av;
+/// Stub frontend and scripted input, shared with the `wasm96-bench` binary.
+pub mod bench;
 mod input;
 mod libretro_glue;
 mod loader;
+mod profile;
 mod runtime;
+mod savestate;
 mod state;
 
+/// Offline mesh conversion, shared with the `wasm96-mesh-bake` binary.
+pub mod mesh_bake {
+    pub use crate::av::graphics3d::Vertex;
+    pub use crate::av::mesh_data::{encode_blob, obj_to_mesh, parse_blob, stl_to_mesh};
+}
+
 use crate::abi::GuestEntrypoints;
+use crate::profile::Phase;
 
 /// The libretro core instance.
 #[derive(Default)]
@@ -46,7 +57,7 @@ impl Wasm96Core {
 
         let (instance, entrypoints) = rt
             .instantiate(module)
-            .map_err(|e| anyhow::anyhow!("Wasmtime instantiate failed: {e:?}"))?;
+            .map_err(|e| e.context("Wasmtime instantiate failed"))?;
 
         self.instance = Some(instance);
         self.entrypoints = Some(entrypoints);
@@ -102,6 +113,22 @@ impl Wasm96Core {
         self.instance = None;
         self.entrypoints = None;
         // Keep `rt` allocated so subsequent loads are faster; it’s safe because imports are pure host fns.
+        // Its store is dropped, though, so the guest's memory goes back to the pool.
+        if let Some(rt) = self.rt.as_mut() {
+            rt.reset_store();
+        }
+    }
+
+    /// Replace the runtime with an on-demand (non-pooling) one, recompile `data` for it and
+    /// instantiate.
+    fn reload_on_demand(&mut self, data: &[u8]) -> Result<(), anyhow::Error> {
+        let mut rt = runtime::WasmtimeRuntime::with_pooling(false)?;
+        rt.define_imports()?;
+        let module = loader::compile_module(&rt.engine, data)
+            .map_err(|e| anyhow::anyhow!("Failed to compile module: {e:?}"))?;
+        self.rt = Some(rt);
+        self.module = Some(module);
+        self.instantiate_with_details()
     }
 
     // Public API for libretro_glue
@@ -126,7 +153,20 @@ impl Wasm96Core {
         self.module = Some(module);
 
         // Instantiate module + resolve entrypoints/memory (with detailed errors).
-        if let Err(e) = self.instantiate_with_details() {
+        let mut result = self.instantiate_with_details();
+        let allocation_failed = result
+            .as_ref()
+            .is_err_and(|e| e.downcast_ref::<runtime::AllocationFailed>().is_some());
+        if allocation_failed && self.rt.as_ref().is_some_and(|rt| rt.pooled) {
+            // The guest may exceed the pooling allocator's limits (or use shared memory); retry
+            // once on an on-demand runtime, which needs its own compile of the module. Link and
+            // export errors would fail the same way there, so they are reported straight away.
+            eprintln!(
+                "(wasm96) instantiation failed under the pooling allocator; retrying on-demand"
+            );
+            result = self.reload_on_demand(data);
+        }
+        if let Err(e) = result {
             state::clear_on_unload();
             self.clear_guest();
             return Err(anyhow::anyhow!("Failed to instantiate module: {e:?}"));
@@ -136,32 +176,99 @@ impl Wasm96Core {
         // self.call_guest_setup();
         self.setup_called = false;
 
+        // Defer 2D drawing to the tiled rasterizer if WASM96_RASTER_THREADS asks for it.
+        av::tiles::configure(&mut state::global().lock().unwrap().video);
+
         Ok(())
     }
 
     pub fn unload(&mut self) {
         self.clear_guest();
+        av::asset_reset();
         state::clear_on_unload();
+        profile::flush_trace();
+        profile::reset();
     }
 
     pub fn run_frame(&mut self) {
+        profile::begin_frame();
+
         if !self.setup_called {
             self.call_guest_setup();
             self.setup_called = true;
         }
 
         // Snapshot inputs once per frame for determinism.
-        input::snapshot_per_frame();
+        {
+            let _p = profile::phase(Phase::Input);
+            input::snapshot_per_frame();
+        }
+
+        // Publish assets that finished decoding on worker threads (uploads happen here).
+        {
+            let _p = profile::phase(Phase::Assets);
+            av::asset_apply_completed();
+        }
 
         // Run guest update loop.
-        self.call_guest_update();
+        {
+            let _p = profile::phase(Phase::Update);
+            self.call_guest_update();
+        }
 
         // Run guest draw loop.
-        self.call_guest_draw();
+        {
+            let _p = profile::phase(Phase::Draw);
+            self.call_guest_draw();
+        }
 
-        // Present video and drain audio.
-        av::video_present_host();
-        av::audio_drain_host(0);
+        // Present video and drain audio. Guest memory is passed along for a guest-bound framebuffer.
+        {
+            let _p = profile::phase(Phase::Present);
+            let guest_memory = self.rt.as_mut().and_then(|rt| {
+                let memory = self.instance?.get_memory(&mut rt.store, "memory")?;
+                Some(memory.data(&rt.store))
+            });
+            av::video_present_host(guest_memory);
+        }
+        {
+            let _p = profile::phase(Phase::Audio);
+            av::audio_drain_host(0);
+        }
+
+        profile::end_frame();
+    }
+
+    /// Bytes a savestate of the running guest may need (0 if no guest is loaded).
+    pub fn serialize_size(&mut self) -> usize {
+        match (self.rt.as_mut(), self.instance.as_ref()) {
+            (Some(rt), Some(instance)) => savestate::serialize_size(&mut rt.store, instance),
+            _ => 0,
+        }
+    }
+
+    /// Write a savestate into `out`.
+    pub fn serialize(&mut self, out: &mut [u8]) -> bool {
+        match (self.rt.as_mut(), self.instance.as_ref()) {
+            (Some(rt), Some(instance)) => {
+                savestate::serialize(&mut rt.store, instance, self.setup_called, out)
+            }
+            _ => false,
+        }
+    }
+
+    /// Restore a savestate written by `serialize`.
+    pub fn unserialize(&mut self, data: &[u8]) -> bool {
+        let (Some(rt), Some(instance)) = (self.rt.as_mut(), self.instance.as_ref()) else {
+            return false;
+        };
+        match savestate::unserialize(&mut rt.store, instance, data) {
+            Some(setup_called) => {
+                self.setup_called = setup_called;
+                true
+            }
+            None => false,
+        }
     }
 
     pub fn reset(&mut self) {
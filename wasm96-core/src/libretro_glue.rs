@@ -18,6 +18,10 @@ static mut INPUT_POLL_CB: Option<InputPollFn> = None;
 static mut INPUT_STATE_CB: Option<InputStateFn> = None;
 static mut ENV_CB: Option<EnvironmentFn> = None;
 
+// Not in libretro-sys: `RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS` and the variable-size quirk.
+const ENVIRONMENT_SET_SERIALIZATION_QUIRKS: c_uint = 44;
+const SERIALIZATION_QUIRK_CORE_VARIABLE_SIZE: u64 = 1 << 2;
+
 // Dummies for HW_RENDER
 unsafe extern "C" fn dummy_get_current_framebuffer() -> usize {
     0
@@ -90,6 +94,14 @@ pub unsafe extern "C" fn retro_set_environment(cb: Option<EnvironmentFn>) {
     unsafe {
         ENV_CB = cb;
 
+        // Frame duping lets present skip frames where nothing was drawn.
+        if let Some(env) = ENV_CB {
+            let mut can_dupe = false;
+            if env(ENVIRONMENT_GET_CAN_DUPE, &raw mut can_dupe as *mut c_void) {
+                state::set_frontend_can_dupe(can_dupe);
+            }
+        }
+
         // Enable HW Render
         if let Some(env) = ENV_CB {
             let ret = env(
@@ -176,6 +188,39 @@ pub unsafe extern "C" fn retro_get_system_av_info(info: *mut SystemAvInfo) {
     info.timing.sample_rate = 44100.0;
 }
 
+/// A directory the frontend reports via `cmd` (`ENVIRONMENT_GET_*_DIRECTORY`), if any.
+fn frontend_directory(cmd: c_uint) -> Option<std::path::PathBuf> {
+    let env = unsafe { ENV_CB }?;
+    let mut dir: *const c_char = ptr::null();
+    let ok = unsafe { env(cmd, &raw mut dir as *mut c_void) };
+    if !ok || dir.is_null() {
+        return None;
+    }
+    let dir = unsafe { std::ffi::CStr::from_ptr(dir) };
+    Some(std::path::PathBuf::from(dir.to_string_lossy().into_owned()))
+}
+
+/// Storage journal file for `game`: named after the content file when the frontend passed a
+/// path, else after a hash of the ROM bytes.
+fn storage_file_name(game: &GameInfo, data: &[u8]) -> String {
+    let stem = (!game.path.is_null())
+        .then(|| unsafe { std::ffi::CStr::from_ptr(game.path) })
+        .and_then(|p| {
+            std::path::Path::new(&*p.to_string_lossy())
+                .file_stem()
+                .map(|s| s.to_string_lossy().into_owned())
+        });
+    match stem {
+        Some(stem) => format!("{stem}.w96kv"),
+        None => {
+            use std::hash::{DefaultHasher, Hash, Hasher};
+            let mut h = DefaultHasher::new();
+            data.hash(&mut h);
+            format!("wasm96-{:016x}.w96kv", h.finish())
+        }
+    }
+}
+
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn retro_load_game(game: *const GameInfo) -> bool {
     let core = unsafe {
@@ -192,8 +237,33 @@ pub unsafe extern "C" fn retro_load_game(game: *const GameInfo) -> bool {
 
     let data_slice = unsafe { std::slice::from_raw_parts(game.data as *const u8, game.size) };
 
+    // Compiled modules are cached under the frontend's system (else save) directory; with
+    // neither, the cache stays off.
+    let cache_dir = frontend_directory(ENVIRONMENT_GET_SYSTEM_DIRECTORY)
+        .or_else(|| frontend_directory(ENVIRONMENT_GET_SAVE_DIRECTORY));
+    crate::loader::cache::configure(cache_dir.as_deref());
+
     match core.load_game_from_bytes(data_slice) {
-        Ok(_) => true,
+        Ok(_) => {
+            // Guest memory can grow, so the state size is not fixed for the session.
+            if let Some(env) = unsafe { ENV_CB } {
+                let mut quirks = SERIALIZATION_QUIRK_CORE_VARIABLE_SIZE;
+                unsafe {
+                    env(
+                        ENVIRONMENT_SET_SERIALIZATION_QUIRKS,
+                        &raw mut quirks as *mut c_void,
+                    )
+                };
+            }
+            // Storage persists under the save directory; without one it stays in memory only.
+            if let Some(dir) = frontend_directory(ENVIRONMENT_GET_SAVE_DIRECTORY) {
+                let path = dir.join(storage_file_name(game, data_slice));
+                if let Err(e) = crate::av::storage_open(&path) {
+                    eprintln!("(wasm96) storage not persistent ({}): {e}", path.display());
+                }
+            }
+            true
+        }
         Err(e) => {
             eprintln!("(wasm96) Failed to load game content: {e:?}");
             false
@@ -262,15 +332,36 @@ pub unsafe extern "C" fn retro_get_memory_size(_id: c_uint) -> usize {
 }
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn retro_serialize_size() -> usize {
-    0
+    unsafe {
+        match (&mut *(&raw mut CORE)).as_mut() {
+            Some(c) => c.serialize_size(),
+            None => 0,
+        }
+    }
 }
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn retro_serialize(_data: *mut c_void, _size: usize) -> bool {
-    false
+pub unsafe extern "C" fn retro_serialize(data: *mut c_void, size: usize) -> bool {
+    if data.is_null() {
+        return false;
+    }
+    unsafe {
+        let Some(c) = (&mut *(&raw mut CORE)).as_mut() else {
+            return false;
+        };
+        c.serialize(std::slice::from_raw_parts_mut(data as *mut u8, size))
+    }
 }
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn retro_unserialize(_data: *const c_void, _size: usize) -> bool {
-    false
+pub unsafe extern "C" fn retro_unserialize(data: *const c_void, size: usize) -> bool {
+    if data.is_null() {
+        return false;
+    }
+    unsafe {
+        let Some(c) = (&mut *(&raw mut CORE)).as_mut() else {
+            return false;
+        };
+        c.unserialize(std::slice::from_raw_parts(data as *const u8, size))
+    }
 }
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn retro_cheat_reset() {}
@@ -0,0 +1,116 @@
+//! On-disk cache of compiled guest modules.
+//!
+//! Cranelift compilation dominates cold start for large guests (physics engines, C++ with big
+//! static data). After the first successful compile the `Module` is serialized next to the
+//! frontend's system directory; later loads of the same ROM on a compatible engine deserialize
+//! it straight from the file (which Wasmtime mmaps) instead of compiling.
+//!
+//! Entries are named by a 128-bit hash of the raw ROM bytes (before WAT conversion, so WAT guests
+//! skip parsing too) plus `Engine::precompile_compatibility_hash`, so a Wasmtime upgrade or a
+//! config change (e.g. `WASM96_PROFILE=jitdump`) simply misses. Stale or corrupt entries that
+//! Wasmtime rejects are recompiled and overwritten. Cache failures never fail a load.
+//!
+//! Deserializing an entry runs it as native code, so the cache only lives where the frontend (or
+//! the user, through `WASM96_MODULE_CACHE`) keeps its own files. Without a frontend directory it
+//! is disabled rather than falling back to a shared temp dir that other local users could write.
+//!
+//! `WASM96_MODULE_CACHE` overrides the location: a directory path, or `off` to disable.
+
+use std::hash::{DefaultHasher, Hash, Hasher};
+use std::path::{Path, PathBuf};
+use std::sync::Mutex;
+
+use wasmtime::{Engine, Module};
+
+use super::LoadError;
+
+/// Environment variable overriding the cache directory (`off` disables caching).
+pub const ENV_VAR: &str = "WASM96_MODULE_CACHE";
+
+static DIR: Mutex<Option<PathBuf>> = Mutex::new(None);
+
+/// Pick the cache directory: `WASM96_MODULE_CACHE` if set, else `<frontend_dir>/wasm96/modules`,
+/// else none (caching disabled).
+pub fn configure(frontend_dir: Option<&Path>) {
+    let dir = match std::env::var_os(ENV_VAR) {
+        Some(v) if v == "off" || v.is_empty() => None,
+        Some(v) => Some(PathBuf::from(v)),
+        None => frontend_dir.map(|dir| dir.join("wasm96").join("modules")),
+    };
+    set_dir(dir);
+}
+
+/// Set (or with `None`, disable) the cache directory directly.
+pub fn set_dir(dir: Option<PathBuf>) {
+    *DIR.lock().unwrap() = dir;
+}
+
+/// Current cache directory, if caching is enabled.
+pub fn dir() -> Option<PathBuf> {
+    DIR.lock().unwrap().clone()
+}
+
+/// Cache file name for `rom_bytes` compiled by `engine`.
+pub fn entry_name(engine: &Engine, rom_bytes: &[u8]) -> String {
+    // Two independently seeded SipHash passes: 128 bits, so distinct ROMs cannot plausibly
+    // collide on one entry.
+    let digest = |seed: u64| {
+        let mut h = DefaultHasher::new();
+        seed.hash(&mut h);
+        engine.precompile_compatibility_hash().hash(&mut h);
+        rom_bytes.hash(&mut h);
+        h.finish()
+    };
+    format!(
+        "{:016x}{:016x}-{:x}.cwasm",
+        digest(0),
+        digest(1),
+        rom_bytes.len()
+    )
+}
+
+/// Load the cached module for `rom_bytes` from `dir`, or compile it with `compile` and store the
+/// result. Returns the module and whether it came from the cache.
+pub fn load_or_compile(
+    engine: &Engine,
+    rom_bytes: &[u8],
+    dir: &Path,
+    compile: impl FnOnce() -> Result<Module, LoadError>,
+) -> Result<(Module, bool), LoadError> {
+    let path = dir.join(entry_name(engine, rom_bytes));
+
+    if path.is_file() {
+        // SAFETY: `dir` is the frontend's own directory or one the user chose (see `configure`),
+        // so entries there come from `store` below (`Module::serialize` on this host). Wasmtime
+        // still validates the header and engine compatibility before use.
+        match unsafe { Module::deserialize_file(engine, &path) } {
+            Ok(module) => return Ok((module, true)),
+            Err(e) => eprintln!(
+                "(wasm96) discarding module cache entry {}: {e}",
+                path.display()
+            ),
+        }
+    }
+
+    let module = compile()?;
+    if let Err(e) = store(&module, dir, &path) {
+        eprintln!(
+            "(wasm96) could not write module cache entry {}: {e}",
+            path.display()
+        );
+    }
+    Ok((module, false))
+}
+
+fn store(module: &Module, dir: &Path, path: &Path) -> Result<(), anyhow::Error> {
+    let bytes = module.serialize()?;
+    std::fs::create_dir_all(dir)?;
+    // Write-then-rename so a concurrent or interrupted writer never leaves a truncated entry.
+    let tmp = path.with_extension(format!("tmp{}", std::process::id()));
+    std::fs::write(&tmp, &bytes)?;
+    if let Err(e) = std::fs::rename(&tmp, path) {
+        let _ = std::fs::remove_file(&tmp);
+        return Err(e.into());
+    }
+    Ok(())
+}
@@ -3,13 +3,16 @@
 //! Responsibilities:
 //! - Detect whether the provided ROM bytes are a `.wasm` binary or `.wat` text.
 //! - If it looks like WAT, convert it to WASM bytes (via the `wat` crate).
-//! - Compile a Wasmtime `Module` from the resulting WASM bytes.
+//! - Compile a Wasmtime `Module` from the resulting WASM bytes, or reuse a previously
+//!   serialized one from the on-disk cache (see [`cache`]).
 //!
 //! Notes:
 //! - libretro provides the ROM bytes; extension sniffing is unreliable in some setups,
 //!   so we sniff the bytes themselves.
 //! - We accept leading whitespace/comments for WAT as best-effort.
 
+pub mod cache;
+
 use wasmtime::{Engine, Module};
 
 /// Error returned by loader helpers.
@@ -44,8 +47,22 @@ pub enum DetectedFormat {
     Wat,
 }
 
-/// Load: detect -> (optional) wat->wasm -> compile.
+/// Load: cache lookup, else detect -> (optional) wat->wasm -> compile -> cache store.
 pub fn compile_module(engine: &Engine, rom_bytes: &[u8]) -> Result<Module, LoadError> {
+    // Reject non-ROMs before touching the cache.
+    detect_format(rom_bytes).ok_or(LoadError::UnrecognizedFormat)?;
+
+    match cache::dir() {
+        Some(dir) => cache::load_or_compile(engine, rom_bytes, &dir, || {
+            compile_uncached(engine, rom_bytes)
+        })
+        .map(|(module, _)| module),
+        None => compile_uncached(engine, rom_bytes),
+    }
+}
+
+/// Detect -> (optional) wat->wasm -> compile, bypassing the cache.
+pub fn compile_uncached(engine: &Engine, rom_bytes: &[u8]) -> Result<Module, LoadError> {
     let Detected { format, wasm_bytes } = normalize_to_wasm(rom_bytes)?;
     let _ = format; // reserved for future logging/telemetry
     Module::new(engine, wasm_bytes.as_slice()).map_err(LoadError::CompileFailed)
@@ -173,4 +190,40 @@ mod tests {
         let m2 = compile_module(&engine, wasm.as_ref()).unwrap();
         assert!(m2.exports().len() >= 1);
     }
+
+    #[test]
+    fn module_cache_reuses_entries_and_replaces_corrupt_ones() {
+        let engine = Engine::default();
+        let dir = std::env::temp_dir().join(format!("wasm96-cache-test-{}", std::process::id()));
+        let _ = std::fs::remove_dir_all(&dir);
+
+        let wat = br#"(module (func (export "setup")))"#;
+        let compile = || compile_uncached(&engine, wat);
+
+        let (_, hit) = cache::load_or_compile(&engine, wat, &dir, compile).unwrap();
+        assert!(!hit, "first load compiles");
+        let entry = dir.join(cache::entry_name(&engine, wat));
+        assert!(entry.is_file(), "compiled module is written to the cache");
+
+        let (m, hit) = cache::load_or_compile(&engine, wat, &dir, compile).unwrap();
+        assert!(hit, "second load deserializes");
+        assert!(m.get_export("setup").is_some());
+
+        // Different bytes get a different entry.
+        let other = br#"(module (func (export "setup")) (func (export "update")))"#;
+        assert_ne!(
+            cache::entry_name(&engine, other),
+            cache::entry_name(&engine, wat)
+        );
+
+        // A corrupt entry is recompiled and overwritten, not returned.
+        std::fs::write(&entry, b"not a module").unwrap();
+        let (m, hit) = cache::load_or_compile(&engine, wat, &dir, compile).unwrap();
+        assert!(!hit);
+        assert!(m.get_export("setup").is_some());
+        let (_, hit) = cache::load_or_compile(&engine, wat, &dir, compile).unwrap();
+        assert!(hit);
+
+        let _ = std::fs::remove_dir_all(&dir);
+    }
 }
@@ -0,0 +1,459 @@
+//! Frame profiling for wasm96-core.
+//!
+//! Records, per frame:
+//! - wall time of each `Core::run_frame` phase (input, assets, update, draw, present, audio),
+//! - count and total time of every `wasm96_*` host import (a `host_call` scope is opened at the top
+//!   of each import in `runtime::imports`),
+//! - time spent waiting on the core's mutexes (`TimedMutex`),
+//! - bytes copied between guest linear memory and the host.
+//!
+//! Collection is off by default and costs one relaxed atomic load per scope while off. It is turned
+//! on by the `WASM96_PROFILE` environment variable or by the guest's first `wasm96_system_stats`
+//! call. `WASM96_PROFILE` is a comma-separated list of:
+//! - `stats`: collect only (for `wasm96_system_stats`),
+//! - `csv`: log one CSV row per frame,
+//! - `trace`: log Chrome trace JSON (`chrome://tracing`, Perfetto) on unload,
+//! - `perfmap` / `jitdump`: enable Wasmtime's JIT profiler so `perf` can symbolize guest code.
+//!
+//! Everything is recorded on the thread that runs the guest; time spent on asset worker threads
+//! is not attributed.
+
+use std::cell::RefCell;
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{LockResult, Mutex, MutexGuard, OnceLock, TryLockError};
+use std::time::{Duration, Instant};
+
+use crate::abi::stats;
+
+/// Cap on buffered trace events (~30 MB of JSON); later events are dropped.
+const TRACE_MAX_EVENTS: usize = 200_000;
+
+/// `Core::run_frame` phases, in `abi::stats::PHASE_*` order.
+#[derive(Copy, Clone, Debug, Eq, PartialEq)]
+pub enum Phase {
+    Input = stats::PHASE_INPUT as isize,
+    Assets = stats::PHASE_ASSETS as isize,
+    Update = stats::PHASE_UPDATE as isize,
+    Draw = stats::PHASE_DRAW as isize,
+    Present = stats::PHASE_PRESENT as isize,
+    Audio = stats::PHASE_AUDIO as isize,
+}
+
+impl Phase {
+    pub const NAMES: [&'static str; stats::PHASE_COUNT] =
+        ["input", "assets", "update", "draw", "present", "audio"];
+}
+
+/// What `WASM96_PROFILE` asked for.
+#[derive(Default, Debug, Clone, Copy)]
+pub struct Options {
+    pub csv: bool,
+    pub trace: bool,
+    pub perfmap: bool,
+    pub jitdump: bool,
+}
+
+impl Options {
+    fn parse(value: &str) -> (Self, bool) {
+        let mut opts = Self::default();
+        let mut any = false;
+        for item in value.split(',').map(str::trim).filter(|s| !s.is_empty()) {
+            any = true;
+            match item {
+                "csv" => opts.csv = true,
+                "trace" => opts.trace = true,
+                "perfmap" => opts.perfmap = true,
+                "jitdump" => opts.jitdump = true,
+                _ => {} // "stats", "1", ...: collect only
+            }
+        }
+        (opts, any)
+    }
+}
+
+static ENABLED: AtomicBool = AtomicBool::new(false);
+static OPTIONS: OnceLock<Options> = OnceLock::new();
+static EPOCH: OnceLock<Instant> = OnceLock::new();
+
+/// Options from `WASM96_PROFILE` (read once; enables collection if set).
+pub fn options() -> Options {
+    *OPTIONS.get_or_init(|| {
+        let (opts, any) = std::env::var("WASM96_PROFILE")
+            .map(|v| Options::parse(&v))
+            .unwrap_or_default();
+        if any {
+            enable();
+        }
+        opts
+    })
+}
+
+#[inline]
+pub fn enabled() -> bool {
+    ENABLED.load(Ordering::Relaxed)
+}
+
+pub fn enable() {
+    EPOCH.get_or_init(Instant::now);
+    ENABLED.store(true, Ordering::Relaxed);
+}
+
+fn micros_since_epoch(t: Instant) -> f64 {
+    let epoch = *EPOCH.get_or_init(Instant::now);
+    t.saturating_duration_since(epoch).as_secs_f64() * 1e6
+}
+
+#[derive(Default, Clone, Copy)]
+struct CallStat {
+    count: u32,
+    nanos: u64,
+}
+
+#[derive(Default, Clone)]
+struct Frame {
+    start: Option<Instant>,
+    nanos: u64,
+    phases: [u64; stats::PHASE_COUNT],
+    calls: HashMap<&'static str, CallStat>,
+    lock_count: u32,
+    lock_wait_nanos: u64,
+    bytes_in: u64,
+    bytes_out: u64,
+}
+
+impl Frame {
+    fn host_totals(&self) -> CallStat {
+        self.calls
+            .values()
+            .fold(CallStat::default(), |acc, c| CallStat {
+                count: acc.count + c.count,
+                nanos: acc.nanos + c.nanos,
+            })
+    }
+}
+
+struct TraceEvent {
+    name: &'static str,
+    category: &'static str,
+    start: Instant,
+    nanos: u64,
+}
+
+#[derive(Default)]
+struct Profiler {
+    frame_index: u64,
+    current: Frame,
+    last: Frame,
+    csv_header_written: bool,
+    trace: Vec<TraceEvent>,
+}
+
+thread_local! {
+    static PROFILER: RefCell<Profiler> = RefCell::new(Profiler::default());
+}
+
+fn with_profiler<R>(f: impl FnOnce(&mut Profiler) -> R) -> Option<R> {
+    PROFILER.with(|p| p.try_borrow_mut().ok().map(|mut p| f(&mut p)))
+}
+
+fn nanos(d: Duration) -> u64 {
+    d.as_nanos().min(u64::MAX as u128) as u64
+}
+
+enum ScopeKind {
+    Phase(Phase),
+    HostCall(&'static str),
+}
+
+/// Times a region until dropped. Only created while profiling is enabled.
+pub struct Scope {
+    kind: ScopeKind,
+    start: Instant,
+}
+
+impl Drop for Scope {
+    fn drop(&mut self) {
+        let elapsed = nanos(self.start.elapsed());
+        let trace = options().trace;
+        with_profiler(|p| {
+            let (name, category) = match self.kind {
+                ScopeKind::Phase(phase) => {
+                    p.current.phases[phase as usize] += elapsed;
+                    (Phase::NAMES[phase as usize], "phase")
+                }
+                ScopeKind::HostCall(name) => {
+                    let stat = p.current.calls.entry(name).or_default();
+                    stat.count += 1;
+                    stat.nanos += elapsed;
+                    (name, "host")
+                }
+            };
+            if trace && p.trace.len() < TRACE_MAX_EVENTS {
+                p.trace.push(TraceEvent {
+                    name,
+                    category,
+                    start: self.start,
+                    nanos: elapsed,
+                });
+            }
+        });
+    }
+}
+
+/// Time a `run_frame` phase.
+#[inline]
+pub fn phase(phase: Phase) -> Option<Scope> {
+    enabled().then(|| Scope {
+        kind: ScopeKind::Phase(phase),
+        start: Instant::now(),
+    })
+}
+
+/// Time one call of the host import `name`.
+#[inline]
+pub fn host_call(name: &'static str) -> Option<Scope> {
+    enabled().then(|| Scope {
+        kind: ScopeKind::HostCall(name),
+        start: Instant::now(),
+    })
+}
+
+/// Count `len` bytes copied from guest memory into the host.
+#[inline]
+pub fn bytes_in(len: usize) {
+    if enabled() {
+        with_profiler(|p| p.current.bytes_in += len as u64);
+    }
+}
+
+/// Count `len` bytes copied from the host into guest memory.
+#[inline]
+pub fn bytes_out(len: usize) {
+    if enabled() {
+        with_profiler(|p| p.current.bytes_out += len as u64);
+    }
+}
+
+fn record_lock(wait: Duration) {
+    with_profiler(|p| {
+        p.current.lock_count += 1;
+        p.current.lock_wait_nanos += nanos(wait);
+    });
+}
+
+/// A `Mutex` that records how long `lock` waits while profiling is enabled.
+///
+/// Drop-in for the core's global mutexes: `lock` has the same signature as `Mutex::lock`.
+pub struct TimedMutex<T> {
+    inner: Mutex<T>,
+}
+
+impl<T> TimedMutex<T> {
+    pub const fn new(value: T) -> Self {
+        Self {
+            inner: Mutex::new(value),
+        }
+    }
+
+    pub fn lock(&self) -> LockResult<MutexGuard<'_, T>> {
+        if !enabled() {
+            return self.inner.lock();
+        }
+        // Uncontended fast path first, so the common case costs no clock reads.
+        match self.inner.try_lock() {
+            Ok(guard) => {
+                record_lock(Duration::ZERO);
+                return Ok(guard);
+            }
+            Err(TryLockError::Poisoned(poisoned)) => return Err(poisoned),
+            Err(TryLockError::WouldBlock) => {}
+        }
+        let start = Instant::now();
+        let guard = self.inner.lock();
+        record_lock(start.elapsed());
+        guard
+    }
+}
+
+/// Start a frame. Called at the top of `Core::run_frame`.
+pub fn begin_frame() {
+    if !enabled() {
+        return;
+    }
+    with_profiler(|p| p.current.start = Some(Instant::now()));
+}
+
+/// Finish a frame: it becomes what `wasm96_system_stats` reports, and is logged in CSV mode.
+pub fn end_frame() {
+    if !enabled() {
+        return;
+    }
+    let opts = options();
+    with_profiler(|p| {
+        let now = Instant::now();
+        let mut frame = std::mem::take(&mut p.current);
+        if let Some(start) = frame.start {
+            frame.nanos = nanos(now.saturating_duration_since(start));
+            if opts.trace && p.trace.len() < TRACE_MAX_EVENTS {
+                p.trace.push(TraceEvent {
+                    name: "frame",
+                    category: "frame",
+                    start,
+                    nanos: frame.nanos,
+                });
+            }
+        }
+        p.frame_index += 1;
+        p.last = frame;
+
+        if opts.csv {
+            if !p.csv_header_written {
+                println!(
+                    "[wasm96 profile] frame,frame_us,input_us,assets_us,update_us,draw_us,present_us,audio_us,host_calls,host_us,locks,lock_wait_us,bytes_in,bytes_out"
+                );
+                p.csv_header_written = true;
+            }
+            println!("[wasm96 profile] {}", csv_row(p.frame_index, &p.last));
+        }
+    });
+}
+
+fn csv_row(index: u64, f: &Frame) -> String {
+    use std::fmt::Write;
+    let us = |ns: u64| ns as f64 / 1000.0;
+    let host = f.host_totals();
+    let mut row = format!("{index},{:.1}", us(f.nanos));
+    for &ns in &f.phases {
+        let _ = write!(row, ",{:.1}", us(ns));
+    }
+    let _ = write!(
+        row,
+        ",{},{:.1},{},{:.1},{},{}",
+        host.count,
+        us(host.nanos),
+        f.lock_count,
+        us(f.lock_wait_nanos),
+        f.bytes_in,
+        f.bytes_out
+    );
+    row
+}
+
+/// Log buffered trace events as Chrome trace JSON and clear them. Called on unload.
+pub fn flush_trace() {
+    if !options().trace {
+        return;
+    }
+    let json = with_profiler(|p| {
+        if p.trace.is_empty() {
+            return None;
+        }
+        let mut json = String::from("{\"traceEvents\":[");
+        for (i, e) in p.trace.drain(..).enumerate() {
+            if i > 0 {
+                json.push(',');
+            }
+            // Names are `&'static str` import/phase names: no characters need escaping.
+            json.push_str(&format!(
+                "{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":{:.3},\"dur\":{:.3}}}",
+                e.name,
+                e.category,
+                micros_since_epoch(e.start),
+                e.nanos as f64 / 1000.0
+            ));
+        }
+        json.push_str("]}");
+        Some(json)
+    })
+    .flatten();
+    if let Some(json) = json {
+        println!("[wasm96 trace] {json}");
+    }
+}
+
+/// Serialize the last finished frame in the `abi::stats` layout, with as many import entries
+/// (slowest first) as fit in `capacity` bytes. Returns the bytes and the full size the report
+/// would need with every entry.
+pub fn encode_stats(capacity: usize) -> (Vec<u8>, usize) {
+    with_profiler(|p| {
+        let f = &p.last;
+        let mut calls: Vec<(&'static str, CallStat)> =
+            f.calls.iter().map(|(&n, &c)| (n, c)).collect();
+        calls.sort_unstable_by(|a, b| b.1.nanos.cmp(&a.1.nanos).then(a.0.cmp(b.0)));
+
+        let needed = stats::HEADER_BYTES + calls.len() * stats::ENTRY_BYTES;
+        let fit = capacity.saturating_sub(stats::HEADER_BYTES) / stats::ENTRY_BYTES;
+        let entries = &calls[..calls.len().min(fit)];
+        let host = f.host_totals();
+
+        let mut out = Vec::with_capacity(stats::HEADER_BYTES + entries.len() * stats::ENTRY_BYTES);
+        out.extend_from_slice(&stats::VERSION.to_le_bytes());
+        out.extend_from_slice(&(entries.len() as u32).to_le_bytes());
+        out.extend_from_slice(&p.frame_index.to_le_bytes());
+        out.extend_from_slice(&f.nanos.to_le_bytes());
+        for ns in f.phases {
+            out.extend_from_slice(&ns.to_le_bytes());
+        }
+        out.extend_from_slice(&host.nanos.to_le_bytes());
+        out.extend_from_slice(&host.count.to_le_bytes());
+        out.extend_from_slice(&f.lock_count.to_le_bytes());
+        out.extend_from_slice(&f.lock_wait_nanos.to_le_bytes());
+        out.extend_from_slice(&f.bytes_in.to_le_bytes());
+        out.extend_from_slice(&f.bytes_out.to_le_bytes());
+        debug_assert_eq!(out.len(), stats::HEADER_BYTES);
+
+        for (name, stat) in entries {
+            let short = name.strip_prefix("wasm96_").unwrap_or(name).as_bytes();
+            let mut field = [0u8; stats::NAME_BYTES];
+            let n = short.len().min(stats::NAME_BYTES);
+            field[..n].copy_from_slice(&short[..n]);
+            out.extend_from_slice(&field);
+            out.extend_from_slice(&stat.count.to_le_bytes());
+            out.extend_from_slice(&0u32.to_le_bytes());
+            out.extend_from_slice(&stat.nanos.to_le_bytes());
+        }
+        (out, needed)
+    })
+    .unwrap_or_default()
+}
+
+/// Per-frame numbers of the last finished frame, for the headless bench runner.
+#[derive(Debug, Default, Clone)]
+pub struct FrameSample {
+    pub nanos: u64,
+    /// Indexed like `Phase::NAMES`.
+    pub phases: [u64; stats::PHASE_COUNT],
+    /// `(import, calls, nanos)` for every import called during the frame.
+    pub host_calls: Vec<(&'static str, u32, u64)>,
+    pub lock_count: u32,
+    pub lock_wait_nanos: u64,
+    pub bytes_in: u64,
+    pub bytes_out: u64,
+}
+
+/// The last finished frame (all zero before the first one).
+pub fn last_frame() -> FrameSample {
+    with_profiler(|p| {
+        let f = &p.last;
+        FrameSample {
+            nanos: f.nanos,
+            phases: f.phases,
+            host_calls: f
+                .calls
+                .iter()
+                .map(|(&n, c)| (n, c.count, c.nanos))
+                .collect(),
+            lock_count: f.lock_count,
+            lock_wait_nanos: f.lock_wait_nanos,
+            bytes_in: f.bytes_in,
+            bytes_out: f.bytes_out,
+        }
+    })
+    .unwrap_or_default()
+}
+
+/// Drop all collected data (on guest unload).
+pub fn reset() {
+    with_profiler(|p| *p = Profiler::default());
+}
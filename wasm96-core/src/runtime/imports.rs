@@ -7,7 +7,7 @@
 
 use crate::{
     abi::{IMPORT_MODULE, host_imports},
-    av, input,
+    av, input, profile,
 };
 use wasmtime::{Caller, Linker};
 
@@ -18,6 +18,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_SET_SIZE,
         |_caller: Caller<'_, ()>, width: u32, height: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_SET_SIZE);
             av::graphics_set_size(width, height);
         },
     )?;
@@ -26,6 +27,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_SET_COLOR,
         |_caller: Caller<'_, ()>, r: u32, g: u32, b: u32, a: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_SET_COLOR);
             av::graphics_set_color(r, g, b, a);
         },
     )?;
@@ -34,6 +36,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_BACKGROUND,
         |_caller: Caller<'_, ()>, r: u32, g: u32, b: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_BACKGROUND);
             av::graphics_background(r, g, b);
         },
     )?;
@@ -42,6 +45,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_POINT,
         |_caller: Caller<'_, ()>, x: i32, y: i32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_POINT);
             av::graphics_point(x, y);
         },
     )?;
@@ -50,6 +54,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_LINE,
         |_caller: Caller<'_, ()>, x1: i32, y1: i32, x2: i32, y2: i32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_LINE);
             av::graphics_line(x1, y1, x2, y2);
         },
     )?;
@@ -58,6 +63,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_RECT,
         |_caller: Caller<'_, ()>, x: i32, y: i32, w: u32, h: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_RECT);
             av::graphics_rect(x, y, w, h);
         },
     )?;
@@ -66,6 +72,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_RECT_OUTLINE,
         |_caller: Caller<'_, ()>, x: i32, y: i32, w: u32, h: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_RECT_OUTLINE);
             av::graphics_rect_outline(x, y, w, h);
         },
     )?;
@@ -74,6 +81,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_CIRCLE,
         |_caller: Caller<'_, ()>, x: i32, y: i32, r: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_CIRCLE);
             av::graphics_circle(x, y, r);
         },
     )?;
@@ -82,15 +90,54 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_CIRCLE_OUTLINE,
         |_caller: Caller<'_, ()>, x: i32, y: i32, r: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_CIRCLE_OUTLINE);
             av::graphics_circle_outline(x, y, r);
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_CLEAR_RECT,
+        |_caller: Caller<'_, ()>, x: i32, y: i32, w: u32, h: u32, r: u32, g: u32, b: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_CLEAR_RECT);
+            av::graphics_clear_rect(x, y, w, h, r, g, b);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_DAMAGE,
+        |_caller: Caller<'_, ()>| -> u64 {
+            let _p = profile::host_call(host_imports::GRAPHICS_DAMAGE);
+            av::graphics_damage()
+        },
+    )?;
+
+    // Batched command buffer: (ptr,len) -> records executed
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_SUBMIT,
+        |mut caller: Caller<'_, ()>, ptr: u32, len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_SUBMIT);
+            av::graphics_submit(&mut caller, ptr, len)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_BIND_FRAMEBUFFER,
+        |_caller: Caller<'_, ()>, ptr: u32, w: u32, h: u32, format: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_BIND_FRAMEBUFFER);
+            av::graphics_bind_framebuffer(ptr, w, h, format)
+        },
+    )?;
+
     // Raw RGBA blit: (x,y,w,h,ptr,len)
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_IMAGE,
         |mut caller: Caller<'_, ()>, x: i32, y: i32, w: u32, h: u32, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_IMAGE);
             let _ = av::graphics_image(&mut caller, x, y, w, h, ptr, len);
         },
     )?;
@@ -100,6 +147,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_IMAGE_PNG,
         |mut caller: Caller<'_, ()>, x: i32, y: i32, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_IMAGE_PNG);
             let _ = av::graphics_image_png(&mut caller, x, y, ptr, len);
         },
     )?;
@@ -109,6 +157,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_IMAGE_JPEG,
         |mut caller: Caller<'_, ()>, x: i32, y: i32, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_IMAGE_JPEG);
             let _ = av::graphics_image_jpeg(&mut caller, x, y, ptr, len);
         },
     )?;
@@ -118,6 +167,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_SVG_REGISTER,
         |mut caller: Caller<'_, ()>, key: u64, data_ptr: u32, data_len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_SVG_REGISTER);
             av::graphics_svg_register(&mut caller, key, data_ptr, data_len)
         },
     )?;
@@ -126,6 +176,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_SVG_DRAW_KEY,
         |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32, w: u32, h: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_SVG_DRAW_KEY);
             av::graphics_svg_draw_key(key, x, y, w, h)
         },
     )?;
@@ -134,14 +185,43 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_SVG_UNREGISTER,
         |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::GRAPHICS_SVG_UNREGISTER);
             av::graphics_svg_unregister(key);
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_SVG_PRERENDER,
+        |_caller: Caller<'_, ()>, key: u64, w: u32, h: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_SVG_PRERENDER);
+            av::graphics_svg_prerender_key(key, w, h)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_SVG_EVICT,
+        |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::GRAPHICS_SVG_EVICT);
+            av::graphics_svg_evict_key(key);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_SVG_SET_CACHE_BUDGET,
+        |_caller: Caller<'_, ()>, bytes: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_SVG_SET_CACHE_BUDGET);
+            av::graphics_svg_set_cache_budget(bytes);
+        },
+    )?;
+
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_GIF_REGISTER,
         |mut caller: Caller<'_, ()>, key: u64, data_ptr: u32, data_len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_GIF_REGISTER);
             av::graphics_gif_register(&mut caller, key, data_ptr, data_len)
         },
     )?;
@@ -149,13 +229,17 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_GIF_DRAW_KEY,
-        |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32| av::graphics_gif_draw_key(key, x, y),
+        |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_GIF_DRAW_KEY);
+            av::graphics_gif_draw_key(key, x, y)
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_GIF_DRAW_KEY_SCALED,
         |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32, w: u32, h: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_GIF_DRAW_KEY_SCALED);
             av::graphics_gif_draw_key_scaled(key, x, y, w, h)
         },
     )?;
@@ -164,6 +248,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_GIF_UNREGISTER,
         |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::GRAPHICS_GIF_UNREGISTER);
             av::graphics_gif_unregister(key);
         },
     )?;
@@ -172,6 +257,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_PNG_REGISTER,
         |mut caller: Caller<'_, ()>, key: u64, data_ptr: u32, data_len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_PNG_REGISTER);
             av::graphics_png_register(&mut caller, key, data_ptr, data_len)
         },
     )?;
@@ -179,13 +265,17 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_PNG_DRAW_KEY,
-        |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32| av::graphics_png_draw_key(key, x, y),
+        |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_PNG_DRAW_KEY);
+            av::graphics_png_draw_key(key, x, y)
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_PNG_DRAW_KEY_SCALED,
         |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32, w: u32, h: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_PNG_DRAW_KEY_SCALED);
             av::graphics_png_draw_key_scaled(key, x, y, w, h)
         },
     )?;
@@ -194,6 +284,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_PNG_UNREGISTER,
         |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::GRAPHICS_PNG_UNREGISTER);
             av::graphics_png_unregister(key);
         },
     )?;
@@ -202,6 +293,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_JPEG_REGISTER,
         |mut caller: Caller<'_, ()>, key: u64, data_ptr: u32, data_len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_JPEG_REGISTER);
             av::graphics_jpeg_register(&mut caller, key, data_ptr, data_len)
         },
     )?;
@@ -209,13 +301,17 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_JPEG_DRAW_KEY,
-        |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32| av::graphics_jpeg_draw_key(key, x, y),
+        |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_JPEG_DRAW_KEY);
+            av::graphics_jpeg_draw_key(key, x, y)
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_JPEG_DRAW_KEY_SCALED,
         |_caller: Caller<'_, ()>, key: u64, x: i32, y: i32, w: u32, h: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_JPEG_DRAW_KEY_SCALED);
             av::graphics_jpeg_draw_key_scaled(key, x, y, w, h)
         },
     )?;
@@ -224,15 +320,127 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_JPEG_UNREGISTER,
         |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::GRAPHICS_JPEG_UNREGISTER);
             av::graphics_jpeg_unregister(key);
         },
     )?;
 
+    // Raw RGBA keyed image: (key, w, h, ptr, len) -> bool
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_IMAGE_REGISTER,
+        |mut caller: Caller<'_, ()>, key: u64, w: u32, h: u32, ptr: u32, len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_IMAGE_REGISTER);
+            av::graphics_image_register(&mut caller, key, w, h, ptr, len)
+        },
+    )?;
+
+    // Sprite batch: one keyed image, `count` instance records -> sprites drawn
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_SPRITE_BATCH,
+        |mut caller: Caller<'_, ()>, image_key: u64, ptr: u32, count: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_SPRITE_BATCH);
+            av::graphics_sprite_batch(&mut caller, image_key, ptr, count)
+        },
+    )?;
+
+    // Retained draw lists (keyed)
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_LIST_BEGIN,
+        |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::GRAPHICS_LIST_BEGIN);
+            av::graphics_list_begin(key);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_LIST_END,
+        |_caller: Caller<'_, ()>| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_LIST_END);
+            av::graphics_list_end()
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_LIST_DRAW,
+        |_caller: Caller<'_, ()>, key: u64, dx: i32, dy: i32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_LIST_DRAW);
+            av::graphics_list_draw(key, dx, dy);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_LIST_DESTROY,
+        |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::GRAPHICS_LIST_DESTROY);
+            av::graphics_list_destroy(key);
+        },
+    )?;
+
+    // Tilemaps (keyed)
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::TILEMAP_CREATE,
+        |_caller: Caller<'_, ()>,
+         key: u64,
+         tileset_key: u64,
+         tile_w: u32,
+         tile_h: u32,
+         map_w: u32,
+         map_h: u32|
+         -> u32 {
+            let _p = profile::host_call(host_imports::TILEMAP_CREATE);
+            av::tilemap_create(key, tileset_key, tile_w, tile_h, map_w, map_h)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::TILEMAP_SET_TILES,
+        |mut caller: Caller<'_, ()>, key: u64, x: u32, y: u32, w: u32, h: u32, ptr: u32| -> u32 {
+            let _p = profile::host_call(host_imports::TILEMAP_SET_TILES);
+            av::tilemap_set_tiles(&mut caller, key, x, y, w, h, ptr)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::TILEMAP_SET_TILE,
+        |_caller: Caller<'_, ()>, key: u64, x: u32, y: u32, tile: u32| {
+            let _p = profile::host_call(host_imports::TILEMAP_SET_TILE);
+            av::tilemap_set_tile(key, x, y, tile);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::TILEMAP_DRAW,
+        |_caller: Caller<'_, ()>, key: u64, scroll_x: i32, scroll_y: i32| {
+            let _p = profile::host_call(host_imports::TILEMAP_DRAW);
+            av::tilemap_draw(key, scroll_x, scroll_y);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::TILEMAP_DESTROY,
+        |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::TILEMAP_DESTROY);
+            av::tilemap_destroy(key);
+        },
+    )?;
+
     // Fonts (keyed)
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_FONT_REGISTER_TTF,
         |mut caller: Caller<'_, ()>, key: u64, data_ptr: u32, data_len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_FONT_REGISTER_TTF);
             av::graphics_font_register_ttf(&mut caller, key, data_ptr, data_len)
         },
     )?;
@@ -241,6 +449,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_FONT_REGISTER_BDF,
         |mut caller: Caller<'_, ()>, key: u64, data_ptr: u32, data_len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_FONT_REGISTER_BDF);
             av::graphics_font_register_bdf(&mut caller, key, data_ptr, data_len)
         },
     )?;
@@ -249,6 +458,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_FONT_REGISTER_SPLEEN,
         |_caller: Caller<'_, ()>, key: u64, size: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_FONT_REGISTER_SPLEEN);
             av::graphics_font_register_spleen(key, size)
         },
     )?;
@@ -257,6 +467,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_FONT_UNREGISTER,
         |_caller: Caller<'_, ()>, key: u64| {
+            let _p = profile::host_call(host_imports::GRAPHICS_FONT_UNREGISTER);
             av::graphics_font_unregister(key);
         },
     )?;
@@ -270,6 +481,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
          font_key: u64,
          text_ptr: u32,
          text_len: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_TEXT_KEY);
             av::graphics_text_key(x, y, &mut caller, font_key, text_ptr, text_len);
         },
     )?;
@@ -278,15 +490,78 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_TEXT_MEASURE_KEY,
         |mut caller: Caller<'_, ()>, font_key: u64, text_ptr: u32, text_len: u32| -> u64 {
+            let _p = profile::host_call(host_imports::GRAPHICS_TEXT_MEASURE_KEY);
             av::graphics_text_measure_key(&mut caller, font_key, text_ptr, text_len)
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_TEXT_KEY_SIZED,
+        |mut caller: Caller<'_, ()>,
+         x: i32,
+         y: i32,
+         font_key: u64,
+         px: u32,
+         text_ptr: u32,
+         text_len: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_TEXT_KEY_SIZED);
+            av::graphics_text_key_sized(x, y, &mut caller, font_key, px, text_ptr, text_len);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_TEXT_MEASURE_KEY_SIZED,
+        |mut caller: Caller<'_, ()>, font_key: u64, px: u32, text_ptr: u32, text_len: u32| -> u64 {
+            let _p = profile::host_call(host_imports::GRAPHICS_TEXT_MEASURE_KEY_SIZED);
+            av::graphics_text_measure_key_sized(&mut caller, font_key, px, text_ptr, text_len)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_TEXT_BATCH,
+        |mut caller: Caller<'_, ()>, font_key: u64, ptr: u32, count: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_TEXT_BATCH);
+            av::graphics_text_batch(&mut caller, font_key, ptr, count)
+        },
+    )?;
+
+    // Async asset loading
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::ASSET_LOAD,
+        |mut caller: Caller<'_, ()>, kind: u32, key: u64, data_ptr: u32, data_len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::ASSET_LOAD);
+            av::asset_load(&mut caller, kind, key, data_ptr, data_len)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::ASSET_STATUS,
+        |_caller: Caller<'_, ()>, key: u64| -> u32 {
+            let _p = profile::host_call(host_imports::ASSET_STATUS);
+            av::asset_status(key)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::ASSET_WAIT_ALL,
+        |_caller: Caller<'_, ()>, timeout_ms: u32| -> u32 {
+            let _p = profile::host_call(host_imports::ASSET_WAIT_ALL);
+            av::asset_wait_all(timeout_ms)
+        },
+    )?;
+
     // Shapes
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_TRIANGLE,
         |_caller: Caller<'_, ()>, x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_TRIANGLE);
             av::graphics_triangle(x1, y1, x2, y2, x3, y3);
         },
     )?;
@@ -295,6 +570,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_TRIANGLE_OUTLINE,
         |_caller: Caller<'_, ()>, x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_TRIANGLE_OUTLINE);
             av::graphics_triangle_outline(x1, y1, x2, y2, x3, y3);
         },
     )?;
@@ -310,6 +586,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
          x2: i32,
          y2: i32,
          segments: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_BEZIER_QUADRATIC);
             av::graphics_bezier_quadratic(x1, y1, cx, cy, x2, y2, segments);
         },
     )?;
@@ -327,6 +604,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
          x2: i32,
          y2: i32,
          segments: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_BEZIER_CUBIC);
             av::graphics_bezier_cubic(x1, y1, cx1, cy1, cx2, cy2, x2, y2, segments);
         },
     )?;
@@ -335,6 +613,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_PILL,
         |_caller: Caller<'_, ()>, x: i32, y: i32, w: u32, h: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_PILL);
             av::graphics_pill(x, y, w, h);
         },
     )?;
@@ -343,6 +622,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_PILL_OUTLINE,
         |_caller: Caller<'_, ()>, x: i32, y: i32, w: u32, h: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_PILL_OUTLINE);
             av::graphics_pill_outline(x, y, w, h);
         },
     )?;
@@ -352,6 +632,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_SET_3D,
         |_caller: Caller<'_, ()>, enable: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_SET_3D);
             av::graphics_set_3d(enable != 0);
         },
     )?;
@@ -369,6 +650,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
          up_x: f32,
          up_y: f32,
          up_z: f32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_CAMERA_LOOK_AT);
             av::graphics_camera_look_at(
                 eye_x, eye_y, eye_z, target_x, target_y, target_z, up_x, up_y, up_z,
             );
@@ -379,6 +661,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_CAMERA_PERSPECTIVE,
         |_caller: Caller<'_, ()>, fovy: f32, aspect: f32, near: f32, far: f32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_CAMERA_PERSPECTIVE);
             av::graphics_camera_perspective(fovy, aspect, near, far);
         },
     )?;
@@ -392,13 +675,17 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
          v_len: u32,
          i_ptr: u32,
          i_len: u32|
-         -> u32 { av::graphics_mesh_create(&mut caller, key, v_ptr, v_len, i_ptr, i_len) },
+         -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_CREATE);
+            av::graphics_mesh_create(&mut caller, key, v_ptr, v_len, i_ptr, i_len)
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_MESH_CREATE_OBJ,
         |mut caller: Caller<'_, ()>, key: u64, ptr: u32, len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_CREATE_OBJ);
             av::graphics_mesh_create_obj(&mut caller, key, ptr, len)
         },
     )?;
@@ -407,14 +694,51 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::GRAPHICS_MESH_CREATE_STL,
         |mut caller: Caller<'_, ()>, key: u64, ptr: u32, len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_CREATE_STL);
             av::graphics_mesh_create_stl(&mut caller, key, ptr, len)
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_MESH_CREATE_BLOB,
+        |mut caller: Caller<'_, ()>, key: u64, ptr: u32, len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_CREATE_BLOB);
+            av::graphics_mesh_create_blob(&mut caller, key, ptr, len)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_MESH_CREATE_EX,
+        |mut caller: Caller<'_, ()>,
+         key: u64,
+         format: u32,
+         v_ptr: u32,
+         v_len: u32,
+         i_ptr: u32,
+         i_len: u32,
+         index_type: u32|
+         -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_CREATE_EX);
+            av::graphics_mesh_create_ex(
+                &mut caller,
+                key,
+                format,
+                v_ptr,
+                v_len,
+                i_ptr,
+                i_len,
+                index_type,
+            )
+        },
+    )?;
+
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::GRAPHICS_MESH_SET_TEXTURE,
         |_caller: Caller<'_, ()>, mesh_key: u64, image_key: u64| -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_SET_TEXTURE);
             av::graphics_mesh_set_texture(mesh_key, image_key)
         },
     )?;
@@ -433,10 +757,29 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
          sx: f32,
          sy: f32,
          sz: f32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_DRAW);
             av::graphics_mesh_draw(key, x, y, z, rx, ry, rz, sx, sy, sz);
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_MESH_DRAW_INSTANCED,
+        |mut caller: Caller<'_, ()>, key: u64, ptr: u32, count: u32| {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_DRAW_INSTANCED);
+            av::graphics_mesh_draw_instanced(&mut caller, key, ptr, count);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::GRAPHICS_MESH_STATS,
+        |_caller: Caller<'_, ()>| -> u64 {
+            let _p = profile::host_call(host_imports::GRAPHICS_MESH_STATS);
+            av::graphics_mesh_stats()
+        },
+    )?;
+
     // Materials / textures (OBJ+MTL workflows)
     linker.func_wrap(
         IMPORT_MODULE,
@@ -450,6 +793,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
          tex_ptr: u32,
          tex_len: u32|
          -> u32 {
+            let _p = profile::host_call(host_imports::GRAPHICS_MTL_REGISTER_TEXTURE);
             av::graphics_mtl_register_texture(
                 &mut caller,
                 texture_key,
@@ -468,32 +812,70 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::INPUT_IS_BUTTON_DOWN,
         |_caller: Caller<'_, ()>, port: u32, btn: u32| -> u32 {
+            let _p = profile::host_call(host_imports::INPUT_IS_BUTTON_DOWN);
             input::joypad_button_pressed(port, btn)
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::INPUT_GET_BUTTONS,
+        |_caller: Caller<'_, ()>, port: u32| -> u32 {
+            let _p = profile::host_call(host_imports::INPUT_GET_BUTTONS);
+            input::joypad_buttons(port)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::INPUT_GET_PRESSED,
+        |_caller: Caller<'_, ()>, port: u32| -> u32 {
+            let _p = profile::host_call(host_imports::INPUT_GET_PRESSED);
+            input::joypad_pressed(port)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::INPUT_GET_RELEASED,
+        |_caller: Caller<'_, ()>, port: u32| -> u32 {
+            let _p = profile::host_call(host_imports::INPUT_GET_RELEASED);
+            input::joypad_released(port)
+        },
+    )?;
+
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::INPUT_IS_KEY_DOWN,
-        |_caller: Caller<'_, ()>, key: u32| -> u32 { input::key_pressed(key) },
+        |_caller: Caller<'_, ()>, key: u32| -> u32 {
+            let _p = profile::host_call(host_imports::INPUT_IS_KEY_DOWN);
+            input::key_pressed(key)
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::INPUT_GET_MOUSE_X,
-        |_caller: Caller<'_, ()>| -> i32 { input::mouse_x() },
+        |_caller: Caller<'_, ()>| -> i32 {
+            let _p = profile::host_call(host_imports::INPUT_GET_MOUSE_X);
+            input::mouse_x()
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::INPUT_GET_MOUSE_Y,
-        |_caller: Caller<'_, ()>| -> i32 { input::mouse_y() },
+        |_caller: Caller<'_, ()>| -> i32 {
+            let _p = profile::host_call(host_imports::INPUT_GET_MOUSE_Y);
+            input::mouse_y()
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::INPUT_IS_MOUSE_DOWN,
         |_caller: Caller<'_, ()>, btn: u32| -> u32 {
+            let _p = profile::host_call(host_imports::INPUT_IS_MOUSE_DOWN);
             let mask = input::mouse_buttons();
             let requested = 1u32 << btn;
             if (mask & requested) != 0 { 1 } else { 0 }
@@ -504,21 +886,35 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::AUDIO_INIT,
-        |_caller: Caller<'_, ()>, sample_rate: u32| -> u32 { av::audio_init(sample_rate) },
+        |_caller: Caller<'_, ()>, sample_rate: u32| -> u32 {
+            let _p = profile::host_call(host_imports::AUDIO_INIT);
+            av::audio_init(sample_rate)
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::AUDIO_PUSH_SAMPLES,
         |mut caller: Caller<'_, ()>, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::AUDIO_PUSH_SAMPLES);
             let _ = av::audio_push_samples(&mut caller, ptr, len);
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::AUDIO_QUEUED_FRAMES,
+        |_caller: Caller<'_, ()>| -> u32 {
+            let _p = profile::host_call(host_imports::AUDIO_QUEUED_FRAMES);
+            av::audio_queued_frames()
+        },
+    )?;
+
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::AUDIO_PLAY_WAV,
         |mut caller: Caller<'_, ()>, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::AUDIO_PLAY_WAV);
             av::audio_play_wav(&mut caller, ptr, len);
         },
     )?;
@@ -527,6 +923,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::AUDIO_PLAY_QOA,
         |mut caller: Caller<'_, ()>, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::AUDIO_PLAY_QOA);
             av::audio_play_qoa(&mut caller, ptr, len);
         },
     )?;
@@ -535,21 +932,78 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::AUDIO_PLAY_XM,
         |mut caller: Caller<'_, ()>, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::AUDIO_PLAY_XM);
             av::audio_play_xm(&mut caller, ptr, len);
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::AUDIO_VOICE_PLAY,
+        |mut caller: Caller<'_, ()>, format: u32, ptr: u32, len: u32, looping: u32| -> u32 {
+            let _p = profile::host_call(host_imports::AUDIO_VOICE_PLAY);
+            av::audio_voice_play(&mut caller, format, ptr, len, looping)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::AUDIO_VOICE_SET_VOLUME,
+        |_caller: Caller<'_, ()>, id: u32, volume_q8_8: u32| {
+            let _p = profile::host_call(host_imports::AUDIO_VOICE_SET_VOLUME);
+            av::audio_voice_set_volume(id, volume_q8_8);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::AUDIO_VOICE_SET_PAN,
+        |_caller: Caller<'_, ()>, id: u32, pan: i32| {
+            let _p = profile::host_call(host_imports::AUDIO_VOICE_SET_PAN);
+            av::audio_voice_set_pan(id, pan);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::AUDIO_VOICE_SET_LOOP,
+        |_caller: Caller<'_, ()>, id: u32, looping: u32| {
+            let _p = profile::host_call(host_imports::AUDIO_VOICE_SET_LOOP);
+            av::audio_voice_set_loop(id, looping);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::AUDIO_VOICE_STOP,
+        |_caller: Caller<'_, ()>, id: u32| {
+            let _p = profile::host_call(host_imports::AUDIO_VOICE_STOP);
+            av::audio_voice_stop(id);
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::AUDIO_VOICE_IS_PLAYING,
+        |_caller: Caller<'_, ()>, id: u32| -> u32 {
+            let _p = profile::host_call(host_imports::AUDIO_VOICE_IS_PLAYING);
+            av::audio_voice_is_playing(id)
+        },
+    )?;
+
     // --- System ---
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::SYSTEM_LOG,
         |mut caller: Caller<'_, ()>, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::SYSTEM_LOG);
             let memory = caller.get_export("memory").and_then(|e| e.into_memory());
             let Some(memory) = memory else {
                 return;
             };
 
             let mut buf = vec![0u8; len as usize];
+            profile::bytes_in(buf.len());
             if memory.read(&caller, ptr as usize, &mut buf).is_ok()
                 && let Ok(msg) = core::str::from_utf8(&buf)
             {
@@ -561,7 +1015,19 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::SYSTEM_MILLIS,
-        |_caller: Caller<'_, ()>| -> u64 { crate::av::utils::system_millis() },
+        |_caller: Caller<'_, ()>| -> u64 {
+            let _p = profile::host_call(host_imports::SYSTEM_MILLIS);
+            crate::av::utils::system_millis()
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::SYSTEM_STATS,
+        |mut caller: Caller<'_, ()>, ptr: u32, len: u32| -> u32 {
+            let _p = profile::host_call(host_imports::SYSTEM_STATS);
+            crate::av::utils::system_stats(&mut caller, ptr, len)
+        },
     )?;
 
     // --- Storage ---
@@ -569,6 +1035,7 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
         IMPORT_MODULE,
         host_imports::STORAGE_SAVE,
         |mut caller: Caller<'_, ()>, key: u64, data_ptr: u32, data_len: u32| {
+            let _p = profile::host_call(host_imports::STORAGE_SAVE);
             av::storage_save(&mut caller, key, data_ptr, data_len);
         },
     )?;
@@ -576,16 +1043,47 @@ pub fn define_imports(linker: &mut Linker<()>) -> anyhow::Result<()> {
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::STORAGE_LOAD,
-        |mut caller: Caller<'_, ()>, key: u64| -> u64 { av::storage_load(&mut caller, key) },
+        |mut caller: Caller<'_, ()>, key: u64| -> u64 {
+            let _p = profile::host_call(host_imports::STORAGE_LOAD);
+            av::storage_load(&mut caller, key)
+        },
     )?;
 
     linker.func_wrap(
         IMPORT_MODULE,
         host_imports::STORAGE_FREE,
         |mut caller: Caller<'_, ()>, ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::STORAGE_FREE);
             av::storage_free(&mut caller, ptr, len);
         },
     )?;
 
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::STORAGE_SIZE,
+        |_caller: Caller<'_, ()>, key: u64| -> u32 {
+            let _p = profile::host_call(host_imports::STORAGE_SIZE);
+            av::storage_size(key)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::STORAGE_READ,
+        |mut caller: Caller<'_, ()>, key: u64, dst_ptr: u32, dst_cap: u32, offset: u32| -> u32 {
+            let _p = profile::host_call(host_imports::STORAGE_READ);
+            av::storage_read(&mut caller, key, dst_ptr, dst_cap, offset)
+        },
+    )?;
+
+    linker.func_wrap(
+        IMPORT_MODULE,
+        host_imports::STORAGE_WRITE,
+        |mut caller: Caller<'_, ()>, key: u64, offset: u32, src_ptr: u32, len: u32| {
+            let _p = profile::host_call(host_imports::STORAGE_WRITE);
+            av::storage_write(&mut caller, key, offset, src_ptr, len)
+        },
+    )?;
+
     Ok(())
 }
@@ -13,13 +13,38 @@
 
 use crate::{abi, state};
 
-use wasmtime::{Extern, Instance, Linker, Module, Store};
+use wasmtime::{
+    Extern, Instance, InstanceAllocationStrategy, Linker, Module, PoolingAllocationConfig, Store,
+};
+
+/// Instance slots pre-reserved by the pooling allocator. One guest runs at a time; the spare slot
+/// lets a reload instantiate while the previous store is still being torn down.
+const POOL_INSTANCES: u32 = 2;
+/// Per-module memory/table limits under pooling (multi-memory guests need more than one).
+const POOL_MEMORIES_PER_MODULE: u32 = 4;
+const POOL_TABLES_PER_MODULE: u32 = 4;
+/// Largest linear memory a pooled guest may grow to.
+const POOL_MAX_MEMORY_BYTES: usize = 4 << 30;
+
+/// Context attached when a module's imports link but its instance cannot be allocated: a pooling
+/// limit, shared memory under pooling, or the host out of memory. Only these failures are worth
+/// retrying on an on-demand runtime.
+#[derive(Debug)]
+pub struct AllocationFailed;
+
+impl std::fmt::Display for AllocationFailed {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.write_str("instance allocation failed")
+    }
+}
 
 /// Host-side runtime container.
 pub struct WasmtimeRuntime {
     pub engine: wasmtime::Engine,
     pub store: Store<()>,
     pub linker: Linker<()>,
+    /// Whether instances come from the pooling allocator (see [`WasmtimeRuntime::with_pooling`]).
+    pub pooled: bool,
 }
 
 impl WasmtimeRuntime {
@@ -30,7 +55,21 @@ impl WasmtimeRuntime {
     /// - Some proposals (notably threads/shared-memory) still require host-side integration
     ///   beyond flipping a config bit; we enable them here so modules can at least validate,
     ///   but guests must still be written with the embedding constraints in mind.
+    ///
+    /// Uses the pooling allocator on 64-bit hosts (see [`WasmtimeRuntime::with_pooling`]).
     pub fn new() -> Result<Self, anyhow::Error> {
+        Self::with_pooling(cfg!(target_pointer_width = "64"))
+    }
+
+    /// Like [`WasmtimeRuntime::new`], choosing the instance allocator.
+    ///
+    /// With `pooling`, memory and table slots are reserved once when the engine is created and
+    /// recycled on every instantiation, so a reload skips the mmap/munmap churn and memory images
+    /// are re-initialized copy-on-write. Pooling imposes fixed limits (`POOL_*`), and shared
+    /// memories are not supported; if the engine cannot reserve its pool this falls back to
+    /// on-demand allocation, and callers retry with `pooling = false` when a guest fails to
+    /// instantiate under the limits.
+    pub fn with_pooling(pooling: bool) -> Result<Self, anyhow::Error> {
         let mut cfg = wasmtime::Config::new();
 
         // Broadly supported/expected features for "modern" Wasm modules.
@@ -54,7 +93,42 @@ impl WasmtimeRuntime {
         // Exception handling proposal is useful for some toolchains.
         cfg.wasm_exceptions(true);
 
-        let engine = wasmtime::Engine::new(&cfg)?;
+        // JIT symbol maps for native profilers (`WASM96_PROFILE=perfmap|jitdump`).
+        let profiling = crate::profile::options();
+        if profiling.jitdump {
+            cfg.profiler(wasmtime::ProfilingStrategy::JitDump);
+        } else if profiling.perfmap {
+            cfg.profiler(wasmtime::ProfilingStrategy::PerfMap);
+        }
+
+        let mut pooled = false;
+        let mut engine = None;
+        if pooling {
+            let mut pool = PoolingAllocationConfig::default();
+            pool.total_core_instances(POOL_INSTANCES);
+            pool.total_memories(POOL_INSTANCES * POOL_MEMORIES_PER_MODULE);
+            pool.total_tables(POOL_INSTANCES * POOL_TABLES_PER_MODULE);
+            pool.total_gc_heaps(POOL_INSTANCES);
+            pool.max_memories_per_module(POOL_MEMORIES_PER_MODULE);
+            pool.max_tables_per_module(POOL_TABLES_PER_MODULE);
+            pool.max_memory_size(POOL_MAX_MEMORY_BYTES);
+            cfg.allocation_strategy(InstanceAllocationStrategy::Pooling(pool));
+
+            match wasmtime::Engine::new(&cfg) {
+                Ok(e) => {
+                    engine = Some(e);
+                    pooled = true;
+                }
+                Err(e) => {
+                    eprintln!("(wasm96) pooling allocator unavailable ({e}); using on-demand");
+                    cfg.allocation_strategy(InstanceAllocationStrategy::OnDemand);
+                }
+            }
+        }
+        let engine = match engine {
+            Some(e) => e,
+            None => wasmtime::Engine::new(&cfg)?,
+        };
         let store = Store::new(&engine, ());
         let linker = Linker::new(&engine);
 
@@ -62,9 +136,16 @@ impl WasmtimeRuntime {
             engine,
             store,
             linker,
+            pooled,
         })
     }
 
+    /// Drop the current store (and with it any instance, returning its pool slot) and start an
+    /// empty one.
+    pub fn reset_store(&mut self) {
+        self.store = Store::new(&self.engine, ());
+    }
+
     /// Define all host imports expected by guests under module `"env"`.
     ///
     /// Must be called before `instantiate`.
@@ -72,12 +153,24 @@ impl WasmtimeRuntime {
         super::imports::define_imports(&mut self.linker)
     }
 
-    /// Instantiate a module and wire up exports/memory.
+    /// Instantiate a module into a fresh store and wire up exports/memory.
     pub fn instantiate(
         &mut self,
         module: &Module,
     ) -> Result<(Instance, abi::GuestEntrypoints), anyhow::Error> {
-        let instance = self.linker.instantiate(&mut self.store, module)?;
+        // A fresh store per load: the previous guest's instance (and pool slot) is released
+        // instead of accumulating in a store that lives as long as the core.
+        self.reset_store();
+        // Link first, so missing or mistyped imports are reported as such and never retried.
+        let pre = self.linker.instantiate_pre(module)?;
+        let instance = pre.instantiate(&mut self.store).map_err(|e| {
+            // A trap in the start function is the guest's own failure, not the allocator's.
+            if e.is::<wasmtime::Trap>() {
+                e
+            } else {
+                e.context(AllocationFailed)
+            }
+        })?;
 
         // Register memory in global state (best-effort).
         let memory = instance
@@ -0,0 +1,784 @@
+//! Savestates for wasm96-core (`retro_serialize` / `retro_unserialize`).
+//!
+//! A state captures the guest and the host state it changes from frame to frame:
+//! - the exported linear memory (`memory`),
+//! - the guest's exported mutable globals (i32/i64/f32/f64),
+//! - the host framebuffer and draw color,
+//! - mixer voices (with the play position of streamed music) and the input snapshot,
+//! - the tiles of every tilemap,
+//! - the storage key/value store.
+//!
+//! Frontends use states for rewind (one per frame) and run-ahead (a save and a restore every
+//! frame), so both directions are built around linear memory, which dominates the size:
+//! - Memory is split into 4 KiB blocks. All-zero blocks (untouched heap, freed arenas) are one
+//!   bit in a bitmap instead of 4 KiB of payload, so saving skips them entirely.
+//! - Restoring compares each block with live memory and writes only the blocks that differ. For
+//!   run-ahead that is the handful of pages the guest touched in the frames being rolled back, so
+//!   the rest of memory is only read, never dirtied.
+//!
+//! States are self-contained and deterministic (storage keys are written sorted), which keeps the
+//! frontend's own delta compression effective; the core does not compress on top of it.
+//!
+//! Limits:
+//! - `serialize_size` leaves room for `MEMORY_GROWTH_BYTES` of `memory.grow` (within the memory's
+//!   maximum). A guest that grows past that fails `serialize` on frontends that ignore the
+//!   variable-size quirk, until the content is reloaded.
+//! - Non-exported globals are invisible to the host. States are only taken between frames, when
+//!   toolchain globals such as the shadow stack pointer are back at their base values.
+//! - Decoded sound effects are referenced by cache key rather than copied (see
+//!   `mixer::cached_pcm`); a voice whose decode has since been evicted is dropped on restore.
+//! - Streamed music keeps its live decoder and is moved back to the saved position (see
+//!   `PcmStream::seek`). Recently played frames are buffered, so run-ahead is exact for every
+//!   format; further back, WAV and QOA seek but XM modules cannot and keep their live position.
+//!   A streamed voice that has finished since the state was taken is dropped.
+//! - Tilemaps are restored by value into the maps that still exist with the same size. Maps
+//!   created or destroyed since, and their tilesets, are not.
+//! - Retained draw lists and registered assets (images, fonts, meshes, SVGs, sounds) are host
+//!   resources rather than state, and are left as they are: ones registered or destroyed after the
+//!   state was taken stay that way after a restore.
+
+use std::collections::HashMap;
+use std::sync::Arc;
+
+use wasmtime::{Extern, Instance, Mutability, Store, Val};
+
+use crate::av::audio_stream::StreamPosition;
+use crate::av::mixer::cached_pcm;
+use crate::av::resources::RESOURCES;
+use crate::state::{self, AudioChannel};
+
+const MAGIC: [u8; 4] = *b"W96S";
+const VERSION: u32 = 2;
+
+/// Memory diff granularity.
+const BLOCK: usize = 4096;
+
+/// Voices beyond this many are not saved (keeps the state size predictable).
+const MAX_SAVED_VOICES: usize = 256;
+const VOICE_BYTES: usize = 4 + 1 + 4 + 4 + 4 + 8 + 4 + 8 + 8 + 8;
+
+/// Headroom in `serialize_size` for storage writes made after the frontend sized its buffer.
+const SLACK_BYTES: usize = 64 << 10;
+
+/// Headroom in `serialize_size` for `memory.grow` after the frontend sized its buffer, capped
+/// by the memory's declared maximum. Frontends size rewind and run-ahead buffers once, and the
+/// variable-size quirk (see `libretro_glue`) only asks the ones that support it to re-query.
+const MEMORY_GROWTH_BYTES: usize = 16 << 20;
+
+const VOICE_ACTIVE: u8 = 1;
+const VOICE_LOOP: u8 = 2;
+const VOICE_STREAM: u8 = 4;
+
+const GLOBAL_I32: u8 = 0;
+const GLOBAL_I64: u8 = 1;
+const GLOBAL_F32: u8 = 2;
+const GLOBAL_F64: u8 = 3;
+
+struct Writer<'a> {
+    buf: &'a mut [u8],
+    pos: usize,
+}
+
+impl Writer<'_> {
+    /// Reserve `n` zeroed bytes; returns their offset.
+    fn zeroed(&mut self, n: usize) -> Option<usize> {
+        let at = self.pos;
+        self.buf.get_mut(at..at.checked_add(n)?)?.fill(0);
+        self.pos += n;
+        Some(at)
+    }
+
+    fn bytes(&mut self, b: &[u8]) -> Option<()> {
+        let at = self.pos;
+        self.buf
+            .get_mut(at..at.checked_add(b.len())?)?
+            .copy_from_slice(b);
+        self.pos += b.len();
+        Some(())
+    }
+
+    fn u8(&mut self, v: u8) -> Option<()> {
+        self.bytes(&[v])
+    }
+
+    fn u16(&mut self, v: u16) -> Option<()> {
+        self.bytes(&v.to_le_bytes())
+    }
+
+    fn u32(&mut self, v: u32) -> Option<()> {
+        self.bytes(&v.to_le_bytes())
+    }
+
+    fn u64(&mut self, v: u64) -> Option<()> {
+        self.bytes(&v.to_le_bytes())
+    }
+}
+
+struct Reader<'a> {
+    buf: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn bytes(&mut self, n: usize) -> Option<&'a [u8]> {
+        let b = self.buf.get(self.pos..self.pos.checked_add(n)?)?;
+        self.pos += n;
+        Some(b)
+    }
+
+    fn array<const N: usize>(&mut self) -> Option<[u8; N]> {
+        self.bytes(N)?.try_into().ok()
+    }
+
+    fn u8(&mut self) -> Option<u8> {
+        Some(self.array::<1>()?[0])
+    }
+
+    fn u16(&mut self) -> Option<u16> {
+        self.array().map(u16::from_le_bytes)
+    }
+
+    fn u32(&mut self) -> Option<u32> {
+        self.array().map(u32::from_le_bytes)
+    }
+
+    fn u64(&mut self) -> Option<u64> {
+        self.array().map(u64::from_le_bytes)
+    }
+}
+
+#[inline]
+fn is_zero(block: &[u8]) -> bool {
+    // OR-fold fixed chunks so the inner loop vectorizes; exit at the first non-zero chunk.
+    block
+        .chunks(64)
+        .all(|c| c.iter().fold(0u8, |acc, &b| acc | b) == 0)
+}
+
+fn memory(store: &mut Store<()>, instance: &Instance) -> Option<wasmtime::Memory> {
+    instance
+        .get_export(&mut *store, "memory")
+        .and_then(Extern::into_memory)
+}
+
+fn mutable_globals(store: &mut Store<()>, instance: &Instance) -> Vec<(String, wasmtime::Global)> {
+    let exports: Vec<(String, wasmtime::Global)> = instance
+        .exports(&mut *store)
+        .filter_map(|e| {
+            let name = e.name().to_string();
+            e.into_global().map(|g| (name, g))
+        })
+        .collect();
+    exports
+        .into_iter()
+        .filter(|(_, g)| g.ty(&*store).mutability() == Mutability::Var)
+        .collect()
+}
+
+/// Upper bound on the bytes `serialize` writes for the current guest, allowing for memory growth
+/// of up to `MEMORY_GROWTH_BYTES` and storage growth of up to `SLACK_BYTES`.
+pub fn serialize_size(store: &mut Store<()>, instance: &Instance) -> usize {
+    let mem_len = memory(store, instance).map_or(0, |m| {
+        let (size, ty) = (m.data_size(&*store), m.ty(&*store));
+        let max = ty
+            .maximum()
+            .map_or(u64::MAX, |p| p.saturating_mul(ty.page_size()));
+        let max = usize::try_from(max).unwrap_or(usize::MAX);
+        size.saturating_add(MEMORY_GROWTH_BYTES).min(max).max(size)
+    });
+    let blocks = mem_len.div_ceil(BLOCK);
+    let globals: usize = mutable_globals(store, instance)
+        .iter()
+        .map(|(name, _)| 2 + name.len().min(u16::MAX as usize) + 1 + 8)
+        .sum();
+
+    let tilemaps: usize = 4 + RESOURCES
+        .lock()
+        .unwrap()
+        .tilemaps
+        .values()
+        .map(|m| 8 + 4 + 4 + m.tiles().len() * 2)
+        .sum::<usize>();
+    let s = state::global().lock().unwrap();
+    let video = 4 * 4 + s.video.framebuffer.len() * 4 + 1 + 3 * 4;
+    let audio = 4 + 4 + MAX_SAVED_VOICES * VOICE_BYTES;
+    let input = 2 * 4 * s.input.buttons.len();
+    let storage: usize = 4 + s
+        .storage
+        .kv
+        .values()
+        .map(|v| 8 + 4 + v.len())
+        .sum::<usize>();
+
+    // header + memory + globals + sections
+    4 + 4
+        + 1
+        + (8 + blocks.div_ceil(8) + mem_len)
+        + (4 + globals)
+        + video
+        + audio
+        + input
+        + tilemaps
+        + storage
+        + SLACK_BYTES
+}
+
+/// Write a state into `out`. Returns false if there is no guest or `out` is too small.
+pub fn serialize(
+    store: &mut Store<()>,
+    instance: &Instance,
+    setup_called: bool,
+    out: &mut [u8],
+) -> bool {
+    write_state(store, instance, setup_called, out).is_some()
+}
+
+/// `serialize`, returning the number of bytes used.
+fn write_state(
+    store: &mut Store<()>,
+    instance: &Instance,
+    setup_called: bool,
+    out: &mut [u8],
+) -> Option<usize> {
+    // Read globals first: the memory slice below borrows the store for the rest of the write.
+    let globals: Vec<(String, u8, u64)> = mutable_globals(store, instance)
+        .into_iter()
+        .filter_map(|(name, g)| {
+            let (kind, bits) = match g.get(&mut *store) {
+                Val::I32(v) => (GLOBAL_I32, v as u32 as u64),
+                Val::I64(v) => (GLOBAL_I64, v as u64),
+                Val::F32(v) => (GLOBAL_F32, v as u64),
+                Val::F64(v) => (GLOBAL_F64, v),
+                // Reference/vector globals are not captured.
+                _ => return None,
+            };
+            Some((name, kind, bits))
+        })
+        .collect();
+
+    let mut w = Writer { buf: out, pos: 0 };
+    w.bytes(&MAGIC)?;
+    w.u32(VERSION)?;
+    w.u8(setup_called as u8)?;
+
+    // Linear memory: length, bitmap of non-zero blocks, then those blocks back to back.
+    let mem = memory(store, instance);
+    let data: &[u8] = mem.as_ref().map_or(&[][..], |m| m.data(&*store));
+    w.u64(data.len() as u64)?;
+    let bitmap = w.zeroed(data.len().div_ceil(BLOCK).div_ceil(8))?;
+    for (i, block) in data.chunks(BLOCK).enumerate() {
+        if !is_zero(block) {
+            w.buf[bitmap + i / 8] |= 1 << (i % 8);
+            w.bytes(block)?;
+        }
+    }
+
+    w.u32(globals.len() as u32)?;
+    for (name, kind, bits) in &globals {
+        let name = &name.as_bytes()[..name.len().min(u16::MAX as usize)];
+        w.u16(name.len() as u16)?;
+        w.bytes(name)?;
+        w.u8(*kind)?;
+        w.u64(*bits)?;
+    }
+
+    // RESOURCES before the global state: the established lock order.
+    let res = RESOURCES.lock().unwrap();
+    let mut s = state::global().lock().unwrap();
+    // Deferred primitives belong to the saved frame.
+    crate::av::tiles::resolve(&mut s.video);
+
+    let video = &s.video;
+    w.u32(video.width)?;
+    w.u32(video.height)?;
+    w.u32(video.draw_color)?;
+    w.u32(video.framebuffer.len() as u32)?;
+    for &px in &video.framebuffer {
+        w.u32(px)?;
+    }
+    match video.bound_framebuffer {
+        Some(b) => {
+            w.u8(1)?;
+            w.u32(b.ptr)?;
+            w.u32(b.width)?;
+            w.u32(b.height)?;
+        }
+        None => {
+            w.u8(0)?;
+            w.u32(0)?;
+            w.u32(0)?;
+            w.u32(0)?;
+        }
+    }
+
+    let audio = &s.audio;
+    w.u32(audio.next_voice_id)?;
+    let voices: Vec<&AudioChannel> = audio
+        .channels
+        .iter()
+        .filter(|v| v.active)
+        .take(MAX_SAVED_VOICES)
+        .collect();
+    w.u32(voices.len() as u32)?;
+    for v in voices {
+        let mut flags = VOICE_ACTIVE;
+        if v.loop_enabled {
+            flags |= VOICE_LOOP;
+        }
+        if v.stream.is_some() {
+            flags |= VOICE_STREAM;
+        }
+        w.u32(v.id)?;
+        w.u8(flags)?;
+        w.u32(v.volume_q8_8)?;
+        w.u32(v.pan_i16 as u32)?;
+        w.u32(v.sample_rate)?;
+        w.u64(v.position_frames as u64)?;
+        w.u32(v.position_frac)?;
+        w.u64(v.pcm_key)?;
+        let stream = v.stream.as_ref().map(|s| s.position()).unwrap_or_default();
+        w.u64(stream.played)?;
+        w.u64(stream.source)?;
+    }
+
+    for (&now, &prev) in s.input.buttons.iter().zip(s.input.prev_buttons.iter()) {
+        w.u32(now)?;
+        w.u32(prev)?;
+    }
+
+    let mut maps: Vec<u64> = res.tilemaps.keys().copied().collect();
+    maps.sort_unstable();
+    w.u32(maps.len() as u32)?;
+    for key in maps {
+        let map = &res.tilemaps[&key];
+        let (map_w, map_h) = map.size();
+        w.u64(key)?;
+        w.u32(map_w)?;
+        w.u32(map_h)?;
+        for &tile in map.tiles() {
+            w.u16(tile)?;
+        }
+    }
+
+    let mut keys: Vec<u64> = s.storage.kv.keys().copied().collect();
+    keys.sort_unstable();
+    w.u32(keys.len() as u32)?;
+    for key in keys {
+        let value = &s.storage.kv[&key];
+        w.u64(key)?;
+        w.u32(value.len() as u32)?;
+        w.bytes(value)?;
+    }
+
+    crate::profile::bytes_out(w.pos);
+    Some(w.pos)
+}
+
+struct SavedVoice {
+    id: u32,
+    flags: u8,
+    volume_q8_8: u32,
+    pan_i16: i32,
+    sample_rate: u32,
+    position_frames: usize,
+    position_frac: u32,
+    pcm_key: u64,
+    stream: StreamPosition,
+}
+
+struct SavedTilemap<'a> {
+    key: u64,
+    size: (u32, u32),
+    tiles: &'a [u8], // little-endian u16s
+}
+
+/// A parsed state; memory blocks still point into the frontend's buffer.
+struct Parsed<'a> {
+    setup_called: bool,
+    mem_len: usize,
+    bitmap: &'a [u8],
+    blocks: &'a [u8],
+    globals: Vec<(&'a [u8], Val)>,
+    width: u32,
+    height: u32,
+    draw_color: u32,
+    framebuffer: &'a [u8],
+    bound: Option<state::BoundFramebuffer>,
+    next_voice_id: u32,
+    voices: Vec<SavedVoice>,
+    input: Vec<(u32, u32)>,
+    tilemaps: Vec<SavedTilemap<'a>>,
+    storage: Vec<(u64, &'a [u8])>,
+}
+
+fn parse(data: &[u8]) -> Option<Parsed<'_>> {
+    let mut r = Reader { buf: data, pos: 0 };
+    if r.array::<4>()? != MAGIC || r.u32()? != VERSION {
+        return None;
+    }
+    let setup_called = r.u8()? != 0;
+
+    let mem_len = usize::try_from(r.u64()?).ok()?;
+    if mem_len % BLOCK != 0 {
+        return None; // not a Wasm memory size
+    }
+    let block_count = mem_len.div_ceil(BLOCK);
+    let bitmap = r.bytes(block_count.div_ceil(8))?;
+    let payload: usize = (0..block_count)
+        .filter(|i| bitmap[i / 8] & (1 << (i % 8)) != 0)
+        .map(|i| (mem_len - i * BLOCK).min(BLOCK))
+        .sum();
+    let blocks = r.bytes(payload)?;
+
+    let global_count = r.u32()? as usize;
+    let mut globals = Vec::with_capacity(global_count.min(1024));
+    for _ in 0..global_count {
+        let name_len = r.u16()? as usize;
+        let name = r.bytes(name_len)?;
+        let kind = r.u8()?;
+        let bits = r.u64()?;
+        let val = match kind {
+            GLOBAL_I32 => Val::I32(bits as u32 as i32),
+            GLOBAL_I64 => Val::I64(bits as i64),
+            GLOBAL_F32 => Val::F32(bits as u32),
+            GLOBAL_F64 => Val::F64(bits),
+            _ => return None,
+        };
+        globals.push((name, val));
+    }
+
+    let width = r.u32()?;
+    let height = r.u32()?;
+    let draw_color = r.u32()?;
+    let pixels = r.u32()? as usize;
+    if Some(pixels) != (width as usize).checked_mul(height as usize) {
+        return None;
+    }
+    let framebuffer = r.bytes(pixels.checked_mul(4)?)?;
+    let has_bound = r.u8()? != 0;
+    let (ptr, bw, bh) = (r.u32()?, r.u32()?, r.u32()?);
+    let bound = has_bound.then_some(state::BoundFramebuffer {
+        ptr,
+        width: bw,
+        height: bh,
+    });
+
+    let next_voice_id = r.u32()?;
+    let voice_count = r.u32()? as usize;
+    if voice_count > MAX_SAVED_VOICES {
+        return None;
+    }
+    let mut voices = Vec::with_capacity(voice_count);
+    for _ in 0..voice_count {
+        voices.push(SavedVoice {
+            id: r.u32()?,
+            flags: r.u8()?,
+            volume_q8_8: r.u32()?,
+            pan_i16: r.u32()? as i32,
+            sample_rate: r.u32()?,
+            position_frames: usize::try_from(r.u64()?).ok()?,
+            position_frac: r.u32()?,
+            pcm_key: r.u64()?,
+            stream: StreamPosition {
+                played: r.u64()?,
+                source: r.u64()?,
+            },
+        });
+    }
+
+    let mut input = Vec::with_capacity(crate::abi::input::MAX_PORTS as usize);
+    for _ in 0..crate::abi::input::MAX_PORTS {
+        input.push((r.u32()?, r.u32()?));
+    }
+
+    let map_count = r.u32()? as usize;
+    let mut tilemaps = Vec::with_capacity(map_count.min(256));
+    for _ in 0..map_count {
+        let key = r.u64()?;
+        let size = (r.u32()?, r.u32()?);
+        let count = (size.0 as usize).checked_mul(size.1 as usize)?;
+        let tiles = r.bytes(count.checked_mul(2)?)?;
+        tilemaps.push(SavedTilemap { key, size, tiles });
+    }
+
+    let entry_count = r.u32()? as usize;
+    let mut storage = Vec::with_capacity(entry_count.min(4096));
+    for _ in 0..entry_count {
+        let key = r.u64()?;
+        let len = r.u32()? as usize;
+        storage.push((key, r.bytes(len)?));
+    }
+
+    Some(Parsed {
+        setup_called,
+        mem_len,
+        bitmap,
+        blocks,
+        globals,
+        width,
+        height,
+        draw_color,
+        framebuffer,
+        bound,
+        next_voice_id,
+        voices,
+        input,
+        tilemaps,
+        storage,
+    })
+}
+
+/// Restore a state written by `serialize`. The whole buffer is validated before anything is
+/// changed, so a rejected state leaves the running guest untouched. Returns the state's
+/// `setup_called` flag on success.
+pub fn unserialize(store: &mut Store<()>, instance: &Instance, data: &[u8]) -> Option<bool> {
+    let p = parse(data)?;
+    crate::profile::bytes_in(data.len());
+
+    if let Some(mem) = memory(store, instance) {
+        const PAGE: usize = 64 << 10;
+        let live_len = mem.data_size(&*store);
+        if p.mem_len > live_len {
+            let pages = (p.mem_len - live_len).div_ceil(PAGE);
+            mem.grow(&mut *store, pages as u64).ok()?;
+        }
+
+        let live = mem.data_mut(&mut *store);
+        let mut packed = p.blocks;
+        for (i, block) in live.chunks_mut(BLOCK).enumerate() {
+            let saved = i * BLOCK < p.mem_len && p.bitmap[i / 8] & (1 << (i % 8)) != 0;
+            if saved {
+                let (src, rest) = packed.split_at(block.len());
+                packed = rest;
+                if block != src {
+                    block.copy_from_slice(src);
+                }
+            } else if !is_zero(block) {
+                // Zero in the state, or past its end (memory cannot shrink).
+                block.fill(0);
+            }
+        }
+    }
+
+    for (name, global) in mutable_globals(store, instance) {
+        if let Some((_, val)) = p.globals.iter().find(|(n, _)| *n == name.as_bytes()) {
+            // A type mismatch (different guest build) is ignored rather than failing the load.
+            let _ = global.set(&mut *store, val.clone());
+        }
+    }
+
+    {
+        // Only tiles that differ are written, so unchanged chunks stay cached.
+        let mut res = RESOURCES.lock().unwrap();
+        for saved in &p.tilemaps {
+            let Some(map) = res.tilemaps.get_mut(&saved.key) else {
+                continue;
+            };
+            if map.size() != saved.size {
+                continue;
+            }
+            let tiles: Vec<u16> = saved
+                .tiles
+                .chunks_exact(2)
+                .map(|t| u16::from_le_bytes([t[0], t[1]]))
+                .collect();
+            map.set_tiles(0, 0, saved.size.0, saved.size.1, &tiles);
+        }
+    }
+
+    // Music streams only exist once; keep live ones for the voices that are still playing.
+    let mut live_streams: Vec<AudioChannel> = {
+        let mut s = state::global().lock().unwrap();
+        std::mem::take(&mut s.audio.channels)
+            .into_iter()
+            .filter(|v| v.stream.is_some())
+            .collect()
+    };
+    let mut channels = Vec::with_capacity(p.voices.len());
+    for v in &p.voices {
+        let base = if v.flags & VOICE_STREAM != 0 {
+            let Some(i) = live_streams.iter().position(|c| c.id == v.id) else {
+                continue;
+            };
+            let mut live = live_streams.swap_remove(i);
+            // Back to the saved cursor; a stream that cannot seek there plays on from where it is.
+            if live.stream.as_mut().is_some_and(|s| s.seek(v.stream)) {
+                live.position_frames = v.position_frames;
+                live.position_frac = v.position_frac;
+            }
+            live
+        } else {
+            let Some(pcm) = cached_pcm(v.pcm_key) else {
+                continue;
+            };
+            AudioChannel {
+                pcm_stereo: Arc::clone(&pcm.pcm_stereo),
+                pcm_key: pcm.key,
+                sample_rate: v.sample_rate,
+                position_frames: v.position_frames,
+                position_frac: v.position_frac,
+                ..AudioChannel::default()
+            }
+        };
+        channels.push(AudioChannel {
+            id: v.id,
+            active: v.flags & VOICE_ACTIVE != 0,
+            loop_enabled: v.flags & VOICE_LOOP != 0,
+            volume_q8_8: v.volume_q8_8,
+            pan_i16: v.pan_i16,
+            ..base
+        });
+    }
+
+    let mut s = state::global().lock().unwrap();
+
+    let video = &mut s.video;
+    // Pending primitives were drawn on the timeline being abandoned.
+    video.display_list.discard();
+    video.width = p.width;
+    video.height = p.height;
+    video.draw_color = p.draw_color;
+    video.framebuffer.clear();
+    video.framebuffer.extend(
+        p.framebuffer
+            .chunks_exact(4)
+            .map(|px| u32::from_le_bytes([px[0], px[1], px[2], px[3]])),
+    );
+    video.bound_framebuffer = p.bound;
+    video.mark_all_damaged();
+
+    s.audio.channels = channels;
+    s.audio.next_voice_id = p.next_voice_id;
+    // Pushed samples belong to the timeline being abandoned.
+    crate::av::audio_ring::push_ring().clear();
+
+    for (i, &(now, prev)) in p.input.iter().enumerate() {
+        s.input.buttons[i] = now;
+        s.input.prev_buttons[i] = prev;
+    }
+
+    // Only touch keys whose value differs, so restoring (e.g. for run-ahead) journals nothing
+    // when storage did not change.
+    let restored: HashMap<u64, &[u8]> = p.storage.into_iter().collect();
+    let stale: Vec<u64> = s
+        .storage
+        .kv
+        .keys()
+        .filter(|k| !restored.contains_key(k))
+        .copied()
+        .collect();
+    for key in stale {
+        s.storage.remove(key);
+    }
+    for (key, value) in restored {
+        if s.storage.kv.get(&key).map(|v| &v[..]) != Some(value) {
+            s.storage.put(key, value.into());
+        }
+    }
+
+    Some(p.setup_called)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use wasmtime::{Engine, Module};
+
+    fn guest() -> (Store<()>, Instance) {
+        let engine = Engine::default();
+        let wat = r#"(module
+            (memory (export "memory") 1)
+            (global (export "score") (mut i32) (i32.const 5))
+            (global (export "fixed") i32 (i32.const 1)))"#;
+        let module = Module::new(&engine, wat).unwrap();
+        let mut store = Store::new(&engine, ());
+        let instance = Instance::new(&mut store, &module, &[]).unwrap();
+        (store, instance)
+    }
+
+    #[test]
+    fn state_round_trips_memory_and_globals_and_skips_zero_blocks() {
+        let (mut store, instance) = guest();
+        let mem = memory(&mut store, &instance).unwrap();
+        let global = instance.get_global(&mut store, "score").unwrap();
+
+        mem.data_mut(&mut store)[100] = 42;
+        global.set(&mut store, Val::I32(7)).unwrap();
+
+        let mut buf = vec![0u8; serialize_size(&mut store, &instance)];
+        let used = write_state(&mut store, &instance, true, &mut buf).unwrap();
+        // One non-zero 4 KiB block of the 64 KiB page is stored.
+        let framebuffer = state::global().lock().unwrap().video.framebuffer.len() * 4;
+        assert!(
+            used.saturating_sub(framebuffer) < 2 * BLOCK,
+            "zero blocks are elided"
+        );
+
+        // Diverge: change a saved byte, dirty a zero block, grow memory, change the global.
+        mem.data_mut(&mut store)[100] = 0;
+        mem.data_mut(&mut store)[5000] = 9;
+        mem.grow(&mut store, 1).unwrap();
+        mem.data_mut(&mut store)[70_000] = 3;
+        global.set(&mut store, Val::I32(1)).unwrap();
+
+        // A truncated state is rejected without touching the guest.
+        assert!(unserialize(&mut store, &instance, &buf[..used / 2]).is_none());
+        assert_eq!(mem.data(&store)[5000], 9);
+
+        assert_eq!(unserialize(&mut store, &instance, &buf[..used]), Some(true));
+        let data = mem.data(&store);
+        assert_eq!(data[100], 42);
+        assert_eq!(data[5000], 0);
+        assert_eq!(data[70_000], 0, "memory past the saved size is zeroed");
+        assert_eq!(global.get(&mut store).i32(), Some(7));
+
+        // Garbage is rejected.
+        assert!(unserialize(&mut store, &instance, b"not a state").is_none());
+    }
+
+    #[test]
+    fn size_reported_before_memory_grows_still_fits_the_state() {
+        let (mut store, instance) = guest();
+        let mem = memory(&mut store, &instance).unwrap();
+        let mut buf = vec![0u8; serialize_size(&mut store, &instance)];
+
+        // Frontends size their buffer once; the guest then grows and fills two more pages.
+        mem.grow(&mut store, 2).unwrap();
+        mem.data_mut(&mut store).fill(0xAB);
+        assert!(write_state(&mut store, &instance, true, &mut buf).is_some());
+    }
+
+    #[test]
+    fn state_restores_tilemap_tiles_in_place() {
+        use crate::av::resources::ImageResource;
+        use crate::av::tilemap::Tilemap;
+
+        const KEY: u64 = 0x5AFE_7115;
+        let tileset = ImageResource {
+            rgba: vec![255; 4 * 2 * 4].into(),
+            width: 4,
+            height: 2,
+        };
+        let mut map = Tilemap::new(&tileset, 2, 2, 3, 2).unwrap();
+        map.set_tiles(0, 0, 3, 1, &[1, 2, 1]);
+        RESOURCES.lock().unwrap().tilemaps.insert(KEY, map);
+
+        let (mut store, instance) = guest();
+        let mut buf = vec![0u8; serialize_size(&mut store, &instance)];
+        let used = write_state(&mut store, &instance, true, &mut buf).unwrap();
+
+        // The guest edits the map after the state was taken.
+        RESOURCES
+            .lock()
+            .unwrap()
+            .tilemaps
+            .get_mut(&KEY)
+            .unwrap()
+            .set_tiles(1, 1, 1, 1, &[2]);
+        assert!(unserialize(&mut store, &instance, &buf[..used]).is_some());
+
+        let mut res = RESOURCES.lock().unwrap();
+        let map = res.tilemaps.remove(&KEY).unwrap();
+        assert_eq!(map.tiles(), &[1, 2, 1, 0, 0, 0]);
+    }
+}
@@ -10,19 +10,24 @@
 
 use libretro_sys::{AudioSampleBatchFn, AudioSampleFn, InputPollFn, InputStateFn, VideoRefreshFn};
 use std::collections::HashMap;
-use std::sync::{Mutex, OnceLock};
+use std::sync::{Arc, OnceLock};
 
 use wasmtime::Memory as WasmtimeMemory;
 
+use crate::profile::TimedMutex;
+
 /// A single host-side “audio channel” (a.k.a. a mixing voice).
 ///
 /// This is used for higher-level playback APIs (e.g. `play_wav`, `play_ogg`, etc.)
 /// where the host decodes and mixes audio. Guests get back an `id` that can be
 /// adjusted (volume/pan/loop/stop) without pushing raw samples every frame.
 ///
-/// NOTE: Actual decoding/mixing logic lives elsewhere (e.g. `av`); this is only state.
-#[derive(Debug, Clone)]
+/// NOTE: Actual decoding/mixing logic lives elsewhere (`av::mixer`); this is only state.
+#[derive(Debug)]
 pub struct AudioChannel {
+    /// Voice handle returned to the guest (never 0).
+    pub id: u32,
+
     /// Whether this channel is currently active/playing.
     pub active: bool,
 
@@ -37,17 +42,26 @@ pub struct AudioChannel {
 
     /// Interleaved stereo PCM samples (i16) for this channel.
     ///
-    /// This is a simple representation that enables mixing without requiring the
-    /// guest to continuously feed audio. Decoders can fill this buffer and reset
-    /// `position_frames` as needed.
-    pub pcm_stereo: Vec<i16>,
+    /// Shared (not copied) between every voice playing the same decoded asset, so many
+    /// concurrent copies of one sound effect cost one buffer.
+    pub pcm_stereo: Arc<[i16]>,
+
+    /// `mixer::DecodedPcm::key` of `pcm_stereo` (0 if not from the PCM cache), so savestates can
+    /// refer to the decode instead of copying it.
+    pub pcm_key: u64,
+
+    /// Incremental decoder for long tracks and XM modules. When set, `pcm_stereo` is unused and
+    /// the position is relative to the stream's decoded window.
+    pub stream: Option<crate::av::audio_stream::PcmStream>,
 
-    /// Current playback position in *frames* (not i16 samples).
+    /// Current playback position in *source frames* (not i16 samples).
     /// One frame = 2 i16 samples (L, R).
     pub position_frames: usize,
 
-    /// Source sample rate for this channel's PCM.
-    #[allow(dead_code)]
+    /// Fractional part of the playback position, in 1/2^32 source frames (resampling).
+    pub position_frac: u32,
+
+    /// Source sample rate for this channel's PCM; resampled to `AudioState::sample_rate`.
     pub sample_rate: u32,
 }
 
@@ -58,8 +72,12 @@ impl Default for AudioChannel {
             volume_q8_8: 256,
             pan_i16: 0,
             loop_enabled: false,
-            pcm_stereo: Vec::new(),
+            id: 0,
+            pcm_stereo: Arc::from([]),
+            pcm_key: 0,
+            stream: None,
             position_frames: 0,
+            position_frac: 0,
             sample_rate: 44100,
         }
     }
@@ -77,6 +95,10 @@ pub struct GlobalState {
     pub input_poll_cb: Option<InputPollFn>,
     pub input_state_cb: Option<InputStateFn>,
 
+    /// Frontend accepts a NULL frame in `video_refresh` to repeat the previous one
+    /// (`RETRO_ENVIRONMENT_GET_CAN_DUPE`).
+    pub frontend_can_dupe: bool,
+
     /// Guest linear memory export (`memory`) for the Wasmtime runtime.
     ///
     /// Stored as a raw pointer because the rest of the codebase accesses global state
@@ -103,10 +125,10 @@ pub struct GlobalState {
 unsafe impl Send for GlobalState {}
 unsafe impl Sync for GlobalState {}
 
-static GLOBAL_STATE: OnceLock<Mutex<GlobalState>> = OnceLock::new();
+static GLOBAL_STATE: OnceLock<TimedMutex<GlobalState>> = OnceLock::new();
 
-pub fn global() -> &'static Mutex<GlobalState> {
-    GLOBAL_STATE.get_or_init(|| Mutex::new(GlobalState::default()))
+pub fn global() -> &'static TimedMutex<GlobalState> {
+    GLOBAL_STATE.get_or_init(|| TimedMutex::new(GlobalState::default()))
 }
 
 /// Host-owned framebuffer state for immediate mode drawing.
@@ -115,14 +137,146 @@ pub struct VideoState {
     pub width: u32,
     pub height: u32,
 
-    /// Framebuffer pixels (XRGB8888).
+    /// Framebuffer pixels (premultiplied ARGB).
     /// Size is width * height.
     /// Stored as `u32` for easy pixel manipulation.
-    /// Format: 0x00RRGGBB (little endian in memory: BB GG RR 00).
+    /// Format: 0xAARRGGBB with color already scaled by alpha (little endian in memory:
+    /// BB GG RR AA). The GL overlay blends it with `ONE, ONE_MINUS_SRC_ALPHA`; the software
+    /// path presents it as XRGB8888, where the alpha byte is ignored.
     pub framebuffer: Vec<u32>,
 
-    /// Current drawing color (packed 0x00RRGGBB for XRGB8888).
+    /// Current drawing color (packed 0xAARRGGBB; alpha < 255 blends, see `raster::fill_span`).
     pub draw_color: u32,
+
+    /// Guest-owned framebuffer bound with `wasm96_graphics_bind_framebuffer`.
+    ///
+    /// When set, present reads pixels straight out of guest linear memory instead of
+    /// `framebuffer`.
+    pub bound_framebuffer: Option<BoundFramebuffer>,
+
+    /// Pixels written since the last present (see `mark_damage`).
+    ///
+    /// Present uses this to skip unchanged frames and to upload only the changed part of the 3D
+    /// overlay texture.
+    pub damage: DamageRect,
+
+    /// Pixels written since the framebuffer was last cleared to transparent.
+    ///
+    /// Everything outside this rectangle is known to be 0 (transparent), so the 3D overlay is
+    /// only composited inside it.
+    pub overlay_bounds: DamageRect,
+
+    /// Primitives recorded but not yet drawn into `framebuffer` (deferred mode, see
+    /// `av::tiles`). Anything that reads or writes `framebuffer` directly must
+    /// `av::tiles::resolve` first.
+    pub display_list: crate::av::tiles::DisplayList,
+
+    /// Retained list being recorded between `wasm96_graphics_list_begin` and `_end`; while set,
+    /// primitives are captured instead of drawn (see `av::draw_lists`).
+    pub recording: Option<crate::av::draw_lists::Recording>,
+}
+
+impl VideoState {
+    /// Record a write to the pixels in `[x0, x1) x [y0, y1)`, clipped to the screen.
+    #[inline]
+    pub fn mark_damage(&mut self, x0: i32, y0: i32, x1: i32, y1: i32) {
+        let rect = DamageRect::clipped(x0, y0, x1, y1, self.width, self.height);
+        self.damage.union(rect);
+        self.overlay_bounds.union(rect);
+    }
+
+    /// Record a write to every pixel.
+    pub fn mark_all_damaged(&mut self) {
+        let full = DamageRect::full(self.width, self.height);
+        self.damage = full;
+        self.overlay_bounds = full;
+    }
+}
+
+/// Half-open pixel rectangle `[x0, x1) x [y0, y1)`; empty when `x0 >= x1` or `y0 >= y1`.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct DamageRect {
+    pub x0: u32,
+    pub y0: u32,
+    pub x1: u32,
+    pub y1: u32,
+}
+
+impl DamageRect {
+    pub fn full(width: u32, height: u32) -> Self {
+        Self {
+            x0: 0,
+            y0: 0,
+            x1: width,
+            y1: height,
+        }
+    }
+
+    /// The part of `[x0, x1) x [y0, y1)` inside a `width`x`height` screen.
+    pub fn clipped(x0: i32, y0: i32, x1: i32, y1: i32, width: u32, height: u32) -> Self {
+        let clip = |v: i32, max: u32| v.clamp(0, max as i32) as u32;
+        Self {
+            x0: clip(x0, width),
+            y0: clip(y0, height),
+            x1: clip(x1, width),
+            y1: clip(y1, height),
+        }
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.x0 >= self.x1 || self.y0 >= self.y1
+    }
+
+    pub fn width(&self) -> u32 {
+        self.x1.saturating_sub(self.x0)
+    }
+
+    pub fn height(&self) -> u32 {
+        self.y1.saturating_sub(self.y0)
+    }
+
+    /// Grow to the bounding box of `self` and `other`.
+    pub fn union(&mut self, other: DamageRect) {
+        if other.is_empty() {
+            return;
+        }
+        if self.is_empty() {
+            *self = other;
+            return;
+        }
+        self.x0 = self.x0.min(other.x0);
+        self.y0 = self.y0.min(other.y0);
+        self.x1 = self.x1.max(other.x1);
+        self.y1 = self.y1.max(other.y1);
+    }
+
+    /// Whether `other` lies entirely inside `self` (an empty `other` always does).
+    pub fn contains(&self, other: &DamageRect) -> bool {
+        other.is_empty()
+            || (self.x0 <= other.x0
+                && self.y0 <= other.y0
+                && self.x1 >= other.x1
+                && self.y1 >= other.y1)
+    }
+
+    /// Pack as `x << 48 | y << 32 | w << 16 | h` (16 bits each) for the guest ABI.
+    pub fn pack(&self) -> u64 {
+        if self.is_empty() {
+            return 0;
+        }
+        ((self.x0 as u64 & 0xFFFF) << 48)
+            | ((self.y0 as u64 & 0xFFFF) << 32)
+            | ((self.width() as u64 & 0xFFFF) << 16)
+            | (self.height() as u64 & 0xFFFF)
+    }
+}
+
+/// A region of guest linear memory presented as the frame (XRGB8888, pitch = width * 4).
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct BoundFramebuffer {
+    pub ptr: u32,
+    pub width: u32,
+    pub height: u32,
 }
 
 impl Default for VideoState {
@@ -131,7 +285,13 @@ impl Default for VideoState {
             width: 320, // Default size until set_size is called
             height: 240,
             framebuffer: vec![0; 320 * 240],
-            draw_color: 0x00FFFFFF, // Default white
+            draw_color: 0xFFFFFFFF, // Default opaque white
+            bound_framebuffer: None,
+            // The first frame has never been presented, so all of it is new.
+            damage: DamageRect::full(320, 240),
+            overlay_bounds: DamageRect::full(320, 240),
+            display_list: Default::default(),
+            recording: None,
         }
     }
 }
@@ -142,43 +302,97 @@ pub struct AudioState {
     /// Output sample rate (what libretro expects).
     pub sample_rate: u32,
 
-    /// Guest-provided staging buffer (interleaved i16 stereo).
-    ///
-    /// This is still supported for “raw push” style audio.
-    pub host_queue: Vec<i16>,
-
+    // Guest-pushed raw samples live in the lock-free `av::audio_ring` instead of here, so
+    // pushing audio does not contend on this mutex.
     /// Host-mixed playback channels (decoded assets like WAV/QOA/M4A/OGG).
     ///
     /// Guests can trigger playback via higher-level audio APIs and the core will mix
-    /// these channels into the output stream.
+    /// these channels into the output stream. Finished channels are removed after each mix.
     pub channels: Vec<AudioChannel>,
+
+    /// Next voice handle to hand out (wraps, skipping 0).
+    pub next_voice_id: u32,
+
+    /// f32 accumulation buffer reused by every mix (interleaved stereo).
+    pub mix_buffer: Vec<f32>,
 }
 
 impl Default for AudioState {
     fn default() -> Self {
         Self {
             sample_rate: 44100,
-            host_queue: Vec::new(),
-
             channels: Vec::new(),
+            next_voice_id: 1,
+            mix_buffer: Vec::new(),
         }
     }
 }
 
 /// Host-owned storage state.
 ///
-/// This is a simple in-memory key/value store used by the `storage` ABI.
-/// Persistence (e.g. to disk via libretro save APIs) can be added later.
+/// The in-memory key/value store used by the `storage` ABI. Reads always come from `kv`; when
+/// a `journal` is open (a game loaded with a save directory), every mutation is also queued to
+/// it so the store persists across sessions. Mutate through the methods below, not `kv`
+/// directly, so the journal stays in step.
 ///
-/// Keys and values are owned by the host.
+/// Keys and values are owned by the host. Values are shared buffers: a `put` hands the journal
+/// the same allocation the map keeps, so saving never copies the value on the frame thread.
 #[derive(Debug, Default)]
 pub struct StorageState {
-    pub kv: HashMap<u64, Vec<u8>>,
+    pub kv: HashMap<u64, Arc<[u8]>>,
+    pub journal: Option<crate::av::storage_log::Journal>,
+}
+
+impl StorageState {
+    /// Replace `key`'s value.
+    pub fn put(&mut self, key: u64, data: Arc<[u8]>) {
+        if let Some(journal) = &self.journal {
+            journal.put(key, Arc::clone(&data));
+        }
+        self.kv.insert(key, data);
+    }
+
+    /// Write `data` at `offset` in `key`'s value, creating or zero-extending it as needed.
+    ///
+    /// Patches in place when the value fits and the journal no longer holds it; otherwise the
+    /// value is copied into a new buffer first.
+    pub fn write(&mut self, key: u64, offset: u32, data: &[u8]) {
+        if let Some(journal) = &self.journal {
+            journal.write(key, offset, data.to_vec());
+        }
+        let (start, end) = (offset as usize, offset as usize + data.len());
+        let value = self.kv.entry(key).or_insert_with(|| Arc::from([]));
+        if Arc::get_mut(value).is_none_or(|v| v.len() < end) {
+            let grow = end.saturating_sub(value.len());
+            *value = value
+                .iter()
+                .copied()
+                .chain(std::iter::repeat_n(0, grow))
+                .collect();
+        }
+        if let Some(v) = Arc::get_mut(value) {
+            v[start..end].copy_from_slice(data);
+        }
+    }
+
+    /// Delete `key`.
+    pub fn remove(&mut self, key: u64) {
+        if self.kv.remove(&key).is_none() {
+            return;
+        }
+        if let Some(journal) = &self.journal {
+            journal.remove(key);
+        }
+    }
 }
 
 /// Minimal cached input state.
 #[derive(Default, Debug)]
 pub struct InputState {
+    /// Held joypad buttons per port this frame (bit `n` is `abi::Button` `n`).
+    pub buttons: [u32; crate::abi::input::MAX_PORTS as usize],
+    /// `buttons` as of the previous frame, for edge masks.
+    pub prev_buttons: [u32; crate::abi::input::MAX_PORTS as usize],
     pub mouse_x: i32,
     pub mouse_y: i32,
     pub mouse_buttons: u32,
@@ -204,6 +418,10 @@ pub fn set_input_state_cb(cb: Option<InputStateFn>) {
     global().lock().unwrap().input_state_cb = cb;
 }
 
+pub fn set_frontend_can_dupe(can_dupe: bool) {
+    global().lock().unwrap().frontend_can_dupe = can_dupe;
+}
+
 /// Set the guest memory for the Wasmtime runtime.
 pub fn set_guest_memory_wasmtime(memory: &WasmtimeMemory) {
     let mut s = global().lock().unwrap();
@@ -231,6 +449,7 @@ pub fn clear_on_unload() {
 
     s.video = VideoState::default();
     s.audio = AudioState::default();
+    crate::av::audio_ring::push_ring().clear();
     s.input = InputState::default();
     s.storage = StorageState::default();
 }
@@ -89,6 +89,36 @@ typedef struct {
     uint32_t height;
 } wasm96_text_size_t;
 
+// One instance for `wasm96_graphics_sprite_batch` (10 x 32-bit words, layout fixed by the ABI).
+//   w/h == 0: draw at the source size; otherwise scale (nearest-neighbor).
+//   src_w/src_h == 0: the whole image; otherwise a sub-rect (sprite sheets).
+//   tint: 0xAARRGGBB multiplied into each pixel (0xFFFFFFFF leaves it unchanged).
+typedef struct {
+    int32_t x;
+    int32_t y;
+    uint32_t w;
+    uint32_t h;
+    uint32_t src_x;
+    uint32_t src_y;
+    uint32_t src_w;
+    uint32_t src_h;
+    uint32_t flags; // bit 0: flip x, bit 1: flip y
+    uint32_t tint;
+} wasm96_sprite_t;
+
+// One string for `wasm96_graphics_text_batch` (6 x 32-bit words on wasm32, layout fixed by the ABI).
+//   text/text_len: UTF-8 bytes (need not be NUL-terminated).
+//   color: 0xAARRGGBB, or 0 for the current draw color.
+//   px: TTF/OTF size in pixels (0 = default 16); bitmap fonts ignore it.
+typedef struct {
+    int32_t x;
+    int32_t y;
+    const char* text;
+    uint32_t text_len;
+    uint32_t color;
+    uint32_t px;
+} wasm96_text_item_t;
+
 // Low-level raw ABI imports.
 extern void wasm96_graphics_set_size(uint32_t width, uint32_t height) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_set_size");
 extern void wasm96_graphics_set_color(uint32_t r, uint32_t g, uint32_t b, uint32_t a) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_set_color");
@@ -99,7 +129,14 @@ extern void wasm96_graphics_rect(int32_t x, int32_t y, uint32_t w, uint32_t h) W
 extern void wasm96_graphics_rect_outline(int32_t x, int32_t y, uint32_t w, uint32_t h) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_rect_outline");
 extern void wasm96_graphics_circle(int32_t x, int32_t y, uint32_t r) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_circle");
 extern void wasm96_graphics_circle_outline(int32_t x, int32_t y, uint32_t r) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_circle_outline");
+// Clear one rectangle (the framebuffer is otherwise retained between frames).
+extern void wasm96_graphics_clear_rect(int32_t x, int32_t y, uint32_t w, uint32_t h, uint32_t r, uint32_t g, uint32_t b) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_clear_rect");
+// Pixels drawn since the last present, packed `x << 48 | y << 32 | w << 16 | h` (0 = none).
+extern uint64_t wasm96_graphics_damage(void) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_damage");
+extern uint32_t wasm96_graphics_submit(const uint32_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_submit");
 extern void wasm96_graphics_image(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint8_t* data, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_image");
+// Present `w*h` pixels straight from guest memory (format 0 = XRGB8888). `w == 0` unbinds.
+extern uint32_t wasm96_graphics_bind_framebuffer(const uint32_t* ptr, uint32_t w, uint32_t h, uint32_t format) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_bind_framebuffer");
 extern void wasm96_graphics_image_png(int32_t x, int32_t y, const uint8_t* data, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_image_png");
 extern void wasm96_graphics_image_jpeg(int32_t x, int32_t y, const uint8_t* data, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_image_jpeg");
 extern void wasm96_graphics_triangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_triangle");
@@ -116,7 +153,11 @@ extern void wasm96_graphics_camera_perspective(float fovy, float aspect, float n
 extern uint32_t wasm96_graphics_mesh_create(uint64_t key, const float* v_ptr, uint32_t v_len, const uint32_t* i_ptr, uint32_t i_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_create");
 extern uint32_t wasm96_graphics_mesh_create_obj(uint64_t key, const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_create_obj");
 extern uint32_t wasm96_graphics_mesh_create_stl(uint64_t key, const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_create_stl");
+extern uint32_t wasm96_graphics_mesh_create_ex(uint64_t key, uint32_t format, const void* v_ptr, uint32_t v_len, const void* i_ptr, uint32_t i_len, uint32_t index_type) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_create_ex");
+extern uint32_t wasm96_graphics_mesh_create_blob(uint64_t key, const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_create_blob");
 extern void wasm96_graphics_mesh_draw(uint64_t key, float x, float y, float z, float rx, float ry, float rz, float sx, float sy, float sz) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_draw");
+extern void wasm96_graphics_mesh_draw_instanced(uint64_t key, const float* transforms, uint32_t count) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_draw_instanced");
+extern uint64_t wasm96_graphics_mesh_stats(void) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_stats");
 extern uint32_t wasm96_graphics_mesh_set_texture(uint64_t mesh_key, uint64_t image_key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_mesh_set_texture");
 
 // Materials / textures (OBJ+MTL workflows)
@@ -136,6 +177,10 @@ extern uint32_t wasm96_graphics_mtl_register_texture(
 extern uint32_t wasm96_graphics_svg_register(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_svg_register");
 extern void wasm96_graphics_svg_draw_key(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_svg_draw_key");
 extern void wasm96_graphics_svg_unregister(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_svg_unregister");
+// Rendered SVGs are cached per (key, w, h). Prerender in setup() so the first draw is a blit.
+extern uint32_t wasm96_graphics_svg_prerender(uint64_t key, uint32_t w, uint32_t h) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_svg_prerender");
+extern void wasm96_graphics_svg_evict(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_svg_evict");
+extern void wasm96_graphics_svg_set_cache_budget(uint32_t bytes) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_svg_set_cache_budget");
 
 extern uint32_t wasm96_graphics_gif_register(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_gif_register");
 extern void wasm96_graphics_gif_draw_key(uint64_t key, int32_t x, int32_t y) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_gif_draw_key");
@@ -152,15 +197,46 @@ extern void wasm96_graphics_jpeg_draw_key(uint64_t key, int32_t x, int32_t y) WA
 extern void wasm96_graphics_jpeg_draw_key_scaled(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_jpeg_draw_key_scaled");
 extern void wasm96_graphics_jpeg_unregister(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_jpeg_unregister");
 
+// Register `w*h` raw RGBA8888 pixels under a key (drawable like a keyed PNG, usable as a tileset).
+extern uint32_t wasm96_graphics_image_register(uint64_t key, uint32_t w, uint32_t h, const uint8_t* rgba, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_image_register");
+
+// Draw `count` instances of one keyed PNG/JPEG. Returns the number drawn (0 if the key is unknown).
+extern uint32_t wasm96_graphics_sprite_batch(uint64_t image_key, const wasm96_sprite_t* sprites, uint32_t count) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_sprite_batch");
+
+// Tilemaps: tile 0 is empty, tile n is cell n-1 of the tileset (a keyed image, row-major cells).
+extern uint32_t wasm96_tilemap_create(uint64_t key, uint64_t tileset_key, uint32_t tile_w, uint32_t tile_h, uint32_t map_w, uint32_t map_h) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_tilemap_create");
+extern uint32_t wasm96_tilemap_set_tiles(uint64_t key, uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint16_t* tiles) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_tilemap_set_tiles");
+extern void wasm96_tilemap_set_tile(uint64_t key, uint32_t x, uint32_t y, uint32_t tile) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_tilemap_set_tile");
+extern void wasm96_tilemap_draw(uint64_t key, int32_t scroll_x, int32_t scroll_y) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_tilemap_draw");
+extern void wasm96_tilemap_destroy(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_tilemap_destroy");
+
+// Retained draw lists: primitives between begin and end are captured on the host, not drawn.
+extern void wasm96_graphics_list_begin(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_list_begin");
+extern uint32_t wasm96_graphics_list_end(void) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_list_end");
+extern void wasm96_graphics_list_draw(uint64_t key, int32_t dx, int32_t dy) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_list_draw");
+extern void wasm96_graphics_list_destroy(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_list_destroy");
+
 extern uint32_t wasm96_graphics_font_register_ttf(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_font_register_ttf");
 extern uint32_t wasm96_graphics_font_register_bdf(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_font_register_bdf");
 extern uint32_t wasm96_graphics_font_register_spleen(uint64_t key, uint32_t size) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_font_register_spleen");
 extern void wasm96_graphics_font_unregister(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_font_unregister");
 extern void wasm96_graphics_text_key(int32_t x, int32_t y, uint64_t font_key, const uint8_t* text_ptr, uint32_t text_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_text_key");
 extern uint64_t wasm96_graphics_text_measure_key(uint64_t font_key, const uint8_t* text_ptr, uint32_t text_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_text_measure_key");
+// Sized variants: `px` is the TTF/OTF size in pixels (0 = default 16). Bitmap fonts ignore it.
+extern void wasm96_graphics_text_key_sized(int32_t x, int32_t y, uint64_t font_key, uint32_t px, const uint8_t* text_ptr, uint32_t text_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_text_key_sized");
+extern uint64_t wasm96_graphics_text_measure_key_sized(uint64_t font_key, uint32_t px, const uint8_t* text_ptr, uint32_t text_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_text_measure_key_sized");
+extern uint32_t wasm96_graphics_text_batch(uint64_t font_key, const wasm96_text_item_t* items, uint32_t count) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_graphics_text_batch");
+
+// Async assets (decoded on host worker threads; see `wasm96::AssetLoader`)
+extern uint32_t wasm96_asset_load(uint32_t kind, uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_asset_load");
+extern uint32_t wasm96_asset_status(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_asset_status");
+extern uint32_t wasm96_asset_wait_all(uint32_t timeout_ms) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_asset_wait_all");
 
 // Input
 extern uint32_t wasm96_input_is_button_down(uint32_t port, uint32_t btn) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_input_is_button_down");
+extern uint32_t wasm96_input_get_buttons(uint32_t port) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_input_get_buttons");
+extern uint32_t wasm96_input_get_pressed(uint32_t port) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_input_get_pressed");
+extern uint32_t wasm96_input_get_released(uint32_t port) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_input_get_released");
 extern uint32_t wasm96_input_is_key_down(uint32_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_input_is_key_down");
 extern int32_t wasm96_input_get_mouse_x(void) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_input_get_mouse_x");
 extern int32_t wasm96_input_get_mouse_y(void) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_input_get_mouse_y");
@@ -169,41 +245,185 @@ extern uint32_t wasm96_input_is_mouse_down(uint32_t btn) WASM96_WASM_IMPORT(WASM
 // Audio
 extern uint32_t wasm96_audio_init(uint32_t sample_rate) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_init");
 extern void wasm96_audio_push_samples(const int16_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_push_samples");
+extern uint32_t wasm96_audio_queued_frames(void) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_queued_frames");
 extern void wasm96_audio_play_wav(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_play_wav");
 extern void wasm96_audio_play_qoa(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_play_qoa");
 extern void wasm96_audio_play_xm(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_play_xm");
+extern uint32_t wasm96_audio_voice_play(uint32_t format, const uint8_t* ptr, uint32_t len, uint32_t loop) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_voice_play");
+extern void wasm96_audio_voice_set_volume(uint32_t id, uint32_t volume_q8_8) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_voice_set_volume");
+extern void wasm96_audio_voice_set_pan(uint32_t id, int32_t pan) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_voice_set_pan");
+extern void wasm96_audio_voice_set_loop(uint32_t id, uint32_t loop) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_voice_set_loop");
+extern void wasm96_audio_voice_stop(uint32_t id) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_voice_stop");
+extern uint32_t wasm96_audio_voice_is_playing(uint32_t id) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_audio_voice_is_playing");
 
 // Storage
 extern void wasm96_storage_save(uint64_t key, const uint8_t* data_ptr, uint32_t data_len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_storage_save");
 extern uint64_t wasm96_storage_load(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_storage_load");
 extern void wasm96_storage_free(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_storage_free");
+extern uint32_t wasm96_storage_size(uint64_t key) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_storage_size");
+extern uint32_t wasm96_storage_read(uint64_t key, uint8_t* dst_ptr, uint32_t dst_cap, uint32_t offset) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_storage_read");
+extern void wasm96_storage_write(uint64_t key, uint32_t offset, const uint8_t* src_ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_storage_write");
 
 // System
 extern void wasm96_system_log(const uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_system_log");
 extern uint64_t wasm96_system_millis(void) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_system_millis");
+extern uint32_t wasm96_system_stats(uint8_t* ptr, uint32_t len) WASM96_WASM_IMPORT(WASM96_WASM_IMPORT_MODULE, "wasm96_system_stats");
 
 } // extern "C"
 
-// Hash function
-static inline uint64_t wasm96_hash_key(const char* key) {
+// Hash function (64-bit FNV-1a over the key bytes, same as the Rust/Zig SDKs).
+// `constexpr`, so keys spelled as string literals can be hashed by the compiler.
+static constexpr uint64_t wasm96_hash_key(const char* key) {
     uint64_t hash = 0xcbf29ce484222325ULL;
     uint32_t i = 0;
     while (key[i] != '\0') {
-        hash ^= (uint64_t)key[i];
+        hash ^= (uint64_t)(uint8_t)key[i];
         hash *= 0x100000001b3ULL;
         i++;
     }
     return hash;
 }
 
-// Graphics API
 namespace wasm96 {
 
+// Precomputed keys.
+//
+// Every keyed method below also has an overload taking the `uint64_t` key directly, so
+// string hashing can be moved out of the frame loop:
+//
+//   using namespace wasm96::literals;
+//   constexpr uint64_t kFont = "ui"_k;            // hashed at compile time
+//   wasm96::Graphics::textKey(10, 10, kFont, "Score");
+//
+// `Key` carries the same value as a distinct type and converts to `uint64_t`.
+struct Key {
+    uint64_t value;
+    constexpr Key(const char* name) : value(wasm96_hash_key(name)) {}
+    constexpr explicit Key(uint64_t hashed) : value(hashed) {}
+    constexpr operator uint64_t() const { return value; }
+};
+
+namespace literals {
+
+#if __cplusplus >= 202002L
+consteval
+#else
+constexpr
+#endif
+uint64_t operator""_k(const char* key, decltype(sizeof(0)) len) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (decltype(sizeof(0)) i = 0; i < len; i++) {
+        hash ^= (uint64_t)(uint8_t)key[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+} // namespace literals
+
+// Screen rectangle (see `Graphics::damage`).
+struct Rect {
+    uint32_t x, y, w, h;
+    bool empty() const { return w == 0 || h == 0; }
+};
+
+// Sprite instance (see `SpriteBatch`).
+using Sprite = wasm96_sprite_t;
+static constexpr uint32_t SpriteFlipX = 1u;
+static constexpr uint32_t SpriteFlipY = 2u;
+static constexpr uint32_t TintNone = 0xFFFFFFFFu;
+
+// One string of a `TextBatch`.
+using TextItem = wasm96_text_item_t;
+static constexpr uint32_t TextColorCurrent = 0u;
+
+// Mesh instance for `Graphics::meshDrawInstanced` (9 floats, the same order as `meshDraw`).
+struct Transform {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    float rx = 0.0f, ry = 0.0f, rz = 0.0f;
+    float sx = 1.0f, sy = 1.0f, sz = 1.0f;
+};
+static_assert(sizeof(Transform) == 9 * sizeof(float), "Transform must match the ABI layout");
+
+// Vertex format for `Graphics::meshCreateEx`: OR one Position*, one Uv* and one Normal* value.
+// Attributes are packed in that order with no gaps; `vertexSize` is the sum.
+// 0 is the 32-byte float layout of `meshCreate`.
+namespace VertexFormat {
+enum : uint32_t {
+    PositionF32 = 0,       // float x3 (12 bytes)
+    PositionF16 = 1,       // half x3 + 1 padding half (8 bytes)
+    PositionSnorm16 = 2,   // int16 x3 + 1 padding, -32767..32767 -> -1..1 (8 bytes)
+    UvF32 = 0 << 2,        // float x2 (8 bytes)
+    UvUnorm16 = 1 << 2,    // uint16 x2, 0..65535 -> 0..1 (4 bytes)
+    UvNone = 2 << 2,       // no UVs
+    NormalF32 = 0 << 4,    // float x3 (12 bytes)
+    NormalOct16 = 1 << 4,  // octahedral-encoded int16 x2 (4 bytes, see `octEncode16`)
+};
+
+constexpr uint32_t vertexSize(uint32_t format) {
+    return ((format & 3u) == PositionF32 ? 12u : 8u)
+         + ((format & (3u << 2)) == UvF32 ? 8u : (format & (3u << 2)) == UvUnorm16 ? 4u : 0u)
+         + ((format & (3u << 4)) == NormalOct16 ? 4u : 12u);
+}
+} // namespace VertexFormat
+
+enum class IndexType : uint32_t { U32 = 0, U16 = 1 };
+
+constexpr int16_t packSnorm16(float v) {
+    return (int16_t)((v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v)) * 32767.0f + (v >= 0.0f ? 0.5f : -0.5f));
+}
+
+constexpr uint16_t packUnorm16(float v) {
+    return (uint16_t)((v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v)) * 65535.0f + 0.5f);
+}
+
+// Octahedral-encode a unit normal into two snorm16 components (`VertexFormat::NormalOct16`).
+inline void octEncode16(float nx, float ny, float nz, int16_t out[2]) {
+    auto absf = [](float f) { return f < 0.0f ? -f : f; };
+    float l1 = absf(nx) + absf(ny) + absf(nz);
+    float x = l1 > 0.0f ? nx / l1 : 0.0f, y = l1 > 0.0f ? ny / l1 : 0.0f;
+    if (nz < 0.0f) {
+        float fx = (1.0f - absf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - absf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+    out[0] = packSnorm16(x);
+    out[1] = packSnorm16(y);
+}
+
+// float -> IEEE half (`VertexFormat::PositionF16`). Values too small flush to zero, too large become inf.
+inline uint16_t f32ToF16(float f) {
+    uint32_t u;
+    __builtin_memcpy(&u, &f, sizeof u);
+    uint32_t sign = (u >> 16) & 0x8000u;
+    int32_t exp = (int32_t)((u >> 23) & 0xFFu) - 127 + 15;
+    uint32_t mant = u & 0x7FFFFFu;
+    if (exp <= 0) return (uint16_t)sign;
+    if (exp >= 31) return (uint16_t)(sign | 0x7C00u);
+    return (uint16_t)((sign | ((uint32_t)exp << 10) | (mant >> 13)) + ((mant >> 12) & 1u));
+}
+
+// Mesh draws this frame (see `Graphics::meshStats`).
+struct MeshStats {
+    uint32_t submitted;
+    uint32_t culled; // outside the camera frustum
+};
+
+// Graphics API
+
 class Graphics {
 public:
     static void setSize(uint32_t width, uint32_t height) { wasm96_graphics_set_size(width, height); }
     static void setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) { wasm96_graphics_set_color(r, g, b, a); }
     static void background(uint8_t r, uint8_t g, uint8_t b) { wasm96_graphics_background(r, g, b); }
+    // Partial redraw: skip `background` and repaint only what changed. Frames where nothing is
+    // drawn are not re-sent to the frontend at all.
+    static void clearRect(int32_t x, int32_t y, uint32_t w, uint32_t h, uint8_t r, uint8_t g, uint8_t b) { wasm96_graphics_clear_rect(x, y, w, h, r, g, b); }
+    static Rect damage() {
+        uint64_t p = wasm96_graphics_damage();
+        return Rect{ (uint32_t)(p >> 48) & 0xFFFFu, (uint32_t)(p >> 32) & 0xFFFFu, (uint32_t)(p >> 16) & 0xFFFFu, (uint32_t)p & 0xFFFFu };
+    }
     static void point(int32_t x, int32_t y) { wasm96_graphics_point(x, y); }
     static void line(int32_t x1, int32_t y1, int32_t x2, int32_t y2) { wasm96_graphics_line(x1, y1, x2, y2); }
     static void rect(int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_rect(x, y, w, h); }
@@ -211,6 +431,8 @@ public:
     static void circle(int32_t x, int32_t y, uint32_t r) { wasm96_graphics_circle(x, y, r); }
     static void circleOutline(int32_t x, int32_t y, uint32_t r) { wasm96_graphics_circle_outline(x, y, r); }
     static void image(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint8_t* data, uint32_t len) { wasm96_graphics_image(x, y, w, h, data, len); }
+    static bool bindFramebuffer(uint32_t* pixels, uint32_t w, uint32_t h) { return wasm96_graphics_bind_framebuffer(pixels, w, h, 0) != 0; }
+    static void unbindFramebuffer() { (void)wasm96_graphics_bind_framebuffer(nullptr, 0, 0, 0); }
     static void imagePng(int32_t x, int32_t y, const uint8_t* data, uint32_t len) { wasm96_graphics_image_png(x, y, data, len); }
     static void imageJpeg(int32_t x, int32_t y, const uint8_t* data, uint32_t len) { wasm96_graphics_image_jpeg(x, y, data, len); }
     static void triangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3) { wasm96_graphics_triangle(x1, y1, x2, y2, x3, y3); }
@@ -224,10 +446,32 @@ public:
     static void cameraLookAt(float ex, float ey, float ez, float tx, float ty, float tz, float ux, float uy, float uz) { wasm96_graphics_camera_look_at(ex, ey, ez, tx, ty, tz, ux, uy, uz); }
     static void cameraPerspective(float fovy, float aspect, float near, float far) { wasm96_graphics_camera_perspective(fovy, aspect, near, far); }
     static bool meshCreate(const char* key, const float* vertices, uint32_t v_len, const uint32_t* indices, uint32_t i_len) { return wasm96_graphics_mesh_create(wasm96_hash_key(key), vertices, v_len, indices, i_len) != 0; }
+    static bool meshCreate(uint64_t key, const float* vertices, uint32_t v_len, const uint32_t* indices, uint32_t i_len) { return wasm96_graphics_mesh_create(key, vertices, v_len, indices, i_len) != 0; }
     static bool meshCreateObj(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_mesh_create_obj(wasm96_hash_key(key), data, len) != 0; }
+    static bool meshCreateObj(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_mesh_create_obj(key, data, len) != 0; }
+    // Compact mesh: `vCount` vertices laid out per `format` (`VertexFormat::*`), `iCount` indices.
+    static bool meshCreateEx(uint64_t key, uint32_t format, const void* vertices, uint32_t vCount, const uint16_t* indices, uint32_t iCount) { return wasm96_graphics_mesh_create_ex(key, format, vertices, vCount, indices, iCount, (uint32_t)IndexType::U16) != 0; }
+    static bool meshCreateEx(uint64_t key, uint32_t format, const void* vertices, uint32_t vCount, const uint32_t* indices, uint32_t iCount) { return wasm96_graphics_mesh_create_ex(key, format, vertices, vCount, indices, iCount, (uint32_t)IndexType::U32) != 0; }
+    static bool meshCreateEx(const char* key, uint32_t format, const void* vertices, uint32_t vCount, const uint16_t* indices, uint32_t iCount) { return meshCreateEx(wasm96_hash_key(key), format, vertices, vCount, indices, iCount); }
+    static bool meshCreateEx(const char* key, uint32_t format, const void* vertices, uint32_t vCount, const uint32_t* indices, uint32_t iCount) { return meshCreateEx(wasm96_hash_key(key), format, vertices, vCount, indices, iCount); }
+    // Pre-baked mesh blob (`just bake-mesh in.obj out.w96m`); uploaded without parsing.
+    static bool meshCreateBlob(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_mesh_create_blob(wasm96_hash_key(key), data, len) != 0; }
+    static bool meshCreateBlob(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_mesh_create_blob(key, data, len) != 0; }
     static bool meshCreateStl(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_mesh_create_stl(wasm96_hash_key(key), data, len) != 0; }
+    static bool meshCreateStl(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_mesh_create_stl(key, data, len) != 0; }
     static void meshDraw(const char* key, float x, float y, float z, float rx, float ry, float rz, float sx, float sy, float sz) { wasm96_graphics_mesh_draw(wasm96_hash_key(key), x, y, z, rx, ry, rz, sx, sy, sz); }
+    static void meshDraw(uint64_t key, float x, float y, float z, float rx, float ry, float rz, float sx, float sy, float sz) { wasm96_graphics_mesh_draw(key, x, y, z, rx, ry, rz, sx, sy, sz); }
+    // Draw `count` copies of a mesh in one call; all copies share the current color and texture.
+    static void meshDrawInstanced(const char* key, const Transform* transforms, uint32_t count) { wasm96_graphics_mesh_draw_instanced(wasm96_hash_key(key), &transforms->x, count); }
+    static void meshDrawInstanced(uint64_t key, const Transform* transforms, uint32_t count) { wasm96_graphics_mesh_draw_instanced(key, &transforms->x, count); }
+    static void meshDrawInstanced(uint64_t key, const float* transforms, uint32_t count) { wasm96_graphics_mesh_draw_instanced(key, transforms, count); }
+    // Mesh draws submitted and frustum-culled since the start of the frame.
+    static MeshStats meshStats() {
+        uint64_t p = wasm96_graphics_mesh_stats();
+        return MeshStats{(uint32_t)(p >> 32), (uint32_t)p};
+    }
     static bool meshSetTexture(const char* mesh_key, const char* image_key) { return wasm96_graphics_mesh_set_texture(wasm96_hash_key(mesh_key), wasm96_hash_key(image_key)) != 0; }
+    static bool meshSetTexture(uint64_t mesh_key, uint64_t image_key) { return wasm96_graphics_mesh_set_texture(mesh_key, image_key) != 0; }
 
     // Register an encoded texture referenced by an `.mtl` file (`map_Kd`) under `texture_key`.
     //
@@ -239,9 +483,19 @@ public:
         const char* tex_filename,
         const uint8_t* tex_bytes,
         uint32_t tex_len
+    ) {
+        return mtlRegisterTexture(wasm96_hash_key(texture_key), mtl_bytes, mtl_len, tex_filename, tex_bytes, tex_len);
+    }
+    static bool mtlRegisterTexture(
+        uint64_t texture_key,
+        const uint8_t* mtl_bytes,
+        uint32_t mtl_len,
+        const char* tex_filename,
+        const uint8_t* tex_bytes,
+        uint32_t tex_len
     ) {
         return wasm96_graphics_mtl_register_texture(
-            wasm96_hash_key(texture_key),
+            texture_key,
             mtl_bytes,
             mtl_len,
             (const uint8_t*)tex_filename,
@@ -252,44 +506,478 @@ public:
     }
 
     static bool svgRegister(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_svg_register(wasm96_hash_key(key), data, len) != 0; }
+    static bool svgRegister(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_svg_register(key, data, len) != 0; }
     static void svgDrawKey(const char* key, int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_svg_draw_key(wasm96_hash_key(key), x, y, w, h); }
+    static void svgDrawKey(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_svg_draw_key(key, x, y, w, h); }
     static void svgUnregister(const char* key) { wasm96_graphics_svg_unregister(wasm96_hash_key(key)); }
+    static void svgUnregister(uint64_t key) { wasm96_graphics_svg_unregister(key); }
+    static bool svgPrerender(const char* key, uint32_t w, uint32_t h) { return wasm96_graphics_svg_prerender(wasm96_hash_key(key), w, h) != 0; }
+    static bool svgPrerender(uint64_t key, uint32_t w, uint32_t h) { return wasm96_graphics_svg_prerender(key, w, h) != 0; }
+    static void svgEvict(const char* key) { wasm96_graphics_svg_evict(wasm96_hash_key(key)); }
+    static void svgEvict(uint64_t key) { wasm96_graphics_svg_evict(key); }
+    static void svgSetCacheBudget(uint32_t bytes) { wasm96_graphics_svg_set_cache_budget(bytes); }
 
     static bool gifRegister(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_gif_register(wasm96_hash_key(key), data, len) != 0; }
+    static bool gifRegister(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_gif_register(key, data, len) != 0; }
     static void gifDrawKey(const char* key, int32_t x, int32_t y) { wasm96_graphics_gif_draw_key(wasm96_hash_key(key), x, y); }
+    static void gifDrawKey(uint64_t key, int32_t x, int32_t y) { wasm96_graphics_gif_draw_key(key, x, y); }
     static void gifDrawKeyScaled(const char* key, int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_gif_draw_key_scaled(wasm96_hash_key(key), x, y, w, h); }
+    static void gifDrawKeyScaled(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_gif_draw_key_scaled(key, x, y, w, h); }
     static void gifUnregister(const char* key) { wasm96_graphics_gif_unregister(wasm96_hash_key(key)); }
+    static void gifUnregister(uint64_t key) { wasm96_graphics_gif_unregister(key); }
 
     static bool pngRegister(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_png_register(wasm96_hash_key(key), data, len) != 0; }
+    static bool pngRegister(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_png_register(key, data, len) != 0; }
     static void pngDrawKey(const char* key, int32_t x, int32_t y) { wasm96_graphics_png_draw_key(wasm96_hash_key(key), x, y); }
+    static void pngDrawKey(uint64_t key, int32_t x, int32_t y) { wasm96_graphics_png_draw_key(key, x, y); }
     static void pngDrawKeyScaled(const char* key, int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_png_draw_key_scaled(wasm96_hash_key(key), x, y, w, h); }
+    static void pngDrawKeyScaled(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_png_draw_key_scaled(key, x, y, w, h); }
     static void pngUnregister(const char* key) { wasm96_graphics_png_unregister(wasm96_hash_key(key)); }
+    static void pngUnregister(uint64_t key) { wasm96_graphics_png_unregister(key); }
 
     static bool jpegRegister(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_jpeg_register(wasm96_hash_key(key), data, len) != 0; }
+    static bool jpegRegister(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_jpeg_register(key, data, len) != 0; }
     static void jpegDrawKey(const char* key, int32_t x, int32_t y) { wasm96_graphics_jpeg_draw_key(wasm96_hash_key(key), x, y); }
+    static void jpegDrawKey(uint64_t key, int32_t x, int32_t y) { wasm96_graphics_jpeg_draw_key(key, x, y); }
     static void jpegDrawKeyScaled(const char* key, int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_jpeg_draw_key_scaled(wasm96_hash_key(key), x, y, w, h); }
+    static void jpegDrawKeyScaled(uint64_t key, int32_t x, int32_t y, uint32_t w, uint32_t h) { wasm96_graphics_jpeg_draw_key_scaled(key, x, y, w, h); }
     static void jpegUnregister(const char* key) { wasm96_graphics_jpeg_unregister(wasm96_hash_key(key)); }
+    static void jpegUnregister(uint64_t key) { wasm96_graphics_jpeg_unregister(key); }
+
+    // Raw RGBA8888 pixels under a key: drawable like a keyed PNG, usable as a tileset.
+    static bool imageRegister(const char* key, uint32_t w, uint32_t h, const uint8_t* rgba, uint32_t len) { return wasm96_graphics_image_register(wasm96_hash_key(key), w, h, rgba, len) != 0; }
+    static bool imageRegister(uint64_t key, uint32_t w, uint32_t h, const uint8_t* rgba, uint32_t len) { return wasm96_graphics_image_register(key, w, h, rgba, len) != 0; }
+
+    static uint32_t spriteBatch(const char* imageKey, const Sprite* sprites, uint32_t count) { return wasm96_graphics_sprite_batch(wasm96_hash_key(imageKey), sprites, count); }
+    static uint32_t spriteBatch(uint64_t imageKey, const Sprite* sprites, uint32_t count) { return wasm96_graphics_sprite_batch(imageKey, sprites, count); }
+
+    // Retained draw lists (see `ScopedList`). `listEnd` returns the number of primitives captured.
+    static void listBegin(const char* key) { wasm96_graphics_list_begin(wasm96_hash_key(key)); }
+    static void listBegin(uint64_t key) { wasm96_graphics_list_begin(key); }
+    static uint32_t listEnd() { return wasm96_graphics_list_end(); }
+    static void listDraw(const char* key, int32_t dx, int32_t dy) { wasm96_graphics_list_draw(wasm96_hash_key(key), dx, dy); }
+    static void listDraw(uint64_t key, int32_t dx, int32_t dy) { wasm96_graphics_list_draw(key, dx, dy); }
+    static void listDestroy(const char* key) { wasm96_graphics_list_destroy(wasm96_hash_key(key)); }
+    static void listDestroy(uint64_t key) { wasm96_graphics_list_destroy(key); }
 
     static bool fontRegisterTtf(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_font_register_ttf(wasm96_hash_key(key), data, len) != 0; }
+    static bool fontRegisterTtf(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_font_register_ttf(key, data, len) != 0; }
     static bool fontRegisterBdf(const char* key, const uint8_t* data, uint32_t len) { return wasm96_graphics_font_register_bdf(wasm96_hash_key(key), data, len) != 0; }
+    static bool fontRegisterBdf(uint64_t key, const uint8_t* data, uint32_t len) { return wasm96_graphics_font_register_bdf(key, data, len) != 0; }
     static bool fontRegisterSpleen(const char* key, uint32_t size) { return wasm96_graphics_font_register_spleen(wasm96_hash_key(key), size) != 0; }
+    static bool fontRegisterSpleen(uint64_t key, uint32_t size) { return wasm96_graphics_font_register_spleen(key, size) != 0; }
     static void fontUnregister(const char* key) { wasm96_graphics_font_unregister(wasm96_hash_key(key)); }
-    static void textKey(int32_t x, int32_t y, const char* font_key, const char* text) {
+    static void fontUnregister(uint64_t key) { wasm96_graphics_font_unregister(key); }
+    static void textKey(int32_t x, int32_t y, const char* font_key, const char* text) { textKey(x, y, wasm96_hash_key(font_key), text); }
+    static void textKey(int32_t x, int32_t y, uint64_t font_key, const char* text) {
         uint32_t len = wasm96_strlen_(text);
-        wasm96_graphics_text_key(x, y, wasm96_hash_key(font_key), (const uint8_t*)text, len);
+        wasm96_graphics_text_key(x, y, font_key, (const uint8_t*)text, len);
     }
-    static wasm96_text_size_t textMeasureKey(const char* font_key, const char* text) {
+    static wasm96_text_size_t textMeasureKey(const char* font_key, const char* text) { return textMeasureKey(wasm96_hash_key(font_key), text); }
+    static wasm96_text_size_t textMeasureKey(uint64_t font_key, const char* text) {
         uint32_t len = wasm96_strlen_(text);
-        uint64_t packed = wasm96_graphics_text_measure_key(wasm96_hash_key(font_key), (const uint8_t*)text, len);
+        uint64_t packed = wasm96_graphics_text_measure_key(font_key, (const uint8_t*)text, len);
         wasm96_text_size_t ts;
         ts.width = (uint32_t)(packed >> 32);
         ts.height = (uint32_t)(packed & 0xFFFFFFFFULL);
         return ts;
     }
+    static void textKeySized(int32_t x, int32_t y, const char* font_key, uint32_t px, const char* text) { textKeySized(x, y, wasm96_hash_key(font_key), px, text); }
+    static void textKeySized(int32_t x, int32_t y, uint64_t font_key, uint32_t px, const char* text) {
+        uint32_t len = wasm96_strlen_(text);
+        wasm96_graphics_text_key_sized(x, y, font_key, px, (const uint8_t*)text, len);
+    }
+    static wasm96_text_size_t textMeasureKeySized(const char* font_key, uint32_t px, const char* text) { return textMeasureKeySized(wasm96_hash_key(font_key), px, text); }
+    static wasm96_text_size_t textMeasureKeySized(uint64_t font_key, uint32_t px, const char* text) {
+        uint32_t len = wasm96_strlen_(text);
+        uint64_t packed = wasm96_graphics_text_measure_key_sized(font_key, px, (const uint8_t*)text, len);
+        wasm96_text_size_t ts;
+        ts.width = (uint32_t)(packed >> 32);
+        ts.height = (uint32_t)(packed & 0xFFFFFFFFULL);
+        return ts;
+    }
+    // Draw `count` strings in one font with one call. Returns the number drawn.
+    static uint32_t textBatch(const char* font_key, const TextItem* items, uint32_t count) { return wasm96_graphics_text_batch(wasm96_hash_key(font_key), items, count); }
+    static uint32_t textBatch(uint64_t font_key, const TextItem* items, uint32_t count) { return wasm96_graphics_text_batch(font_key, items, count); }
+};
+
+// Guest-owned framebuffer: `W*H` 0x00RRGGBB pixels the host presents directly every frame
+// (no copy, no per-pixel import calls). While bound, host drawing calls are not visible.
+//
+// Use static storage (the host reads the pixels after `draw()` returns):
+//   static wasm96::Framebuffer<320, 240> fb;
+//   void setup() { fb.bind(); }
+//   void draw() { fb.set(x, y, 0xFF8800); }
+template <uint32_t W, uint32_t H>
+class Framebuffer {
+public:
+    static_assert(W > 0 && H > 0, "Framebuffer dimensions must be non-zero");
+
+    bool bind() { return Graphics::bindFramebuffer(pixels_, W, H); }
+    void unbind() { Graphics::unbindFramebuffer(); }
+
+    static constexpr uint32_t width() { return W; }
+    static constexpr uint32_t height() { return H; }
+
+    uint32_t* data() { return pixels_; }
+    const uint32_t* data() const { return pixels_; }
+    uint32_t* row(uint32_t y) { return pixels_ + y * W; }
+
+    void set(int32_t x, int32_t y, uint32_t rgb) {
+        if (x >= 0 && y >= 0 && (uint32_t)x < W && (uint32_t)y < H) pixels_[(uint32_t)y * W + (uint32_t)x] = rgb;
+    }
+    void fill(uint32_t rgb) {
+        for (uint32_t i = 0; i < W * H; i++) pixels_[i] = rgb;
+    }
+
+private:
+    alignas(4) uint32_t pixels_[W * H] = {};
+};
+
+// Batched drawing: records are queued in an inline buffer and executed by the host with a
+// single `wasm96_graphics_submit` call (one boundary crossing, one host lock).
+//
+// Commands run on `submit()`, not when they are appended, so submit before issuing
+// immediate-mode calls that must layer on top. A full list submits itself automatically.
+//
+// Prefer a long-lived (e.g. namespace-scope) instance: the buffer is `CapacityWords * 4` bytes.
+template <uint32_t CapacityWords = 1024>
+class CommandList {
+public:
+    enum Op : uint32_t {
+        SetColor = 1,
+        Background = 2,
+        Point = 3,
+        Line = 4,
+        Rect = 5,
+        RectOutline = 6,
+        Circle = 7,
+        CircleOutline = 8,
+        Triangle = 9,
+        TriangleOutline = 10,
+        BezierQuadratic = 11,
+        BezierCubic = 12,
+        Pill = 13,
+        PillOutline = 14,
+        ClearRect = 15,
+    };
+
+    CommandList& setColor(uint8_t r, uint8_t g, uint8_t b, uint8_t a) { return push(SetColor, r, g, b, a); }
+    CommandList& background(uint8_t r, uint8_t g, uint8_t b) { return push(Background, r, g, b); }
+    CommandList& point(int32_t x, int32_t y) { return push(Point, x, y); }
+    CommandList& line(int32_t x1, int32_t y1, int32_t x2, int32_t y2) { return push(Line, x1, y1, x2, y2); }
+    CommandList& rect(int32_t x, int32_t y, uint32_t w, uint32_t h) { return push(Rect, x, y, w, h); }
+    CommandList& rectOutline(int32_t x, int32_t y, uint32_t w, uint32_t h) { return push(RectOutline, x, y, w, h); }
+    CommandList& circle(int32_t x, int32_t y, uint32_t r) { return push(Circle, x, y, r); }
+    CommandList& circleOutline(int32_t x, int32_t y, uint32_t r) { return push(CircleOutline, x, y, r); }
+    CommandList& triangle(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3) { return push(Triangle, x1, y1, x2, y2, x3, y3); }
+    CommandList& triangleOutline(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t x3, int32_t y3) { return push(TriangleOutline, x1, y1, x2, y2, x3, y3); }
+    CommandList& bezierQuadratic(int32_t x1, int32_t y1, int32_t cx, int32_t cy, int32_t x2, int32_t y2, uint32_t segments) { return push(BezierQuadratic, x1, y1, cx, cy, x2, y2, segments); }
+    CommandList& bezierCubic(int32_t x1, int32_t y1, int32_t cx1, int32_t cy1, int32_t cx2, int32_t cy2, int32_t x2, int32_t y2, uint32_t segments) { return push(BezierCubic, x1, y1, cx1, cy1, cx2, cy2, x2, y2, segments); }
+    CommandList& pill(int32_t x, int32_t y, uint32_t w, uint32_t h) { return push(Pill, x, y, w, h); }
+    CommandList& pillOutline(int32_t x, int32_t y, uint32_t w, uint32_t h) { return push(PillOutline, x, y, w, h); }
+    CommandList& clearRect(int32_t x, int32_t y, uint32_t w, uint32_t h, uint8_t r, uint8_t g, uint8_t b) { return push(ClearRect, x, y, w, h, r, g, b); }
+
+    // Execute all queued commands and empty the list. Returns the number of records executed.
+    uint32_t submit() {
+        uint32_t executed = 0;
+        if (count_ != 0) executed = wasm96_graphics_submit(words_, count_ * 4u);
+        count_ = 0;
+        return executed;
+    }
+
+    void clear() { count_ = 0; }
+    uint32_t sizeWords() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+private:
+    static_assert(CapacityWords >= 10, "CommandList must hold at least one bezierCubic record");
+
+    template <typename... Args>
+    CommandList& push(Op op, Args... args) {
+        constexpr uint32_t argc = sizeof...(Args);
+        if (count_ + 1u + argc > CapacityWords) submit();
+        words_[count_++] = static_cast<uint32_t>(op) | (argc << 16);
+        const uint32_t values[] = { static_cast<uint32_t>(args)... };
+        for (uint32_t i = 0; i < argc; i++) words_[count_++] = values[i];
+        return *this;
+    }
+
+    uint32_t words_[CapacityWords];
+    uint32_t count_ = 0;
+};
+
+// Sprite batches: many instances of one keyed PNG/JPEG (typically a sprite sheet) drawn with a
+// single `wasm96_graphics_sprite_batch` call, so the image is resolved once per flush instead of
+// once per sprite.
+//
+// Sprites are drawn on `flush()`, not when they are added; a full batch flushes itself.
+//   static wasm96::SpriteBatch<> batch("sheet"_k);
+//   batch.cell(x, y, 16, 16, frame, 0).draw(px, py, 0, 16, 16, 16, wasm96::SpriteFlipX);
+//   batch.flush();
+template <uint32_t Capacity = 256>
+class SpriteBatch {
+public:
+    static_assert(Capacity > 0, "SpriteBatch must hold at least one sprite");
+
+    explicit SpriteBatch(uint64_t imageKey) : image_(imageKey) {}
+    explicit SpriteBatch(const char* imageKey) : image_(wasm96_hash_key(imageKey)) {}
+
+    // Switch images; sprites queued for the previous one are flushed first.
+    void setImage(uint64_t imageKey) {
+        if (imageKey != image_) flush();
+        image_ = imageKey;
+    }
+
+    SpriteBatch& add(const Sprite& sprite) {
+        if (count_ == Capacity) flush();
+        sprites_[count_++] = sprite;
+        return *this;
+    }
+
+    // Source sub-rect drawn unscaled at (x, y).
+    SpriteBatch& draw(int32_t x, int32_t y, uint32_t srcX, uint32_t srcY, uint32_t srcW, uint32_t srcH, uint32_t flags = 0, uint32_t tint = TintNone) {
+        return drawScaled(x, y, srcW, srcH, srcX, srcY, srcW, srcH, flags, tint);
+    }
+
+    // Source sub-rect scaled (nearest-neighbor) into a `w`x`h` destination.
+    SpriteBatch& drawScaled(int32_t x, int32_t y, uint32_t w, uint32_t h, uint32_t srcX, uint32_t srcY, uint32_t srcW, uint32_t srcH, uint32_t flags = 0, uint32_t tint = TintNone) {
+        Sprite s;
+        s.x = x;
+        s.y = y;
+        s.w = w;
+        s.h = h;
+        s.src_x = srcX;
+        s.src_y = srcY;
+        s.src_w = srcW;
+        s.src_h = srcH;
+        s.flags = flags;
+        s.tint = tint;
+        return add(s);
+    }
+
+    // Cell (`col`, `row`) of a sheet laid out in `cellW`x`cellH` cells.
+    SpriteBatch& cell(int32_t x, int32_t y, uint32_t cellW, uint32_t cellH, uint32_t col, uint32_t row, uint32_t flags = 0, uint32_t tint = TintNone) {
+        return draw(x, y, col * cellW, row * cellH, cellW, cellH, flags, tint);
+    }
+
+    // Draw all queued sprites and empty the batch. Returns the number drawn.
+    uint32_t flush() {
+        uint32_t drawn = 0;
+        if (count_ != 0) drawn = Graphics::spriteBatch(image_, sprites_, count_);
+        count_ = 0;
+        return drawn;
+    }
+
+    void clear() { count_ = 0; }
+    uint32_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+private:
+    uint64_t image_;
+    Sprite sprites_[Capacity];
+    uint32_t count_ = 0;
+};
+
+// Text batches: many strings in one registered font drawn with a single
+// `wasm96_graphics_text_batch` call. The host keeps laid-out runs, so strings that are the same
+// as last frame skip layout entirely.
+//
+// Only the pointers are queued: each string must stay alive until `flush()`. A full batch
+// flushes itself.
+//   static wasm96::TextBatch<> hud("hud"_k);
+//   hud.add(4, 4, "SCORE").add(4, 20, scoreBuf, 0xFFFFD700u);
+//   hud.flush();
+template <uint32_t Capacity = 32>
+class TextBatch {
+public:
+    static_assert(Capacity > 0, "TextBatch must hold at least one string");
+
+    explicit TextBatch(uint64_t fontKey) : font_(fontKey) {}
+    explicit TextBatch(const char* fontKey) : font_(wasm96_hash_key(fontKey)) {}
+
+    // Switch fonts; strings queued for the previous one are flushed first.
+    void setFont(uint64_t fontKey) {
+        if (fontKey != font_) flush();
+        font_ = fontKey;
+    }
+
+    TextBatch& add(const TextItem& item) {
+        if (count_ == Capacity) flush();
+        items_[count_++] = item;
+        return *this;
+    }
+
+    // NUL-terminated `text` at (x, y); `color` is 0xAARRGGBB (`TextColorCurrent` = draw color).
+    TextBatch& add(int32_t x, int32_t y, const char* text, uint32_t color = TextColorCurrent, uint32_t px = 0) {
+        TextItem item;
+        item.x = x;
+        item.y = y;
+        item.text = text;
+        item.text_len = wasm96_strlen_(text);
+        item.color = color;
+        item.px = px;
+        return add(item);
+    }
+
+    // Draw all queued strings and empty the batch. Returns the number drawn.
+    uint32_t flush() {
+        uint32_t drawn = 0;
+        if (count_ != 0) drawn = Graphics::textBatch(font_, items_, count_);
+        count_ = 0;
+        return drawn;
+    }
+
+    void clear() { count_ = 0; }
+    uint32_t size() const { return count_; }
+    bool empty() const { return count_ == 0; }
+
+private:
+    uint64_t font_;
+    TextItem items_[Capacity];
+    uint32_t count_ = 0;
+};
+
+// Tilemap layer: a grid of `uint16_t` tiles kept on the host and drawn from cached chunks of
+// 16x16 tiles. Only chunks whose tiles change are re-rendered, so a board or level costs one
+// `draw` call per frame instead of one call per cell.
+//
+// Tile 0 is empty; tile n is cell n-1 of the tileset (a keyed image, cells counted row-major).
+//   static wasm96::Tilemap board("board"_k);
+//   board.create("tiles"_k, 16, 16, 10, 20);
+//   board.setTile(x, y, 3);
+//   board.draw(-kBoardX, -kBoardY);   // map origin at (kBoardX, kBoardY)
+class Tilemap {
+public:
+    constexpr explicit Tilemap(uint64_t key) : key_(key) {}
+    explicit Tilemap(const char* key) : key_(wasm96_hash_key(key)) {}
+
+    bool create(uint64_t tilesetKey, uint32_t tileW, uint32_t tileH, uint32_t mapW, uint32_t mapH) { return wasm96_tilemap_create(key_, tilesetKey, tileW, tileH, mapW, mapH) != 0; }
+    // Copy a `w*h` block of tiles (row-major). Returns the number of tiles that changed.
+    uint32_t setTiles(uint32_t x, uint32_t y, uint32_t w, uint32_t h, const uint16_t* tiles) { return wasm96_tilemap_set_tiles(key_, x, y, w, h, tiles); }
+    void setTile(uint32_t x, uint32_t y, uint16_t tile) { wasm96_tilemap_set_tile(key_, x, y, tile); }
+    // Map pixel (scrollX, scrollY) lands on screen (0, 0).
+    void draw(int32_t scrollX, int32_t scrollY) const { wasm96_tilemap_draw(key_, scrollX, scrollY); }
+    void destroy() { wasm96_tilemap_destroy(key_); }
+
+    uint64_t key() const { return key_; }
+
+private:
+    uint64_t key_;
+};
+
+// Records a retained draw list for as long as it is alive: every primitive issued meanwhile is
+// captured under `key` (with its color) instead of drawn. Replay it each frame with one
+// `Graphics::listDraw(key, dx, dy)` call. Bitmap-font text is captured; TTF/OTF text, images
+// and sprites are not.
+//   void setup() { wasm96::ScopedList frame("hud/frame"_k); drawHudFrame(); }
+//   void draw()  { wasm96::Graphics::listDraw("hud/frame"_k, 0, 0); }
+class ScopedList {
+public:
+    explicit ScopedList(uint64_t key) { wasm96_graphics_list_begin(key); }
+    explicit ScopedList(const char* key) { wasm96_graphics_list_begin(wasm96_hash_key(key)); }
+    ~ScopedList() { end(); }
+
+    ScopedList(const ScopedList&) = delete;
+    ScopedList& operator=(const ScopedList&) = delete;
+
+    // Stop recording early. Returns the number of primitives captured (0 once ended).
+    uint32_t end() {
+        if (!open_) return 0;
+        open_ = false;
+        return wasm96_graphics_list_end();
+    }
+
+private:
+    bool open_ = true;
+};
+
+// Async asset kinds; each matches a synchronous register call with the same key.
+enum class AssetKind : uint32_t { Png = 0, Jpeg = 1, Svg = 2, Gif = 3, FontTtf = 4, MeshObj = 5 };
+enum class AssetStatus : uint32_t { None = 0, Pending = 1, Ready = 2, Failed = 3 };
+
+// Async asset loading for loading screens: assets are decoded on host worker threads while the
+// guest keeps drawing frames. Finished assets are published at the start of a frame (or during
+// `poll`) and are then used with the normal keyed calls.
+//
+// The host copies the bytes at `load` time, so `data` may be temporary. Meshes are uploaded on
+// the main thread once decoded and report `Failed` if no GL context exists by then.
+//   static wasm96::AssetLoader<> loader;
+//   void setup() { loader.png("bg"_k, kBgPng, sizeof kBgPng); loader.fontTtf("ui"_k, kUiTtf, sizeof kUiTtf); }
+//   void draw() {
+//       if (!loader.poll()) { drawProgressBar(loader.progress()); return; }
+//       ...
+//   }
+template <uint32_t Capacity = 64>
+class AssetLoader {
+public:
+    // Queue an asset. Returns false if the host rejected it or the loader is full.
+    bool load(AssetKind kind, uint64_t key, const uint8_t* data, uint32_t len) {
+        if (count_ >= Capacity || wasm96_asset_load(static_cast<uint32_t>(kind), key, data, len) == 0) return false;
+        keys_[count_++] = key;
+        return true;
+    }
+    bool png(uint64_t key, const uint8_t* data, uint32_t len) { return load(AssetKind::Png, key, data, len); }
+    bool jpeg(uint64_t key, const uint8_t* data, uint32_t len) { return load(AssetKind::Jpeg, key, data, len); }
+    bool svg(uint64_t key, const uint8_t* data, uint32_t len) { return load(AssetKind::Svg, key, data, len); }
+    bool gif(uint64_t key, const uint8_t* data, uint32_t len) { return load(AssetKind::Gif, key, data, len); }
+    bool fontTtf(uint64_t key, const uint8_t* data, uint32_t len) { return load(AssetKind::FontTtf, key, data, len); }
+    bool meshObj(uint64_t key, const uint8_t* data, uint32_t len) { return load(AssetKind::MeshObj, key, data, len); }
+
+    // Publish finished assets, blocking for at most `timeoutMs` (0 = just poll; call once per
+    // frame). Returns true once no load is pending.
+    bool poll(uint32_t timeoutMs = 0) { return wasm96_asset_wait_all(timeoutMs) == 0; }
+
+    static AssetStatus status(uint64_t key) { return static_cast<AssetStatus>(wasm96_asset_status(key)); }
+
+    // Loads that are no longer pending (ready or failed).
+    uint32_t finished() const { return countWhere([](AssetStatus s) { return s != AssetStatus::Pending; }); }
+    uint32_t failed() const { return countWhere([](AssetStatus s) { return s == AssetStatus::Failed; }); }
+    uint32_t total() const { return count_; }
+    // Fraction of queued loads that have finished, in [0, 1] (1 when nothing was queued).
+    float progress() const { return count_ == 0 ? 1.0f : (float)finished() / (float)count_; }
+
+private:
+    template <typename Pred>
+    uint32_t countWhere(Pred pred) const {
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < count_; i++) n += pred(status(keys_[i])) ? 1 : 0;
+        return n;
+    }
+
+    uint64_t keys_[Capacity] = {};
+    uint32_t count_ = 0;
 };
 
 class Input {
 public:
+    // Joypad ports snapshotted by the host each frame.
+    static constexpr uint32_t kMaxPorts = 4;
+
+    // One port's buttons for the current frame: three host calls instead of one per button.
+    // The host polls the frontend once before the guest's `update`, so a Pad read at the top of
+    // `update` agrees with every other input query made during the frame.
+    //   auto pad = wasm96::Input::pad(0);
+    //   if (pad.wasPressed(WASM96_BUTTON_START)) paused = !paused;
+    struct Pad {
+        uint32_t held = 0;     // bit n: button n is down
+        uint32_t pressed = 0;  // went down since last frame
+        uint32_t released = 0; // went up since last frame
+
+        static constexpr uint32_t mask(wasm96_button_t btn) { return 1u << static_cast<uint32_t>(btn); }
+        bool isDown(wasm96_button_t btn) const { return (held & mask(btn)) != 0; }
+        bool wasPressed(wasm96_button_t btn) const { return (pressed & mask(btn)) != 0; }
+        bool wasReleased(wasm96_button_t btn) const { return (released & mask(btn)) != 0; }
+    };
+
+    static Pad pad(uint32_t port) {
+        Pad p;
+        p.held = wasm96_input_get_buttons(port);
+        p.pressed = wasm96_input_get_pressed(port);
+        p.released = wasm96_input_get_released(port);
+        return p;
+    }
+
     static bool isButtonDown(uint32_t port, wasm96_button_t btn) { return wasm96_input_is_button_down(port, static_cast<uint32_t>(btn)) != 0; }
     static bool isKeyDown(uint32_t key) { return wasm96_input_is_key_down(key) != 0; }
     static int32_t getMouseX() { return wasm96_input_get_mouse_x(); }
@@ -301,16 +989,151 @@ class Audio {
 public:
     static uint32_t init(uint32_t sample_rate) { return wasm96_audio_init(sample_rate); }
     static void pushSamples(const int16_t* samples, uint32_t len) { wasm96_audio_push_samples(samples, len); }
+    // Stereo frames pushed but not yet played; top up to a target (overflowing pushes are dropped).
+    static uint32_t queuedFrames() { return wasm96_audio_queued_frames(); }
     static void playWav(const uint8_t* data, uint32_t len) { wasm96_audio_play_wav(data, len); }
     static void playQoa(const uint8_t* data, uint32_t len) { wasm96_audio_play_qoa(data, len); }
     static void playXm(const uint8_t* data, uint32_t len) { wasm96_audio_play_xm(data, len); }
 };
 
+enum class AudioFormat : uint32_t { Wav = 0, Qoa = 1, Xm = 2 };
+
+// A host-mixed voice. Voices are resampled to the output rate, mixed in floating point and clipped
+// once; replaying the same asset bytes reuses the host's cached decode. A default (id 0) voice is
+// inert, and controls on a finished voice are ignored.
+//   wasm96::Voice shot = wasm96::Voice::play(wasm96::AudioFormat::Wav, kShotWav, sizeof kShotWav);
+//   shot.setPan(-16384);
+class Voice {
+public:
+    static constexpr uint32_t VolumeUnity = 256;
+
+    Voice() = default;
+    explicit Voice(uint32_t id) : id_(id) {}
+
+    static Voice play(AudioFormat format, const uint8_t* data, uint32_t len, bool loop = false) {
+        return Voice(wasm96_audio_voice_play(static_cast<uint32_t>(format), data, len, loop ? 1u : 0u));
+    }
+
+    uint32_t id() const { return id_; }
+    explicit operator bool() const { return id_ != 0; }
+
+    // Q8.8 volume (VolumeUnity = 1.0).
+    void setVolume(uint32_t volume_q8_8) const { wasm96_audio_voice_set_volume(id_, volume_q8_8); }
+    // -32768 = left, 0 = center, 32767 = right.
+    void setPan(int32_t pan) const { wasm96_audio_voice_set_pan(id_, pan); }
+    void setLoop(bool loop) const { wasm96_audio_voice_set_loop(id_, loop ? 1u : 0u); }
+    void stop() const { wasm96_audio_voice_stop(id_); }
+    bool isPlaying() const { return wasm96_audio_voice_is_playing(id_) != 0; }
+
+private:
+    uint32_t id_ = 0;
+};
+
+// A non-owning view of bytes (freestanding stand-in for std::span<uint8_t>).
+struct ByteSpan {
+    uint8_t* data = nullptr;
+    uint32_t size = 0;
+
+    constexpr ByteSpan() = default;
+    constexpr ByteSpan(uint8_t* d, uint32_t n) : data(d), size(n) {}
+    template <uint32_t N>
+    constexpr ByteSpan(uint8_t (&array)[N]) : data(array), size(N) {}
+
+    bool empty() const { return size == 0; }
+};
+
+// Bump allocator over caller-owned memory, for guests without malloc. Allocations live until
+// `reset()`; a request that does not fit returns an empty span and allocates nothing.
+//   static uint8_t scratch[4096];
+//   wasm96::Arena arena(scratch);
+class Arena {
+public:
+    Arena(uint8_t* base, uint32_t capacity) : base_(base), capacity_(capacity) {}
+    template <uint32_t N>
+    explicit Arena(uint8_t (&array)[N]) : base_(array), capacity_(N) {}
+
+    ByteSpan alloc(uint32_t n) {
+        if (n > capacity_ - used_) return ByteSpan();
+        ByteSpan span(base_ + used_, n);
+        used_ += n;
+        return span;
+    }
+    void reset() { used_ = 0; }
+    uint32_t used() const { return used_; }
+    uint32_t remaining() const { return capacity_ - used_; }
+
+private:
+    uint8_t* base_;
+    uint32_t capacity_;
+    uint32_t used_ = 0;
+};
+
 class Storage {
 public:
+    // Returned by `size`/`load` when no value is stored under the key.
+    static constexpr uint32_t kNotFound = 0xFFFFFFFFu;
+
     static void save(const char* key, const uint8_t* data, uint32_t len) { wasm96_storage_save(wasm96_hash_key(key), data, len); }
-    // load would need allocation, similar to Rust
+    static void save(uint64_t key, const uint8_t* data, uint32_t len) { wasm96_storage_save(key, data, len); }
+
+    // Overwrite `len` bytes at byte `offset` of the value (creating or zero-extending it). Only
+    // the changed range is copied and persisted; prefer this to re-saving a large blob.
+    static void write(uint64_t key, uint32_t offset, const uint8_t* data, uint32_t len) { wasm96_storage_write(key, offset, data, len); }
+    static void write(const char* key, uint32_t offset, const uint8_t* data, uint32_t len) { write(wasm96_hash_key(key), offset, data, len); }
+
+    // Length of the stored value, or kNotFound.
+    static uint32_t size(uint64_t key) { return wasm96_storage_size(key); }
+    static uint32_t size(const char* key) { return wasm96_storage_size(wasm96_hash_key(key)); }
+
+    // Copy the value (from byte `offset`) straight into `dst`; no guest allocation. Returns the
+    // bytes copied, or kNotFound.
+    static uint32_t load(uint64_t key, ByteSpan dst, uint32_t offset = 0) {
+        return wasm96_storage_read(key, dst.data, dst.size, offset);
+    }
+    static uint32_t load(const char* key, ByteSpan dst, uint32_t offset = 0) {
+        return load(wasm96_hash_key(key), dst, offset);
+    }
+
+    // Allocate exactly the value's size from `arena` and load into it. Returns an empty span if
+    // the key is missing or the value does not fit (the arena is left unchanged).
+    static ByteSpan load(uint64_t key, Arena& arena) {
+        uint32_t n = size(key);
+        if (n == kNotFound) return ByteSpan();
+        ByteSpan dst = arena.alloc(n);
+        if (dst.size != n) return ByteSpan();
+        dst.size = load(key, dst);
+        return dst;
+    }
+    static ByteSpan load(const char* key, Arena& arena) { return load(wasm96_hash_key(key), arena); }
+};
+
+// Host profile of the last finished frame (`System::stats`); times in nanoseconds.
+enum class Phase : uint32_t { Input = 0, Assets = 1, Update = 2, Draw = 3, Present = 4, Audio = 5 };
+
+struct FrameStats {
+    uint32_t version;
+    uint32_t entryCount; // ImportStats entries that follow in a report
+    uint64_t frameIndex;
+    uint64_t frameNs;
+    uint64_t phaseNs[6];
+    uint64_t hostNs;
+    uint32_t hostCalls;
+    uint32_t lockCount;
+    uint64_t lockWaitNs;
+    uint64_t bytesIn;  // guest -> host copies
+    uint64_t bytesOut; // host -> guest copies
+
+    uint64_t phase(Phase p) const { return phaseNs[static_cast<uint32_t>(p)]; }
 };
+static_assert(sizeof(FrameStats) == 112, "FrameStats must match the host report layout");
+
+struct ImportStats {
+    char name[32]; // without the `wasm96_` prefix, zero-padded
+    uint32_t calls;
+    uint32_t reserved;
+    uint64_t ns;
+};
+static_assert(sizeof(ImportStats) == 48, "ImportStats must match the host report layout");
 
 class System {
 public:
@@ -319,6 +1142,16 @@ public:
         wasm96_system_log((const uint8_t*)message, len);
     }
     static uint64_t millis() { return wasm96_system_millis(); }
+
+    // Last frame's totals. The first call turns host profiling on (numbers start next frame).
+    static FrameStats stats() {
+        FrameStats s{};
+        wasm96_system_stats(reinterpret_cast<uint8_t*>(&s), sizeof s);
+        return s;
+    }
+
+    // Fill a raw report (FrameStats + entryCount ImportStats, slowest first); returns the full size.
+    static uint32_t stats(uint8_t* report, uint32_t len) { return wasm96_system_stats(report, len); }
 };
 
 } // namespace wasm96
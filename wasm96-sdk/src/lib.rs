@@ -123,6 +123,265 @@ pub struct TextSize {
     pub height: u32,
 }
 
+/// A screen rectangle (see [`graphics::damage`]).
+#[derive(Copy, Clone, Debug, Default, Eq, PartialEq)]
+pub struct Rect {
+    pub x: u32,
+    pub y: u32,
+    pub w: u32,
+    pub h: u32,
+}
+
+impl Rect {
+    pub fn is_empty(&self) -> bool {
+        self.w == 0 || self.h == 0
+    }
+}
+
+/// One instance for [`graphics::sprite_batch`] (layout fixed by the ABI: 10 x 32-bit words).
+///
+/// - `w`/`h` of `0` draw at the source size; other sizes scale (nearest-neighbor).
+/// - `src_w`/`src_h` of `0` select the whole image; otherwise a sub-rect (sprite sheets).
+/// - `tint` is `0xAARRGGBB`, multiplied into every pixel ([`Sprite::TINT_NONE`] = unchanged).
+#[repr(C)]
+#[derive(Copy, Clone, Debug, Eq, PartialEq)]
+pub struct Sprite {
+    pub x: i32,
+    pub y: i32,
+    pub w: u32,
+    pub h: u32,
+    pub src_x: u32,
+    pub src_y: u32,
+    pub src_w: u32,
+    pub src_h: u32,
+    pub flags: u32,
+    pub tint: u32,
+}
+
+impl Sprite {
+    pub const FLIP_X: u32 = 1 << 0;
+    pub const FLIP_Y: u32 = 1 << 1;
+    pub const TINT_NONE: u32 = 0xFFFF_FFFF;
+
+    /// The source sub-rect `(src_x, src_y, src_w, src_h)` drawn unscaled at `(x, y)`.
+    pub const fn new(x: i32, y: i32, src_x: u32, src_y: u32, src_w: u32, src_h: u32) -> Self {
+        Self {
+            x,
+            y,
+            w: src_w,
+            h: src_h,
+            src_x,
+            src_y,
+            src_w,
+            src_h,
+            flags: 0,
+            tint: Self::TINT_NONE,
+        }
+    }
+
+    /// Cell `(col, row)` of a sheet laid out in `cell_w`x`cell_h` cells, drawn unscaled.
+    pub const fn cell(x: i32, y: i32, cell_w: u32, cell_h: u32, col: u32, row: u32) -> Self {
+        Self::new(x, y, col * cell_w, row * cell_h, cell_w, cell_h)
+    }
+
+    /// Scale into a `w`x`h` destination.
+    pub const fn scaled(mut self, w: u32, h: u32) -> Self {
+        self.w = w;
+        self.h = h;
+        self
+    }
+
+    /// Set the flip flags ([`Sprite::FLIP_X`], [`Sprite::FLIP_Y`]).
+    pub const fn flipped(mut self, flags: u32) -> Self {
+        self.flags = flags;
+        self
+    }
+
+    /// Multiply every pixel by `0xAARRGGBB`.
+    pub const fn tinted(mut self, argb: u32) -> Self {
+        self.tint = argb;
+        self
+    }
+}
+
+/// One string for [`graphics::text_batch`] (layout fixed by the ABI: 6 x 32-bit words).
+///
+/// - `color` is `0xAARRGGBB`, or [`TextItem::COLOR_CURRENT`] for the current draw color.
+/// - `px` is the TTF/OTF size (`0` = default 16); bitmap fonts ignore it.
+///
+/// The item borrows its text, so the string outlives the batch that draws it.
+#[repr(C)]
+#[derive(Copy, Clone, Debug, Eq, PartialEq)]
+pub struct TextItem<'a> {
+    pub x: i32,
+    pub y: i32,
+    text_ptr: u32,
+    text_len: u32,
+    pub color: u32,
+    pub px: u32,
+    _text: core::marker::PhantomData<&'a str>,
+}
+
+impl<'a> TextItem<'a> {
+    pub const COLOR_CURRENT: u32 = 0;
+
+    /// `text` at `(x, y)` in the current draw color, at the default size.
+    pub fn new(x: i32, y: i32, text: &'a str) -> Self {
+        Self {
+            x,
+            y,
+            text_ptr: text.as_ptr() as u32,
+            text_len: text.len() as u32,
+            color: Self::COLOR_CURRENT,
+            px: 0,
+            _text: core::marker::PhantomData,
+        }
+    }
+
+    /// Draw in `0xAARRGGBB` instead of the current draw color.
+    pub const fn colored(mut self, argb: u32) -> Self {
+        self.color = argb;
+        self
+    }
+
+    /// Set the TTF/OTF size in pixels.
+    pub const fn sized(mut self, px: u32) -> Self {
+        self.px = px;
+        self
+    }
+}
+
+/// One instance for [`graphics::mesh_draw_instanced`] (layout fixed by the ABI: 9 x `f32`).
+///
+/// Translation, Euler rotation in radians and scale, the same order as [`graphics::mesh_draw`].
+#[repr(C)]
+#[derive(Copy, Clone, Debug, PartialEq)]
+pub struct Transform {
+    pub position: [f32; 3],
+    pub rotation: [f32; 3],
+    pub scale: [f32; 3],
+}
+
+impl Transform {
+    pub const IDENTITY: Self = Self {
+        position: [0.0; 3],
+        rotation: [0.0; 3],
+        scale: [1.0; 3],
+    };
+
+    pub const fn new(pos: (f32, f32, f32), rot: (f32, f32, f32), scale: (f32, f32, f32)) -> Self {
+        Self {
+            position: [pos.0, pos.1, pos.2],
+            rotation: [rot.0, rot.1, rot.2],
+            scale: [scale.0, scale.1, scale.2],
+        }
+    }
+
+    /// Unrotated, unscaled, at `(x, y, z)`.
+    pub const fn at(x: f32, y: f32, z: f32) -> Self {
+        Self {
+            position: [x, y, z],
+            ..Self::IDENTITY
+        }
+    }
+}
+
+impl Default for Transform {
+    fn default() -> Self {
+        Self::IDENTITY
+    }
+}
+
+/// Vertex format bits for [`graphics::mesh_create_ex`].
+///
+/// OR one `POSITION_*`, one `UV_*` and one `NORMAL_*` value. Attributes are packed in that order
+/// with no gaps ([`vertex_format::size`] bytes per vertex). `0` is the 32-byte `f32` layout of
+/// [`graphics::mesh_create`].
+pub mod vertex_format {
+    /// `f32` x3 (12 bytes).
+    pub const POSITION_F32: u32 = 0;
+    /// Half-float x3 + one padding half (8 bytes); see [`f32_to_f16`].
+    pub const POSITION_F16: u32 = 1;
+    /// Normalized `i16` x3 (`-32767..=32767` -> `-1.0..=1.0`) + one padding `i16` (8 bytes).
+    pub const POSITION_SNORM16: u32 = 2;
+    /// `f32` x2 (8 bytes).
+    pub const UV_F32: u32 = 0 << 2;
+    /// Normalized `u16` x2 (`0..=65535` -> `0.0..=1.0`, 4 bytes).
+    pub const UV_UNORM16: u32 = 1 << 2;
+    /// No UVs.
+    pub const UV_NONE: u32 = 2 << 2;
+    /// `f32` x3 (12 bytes).
+    pub const NORMAL_F32: u32 = 0 << 4;
+    /// Octahedral-encoded unit normal, normalized `i16` x2 (4 bytes); see [`oct_encode16`].
+    pub const NORMAL_OCT16: u32 = 1 << 4;
+
+    /// Bytes per vertex for a format.
+    pub const fn size(format: u32) -> usize {
+        let pos = if format & 3 == POSITION_F32 { 12 } else { 8 };
+        let uv = match format & (3 << 2) {
+            UV_F32 => 8,
+            UV_UNORM16 => 4,
+            _ => 0,
+        };
+        let normal = if format & (3 << 4) == NORMAL_OCT16 { 4 } else { 12 };
+        pos + uv + normal
+    }
+
+    pub fn pack_snorm16(v: f32) -> i16 {
+        let v = v.clamp(-1.0, 1.0) * 32767.0;
+        (if v >= 0.0 { v + 0.5 } else { v - 0.5 }) as i16
+    }
+
+    pub fn pack_unorm16(v: f32) -> u16 {
+        (v.clamp(0.0, 1.0) * 65535.0 + 0.5) as u16
+    }
+
+    /// Octahedral-encode a unit normal into two snorm16 components.
+    pub fn oct_encode16(n: [f32; 3]) -> [i16; 2] {
+        let l1 = n[0].abs() + n[1].abs() + n[2].abs();
+        let (mut x, mut y) = if l1 > 0.0 {
+            (n[0] / l1, n[1] / l1)
+        } else {
+            (0.0, 0.0)
+        };
+        if n[2] < 0.0 {
+            let sign = |v: f32| if v >= 0.0 { 1.0 } else { -1.0 };
+            (x, y) = ((1.0 - y.abs()) * sign(x), (1.0 - x.abs()) * sign(y));
+        }
+        [pack_snorm16(x), pack_snorm16(y)]
+    }
+
+    /// `f32` to IEEE half. Values too small flush to zero, too large become infinity.
+    pub fn f32_to_f16(f: f32) -> u16 {
+        let u = f.to_bits();
+        let sign = (u >> 16) & 0x8000;
+        let exp = ((u >> 23) & 0xFF) as i32 - 127 + 15;
+        let mant = u & 0x7F_FFFF;
+        if exp <= 0 {
+            return sign as u16;
+        }
+        if exp >= 31 {
+            return (sign | 0x7C00) as u16;
+        }
+        ((sign | ((exp as u32) << 10) | (mant >> 13)) + ((mant >> 12) & 1)) as u16
+    }
+}
+
+/// Index array for [`graphics::mesh_create_ex`].
+#[derive(Copy, Clone, Debug)]
+pub enum MeshIndices<'a> {
+    U16(&'a [u16]),
+    U32(&'a [u32]),
+}
+
+/// Mesh draws this frame (see [`graphics::mesh_stats`]).
+#[derive(Copy, Clone, Debug, Default, Eq, PartialEq)]
+pub struct MeshStats {
+    pub submitted: u32,
+    /// Draws (or instances) outside the camera frustum.
+    pub culled: u32,
+}
+
 /// Low-level raw ABI imports.
 #[allow(non_camel_case_types)]
 pub mod sys {
@@ -146,8 +405,19 @@ pub mod sys {
         pub fn graphics_circle(x: i32, y: i32, r: u32);
         #[link_name = "wasm96_graphics_circle_outline"]
         pub fn graphics_circle_outline(x: i32, y: i32, r: u32);
+        // Clear one rectangle (the framebuffer is otherwise retained between frames).
+        #[link_name = "wasm96_graphics_clear_rect"]
+        pub fn graphics_clear_rect(x: i32, y: i32, w: u32, h: u32, r: u32, g: u32, b: u32);
+        // Pixels drawn since the last present, packed `x << 48 | y << 32 | w << 16 | h`.
+        #[link_name = "wasm96_graphics_damage"]
+        pub fn graphics_damage() -> u64;
+        #[link_name = "wasm96_graphics_submit"]
+        pub fn graphics_submit(ptr: u32, len: u32) -> u32;
         #[link_name = "wasm96_graphics_image"]
         pub fn graphics_image(x: i32, y: i32, w: u32, h: u32, ptr: u32, len: u32);
+        // Present `w*h` XRGB8888 pixels straight from guest memory; `w == 0` unbinds.
+        #[link_name = "wasm96_graphics_bind_framebuffer"]
+        pub fn graphics_bind_framebuffer(ptr: u32, w: u32, h: u32, format: u32) -> u32;
 
         // One-shot (decode + draw at natural size)
         #[link_name = "wasm96_graphics_image_png"]
@@ -178,6 +448,12 @@ pub mod sys {
         pub fn graphics_svg_draw_key(key: u64, x: i32, y: i32, w: u32, h: u32);
         #[link_name = "wasm96_graphics_svg_unregister"]
         pub fn graphics_svg_unregister(key: u64);
+        #[link_name = "wasm96_graphics_svg_prerender"]
+        pub fn graphics_svg_prerender(key: u64, w: u32, h: u32) -> u32;
+        #[link_name = "wasm96_graphics_svg_evict"]
+        pub fn graphics_svg_evict(key: u64);
+        #[link_name = "wasm96_graphics_svg_set_cache_budget"]
+        pub fn graphics_svg_set_cache_budget(bytes: u32);
 
         // GIF
         #[link_name = "wasm96_graphics_gif_register"]
@@ -209,6 +485,43 @@ pub mod sys {
         #[link_name = "wasm96_graphics_jpeg_unregister"]
         pub fn graphics_jpeg_unregister(key: u64);
 
+        // Raw RGBA8888 keyed image (drawable like a keyed PNG, usable as a tileset).
+        #[link_name = "wasm96_graphics_image_register"]
+        pub fn graphics_image_register(key: u64, w: u32, h: u32, ptr: u32, len: u32) -> u32;
+
+        // Sprite batches: `count` `Sprite` records drawn from one keyed PNG/JPEG.
+        #[link_name = "wasm96_graphics_sprite_batch"]
+        pub fn graphics_sprite_batch(image_key: u64, ptr: u32, count: u32) -> u32;
+
+        // Tilemaps (keyed; `u16` tiles, 0 = empty)
+        #[link_name = "wasm96_tilemap_create"]
+        pub fn tilemap_create(
+            key: u64,
+            tileset_key: u64,
+            tile_w: u32,
+            tile_h: u32,
+            map_w: u32,
+            map_h: u32,
+        ) -> u32;
+        #[link_name = "wasm96_tilemap_set_tiles"]
+        pub fn tilemap_set_tiles(key: u64, x: u32, y: u32, w: u32, h: u32, ptr: u32) -> u32;
+        #[link_name = "wasm96_tilemap_set_tile"]
+        pub fn tilemap_set_tile(key: u64, x: u32, y: u32, tile: u32);
+        #[link_name = "wasm96_tilemap_draw"]
+        pub fn tilemap_draw(key: u64, scroll_x: i32, scroll_y: i32);
+        #[link_name = "wasm96_tilemap_destroy"]
+        pub fn tilemap_destroy(key: u64);
+
+        // Retained draw lists (keyed; primitives between begin and end are captured)
+        #[link_name = "wasm96_graphics_list_begin"]
+        pub fn graphics_list_begin(key: u64);
+        #[link_name = "wasm96_graphics_list_end"]
+        pub fn graphics_list_end() -> u32;
+        #[link_name = "wasm96_graphics_list_draw"]
+        pub fn graphics_list_draw(key: u64, dx: i32, dy: i32);
+        #[link_name = "wasm96_graphics_list_destroy"]
+        pub fn graphics_list_destroy(key: u64);
+
         // Fonts + text (keyed by string)
         //
         // The host maintains a map of `u64 font_key -> font resource`.
@@ -243,6 +556,37 @@ pub mod sys {
         #[link_name = "wasm96_graphics_text_measure_key"]
         pub fn graphics_text_measure_key(font_key: u64, text_ptr: u32, text_len: u32) -> u64;
 
+        // Sized variants: `px` is the TTF/OTF size in pixels (0 = default 16).
+        // Bitmap fonts (BDF/Spleen) ignore `px`.
+        #[link_name = "wasm96_graphics_text_key_sized"]
+        pub fn graphics_text_key_sized(
+            x: i32,
+            y: i32,
+            font_key: u64,
+            px: u32,
+            text_ptr: u32,
+            text_len: u32,
+        );
+
+        #[link_name = "wasm96_graphics_text_measure_key_sized"]
+        pub fn graphics_text_measure_key_sized(
+            font_key: u64,
+            px: u32,
+            text_ptr: u32,
+            text_len: u32,
+        ) -> u64;
+
+        #[link_name = "wasm96_graphics_text_batch"]
+        pub fn graphics_text_batch(font_key: u64, ptr: u32, count: u32) -> u32;
+
+        // Async assets (decoded on host worker threads).
+        #[link_name = "wasm96_asset_load"]
+        pub fn asset_load(kind: u32, key: u64, data_ptr: u32, data_len: u32) -> u32;
+        #[link_name = "wasm96_asset_status"]
+        pub fn asset_status(key: u64) -> u32;
+        #[link_name = "wasm96_asset_wait_all"]
+        pub fn asset_wait_all(timeout_ms: u32) -> u32;
+
         #[link_name = "wasm96_graphics_triangle"]
         pub fn graphics_triangle(x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32);
 
@@ -311,6 +655,20 @@ pub mod sys {
         #[link_name = "wasm96_graphics_mesh_create_obj"]
         pub fn graphics_mesh_create_obj(key: u64, ptr: *const u8, len: usize) -> u32;
 
+        #[link_name = "wasm96_graphics_mesh_create_ex"]
+        pub fn graphics_mesh_create_ex(
+            key: u64,
+            format: u32,
+            v_ptr: *const u8,
+            v_len: u32,
+            i_ptr: *const u8,
+            i_len: u32,
+            index_type: u32,
+        ) -> u32;
+
+        #[link_name = "wasm96_graphics_mesh_create_blob"]
+        pub fn graphics_mesh_create_blob(key: u64, ptr: *const u8, len: usize) -> u32;
+
         #[link_name = "wasm96_graphics_mesh_create_stl"]
         pub fn graphics_mesh_create_stl(key: u64, ptr: *const u8, len: usize) -> u32;
 
@@ -331,9 +689,21 @@ pub mod sys {
             sz: f32,
         );
 
+        #[link_name = "wasm96_graphics_mesh_draw_instanced"]
+        pub fn graphics_mesh_draw_instanced(key: u64, transforms: *const f32, count: u32);
+
+        #[link_name = "wasm96_graphics_mesh_stats"]
+        pub fn graphics_mesh_stats() -> u64;
+
         // Input
         #[link_name = "wasm96_input_is_button_down"]
         pub fn input_is_button_down(port: u32, btn: u32) -> u32;
+        #[link_name = "wasm96_input_get_buttons"]
+        pub fn input_get_buttons(port: u32) -> u32;
+        #[link_name = "wasm96_input_get_pressed"]
+        pub fn input_get_pressed(port: u32) -> u32;
+        #[link_name = "wasm96_input_get_released"]
+        pub fn input_get_released(port: u32) -> u32;
         #[link_name = "wasm96_input_is_key_down"]
         pub fn input_is_key_down(key: u32) -> u32;
         #[link_name = "wasm96_input_get_mouse_x"]
@@ -348,6 +718,8 @@ pub mod sys {
         pub fn audio_init(sample_rate: u32) -> u32;
         #[link_name = "wasm96_audio_push_samples"]
         pub fn audio_push_samples(ptr: u32, len: u32);
+        #[link_name = "wasm96_audio_queued_frames"]
+        pub fn audio_queued_frames() -> u32;
 
         #[link_name = "wasm96_audio_play_wav"]
         pub fn audio_play_wav(ptr: u32, len: u32);
@@ -358,6 +730,19 @@ pub mod sys {
         #[link_name = "wasm96_audio_play_xm"]
         pub fn audio_play_xm(ptr: u32, len: u32);
 
+        #[link_name = "wasm96_audio_voice_play"]
+        pub fn audio_voice_play(format: u32, ptr: u32, len: u32, looping: u32) -> u32;
+        #[link_name = "wasm96_audio_voice_set_volume"]
+        pub fn audio_voice_set_volume(id: u32, volume_q8_8: u32);
+        #[link_name = "wasm96_audio_voice_set_pan"]
+        pub fn audio_voice_set_pan(id: u32, pan: i32);
+        #[link_name = "wasm96_audio_voice_set_loop"]
+        pub fn audio_voice_set_loop(id: u32, looping: u32);
+        #[link_name = "wasm96_audio_voice_stop"]
+        pub fn audio_voice_stop(id: u32);
+        #[link_name = "wasm96_audio_voice_is_playing"]
+        pub fn audio_voice_is_playing(id: u32) -> u32;
+
         // Storage
         #[link_name = "wasm96_storage_save"]
         pub fn storage_save(key: u64, data_ptr: u32, data_len: u32);
@@ -365,19 +750,27 @@ pub mod sys {
         pub fn storage_load(key: u64) -> u64;
         #[link_name = "wasm96_storage_free"]
         pub fn storage_free(ptr: u32, len: u32);
+        #[link_name = "wasm96_storage_size"]
+        pub fn storage_size(key: u64) -> u32;
+        #[link_name = "wasm96_storage_read"]
+        pub fn storage_read(key: u64, dst_ptr: u32, dst_cap: u32, offset: u32) -> u32;
+        #[link_name = "wasm96_storage_write"]
+        pub fn storage_write(key: u64, offset: u32, src_ptr: u32, len: u32);
 
         // System
         #[link_name = "wasm96_system_log"]
         pub fn system_log(ptr: u32, len: u32);
         #[link_name = "wasm96_system_millis"]
         pub fn system_millis() -> u64;
+        #[link_name = "wasm96_system_stats"]
+        pub fn system_stats(ptr: u32, len: u32) -> u32;
     }
 }
 
 /// Graphics API.
 pub mod graphics {
     use super::sys;
-    use crate::TextSize;
+    use crate::{Rect, Sprite, TextItem, TextSize};
 
     pub(crate) fn hash_key(key: &str) -> u64 {
         let mut hash: u64 = 0xcbf29ce484222325;
@@ -403,6 +796,26 @@ pub mod graphics {
         unsafe { sys::graphics_background(r as u32, g as u32, b as u32) }
     }
 
+    /// Clear one rectangle with a specific color (RGB), keeping the rest of the previous frame.
+    ///
+    /// The framebuffer is retained between frames, so a guest that only changes part of the
+    /// screen can skip [`background`] and repaint just that part. Frames where nothing is drawn
+    /// are not re-sent to the frontend at all.
+    pub fn clear_rect(x: i32, y: i32, w: u32, h: u32, r: u8, g: u8, b: u8) {
+        unsafe { sys::graphics_clear_rect(x, y, w, h, r as u32, g as u32, b as u32) }
+    }
+
+    /// Bounding box of the pixels drawn so far this frame (empty if nothing changed).
+    pub fn damage() -> Rect {
+        let p = unsafe { sys::graphics_damage() };
+        Rect {
+            x: (p >> 48) as u32 & 0xFFFF,
+            y: (p >> 32) as u32 & 0xFFFF,
+            w: (p >> 16) as u32 & 0xFFFF,
+            h: p as u32 & 0xFFFF,
+        }
+    }
+
     /// Draw a single pixel at (x, y).
     pub fn point(x: i32, y: i32) {
         unsafe { sys::graphics_point(x, y) }
@@ -439,6 +852,27 @@ pub mod graphics {
         unsafe { sys::graphics_image(x, y, w, h, data.as_ptr() as u32, data.len() as u32) }
     }
 
+    /// Present `pixels` (`w * h` words, `0x00RRGGBB`) directly as the screen.
+    ///
+    /// The host reads the slice straight out of guest memory at the end of every frame, so
+    /// per-pixel effects can write into it without any import calls or copies. It must stay alive
+    /// while bound, hence `'static`. While bound, host drawing calls are not visible.
+    ///
+    /// Returns `false` if `pixels` is shorter than `w * h`.
+    pub fn bind_framebuffer(pixels: &'static mut [u32], w: u32, h: u32) -> bool {
+        if (pixels.len() as u64) < w as u64 * h as u64 {
+            return false;
+        }
+        unsafe { sys::graphics_bind_framebuffer(pixels.as_mut_ptr() as u32, w, h, 0) != 0 }
+    }
+
+    /// Go back to presenting the host framebuffer.
+    pub fn unbind_framebuffer() {
+        unsafe {
+            sys::graphics_bind_framebuffer(0, 0, 0, 0);
+        }
+    }
+
     /// Draw an image from raw PNG bytes.
     pub fn image_png(x: i32, y: i32, data: &[u8]) {
         unsafe { sys::graphics_image_png(x, y, data.as_ptr() as u32, data.len() as u32) }
@@ -555,6 +989,41 @@ pub mod graphics {
         unsafe { sys::graphics_mesh_create_obj(k, obj_data.as_ptr(), obj_data.len()) != 0 }
     }
 
+    /// Create a mesh from vertices in a compact [`vertex_format`](crate::vertex_format).
+    ///
+    /// `vertices` holds whole vertices of [`vertex_format::size`](crate::vertex_format::size)
+    /// bytes each. The GPU reads the packed attributes directly (no expansion to `f32`).
+    pub fn mesh_create_ex(
+        key: &str,
+        format: u32,
+        vertices: &[u8],
+        indices: crate::MeshIndices<'_>,
+    ) -> bool {
+        let v_len = (vertices.len() / crate::vertex_format::size(format)) as u32;
+        let (i_ptr, i_len, index_type) = match indices {
+            crate::MeshIndices::U16(i) => (i.as_ptr() as *const u8, i.len() as u32, 1),
+            crate::MeshIndices::U32(i) => (i.as_ptr() as *const u8, i.len() as u32, 0),
+        };
+        unsafe {
+            sys::graphics_mesh_create_ex(
+                hash_key(key),
+                format,
+                vertices.as_ptr(),
+                v_len,
+                i_ptr,
+                i_len,
+                index_type,
+            ) != 0
+        }
+    }
+
+    /// Create a mesh from a pre-baked blob (`just bake-mesh in.obj out.w96m`).
+    ///
+    /// The host uploads the vertex and index arrays as-is, so this skips OBJ/STL parsing at load.
+    pub fn mesh_create_blob(key: &str, blob: &[u8]) -> bool {
+        unsafe { sys::graphics_mesh_create_blob(hash_key(key), blob.as_ptr(), blob.len()) != 0 }
+    }
+
     pub fn mesh_create_stl(key: &str, stl_data: &[u8]) -> bool {
         let k = hash_key(key);
         unsafe { sys::graphics_mesh_create_stl(k, stl_data.as_ptr(), stl_data.len()) != 0 }
@@ -574,6 +1043,28 @@ pub mod graphics {
         }
     }
 
+    /// Draw one copy of a mesh per transform in a single call.
+    ///
+    /// All copies share the current color and the mesh texture.
+    pub fn mesh_draw_instanced(key: &str, transforms: &[crate::Transform]) {
+        unsafe {
+            sys::graphics_mesh_draw_instanced(
+                hash_key(key),
+                transforms.as_ptr() as *const f32,
+                transforms.len() as u32,
+            )
+        }
+    }
+
+    /// Mesh draws submitted and frustum-culled since the start of the frame.
+    pub fn mesh_stats() -> crate::MeshStats {
+        let p = unsafe { sys::graphics_mesh_stats() };
+        crate::MeshStats {
+            submitted: (p >> 32) as u32,
+            culled: p as u32,
+        }
+    }
+
     /// Bind a keyed decoded image (PNG/JPEG) as the texture for a mesh.
     /// Returns true on success.
     ///
@@ -607,6 +1098,25 @@ pub mod graphics {
         unsafe { sys::graphics_svg_unregister(hash_key(key)) }
     }
 
+    /// Render a keyed SVG at `w`x`h` ahead of time.
+    ///
+    /// The host caches renders per (key, w, h), so drawing at a cached size is a plain blit.
+    /// Call this in `setup()` to avoid a rasterization hitch on first draw. Returns `false` if the
+    /// key is unknown or the render is larger than the cache budget.
+    pub fn svg_prerender(key: &str, w: u32, h: u32) -> bool {
+        unsafe { sys::graphics_svg_prerender(hash_key(key), w, h) != 0 }
+    }
+
+    /// Drop cached renders of a keyed SVG (the SVG stays registered).
+    pub fn svg_evict(key: &str) {
+        unsafe { sys::graphics_svg_evict(hash_key(key)) }
+    }
+
+    /// Set the host's byte budget for cached SVG renders (`0` disables caching).
+    pub fn svg_set_cache_budget(bytes: u32) {
+        unsafe { sys::graphics_svg_set_cache_budget(bytes) }
+    }
+
     /// Register a PNG resource (encoded bytes) under a string key.
     /// Returns true on success.
     pub fn png_register(key: &str, png_bytes: &[u8]) -> bool {
@@ -690,6 +1200,69 @@ pub mod graphics {
         unsafe { sys::graphics_jpeg_unregister(hash_key(key)) }
     }
 
+    /// Register `w * h` raw RGBA8888 pixels under a string key.
+    ///
+    /// The image can be drawn like a keyed PNG (`png_draw_key*`), used by [`sprite_batch`], or
+    /// used as a [`Tilemap`] tileset. Returns true on success.
+    pub fn image_register(key: &str, w: u32, h: u32, rgba: &[u8]) -> bool {
+        unsafe {
+            sys::graphics_image_register(
+                hash_key(key),
+                w,
+                h,
+                rgba.as_ptr() as u32,
+                rgba.len() as u32,
+            ) != 0
+        }
+    }
+
+    /// Draw many instances of one registered PNG/JPEG with a single host call.
+    ///
+    /// The image is looked up once for the whole slice, so this is much cheaper than calling
+    /// [`png_draw_key_scaled`] per sprite. Returns the number of sprites drawn (0 if the key is
+    /// not registered).
+    pub fn sprite_batch(image_key: &str, sprites: &[Sprite]) -> u32 {
+        sprite_batch_key(hash_key(image_key), sprites)
+    }
+
+    /// [`sprite_batch`] with a pre-hashed key.
+    pub fn sprite_batch_key(image_key: u64, sprites: &[Sprite]) -> u32 {
+        if sprites.is_empty() {
+            return 0;
+        }
+        unsafe {
+            sys::graphics_sprite_batch(image_key, sprites.as_ptr() as u32, sprites.len() as u32)
+        }
+    }
+
+    /// Start recording the retained draw list `key`: primitives issued until [`list_end`] are
+    /// captured on the host (with their colors) instead of drawn. Bitmap-font text is captured;
+    /// TTF/OTF text, images and sprites are not.
+    pub fn list_begin(key: &str) {
+        unsafe { sys::graphics_list_begin(hash_key(key)) }
+    }
+
+    /// Finish the recording. Returns the number of primitives captured.
+    pub fn list_end() -> u32 {
+        unsafe { sys::graphics_list_end() }
+    }
+
+    /// Record `f`'s primitives as the list `key`. Returns the number captured.
+    pub fn record_list(key: &str, f: impl FnOnce()) -> u32 {
+        list_begin(key);
+        f();
+        list_end()
+    }
+
+    /// Replay the list `key` offset by (`dx`, `dy`) pixels, with one host call.
+    pub fn list_draw(key: &str, dx: i32, dy: i32) {
+        unsafe { sys::graphics_list_draw(hash_key(key), dx, dy) }
+    }
+
+    pub fn list_destroy(key: &str) {
+        unsafe { sys::graphics_list_destroy(hash_key(key)) }
+    }
+
     /// Register a TTF/OTF font under a string key.
     ///
     /// ## What the host does
@@ -826,12 +1399,541 @@ pub mod graphics {
             height: (packed & 0xFFFF_FFFF) as u32,
         }
     }
+
+    /// Draw text using a keyed font at `px` pixels.
+    ///
+    /// [`text_key`] always uses 16px. TTF/OTF glyphs are cached by the host per (font, char, px),
+    /// so stick to a handful of sizes. `px == 0` selects the default; bitmap fonts (BDF/Spleen)
+    /// ignore `px` and draw at their native size.
+    pub fn text_key_sized(x: i32, y: i32, font_key: &str, px: u32, text: &str) {
+        unsafe {
+            sys::graphics_text_key_sized(
+                x,
+                y,
+                hash_key(font_key),
+                px,
+                text.as_ptr() as u32,
+                text.len() as u32,
+            )
+        }
+    }
+
+    /// Measure text using a keyed font at `px` pixels (see [`text_key_sized`]).
+    pub fn text_measure_key_sized(font_key: &str, px: u32, text: &str) -> TextSize {
+        let packed = unsafe {
+            sys::graphics_text_measure_key_sized(
+                hash_key(font_key),
+                px,
+                text.as_ptr() as u32,
+                text.len() as u32,
+            )
+        };
+
+        TextSize {
+            width: (packed >> 32) as u32,
+            height: (packed & 0xFFFF_FFFF) as u32,
+        }
+    }
+
+    /// Draw many strings in one keyed font with a single host call.
+    ///
+    /// The font is looked up once, and the host keeps laid-out runs, so strings that match last
+    /// frame's skip layout. Returns the number of strings drawn (0 if the key is not registered).
+    pub fn text_batch(font_key: &str, items: &[TextItem]) -> u32 {
+        text_batch_key(hash_key(font_key), items)
+    }
+
+    /// [`text_batch`] with a pre-hashed key.
+    pub fn text_batch_key(font_key: u64, items: &[TextItem]) -> u32 {
+        if items.is_empty() {
+            return 0;
+        }
+        unsafe { sys::graphics_text_batch(font_key, items.as_ptr() as u32, items.len() as u32) }
+    }
+
+    /// Batched draw commands.
+    ///
+    /// Records are queued in an inline buffer of `N` 32-bit words and executed by the host with
+    /// a single `wasm96_graphics_submit` call, instead of one import call per primitive.
+    ///
+    /// Commands run on [`CommandList::submit`], not when they are appended, so submit before
+    /// issuing immediate-mode calls (text, images, ...) that must layer on top. A full list
+    /// submits itself automatically.
+    pub struct CommandList<const N: usize = 1024> {
+        words: [u32; N],
+        len: usize,
+    }
+
+    impl<const N: usize> Default for CommandList<N> {
+        fn default() -> Self {
+            Self::new()
+        }
+    }
+
+    impl<const N: usize> CommandList<N> {
+        const SET_COLOR: u32 = 1;
+        const BACKGROUND: u32 = 2;
+        const POINT: u32 = 3;
+        const LINE: u32 = 4;
+        const RECT: u32 = 5;
+        const RECT_OUTLINE: u32 = 6;
+        const CIRCLE: u32 = 7;
+        const CIRCLE_OUTLINE: u32 = 8;
+        const TRIANGLE: u32 = 9;
+        const TRIANGLE_OUTLINE: u32 = 10;
+        const BEZIER_QUADRATIC: u32 = 11;
+        const BEZIER_CUBIC: u32 = 12;
+        const PILL: u32 = 13;
+        const PILL_OUTLINE: u32 = 14;
+        const CLEAR_RECT: u32 = 15;
+
+        /// Create an empty command list.
+        pub const fn new() -> Self {
+            Self {
+                words: [0; N],
+                len: 0,
+            }
+        }
+
+        fn push(&mut self, op: u32, args: &[u32]) -> &mut Self {
+            if self.len + 1 + args.len() > N {
+                self.submit();
+                if 1 + args.len() > N {
+                    return self;
+                }
+            }
+            self.words[self.len] = op | ((args.len() as u32) << 16);
+            self.words[self.len + 1..self.len + 1 + args.len()].copy_from_slice(args);
+            self.len += 1 + args.len();
+            self
+        }
+
+        /// Queue [`set_color`].
+        pub fn set_color(&mut self, r: u8, g: u8, b: u8, a: u8) -> &mut Self {
+            self.push(Self::SET_COLOR, &[r as u32, g as u32, b as u32, a as u32])
+        }
+
+        /// Queue [`background`].
+        pub fn background(&mut self, r: u8, g: u8, b: u8) -> &mut Self {
+            self.push(Self::BACKGROUND, &[r as u32, g as u32, b as u32])
+        }
+
+        /// Queue [`point`].
+        pub fn point(&mut self, x: i32, y: i32) -> &mut Self {
+            self.push(Self::POINT, &[x as u32, y as u32])
+        }
+
+        /// Queue [`line`].
+        pub fn line(&mut self, x1: i32, y1: i32, x2: i32, y2: i32) -> &mut Self {
+            self.push(Self::LINE, &[x1 as u32, y1 as u32, x2 as u32, y2 as u32])
+        }
+
+        /// Queue [`rect`].
+        pub fn rect(&mut self, x: i32, y: i32, w: u32, h: u32) -> &mut Self {
+            self.push(Self::RECT, &[x as u32, y as u32, w, h])
+        }
+
+        /// Queue [`rect_outline`].
+        pub fn rect_outline(&mut self, x: i32, y: i32, w: u32, h: u32) -> &mut Self {
+            self.push(Self::RECT_OUTLINE, &[x as u32, y as u32, w, h])
+        }
+
+        /// Queue [`circle`].
+        pub fn circle(&mut self, x: i32, y: i32, r: u32) -> &mut Self {
+            self.push(Self::CIRCLE, &[x as u32, y as u32, r])
+        }
+
+        /// Queue [`circle_outline`].
+        pub fn circle_outline(&mut self, x: i32, y: i32, r: u32) -> &mut Self {
+            self.push(Self::CIRCLE_OUTLINE, &[x as u32, y as u32, r])
+        }
+
+        /// Queue [`triangle`].
+        pub fn triangle(
+            &mut self,
+            x1: i32,
+            y1: i32,
+            x2: i32,
+            y2: i32,
+            x3: i32,
+            y3: i32,
+        ) -> &mut Self {
+            self.push(
+                Self::TRIANGLE,
+                &[
+                    x1 as u32, y1 as u32, x2 as u32, y2 as u32, x3 as u32, y3 as u32,
+                ],
+            )
+        }
+
+        /// Queue [`triangle_outline`].
+        pub fn triangle_outline(
+            &mut self,
+            x1: i32,
+            y1: i32,
+            x2: i32,
+            y2: i32,
+            x3: i32,
+            y3: i32,
+        ) -> &mut Self {
+            self.push(
+                Self::TRIANGLE_OUTLINE,
+                &[
+                    x1 as u32, y1 as u32, x2 as u32, y2 as u32, x3 as u32, y3 as u32,
+                ],
+            )
+        }
+
+        /// Queue [`bezier_quadratic`].
+        #[allow(clippy::too_many_arguments)]
+        pub fn bezier_quadratic(
+            &mut self,
+            x1: i32,
+            y1: i32,
+            cx: i32,
+            cy: i32,
+            x2: i32,
+            y2: i32,
+            segments: u32,
+        ) -> &mut Self {
+            self.push(
+                Self::BEZIER_QUADRATIC,
+                &[
+                    x1 as u32, y1 as u32, cx as u32, cy as u32, x2 as u32, y2 as u32, segments,
+                ],
+            )
+        }
+
+        /// Queue [`bezier_cubic`].
+        #[allow(clippy::too_many_arguments)]
+        pub fn bezier_cubic(
+            &mut self,
+            x1: i32,
+            y1: i32,
+            cx1: i32,
+            cy1: i32,
+            cx2: i32,
+            cy2: i32,
+            x2: i32,
+            y2: i32,
+            segments: u32,
+        ) -> &mut Self {
+            self.push(
+                Self::BEZIER_CUBIC,
+                &[
+                    x1 as u32, y1 as u32, cx1 as u32, cy1 as u32, cx2 as u32, cy2 as u32,
+                    x2 as u32, y2 as u32, segments,
+                ],
+            )
+        }
+
+        /// Queue [`pill`].
+        pub fn pill(&mut self, x: i32, y: i32, w: u32, h: u32) -> &mut Self {
+            self.push(Self::PILL, &[x as u32, y as u32, w, h])
+        }
+
+        /// Queue [`pill_outline`].
+        pub fn pill_outline(&mut self, x: i32, y: i32, w: u32, h: u32) -> &mut Self {
+            self.push(Self::PILL_OUTLINE, &[x as u32, y as u32, w, h])
+        }
+
+        /// Queue [`clear_rect`].
+        pub fn clear_rect(
+            &mut self,
+            x: i32,
+            y: i32,
+            w: u32,
+            h: u32,
+            r: u8,
+            g: u8,
+            b: u8,
+        ) -> &mut Self {
+            self.push(
+                Self::CLEAR_RECT,
+                &[x as u32, y as u32, w, h, r as u32, g as u32, b as u32],
+            )
+        }
+
+        /// Execute all queued commands and empty the list.
+        /// Returns the number of records the host executed.
+        pub fn submit(&mut self) -> u32 {
+            let executed = if self.len == 0 {
+                0
+            } else {
+                unsafe { sys::graphics_submit(self.words.as_ptr() as u32, (self.len * 4) as u32) }
+            };
+            self.len = 0;
+            executed
+        }
+
+        /// Discard all queued commands.
+        pub fn clear(&mut self) {
+            self.len = 0;
+        }
+
+        /// Returns true if no commands are queued.
+        pub fn is_empty(&self) -> bool {
+            self.len == 0
+        }
+    }
+
+    /// A tilemap layer: a grid of `u16` tiles kept on the host and drawn from cached chunks of
+    /// 16x16 tiles. Only chunks whose tiles change are re-rendered, so a board or level costs one
+    /// [`Tilemap::draw`] call per frame instead of one call per cell.
+    ///
+    /// Tile `0` is empty; tile `n` is cell `n - 1` of the tileset (a keyed image, cells counted
+    /// row-major).
+    #[derive(Copy, Clone, Debug, Eq, PartialEq)]
+    pub struct Tilemap {
+        key: u64,
+    }
+
+    impl Tilemap {
+        /// Create (or replace) the map `key` using `tile_w` x `tile_h` cells of `tileset_key`.
+        /// Returns `None` if the tileset is not registered or a dimension is zero.
+        pub fn create(
+            key: &str,
+            tileset_key: &str,
+            tile_w: u32,
+            tile_h: u32,
+            map_w: u32,
+            map_h: u32,
+        ) -> Option<Self> {
+            let key = hash_key(key);
+            let ok = unsafe {
+                sys::tilemap_create(key, hash_key(tileset_key), tile_w, tile_h, map_w, map_h)
+            };
+            (ok != 0).then_some(Self { key })
+        }
+
+        /// Refer to an existing map by key.
+        pub fn from_key(key: &str) -> Self {
+            Self { key: hash_key(key) }
+        }
+
+        /// Copy a `w` x `h` block of tiles (row-major). Returns the number of tiles that changed.
+        pub fn set_tiles(&self, x: u32, y: u32, w: u32, h: u32, tiles: &[u16]) -> u32 {
+            if tiles.len() < (w as usize) * (h as usize) {
+                return 0;
+            }
+            unsafe { sys::tilemap_set_tiles(self.key, x, y, w, h, tiles.as_ptr() as u32) }
+        }
+
+        pub fn set_tile(&self, x: u32, y: u32, tile: u16) {
+            unsafe { sys::tilemap_set_tile(self.key, x, y, tile as u32) }
+        }
+
+        /// Draw with map pixel (`scroll_x`, `scroll_y`) at screen (0, 0).
+        pub fn draw(&self, scroll_x: i32, scroll_y: i32) {
+            unsafe { sys::tilemap_draw(self.key, scroll_x, scroll_y) }
+        }
+
+        /// Drop the map and its cached chunks.
+        pub fn destroy(self) {
+            unsafe { sys::tilemap_destroy(self.key) }
+        }
+    }
+
+    /// Sprites queued for one keyed image.
+    ///
+    /// Holds up to `N` [`Sprite`]s inline and draws them with one [`sprite_batch`] call on
+    /// [`SpriteBatch::flush`]. A full batch flushes itself.
+    pub struct SpriteBatch<const N: usize = 256> {
+        image_key: u64,
+        sprites: [Sprite; N],
+        len: usize,
+    }
+
+    impl<const N: usize> SpriteBatch<N> {
+        /// Create an empty batch for the image registered under `image_key`.
+        pub fn new(image_key: &str) -> Self {
+            Self::with_key(hash_key(image_key))
+        }
+
+        /// Create an empty batch for a pre-hashed image key.
+        pub const fn with_key(image_key: u64) -> Self {
+            Self {
+                image_key,
+                sprites: [Sprite::new(0, 0, 0, 0, 0, 0); N],
+                len: 0,
+            }
+        }
+
+        /// Switch images; sprites queued for the previous one are drawn first.
+        pub fn set_image(&mut self, image_key: &str) {
+            let key = hash_key(image_key);
+            if key != self.image_key {
+                self.flush();
+                self.image_key = key;
+            }
+        }
+
+        /// Queue one sprite.
+        pub fn push(&mut self, sprite: Sprite) -> &mut Self {
+            if self.len == N {
+                self.flush();
+            }
+            if N > 0 {
+                self.sprites[self.len] = sprite;
+                self.len += 1;
+            }
+            self
+        }
+
+        /// Draw all queued sprites and empty the batch.
+        /// Returns the number of sprites the host drew.
+        pub fn flush(&mut self) -> u32 {
+            let drawn = sprite_batch_key(self.image_key, &self.sprites[..self.len]);
+            self.len = 0;
+            drawn
+        }
+
+        /// Discard all queued sprites.
+        pub fn clear(&mut self) {
+            self.len = 0;
+        }
+
+        /// Number of queued sprites.
+        pub fn len(&self) -> usize {
+            self.len
+        }
+
+        /// Returns true if no sprites are queued.
+        pub fn is_empty(&self) -> bool {
+            self.len == 0
+        }
+    }
+}
+
+/// Async asset loading.
+///
+/// The host copies the bytes and decodes them on worker threads, so a loading screen can keep
+/// animating. Finished assets are published at the start of a frame (or during [`wait_all`]) and
+/// are then drawn with the normal keyed calls, exactly as if they had been registered
+/// synchronously under the same key.
+///
+/// ```ignore
+/// asset::load(AssetKind::Png, "bg", include_bytes!("bg.png"));
+/// // each frame:
+/// if asset::wait_all(0) > 0 { draw_loading_bar(); return; }
+/// ```
+pub mod asset {
+    use super::graphics::hash_key;
+    use super::sys;
+
+    /// What to decode the bytes as; each matches a synchronous register call.
+    #[repr(u32)]
+    #[derive(Copy, Clone, Debug, Eq, PartialEq)]
+    pub enum AssetKind {
+        /// As `graphics::png_register`.
+        Png = 0,
+        /// As `graphics::jpeg_register`.
+        Jpeg = 1,
+        /// As `graphics::svg_register`.
+        Svg = 2,
+        /// As `graphics::gif_register`.
+        Gif = 3,
+        /// As `graphics::font_register_ttf`.
+        FontTtf = 4,
+        /// As `graphics::mesh_create_obj` (needs a GL context when it is published).
+        MeshObj = 5,
+    }
+
+    #[repr(u32)]
+    #[derive(Copy, Clone, Debug, Eq, PartialEq)]
+    pub enum AssetStatus {
+        /// No async load was requested for the key.
+        None = 0,
+        Pending = 1,
+        Ready = 2,
+        Failed = 3,
+    }
+
+    /// Queue `data` for decoding under `key`. Returns false if the host rejected it.
+    pub fn load(kind: AssetKind, key: &str, data: &[u8]) -> bool {
+        unsafe {
+            sys::asset_load(
+                kind as u32,
+                hash_key(key),
+                data.as_ptr() as u32,
+                data.len() as u32,
+            ) != 0
+        }
+    }
+
+    /// Status of the latest async load of `key`.
+    pub fn status(key: &str) -> AssetStatus {
+        match unsafe { sys::asset_status(hash_key(key)) } {
+            1 => AssetStatus::Pending,
+            2 => AssetStatus::Ready,
+            3 => AssetStatus::Failed,
+            _ => AssetStatus::None,
+        }
+    }
+
+    /// Publish finished loads, blocking for at most `timeout_ms` (0 = just poll; call once per
+    /// frame). Returns how many loads are still pending.
+    pub fn wait_all(timeout_ms: u32) -> u32 {
+        unsafe { sys::asset_wait_all(timeout_ms) }
+    }
 }
 
 /// Input API.
 pub mod input {
     use super::{Button, sys};
 
+    /// Joypad ports snapshotted by the host each frame.
+    pub const MAX_PORTS: u32 = 4;
+
+    /// One port's buttons for the current frame.
+    ///
+    /// The host polls the frontend once before the guest's `update`; reading a `Pad` costs three
+    /// host calls, where testing each button with [`is_button_down`] costs one call per button.
+    ///
+    /// ```ignore
+    /// let pad = input::pad(0);
+    /// if pad.pressed(Button::Start) { paused = !paused; }
+    /// ```
+    #[derive(Copy, Clone, Debug, Default, PartialEq, Eq)]
+    pub struct Pad {
+        /// Bit `n` set while button `n` is down.
+        pub held: u32,
+        /// Buttons that went down since the previous frame.
+        pub pressed: u32,
+        /// Buttons that went up since the previous frame.
+        pub released: u32,
+    }
+
+    impl Pad {
+        /// Mask bit for `btn`.
+        pub const fn mask(btn: Button) -> u32 {
+            1 << btn as u32
+        }
+
+        pub fn down(&self, btn: Button) -> bool {
+            self.held & Self::mask(btn) != 0
+        }
+
+        pub fn pressed(&self, btn: Button) -> bool {
+            self.pressed & Self::mask(btn) != 0
+        }
+
+        pub fn released(&self, btn: Button) -> bool {
+            self.released & Self::mask(btn) != 0
+        }
+    }
+
+    /// Read `port`'s held/pressed/released masks for this frame.
+    pub fn pad(port: u32) -> Pad {
+        unsafe {
+            Pad {
+                held: sys::input_get_buttons(port),
+                pressed: sys::input_get_pressed(port),
+                released: sys::input_get_released(port),
+            }
+        }
+    }
+
     /// Returns true if the specified button is currently held down.
     pub fn is_button_down(port: u32, btn: Button) -> bool {
         unsafe { sys::input_is_button_down(port, btn as u32) != 0 }
@@ -874,6 +1976,15 @@ pub mod audio {
         unsafe { sys::audio_push_samples(samples.as_ptr() as u32, samples.len() as u32) }
     }
 
+    /// Stereo frames pushed with [`push_samples`] that have not been played yet.
+    ///
+    /// The host plays about `sample_rate / 60` frames per video frame and drops pushes that
+    /// would overflow its queue, so synths should top up to a target instead of pushing a fixed
+    /// amount.
+    pub fn queued_frames() -> u32 {
+        unsafe { sys::audio_queued_frames() }
+    }
+
     /// Play a WAV file.
     /// The WAV data is decoded and played as a one-shot audio channel.
     pub fn play_wav(data: &[u8]) {
@@ -892,6 +2003,64 @@ pub mod audio {
     pub fn play_xm(data: &[u8]) {
         unsafe { sys::audio_play_xm(data.as_ptr() as u32, data.len() as u32) }
     }
+
+    /// Encoded audio formats accepted by [`play`].
+    #[repr(u32)]
+    #[derive(Copy, Clone, Debug, Eq, PartialEq)]
+    pub enum AudioFormat {
+        Wav = 0,
+        Qoa = 1,
+        Xm = 2,
+    }
+
+    /// Q8.8 volume for 1.0.
+    pub const VOLUME_UNITY: u32 = 256;
+
+    /// Decode `data` and start a host-mixed voice, returning its handle.
+    ///
+    /// Voices are resampled to the output rate, mixed in floating point and clipped once, and
+    /// replaying identical bytes reuses the host's cached decode, so firing the same sound effect
+    /// often is cheap. Returns `None` if the data could not be decoded.
+    pub fn play(format: AudioFormat, data: &[u8], looping: bool) -> Option<Voice> {
+        let id = unsafe {
+            sys::audio_voice_play(
+                format as u32,
+                data.as_ptr() as u32,
+                data.len() as u32,
+                looping as u32,
+            )
+        };
+        (id != 0).then_some(Voice(id))
+    }
+
+    /// Handle to a voice started with [`play`]. Controls on a finished voice are ignored.
+    #[derive(Copy, Clone, Debug, Eq, PartialEq)]
+    pub struct Voice(pub u32);
+
+    impl Voice {
+        /// Q8.8 volume ([`VOLUME_UNITY`] is 1.0).
+        pub fn set_volume(self, volume_q8_8: u32) {
+            unsafe { sys::audio_voice_set_volume(self.0, volume_q8_8) }
+        }
+
+        /// -32768 = left, 0 = center, 32767 = right.
+        pub fn set_pan(self, pan: i32) {
+            unsafe { sys::audio_voice_set_pan(self.0, pan) }
+        }
+
+        pub fn set_loop(self, looping: bool) {
+            unsafe { sys::audio_voice_set_loop(self.0, looping as u32) }
+        }
+
+        pub fn stop(self) {
+            unsafe { sys::audio_voice_stop(self.0) }
+        }
+
+        /// False once the voice has finished or been stopped.
+        pub fn is_playing(self) -> bool {
+            unsafe { sys::audio_voice_is_playing(self.0) != 0 }
+        }
+    }
 }
 
 /// Storage API.
@@ -909,27 +2078,52 @@ pub mod storage {
         }
     }
 
-    /// Load data from persistent storage.
-    /// Returns `Some(data)` if found, `None` otherwise.
-    pub fn load(key: &str) -> Option<Vec<u8>> {
-        let packed = unsafe { sys::storage_load(super::graphics::hash_key(key)) };
-        if packed == 0 {
-            return None;
-        }
+    /// Returned by the raw imports when no value is stored under a key.
+    pub const NOT_FOUND: u32 = u32::MAX;
 
-        let ptr = (packed >> 32) as u32;
-        let len = packed as u32;
+    /// Length of the value stored under `key`, if any.
+    pub fn size(key: &str) -> Option<u32> {
+        let n = unsafe { sys::storage_size(super::graphics::hash_key(key)) };
+        (n != NOT_FOUND).then_some(n)
+    }
 
-        // Read data from guest memory
-        let mut data = Vec::with_capacity(len as usize);
+    /// Copy `key`'s value, starting at byte `offset`, into `dst`; the host writes straight into
+    /// the slice (no allocation on either side). Returns the bytes copied, or `None` if the key
+    /// is missing.
+    pub fn read(key: &str, dst: &mut [u8], offset: u32) -> Option<usize> {
+        let n = unsafe {
+            sys::storage_read(
+                super::graphics::hash_key(key),
+                dst.as_mut_ptr() as u32,
+                dst.len() as u32,
+                offset,
+            )
+        };
+        (n != NOT_FOUND).then_some(n as usize)
+    }
+
+    /// Overwrite `data.len()` bytes at byte `offset` of `key`'s value, creating or zero-extending
+    /// it. Only the changed range is copied and persisted, so patch large saves with this rather
+    /// than re-saving them.
+    pub fn write(key: &str, offset: u32, data: &[u8]) {
         unsafe {
-            core::ptr::copy_nonoverlapping(ptr as *const u8, data.as_mut_ptr(), len as usize);
-            data.set_len(len as usize);
+            sys::storage_write(
+                super::graphics::hash_key(key),
+                offset,
+                data.as_ptr() as u32,
+                data.len() as u32,
+            )
         }
+    }
 
-        // Free the memory in guest space
-        unsafe { sys::storage_free(ptr, len) };
-
+    /// Load data from persistent storage.
+    /// Returns `Some(data)` if found, `None` otherwise.
+    pub fn load(key: &str) -> Option<Vec<u8>> {
+        let len = size(key)?;
+        let mut data = Vec::new();
+        data.resize(len as usize, 0);
+        let n = read(key, &mut data, 0)?;
+        data.truncate(n);
         Some(data)
     }
 }
@@ -947,12 +2141,126 @@ pub mod system {
     pub fn millis() -> u64 {
         unsafe { sys::system_millis() }
     }
+
+    /// Indices into [`FrameStats::phase_ns`].
+    pub const PHASE_INPUT: usize = 0;
+    pub const PHASE_ASSETS: usize = 1;
+    pub const PHASE_UPDATE: usize = 2;
+    pub const PHASE_DRAW: usize = 3;
+    pub const PHASE_PRESENT: usize = 4;
+    pub const PHASE_AUDIO: usize = 5;
+    pub const PHASE_COUNT: usize = 6;
+
+    /// Size of the report header; each import entry adds [`IMPORT_ENTRY_BYTES`].
+    pub const STATS_HEADER_BYTES: usize = 112;
+    pub const IMPORT_ENTRY_BYTES: usize = 48;
+    const IMPORT_NAME_BYTES: usize = 32;
+
+    fn u32_at(b: &[u8], at: usize) -> u32 {
+        u32::from_le_bytes([b[at], b[at + 1], b[at + 2], b[at + 3]])
+    }
+
+    fn u64_at(b: &[u8], at: usize) -> u64 {
+        u32_at(b, at) as u64 | (u32_at(b, at + 4) as u64) << 32
+    }
+
+    /// Host profile of the last finished frame (all times in nanoseconds).
+    #[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+    pub struct FrameStats {
+        pub frame_index: u64,
+        pub frame_ns: u64,
+        /// Wall time per core phase (`PHASE_*`); guest `update`/`draw` are `PHASE_UPDATE`/`PHASE_DRAW`.
+        pub phase_ns: [u64; PHASE_COUNT],
+        /// Time inside `wasm96_*` imports, and how many were called.
+        pub host_ns: u64,
+        pub host_calls: u32,
+        pub lock_count: u32,
+        pub lock_wait_ns: u64,
+        /// Bytes copied guest -> host and host -> guest.
+        pub bytes_in: u64,
+        pub bytes_out: u64,
+    }
+
+    impl FrameStats {
+        /// Parse the header of a report filled by [`stats_into`].
+        pub fn parse(report: &[u8]) -> Option<Self> {
+            if report.len() < STATS_HEADER_BYTES {
+                return None;
+            }
+            let mut phase_ns = [0u64; PHASE_COUNT];
+            for (i, ns) in phase_ns.iter_mut().enumerate() {
+                *ns = u64_at(report, 24 + i * 8);
+            }
+            let tail = 24 + PHASE_COUNT * 8;
+            Some(Self {
+                frame_index: u64_at(report, 8),
+                frame_ns: u64_at(report, 16),
+                phase_ns,
+                host_ns: u64_at(report, tail),
+                host_calls: u32_at(report, tail + 8),
+                lock_count: u32_at(report, tail + 12),
+                lock_wait_ns: u64_at(report, tail + 16),
+                bytes_in: u64_at(report, tail + 24),
+                bytes_out: u64_at(report, tail + 32),
+            })
+        }
+    }
+
+    /// One host import's calls in the reported frame.
+    #[derive(Clone, Copy, Debug, PartialEq, Eq)]
+    pub struct ImportStats<'a> {
+        /// Import name without the `wasm96_` prefix (e.g. `"graphics_rect"`).
+        pub name: &'a str,
+        pub calls: u32,
+        pub ns: u64,
+    }
+
+    /// Fill `report` with the last frame's profile and return the size the full report needs.
+    ///
+    /// The first call turns host profiling on, so numbers appear from the next frame. Imports are
+    /// listed slowest first, as many as fit.
+    pub fn stats_into(report: &mut [u8]) -> usize {
+        unsafe { sys::system_stats(report.as_mut_ptr() as u32, report.len() as u32) as usize }
+    }
+
+    /// The last frame's totals, without per-import entries.
+    pub fn stats() -> FrameStats {
+        let mut report = [0u8; STATS_HEADER_BYTES];
+        stats_into(&mut report);
+        FrameStats::parse(&report).unwrap_or_default()
+    }
+
+    /// The per-import entries of a report filled by [`stats_into`].
+    pub fn import_stats(report: &[u8]) -> impl Iterator<Item = ImportStats<'_>> {
+        let count = if report.len() >= STATS_HEADER_BYTES {
+            u32_at(report, 4) as usize
+        } else {
+            0
+        };
+        report
+            .get(STATS_HEADER_BYTES..)
+            .unwrap_or(&[])
+            .chunks_exact(IMPORT_ENTRY_BYTES)
+            .take(count)
+            .map(|e| {
+                let name = &e[..IMPORT_NAME_BYTES];
+                let len = name.iter().position(|&b| b == 0).unwrap_or(IMPORT_NAME_BYTES);
+                ImportStats {
+                    name: core::str::from_utf8(&name[..len]).unwrap_or(""),
+                    calls: u32_at(e, IMPORT_NAME_BYTES),
+                    ns: u64_at(e, IMPORT_NAME_BYTES + 8),
+                }
+            })
+    }
 }
 
 /// Convenience prelude for guest apps.
 pub mod prelude {
     pub use crate::Button;
+    pub use crate::asset::{self, AssetKind, AssetStatus};
+    pub use crate::Sprite;
     pub use crate::TextSize;
+    pub use crate::Transform;
     pub use crate::audio;
     pub use crate::graphics;
     pub use crate::input;
@@ -26,6 +26,144 @@ pub const TextSize = struct {
     height: u32,
 };
 
+/// A screen rectangle (see `graphics.damage`).
+pub const Rect = struct {
+    x: u32,
+    y: u32,
+    w: u32,
+    h: u32,
+
+    pub fn isEmpty(self: Rect) bool {
+        return self.w == 0 or self.h == 0;
+    }
+};
+
+/// One instance for `graphics.spriteBatch` (layout fixed by the ABI: 10 x 32-bit words).
+/// `w`/`h` of 0 draw at the source size; `src_w`/`src_h` of 0 select the whole image.
+/// `tint` is 0xAARRGGBB, multiplied into every pixel.
+pub const Sprite = extern struct {
+    x: i32,
+    y: i32,
+    w: u32 = 0,
+    h: u32 = 0,
+    src_x: u32 = 0,
+    src_y: u32 = 0,
+    src_w: u32 = 0,
+    src_h: u32 = 0,
+    flags: u32 = 0,
+    tint: u32 = tint_none,
+
+    pub const flip_x: u32 = 1 << 0;
+    pub const flip_y: u32 = 1 << 1;
+    pub const tint_none: u32 = 0xFFFF_FFFF;
+
+    /// Cell (`col`, `row`) of a sheet laid out in `cell_w`x`cell_h` cells, drawn unscaled.
+    pub fn cell(x: i32, y: i32, cell_w: u32, cell_h: u32, col: u32, row: u32) Sprite {
+        return .{ .x = x, .y = y, .w = cell_w, .h = cell_h, .src_x = col * cell_w, .src_y = row * cell_h, .src_w = cell_w, .src_h = cell_h };
+    }
+};
+
+/// One string for `graphics.textBatch` (layout fixed by the ABI: 6 x 32-bit words on wasm32).
+/// `color` is 0xAARRGGBB, or `color_current` for the current draw color. `px` is the TTF/OTF size
+/// (0 = default 16); bitmap fonts ignore it. The text must stay alive until the batch is drawn.
+pub const TextItem = extern struct {
+    x: i32,
+    y: i32,
+    text: [*]const u8,
+    text_len: u32,
+    color: u32 = color_current,
+    px: u32 = 0,
+
+    pub const color_current: u32 = 0;
+
+    /// `string` at (`x`, `y`) in `color` (0xAARRGGBB or `color_current`).
+    pub fn init(x: i32, y: i32, string: []const u8, color: u32) TextItem {
+        return .{ .x = x, .y = y, .text = string.ptr, .text_len = @intCast(string.len), .color = color };
+    }
+};
+
+/// One instance for `graphics.meshDrawInstanced` (layout fixed by the ABI: 9 x f32).
+/// Translation, Euler rotation in radians and scale, the same order as `graphics.meshDraw`.
+pub const Transform = extern struct {
+    x: f32 = 0.0,
+    y: f32 = 0.0,
+    z: f32 = 0.0,
+    rx: f32 = 0.0,
+    ry: f32 = 0.0,
+    rz: f32 = 0.0,
+    sx: f32 = 1.0,
+    sy: f32 = 1.0,
+    sz: f32 = 1.0,
+};
+
+/// Vertex format bits for `graphics.meshCreateEx`: OR one position_*, one uv_* and one normal_*
+/// value. Attributes are packed in that order with no gaps (`size` bytes per vertex).
+/// 0 is the 32-byte f32 layout of `graphics.meshCreate`.
+pub const VertexFormat = struct {
+    /// f32 x3 (12 bytes).
+    pub const position_f32: u32 = 0;
+    /// f16 x3 + one padding f16 (8 bytes).
+    pub const position_f16: u32 = 1;
+    /// Normalized i16 x3 (-32767..32767 -> -1..1) + one padding i16 (8 bytes).
+    pub const position_snorm16: u32 = 2;
+    /// f32 x2 (8 bytes).
+    pub const uv_f32: u32 = 0 << 2;
+    /// Normalized u16 x2 (0..65535 -> 0..1, 4 bytes).
+    pub const uv_unorm16: u32 = 1 << 2;
+    /// No UVs.
+    pub const uv_none: u32 = 2 << 2;
+    /// f32 x3 (12 bytes).
+    pub const normal_f32: u32 = 0 << 4;
+    /// Octahedral-encoded unit normal, normalized i16 x2 (4 bytes); see `octEncode16`.
+    pub const normal_oct16: u32 = 1 << 4;
+
+    /// Bytes per vertex for a format.
+    pub fn size(format: u32) usize {
+        const pos: usize = if (format & 3 == position_f32) 12 else 8;
+        const uv: usize = switch (format & (3 << 2)) {
+            uv_f32 => 8,
+            uv_unorm16 => 4,
+            else => 0,
+        };
+        const normal: usize = if (format & (3 << 4) == normal_oct16) 4 else 12;
+        return pos + uv + normal;
+    }
+
+    pub fn packSnorm16(v: f32) i16 {
+        return @intFromFloat(@round(std.math.clamp(v, -1.0, 1.0) * 32767.0));
+    }
+
+    pub fn packUnorm16(v: f32) u16 {
+        return @intFromFloat(@round(std.math.clamp(v, 0.0, 1.0) * 65535.0));
+    }
+
+    /// Octahedral-encode a unit normal into two snorm16 components.
+    pub fn octEncode16(nx: f32, ny: f32, nz: f32) [2]i16 {
+        const l1 = @abs(nx) + @abs(ny) + @abs(nz);
+        var x: f32 = if (l1 > 0.0) nx / l1 else 0.0;
+        var y: f32 = if (l1 > 0.0) ny / l1 else 0.0;
+        if (nz < 0.0) {
+            const fx = (1.0 - @abs(y)) * @as(f32, if (x >= 0.0) 1.0 else -1.0);
+            const fy = (1.0 - @abs(x)) * @as(f32, if (y >= 0.0) 1.0 else -1.0);
+            x = fx;
+            y = fy;
+        }
+        return .{ packSnorm16(x), packSnorm16(y) };
+    }
+};
+
+/// Index array for `graphics.meshCreateEx`.
+pub const MeshIndices = union(enum) {
+    u16: []const u16,
+    u32: []const u32,
+};
+
+/// Mesh draws this frame (see `graphics.meshStats`); `culled` were outside the camera frustum.
+pub const MeshStats = struct {
+    submitted: u32,
+    culled: u32,
+};
+
 /// Low-level raw ABI imports.
 pub const sys = struct {
     // Graphics
@@ -38,7 +176,11 @@ pub const sys = struct {
     extern fn wasm96_graphics_rect_outline(x: i32, y: i32, w: u32, h: u32) void;
     extern fn wasm96_graphics_circle(x: i32, y: i32, r: u32) void;
     extern fn wasm96_graphics_circle_outline(x: i32, y: i32, r: u32) void;
+    extern fn wasm96_graphics_clear_rect(x: i32, y: i32, w: u32, h: u32, r: u32, g: u32, b: u32) void;
+    extern fn wasm96_graphics_damage() u64;
+    extern fn wasm96_graphics_submit(ptr: [*]const u32, len: usize) u32;
     extern fn wasm96_graphics_image(x: i32, y: i32, w: u32, h: u32, ptr: [*]const u8, len: usize) void;
+    extern fn wasm96_graphics_bind_framebuffer(ptr: ?[*]const u32, w: u32, h: u32, format: u32) u32;
     extern fn wasm96_graphics_image_png(x: i32, y: i32, ptr: [*]const u8, len: usize) void;
     extern fn wasm96_graphics_image_jpeg(x: i32, y: i32, ptr: [*]const u8, len: usize) void;
     extern fn wasm96_graphics_triangle(x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32) void;
@@ -54,8 +196,12 @@ pub const sys = struct {
     extern fn wasm96_graphics_camera_perspective(fovy: f32, aspect: f32, near: f32, far: f32) void;
     extern fn wasm96_graphics_mesh_create(key: u64, v_ptr: [*]const f32, v_len: usize, i_ptr: [*]const u32, i_len: usize) u32;
     extern fn wasm96_graphics_mesh_create_obj(key: u64, ptr: [*]const u8, len: usize) u32;
+    extern fn wasm96_graphics_mesh_create_ex(key: u64, format: u32, v_ptr: [*]const u8, v_len: u32, i_ptr: [*]const u8, i_len: u32, index_type: u32) u32;
+    extern fn wasm96_graphics_mesh_create_blob(key: u64, ptr: [*]const u8, len: usize) u32;
     extern fn wasm96_graphics_mesh_create_stl(key: u64, ptr: [*]const u8, len: usize) u32;
     extern fn wasm96_graphics_mesh_draw(key: u64, x: f32, y: f32, z: f32, rx: f32, ry: f32, rz: f32, sx: f32, sy: f32, sz: f32) void;
+    extern fn wasm96_graphics_mesh_draw_instanced(key: u64, transforms: [*]const Transform, count: u32) void;
+    extern fn wasm96_graphics_mesh_stats() u64;
     extern fn wasm96_graphics_mesh_set_texture(mesh_key: u64, image_key: u64) u32;
 
     // Materials / textures (OBJ+MTL workflows)
@@ -72,6 +218,9 @@ pub const sys = struct {
     extern fn wasm96_graphics_svg_register(key: u64, data_ptr: [*]const u8, data_len: usize) u32;
     extern fn wasm96_graphics_svg_draw_key(key: u64, x: i32, y: i32, w: u32, h: u32) void;
     extern fn wasm96_graphics_svg_unregister(key: u64) void;
+    extern fn wasm96_graphics_svg_prerender(key: u64, w: u32, h: u32) u32;
+    extern fn wasm96_graphics_svg_evict(key: u64) void;
+    extern fn wasm96_graphics_svg_set_cache_budget(bytes: u32) void;
 
     extern fn wasm96_graphics_gif_register(key: u64, data_ptr: [*]const u8, data_len: usize) u32;
     extern fn wasm96_graphics_gif_draw_key(key: u64, x: i32, y: i32) void;
@@ -88,15 +237,40 @@ pub const sys = struct {
     extern fn wasm96_graphics_jpeg_draw_key_scaled(key: u64, x: i32, y: i32, w: u32, h: u32) void;
     extern fn wasm96_graphics_jpeg_unregister(key: u64) void;
 
+    extern fn wasm96_graphics_image_register(key: u64, w: u32, h: u32, rgba: [*]const u8, len: usize) u32;
+    extern fn wasm96_graphics_sprite_batch(image_key: u64, sprites: [*]const Sprite, count: u32) u32;
+
+    extern fn wasm96_tilemap_create(key: u64, tileset_key: u64, tile_w: u32, tile_h: u32, map_w: u32, map_h: u32) u32;
+    extern fn wasm96_tilemap_set_tiles(key: u64, x: u32, y: u32, w: u32, h: u32, tiles: [*]const u16) u32;
+    extern fn wasm96_tilemap_set_tile(key: u64, x: u32, y: u32, tile: u32) void;
+    extern fn wasm96_tilemap_draw(key: u64, scroll_x: i32, scroll_y: i32) void;
+    extern fn wasm96_tilemap_destroy(key: u64) void;
+
+    extern fn wasm96_graphics_list_begin(key: u64) void;
+    extern fn wasm96_graphics_list_end() u32;
+    extern fn wasm96_graphics_list_draw(key: u64, dx: i32, dy: i32) void;
+    extern fn wasm96_graphics_list_destroy(key: u64) void;
+
     extern fn wasm96_graphics_font_register_ttf(key: u64, data_ptr: [*]const u8, data_len: usize) u32;
     extern fn wasm96_graphics_font_register_bdf(key: u64, data_ptr: [*]const u8, data_len: usize) u32;
     extern fn wasm96_graphics_font_register_spleen(key: u64, size: u32) u32;
     extern fn wasm96_graphics_font_unregister(key: u64) void;
     extern fn wasm96_graphics_text_key(x: i32, y: i32, font_key: u64, text_ptr: [*]const u8, text_len: usize) void;
     extern fn wasm96_graphics_text_measure_key(font_key: u64, text_ptr: [*]const u8, text_len: usize) u64;
+    extern fn wasm96_graphics_text_key_sized(x: i32, y: i32, font_key: u64, px: u32, text_ptr: [*]const u8, text_len: usize) void;
+    extern fn wasm96_graphics_text_measure_key_sized(font_key: u64, px: u32, text_ptr: [*]const u8, text_len: usize) u64;
+    extern fn wasm96_graphics_text_batch(font_key: u64, items: [*]const TextItem, count: u32) u32;
+
+    // Async assets
+    extern fn wasm96_asset_load(kind: u32, key: u64, data_ptr: [*]const u8, data_len: usize) u32;
+    extern fn wasm96_asset_status(key: u64) u32;
+    extern fn wasm96_asset_wait_all(timeout_ms: u32) u32;
 
     // Input
     extern fn wasm96_input_is_button_down(port: u32, btn: u32) u32;
+    extern fn wasm96_input_get_buttons(port: u32) u32;
+    extern fn wasm96_input_get_pressed(port: u32) u32;
+    extern fn wasm96_input_get_released(port: u32) u32;
     extern fn wasm96_input_is_key_down(key: u32) u32;
     extern fn wasm96_input_get_mouse_x() i32;
     extern fn wasm96_input_get_mouse_y() i32;
@@ -105,17 +279,28 @@ pub const sys = struct {
     // Audio
     extern fn wasm96_audio_init(sample_rate: u32) u32;
     extern fn wasm96_audio_push_samples(ptr: [*]const i16, len: usize) void;
+    extern fn wasm96_audio_queued_frames() u32;
     extern fn wasm96_audio_play_wav(ptr: [*]const u8, len: usize) void;
     extern fn wasm96_audio_play_qoa(ptr: [*]const u8, len: usize) void;
     extern fn wasm96_audio_play_xm(ptr: [*]const u8, len: usize) void;
+    extern fn wasm96_audio_voice_play(format: u32, ptr: [*]const u8, len: usize, loop: u32) u32;
+    extern fn wasm96_audio_voice_set_volume(id: u32, volume_q8_8: u32) void;
+    extern fn wasm96_audio_voice_set_pan(id: u32, pan: i32) void;
+    extern fn wasm96_audio_voice_set_loop(id: u32, loop: u32) void;
+    extern fn wasm96_audio_voice_stop(id: u32) void;
+    extern fn wasm96_audio_voice_is_playing(id: u32) u32;
 
     // System
     extern fn wasm96_storage_save(key: u64, data_ptr: [*]const u8, data_len: usize) void;
     extern fn wasm96_storage_load(key: u64) u64;
     extern fn wasm96_storage_free(ptr: [*]const u8, len: usize) void;
+    extern fn wasm96_storage_size(key: u64) u32;
+    extern fn wasm96_storage_read(key: u64, dst_ptr: [*]u8, dst_cap: u32, offset: u32) u32;
+    extern fn wasm96_storage_write(key: u64, offset: u32, src_ptr: [*]const u8, len: u32) void;
 
     extern fn wasm96_system_log(ptr: [*]const u8, len: usize) void;
     extern fn wasm96_system_millis() u64;
+    extern fn wasm96_system_stats(ptr: [*]u8, len: usize) u32;
 };
 
 /// Graphics API.
@@ -144,6 +329,26 @@ pub const graphics = struct {
         sys.wasm96_graphics_background(@as(u32, r), @as(u32, g), @as(u32, b));
     }
 
+    /// Clear one rectangle with a specific color (RGB), keeping the rest of the previous frame.
+    ///
+    /// The framebuffer is retained between frames, so a guest that only changes part of the
+    /// screen can skip `background` and repaint just that part. Frames where nothing is drawn are
+    /// not re-sent to the frontend at all.
+    pub fn clearRect(x: i32, y: i32, w: u32, h: u32, r: u8, g: u8, b: u8) void {
+        sys.wasm96_graphics_clear_rect(x, y, w, h, @as(u32, r), @as(u32, g), @as(u32, b));
+    }
+
+    /// Bounding box of the pixels drawn so far this frame (empty if nothing changed).
+    pub fn damage() Rect {
+        const p = sys.wasm96_graphics_damage();
+        return .{
+            .x = @as(u32, @intCast((p >> 48) & 0xFFFF)),
+            .y = @as(u32, @intCast((p >> 32) & 0xFFFF)),
+            .w = @as(u32, @intCast((p >> 16) & 0xFFFF)),
+            .h = @as(u32, @intCast(p & 0xFFFF)),
+        };
+    }
+
     /// Draw a single pixel at (x, y).
     pub fn point(x: i32, y: i32) void {
         sys.wasm96_graphics_point(x, y);
@@ -180,6 +385,18 @@ pub const graphics = struct {
         sys.wasm96_graphics_image(x, y, w, h, data.ptr, data.len);
     }
 
+    /// Present `pixels` (`w * h` words, 0x00RRGGBB) directly as the screen, read straight from
+    /// guest memory every frame. Must stay alive while bound; host drawing calls are not visible.
+    pub fn bindFramebuffer(pixels: []u32, w: u32, h: u32) bool {
+        if (pixels.len < @as(usize, w) * @as(usize, h)) return false;
+        return sys.wasm96_graphics_bind_framebuffer(pixels.ptr, w, h, 0) != 0;
+    }
+
+    /// Go back to presenting the host framebuffer.
+    pub fn unbindFramebuffer() void {
+        _ = sys.wasm96_graphics_bind_framebuffer(null, 0, 0, 0);
+    }
+
     /// Draw an image from raw PNG bytes.
     pub fn imagePng(x: i32, y: i32, data: []const u8) void {
         sys.wasm96_graphics_image_png(x, y, data.ptr, data.len);
@@ -251,6 +468,22 @@ pub const graphics = struct {
         return sys.wasm96_graphics_mesh_create_obj(hashKey(key), data.ptr, data.len) != 0;
     }
 
+    /// Create a mesh from vertices in a compact `VertexFormat` (whole vertices of
+    /// `VertexFormat.size(format)` bytes). The GPU reads the packed attributes directly.
+    pub fn meshCreateEx(key: []const u8, format: u32, vertices: []const u8, indices: MeshIndices) bool {
+        const v_len: u32 = @intCast(vertices.len / VertexFormat.size(format));
+        return switch (indices) {
+            .u16 => |i| sys.wasm96_graphics_mesh_create_ex(hashKey(key), format, vertices.ptr, v_len, @ptrCast(i.ptr), @intCast(i.len), 1),
+            .u32 => |i| sys.wasm96_graphics_mesh_create_ex(hashKey(key), format, vertices.ptr, v_len, @ptrCast(i.ptr), @intCast(i.len), 0),
+        } != 0;
+    }
+
+    /// Create a mesh from a pre-baked blob (`just bake-mesh in.obj out.w96m`).
+    /// The host uploads it as-is, skipping OBJ/STL parsing. Returns true on success.
+    pub fn meshCreateBlob(key: []const u8, data: []const u8) bool {
+        return sys.wasm96_graphics_mesh_create_blob(hashKey(key), data.ptr, data.len) != 0;
+    }
+
     /// Create a mesh from STL binary data.
     /// Returns true on success.
     pub fn meshCreateStl(key: []const u8, data: []const u8) bool {
@@ -263,6 +496,18 @@ pub const graphics = struct {
         sys.wasm96_graphics_mesh_draw(hashKey(key), x, y, z, rx, ry, rz, sx, sy, sz);
     }
 
+    /// Draw one copy of a mesh per transform in a single call.
+    /// All copies share the current color and the mesh texture.
+    pub fn meshDrawInstanced(key: []const u8, transforms: []const Transform) void {
+        sys.wasm96_graphics_mesh_draw_instanced(hashKey(key), transforms.ptr, @intCast(transforms.len));
+    }
+
+    /// Mesh draws submitted and frustum-culled since the start of the frame.
+    pub fn meshStats() MeshStats {
+        const p = sys.wasm96_graphics_mesh_stats();
+        return .{ .submitted = @truncate(p >> 32), .culled = @truncate(p) };
+    }
+
     /// Bind a keyed decoded image (PNG/JPEG) as the texture for a mesh.
     /// Returns true on success.
     ///
@@ -303,6 +548,21 @@ pub const graphics = struct {
         sys.wasm96_graphics_svg_unregister(hashKey(key));
     }
 
+    /// Render an SVG at `w`x`h` into the host cache (e.g. in `setup()`).
+    pub fn svgPrerender(key: []const u8, w: u32, h: u32) bool {
+        return sys.wasm96_graphics_svg_prerender(hashKey(key), w, h) != 0;
+    }
+
+    /// Drop cached renders of an SVG (it stays registered).
+    pub fn svgEvict(key: []const u8) void {
+        sys.wasm96_graphics_svg_evict(hashKey(key));
+    }
+
+    /// Set the host's byte budget for cached SVG renders (0 disables caching).
+    pub fn svgSetCacheBudget(bytes: u32) void {
+        sys.wasm96_graphics_svg_set_cache_budget(bytes);
+    }
+
     /// Register a GIF resource under a string key.
     pub fn gifRegister(key: []const u8, data: []const u8) bool {
         return sys.wasm96_graphics_gif_register(hashKey(key), data.ptr, data.len) != 0;
@@ -359,6 +619,44 @@ pub const graphics = struct {
         sys.wasm96_graphics_jpeg_unregister(hashKey(key));
     }
 
+    /// Register `w * h` raw RGBA8888 pixels under a string key (drawable like a keyed PNG,
+    /// usable by `spriteBatch` and as a `Tilemap` tileset).
+    pub fn imageRegister(key: []const u8, w: u32, h: u32, rgba: []const u8) bool {
+        return sys.wasm96_graphics_image_register(hashKey(key), w, h, rgba.ptr, rgba.len) != 0;
+    }
+
+    /// Draw many instances of one registered PNG/JPEG with a single host call.
+    /// Returns the number of sprites drawn (0 if the key is not registered).
+    pub fn spriteBatch(image_key: []const u8, sprites: []const Sprite) u32 {
+        return spriteBatchKey(hashKey(image_key), sprites);
+    }
+
+    pub fn spriteBatchKey(image_key: u64, sprites: []const Sprite) u32 {
+        if (sprites.len == 0) return 0;
+        return sys.wasm96_graphics_sprite_batch(image_key, sprites.ptr, @intCast(sprites.len));
+    }
+
+    /// Start recording the retained draw list `key`: primitives issued until `listEnd` are
+    /// captured on the host instead of drawn. Bitmap-font text is captured; TTF/OTF text,
+    /// images and sprites are not.
+    pub fn listBegin(key: []const u8) void {
+        sys.wasm96_graphics_list_begin(hashKey(key));
+    }
+
+    /// Finish the recording. Returns the number of primitives captured.
+    pub fn listEnd() u32 {
+        return sys.wasm96_graphics_list_end();
+    }
+
+    /// Replay the list `key` offset by (`dx`, `dy`) pixels, with one host call.
+    pub fn listDraw(key: []const u8, dx: i32, dy: i32) void {
+        sys.wasm96_graphics_list_draw(hashKey(key), dx, dy);
+    }
+
+    pub fn listDestroy(key: []const u8) void {
+        sys.wasm96_graphics_list_destroy(hashKey(key));
+    }
+
     /// Register a TTF font under a string key.
     pub fn fontRegisterTtf(key: []const u8, data: []const u8) bool {
         return sys.wasm96_graphics_font_register_ttf(hashKey(key), data.ptr, data.len) != 0;
@@ -392,10 +690,298 @@ pub const graphics = struct {
             .height = @as(u32, @intCast(result & 0xFFFFFFFF)),
         };
     }
+
+    /// Draw text at `px` pixels (TTF/OTF; 0 = default 16, bitmap fonts ignore it).
+    pub fn textKeySized(x: i32, y: i32, font_key: []const u8, px: u32, string: []const u8) void {
+        sys.wasm96_graphics_text_key_sized(x, y, hashKey(font_key), px, string.ptr, string.len);
+    }
+
+    /// Measure text at `px` pixels (matches `textKeySized`).
+    pub fn textMeasureKeySized(font_key: []const u8, px: u32, str: []const u8) TextSize {
+        const result = sys.wasm96_graphics_text_measure_key_sized(hashKey(font_key), px, str.ptr, str.len);
+        return TextSize{
+            .width = @as(u32, @intCast(result >> 32)),
+            .height = @as(u32, @intCast(result & 0xFFFFFFFF)),
+        };
+    }
+
+    /// Draw many strings in one keyed font with a single host call. The host keeps laid-out
+    /// runs, so strings that match last frame skip layout. Returns the number drawn.
+    pub fn textBatch(font_key: []const u8, items: []const TextItem) u32 {
+        return textBatchKey(hashKey(font_key), items);
+    }
+
+    pub fn textBatchKey(font_key: u64, items: []const TextItem) u32 {
+        if (items.len == 0) return 0;
+        return sys.wasm96_graphics_text_batch(font_key, items.ptr, @intCast(items.len));
+    }
+
+    /// Batched draw commands executed by the host with a single `wasm96_graphics_submit` call.
+    ///
+    /// Commands run on `submit()`, not when they are appended, so submit before issuing
+    /// immediate-mode calls that must layer on top. A full list submits itself automatically.
+    pub fn CommandList(comptime capacity_words: usize) type {
+        return struct {
+            const Self = @This();
+
+            words: [capacity_words]u32 = undefined,
+            len: usize = 0,
+
+            fn push(self: *Self, op: u32, args: []const u32) void {
+                if (self.len + 1 + args.len > capacity_words) {
+                    _ = self.submit();
+                    if (1 + args.len > capacity_words) return;
+                }
+                self.words[self.len] = op | (@as(u32, @intCast(args.len)) << 16);
+                @memcpy(self.words[self.len + 1 .. self.len + 1 + args.len], args);
+                self.len += 1 + args.len;
+            }
+
+            fn w(v: i32) u32 {
+                return @bitCast(v);
+            }
+
+            pub fn setColor(self: *Self, r: u8, g: u8, b: u8, a: u8) void {
+                self.push(1, &.{ r, g, b, a });
+            }
+
+            pub fn background(self: *Self, r: u8, g: u8, b: u8) void {
+                self.push(2, &.{ r, g, b });
+            }
+
+            pub fn point(self: *Self, x: i32, y: i32) void {
+                self.push(3, &.{ w(x), w(y) });
+            }
+
+            pub fn line(self: *Self, x1: i32, y1: i32, x2: i32, y2: i32) void {
+                self.push(4, &.{ w(x1), w(y1), w(x2), w(y2) });
+            }
+
+            pub fn rect(self: *Self, x: i32, y: i32, width: u32, height: u32) void {
+                self.push(5, &.{ w(x), w(y), width, height });
+            }
+
+            pub fn rectOutline(self: *Self, x: i32, y: i32, width: u32, height: u32) void {
+                self.push(6, &.{ w(x), w(y), width, height });
+            }
+
+            pub fn circle(self: *Self, x: i32, y: i32, r: u32) void {
+                self.push(7, &.{ w(x), w(y), r });
+            }
+
+            pub fn circleOutline(self: *Self, x: i32, y: i32, r: u32) void {
+                self.push(8, &.{ w(x), w(y), r });
+            }
+
+            pub fn triangle(self: *Self, x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32) void {
+                self.push(9, &.{ w(x1), w(y1), w(x2), w(y2), w(x3), w(y3) });
+            }
+
+            pub fn triangleOutline(self: *Self, x1: i32, y1: i32, x2: i32, y2: i32, x3: i32, y3: i32) void {
+                self.push(10, &.{ w(x1), w(y1), w(x2), w(y2), w(x3), w(y3) });
+            }
+
+            pub fn bezierQuadratic(self: *Self, x1: i32, y1: i32, cx: i32, cy: i32, x2: i32, y2: i32, segments: u32) void {
+                self.push(11, &.{ w(x1), w(y1), w(cx), w(cy), w(x2), w(y2), segments });
+            }
+
+            pub fn bezierCubic(self: *Self, x1: i32, y1: i32, cx1: i32, cy1: i32, cx2: i32, cy2: i32, x2: i32, y2: i32, segments: u32) void {
+                self.push(12, &.{ w(x1), w(y1), w(cx1), w(cy1), w(cx2), w(cy2), w(x2), w(y2), segments });
+            }
+
+            pub fn pill(self: *Self, x: i32, y: i32, width: u32, height: u32) void {
+                self.push(13, &.{ w(x), w(y), width, height });
+            }
+
+            pub fn pillOutline(self: *Self, x: i32, y: i32, width: u32, height: u32) void {
+                self.push(14, &.{ w(x), w(y), width, height });
+            }
+
+            pub fn clearRect(self: *Self, x: i32, y: i32, width: u32, height: u32, r: u8, g: u8, b: u8) void {
+                self.push(15, &.{ w(x), w(y), width, height, r, g, b });
+            }
+
+            /// Execute all queued commands and empty the list.
+            /// Returns the number of records the host executed.
+            pub fn submit(self: *Self) u32 {
+                var executed: u32 = 0;
+                if (self.len != 0) {
+                    executed = sys.wasm96_graphics_submit(&self.words, self.len * 4);
+                }
+                self.len = 0;
+                return executed;
+            }
+
+            /// Discard all queued commands.
+            pub fn clear(self: *Self) void {
+                self.len = 0;
+            }
+        };
+    }
+
+    /// A tilemap layer: a grid of `u16` tiles kept on the host and drawn from cached chunks of
+    /// 16x16 tiles; only chunks whose tiles change are re-rendered.
+    /// Tile 0 is empty; tile n is cell n-1 of the tileset (a keyed image, row-major cells).
+    pub const Tilemap = struct {
+        key: u64,
+
+        /// Create (or replace) the map. Returns null if the tileset is missing or a size is 0.
+        pub fn create(key: []const u8, tileset_key: []const u8, tile_w: u32, tile_h: u32, map_w: u32, map_h: u32) ?Tilemap {
+            const k = hashKey(key);
+            if (sys.wasm96_tilemap_create(k, hashKey(tileset_key), tile_w, tile_h, map_w, map_h) == 0) return null;
+            return .{ .key = k };
+        }
+
+        /// Copy a `w` x `h` block of tiles (row-major). Returns the number of tiles that changed.
+        pub fn setTiles(self: Tilemap, x: u32, y: u32, w: u32, h: u32, tiles: []const u16) u32 {
+            if (tiles.len < @as(usize, w) * @as(usize, h)) return 0;
+            return sys.wasm96_tilemap_set_tiles(self.key, x, y, w, h, tiles.ptr);
+        }
+
+        pub fn setTile(self: Tilemap, x: u32, y: u32, tile: u16) void {
+            sys.wasm96_tilemap_set_tile(self.key, x, y, tile);
+        }
+
+        /// Draw with map pixel (`scroll_x`, `scroll_y`) at screen (0, 0).
+        pub fn draw(self: Tilemap, scroll_x: i32, scroll_y: i32) void {
+            sys.wasm96_tilemap_draw(self.key, scroll_x, scroll_y);
+        }
+
+        pub fn destroy(self: Tilemap) void {
+            sys.wasm96_tilemap_destroy(self.key);
+        }
+    };
+
+    /// Sprites queued for one keyed image, drawn with one `spriteBatch` call on `flush()`.
+    /// A full batch flushes itself.
+    pub fn SpriteBatch(comptime capacity: usize) type {
+        return struct {
+            const Self = @This();
+
+            image_key: u64,
+            sprites: [capacity]Sprite = undefined,
+            len: usize = 0,
+
+            pub fn init(image_key: []const u8) Self {
+                return .{ .image_key = hashKey(image_key) };
+            }
+
+            /// Switch images; sprites queued for the previous one are drawn first.
+            pub fn setImage(self: *Self, image_key: []const u8) void {
+                const key = hashKey(image_key);
+                if (key != self.image_key) {
+                    _ = self.flush();
+                    self.image_key = key;
+                }
+            }
+
+            pub fn push(self: *Self, sprite: Sprite) void {
+                if (self.len == capacity) _ = self.flush();
+                self.sprites[self.len] = sprite;
+                self.len += 1;
+            }
+
+            /// Draw all queued sprites and empty the batch.
+            /// Returns the number of sprites the host drew.
+            pub fn flush(self: *Self) u32 {
+                const drawn = spriteBatchKey(self.image_key, self.sprites[0..self.len]);
+                self.len = 0;
+                return drawn;
+            }
+
+            /// Discard all queued sprites.
+            pub fn clear(self: *Self) void {
+                self.len = 0;
+            }
+        };
+    }
+};
+
+/// Async asset loading: the host copies the bytes and decodes them on worker threads. Finished
+/// assets are published at the start of a frame (or during `waitAll`) and are then drawn with the
+/// normal keyed calls, as if registered synchronously under the same key.
+pub const asset = struct {
+    /// What to decode the bytes as; each matches a synchronous register call.
+    pub const Kind = enum(u32) {
+        png = 0,
+        jpeg = 1,
+        svg = 2,
+        gif = 3,
+        font_ttf = 4,
+        /// Needs a GL context when it is published.
+        mesh_obj = 5,
+    };
+
+    pub const Status = enum(u32) {
+        /// No async load was requested for the key.
+        none = 0,
+        pending = 1,
+        ready = 2,
+        failed = 3,
+    };
+
+    /// Queue `data` for decoding under `key`. Returns false if the host rejected it.
+    pub fn load(kind: Kind, key: []const u8, data: []const u8) bool {
+        return sys.wasm96_asset_load(@intFromEnum(kind), graphics.hashKey(key), data.ptr, data.len) != 0;
+    }
+
+    /// Status of the latest async load of `key`.
+    pub fn status(key: []const u8) Status {
+        return switch (sys.wasm96_asset_status(graphics.hashKey(key))) {
+            1 => .pending,
+            2 => .ready,
+            3 => .failed,
+            else => .none,
+        };
+    }
+
+    /// Publish finished loads, blocking for at most `timeout_ms` (0 = just poll; call once per
+    /// frame). Returns how many loads are still pending.
+    pub fn waitAll(timeout_ms: u32) u32 {
+        return sys.wasm96_asset_wait_all(timeout_ms);
+    }
 };
 
 /// Input API.
 pub const input = struct {
+    /// Joypad ports snapshotted by the host each frame.
+    pub const max_ports: u32 = 4;
+
+    /// One port's buttons for the current frame (three host calls instead of one per button).
+    pub const Pad = struct {
+        /// Bit `n` set while button `n` is down.
+        held: u32 = 0,
+        /// Buttons that went down since the previous frame.
+        pressed: u32 = 0,
+        /// Buttons that went up since the previous frame.
+        released: u32 = 0,
+
+        pub fn mask(btn: Button) u32 {
+            return @as(u32, 1) << @intCast(@intFromEnum(btn));
+        }
+
+        pub fn isDown(self: Pad, btn: Button) bool {
+            return self.held & mask(btn) != 0;
+        }
+
+        pub fn wasPressed(self: Pad, btn: Button) bool {
+            return self.pressed & mask(btn) != 0;
+        }
+
+        pub fn wasReleased(self: Pad, btn: Button) bool {
+            return self.released & mask(btn) != 0;
+        }
+    };
+
+    /// Read `port`'s held/pressed/released masks for this frame.
+    pub fn pad(port: u32) Pad {
+        return .{
+            .held = sys.wasm96_input_get_buttons(port),
+            .pressed = sys.wasm96_input_get_pressed(port),
+            .released = sys.wasm96_input_get_released(port),
+        };
+    }
+
     /// Returns true if the specified button is currently held down.
     pub fn isButtonDown(port: u32, btn: Button) bool {
         return sys.wasm96_input_is_button_down(port, @intFromEnum(btn)) != 0;
@@ -436,6 +1022,12 @@ pub const audio = struct {
         sys.wasm96_audio_push_samples(samples.ptr, samples.len);
     }
 
+    /// Stereo frames pushed with `pushSamples` that have not been played yet (top up to a target
+    /// rather than pushing a fixed amount; overflowing pushes are dropped).
+    pub fn queuedFrames() u32 {
+        return sys.wasm96_audio_queued_frames();
+    }
+
     /// Play a WAV file.
     /// The WAV data is decoded and played as a one-shot audio channel.
     pub fn playWav(data: []const u8) void {
@@ -453,6 +1045,50 @@ pub const audio = struct {
     pub fn playXm(data: []const u8) void {
         sys.wasm96_audio_play_xm(data.ptr, data.len);
     }
+
+    /// Encoded audio formats accepted by `play`.
+    pub const Format = enum(u32) {
+        wav = 0,
+        qoa = 1,
+        xm = 2,
+    };
+
+    /// Q8.8 volume for 1.0.
+    pub const volume_unity: u32 = 256;
+
+    /// Handle to a host-mixed voice. Controls on a finished voice are ignored.
+    pub const Voice = struct {
+        id: u32,
+
+        /// Q8.8 volume (`volume_unity` is 1.0).
+        pub fn setVolume(self: Voice, volume_q8_8: u32) void {
+            sys.wasm96_audio_voice_set_volume(self.id, volume_q8_8);
+        }
+
+        /// -32768 = left, 0 = center, 32767 = right.
+        pub fn setPan(self: Voice, pan: i32) void {
+            sys.wasm96_audio_voice_set_pan(self.id, pan);
+        }
+
+        pub fn setLoop(self: Voice, loop: bool) void {
+            sys.wasm96_audio_voice_set_loop(self.id, @intFromBool(loop));
+        }
+
+        pub fn stop(self: Voice) void {
+            sys.wasm96_audio_voice_stop(self.id);
+        }
+
+        pub fn isPlaying(self: Voice) bool {
+            return sys.wasm96_audio_voice_is_playing(self.id) != 0;
+        }
+    };
+
+    /// Decode `data` and start a voice (resampled to the output rate; identical bytes reuse the
+    /// host's cached decode). Returns null if the data could not be decoded.
+    pub fn play(format: Format, data: []const u8, loop: bool) ?Voice {
+        const id = sys.wasm96_audio_voice_play(@intFromEnum(format), data.ptr, data.len, @intFromBool(loop));
+        return if (id == 0) null else Voice{ .id = id };
+    }
 };
 
 /// Storage API.
@@ -462,24 +1098,37 @@ pub const storage = struct {
         sys.wasm96_storage_save(graphics.hashKey(key), data.ptr, data.len);
     }
 
-    /// Load data from persistent storage.
-    /// Returns the data if found, null otherwise.
-    pub fn load(allocator: std.mem.Allocator, key: []const u8) !?[]u8 {
-        const packed_result = sys.wasm96_storage_load(graphics.hashKey(key));
-        if (packed_result == 0) return null;
-
-        const ptr_int = packed_result >> 32;
-        const len = packed_result & 0xFFFFFFFF;
+    /// Returned by the raw imports when no value is stored under a key.
+    pub const not_found: u32 = 0xFFFF_FFFF;
 
-        const ptr = @as([*]const u8, @ptrFromInt(ptr_int));
+    /// Length of the value stored under `key`, or null if missing.
+    pub fn size(key: []const u8) ?u32 {
+        const n = sys.wasm96_storage_size(graphics.hashKey(key));
+        return if (n == not_found) null else n;
+    }
 
-        // Copy data from guest memory
-        const data = try allocator.alloc(u8, @as(usize, @intCast(len)));
-        @memcpy(data, ptr[0..@as(usize, @intCast(len))]);
+    /// Copy `key`'s value, starting at byte `offset`, straight into `dst` (no allocation).
+    /// Returns the bytes copied, or null if the key is missing.
+    pub fn read(key: []const u8, dst: []u8, offset: u32) ?usize {
+        const n = sys.wasm96_storage_read(graphics.hashKey(key), dst.ptr, @intCast(dst.len), offset);
+        return if (n == not_found) null else n;
+    }
 
-        // Free the memory in guest space
-        sys.wasm96_storage_free(ptr, @as(usize, @intCast(len)));
+    /// Overwrite `data.len` bytes at byte `offset` of `key`'s value, creating or zero-extending
+    /// it. Only the changed range is copied and persisted; prefer this to re-saving a large blob.
+    pub fn write(key: []const u8, offset: u32, data: []const u8) void {
+        sys.wasm96_storage_write(graphics.hashKey(key), offset, data.ptr, @intCast(data.len));
+    }
 
+    /// Load data from persistent storage.
+    /// Returns the data if found, null otherwise.
+    pub fn load(allocator: std.mem.Allocator, key: []const u8) !?[]u8 {
+        const len = size(key) orelse return null;
+        const data = try allocator.alloc(u8, len);
+        _ = read(key, data, 0) orelse {
+            allocator.free(data);
+            return null;
+        };
         return data;
     }
 };
@@ -495,4 +1144,43 @@ pub const system = struct {
     pub fn millis() u64 {
         return sys.wasm96_system_millis();
     }
+
+    /// Index into `FrameStats.phase_ns`.
+    pub const Phase = enum(u32) { input = 0, assets = 1, update = 2, draw = 3, present = 4, audio = 5 };
+
+    /// Host profile of the last finished frame (report header); times in nanoseconds.
+    pub const FrameStats = extern struct {
+        version: u32,
+        entry_count: u32,
+        frame_index: u64,
+        frame_ns: u64,
+        phase_ns: [6]u64,
+        host_ns: u64,
+        host_calls: u32,
+        lock_count: u32,
+        lock_wait_ns: u64,
+        bytes_in: u64,
+        bytes_out: u64,
+    };
+
+    /// One import's calls in a report (name without the `wasm96_` prefix, zero-padded).
+    pub const ImportStats = extern struct {
+        name: [32]u8,
+        calls: u32,
+        reserved: u32,
+        ns: u64,
+    };
+
+    /// Last frame's totals. The first call turns host profiling on (numbers start next frame).
+    pub fn stats() FrameStats {
+        var s = std.mem.zeroes(FrameStats);
+        _ = sys.wasm96_system_stats(@ptrCast(&s), @sizeOf(FrameStats));
+        return s;
+    }
+
+    /// Fill `report` with a `FrameStats` followed by `entry_count` `ImportStats` (slowest first);
+    /// returns the size of the full report.
+    pub fn statsInto(report: []u8) u32 {
+        return sys.wasm96_system_stats(report.ptr, report.len);
+    }
 };